@@ -31,6 +31,7 @@
 #define RPC_MAX_CORES 255
 #define MAX_THREAD_NAME 128
 #define MAX_POLLER_NAME 128
+#define MAX_POLLER_RUN_TIME_BUCKETS 64
 #define MAX_THREADS 4096
 #define RR_MAX_VALUE 255
 
@@ -65,12 +66,12 @@
 #define WINDOW_HEADER 12
 #define FROM_HEX 16
 #define THREAD_WIN_WIDTH 69
-#define THREAD_WIN_HEIGHT 9
+#define THREAD_WIN_HEIGHT 10
 #define THREAD_WIN_FIRST_COL 2
 #define CORE_WIN_FIRST_COL 16
 #define CORE_WIN_WIDTH 48
 #define CORE_WIN_HEIGHT 11
-#define POLLER_WIN_HEIGHT 8
+#define POLLER_WIN_HEIGHT 11
 #define POLLER_WIN_WIDTH 64
 #define POLLER_WIN_FIRST_COL 14
 #define FIRST_DATA_ROW 7
@@ -202,6 +203,10 @@ struct rpc_thread_info {
 	uint64_t active_pollers_count;
 	uint64_t timed_pollers_count;
 	uint64_t paused_pollers_count;
+	uint64_t msg_count;
+	uint64_t last_msg_count;
+	uint64_t msg_queue_depth_max;
+	uint64_t msg_latency_max;
 };
 
 struct rpc_poller_info {
@@ -214,6 +219,10 @@ struct rpc_poller_info {
 	enum spdk_poller_type type;
 	char thread_name[MAX_THREAD_NAME];
 	uint64_t thread_id;
+	uint64_t total_run_ticks;
+	uint64_t max_run_ticks;
+	uint64_t run_time_histogram[MAX_POLLER_RUN_TIME_BUCKETS];
+	size_t run_time_buckets;
 };
 
 struct rpc_core_thread_info {
@@ -280,6 +289,9 @@ static const struct spdk_json_object_decoder rpc_thread_info_decoders[] = {
 	{"active_pollers_count", offsetof(struct rpc_thread_info, active_pollers_count), spdk_json_decode_uint64},
 	{"timed_pollers_count", offsetof(struct rpc_thread_info, timed_pollers_count), spdk_json_decode_uint64},
 	{"paused_pollers_count", offsetof(struct rpc_thread_info, paused_pollers_count), spdk_json_decode_uint64},
+	{"msg_count", offsetof(struct rpc_thread_info, msg_count), spdk_json_decode_uint64, true},
+	{"msg_queue_depth_max", offsetof(struct rpc_thread_info, msg_queue_depth_max), spdk_json_decode_uint64, true},
+	{"msg_latency_max", offsetof(struct rpc_thread_info, msg_latency_max), spdk_json_decode_uint64, true},
 };
 
 static int
@@ -341,6 +353,16 @@ free_rpc_core_info(struct rpc_core_info *core_info, size_t size)
 	}
 }
 
+static int
+rpc_decode_run_time_histogram(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_poller_info *poller = SPDK_CONTAINEROF(out, struct rpc_poller_info,
+					 run_time_histogram);
+
+	return spdk_json_decode_array(val, spdk_json_decode_uint64, poller->run_time_histogram,
+				      MAX_POLLER_RUN_TIME_BUCKETS, &poller->run_time_buckets, sizeof(uint64_t));
+}
+
 static const struct spdk_json_object_decoder rpc_pollers_decoders[] = {
 	{"name", offsetof(struct rpc_poller_info, name), spdk_json_decode_string},
 	{"state", offsetof(struct rpc_poller_info, state), spdk_json_decode_string},
@@ -348,6 +370,9 @@ static const struct spdk_json_object_decoder rpc_pollers_decoders[] = {
 	{"run_count", offsetof(struct rpc_poller_info, run_count), spdk_json_decode_uint64},
 	{"busy_count", offsetof(struct rpc_poller_info, busy_count), spdk_json_decode_uint64},
 	{"period_ticks", offsetof(struct rpc_poller_info, period_ticks), spdk_json_decode_uint64, true},
+	{"total_run_ticks", offsetof(struct rpc_poller_info, total_run_ticks), spdk_json_decode_uint64, true},
+	{"max_run_ticks", offsetof(struct rpc_poller_info, max_run_ticks), spdk_json_decode_uint64, true},
+	{"run_time_histogram", offsetof(struct rpc_poller_info, run_time_histogram), rpc_decode_run_time_histogram, true},
 };
 
 static int
@@ -736,6 +761,7 @@ get_thread_data(void)
 			if (thread_info[i].id == g_threads_info[j].id) {
 				thread_info[i].last_busy = g_threads_info[j].busy;
 				thread_info[i].last_idle = g_threads_info[j].idle;
+				thread_info[i].last_msg_count = g_threads_info[j].msg_count;
 			}
 		}
 	}
@@ -2254,6 +2280,7 @@ draw_thread_win_content(WINDOW *thread_win, struct rpc_thread_info *thread_info)
 {
 	uint64_t current_row, i, time;
 	char idle_time[MAX_TIME_STR_LEN], busy_time[MAX_TIME_STR_LEN];
+	char msg_latency[MAX_TIME_STR_LEN];
 
 	box(thread_win, 0, 0);
 
@@ -2288,14 +2315,24 @@ draw_thread_win_content(WINDOW *thread_win, struct rpc_thread_info *thread_info)
 	mvwprintw(thread_win, 4, THREAD_WIN_FIRST_COL + 59, "%" PRIu64,
 		  thread_info->paused_pollers_count);
 
-	mvwhline(thread_win, 5, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
+	print_left(thread_win, 5, THREAD_WIN_FIRST_COL, THREAD_WIN_WIDTH,
+		   "Messages:            Max msg queue:        Max msg lat [us]:", COLOR_PAIR(5));
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 10, "%" PRIu64,
+		  g_interval_data ? thread_info->msg_count - thread_info->last_msg_count :
+		  thread_info->msg_count);
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 36, "%" PRIu64,
+		  thread_info->msg_queue_depth_max);
+	get_time_str(thread_info->msg_latency_max, msg_latency);
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 61, "%s", msg_latency);
+
+	mvwhline(thread_win, 6, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
 
-	print_in_middle(thread_win, 6, 0, THREAD_WIN_WIDTH,
+	print_in_middle(thread_win, 7, 0, THREAD_WIN_WIDTH,
 			"Pollers                          Type    Total run count   Period", COLOR_PAIR(5));
 
-	mvwhline(thread_win, 7, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
+	mvwhline(thread_win, 8, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
 
-	current_row = 8;
+	current_row = 9;
 
 	for (i = 0; i < g_last_pollers_count; i++) {
 		if (g_pollers_info[i].thread_id == thread_info->id) {
@@ -2642,11 +2679,51 @@ show_core(uint8_t current_page, uint8_t active_tab)
 	delwin(core_win);
 }
 
+static void
+get_run_time_str(uint64_t ticks, char *time_str)
+{
+	uint64_t time;
+
+	time = (uint64_t)((double)ticks * SPDK_SEC_TO_NSEC / g_tick_rate);
+	snprintf(time_str, MAX_TIME_STR_LEN, "%" PRIu64, time);
+}
+
+/* Returns the upper bound, in ticks, of the log2 histogram bucket holding the given percentile */
+static uint64_t
+get_run_time_percentile(struct rpc_poller_info *poller_info, uint64_t percentile)
+{
+	uint64_t total = 0, sum = 0, threshold;
+	size_t i;
+
+	for (i = 0; i < poller_info->run_time_buckets; i++) {
+		total += poller_info->run_time_histogram[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	threshold = spdk_divide_round_up(total * percentile, 100);
+	for (i = 0; i < poller_info->run_time_buckets; i++) {
+		sum += poller_info->run_time_histogram[i];
+		if (sum >= threshold) {
+			break;
+		}
+	}
+
+	/* The highest bucket may be clamped, so use the watermark for it instead */
+	if (i + 1 >= poller_info->run_time_buckets) {
+		return poller_info->max_run_ticks;
+	}
+
+	return (2ULL << i) - 1;
+}
+
 static void
 draw_poller_win_content(WINDOW *poller_win, struct rpc_poller_info *poller_info)
 {
 	uint64_t last_run_counter, last_busy_counter, busy_count;
 	char poller_period[MAX_TIME_STR_LEN];
+	char run_time[MAX_TIME_STR_LEN];
 
 	box(poller_win, 0, 0);
 
@@ -2694,6 +2771,22 @@ draw_poller_win_content(WINDOW *poller_win, struct rpc_poller_info *poller_info)
 		print_in_middle(poller_win, 6, 1, POLLER_WIN_WIDTH + 6, "Idle", COLOR_PAIR(7));
 	}
 
+	mvwhline(poller_win, 7, 1, ACS_HLINE, POLLER_WIN_WIDTH - 2);
+
+	/* Run time statistics are cumulative since the poller was registered */
+	print_left(poller_win, 8, 2, POLLER_WIN_WIDTH, "Avg [ns]:              Max [ns]:", COLOR_PAIR(5));
+	get_run_time_str(poller_info->run_count ? poller_info->total_run_ticks / poller_info->run_count : 0,
+			 run_time);
+	mvwprintw(poller_win, 8, POLLER_WIN_FIRST_COL, "%s", run_time);
+	get_run_time_str(poller_info->max_run_ticks, run_time);
+	mvwprintw(poller_win, 8, POLLER_WIN_FIRST_COL + 23, "%s", run_time);
+
+	print_left(poller_win, 9, 2, POLLER_WIN_WIDTH, "p50 [ns]:              p99 [ns]:", COLOR_PAIR(5));
+	get_run_time_str(get_run_time_percentile(poller_info, 50), run_time);
+	mvwprintw(poller_win, 9, POLLER_WIN_FIRST_COL, "<%s", run_time);
+	get_run_time_str(get_run_time_percentile(poller_info, 99), run_time);
+	mvwprintw(poller_win, 9, POLLER_WIN_FIRST_COL + 23, "<%s", run_time);
+
 	wnoutrefresh(poller_win);
 }
 
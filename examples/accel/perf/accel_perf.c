@@ -12,6 +12,7 @@
 #include "spdk/accel.h"
 #include "spdk/crc32.h"
 #include "spdk/util.h"
+#include "spdk/xor.h"
 
 #define DATA_PATTERN 0x5a
 #define ALIGN_4K 0x1000
@@ -31,6 +32,7 @@ static uint32_t g_crc32c_seed = 0;
 static uint32_t g_crc32c_chained_count = 1;
 static int g_fail_percent_goal = 0;
 static uint8_t g_fill_pattern = 255;
+static uint32_t g_xor_src_count = 2;
 static bool g_verify = false;
 static const char *g_workload_type = NULL;
 static enum accel_opcode g_workload_selection;
@@ -49,6 +51,7 @@ struct display_info {
 
 struct ap_task {
 	void			*src;
+	void			**sources;
 	struct iovec		*iovs;
 	uint32_t		iov_cnt;
 	void			*dst;
@@ -99,6 +102,8 @@ dump_user_config(void)
 		printf("Fill pattern:   0x%x\n", g_fill_pattern);
 	} else if ((g_workload_selection == ACCEL_OPC_COMPARE) && g_fail_percent_goal > 0) {
 		printf("Failure inject: %u percent\n", g_fail_percent_goal);
+	} else if (g_workload_selection == ACCEL_OPC_XOR) {
+		printf("Source buffers: %u\n", g_xor_src_count);
 	}
 	if (g_workload_selection == ACCEL_OPC_COPY_CRC32C) {
 		printf("Vector size:    %u bytes\n", g_xfer_size_bytes);
@@ -125,10 +130,11 @@ usage(void)
 	printf("\t[-n number of channels]\n");
 	printf("\t[-o transfer size in bytes]\n");
 	printf("\t[-t time in seconds]\n");
-	printf("\t[-w workload type must be one of these: copy, fill, crc32c, copy_crc32c, compare, dualcast\n");
+	printf("\t[-w workload type must be one of these: copy, fill, crc32c, copy_crc32c, compare, dualcast, xor\n");
 	printf("\t[-s for crc32c workload, use this seed value (default 0)\n");
 	printf("\t[-P for compare workload, percentage of operations that should miscompare (percent, default 0)\n");
 	printf("\t[-f for fill workload, use this BYTE value (default 255)\n");
+	printf("\t[-x for xor workload, number of source buffers (default 2, minimum 2)\n");
 	printf("\t[-y verify result if this switch is on]\n");
 	printf("\t[-a tasks to allocate per core (default: same value as -q)]\n");
 	printf("\t\tCan be used to spread operations across a wider range of memory.\n");
@@ -149,6 +155,7 @@ parse_args(int argc, char *argv)
 	case 'q':
 	case 's':
 	case 't':
+	case 'x':
 		argval = spdk_strtol(optarg, 10);
 		if (argval < 0) {
 			fprintf(stderr, "-%c option must be non-negative.\n", argc);
@@ -188,6 +195,9 @@ parse_args(int argc, char *argv)
 	case 't':
 		g_time_in_sec = argval;
 		break;
+	case 'x':
+		g_xor_src_count = argval;
+		break;
 	case 'y':
 		g_verify = true;
 		break;
@@ -205,6 +215,8 @@ parse_args(int argc, char *argv)
 			g_workload_selection = ACCEL_OPC_COMPARE;
 		} else if (!strcmp(g_workload_type, "dualcast")) {
 			g_workload_selection = ACCEL_OPC_DUALCAST;
+		} else if (!strcmp(g_workload_type, "xor")) {
+			g_workload_selection = ACCEL_OPC_XOR;
 		} else {
 			usage();
 			return 1;
@@ -272,6 +284,20 @@ _get_task_data_bufs(struct ap_task *task)
 			task->iovs[i].iov_len = g_xfer_size_bytes;
 		}
 
+	} else if (g_workload_selection == ACCEL_OPC_XOR) {
+		assert(g_xor_src_count > 1);
+		task->sources = calloc(g_xor_src_count, sizeof(*task->sources));
+		if (!task->sources) {
+			return -ENOMEM;
+		}
+
+		for (i = 0; i < g_xor_src_count; i++) {
+			task->sources[i] = spdk_dma_zmalloc(g_xfer_size_bytes, 0, NULL);
+			if (!task->sources[i]) {
+				return -ENOMEM;
+			}
+			memset(task->sources[i], DATA_PATTERN + i, g_xfer_size_bytes);
+		}
 	} else {
 		task->src = spdk_dma_zmalloc(g_xfer_size_bytes, 0, NULL);
 		if (task->src == NULL) {
@@ -302,8 +328,10 @@ _get_task_data_bufs(struct ap_task *task)
 		}
 	}
 
-	/* For dualcast 2 buffers are needed for the operation.  */
-	if (g_workload_selection == ACCEL_OPC_DUALCAST) {
+	/* For dualcast 2 buffers are needed for the operation. For xor the second one holds
+	 * the software result when verify is enabled. */
+	if (g_workload_selection == ACCEL_OPC_DUALCAST ||
+	    (g_workload_selection == ACCEL_OPC_XOR && g_verify)) {
 		task->dst2 = spdk_dma_zmalloc(g_xfer_size_bytes, align, NULL);
 		if (task->dst2 == NULL) {
 			fprintf(stderr, "Unable to alloc dst buffer\n");
@@ -376,6 +404,10 @@ _submit_single(struct worker_thread *worker, struct ap_task *task)
 		rc = spdk_accel_submit_dualcast(worker->ch, task->dst, task->dst2,
 						task->src, g_xfer_size_bytes, flags, accel_done, task);
 		break;
+	case ACCEL_OPC_XOR:
+		rc = spdk_accel_submit_xor(worker->ch, task->dst, task->sources, g_xor_src_count,
+					   g_xfer_size_bytes, accel_done, task);
+		break;
 	default:
 		assert(false);
 		break;
@@ -402,12 +434,19 @@ _free_task_buffers(struct ap_task *task)
 			}
 			free(task->iovs);
 		}
+	} else if (g_workload_selection == ACCEL_OPC_XOR) {
+		if (task->sources) {
+			for (i = 0; i < g_xor_src_count; i++) {
+				spdk_dma_free(task->sources[i]);
+			}
+			free(task->sources);
+		}
 	} else {
 		spdk_dma_free(task->src);
 	}
 
 	spdk_dma_free(task->dst);
-	if (g_workload_selection == ACCEL_OPC_DUALCAST) {
+	if (g_workload_selection == ACCEL_OPC_DUALCAST || g_workload_selection == ACCEL_OPC_XOR) {
 		spdk_dma_free(task->dst2);
 	}
 }
@@ -490,6 +529,15 @@ accel_done(void *arg1, int status)
 			break;
 		case ACCEL_OPC_COMPARE:
 			break;
+		case ACCEL_OPC_XOR:
+			if (spdk_xor_gen(task->dst2, task->sources, g_xor_src_count,
+					 g_xfer_size_bytes) != 0) {
+				SPDK_ERRLOG("Failed to generate xor for verification\n");
+			} else if (memcmp(task->dst, task->dst2, g_xfer_size_bytes)) {
+				SPDK_NOTICELOG("Data miscompare\n");
+				worker->xfer_failed++;
+			}
+			break;
 		default:
 			assert(false);
 			break;
@@ -721,7 +769,7 @@ main(int argc, char **argv)
 	spdk_app_opts_init(&g_opts, sizeof(g_opts));
 	g_opts.name = "accel_perf";
 	g_opts.reactor_mask = "0x1";
-	if (spdk_app_parse_args(argc, argv, &g_opts, "a:C:o:q:t:yw:P:f:T:", NULL, parse_args,
+	if (spdk_app_parse_args(argc, argv, &g_opts, "a:C:o:q:t:yw:P:f:T:x:", NULL, parse_args,
 				usage) != SPDK_APP_PARSE_ARGS_SUCCESS) {
 		g_rc = -1;
 		goto cleanup;
@@ -732,7 +780,8 @@ main(int argc, char **argv)
 	    (g_workload_selection != ACCEL_OPC_CRC32C) &&
 	    (g_workload_selection != ACCEL_OPC_COPY_CRC32C) &&
 	    (g_workload_selection != ACCEL_OPC_COMPARE) &&
-	    (g_workload_selection != ACCEL_OPC_DUALCAST)) {
+	    (g_workload_selection != ACCEL_OPC_DUALCAST) &&
+	    (g_workload_selection != ACCEL_OPC_XOR)) {
 		usage();
 		g_rc = -1;
 		goto cleanup;
@@ -756,6 +805,13 @@ main(int argc, char **argv)
 		goto cleanup;
 	}
 
+	if (g_workload_selection == ACCEL_OPC_XOR && g_xor_src_count < 2) {
+		fprintf(stdout, "xor workload requires at least 2 source buffers\n");
+		usage();
+		g_rc = -1;
+		goto cleanup;
+	}
+
 	g_rc = spdk_app_start(&g_opts, accel_perf_start, NULL);
 	if (g_rc) {
 		SPDK_ERRLOG("ERROR starting application\n");
@@ -28,7 +28,67 @@ enum accel_opcode {
 	ACCEL_OPC_COPY_CRC32C		= 5,
 	ACCEL_OPC_COMPRESS		= 6,
 	ACCEL_OPC_DECOMPRESS		= 7,
-	ACCEL_OPC_LAST			= 8,
+	ACCEL_OPC_XOR			= 8,
+	ACCEL_OPC_PQ_GEN		= 9,
+	ACCEL_OPC_ENCRYPT		= 10,
+	ACCEL_OPC_DECRYPT		= 11,
+	ACCEL_OPC_LAST			= 12,
+};
+
+/* Ciphers of crypto keys */
+#define ACCEL_AES_XTS "AES_XTS"
+
+/**
+ * Key used by encrypt and decrypt operations.
+ */
+struct spdk_accel_crypto_key;
+
+/**
+ * Parameters of a crypto key.
+ */
+struct spdk_accel_crypto_key_create_param {
+	/** Cipher, only ACCEL_AES_XTS is supported */
+	const char	*cipher;
+	/** Data key */
+	const uint8_t	*key;
+	/** Size of the data key in bytes */
+	size_t		key_size;
+	/** Tweak key */
+	const uint8_t	*key2;
+	/** Size of the tweak key in bytes */
+	size_t		key2_size;
+};
+
+/**
+ * Compression algorithms of compress and decompress operations.
+ */
+enum spdk_accel_comp_algo {
+	SPDK_ACCEL_COMP_ALGO_DEFLATE	= 0,
+	SPDK_ACCEL_COMP_ALGO_LZ4	= 1,
+	SPDK_ACCEL_COMP_ALGO_ZSTD	= 2,
+	SPDK_ACCEL_COMP_ALGO_LAST	= 3,
+};
+
+/**
+ * Options of compress and decompress operations.
+ */
+struct spdk_accel_comp_opts {
+	/** Size of this structure in bytes, should be set to sizeof(struct spdk_accel_comp_opts) */
+	size_t				size;
+	/** Compression algorithm */
+	enum spdk_accel_comp_algo	algo;
+	/**
+	 * Compression level, 0 selects the default level of the algorithm.  Higher levels
+	 * trade speed for compression ratio.  Ignored by decompress operations.
+	 */
+	int32_t				level;
+	/**
+	 * Maximum number of input bytes processed in one go, 0 processes the whole
+	 * operation at once.  Engines supporting streaming split larger operations into
+	 * chunks of this size and interleave them with other work, so that compressing a
+	 * large buffer doesn't stall the thread.
+	 */
+	uint32_t			chunk_size;
 };
 
 /**
@@ -39,6 +99,24 @@ enum accel_opcode {
  */
 typedef void (*spdk_accel_completion_cb)(void *ref, int status);
 
+/**
+ * Acceleration sequence step callback.  Called once an operation appended to a
+ * sequence is done (or the sequence was aborted before executing it).
+ *
+ * \param cb_arg Callback argument.
+ */
+typedef void (*spdk_accel_step_cb)(void *cb_arg);
+
+/**
+ * Sequence of acceleration operations executed back-to-back.
+ */
+struct spdk_accel_sequence;
+
+/**
+ * Batch of independent acceleration operations submitted together.
+ */
+struct spdk_accel_batch;
+
 /**
  * Acceleration engine finish callback.
  *
@@ -263,6 +341,503 @@ int spdk_accel_submit_decompress(struct spdk_io_channel *ch, void *dst, void *sr
 				 uint64_t nbytes_dst, uint64_t nbytes_src, int flags,
 				 spdk_accel_completion_cb cb_fn, void *cb_arg);
 
+/**
+ * Submit a compress request using the algorithm and level selected by opts.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dst_iovs Destination I/O vector array to compress to.
+ * \param dst_iovcnt Size of the dst_iovs array.
+ * \param src_iovs Source I/O vector array to read from.
+ * \param src_iovcnt Size of the src_iovs array.
+ * \param output_size Set to the size of the compressed data.  Optional.
+ * \param opts Compression options.  If NULL, deflate at its default level is used.
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Callback function which will be called when the request is complete.
+ * \param cb_arg Opaque value which will be passed back as the arg parameter in
+ * the completion callback.
+ *
+ * \return 0 on success, -ENOTSUP if the engine assigned to compress operations doesn't
+ * support the algorithm, other negative errno on failure.
+ */
+int spdk_accel_submit_compress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				   uint32_t dst_iovcnt, struct iovec *src_iovs,
+				   uint32_t src_iovcnt, uint32_t *output_size,
+				   const struct spdk_accel_comp_opts *opts, int flags,
+				   spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a decompress request using the algorithm selected by opts.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dst_iovs Destination I/O vector array.  Must be large enough to hold the
+ * decompressed data.
+ * \param dst_iovcnt Size of the dst_iovs array.
+ * \param src_iovs Source I/O vector array to read from.
+ * \param src_iovcnt Size of the src_iovs array.
+ * \param output_size Set to the size of the decompressed data.  Optional.
+ * \param opts Compression options.  If NULL, deflate is used.
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Callback function which will be called when the request is complete.
+ * \param cb_arg Opaque value which will be passed back as the arg parameter in
+ * the completion callback.
+ *
+ * \return 0 on success, -ENOTSUP if the engine assigned to decompress operations doesn't
+ * support the algorithm, other negative errno on failure.
+ */
+int spdk_accel_submit_decompress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				     uint32_t dst_iovcnt, struct iovec *src_iovs,
+				     uint32_t src_iovcnt, uint32_t *output_size,
+				     const struct spdk_accel_comp_opts *opts, int flags,
+				     spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Check whether the engines assigned to compress and decompress operations
+ * both support the given algorithm.
+ *
+ * \param algo Compression algorithm.
+ *
+ * \return true if the algorithm can be used with the _ext compression APIs.
+ */
+bool spdk_accel_comp_algo_supported(enum spdk_accel_comp_algo algo);
+
+/**
+ * Submit an xor request.
+ *
+ * This operation will calculate the XOR of all source buffers and write the result
+ * to the destination buffer.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param dst Destination to write the data to.
+ * \param sources Array of source buffers.
+ * \param nsrcs Number of source buffers in the array. Must be at least 2.
+ * \param nbytes Length in bytes of each buffer.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uint32_t nsrcs,
+			  uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a RAID-6 P+Q parity generation request.
+ *
+ * This operation will calculate the P (XOR) and Q (Reed-Solomon syndrome) parity of
+ * the source buffers, as described by spdk_xor_gen_pq().
+ *
+ * \param ch I/O channel associated with this call.
+ * \param p Destination to write the P parity to.
+ * \param q Destination to write the Q parity to.
+ * \param sources Array of source buffers.
+ * \param nsrcs Number of source buffers in the array. Must be at least 2.
+ * \param nbytes Length in bytes of each buffer.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_pq_gen(struct spdk_io_channel *ch, void *p, void *q, void **sources,
+			     uint32_t nsrcs, uint64_t nbytes, spdk_accel_completion_cb cb_fn,
+			     void *cb_arg);
+
+/**
+ * Create a crypto key.  The key is bound to the engine assigned to the encrypt and decrypt
+ * opcodes, so both of them have to be assigned to the same engine.
+ *
+ * \param param Key parameters.  The key material is copied.
+ * \param key Pointer to update with the key.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_crypto_key_create(const struct spdk_accel_crypto_key_create_param *param,
+				 struct spdk_accel_crypto_key **key);
+
+/**
+ * Destroy a crypto key.  There must be no operations using it in progress.
+ *
+ * \param key Key to destroy.
+ */
+void spdk_accel_crypto_key_destroy(struct spdk_accel_crypto_key *key);
+
+/**
+ * Submit an encryption request to the accel framework.
+ *
+ * The data is encrypted in units of block_size bytes, each with its own tweak: iv for the
+ * first block, iv + 1 for the next one and so on.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param key Key to encrypt with.
+ * \param dst_iovs Destination I/O vector array.  May be the same as the source.
+ * \param dst_iovcnt Size of the destination I/O vector array.
+ * \param src_iovs Source I/O vector array.
+ * \param src_iovcnt Size of the source I/O vector array.
+ * \param iv Initialization vector (tweak) of the first block.
+ * \param block_size Size of a data unit in bytes.  The length of the data must be a multiple
+ * of it.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_encrypt(struct spdk_io_channel *ch, struct spdk_accel_crypto_key *key,
+			      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			      struct iovec *src_iovs, uint32_t src_iovcnt,
+			      uint64_t iv, uint32_t block_size, int flags,
+			      spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit a decryption request to the accel framework.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param key Key to decrypt with.
+ * \param dst_iovs Destination I/O vector array.  May be the same as the source.
+ * \param dst_iovcnt Size of the destination I/O vector array.
+ * \param src_iovs Source I/O vector array.
+ * \param src_iovcnt Size of the source I/O vector array.
+ * \param iv Initialization vector (tweak) of the first block.
+ * \param block_size Size of a data unit in bytes.  The length of the data must be a multiple
+ * of it.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_submit_decrypt(struct spdk_io_channel *ch, struct spdk_accel_crypto_key *key,
+			      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			      struct iovec *src_iovs, uint32_t src_iovcnt,
+			      uint64_t iv, uint32_t block_size, int flags,
+			      spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a copy operation to a sequence.
+ *
+ * Operations appended to a sequence aren't executed until spdk_accel_sequence_finish() is
+ * called.  The first append allocates a new sequence, which is then bound to the I/O channel.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param dst Destination to copy to.
+ * \param src Source to copy from.
+ * \param nbytes Length in bytes to copy.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_copy(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			   void *dst, void *src, uint64_t nbytes, int flags,
+			   spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a fill operation to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param dst Destination to fill.
+ * \param fill Constant byte to fill to the destination.
+ * \param nbytes Length in bytes to fill.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_fill(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			   void *dst, uint8_t fill, uint64_t nbytes, int flags,
+			   spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a CRC-32C calculation to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param crc_dst Destination to write the CRC-32C to.
+ * \param src The source address for the data.
+ * \param seed Four byte seed value.
+ * \param nbytes Length in bytes.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_crc32c(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			     uint32_t *crc_dst, void *src, uint32_t seed, uint64_t nbytes,
+			     spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a compress operation to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param dst Destination to compress to.
+ * \param src Source to read from.
+ * \param nbytes_dst Length in bytes of output buffer.
+ * \param nbytes_src Length in bytes of input buffer.
+ * \param output_size The size of the compressed data.
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_compress(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			       void *dst, void *src, uint64_t nbytes_dst, uint64_t nbytes_src,
+			       uint32_t *output_size, int flags,
+			       spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a decompress operation to a sequence.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param dst Destination. Must be large enough to hold decompressed data.
+ * \param src Source to read from.
+ * \param nbytes_dst Length in bytes of output buffer.
+ * \param nbytes_src Length in bytes of input buffer.
+ * \param flags Flags, optional flags that can vary per operation.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_decompress(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+				 void *dst, void *src, uint64_t nbytes_dst, uint64_t nbytes_src,
+				 int flags, spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append an encrypt operation to a sequence.  See spdk_accel_submit_encrypt() for the
+ * description of the parameters.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param key Key to encrypt with.
+ * \param dst_iovs Destination I/O vector array.  Must stay valid until the step is done.
+ * \param dst_iovcnt Size of the destination I/O vector array.
+ * \param src_iovs Source I/O vector array.  Must stay valid until the step is done.
+ * \param src_iovcnt Size of the source I/O vector array.
+ * \param iv Initialization vector (tweak) of the first block.
+ * \param block_size Size of a data unit in bytes.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_encrypt(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			      struct spdk_accel_crypto_key *key,
+			      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			      struct iovec *src_iovs, uint32_t src_iovcnt,
+			      uint64_t iv, uint32_t block_size, int flags,
+			      spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a decrypt operation to a sequence.  See spdk_accel_submit_decrypt() for the
+ * description of the parameters.
+ *
+ * \param seq Sequence object.  If NULL, a new sequence object will be created.
+ * \param ch I/O channel associated with this call.
+ * \param key Key to decrypt with.
+ * \param dst_iovs Destination I/O vector array.  Must stay valid until the step is done.
+ * \param dst_iovcnt Size of the destination I/O vector array.
+ * \param src_iovs Source I/O vector array.  Must stay valid until the step is done.
+ * \param src_iovcnt Size of the source I/O vector array.
+ * \param iv Initialization vector (tweak) of the first block.
+ * \param block_size Size of a data unit in bytes.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation is done.  Optional.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_append_decrypt(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			      struct spdk_accel_crypto_key *key,
+			      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			      struct iovec *src_iovs, uint32_t src_iovcnt,
+			      uint64_t iv, uint32_t block_size, int flags,
+			      spdk_accel_step_cb cb_fn, void *cb_arg);
+
+/**
+ * Execute the operations of a sequence.
+ *
+ * Consecutive operations assigned to the same engine are handed to it together when the
+ * engine executes them in order.  Copies to or from buffers obtained with
+ * spdk_accel_get_buf() are removed from the sequence whenever the neighbouring operation
+ * can read or write the data in place.  The sequence object is released once the callback
+ * is executed and can't be used afterwards.
+ *
+ * \param seq Sequence to execute.
+ * \param cb_fn Called when all the operations are done or any of them failed.
+ * \param cb_arg Callback argument.
+ */
+void spdk_accel_sequence_finish(struct spdk_accel_sequence *seq,
+				spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Reverse the order of the operations of a sequence.
+ *
+ * This is used to put operations in front of the ones already appended, e.g. by a bdev
+ * module which needs to read the data before the operations of a sequence it received
+ * with a read request are executed.
+ *
+ * \param seq Sequence to reverse.
+ */
+void spdk_accel_sequence_reverse(struct spdk_accel_sequence *seq);
+
+/**
+ * Abort a sequence without executing its operations.  The step callbacks of all the
+ * operations are executed and the sequence object is released.
+ *
+ * \param seq Sequence to abort.
+ */
+void spdk_accel_sequence_abort(struct spdk_accel_sequence *seq);
+
+/**
+ * Start a batch of operations.
+ *
+ * Operations appended to a batch aren't executed until spdk_accel_batch_submit() is called,
+ * which hands all the operations assigned to an engine to it at once, e.g. so that they're
+ * submitted to the hardware with a single batch descriptor.  Unlike the steps of a sequence,
+ * the operations don't depend on each other and may be executed in any order.
+ *
+ * \param ch I/O channel associated with this call.
+ *
+ * \return Batch object, or NULL if the channel ran out of them.
+ */
+struct spdk_accel_batch *spdk_accel_batch_begin(struct spdk_io_channel *ch);
+
+/**
+ * Append a copy operation to a batch.  See spdk_accel_submit_copy() for the description
+ * of the parameters.
+ *
+ * \param batch Batch object.
+ * \param dst Destination to copy to.
+ * \param src Source to copy from.
+ * \param nbytes Length in bytes to copy.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.  The batch is left intact on failure.
+ */
+int spdk_accel_batch_append_copy(struct spdk_accel_batch *batch, void *dst, void *src,
+				 uint64_t nbytes, int flags, spdk_accel_completion_cb cb_fn,
+				 void *cb_arg);
+
+/**
+ * Append a fill operation to a batch.  See spdk_accel_submit_fill() for the description
+ * of the parameters.
+ *
+ * \param batch Batch object.
+ * \param dst Destination to fill.
+ * \param fill Constant byte to fill to the destination.
+ * \param nbytes Length in bytes to fill.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.  The batch is left intact on failure.
+ */
+int spdk_accel_batch_append_fill(struct spdk_accel_batch *batch, void *dst, uint8_t fill,
+				 uint64_t nbytes, int flags, spdk_accel_completion_cb cb_fn,
+				 void *cb_arg);
+
+/**
+ * Append a compare operation to a batch.  See spdk_accel_submit_compare() for the
+ * description of the parameters.
+ *
+ * \param batch Batch object.
+ * \param src1 First location to perform compare on.
+ * \param src2 Second location to perform compare on.
+ * \param nbytes Length in bytes to compare.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.  The batch is left intact on failure.
+ */
+int spdk_accel_batch_append_compare(struct spdk_accel_batch *batch, void *src1, void *src2,
+				    uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a CRC-32C calculation to a batch.  See spdk_accel_submit_crc32c() for the
+ * description of the parameters.
+ *
+ * \param batch Batch object.
+ * \param crc_dst Destination to write the CRC-32C to.
+ * \param src The source address for the data.
+ * \param seed Four byte seed value.
+ * \param nbytes Length in bytes.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.  The batch is left intact on failure.
+ */
+int spdk_accel_batch_append_crc32c(struct spdk_accel_batch *batch, uint32_t *crc_dst,
+				   void *src, uint32_t seed, uint64_t nbytes,
+				   spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Append a copy with CRC-32C calculation to a batch.  See spdk_accel_submit_copy_crc32c()
+ * for the description of the parameters.
+ *
+ * \param batch Batch object.
+ * \param dst Destination to write the data to.
+ * \param src The source address for the data.
+ * \param crc_dst Destination to write the CRC-32C to.
+ * \param seed Four byte seed value.
+ * \param nbytes Length in bytes.
+ * \param flags Accel framework flags for operations.
+ * \param cb_fn Called when this operation completes.
+ * \param cb_arg Callback argument.
+ *
+ * \return 0 on success, negative errno on failure.  The batch is left intact on failure.
+ */
+int spdk_accel_batch_append_copy_crc32c(struct spdk_accel_batch *batch, void *dst, void *src,
+					uint32_t *crc_dst, uint32_t seed, uint64_t nbytes,
+					int flags, spdk_accel_completion_cb cb_fn, void *cb_arg);
+
+/**
+ * Submit the operations of a batch.  The callback of each operation is executed once it
+ * completes, and failures of the submission are reported through them as well.  The batch
+ * object is released by this call and can't be used afterwards.
+ *
+ * \param batch Batch to submit.
+ */
+void spdk_accel_batch_submit(struct spdk_accel_batch *batch);
+
+/**
+ * Abort a batch without executing its operations.  The callbacks of all the operations
+ * are executed with -ECANCELED and the batch object is released.
+ *
+ * \param batch Batch to abort.
+ */
+void spdk_accel_batch_abort(struct spdk_accel_batch *batch);
+
+/**
+ * Get a data buffer from the acceleration framework.
+ *
+ * Such buffers are meant to hold intermediate results of a sequence.  Copies of their
+ * data may be removed from a sequence, so their contents are undefined once the sequence
+ * is done.
+ *
+ * \param ch I/O channel associated with this call.
+ * \param len Length of the buffer in bytes.
+ * \param buf Pointer to update with the buffer.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_accel_get_buf(struct spdk_io_channel *ch, uint64_t len, void **buf);
+
+/**
+ * Release a data buffer obtained with spdk_accel_get_buf().
+ *
+ * \param ch I/O channel the buffer was obtained from.
+ * \param buf Buffer to release.
+ */
+void spdk_accel_put_buf(struct spdk_io_channel *ch, void *buf);
+
 /**
  * Return the name of the engine assigned to a specfic opcode.
  *
@@ -82,6 +82,7 @@ struct spdk_bdev_io;
 
 struct spdk_bdev_fn_table;
 struct spdk_io_channel;
+struct spdk_accel_sequence;
 struct spdk_json_write_ctx;
 struct spdk_uuid;
 
@@ -158,6 +159,38 @@ struct spdk_bdev_io_stat {
 	uint64_t write_latency_ticks;
 	uint64_t unmap_latency_ticks;
 	uint64_t ticks_rate;
+
+	/** Number of I/Os which had to wait because no small data buffer was available. */
+	uint64_t num_small_buf_waits;
+	/** Number of I/Os which had to wait because no large data buffer was available. */
+	uint64_t num_large_buf_waits;
+};
+
+/**
+ * I/O types for which every bdev channel tracks a latency distribution.
+ */
+enum spdk_bdev_latency_io_type {
+	SPDK_BDEV_LATENCY_IO_TYPE_READ = 0,
+	SPDK_BDEV_LATENCY_IO_TYPE_WRITE,
+	SPDK_BDEV_LATENCY_IO_TYPE_UNMAP,
+	SPDK_BDEV_LATENCY_IO_TYPE_FLUSH,
+	SPDK_BDEV_LATENCY_IO_TYPE_ZCOPY,
+	SPDK_BDEV_NUM_LATENCY_IO_TYPES
+};
+
+struct spdk_bdev_io_latency {
+	/** Number of successfully completed I/Os. */
+	uint64_t num_ios;
+	/** Lowest latency in ticks. Valid only if num_ios is non-zero. */
+	uint64_t min_ticks;
+	/** Highest latency in ticks. */
+	uint64_t max_ticks;
+	/** Latency histogram in ticks. NULL until the first I/O completes. */
+	struct spdk_histogram_data *histogram;
+};
+
+struct spdk_bdev_latency_stat {
+	struct spdk_bdev_io_latency io_type[SPDK_BDEV_NUM_LATENCY_IO_TYPES];
 };
 
 struct spdk_bdev_opts {
@@ -178,8 +211,16 @@ struct spdk_bdev_opts {
 
 	uint32_t small_buf_pool_size;
 	uint32_t large_buf_pool_size;
+
+	/**
+	 * Maximum number of small and large data buffers cached by each thread. The
+	 * caches are further limited to the pool size divided by twice the number of
+	 * cores. Zero disables the per-thread data buffer cache.
+	 */
+	uint32_t small_buf_cache_size;
+	uint32_t large_buf_cache_size;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 32, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 40, "Incorrect size");
 
 /**
  * Structure with optional IO request parameters
@@ -197,8 +238,15 @@ struct spdk_bdev_ext_io_opts {
 	void *memory_domain_ctx;
 	/** Metadata buffer, optional */
 	void *metadata;
+	/**
+	 * Sequence of accel operations to execute on the data buffers of this IO request,
+	 * optional.  The operations are executed before the data is written, or after it's
+	 * read.  The sequence is either handed down to the bdev module, if it supports it, or
+	 * executed by the bdev layer.  Can't be used together with memory domains.
+	 */
+	struct spdk_accel_sequence *accel_sequence;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 32, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_ext_io_opts) == 40, "Incorrect size");
 
 /**
  * Get the options for the bdev module.
@@ -248,6 +296,8 @@ typedef void (*spdk_bdev_init_cb)(void *cb_arg, int rc);
 typedef void (*spdk_bdev_fini_cb)(void *cb_arg);
 typedef void (*spdk_bdev_get_device_stat_cb)(struct spdk_bdev *bdev,
 		struct spdk_bdev_io_stat *stat, void *cb_arg, int rc);
+typedef void (*spdk_bdev_get_device_latency_stat_cb)(struct spdk_bdev *bdev,
+		struct spdk_bdev_latency_stat *stat, void *cb_arg, int rc);
 
 /**
  * Block device channel IO timeout callback
@@ -1741,6 +1791,32 @@ void spdk_bdev_get_io_stat(struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 void spdk_bdev_get_device_stat(struct spdk_bdev *bdev, struct spdk_bdev_io_stat *stat,
 			       spdk_bdev_get_device_stat_cb cb, void *cb_arg);
 
+/**
+ * Return latency statistics for this bdev, merged from all of its channels. All the
+ * required information will be passed via the callback function.
+ *
+ * The histograms in stat are allocated as needed and must be released by
+ * spdk_bdev_latency_stat_clear() after the callback is executed.
+ *
+ * \param bdev Block device to query.
+ * \param stat Zero-initialized structure for aggregating collected statistics.
+ * Passed as argument to cb.
+ * \param reset Reset latency statistics of the bdev and all of its channels after
+ * collecting them.
+ * \param cb Called when this operation completes.
+ * \param cb_arg Argument passed to callback function.
+ */
+void spdk_bdev_get_device_latency_stat(struct spdk_bdev *bdev,
+				       struct spdk_bdev_latency_stat *stat, bool reset,
+				       spdk_bdev_get_device_latency_stat_cb cb, void *cb_arg);
+
+/**
+ * Release the histograms held by latency statistics and zero them.
+ *
+ * \param stat Latency statistics to clear.
+ */
+void spdk_bdev_latency_stat_clear(struct spdk_bdev_latency_stat *stat);
+
 /**
  * Get the status of bdev_io as an NVMe status code and command specific
  * completion queue value.
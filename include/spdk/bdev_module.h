@@ -242,6 +242,13 @@ struct spdk_bdev_fn_table {
 	 * Vbdev module must inspect types of memory domains returned by base bdev and report only those
 	 * memory domains that it can work with. */
 	int (*get_memory_domains)(void *ctx, struct spdk_memory_domain **domains, int array_size);
+
+	/**
+	 * Check if the bdev executes accel sequences passed with I/O of a specific type.  Optional
+	 * - may be NULL, in which case the sequences are executed by the bdev layer.  The sequence
+	 * of an I/O is passed in ext_opts->accel_sequence and must be finished by the module.
+	 */
+	bool (*accel_sequence_supported)(void *ctx, enum spdk_bdev_io_type type);
 };
 
 /** bdev I/O completion status */
@@ -330,6 +337,15 @@ struct spdk_bdev {
 	 */
 	bool split_on_optimal_io_boundary;
 
+	/**
+	 * Specifies whether the write_unit_size is mandatory or
+	 * only advisory. If set to true, the bdev layer will split
+	 * WRITE I/O that span the write_unit_size before submitting
+	 * them to the bdev module. For WRITE I/O this takes precedence
+	 * over split_on_optimal_io_boundary.
+	 */
+	bool split_on_write_unit;
+
 	/**
 	 * Optimal I/O boundary in blocks, or 0 for no value reported.
 	 */
@@ -502,6 +518,9 @@ struct spdk_bdev {
 		/** accumulated I/O statistics for previously deleted channels of this bdev */
 		struct spdk_bdev_io_stat stat;
 
+		/** accumulated latency statistics for previously deleted channels of this bdev */
+		struct spdk_bdev_latency_stat latency_stat;
+
 		/** true if tracking the queue_depth of a device is in progress */
 		bool	qd_poll_in_progress;
 
@@ -759,6 +778,9 @@ struct spdk_bdev_io {
 		/** Copy of user's opts, used when I/O is split */
 		struct spdk_bdev_ext_io_opts ext_opts_copy;
 
+		/** Accel sequence executed by the bdev layer on behalf of the bdev module */
+		struct spdk_accel_sequence *accel_sequence;
+
 		/** Data transfer completion callback */
 		void (*data_transfer_cpl)(void *ctx, int rc);
 	} internal;
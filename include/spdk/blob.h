@@ -241,8 +241,28 @@ struct spdk_bs_opts {
 
 	/** Force recovery during import. This is a uint64_t for padding reasons, treated as a bool. */
 	uint64_t force_recover;
+
+	/**
+	 * Allocate clusters of thin clones without copying the whole cluster from the parent on
+	 * first write. Written io_units are tracked in a per-cluster bitmap persisted in extent
+	 * pages and the remaining ones are read from the parent until the cluster is compacted.
+	 * Only applies to blobs using extent table. This is a uint64_t for padding reasons,
+	 * treated as a bool.
+	 */
+	uint64_t sub_cluster_cow;
+
+	/**
+	 * Count of the number of pages reserved for the metadata journal. Thin provisioned
+	 * cluster allocations are logged to the journal and written back to blob metadata
+	 * in the background, instead of rewriting the metadata on every allocation.
+	 * Only used during spdk_bs_init(), 0 disables the journal.
+	 */
+	uint32_t md_journal_pages;
+
+	/* Hole at bytes 84-87. */
+	uint8_t reserved84[4];
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 72, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
 
 /**
  * Initialize a spdk_bs_opts structure to the default blobstore option values.
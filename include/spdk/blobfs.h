@@ -348,6 +348,51 @@ int spdk_fs_set_cache_size(uint64_t size_in_mb);
  */
 uint64_t spdk_fs_get_cache_size(void);
 
+/**
+ * Statistics of the cache shared by all blobstore filesystems.
+ */
+struct spdk_fs_cache_stats {
+	/** Number of reads served from a cache buffer. */
+	uint64_t hits;
+
+	/** Number of reads which had to be served from the blobstore. */
+	uint64_t misses;
+
+	/** Number of cache buffers evicted to make room for new data. */
+	uint64_t evictions;
+
+	/** Number of misses on buffers recently evicted after being accessed once. */
+	uint64_t recent_ghost_hits;
+
+	/** Number of misses on buffers recently evicted after being accessed repeatedly. */
+	uint64_t frequent_ghost_hits;
+
+	/** Number of cache buffers filled by readahead. */
+	uint64_t readahead_buffers;
+
+	/** Number of cache buffers filled by readahead and evicted before being read. */
+	uint64_t readahead_unused;
+
+	/** Number of cached buffers accessed once. */
+	uint64_t recent_buffers;
+
+	/** Number of cached buffers accessed repeatedly. */
+	uint64_t frequent_buffers;
+
+	/** Adaptive target number of cached buffers accessed once. */
+	uint64_t target_recent_buffers;
+
+	/** Total number of cache buffers. */
+	uint64_t total_buffers;
+};
+
+/**
+ * Get statistics of the blobstore filesystem cache.
+ *
+ * \param stats Filled with the current cache statistics.
+ */
+void spdk_fs_get_cache_stats(struct spdk_fs_cache_stats *stats);
+
 #define SPDK_FILE_PRIORITY_LOW	0 /* default */
 #define SPDK_FILE_PRIORITY_HIGH	1
 
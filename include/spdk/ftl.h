@@ -37,6 +37,10 @@ struct spdk_ftl_conf {
 	/* Percentage of base device blocks not exposed to the user */
 	uint64_t				overprovisioning;
 
+	/* Maximum amount of DRAM (in MiB) the L2P cache may use. If 0 (the default),
+	 * the whole L2P is kept in DRAM and no L2P cache is used */
+	size_t					l2p_dram_limit;
+
 	/* Core mask - core thread plus additional relocation threads */
 	char					*core_mask;
 
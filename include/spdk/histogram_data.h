@@ -179,6 +179,60 @@ spdk_histogram_data_iterate(const struct spdk_histogram_data *histogram,
 	}
 }
 
+/**
+ * Get an upper bound of the given percentile of the datapoints tallied in the histogram.
+ *
+ * The returned value is the last datapoint covered by the bucket containing the requested
+ * percentile, so its precision is limited by the bucket granularity of the histogram.
+ *
+ * \param histogram Histogram to query.
+ * \param percentile Percentile to look up, in the range of 0 to 100.
+ *
+ * \return upper bound of the percentile, or 0 if the histogram is empty.
+ */
+static inline uint64_t
+spdk_histogram_data_get_percentile(const struct spdk_histogram_data *histogram,
+				   double percentile)
+{
+	uint64_t i, j, so_far, total, target;
+	double rank;
+
+	total = 0;
+
+	for (i = 0; i < SPDK_HISTOGRAM_NUM_BUCKETS(histogram); i++) {
+		total += histogram->bucket[i];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	rank = total * percentile / 100.0;
+	target = (uint64_t)rank;
+	if ((double)target < rank) {
+		target++;
+	}
+
+	if (target == 0) {
+		target = 1;
+	} else if (target > total) {
+		target = total;
+	}
+
+	so_far = 0;
+
+	for (i = 0; i < SPDK_HISTOGRAM_NUM_BUCKET_RANGES(histogram); i++) {
+		for (j = 0; j < SPDK_HISTOGRAM_NUM_BUCKETS_PER_RANGE(histogram); j++) {
+			so_far += __spdk_histogram_get_count(histogram, i, j);
+			if (so_far >= target) {
+				return __spdk_histogram_data_get_bucket_start(histogram, i, j) - 1;
+			}
+		}
+	}
+
+	return UINT64_MAX;
+}
+
 static inline void
 spdk_histogram_data_merge(const struct spdk_histogram_data *dst,
 			  const struct spdk_histogram_data *src)
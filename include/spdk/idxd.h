@@ -332,6 +332,18 @@ int spdk_idxd_submit_raw_desc(struct spdk_idxd_io_channel *chan,
  */
 int spdk_idxd_process_events(struct spdk_idxd_io_channel *chan);
 
+/**
+ * Submit the operations built up on an IDXD channel to the hardware.
+ *
+ * Operations submitted to a channel are collected in a batch descriptor, which is otherwise
+ * only submitted once it's full or by the next spdk_idxd_process_events() call.
+ *
+ * \param chan IDXD channel to flush.
+ * \return 0 on success, -EBUSY if the channel is out of descriptors, in which case the
+ * operations are submitted by a later spdk_idxd_process_events() call.
+ */
+int spdk_idxd_flush(struct spdk_idxd_io_channel *chan);
+
 /**
  * Returns an IDXD channel for a given IDXD device.
  *
@@ -44,6 +44,20 @@ struct spdk_reduce_vol_params {
 	 */
 	uint32_t		chunk_size;
 
+	/**
+	 * Compression algorithm identifier, interpreted by the owner of the
+	 *  backing device.  0 selects the backing device's default.  Stored
+	 *  in the superblock so the volume is always decompressed with the
+	 *  algorithm it was written with.
+	 */
+	uint16_t		comp_algo;
+
+	/**
+	 * Compression level passed along with comp_algo.  0 selects the
+	 *  algorithm's default level.
+	 */
+	int16_t			comp_level;
+
 	/**
 	 * Total size in bytes of the compressed volume.  During
 	 *  initialization, the size is calculated from the size of
@@ -196,6 +196,19 @@ struct spdk_scheduler {
 	 */
 	void (*balance)(struct spdk_scheduler_core_info *core_info, uint32_t count);
 
+	/**
+	 * Function called periodically between scheduling periods to let a scheduler
+	 * move a thread from an overloaded core to an idle one, without waiting for
+	 * the next balance. The thread to move is picked on the source core among the
+	 * threads allowed to run on the destination core. Optional.
+	 *
+	 * \param src_lcore Filled with the core to take a thread from.
+	 * \param dst_lcore Filled with the core to move the thread to.
+	 *
+	 * \return true if a thread should be moved, false otherwise.
+	 */
+	bool (*steal)(uint32_t *src_lcore, uint32_t *dst_lcore);
+
 	/**
 	 * Function to set scheduler parameters like load_limit.
 	 *
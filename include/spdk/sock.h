@@ -74,6 +74,9 @@ enum spdk_placement_mode {
 #define SPDK_TLS_VERSION_1_2 12
 #define SPDK_TLS_VERSION_1_3 13
 
+/* Minimum length of a buffer provided to the pool of a sock group */
+#define SPDK_SOCK_GROUP_BUF_MIN_LEN 64
+
 /**
  * SPDK socket implementation options.
  *
@@ -149,6 +152,53 @@ struct spdk_sock_impl_opts {
 	 * Set default PSK identity. Used by ssl socket module.
 	 */
 	char *psk_identity;
+
+	/**
+	 * Time in msec after which the receive pipe of an idle socket is released. When non-zero,
+	 * receive pipes are allocated on demand and grown under sustained traffic up to the receive
+	 * buffer size instead of being allocated at full size for every socket. 0 disables adaptive
+	 * receive pipes. Used by posix and uring socket modules.
+	 */
+	uint32_t recv_pipe_idle_timeout;
+
+	/**
+	 * Maximum size in bytes of the adaptive receive pipes of all sockets in a sock group.
+	 * Sockets receive directly into the user buffers once it's reached. 0 means no limit.
+	 * Used by posix and uring socket modules.
+	 */
+	uint64_t group_recv_pipe_limit;
+};
+
+/**
+ * SPDK socket implementation statistics.
+ *
+ * A pointer to this structure is used by spdk_sock_impl_get_stats().
+ */
+struct spdk_sock_impl_stats {
+	/**
+	 * Memory currently allocated for receive pipes, in bytes.
+	 */
+	uint64_t recv_pipe_bytes;
+
+	/**
+	 * Number of sockets that currently have a receive pipe.
+	 */
+	uint64_t recv_pipes;
+
+	/**
+	 * Number of times a receive pipe was allocated or grown.
+	 */
+	uint64_t recv_pipe_grows;
+
+	/**
+	 * Number of times a receive pipe was shrunk or released.
+	 */
+	uint64_t recv_pipe_shrinks;
+
+	/**
+	 * Number of times a receive pipe couldn't grow due to group_recv_pipe_limit.
+	 */
+	uint64_t recv_pipe_limit_hits;
 };
 
 /**
@@ -375,6 +425,27 @@ ssize_t spdk_sock_readv(struct spdk_sock *sock, struct iovec *iov, int iovcnt);
  */
 void spdk_sock_readv_async(struct spdk_sock *sock, struct spdk_sock_request *req);
 
+/**
+ * Receive the next portion of the stream from the socket into a buffer taken from the pool of
+ * its sock group. The socket must be part of a sock group. The data is read the same way as by
+ * spdk_sock_readv() into the buffer: it's received directly into the buffer unless the socket's
+ * receive pipe holds data or the buffer is too small to bypass the pipe, in which case it's
+ * copied from the pipe. Buffers provided to the kernel, such as the buffer ring of the uring
+ * implementation, are never handed out.
+ *
+ * The caller owns the returned buffer and must give it back to the pool of the sock group with
+ * spdk_sock_group_provide_buf() once it's done with the data, which allows passing it further
+ * down without copying it.
+ *
+ * \param sock Socket to receive from.
+ * \param buf Set to the buffer holding the received data.
+ * \param ctx Set to the context the buffer was provided with.
+ *
+ * \return the number of bytes received on success, 0 if the peer closed the connection, or -1
+ * on failure with errno set. ENOBUFS indicates that the pool of the sock group is empty.
+ */
+int spdk_sock_recv_next(struct spdk_sock *sock, void **buf, void **ctx);
+
 /**
  * Set the value used to specify the low water mark (in bytes) for this socket.
  *
@@ -457,6 +528,32 @@ struct spdk_sock_group *spdk_sock_group_create(void *ctx);
  */
 void *spdk_sock_group_get_ctx(struct spdk_sock_group *sock_group);
 
+/**
+ * Provide a buffer to the pool of the sock group used by spdk_sock_recv_next(). The buffer
+ * is owned by the sock group until it's handed out by spdk_sock_recv_next() or taken back
+ * with spdk_sock_group_reclaim_buf(). The pool has to be empty when the group is closed.
+ *
+ * \param group Socket group.
+ * \param buf Buffer to provide.
+ * \param len Length of the buffer, at least SPDK_SOCK_GROUP_BUF_MIN_LEN.
+ * \param ctx Context returned along with the buffer by spdk_sock_recv_next().
+ *
+ * \return 0 on success, negated errno on failure.
+ */
+int spdk_sock_group_provide_buf(struct spdk_sock_group *group, void *buf, size_t len, void *ctx);
+
+/**
+ * Take a buffer back from the pool of the sock group, e.g. to free the buffers left in the
+ * pool before closing the group.
+ *
+ * \param group Socket group.
+ * \param buf Set to the buffer, or NULL if the pool is empty.
+ * \param ctx Set to the context the buffer was provided with.
+ *
+ * \return the length of the buffer, or 0 if the pool is empty.
+ */
+size_t spdk_sock_group_reclaim_buf(struct spdk_sock_group *group, void **buf, void **ctx);
+
 
 /**
  * Add a socket to the group.
@@ -505,7 +602,8 @@ int spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events);
  *
  * \param group Group to close.
  *
- * \return 0 on success, -1 on failure.
+ * \return 0 on success, -1 on failure. errno is set to EBUSY if sockets are still part of the
+ * group or buffers are left in its pool.
  */
 int spdk_sock_group_close(struct spdk_sock_group **group);
 
@@ -544,6 +642,18 @@ int spdk_sock_impl_get_opts(const char *impl_name, struct spdk_sock_impl_opts *o
 int spdk_sock_impl_set_opts(const char *impl_name, const struct spdk_sock_impl_opts *opts,
 			    size_t len);
 
+/**
+ * Get statistics of the socket implementation.
+ *
+ * \param impl_name The socket implementation to use, such as "posix".
+ * \param stats Pointer to allocated spdk_sock_impl_stats structure that will be filled with actual values.
+ * \param len On input specifies size of passed stats structure. On return it is set to actual size that was filled with values.
+ *
+ * \return 0 on success, -1 on failure. errno is set to indicate the reason of failure.
+ */
+int spdk_sock_impl_get_stats(const char *impl_name, struct spdk_sock_impl_stats *stats,
+			     size_t *len);
+
 /**
  * Set the given sock implementation to be used a default one.
  *
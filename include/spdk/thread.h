@@ -425,6 +425,17 @@ struct spdk_thread *spdk_thread_get_by_id(uint64_t id);
 struct spdk_thread_stats {
 	uint64_t busy_tsc;
 	uint64_t idle_tsc;
+
+	/** Number of messages executed. */
+	uint64_t msg_count;
+	/** Number of samples taken of the message queue, one per batch of messages executed. */
+	uint64_t msg_samples;
+	/** Sum and maximum of the sampled message queue depths. */
+	uint64_t msg_queue_depth_total;
+	uint64_t msg_queue_depth_max;
+	/** Sum and maximum of the sampled ticks the oldest queued message waited to be executed. */
+	uint64_t msg_latency_total_tsc;
+	uint64_t msg_latency_max_tsc;
 };
 
 /**
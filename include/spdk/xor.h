@@ -0,0 +1,60 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+/**
+ * \file
+ * XOR and RAID-6 P+Q parity utility functions
+ */
+
+#ifndef SPDK_XOR_H
+#define SPDK_XOR_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Generate XOR from multiple source buffers.
+ *
+ * \param dest Destination buffer.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers in the \c sources array. Must be at least 2.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_xor_gen(void *dest, void **sources, uint32_t n, size_t len);
+
+/**
+ * Generate RAID-6 P and Q parity from multiple source buffers.
+ *
+ * P is the XOR of all sources. Q is the Reed-Solomon syndrome over GF(2^8) with the
+ * polynomial 0x11d and generator 2, where source i is multiplied by 2^i.
+ *
+ * \param p Destination buffer for P parity.
+ * \param q Destination buffer for Q parity.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers in the \c sources array. Must be at least 2.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, size_t len);
+
+/**
+ * Get the optimal buffer alignment for XOR and P+Q functions.
+ *
+ * Buffers whose addresses and length are multiples of this value can be processed with
+ * the vectorized implementation, if one is available.
+ *
+ * \return The alignment in bytes.
+ */
+size_t spdk_xor_get_optimal_alignment(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPDK_XOR_H */
@@ -14,37 +14,70 @@
 
 struct spdk_accel_task;
 
+struct spdk_accel_crypto_key {
+	uint8_t				*key;		/* data key */
+	size_t				key_size;
+	uint8_t				*key2;		/* tweak key */
+	size_t				key2_size;
+	struct spdk_accel_module_if	*module_if;	/* module the key was created for */
+	void				*priv;		/* module private data */
+};
+
 void spdk_accel_task_complete(struct spdk_accel_task *task, int status);
 
 struct spdk_accel_task {
 	struct accel_io_channel		*accel_ch;
 	spdk_accel_completion_cb	cb_fn;
 	void				*cb_arg;
+	struct spdk_accel_sequence	*seq;
+	spdk_accel_step_cb		step_cb_fn;
+	void				*step_cb_arg;
 	union {
 		struct {
 			struct iovec		*iovs; /* iovs passed by the caller */
 			uint32_t		iovcnt; /* iovcnt passed by the caller */
 		} v;
+		struct {
+			void			**srcs; /* source buffers of xor and pq_gen */
+			uint32_t		cnt;
+		} nsrcs;
 		void				*src;
 	};
 	union {
 		void			*dst;
 		void			*src2;
+		struct {
+			struct iovec		*iovs; /* destination iovs of encrypt/decrypt */
+			uint32_t		iovcnt;
+		} d;
 	};
 	union {
 		void				*dst2;
 		uint32_t			seed;
 		uint64_t			fill_pattern;
+		uint64_t			iv;
+		struct {
+			uint16_t		algo; /* enum spdk_accel_comp_algo */
+			int16_t			level;
+			uint32_t		chunk_size;
+		} comp;
 	};
 	union {
-		uint32_t		*crc_dst;
-		uint32_t		*output_size;
+		uint32_t			*crc_dst;
+		uint32_t			*output_size;
+		struct spdk_accel_crypto_key	*crypto_key;
 	};
 	enum accel_opcode		op_code;
 	uint64_t			nbytes;
-	uint64_t			nbytes_dst;
+	union {
+		uint64_t			nbytes_dst;
+		uint32_t			block_size;
+	};
 	int				flags;
 	int				status;
+	/* Set once the task is handed to the software engine in place of the assigned one */
+	bool				fallback;
+	uint64_t			submit_tsc;
 	TAILQ_ENTRY(spdk_accel_task)	link;
 };
 
@@ -78,6 +111,38 @@ struct spdk_accel_module_if {
 	struct spdk_io_channel *(*get_io_channel)(void);
 	int (*submit_tasks)(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task);
 
+	/**
+	 * Submit the tasks of a batch, linked together like for submit_tasks().  The tasks
+	 * don't depend on each other.  Optional, modules queueing their work until the next
+	 * poll use it to hand all the tasks to the hardware at once, other modules get the
+	 * tasks through submit_tasks().
+	 */
+	int (*submit_batch)(struct spdk_io_channel *ch, struct spdk_accel_task *first_task);
+
+	/**
+	 * Set by modules executing the tasks passed to submit_tasks() one after another, in
+	 * order.  Consecutive steps of a sequence assigned to such a module are submitted with
+	 * a single call.
+	 */
+	bool	ordered_tasks;
+
+	/**
+	 * Initialize the module's private data of a crypto key, e.g. expand the key schedule.
+	 * Optional, may be NULL for modules without per key state.
+	 */
+	int	(*crypto_key_init)(struct spdk_accel_crypto_key *key);
+
+	/**
+	 * Release the private data set up by crypto_key_init().
+	 */
+	void	(*crypto_key_deinit)(struct spdk_accel_crypto_key *key);
+
+	/**
+	 * Returns true if the module can compress and decompress data with the given
+	 * algorithm.  Optional, modules not defining it are assumed to support deflate only.
+	 */
+	bool	(*supports_comp_algo)(enum spdk_accel_comp_algo algo);
+
 	TAILQ_ENTRY(spdk_accel_module_if)	tailq;
 };
 
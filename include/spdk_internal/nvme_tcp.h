@@ -18,6 +18,11 @@
 #define SPDK_NVME_TCP_QPAIR_EXIT_TIMEOUT	30
 #define SPDK_NVMF_TCP_RECV_BUF_SIZE_FACTOR	8
 #define SPDK_NVME_TCP_IN_CAPSULE_DATA_MAX_SIZE	8192u
+/*
+ * Data digests of PDUs carrying less data than this are calculated inline, as for
+ * small payloads submitting them to the accel framework costs more than the CRC itself.
+ */
+#define SPDK_NVME_TCP_DDGST_ACCEL_MIN_LEN	4096u
 /*
  * Maximum number of SGL elements.
  */
@@ -175,11 +180,30 @@ nvme_tcp_pdu_calc_header_digest(struct nvme_tcp_pdu *pdu)
 	return crc32c;
 }
 
+/*
+ * Extend the CRC of the PDU's data with the padding up to the digest alignment.
+ */
+static inline uint32_t
+nvme_tcp_pdu_pad_data_digest(struct nvme_tcp_pdu *pdu, uint32_t crc32c)
+{
+	uint32_t mod;
+
+	mod = pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT;
+	if (mod != 0) {
+		uint32_t pad_length = SPDK_NVME_TCP_DIGEST_ALIGNMENT - mod;
+		uint8_t pad[3] = {0, 0, 0};
+
+		assert(pad_length > 0);
+		assert(pad_length <= sizeof(pad));
+		crc32c = spdk_crc32c_update(pad, pad_length, crc32c);
+	}
+	return crc32c;
+}
+
 static uint32_t
 nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
 {
 	uint32_t crc32c = SPDK_CRC32C_XOR;
-	uint32_t mod;
 
 	assert(pdu->data_len != 0);
 
@@ -190,16 +214,19 @@ nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
 					      0, pdu->data_len, &crc32c, pdu->dif_ctx);
 	}
 
-	mod = pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT;
-	if (mod != 0) {
-		uint32_t pad_length = SPDK_NVME_TCP_DIGEST_ALIGNMENT - mod;
-		uint8_t pad[3] = {0, 0, 0};
+	return nvme_tcp_pdu_pad_data_digest(pdu, crc32c);
+}
 
-		assert(pad_length > 0);
-		assert(pad_length <= sizeof(pad));
-		crc32c = spdk_crc32c_update(pad, pad_length, crc32c);
-	}
-	return crc32c;
+/*
+ * Check whether the data digest of the PDU should be calculated by the accel framework.
+ * The digest of a PDU with DIF context is calculated over the data stream without the
+ * metadata, so it's always done inline. The accel framework calculates the CRC of the
+ * data only, the padding has to be added with nvme_tcp_pdu_pad_data_digest().
+ */
+static inline bool
+nvme_tcp_pdu_offload_data_digest(struct nvme_tcp_pdu *pdu)
+{
+	return !pdu->dif_ctx && pdu->data_len >= SPDK_NVME_TCP_DDGST_ACCEL_MIN_LEN;
 }
 
 static inline void
@@ -46,9 +46,17 @@ struct spdk_sock {
 	struct spdk_sock_impl_opts	impl_opts;
 };
 
+/* Header of a buffer in the pool of a sock group, stored in the buffer itself */
+struct spdk_sock_group_provided_buf {
+	size_t						len;
+	void						*ctx;
+	STAILQ_ENTRY(spdk_sock_group_provided_buf)	link;
+};
+
 struct spdk_sock_group {
-	STAILQ_HEAD(, spdk_sock_group_impl)	group_impls;
-	void					*ctx;
+	STAILQ_HEAD(, spdk_sock_group_impl)		group_impls;
+	STAILQ_HEAD(, spdk_sock_group_provided_buf)	pool;
+	void						*ctx;
 };
 
 struct spdk_sock_group_impl {
@@ -79,6 +87,7 @@ struct spdk_net_impl {
 
 	void (*writev_async)(struct spdk_sock *sock, struct spdk_sock_request *req);
 	void (*readv_async)(struct spdk_sock *sock, struct spdk_sock_request *req);
+	int (*recv_next)(struct spdk_sock *sock, void **buf, void **ctx);
 	int (*flush)(struct spdk_sock *sock);
 
 	int (*set_recvlowat)(struct spdk_sock *sock, int nbytes);
@@ -100,12 +109,40 @@ struct spdk_net_impl {
 
 	int (*get_opts)(struct spdk_sock_impl_opts *opts, size_t *len);
 	int (*set_opts)(const struct spdk_sock_impl_opts *opts, size_t len);
+	int (*get_stats)(struct spdk_sock_impl_stats *stats, size_t *len);
 
 	STAILQ_ENTRY(spdk_net_impl) link;
 };
 
 void spdk_net_impl_register(struct spdk_net_impl *impl, int priority);
 
+/**
+ * Take a buffer out of the pool of the sock group.
+ *
+ * \param group Socket group.
+ * \param buf Set to the buffer, or NULL if the pool is empty.
+ * \param ctx Set to the context the buffer was provided with.
+ *
+ * \return the length of the buffer, or 0 if the pool is empty.
+ */
+static inline size_t
+spdk_sock_group_get_buf(struct spdk_sock_group *group, void **buf, void **ctx)
+{
+	struct spdk_sock_group_provided_buf *provided;
+
+	provided = STAILQ_FIRST(&group->pool);
+	if (provided == NULL) {
+		*buf = NULL;
+		return 0;
+	}
+	STAILQ_REMOVE_HEAD(&group->pool, link);
+
+	*buf = provided;
+	*ctx = provided->ctx;
+
+	return provided->len;
+}
+
 #define SPDK_NET_IMPL_REGISTER(name, impl, priority) \
 static void __attribute__((constructor)) net_impl_register_##name(void) \
 { \
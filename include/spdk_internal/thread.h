@@ -11,9 +11,19 @@
 
 struct spdk_poller;
 
+/*
+ * Number of buckets in the poller run time histogram.  Bucket i counts the runs which
+ * took from 2^i to 2^(i+1) - 1 ticks.  Bucket 0 also counts runs which took no ticks and
+ * the last bucket counts all runs longer than it covers.
+ */
+#define SPDK_POLLER_RUN_TIME_BUCKETS	32
+
 struct spdk_poller_stats {
 	uint64_t	run_count;
 	uint64_t	busy_count;
+	uint64_t	total_run_ticks;
+	uint64_t	max_run_ticks;
+	uint64_t	run_time_histogram[SPDK_POLLER_RUN_TIME_BUCKETS];
 };
 
 struct io_device;
@@ -26,11 +26,19 @@
 
 #define ALIGN_4K			0x1000
 #define MAX_TASKS_PER_CHANNEL		0x800
+#define MAX_CACHED_BUFS_PER_CHANNEL	32
+#define MAX_BATCHES_PER_CHANNEL		64
+
+/* Latency histograms use 16 buckets per power of two, which keeps the relative error of
+ * reported percentiles within ~6%.
+ */
+#define ACCEL_LATENCY_HISTOGRAM_BUCKET_SHIFT	4
 
 /* Largest context size for all accel modules */
 static size_t g_max_accel_module_size = sizeof(struct spdk_accel_task);
 
 static struct spdk_accel_module_if *g_accel_engine_module = NULL;
+static struct spdk_accel_module_if *g_sw_engine_module = NULL;
 static spdk_accel_fini_cb g_fini_cb_fn = NULL;
 static void *g_fini_cb_arg = NULL;
 static bool g_engine_started = false;
@@ -43,12 +51,55 @@ static TAILQ_HEAD(, spdk_accel_module_if) spdk_accel_module_list =
 static struct spdk_accel_module_if *g_engines_opc[ACCEL_OPC_LAST] = {};
 static char *g_engines_opc_override[ACCEL_OPC_LAST] = {};
 
+struct accel_buffer {
+	void				*buf;
+	uint64_t			len;
+	TAILQ_ENTRY(accel_buffer)	link;
+};
+
+TAILQ_HEAD(accel_sequence_tasks, spdk_accel_task);
+
+struct spdk_accel_sequence {
+	struct accel_io_channel			*ch;
+	/* Steps waiting to be executed */
+	struct accel_sequence_tasks		tasks;
+	/* Steps removed from the sequence, their callbacks are executed once it's done */
+	struct accel_sequence_tasks		elided;
+	uint32_t				num_running;
+	int					status;
+	spdk_accel_completion_cb		cb_fn;
+	void					*cb_arg;
+	TAILQ_ENTRY(spdk_accel_sequence)	link;
+};
+
+struct spdk_accel_batch {
+	struct accel_io_channel			*ch;
+	struct accel_sequence_tasks		tasks;
+	TAILQ_ENTRY(spdk_accel_batch)		link;
+};
+
 struct accel_io_channel {
-	struct spdk_io_channel		*engine_ch[ACCEL_OPC_LAST];
-	void				*task_pool_base;
-	TAILQ_HEAD(, spdk_accel_task)	task_pool;
+	struct spdk_io_channel			*engine_ch[ACCEL_OPC_LAST];
+	/* Software engine channel taking over tasks failed by the other engines */
+	struct spdk_io_channel			*sw_ch;
+	void					*task_pool_base;
+	TAILQ_HEAD(, spdk_accel_task)		task_pool;
+	void					*seq_pool_base;
+	TAILQ_HEAD(, spdk_accel_sequence)	seq_pool;
+	void					*batch_pool_base;
+	TAILQ_HEAD(, spdk_accel_batch)		batch_pool;
+	TAILQ_HEAD(, accel_buffer)		buf_cache;
+	TAILQ_HEAD(, accel_buffer)		bufs_in_use;
+	uint32_t				num_cached_bufs;
+	struct accel_stats			stats;
 };
 
+/* Statistics of the channels that were already destroyed */
+static struct accel_stats g_stats;
+static pthread_mutex_t g_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void accel_sequence_task_cb(struct spdk_accel_task *task, int status);
+
 int
 spdk_accel_get_opc_engine_name(enum accel_opcode opcode, const char **engine_name)
 {
@@ -106,6 +157,110 @@ spdk_accel_assign_opc(enum accel_opcode opcode, const char *name)
 	return 0;
 }
 
+static void
+accel_update_comp_stats(struct accel_io_channel *accel_ch, struct spdk_accel_task *accel_task,
+			int status)
+{
+	struct accel_comp_stats *stats;
+	enum accel_comp_dir dir;
+
+	dir = accel_task->op_code == ACCEL_OPC_COMPRESS ? ACCEL_COMP_DIR_COMPRESS :
+	      ACCEL_COMP_DIR_DECOMPRESS;
+	stats = &accel_ch->stats.comp[accel_task->comp.algo][dir];
+	stats->total_tsc += spdk_get_ticks() - accel_task->submit_tsc;
+	if (spdk_unlikely(status != 0)) {
+		stats->num_failed++;
+		return;
+	}
+
+	stats->num_ops++;
+	stats->bytes_in += accel_task->nbytes;
+	if (accel_task->output_size != NULL) {
+		stats->bytes_out += *accel_task->output_size;
+	}
+}
+
+static void
+accel_update_opc_stats(struct accel_io_channel *accel_ch, struct spdk_accel_task *accel_task,
+		       int status)
+{
+	struct accel_opc_stats *stats = &accel_ch->stats.opc[accel_task->op_code];
+	uint64_t tsc;
+
+	if (spdk_unlikely(status != 0)) {
+		stats->num_failed++;
+		return;
+	}
+
+	tsc = spdk_get_ticks() - accel_task->submit_tsc;
+	if (stats->num_completed == 0 || tsc < stats->min_tsc) {
+		stats->min_tsc = tsc;
+	}
+	if (tsc > stats->max_tsc) {
+		stats->max_tsc = tsc;
+	}
+	stats->num_completed++;
+	stats->bytes += accel_task->nbytes;
+
+	if (spdk_unlikely(stats->histogram == NULL)) {
+		stats->histogram = spdk_histogram_data_alloc_sized(ACCEL_LATENCY_HISTOGRAM_BUCKET_SHIFT);
+		if (stats->histogram == NULL) {
+			return;
+		}
+	}
+
+	spdk_histogram_data_tally(stats->histogram, tsc);
+}
+
+static bool
+accel_task_can_fallback(struct accel_io_channel *accel_ch, struct spdk_accel_task *accel_task)
+{
+	struct spdk_accel_module_if *sw_engine = g_sw_engine_module;
+
+	if (accel_ch->sw_ch == NULL || accel_task->fallback ||
+	    g_engines_opc[accel_task->op_code] == sw_engine ||
+	    !sw_engine->supports_opcode(accel_task->op_code)) {
+		return false;
+	}
+
+	switch (accel_task->op_code) {
+	case ACCEL_OPC_ENCRYPT:
+	case ACCEL_OPC_DECRYPT:
+		/* Crypto keys are initialized for the engine assigned to the opcode */
+		return false;
+	case ACCEL_OPC_COMPRESS:
+	case ACCEL_OPC_DECOMPRESS:
+		return sw_engine->supports_comp_algo != NULL &&
+		       sw_engine->supports_comp_algo(accel_task->comp.algo);
+	default:
+		return true;
+	}
+}
+
+/* Hand tasks the engine assigned to their opcode failed to execute over to the software
+ * engine.  Either all the linked tasks are taken over or none of them.
+ */
+static int
+accel_submit_fallback(struct accel_io_channel *accel_ch, struct spdk_accel_task *first_task)
+{
+	struct spdk_accel_task *accel_task;
+
+	for (accel_task = first_task; accel_task != NULL;
+	     accel_task = TAILQ_NEXT(accel_task, link)) {
+		if (!accel_task_can_fallback(accel_ch, accel_task)) {
+			return -ENOTSUP;
+		}
+	}
+
+	for (accel_task = first_task; accel_task != NULL;
+	     accel_task = TAILQ_NEXT(accel_task, link)) {
+		accel_task->fallback = true;
+		accel_ch->stats.opc[accel_task->op_code].num_fallbacks++;
+	}
+
+	return g_sw_engine_module->submit_tasks(accel_ch->sw_ch, first_task);
+}
+
 void
 spdk_accel_task_complete(struct spdk_accel_task *accel_task, int status)
 {
@@ -113,6 +268,28 @@ spdk_accel_task_complete(struct spdk_accel_task *accel_task, int status)
 	spdk_accel_completion_cb	cb_fn = accel_task->cb_fn;
 	void				*cb_arg = accel_task->cb_arg;
 
+	/* Engines running out of descriptors or queue slots is transient, the software engine
+	 * can still execute the task.
+	 */
+	if (spdk_unlikely(status == -ENOMEM || status == -EBUSY || status == -EAGAIN) &&
+	    accel_task_can_fallback(accel_ch, accel_task)) {
+		accel_task->link.tqe_next = NULL;
+		if (accel_submit_fallback(accel_ch, accel_task) == 0) {
+			return;
+		}
+	}
+
+	accel_update_opc_stats(accel_ch, accel_task, status);
+	if (accel_task->op_code == ACCEL_OPC_COMPRESS ||
+	    accel_task->op_code == ACCEL_OPC_DECOMPRESS) {
+		accel_update_comp_stats(accel_ch, accel_task, status);
+	}
+
+	if (accel_task->seq != NULL) {
+		accel_sequence_task_cb(accel_task, status);
+		return;
+	}
+
 	/* We should put the accel_task into the list firstly in order to avoid
 	 * the accel task list is exhausted when there is recursive call to
 	 * allocate accel_task in user's call back function (cb_fn)
@@ -128,7 +305,8 @@ _get_task(struct accel_io_channel *accel_ch, spdk_accel_completion_cb cb_fn, voi
 	struct spdk_accel_task *accel_task;
 
 	accel_task = TAILQ_FIRST(&accel_ch->task_pool);
-	if (accel_task == NULL) {
+	if (spdk_unlikely(accel_task == NULL)) {
+		accel_ch->stats.num_task_exhausted++;
 		return NULL;
 	}
 
@@ -139,11 +317,35 @@ _get_task(struct accel_io_channel *accel_ch, spdk_accel_completion_cb cb_fn, voi
 	accel_task->cb_fn = cb_fn;
 	accel_task->cb_arg = cb_arg;
 	accel_task->accel_ch = accel_ch;
+	accel_task->seq = NULL;
+	accel_task->fallback = false;
 
 	return accel_task;
 }
 
+static int
+accel_submit_task(struct accel_io_channel *accel_ch, struct spdk_accel_task *accel_task)
+{
+	enum accel_opcode opcode = accel_task->op_code;
+	struct spdk_accel_module_if *engine = g_engines_opc[opcode];
+	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[opcode];
+	int rc;
+
+	accel_task->submit_tsc = spdk_get_ticks();
+	accel_ch->stats.opc[opcode].num_submitted++;
+
+	rc = engine->submit_tasks(engine_ch, accel_task);
+	if (spdk_unlikely(rc != 0)) {
+		if (accel_submit_fallback(accel_ch, accel_task) == 0) {
+			return 0;
+		}
+
+		accel_ch->stats.opc[opcode].num_failed++;
+		TAILQ_INSERT_HEAD(&accel_ch->task_pool, accel_task, link);
+	}
 
+	return rc;
+}
 
 /* Accel framework public API for copy function */
 int
@@ -152,8 +354,6 @@ spdk_accel_submit_copy(struct spdk_io_channel *ch, void *dst, void *src,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_COPY];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_COPY];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -166,7 +366,7 @@ spdk_accel_submit_copy(struct spdk_io_channel *ch, void *dst, void *src,
 	accel_task->nbytes = nbytes;
 	accel_task->flags = flags;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for dual cast copy function */
@@ -177,8 +377,6 @@ spdk_accel_submit_dualcast(struct spdk_io_channel *ch, void *dst1,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_DUALCAST];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_DUALCAST];
 
 	if ((uintptr_t)dst1 & (ALIGN_4K - 1) || (uintptr_t)dst2 & (ALIGN_4K - 1)) {
 		SPDK_ERRLOG("Dualcast requires 4K alignment on dst addresses\n");
@@ -197,7 +395,7 @@ spdk_accel_submit_dualcast(struct spdk_io_channel *ch, void *dst1,
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_DUALCAST;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for compare function */
@@ -208,8 +406,6 @@ spdk_accel_submit_compare(struct spdk_io_channel *ch, void *src1,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_COMPARE];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_COMPARE];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -221,7 +417,7 @@ spdk_accel_submit_compare(struct spdk_io_channel *ch, void *src1,
 	accel_task->nbytes = nbytes;
 	accel_task->op_code = ACCEL_OPC_COMPARE;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for fill function */
@@ -232,8 +428,6 @@ spdk_accel_submit_fill(struct spdk_io_channel *ch, void *dst,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_FILL];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_FILL];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -246,7 +440,7 @@ spdk_accel_submit_fill(struct spdk_io_channel *ch, void *dst,
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_FILL;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for CRC-32C function */
@@ -257,8 +451,6 @@ spdk_accel_submit_crc32c(struct spdk_io_channel *ch, uint32_t *crc_dst,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_CRC32C];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_CRC32C];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -272,7 +464,7 @@ spdk_accel_submit_crc32c(struct spdk_io_channel *ch, uint32_t *crc_dst,
 	accel_task->nbytes = nbytes;
 	accel_task->op_code = ACCEL_OPC_CRC32C;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for chained CRC-32C function */
@@ -283,8 +475,6 @@ spdk_accel_submit_crc32cv(struct spdk_io_channel *ch, uint32_t *crc_dst,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_CRC32C];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_CRC32C];
 
 	if (iov == NULL) {
 		SPDK_ERRLOG("iov should not be NULL");
@@ -309,7 +499,7 @@ spdk_accel_submit_crc32cv(struct spdk_io_channel *ch, uint32_t *crc_dst,
 	accel_task->seed = seed;
 	accel_task->op_code = ACCEL_OPC_CRC32C;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for copy with CRC-32C function */
@@ -320,8 +510,6 @@ spdk_accel_submit_copy_crc32c(struct spdk_io_channel *ch, void *dst,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_COPY_CRC32C];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_COPY_CRC32C];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -337,7 +525,7 @@ spdk_accel_submit_copy_crc32c(struct spdk_io_channel *ch, void *dst,
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_COPY_CRC32C;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 /* Accel framework public API for chained copy + CRC-32C function */
@@ -348,8 +536,6 @@ spdk_accel_submit_copy_crc32cv(struct spdk_io_channel *ch, void *dst,
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_COPY_CRC32C];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_COPY_CRC32C];
 	uint64_t nbytes;
 	uint32_t i;
 
@@ -384,7 +570,64 @@ spdk_accel_submit_copy_crc32cv(struct spdk_io_channel *ch, void *dst,
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_COPY_CRC32C;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+static int
+accel_task_set_comp_opts(struct spdk_accel_task *accel_task, const struct spdk_accel_comp_opts *opts)
+{
+	enum spdk_accel_comp_algo algo = SPDK_ACCEL_COMP_ALGO_DEFLATE;
+	int32_t level = 0;
+	uint32_t chunk_size = 0;
+
+	if (opts != NULL) {
+#define FIELD_OK(field) \
+	offsetof(struct spdk_accel_comp_opts, field) + sizeof(opts->field) <= opts->size
+
+		if (FIELD_OK(algo)) {
+			algo = opts->algo;
+		}
+		if (FIELD_OK(level)) {
+			level = opts->level;
+		}
+		if (FIELD_OK(chunk_size)) {
+			chunk_size = opts->chunk_size;
+		}
+#undef FIELD_OK
+	}
+
+	if (algo >= SPDK_ACCEL_COMP_ALGO_LAST || level < INT16_MIN || level > INT16_MAX) {
+		return -EINVAL;
+	}
+
+	accel_task->comp.algo = algo;
+	accel_task->comp.level = level;
+	accel_task->comp.chunk_size = chunk_size;
+
+	return 0;
+}
+
+static int
+accel_check_comp_algo(enum accel_opcode opcode, enum spdk_accel_comp_algo algo)
+{
+	struct spdk_accel_module_if *engine = g_engines_opc[opcode];
+
+	if (engine->supports_comp_algo == NULL) {
+		return algo == SPDK_ACCEL_COMP_ALGO_DEFLATE ? 0 : -ENOTSUP;
+	}
+
+	return engine->supports_comp_algo(algo) ? 0 : -ENOTSUP;
+}
+
+bool
+spdk_accel_comp_algo_supported(enum spdk_accel_comp_algo algo)
+{
+	if (algo >= SPDK_ACCEL_COMP_ALGO_LAST) {
+		return false;
+	}
+
+	return accel_check_comp_algo(ACCEL_OPC_COMPRESS, algo) == 0 &&
+	       accel_check_comp_algo(ACCEL_OPC_DECOMPRESS, algo) == 0;
 }
 
 int
@@ -394,8 +637,6 @@ spdk_accel_submit_compress(struct spdk_io_channel *ch, void *dst, void *src, uin
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_COMPRESS];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_COMPRESS];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
@@ -404,15 +645,14 @@ spdk_accel_submit_compress(struct spdk_io_channel *ch, void *dst, void *src, uin
 
 	accel_task->output_size = output_size;
 	accel_task->src = src;
+	accel_task->v.iovcnt = 0;
 	accel_task->dst = dst;
 	accel_task->nbytes = nbytes_src;
 	accel_task->nbytes_dst = nbytes_dst;
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_COMPRESS;
-
-	return engine->submit_tasks(engine_ch, accel_task);
-
-	return 0;
+	accel_task_set_comp_opts(accel_task, NULL);
+	return accel_submit_task(accel_ch, accel_task);
 }
 
 int
@@ -421,126 +661,1418 @@ spdk_accel_submit_decompress(struct spdk_io_channel *ch, void *dst, void *src, u
 {
 	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *accel_task;
-	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_DECOMPRESS];
-	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[ACCEL_OPC_DECOMPRESS];
 
 	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
 	if (accel_task == NULL) {
 		return -ENOMEM;
 	}
 
+	accel_task->output_size = NULL;
 	accel_task->src = src;
+	accel_task->v.iovcnt = 0;
 	accel_task->dst = dst;
 	accel_task->nbytes = nbytes_src;
 	accel_task->nbytes_dst = nbytes_dst;
 	accel_task->flags = flags;
 	accel_task->op_code = ACCEL_OPC_DECOMPRESS;
+	accel_task_set_comp_opts(accel_task, NULL);
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+static int
+accel_submit_comp_ext(struct spdk_io_channel *ch, enum accel_opcode opcode,
+		      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		      struct iovec *src_iovs, uint32_t src_iovcnt, uint32_t *output_size,
+		      const struct spdk_accel_comp_opts *opts, int flags,
+		      spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+	uint32_t i;
+	int rc;
 
-	return engine->submit_tasks(engine_ch, accel_task);
+	if (src_iovs == NULL || src_iovcnt == 0 || dst_iovs == NULL || dst_iovcnt == 0) {
+		return -EINVAL;
+	}
 
-	return 0;
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (accel_task == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = accel_task_set_comp_opts(accel_task, opts);
+	if (spdk_unlikely(rc != 0)) {
+		TAILQ_INSERT_HEAD(&accel_ch->task_pool, accel_task, link);
+		return rc;
+	}
+
+	rc = accel_check_comp_algo(opcode, accel_task->comp.algo);
+	if (spdk_unlikely(rc != 0)) {
+		TAILQ_INSERT_HEAD(&accel_ch->task_pool, accel_task, link);
+		return rc;
+	}
+
+	accel_task->output_size = output_size;
+	accel_task->v.iovs = src_iovs;
+	accel_task->v.iovcnt = src_iovcnt;
+	accel_task->d.iovs = dst_iovs;
+	accel_task->d.iovcnt = dst_iovcnt;
+	accel_task->nbytes = 0;
+	for (i = 0; i < src_iovcnt; i++) {
+		accel_task->nbytes += src_iovs[i].iov_len;
+	}
+	accel_task->flags = flags;
+	accel_task->op_code = opcode;
+	return accel_submit_task(accel_ch, accel_task);
 }
 
+int
+spdk_accel_submit_compress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+			       uint32_t dst_iovcnt, struct iovec *src_iovs, uint32_t src_iovcnt,
+			       uint32_t *output_size, const struct spdk_accel_comp_opts *opts,
+			       int flags, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	return accel_submit_comp_ext(ch, ACCEL_OPC_COMPRESS, dst_iovs, dst_iovcnt, src_iovs,
+				     src_iovcnt, output_size, opts, flags, cb_fn, cb_arg);
+}
 
-static struct spdk_accel_module_if *
-_module_find_by_name(const char *name)
+int
+spdk_accel_submit_decompress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				 uint32_t dst_iovcnt, struct iovec *src_iovs, uint32_t src_iovcnt,
+				 uint32_t *output_size, const struct spdk_accel_comp_opts *opts,
+				 int flags, spdk_accel_completion_cb cb_fn, void *cb_arg)
 {
-	struct spdk_accel_module_if *accel_module = NULL;
+	return accel_submit_comp_ext(ch, ACCEL_OPC_DECOMPRESS, dst_iovs, dst_iovcnt, src_iovs,
+				     src_iovcnt, output_size, opts, flags, cb_fn, cb_arg);
+}
 
-	TAILQ_FOREACH(accel_module, &spdk_accel_module_list, tailq) {
-		if (strcmp(name, accel_module->name) == 0) {
-			break;
-		}
+/* Accel framework public API for xor function */
+int
+spdk_accel_submit_xor(struct spdk_io_channel *ch, void *dst, void **sources, uint32_t nsrcs,
+		      uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+
+	if (sources == NULL || nsrcs < 2) {
+		SPDK_ERRLOG("xor requires at least 2 sources\n");
+		return -EINVAL;
 	}
 
-	return accel_module;
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (accel_task == NULL) {
+		return -ENOMEM;
+	}
+
+	accel_task->nsrcs.srcs = sources;
+	accel_task->nsrcs.cnt = nsrcs;
+	accel_task->dst = dst;
+	accel_task->nbytes = nbytes;
+	accel_task->op_code = ACCEL_OPC_XOR;
+
+	return accel_submit_task(accel_ch, accel_task);
 }
 
-/* Helper function when when accel modules register with the framework. */
-void
-spdk_accel_module_list_add(struct spdk_accel_module_if *accel_module)
+/* Accel framework public API for P+Q parity generation function */
+int
+spdk_accel_submit_pq_gen(struct spdk_io_channel *ch, void *p, void *q, void **sources,
+			 uint32_t nsrcs, uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
 {
-	if (_module_find_by_name(accel_module->name)) {
-		SPDK_NOTICELOG("Accel module %s already registered\n", accel_module->name);
-		assert(false);
-		return;
-	}
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
 
-	/* Make sure that the software module is at the head of the list, this
-	 * will assure that all opcodes are later assigned to software first and
-	 * then udpated to HW engines as they are registered.
-	 */
-	if (strcmp(accel_module->name, "software") == 0) {
-		TAILQ_INSERT_HEAD(&spdk_accel_module_list, accel_module, tailq);
-	} else {
-		TAILQ_INSERT_TAIL(&spdk_accel_module_list, accel_module, tailq);
+	if (sources == NULL || nsrcs < 2) {
+		SPDK_ERRLOG("pq_gen requires at least 2 sources\n");
+		return -EINVAL;
 	}
 
-	if (accel_module->get_ctx_size && accel_module->get_ctx_size() > g_max_accel_module_size) {
-		g_max_accel_module_size = accel_module->get_ctx_size();
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (accel_task == NULL) {
+		return -ENOMEM;
 	}
+
+	accel_task->nsrcs.srcs = sources;
+	accel_task->nsrcs.cnt = nsrcs;
+	accel_task->dst = p;
+	accel_task->dst2 = q;
+	accel_task->nbytes = nbytes;
+	accel_task->op_code = ACCEL_OPC_PQ_GEN;
+
+	return accel_submit_task(accel_ch, accel_task);
 }
 
-/* Framework level channel create callback. */
-static int
-accel_engine_create_cb(void *io_device, void *ctx_buf)
+int
+spdk_accel_crypto_key_create(const struct spdk_accel_crypto_key_create_param *param,
+			     struct spdk_accel_crypto_key **_key)
 {
-	struct accel_io_channel	*accel_ch = ctx_buf;
-	struct spdk_accel_task *accel_task;
-	uint8_t *task_mem;
-	int i, j;
+	struct spdk_accel_module_if *engine = g_engines_opc[ACCEL_OPC_ENCRYPT];
+	struct spdk_accel_crypto_key *key;
+	int rc;
 
-	accel_ch->task_pool_base = calloc(MAX_TASKS_PER_CHANNEL, g_max_accel_module_size);
-	if (accel_ch->task_pool_base == NULL) {
+	if (engine == NULL || engine != g_engines_opc[ACCEL_OPC_DECRYPT]) {
+		SPDK_ERRLOG("Encrypt and decrypt must be assigned to the same engine\n");
+		return -EINVAL;
+	}
+
+	if (param->cipher == NULL || strcmp(param->cipher, ACCEL_AES_XTS) != 0) {
+		SPDK_ERRLOG("Unsupported cipher %s\n", param->cipher ? param->cipher : "(null)");
+		return -EINVAL;
+	}
+
+	if (param->key == NULL || param->key_size == 0 ||
+	    param->key2 == NULL || param->key2_size == 0) {
+		SPDK_ERRLOG("Both the data and the tweak key are required\n");
+		return -EINVAL;
+	}
+
+	key = calloc(1, sizeof(*key));
+	if (key == NULL) {
 		return -ENOMEM;
 	}
 
-	TAILQ_INIT(&accel_ch->task_pool);
-	task_mem = accel_ch->task_pool_base;
-	for (i = 0 ; i < MAX_TASKS_PER_CHANNEL; i++) {
-		accel_task = (struct spdk_accel_task *)task_mem;
-		TAILQ_INSERT_TAIL(&accel_ch->task_pool, accel_task, link);
-		task_mem += g_max_accel_module_size;
+	key->key = malloc(param->key_size);
+	key->key2 = malloc(param->key2_size);
+	if (key->key == NULL || key->key2 == NULL) {
+		free(key->key);
+		free(key->key2);
+		free(key);
+		return -ENOMEM;
 	}
 
-	/* Assign engines and get IO channels for each */
-	for (i = 0; i < ACCEL_OPC_LAST; i++) {
-		accel_ch->engine_ch[i] = g_engines_opc[i]->get_io_channel();
-		/* This can happen if idxd runs out of channels. */
-		if (accel_ch->engine_ch[i] == NULL) {
-			goto err;
+	memcpy(key->key, param->key, param->key_size);
+	key->key_size = param->key_size;
+	memcpy(key->key2, param->key2, param->key2_size);
+	key->key2_size = param->key2_size;
+	key->module_if = engine;
+
+	if (engine->crypto_key_init != NULL) {
+		rc = engine->crypto_key_init(key);
+		if (rc != 0) {
+			SPDK_ERRLOG("Engine %s failed to initialize the key: %d\n",
+				    engine->name, rc);
+			key->module_if = NULL;
+			spdk_accel_crypto_key_destroy(key);
+			return rc;
 		}
 	}
 
+	*_key = key;
+
 	return 0;
-err:
-	for (j = 0; j < i; j++) {
-		spdk_put_io_channel(accel_ch->engine_ch[j]);
+}
+
+void
+spdk_accel_crypto_key_destroy(struct spdk_accel_crypto_key *key)
+{
+	if (key == NULL) {
+		return;
 	}
-	free(accel_ch->task_pool_base);
-	return -ENOMEM;
+
+	if (key->module_if != NULL && key->module_if->crypto_key_deinit != NULL) {
+		key->module_if->crypto_key_deinit(key);
+	}
+
+	memset(key->key, 0, key->key_size);
+	free(key->key);
+	memset(key->key2, 0, key->key2_size);
+	free(key->key2);
+	free(key);
 }
 
-/* Framework level channel destroy callback. */
 static void
-accel_engine_destroy_cb(void *io_device, void *ctx_buf)
+accel_task_set_crypto(struct spdk_accel_task *accel_task, struct spdk_accel_crypto_key *key,
+		      struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		      struct iovec *src_iovs, uint32_t src_iovcnt,
+		      uint64_t iv, uint32_t block_size, int flags)
 {
-	struct accel_io_channel	*accel_ch = ctx_buf;
-	int i;
+	accel_task->crypto_key = key;
+	accel_task->v.iovs = src_iovs;
+	accel_task->v.iovcnt = src_iovcnt;
+	accel_task->d.iovs = dst_iovs;
+	accel_task->d.iovcnt = dst_iovcnt;
+	accel_task->iv = iv;
+	accel_task->block_size = block_size;
+	accel_task->flags = flags;
+}
 
-	for (i = 0; i < ACCEL_OPC_LAST; i++) {
-		assert(accel_ch->engine_ch[i] != NULL);
-		spdk_put_io_channel(accel_ch->engine_ch[i]);
-		accel_ch->engine_ch[i] = NULL;
+static int
+accel_check_crypto(enum accel_opcode opcode, struct spdk_accel_crypto_key *key,
+		   uint32_t block_size)
+{
+	if (spdk_unlikely(key == NULL || key->module_if != g_engines_opc[opcode])) {
+		SPDK_ERRLOG("Crypto key doesn't belong to the engine assigned to opcode %d\n",
+			    opcode);
+		return -EINVAL;
 	}
 
-	free(accel_ch->task_pool_base);
+	if (spdk_unlikely(block_size == 0)) {
+		return -EINVAL;
+	}
+
+	return 0;
 }
 
-struct spdk_io_channel *
-spdk_accel_engine_get_io_channel(void)
+/* Accel framework public API for encrypt function */
+int
+spdk_accel_submit_encrypt(struct spdk_io_channel *ch, struct spdk_accel_crypto_key *key,
+			  struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct iovec *src_iovs, uint32_t src_iovcnt,
+			  uint64_t iv, uint32_t block_size, int flags,
+			  spdk_accel_completion_cb cb_fn, void *cb_arg)
 {
-	return spdk_get_io_channel(&spdk_accel_module_list);
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+	int rc;
+
+	rc = accel_check_crypto(ACCEL_OPC_ENCRYPT, key, block_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (accel_task == NULL) {
+		return -ENOMEM;
+	}
+
+	accel_task_set_crypto(accel_task, key, dst_iovs, dst_iovcnt, src_iovs, src_iovcnt,
+			      iv, block_size, flags);
+	accel_task->op_code = ACCEL_OPC_ENCRYPT;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+/* Accel framework public API for decrypt function */
+int
+spdk_accel_submit_decrypt(struct spdk_io_channel *ch, struct spdk_accel_crypto_key *key,
+			  struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct iovec *src_iovs, uint32_t src_iovcnt,
+			  uint64_t iv, uint32_t block_size, int flags,
+			  spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *accel_task;
+	int rc;
+
+	rc = accel_check_crypto(ACCEL_OPC_DECRYPT, key, block_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	accel_task = _get_task(accel_ch, cb_fn, cb_arg);
+	if (accel_task == NULL) {
+		return -ENOMEM;
+	}
+
+	accel_task_set_crypto(accel_task, key, dst_iovs, dst_iovcnt, src_iovs, src_iovcnt,
+			      iv, block_size, flags);
+	accel_task->op_code = ACCEL_OPC_DECRYPT;
+
+	return accel_submit_task(accel_ch, accel_task);
+}
+
+static struct spdk_accel_sequence *
+accel_sequence_get(struct accel_io_channel *accel_ch)
+{
+	struct spdk_accel_sequence *seq;
+
+	seq = TAILQ_FIRST(&accel_ch->seq_pool);
+	if (seq == NULL) {
+		return NULL;
+	}
+
+	TAILQ_REMOVE(&accel_ch->seq_pool, seq, link);
+	TAILQ_INIT(&seq->tasks);
+	TAILQ_INIT(&seq->elided);
+	seq->ch = accel_ch;
+	seq->num_running = 0;
+	seq->status = 0;
+	seq->cb_fn = NULL;
+	seq->cb_arg = NULL;
+
+	return seq;
+}
+
+static void
+accel_sequence_put_tasks(struct accel_sequence_tasks *tasks)
+{
+	struct spdk_accel_task *task;
+	spdk_accel_step_cb cb_fn;
+	void *cb_arg;
+
+	while ((task = TAILQ_FIRST(tasks))) {
+		TAILQ_REMOVE(tasks, task, link);
+		cb_fn = task->step_cb_fn;
+		cb_arg = task->step_cb_arg;
+		TAILQ_INSERT_HEAD(&task->accel_ch->task_pool, task, link);
+		if (cb_fn != NULL) {
+			cb_fn(cb_arg);
+		}
+	}
+}
+
+static void
+accel_sequence_put(struct spdk_accel_sequence *seq)
+{
+	assert(seq->num_running == 0);
+
+	accel_sequence_put_tasks(&seq->elided);
+	/* Let the owners of the steps which weren't executed release their resources */
+	accel_sequence_put_tasks(&seq->tasks);
+
+	TAILQ_INSERT_HEAD(&seq->ch->seq_pool, seq, link);
+}
+
+static struct spdk_accel_task *
+accel_sequence_get_task(struct accel_io_channel *accel_ch, struct spdk_accel_sequence **pseq,
+			spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct spdk_accel_sequence *seq = *pseq;
+	struct spdk_accel_task *task;
+
+	if (seq == NULL) {
+		seq = accel_sequence_get(accel_ch);
+		if (seq == NULL) {
+			return NULL;
+		}
+	}
+
+	assert(seq->ch == accel_ch);
+	task = _get_task(accel_ch, NULL, NULL);
+	if (task == NULL) {
+		if (*pseq == NULL) {
+			TAILQ_INSERT_HEAD(&accel_ch->seq_pool, seq, link);
+		}
+		return NULL;
+	}
+
+	task->seq = seq;
+	task->step_cb_fn = cb_fn;
+	task->step_cb_arg = cb_arg;
+	task->flags = 0;
+	TAILQ_INSERT_TAIL(&seq->tasks, task, link);
+	*pseq = seq;
+
+	return task;
+}
+
+int
+spdk_accel_append_copy(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+		       void *dst, void *src, uint64_t nbytes, int flags,
+		       spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->dst = dst;
+	task->src = src;
+	task->nbytes = nbytes;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_COPY;
+
+	return 0;
+}
+
+int
+spdk_accel_append_fill(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+		       void *dst, uint8_t fill, uint64_t nbytes, int flags,
+		       spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->dst = dst;
+	memset(&task->fill_pattern, fill, sizeof(uint64_t));
+	task->nbytes = nbytes;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_FILL;
+
+	return 0;
+}
+
+int
+spdk_accel_append_crc32c(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			 uint32_t *crc_dst, void *src, uint32_t seed, uint64_t nbytes,
+			 spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->crc_dst = crc_dst;
+	task->src = src;
+	task->v.iovcnt = 0;
+	task->seed = seed;
+	task->nbytes = nbytes;
+	task->op_code = ACCEL_OPC_CRC32C;
+
+	return 0;
+}
+
+int
+spdk_accel_append_compress(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			   void *dst, void *src, uint64_t nbytes_dst, uint64_t nbytes_src,
+			   uint32_t *output_size, int flags, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->output_size = output_size;
+	task->src = src;
+	task->v.iovcnt = 0;
+	task->dst = dst;
+	task->nbytes = nbytes_src;
+	task->nbytes_dst = nbytes_dst;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_COMPRESS;
+	accel_task_set_comp_opts(task, NULL);
+
+	return 0;
+}
+
+int
+spdk_accel_append_decompress(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			     void *dst, void *src, uint64_t nbytes_dst, uint64_t nbytes_src,
+			     int flags, spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->output_size = NULL;
+	task->src = src;
+	task->v.iovcnt = 0;
+	task->dst = dst;
+	task->nbytes = nbytes_src;
+	task->nbytes_dst = nbytes_dst;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_DECOMPRESS;
+	accel_task_set_comp_opts(task, NULL);
+
+	return 0;
+}
+
+int
+spdk_accel_append_encrypt(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			  struct spdk_accel_crypto_key *key,
+			  struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct iovec *src_iovs, uint32_t src_iovcnt,
+			  uint64_t iv, uint32_t block_size, int flags,
+			  spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	int rc;
+
+	rc = accel_check_crypto(ACCEL_OPC_ENCRYPT, key, block_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	accel_task_set_crypto(task, key, dst_iovs, dst_iovcnt, src_iovs, src_iovcnt,
+			      iv, block_size, flags);
+	task->op_code = ACCEL_OPC_ENCRYPT;
+
+	return 0;
+}
+
+int
+spdk_accel_append_decrypt(struct spdk_accel_sequence **seq, struct spdk_io_channel *ch,
+			  struct spdk_accel_crypto_key *key,
+			  struct iovec *dst_iovs, uint32_t dst_iovcnt,
+			  struct iovec *src_iovs, uint32_t src_iovcnt,
+			  uint64_t iv, uint32_t block_size, int flags,
+			  spdk_accel_step_cb cb_fn, void *cb_arg)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *task;
+	int rc;
+
+	rc = accel_check_crypto(ACCEL_OPC_DECRYPT, key, block_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	task = accel_sequence_get_task(accel_ch, seq, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	accel_task_set_crypto(task, key, dst_iovs, dst_iovcnt, src_iovs, src_iovcnt,
+			      iv, block_size, flags);
+	task->op_code = ACCEL_OPC_DECRYPT;
+
+	return 0;
+}
+
+static struct accel_buffer *
+accel_find_buf(struct accel_io_channel *accel_ch, void *buf)
+{
+	struct accel_buffer *accel_buf;
+
+	TAILQ_FOREACH(accel_buf, &accel_ch->bufs_in_use, link) {
+		if (accel_buf->buf == buf) {
+			return accel_buf;
+		}
+	}
+
+	return NULL;
+}
+
+int
+spdk_accel_get_buf(struct spdk_io_channel *ch, uint64_t len, void **buf)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct accel_buffer *accel_buf;
+
+	TAILQ_FOREACH(accel_buf, &accel_ch->buf_cache, link) {
+		if (accel_buf->len >= len) {
+			break;
+		}
+	}
+
+	if (accel_buf != NULL) {
+		TAILQ_REMOVE(&accel_ch->buf_cache, accel_buf, link);
+		accel_ch->num_cached_bufs--;
+	} else {
+		accel_buf = calloc(1, sizeof(*accel_buf));
+		if (accel_buf == NULL) {
+			return -ENOMEM;
+		}
+
+		accel_buf->buf = spdk_malloc(len, ALIGN_4K, NULL, SPDK_ENV_LCORE_ID_ANY,
+					     SPDK_MALLOC_DMA);
+		if (accel_buf->buf == NULL) {
+			free(accel_buf);
+			return -ENOMEM;
+		}
+		accel_buf->len = len;
+	}
+
+	TAILQ_INSERT_HEAD(&accel_ch->bufs_in_use, accel_buf, link);
+	*buf = accel_buf->buf;
+
+	return 0;
+}
+
+static void
+accel_free_buf(struct accel_buffer *accel_buf)
+{
+	spdk_free(accel_buf->buf);
+	free(accel_buf);
+}
+
+void
+spdk_accel_put_buf(struct spdk_io_channel *ch, void *buf)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct accel_buffer *accel_buf;
+
+	accel_buf = accel_find_buf(accel_ch, buf);
+	if (accel_buf == NULL) {
+		SPDK_ERRLOG("Buffer %p wasn't obtained from the accel framework\n", buf);
+		assert(0);
+		return;
+	}
+
+	TAILQ_REMOVE(&accel_ch->bufs_in_use, accel_buf, link);
+	if (accel_ch->num_cached_bufs < MAX_CACHED_BUFS_PER_CHANNEL) {
+		TAILQ_INSERT_HEAD(&accel_ch->buf_cache, accel_buf, link);
+		accel_ch->num_cached_bufs++;
+	} else {
+		accel_free_buf(accel_buf);
+	}
+}
+
+/* Returns the buffer a sequence step writes its output to */
+static void *
+accel_task_get_dst(struct spdk_accel_task *task, uint64_t *len)
+{
+	switch (task->op_code) {
+	case ACCEL_OPC_COPY:
+	case ACCEL_OPC_FILL:
+		*len = task->nbytes;
+		return task->dst;
+	case ACCEL_OPC_DECOMPRESS:
+		*len = task->nbytes_dst;
+		return task->dst;
+	default:
+		*len = 0;
+		return NULL;
+	}
+}
+
+/* Returns the buffer a sequence step reads its input from */
+static void *
+accel_task_get_src(struct spdk_accel_task *task, uint64_t *len)
+{
+	switch (task->op_code) {
+	case ACCEL_OPC_COPY:
+	case ACCEL_OPC_CRC32C:
+	case ACCEL_OPC_COMPRESS:
+	case ACCEL_OPC_DECOMPRESS:
+		*len = task->nbytes;
+		return task->src;
+	default:
+		*len = 0;
+		return NULL;
+	}
+}
+
+static uint32_t
+accel_iovs_get_buf_refs(struct iovec *iovs, uint32_t iovcnt, void *buf)
+{
+	uint32_t i, refs = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (iovs[i].iov_base == buf) {
+			refs++;
+		}
+	}
+
+	return refs;
+}
+
+static uint32_t
+accel_sequence_get_buf_refs(struct spdk_accel_sequence *seq, void *buf)
+{
+	struct spdk_accel_task *task;
+	uint32_t refs = 0;
+	uint64_t len;
+
+	TAILQ_FOREACH(task, &seq->tasks, link) {
+		/* Steps using iovs can't be redirected to other buffers, but their references
+		 * still keep the copies around
+		 */
+		if (task->op_code == ACCEL_OPC_ENCRYPT || task->op_code == ACCEL_OPC_DECRYPT) {
+			refs += accel_iovs_get_buf_refs(task->v.iovs, task->v.iovcnt, buf);
+			refs += accel_iovs_get_buf_refs(task->d.iovs, task->d.iovcnt, buf);
+			continue;
+		}
+		if (accel_task_get_dst(task, &len) == buf) {
+			refs++;
+		}
+		if (accel_task_get_src(task, &len) == buf) {
+			refs++;
+		}
+	}
+
+	return refs;
+}
+
+/* Checks whether a copy only moves data between a framework buffer and the step next to it,
+ * which can then read or write the data in place.
+ */
+static bool
+accel_sequence_elide_copy(struct spdk_accel_sequence *seq, struct spdk_accel_task *task)
+{
+	struct spdk_accel_task *prev, *next;
+	uint64_t len;
+
+	if (task->op_code != ACCEL_OPC_COPY || task->flags != 0) {
+		return false;
+	}
+
+	prev = TAILQ_PREV(task, accel_sequence_tasks, link);
+	if (prev != NULL && accel_task_get_dst(prev, &len) == task->src && len == task->nbytes &&
+	    accel_find_buf(seq->ch, task->src) != NULL &&
+	    accel_sequence_get_buf_refs(seq, task->src) == 2) {
+		prev->dst = task->dst;
+		return true;
+	}
+
+	next = TAILQ_NEXT(task, link);
+	if (next != NULL && accel_task_get_src(next, &len) == task->dst && len == task->nbytes &&
+	    accel_find_buf(seq->ch, task->dst) != NULL &&
+	    accel_sequence_get_buf_refs(seq, task->dst) == 2) {
+		next->src = task->src;
+		return true;
+	}
+
+	return false;
+}
+
+static void
+accel_sequence_merge_tasks(struct spdk_accel_sequence *seq)
+{
+	struct spdk_accel_task *task, *tmp;
+
+	TAILQ_FOREACH_SAFE(task, &seq->tasks, link, tmp) {
+		if (accel_sequence_elide_copy(seq, task)) {
+			TAILQ_REMOVE(&seq->tasks, task, link);
+			TAILQ_INSERT_TAIL(&seq->elided, task, link);
+		}
+	}
+}
+
+static void
+accel_sequence_complete(struct spdk_accel_sequence *seq)
+{
+	spdk_accel_completion_cb cb_fn = seq->cb_fn;
+	void *cb_arg = seq->cb_arg;
+	int status = seq->status;
+
+	/* Release the sequence first, so that it can be reused from the callback */
+	accel_sequence_put(seq);
+
+	cb_fn(cb_arg, status);
+}
+
+static void
+accel_sequence_process(struct spdk_accel_sequence *seq)
+{
+	struct accel_io_channel *accel_ch = seq->ch;
+	struct accel_sequence_tasks run = TAILQ_HEAD_INITIALIZER(run);
+	struct spdk_accel_module_if *engine;
+	struct spdk_io_channel *engine_ch;
+	struct spdk_accel_task *task, *tmp;
+	uint64_t tsc;
+	int rc;
+
+	task = TAILQ_FIRST(&seq->tasks);
+	if (task == NULL) {
+		accel_sequence_complete(seq);
+		return;
+	}
+
+	tsc = spdk_get_ticks();
+
+	engine = g_engines_opc[task->op_code];
+	engine_ch = accel_ch->engine_ch[task->op_code];
+
+	/* Engines executing tasks in order are handed all their consecutive steps at once,
+	 * others get them one by one.  The tasks can't be left on the sequence's list, as the
+	 * engines link them on their own lists.
+	 */
+	do {
+		TAILQ_REMOVE(&seq->tasks, task, link);
+		TAILQ_INSERT_TAIL(&run, task, link);
+		task->submit_tsc = tsc;
+		accel_ch->stats.opc[task->op_code].num_submitted++;
+		seq->num_running++;
+
+		task = TAILQ_FIRST(&seq->tasks);
+	} while (task != NULL && engine->ordered_tasks && g_engines_opc[task->op_code] == engine &&
+		 accel_ch->engine_ch[task->op_code] == engine_ch);
+
+	rc = engine->submit_tasks(engine_ch, TAILQ_FIRST(&run));
+	if (spdk_unlikely(rc != 0)) {
+		if (accel_submit_fallback(accel_ch, TAILQ_FIRST(&run)) == 0) {
+			return;
+		}
+
+		TAILQ_FOREACH_SAFE(task, &run, link, tmp) {
+			accel_ch->stats.opc[task->op_code].num_failed++;
+			accel_sequence_task_cb(task, rc);
+		}
+	}
+}
+
+static void
+accel_sequence_task_cb(struct spdk_accel_task *task, int status)
+{
+	struct spdk_accel_sequence *seq = task->seq;
+	spdk_accel_step_cb cb_fn = task->step_cb_fn;
+	void *cb_arg = task->step_cb_arg;
+
+	if (spdk_unlikely(status != 0)) {
+		SPDK_ERRLOG("Failed to execute opcode %d of sequence %p: %d\n",
+			    task->op_code, seq, status);
+		if (seq->status == 0) {
+			seq->status = status;
+		}
+	}
+
+	TAILQ_INSERT_HEAD(&task->accel_ch->task_pool, task, link);
+	if (cb_fn != NULL) {
+		cb_fn(cb_arg);
+	}
+
+	assert(seq->num_running > 0);
+	if (--seq->num_running > 0) {
+		return;
+	}
+
+	if (spdk_unlikely(seq->status != 0)) {
+		accel_sequence_complete(seq);
+	} else {
+		accel_sequence_process(seq);
+	}
+}
+
+void
+spdk_accel_sequence_finish(struct spdk_accel_sequence *seq,
+			   spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	assert(seq->num_running == 0);
+
+	seq->cb_fn = cb_fn;
+	seq->cb_arg = cb_arg;
+
+	accel_sequence_merge_tasks(seq);
+	accel_sequence_process(seq);
+}
+
+void
+spdk_accel_sequence_reverse(struct spdk_accel_sequence *seq)
+{
+	struct accel_sequence_tasks tasks = TAILQ_HEAD_INITIALIZER(tasks);
+	struct spdk_accel_task *task;
+
+	TAILQ_SWAP(&tasks, &seq->tasks, spdk_accel_task, link);
+	while ((task = TAILQ_FIRST(&tasks))) {
+		TAILQ_REMOVE(&tasks, task, link);
+		TAILQ_INSERT_HEAD(&seq->tasks, task, link);
+	}
+}
+
+void
+spdk_accel_sequence_abort(struct spdk_accel_sequence *seq)
+{
+	if (seq == NULL) {
+		return;
+	}
+
+	accel_sequence_put(seq);
+}
+
+struct spdk_accel_batch *
+spdk_accel_batch_begin(struct spdk_io_channel *ch)
+{
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_batch *batch;
+
+	batch = TAILQ_FIRST(&accel_ch->batch_pool);
+	if (batch == NULL) {
+		return NULL;
+	}
+
+	TAILQ_REMOVE(&accel_ch->batch_pool, batch, link);
+	TAILQ_INIT(&batch->tasks);
+	batch->ch = accel_ch;
+
+	return batch;
+}
+
+static struct spdk_accel_task *
+accel_batch_get_task(struct spdk_accel_batch *batch, spdk_accel_completion_cb cb_fn,
+		     void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = _get_task(batch->ch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return NULL;
+	}
+
+	task->flags = 0;
+	TAILQ_INSERT_TAIL(&batch->tasks, task, link);
+
+	return task;
+}
+
+int
+spdk_accel_batch_append_copy(struct spdk_accel_batch *batch, void *dst, void *src,
+			     uint64_t nbytes, int flags, spdk_accel_completion_cb cb_fn,
+			     void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = accel_batch_get_task(batch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->dst = dst;
+	task->src = src;
+	task->nbytes = nbytes;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_COPY;
+
+	return 0;
+}
+
+int
+spdk_accel_batch_append_fill(struct spdk_accel_batch *batch, void *dst, uint8_t fill,
+			     uint64_t nbytes, int flags, spdk_accel_completion_cb cb_fn,
+			     void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = accel_batch_get_task(batch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->dst = dst;
+	memset(&task->fill_pattern, fill, sizeof(uint64_t));
+	task->nbytes = nbytes;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_FILL;
+
+	return 0;
+}
+
+int
+spdk_accel_batch_append_compare(struct spdk_accel_batch *batch, void *src1, void *src2,
+				uint64_t nbytes, spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = accel_batch_get_task(batch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->src = src1;
+	task->src2 = src2;
+	task->nbytes = nbytes;
+	task->op_code = ACCEL_OPC_COMPARE;
+
+	return 0;
+}
+
+int
+spdk_accel_batch_append_crc32c(struct spdk_accel_batch *batch, uint32_t *crc_dst, void *src,
+			       uint32_t seed, uint64_t nbytes, spdk_accel_completion_cb cb_fn,
+			       void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = accel_batch_get_task(batch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->crc_dst = crc_dst;
+	task->src = src;
+	task->v.iovcnt = 0;
+	task->seed = seed;
+	task->nbytes = nbytes;
+	task->op_code = ACCEL_OPC_CRC32C;
+
+	return 0;
+}
+
+int
+spdk_accel_batch_append_copy_crc32c(struct spdk_accel_batch *batch, void *dst, void *src,
+				    uint32_t *crc_dst, uint32_t seed, uint64_t nbytes, int flags,
+				    spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	struct spdk_accel_task *task;
+
+	task = accel_batch_get_task(batch, cb_fn, cb_arg);
+	if (task == NULL) {
+		return -ENOMEM;
+	}
+
+	task->dst = dst;
+	task->src = src;
+	task->crc_dst = crc_dst;
+	task->v.iovcnt = 0;
+	task->seed = seed;
+	task->nbytes = nbytes;
+	task->flags = flags;
+	task->op_code = ACCEL_OPC_COPY_CRC32C;
+
+	return 0;
+}
+
+static void
+accel_batch_submit_run(struct accel_io_channel *accel_ch, struct accel_sequence_tasks *run)
+{
+	struct spdk_accel_task *task = TAILQ_FIRST(run), *tmp;
+	struct spdk_accel_module_if *engine = g_engines_opc[task->op_code];
+	struct spdk_io_channel *engine_ch = accel_ch->engine_ch[task->op_code];
+	int rc;
+
+	if (engine->submit_batch != NULL) {
+		rc = engine->submit_batch(engine_ch, task);
+	} else {
+		rc = engine->submit_tasks(engine_ch, task);
+	}
+
+	if (spdk_unlikely(rc != 0)) {
+		if (accel_submit_fallback(accel_ch, task) == 0) {
+			return;
+		}
+
+		TAILQ_FOREACH_SAFE(task, run, link, tmp) {
+			spdk_accel_task_complete(task, rc);
+		}
+	}
+}
+
+void
+spdk_accel_batch_submit(struct spdk_accel_batch *batch)
+{
+	struct accel_io_channel *accel_ch = batch->ch;
+	struct accel_sequence_tasks tasks = TAILQ_HEAD_INITIALIZER(tasks);
+	struct accel_sequence_tasks run;
+	struct spdk_accel_module_if *engine;
+	struct spdk_io_channel *engine_ch;
+	struct spdk_accel_task *task, *tmp;
+	uint64_t tsc;
+
+	/* Release the batch first, so that it can be reused from the callbacks */
+	TAILQ_CONCAT(&tasks, &batch->tasks, link);
+	TAILQ_INSERT_HEAD(&accel_ch->batch_pool, batch, link);
+
+	tsc = spdk_get_ticks();
+
+	/* The operations don't depend on each other, so each engine is handed all of its
+	 * tasks with a single call, regardless of their order in the batch.
+	 */
+	while ((task = TAILQ_FIRST(&tasks)) != NULL) {
+		engine = g_engines_opc[task->op_code];
+		engine_ch = accel_ch->engine_ch[task->op_code];
+
+		TAILQ_INIT(&run);
+		TAILQ_FOREACH_SAFE(task, &tasks, link, tmp) {
+			if (g_engines_opc[task->op_code] != engine ||
+			    accel_ch->engine_ch[task->op_code] != engine_ch) {
+				continue;
+			}
+
+			TAILQ_REMOVE(&tasks, task, link);
+			TAILQ_INSERT_TAIL(&run, task, link);
+			task->submit_tsc = tsc;
+			accel_ch->stats.opc[task->op_code].num_submitted++;
+		}
+
+		accel_batch_submit_run(accel_ch, &run);
+	}
+}
+
+void
+spdk_accel_batch_abort(struct spdk_accel_batch *batch)
+{
+	struct accel_io_channel *accel_ch = batch->ch;
+	struct accel_sequence_tasks tasks = TAILQ_HEAD_INITIALIZER(tasks);
+	struct spdk_accel_task *task;
+
+	TAILQ_CONCAT(&tasks, &batch->tasks, link);
+	TAILQ_INSERT_HEAD(&accel_ch->batch_pool, batch, link);
+
+	while ((task = TAILQ_FIRST(&tasks)) != NULL) {
+		TAILQ_REMOVE(&tasks, task, link);
+		TAILQ_INSERT_HEAD(&accel_ch->task_pool, task, link);
+		task->cb_fn(task->cb_arg, -ECANCELED);
+	}
+}
+
+static struct spdk_accel_module_if *
+_module_find_by_name(const char *name)
+{
+	struct spdk_accel_module_if *accel_module = NULL;
+
+	TAILQ_FOREACH(accel_module, &spdk_accel_module_list, tailq) {
+		if (strcmp(name, accel_module->name) == 0) {
+			break;
+		}
+	}
+
+	return accel_module;
+}
+
+/* Helper function when when accel modules register with the framework. */
+void
+spdk_accel_module_list_add(struct spdk_accel_module_if *accel_module)
+{
+	if (_module_find_by_name(accel_module->name)) {
+		SPDK_NOTICELOG("Accel module %s already registered\n", accel_module->name);
+		assert(false);
+		return;
+	}
+
+	/* Make sure that the software module is at the head of the list, this
+	 * will assure that all opcodes are later assigned to software first and
+	 * then udpated to HW engines as they are registered.
+	 */
+	if (strcmp(accel_module->name, "software") == 0) {
+		TAILQ_INSERT_HEAD(&spdk_accel_module_list, accel_module, tailq);
+		g_sw_engine_module = accel_module;
+	} else {
+		TAILQ_INSERT_TAIL(&spdk_accel_module_list, accel_module, tailq);
+	}
+
+	if (accel_module->get_ctx_size && accel_module->get_ctx_size() > g_max_accel_module_size) {
+		g_max_accel_module_size = accel_module->get_ctx_size();
+	}
+}
+
+/* Framework level channel create callback. */
+static int
+accel_engine_create_cb(void *io_device, void *ctx_buf)
+{
+	struct accel_io_channel	*accel_ch = ctx_buf;
+	struct spdk_accel_task *accel_task;
+	struct spdk_accel_sequence *seq;
+	struct spdk_accel_batch *batch;
+	uint8_t *task_mem;
+	int i, j;
+
+	accel_ch->task_pool_base = calloc(MAX_TASKS_PER_CHANNEL, g_max_accel_module_size);
+	if (accel_ch->task_pool_base == NULL) {
+		return -ENOMEM;
+	}
+
+	/* Each sequence holds at least one task, so there's no point in having more of them */
+	accel_ch->seq_pool_base = calloc(MAX_TASKS_PER_CHANNEL, sizeof(struct spdk_accel_sequence));
+	if (accel_ch->seq_pool_base == NULL) {
+		free(accel_ch->task_pool_base);
+		return -ENOMEM;
+	}
+
+	accel_ch->batch_pool_base = calloc(MAX_BATCHES_PER_CHANNEL, sizeof(struct spdk_accel_batch));
+	if (accel_ch->batch_pool_base == NULL) {
+		free(accel_ch->seq_pool_base);
+		free(accel_ch->task_pool_base);
+		return -ENOMEM;
+	}
+
+	TAILQ_INIT(&accel_ch->task_pool);
+	task_mem = accel_ch->task_pool_base;
+	for (i = 0 ; i < MAX_TASKS_PER_CHANNEL; i++) {
+		accel_task = (struct spdk_accel_task *)task_mem;
+		TAILQ_INSERT_TAIL(&accel_ch->task_pool, accel_task, link);
+		task_mem += g_max_accel_module_size;
+	}
+
+	TAILQ_INIT(&accel_ch->seq_pool);
+	for (i = 0; i < MAX_TASKS_PER_CHANNEL; i++) {
+		seq = &((struct spdk_accel_sequence *)accel_ch->seq_pool_base)[i];
+		TAILQ_INSERT_TAIL(&accel_ch->seq_pool, seq, link);
+	}
+
+	TAILQ_INIT(&accel_ch->batch_pool);
+	for (i = 0; i < MAX_BATCHES_PER_CHANNEL; i++) {
+		batch = &((struct spdk_accel_batch *)accel_ch->batch_pool_base)[i];
+		TAILQ_INSERT_TAIL(&accel_ch->batch_pool, batch, link);
+	}
+
+	TAILQ_INIT(&accel_ch->buf_cache);
+	TAILQ_INIT(&accel_ch->bufs_in_use);
+	accel_ch->num_cached_bufs = 0;
+
+	/* Assign engines and get IO channels for each */
+	for (i = 0; i < ACCEL_OPC_LAST; i++) {
+		accel_ch->engine_ch[i] = g_engines_opc[i]->get_io_channel();
+		/* This can happen if idxd runs out of channels. */
+		if (accel_ch->engine_ch[i] == NULL) {
+			goto err;
+		}
+	}
+
+	/* Not being able to fall back isn't fatal, the tasks just fail */
+	accel_ch->sw_ch = NULL;
+	if (g_sw_engine_module != NULL) {
+		for (i = 0; i < ACCEL_OPC_LAST; i++) {
+			if (g_engines_opc[i] != g_sw_engine_module) {
+				accel_ch->sw_ch = g_sw_engine_module->get_io_channel();
+				break;
+			}
+		}
+	}
+
+	return 0;
+err:
+	for (j = 0; j < i; j++) {
+		spdk_put_io_channel(accel_ch->engine_ch[j]);
+	}
+	free(accel_ch->batch_pool_base);
+	free(accel_ch->seq_pool_base);
+	free(accel_ch->task_pool_base);
+	return -ENOMEM;
+}
+
+static void
+accel_add_opc_stats(struct accel_opc_stats *total, struct accel_opc_stats *stats)
+{
+	total->num_submitted += stats->num_submitted;
+	total->num_failed += stats->num_failed;
+	total->num_fallbacks += stats->num_fallbacks;
+
+	if (stats->num_completed == 0) {
+		return;
+	}
+
+	if (total->num_completed == 0 || stats->min_tsc < total->min_tsc) {
+		total->min_tsc = stats->min_tsc;
+	}
+	total->max_tsc = spdk_max(total->max_tsc, stats->max_tsc);
+	total->num_completed += stats->num_completed;
+	total->bytes += stats->bytes;
+
+	if (stats->histogram == NULL) {
+		return;
+	}
+
+	/* Failing to allocate the histogram only makes the percentiles less accurate */
+	if (total->histogram == NULL) {
+		total->histogram = spdk_histogram_data_alloc_sized(ACCEL_LATENCY_HISTOGRAM_BUCKET_SHIFT);
+		if (total->histogram == NULL) {
+			return;
+		}
+	}
+
+	spdk_histogram_data_merge(total->histogram, stats->histogram);
+}
+
+static void
+accel_add_stats(struct accel_stats *total, struct accel_stats *stats)
+{
+	struct accel_comp_stats *t, *s;
+	int opc, algo, dir;
+
+	for (opc = 0; opc < ACCEL_OPC_LAST; opc++) {
+		accel_add_opc_stats(&total->opc[opc], &stats->opc[opc]);
+	}
+	total->num_task_exhausted += stats->num_task_exhausted;
+
+	for (algo = 0; algo < SPDK_ACCEL_COMP_ALGO_LAST; algo++) {
+		for (dir = 0; dir < ACCEL_COMP_DIR_LAST; dir++) {
+			t = &total->comp[algo][dir];
+			s = &stats->comp[algo][dir];
+			t->num_ops += s->num_ops;
+			t->num_failed += s->num_failed;
+			t->bytes_in += s->bytes_in;
+			t->bytes_out += s->bytes_out;
+			t->total_tsc += s->total_tsc;
+		}
+	}
+}
+
+static void
+accel_free_stats(struct accel_stats *stats)
+{
+	int opc;
+
+	for (opc = 0; opc < ACCEL_OPC_LAST; opc++) {
+		spdk_histogram_data_free(stats->opc[opc].histogram);
+		stats->opc[opc].histogram = NULL;
+	}
+}
+
+/* Framework level channel destroy callback. */
+static void
+accel_engine_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct accel_io_channel	*accel_ch = ctx_buf;
+	struct accel_buffer *accel_buf;
+	int i;
+
+	for (i = 0; i < ACCEL_OPC_LAST; i++) {
+		assert(accel_ch->engine_ch[i] != NULL);
+		spdk_put_io_channel(accel_ch->engine_ch[i]);
+		accel_ch->engine_ch[i] = NULL;
+	}
+
+	if (accel_ch->sw_ch != NULL) {
+		spdk_put_io_channel(accel_ch->sw_ch);
+		accel_ch->sw_ch = NULL;
+	}
+
+	assert(TAILQ_EMPTY(&accel_ch->bufs_in_use));
+	while ((accel_buf = TAILQ_FIRST(&accel_ch->buf_cache))) {
+		TAILQ_REMOVE(&accel_ch->buf_cache, accel_buf, link);
+		accel_free_buf(accel_buf);
+	}
+
+	free(accel_ch->batch_pool_base);
+	free(accel_ch->seq_pool_base);
+	free(accel_ch->task_pool_base);
+
+	pthread_mutex_lock(&g_stats_lock);
+	accel_add_stats(&g_stats, &accel_ch->stats);
+	pthread_mutex_unlock(&g_stats_lock);
+	accel_free_stats(&accel_ch->stats);
+}
+
+struct spdk_io_channel *
+spdk_accel_engine_get_io_channel(void)
+{
+	return spdk_get_io_channel(&spdk_accel_module_list);
+}
+
+struct accel_get_stats_ctx {
+	struct accel_stats	stats;
+	_accel_get_stats_cb	cb_fn;
+	void			*cb_arg;
+};
+
+static void
+accel_get_channel_stats(struct spdk_io_channel_iter *iter)
+{
+	struct accel_get_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(iter);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(iter);
+	struct accel_io_channel *accel_ch = spdk_io_channel_get_ctx(ch);
+
+	accel_add_stats(&ctx->stats, &accel_ch->stats);
+	spdk_for_each_channel_continue(iter, 0);
+}
+
+static void
+accel_get_stats_done(struct spdk_io_channel_iter *iter, int status)
+{
+	struct accel_get_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(iter);
+
+	ctx->cb_fn(&ctx->stats, ctx->cb_arg);
+	accel_free_stats(&ctx->stats);
+	free(ctx);
+}
+
+int
+_accel_get_stats(_accel_get_stats_cb cb_fn, void *cb_arg)
+{
+	struct accel_get_stats_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	/* Take the destroyed channels' share first, a channel going away during the
+	 * iteration is then missed rather than counted twice.
+	 */
+	pthread_mutex_lock(&g_stats_lock);
+	accel_add_stats(&ctx->stats, &g_stats);
+	pthread_mutex_unlock(&g_stats_lock);
+
+	spdk_for_each_channel(&spdk_accel_module_list, accel_get_channel_stats, ctx,
+			      accel_get_stats_done);
+
+	return 0;
 }
 
 static void
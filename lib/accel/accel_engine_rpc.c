@@ -10,10 +10,11 @@
 #include "spdk/event.h"
 #include "spdk/stdinc.h"
 #include "spdk/env.h"
+#include "spdk/string.h"
 
 const char *g_opcode_strings[ACCEL_OPC_LAST] = {
 	"copy", "fill", "dualcast", "compare", "crc32c", "copy_crc32c",
-	"compress", "decompress"
+	"compress", "decompress", "xor", "pq_gen", "encrypt", "decrypt"
 };
 
 static int
@@ -187,3 +188,108 @@ cleanup:
 
 }
 SPDK_RPC_REGISTER("accel_assign_opc", rpc_accel_assign_opc, SPDK_RPC_STARTUP)
+
+static const char *g_comp_algo_strings[SPDK_ACCEL_COMP_ALGO_LAST] = {
+	"deflate", "lz4", "zstd"
+};
+
+static void
+rpc_dump_comp_stats(struct spdk_json_write_ctx *w, const char *name,
+		    struct accel_comp_stats *stats)
+{
+	spdk_json_write_named_object_begin(w, name);
+	spdk_json_write_named_uint64(w, "num_ops", stats->num_ops);
+	spdk_json_write_named_uint64(w, "num_failed", stats->num_failed);
+	spdk_json_write_named_uint64(w, "bytes_in", stats->bytes_in);
+	spdk_json_write_named_uint64(w, "bytes_out", stats->bytes_out);
+	spdk_json_write_named_uint64(w, "total_tsc", stats->total_tsc);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_dump_opc_stats(struct spdk_json_write_ctx *w, enum accel_opcode opcode,
+		   struct accel_opc_stats *stats)
+{
+	const char *engine_name = NULL;
+	uint64_t p50 = 0, p99 = 0, p999 = 0;
+
+	if (stats->histogram != NULL) {
+		/* Percentiles are upper bounds of histogram buckets, so they are capped
+		 * to the highest latency actually seen.
+		 */
+		p50 = spdk_min(spdk_histogram_data_get_percentile(stats->histogram, 50.0),
+			       stats->max_tsc);
+		p99 = spdk_min(spdk_histogram_data_get_percentile(stats->histogram, 99.0),
+			       stats->max_tsc);
+		p999 = spdk_min(spdk_histogram_data_get_percentile(stats->histogram, 99.9),
+				stats->max_tsc);
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "opcode", g_opcode_strings[opcode]);
+	if (spdk_accel_get_opc_engine_name(opcode, &engine_name) == 0) {
+		spdk_json_write_named_string(w, "engine", engine_name);
+	}
+	spdk_json_write_named_uint64(w, "num_submitted", stats->num_submitted);
+	spdk_json_write_named_uint64(w, "num_completed", stats->num_completed);
+	spdk_json_write_named_uint64(w, "num_failed", stats->num_failed);
+	spdk_json_write_named_uint64(w, "num_fallbacks", stats->num_fallbacks);
+	spdk_json_write_named_uint64(w, "bytes", stats->bytes);
+	spdk_json_write_named_uint64(w, "min_ticks", stats->min_tsc);
+	spdk_json_write_named_uint64(w, "max_ticks", stats->max_tsc);
+	spdk_json_write_named_uint64(w, "p50_ticks", p50);
+	spdk_json_write_named_uint64(w, "p99_ticks", p99);
+	spdk_json_write_named_uint64(w, "p999_ticks", p999);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_accel_get_stats_done(struct accel_stats *stats, void *cb_arg)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+	struct spdk_json_write_ctx *w;
+	enum accel_opcode opcode;
+	int algo;
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_uint64(w, "tick_rate", spdk_get_ticks_hz());
+	spdk_json_write_named_uint64(w, "num_task_exhausted", stats->num_task_exhausted);
+	spdk_json_write_named_array_begin(w, "operations");
+	for (opcode = 0; opcode < ACCEL_OPC_LAST; opcode++) {
+		rpc_dump_opc_stats(w, opcode, &stats->opc[opcode]);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_named_array_begin(w, "compression");
+	for (algo = 0; algo < SPDK_ACCEL_COMP_ALGO_LAST; algo++) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "algo", g_comp_algo_strings[algo]);
+		rpc_dump_comp_stats(w, "compress", &stats->comp[algo][ACCEL_COMP_DIR_COMPRESS]);
+		rpc_dump_comp_stats(w, "decompress", &stats->comp[algo][ACCEL_COMP_DIR_DECOMPRESS]);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+static void
+rpc_accel_get_stats(struct spdk_jsonrpc_request *request,
+		    const struct spdk_json_val *params)
+{
+	int rc;
+
+	if (params != NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "accel_get_stats requires no parameters");
+		return;
+	}
+
+	rc = _accel_get_stats(rpc_accel_get_stats_done, request);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+	}
+}
+SPDK_RPC_REGISTER("accel_get_stats", rpc_accel_get_stats, SPDK_RPC_RUNTIME)
@@ -11,6 +11,7 @@
 #include "spdk/accel.h"
 #include "spdk/queue.h"
 #include "spdk/config.h"
+#include "spdk/histogram_data.h"
 
 struct engine_info {
 	struct spdk_json_write_ctx *w;
@@ -22,4 +23,44 @@ struct engine_info {
 typedef void (*_accel_for_each_engine_fn)(struct engine_info *info);
 void _accel_for_each_engine(struct engine_info *info, _accel_for_each_engine_fn fn);
 
+enum accel_comp_dir {
+	ACCEL_COMP_DIR_COMPRESS,
+	ACCEL_COMP_DIR_DECOMPRESS,
+	ACCEL_COMP_DIR_LAST,
+};
+
+struct accel_comp_stats {
+	uint64_t	num_ops;
+	uint64_t	num_failed;
+	uint64_t	bytes_in;
+	/* Only counted for operations reporting their output size */
+	uint64_t	bytes_out;
+	/* Sum of the submit to completion times of the operations */
+	uint64_t	total_tsc;
+};
+
+struct accel_opc_stats {
+	uint64_t			num_submitted;
+	/* Completed successfully, the latency and bytes are only counted for those */
+	uint64_t			num_completed;
+	uint64_t			num_failed;
+	/* Tasks executed by the software engine after the assigned engine failed them */
+	uint64_t			num_fallbacks;
+	uint64_t			bytes;
+	uint64_t			min_tsc;
+	uint64_t			max_tsc;
+	/* Allocated on the first completion of the opcode */
+	struct spdk_histogram_data	*histogram;
+};
+
+struct accel_stats {
+	struct accel_opc_stats	opc[ACCEL_OPC_LAST];
+	/* Submissions failed because the channel ran out of tasks */
+	uint64_t		num_task_exhausted;
+	struct accel_comp_stats	comp[SPDK_ACCEL_COMP_ALGO_LAST][ACCEL_COMP_DIR_LAST];
+};
+
+typedef void (*_accel_get_stats_cb)(struct accel_stats *stats, void *cb_arg);
+int _accel_get_stats(_accel_get_stats_cb cb_fn, void *cb_arg);
+
 #endif
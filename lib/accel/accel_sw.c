@@ -8,12 +8,14 @@
 #include "spdk_internal/accel_engine.h"
 
 #include "spdk/env.h"
+#include "spdk/endian.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
 #include "spdk/thread.h"
 #include "spdk/json.h"
 #include "spdk/crc32.h"
 #include "spdk/util.h"
+#include "spdk/xor.h"
 
 #ifdef SPDK_CONFIG_PMDK
 #include "libpmem.h"
@@ -23,16 +25,107 @@
 #include "../isa-l/include/igzip_lib.h"
 #endif
 
+#ifdef SPDK_CONFIG_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef SPDK_CONFIG_LZ4
+#include <lz4frame.h>
+#endif
+
+#include <openssl/evp.h>
+
+/* AES-XTS uses a 128-bit tweak, the low 64 bits of which carry the logical block number */
+#define ACCEL_AES_XTS_TWEAK_SIZE	16
+
+/* Input is handed to the lz4 frame compressor in blocks of at most this size */
+#define SW_ACCEL_LZ4_BLOCK_SIZE	(64 * 1024)
+
+struct sw_accel_iov_pos {
+	struct iovec			*iovs;
+	uint32_t			iovcnt;
+	uint32_t			idx;
+	size_t				offset;
+};
+
+/* State of the compress or decompress task being executed, kept across polls when the task
+ * is processed in chunks.
+ */
+struct sw_accel_comp_stream {
+	struct spdk_accel_task		*task;
+	struct sw_accel_iov_pos		src;
+	struct sw_accel_iov_pos		dst;
+	/* Vectors wrapping the buffers of tasks submitted without iovecs */
+	struct iovec			src_iov;
+	struct iovec			dst_iov;
+	uint64_t			in_remaining;
+	uint64_t			produced;
+};
+
 struct sw_accel_io_channel {
 	/* for ISAL */
 #ifdef SPDK_CONFIG_ISAL
 	struct isal_zstream		stream;
 	struct inflate_state		state;
+	uint8_t				*deflate_buf;
+	uint32_t			deflate_buf_size;
+#endif
+#ifdef SPDK_CONFIG_ZSTD
+	ZSTD_CCtx			*zstd_cctx;
+	ZSTD_DCtx			*zstd_dctx;
 #endif
+#ifdef SPDK_CONFIG_LZ4
+	LZ4F_cctx			*lz4_cctx;
+	LZ4F_dctx			*lz4_dctx;
+	/* Staging buffer for the compressor's output not fitting the destination */
+	uint8_t				*lz4_buf;
+	size_t				lz4_buf_size;
+	size_t				lz4_buf_len;
+	size_t				lz4_buf_pos;
+	bool				lz4_ended;
+#endif
+	struct sw_accel_comp_stream	comp;
+	/* for AES-XTS */
+	EVP_CIPHER_CTX			*crypto_ctx;
+	/* Bounce buffer for blocks crossing iovec boundaries */
+	uint8_t				*crypto_buf;
+	uint32_t			crypto_buf_size;
 	struct spdk_poller		*completion_poller;
+	/* Tasks waiting for a compress or decompress task executed in chunks */
+	TAILQ_HEAD(, spdk_accel_task)	tasks_to_execute;
 	TAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
 };
 
+struct sw_accel_crypto_key {
+	const EVP_CIPHER		*cipher;
+	/* Data key followed by the tweak key, as OpenSSL expects them */
+	uint8_t				key[64];
+};
+
+struct sw_accel_comp_buf {
+	uint8_t				*buf;
+	size_t				len;
+	size_t				pos;
+};
+
+/* Sets up the compressor's state for a new task */
+typedef int (*sw_accel_comp_begin_fn)(struct sw_accel_io_channel *sw_ch,
+				      struct spdk_accel_task *accel_task);
+/* Consumes input from in and produces output to out, advancing their positions.  last is set
+ * once in holds the end of the task's input.  Returns 0 once the stream is finished, 1 if it
+ * needs more input or output space and negative errno on failure.
+ */
+typedef int (*sw_accel_comp_step_fn)(struct sw_accel_io_channel *sw_ch,
+				     struct sw_accel_comp_buf *in,
+				     struct sw_accel_comp_buf *out, bool last);
+
+struct sw_accel_comp_ops {
+	sw_accel_comp_begin_fn		compress_begin;
+	sw_accel_comp_step_fn		compress;
+	sw_accel_comp_begin_fn		decompress_begin;
+	sw_accel_comp_step_fn		decompress;
+};
+
 /* Post SW completions to a list and complete in a poller as we don't want to
  * complete them on the caller's stack as they'll likely submit another. */
 inline static void
@@ -68,6 +161,10 @@ sw_accel_supports_opcode(enum accel_opcode opc)
 	case ACCEL_OPC_COPY_CRC32C:
 	case ACCEL_OPC_COMPRESS:
 	case ACCEL_OPC_DECOMPRESS:
+	case ACCEL_OPC_XOR:
+	case ACCEL_OPC_PQ_GEN:
+	case ACCEL_OPC_ENCRYPT:
+	case ACCEL_OPC_DECRYPT:
 		return true;
 	default:
 		return false;
@@ -171,113 +268,779 @@ _sw_accel_crc32cv(uint32_t *crc_dst, struct iovec *iov, uint32_t iovcnt, uint32_
 	*crc_dst = spdk_crc32c_iov_update(iov, iovcnt, ~seed);
 }
 
+static void
+_sw_iov_pos_init(struct sw_accel_iov_pos *pos, struct iovec *iovs, uint32_t iovcnt)
+{
+	pos->iovs = iovs;
+	pos->iovcnt = iovcnt;
+	pos->idx = 0;
+	pos->offset = 0;
+}
+
+/* Returns a pointer to the next len bytes if they're contiguous, NULL otherwise */
+static uint8_t *
+_sw_iov_pos_get(struct sw_accel_iov_pos *pos, size_t len)
+{
+	struct iovec *iov = &pos->iovs[pos->idx];
+
+	if (iov->iov_len - pos->offset < len) {
+		return NULL;
+	}
+
+	return (uint8_t *)iov->iov_base + pos->offset;
+}
+
+/* Copies len bytes between buf and the iovecs (in the direction given by to_iovs) and
+ * advances the position.  If buf is NULL, only the position is advanced.
+ */
+static void
+_sw_iov_pos_xfer(struct sw_accel_iov_pos *pos, uint8_t *buf, size_t len, bool to_iovs)
+{
+	struct iovec *iov;
+	size_t n;
+
+	while (len > 0) {
+		assert(pos->idx < pos->iovcnt);
+		iov = &pos->iovs[pos->idx];
+		n = spdk_min(len, iov->iov_len - pos->offset);
+		if (buf != NULL) {
+			if (to_iovs) {
+				memcpy((uint8_t *)iov->iov_base + pos->offset, buf, n);
+			} else {
+				memcpy(buf, (uint8_t *)iov->iov_base + pos->offset, n);
+			}
+			buf += n;
+		}
+		len -= n;
+		pos->offset += n;
+		if (pos->offset == iov->iov_len) {
+			pos->idx++;
+			pos->offset = 0;
+		}
+	}
+}
+
+/* Returns the rest of the current iovec, skipping empty ones, or NULL past the last one */
+static uint8_t *
+_sw_iov_pos_seg(struct sw_accel_iov_pos *pos, size_t *len)
+{
+	struct iovec *iov;
+
+	while (pos->idx < pos->iovcnt && pos->iovs[pos->idx].iov_len == pos->offset) {
+		pos->idx++;
+		pos->offset = 0;
+	}
+
+	if (pos->idx == pos->iovcnt) {
+		*len = 0;
+		return NULL;
+	}
+
+	iov = &pos->iovs[pos->idx];
+	*len = iov->iov_len - pos->offset;
+
+	return (uint8_t *)iov->iov_base + pos->offset;
+}
+
+static uint64_t
+_sw_iovs_len(struct iovec *iovs, uint32_t iovcnt)
+{
+	uint64_t len = 0;
+	uint32_t i;
+
+	for (i = 0; i < iovcnt; i++) {
+		len += iovs[i].iov_len;
+	}
+
+	return len;
+}
+
+static int
+_sw_accel_crypto(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task, int enc)
+{
+	struct sw_accel_crypto_key *key_priv = accel_task->crypto_key->priv;
+	struct sw_accel_iov_pos src, dst;
+	uint32_t block_size = accel_task->block_size;
+	uint8_t tweak[ACCEL_AES_XTS_TWEAK_SIZE];
+	uint64_t src_len, num_blocks, iv = accel_task->iv;
+	EVP_CIPHER_CTX *ctx = sw_ch->crypto_ctx;
+	uint8_t *in, *out, *buf;
+	int outl;
+
+	src_len = _sw_iovs_len(accel_task->v.iovs, accel_task->v.iovcnt);
+	if (spdk_unlikely(src_len % block_size != 0 ||
+			  src_len > _sw_iovs_len(accel_task->d.iovs, accel_task->d.iovcnt))) {
+		return -EINVAL;
+	}
+
+	if (spdk_unlikely(sw_ch->crypto_buf_size < block_size)) {
+		buf = realloc(sw_ch->crypto_buf, block_size);
+		if (buf == NULL) {
+			return -ENOMEM;
+		}
+		sw_ch->crypto_buf = buf;
+		sw_ch->crypto_buf_size = block_size;
+	}
+
+	/* Expand the key schedule once, only the tweak changes between blocks */
+	if (spdk_unlikely(EVP_CipherInit_ex(ctx, key_priv->cipher, NULL, key_priv->key, NULL,
+					    enc) != 1)) {
+		return -EINVAL;
+	}
+
+	_sw_iov_pos_init(&src, accel_task->v.iovs, accel_task->v.iovcnt);
+	_sw_iov_pos_init(&dst, accel_task->d.iovs, accel_task->d.iovcnt);
+	memset(tweak, 0, sizeof(tweak));
+
+	for (num_blocks = src_len / block_size; num_blocks > 0; num_blocks--, iv++) {
+		to_le64(tweak, iv);
+		if (spdk_unlikely(EVP_CipherInit_ex(ctx, NULL, NULL, NULL, tweak, -1) != 1)) {
+			return -EINVAL;
+		}
+
+		/* Blocks split across iovecs are gathered into (and scattered from) the bounce
+		 * buffer.  XTS handles in == out, so a single buffer covers both directions.
+		 */
+		in = _sw_iov_pos_get(&src, block_size);
+		if (in == NULL) {
+			in = sw_ch->crypto_buf;
+			_sw_iov_pos_xfer(&src, in, block_size, false);
+		} else {
+			_sw_iov_pos_xfer(&src, NULL, block_size, false);
+		}
+
+		out = _sw_iov_pos_get(&dst, block_size);
+		if (out == NULL) {
+			out = sw_ch->crypto_buf;
+		}
+
+		if (spdk_unlikely(EVP_CipherUpdate(ctx, out, &outl, in, block_size) != 1 ||
+				  (uint32_t)outl != block_size)) {
+			return -EINVAL;
+		}
+
+		_sw_iov_pos_xfer(&dst, out == sw_ch->crypto_buf ? out : NULL, block_size, true);
+	}
+
+	return 0;
+}
+
 static int
-_sw_accel_compress(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+sw_accel_crypto_key_init(struct spdk_accel_crypto_key *key)
 {
+	struct sw_accel_crypto_key *key_priv;
+	const EVP_CIPHER *cipher;
+
+	switch (key->key_size) {
+	case 16:
+		cipher = EVP_aes_128_xts();
+		break;
+	case 32:
+		cipher = EVP_aes_256_xts();
+		break;
+	default:
+		SPDK_ERRLOG("Unsupported AES-XTS key size %zu\n", key->key_size);
+		return -EINVAL;
+	}
+
+	if (key->key2_size != key->key_size) {
+		SPDK_ERRLOG("AES-XTS tweak key size must match the data key size\n");
+		return -EINVAL;
+	}
+
+	/* XTS is insecure with identical keys and OpenSSL refuses them anyway */
+	if (memcmp(key->key, key->key2, key->key_size) == 0) {
+		SPDK_ERRLOG("AES-XTS data and tweak keys must differ\n");
+		return -EINVAL;
+	}
+
+	key_priv = calloc(1, sizeof(*key_priv));
+	if (key_priv == NULL) {
+		return -ENOMEM;
+	}
+
+	key_priv->cipher = cipher;
+	memcpy(key_priv->key, key->key, key->key_size);
+	memcpy(key_priv->key + key->key_size, key->key2, key->key2_size);
+	key->priv = key_priv;
+
+	return 0;
+}
+
+static void
+sw_accel_crypto_key_deinit(struct spdk_accel_crypto_key *key)
+{
+	struct sw_accel_crypto_key *key_priv = key->priv;
+
+	if (key_priv == NULL) {
+		return;
+	}
+
+	memset(key_priv, 0, sizeof(*key_priv));
+	free(key_priv);
+	key->priv = NULL;
+}
+
 #ifdef SPDK_CONFIG_ISAL
-	sw_ch->stream.next_in = accel_task->src;
-	sw_ch->stream.next_out = accel_task->dst;
-	sw_ch->stream.avail_in = accel_task->nbytes;
-	sw_ch->stream.avail_out = accel_task->nbytes_dst;
+static const uint32_t g_isal_level_buf_size[ISAL_DEF_MAX_LEVEL + 1] = {
+	ISAL_DEF_LVL0_DEFAULT, ISAL_DEF_LVL1_DEFAULT, ISAL_DEF_LVL2_DEFAULT, ISAL_DEF_LVL3_DEFAULT
+};
+
+static int
+_sw_deflate_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	/* Level 1 is the default, as it was for the former stateless compression */
+	int level = accel_task->comp.level != 0 ? accel_task->comp.level : 1;
+	uint32_t size;
+	uint8_t *buf;
+
+	if (level < 1 || level > ISAL_DEF_MAX_LEVEL) {
+		SPDK_ERRLOG("Invalid deflate compression level %d\n", level);
+		return -EINVAL;
+	}
+
+	size = g_isal_level_buf_size[level];
+	if (sw_ch->deflate_buf_size < size) {
+		buf = realloc(sw_ch->deflate_buf, size);
+		if (buf == NULL) {
+			return -ENOMEM;
+		}
+		sw_ch->deflate_buf = buf;
+		sw_ch->deflate_buf_size = size;
+	}
+
+	isal_deflate_init(&sw_ch->stream);
+	sw_ch->stream.level = level;
+	sw_ch->stream.level_buf = sw_ch->deflate_buf;
+	sw_ch->stream.level_buf_size = sw_ch->deflate_buf_size;
+
+	return 0;
+}
+
+static int
+_sw_deflate(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+	    struct sw_accel_comp_buf *out, bool last)
+{
+	struct isal_zstream *stream = &sw_ch->stream;
+	int rc;
 
-	isal_deflate_stateless(&sw_ch->stream);
-	if (accel_task->output_size != NULL) {
-		assert(accel_task->nbytes_dst > sw_ch->stream.avail_out);
-		*accel_task->output_size = accel_task->nbytes_dst - sw_ch->stream.avail_out;
+	stream->next_in = in->buf;
+	stream->avail_in = in->len;
+	stream->next_out = out->buf;
+	stream->avail_out = out->len;
+	stream->end_of_stream = last;
+	stream->flush = NO_FLUSH;
+
+	rc = isal_deflate(stream);
+	in->pos = in->len - stream->avail_in;
+	out->pos = out->len - stream->avail_out;
+	if (spdk_unlikely(rc != COMP_OK)) {
+		SPDK_ERRLOG("isal_deflate returned error %d.\n", rc);
+		return -EIO;
 	}
 
+	return stream->internal_state.state == ZSTATE_END ? 0 : 1;
+}
+
+static int
+_sw_inflate_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	isal_inflate_init(&sw_ch->state);
+
 	return 0;
-#else
-	SPDK_ERRLOG("ISAL option is required to use software compression.\n");
-	return -EINVAL;
+}
+
+static int
+_sw_inflate(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+	    struct sw_accel_comp_buf *out, bool last)
+{
+	struct inflate_state *state = &sw_ch->state;
+	int rc;
+
+	state->next_in = in->buf;
+	state->avail_in = in->len;
+	state->next_out = out->buf;
+	state->avail_out = out->len;
+
+	rc = isal_inflate(state);
+	in->pos = in->len - state->avail_in;
+	out->pos = out->len - state->avail_out;
+	if (spdk_unlikely(rc < 0)) {
+		SPDK_ERRLOG("isal_inflate returned error %d.\n", rc);
+		return -EIO;
+	}
+
+	return state->block_state == ISAL_BLOCK_FINISH ? 0 : 1;
+}
+#endif
+
+#ifdef SPDK_CONFIG_ZSTD
+static int
+_sw_zstd_compress_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	int level = accel_task->comp.level != 0 ? accel_task->comp.level : ZSTD_CLEVEL_DEFAULT;
+	ZSTD_CCtx *cctx = sw_ch->zstd_cctx;
+
+	if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
+		SPDK_ERRLOG("Invalid zstd compression level %d\n", level);
+		return -EINVAL;
+	}
+
+	/* Recording the content size in the frame header lets the decompressor size its
+	 * window to the data.
+	 */
+	if (ZSTD_isError(ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only)) ||
+	    ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level)) ||
+	    ZSTD_isError(ZSTD_CCtx_setPledgedSrcSize(cctx, accel_task->nbytes))) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+_sw_zstd_compress(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+		  struct sw_accel_comp_buf *out, bool last)
+{
+	ZSTD_inBuffer zin = { .src = in->buf, .size = in->len, .pos = 0 };
+	ZSTD_outBuffer zout = { .dst = out->buf, .size = out->len, .pos = 0 };
+	size_t rc;
+
+	rc = ZSTD_compressStream2(sw_ch->zstd_cctx, &zout, &zin,
+				  last ? ZSTD_e_end : ZSTD_e_continue);
+	in->pos = zin.pos;
+	out->pos = zout.pos;
+	if (spdk_unlikely(ZSTD_isError(rc))) {
+		SPDK_ERRLOG("ZSTD_compressStream2 failed: %s\n", ZSTD_getErrorName(rc));
+		return -EIO;
+	}
+
+	/* With ZSTD_e_end, 0 means the whole frame has been flushed */
+	return last && rc == 0 ? 0 : 1;
+}
+
+static int
+_sw_zstd_decompress_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	if (ZSTD_isError(ZSTD_DCtx_reset(sw_ch->zstd_dctx, ZSTD_reset_session_only))) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+_sw_zstd_decompress(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+		    struct sw_accel_comp_buf *out, bool last)
+{
+	ZSTD_inBuffer zin = { .src = in->buf, .size = in->len, .pos = 0 };
+	ZSTD_outBuffer zout = { .dst = out->buf, .size = out->len, .pos = 0 };
+	size_t rc;
+
+	rc = ZSTD_decompressStream(sw_ch->zstd_dctx, &zout, &zin);
+	in->pos = zin.pos;
+	out->pos = zout.pos;
+	if (spdk_unlikely(ZSTD_isError(rc))) {
+		SPDK_ERRLOG("ZSTD_decompressStream failed: %s\n", ZSTD_getErrorName(rc));
+		return -EIO;
+	}
+
+	return rc == 0 ? 0 : 1;
+}
 #endif
+
+#ifdef SPDK_CONFIG_LZ4
+static void
+_sw_lz4_prefs_init(LZ4F_preferences_t *prefs, int level, uint64_t content_size)
+{
+	memset(prefs, 0, sizeof(*prefs));
+	prefs->frameInfo.blockSizeID = LZ4F_max64KB;
+	prefs->frameInfo.contentSize = content_size;
+	prefs->compressionLevel = level;
+	/* Let the context gather input into whole blocks, so that iovec and chunk
+	 * boundaries don't show up in the compressed data.
+	 */
+	prefs->autoFlush = 0;
+}
+
+static int
+_sw_lz4_compress_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	LZ4F_preferences_t prefs;
+	size_t rc;
+
+	/* 0 is lz4's default, negative levels trade ratio for even more speed */
+	if (accel_task->comp.level > LZ4F_compressionLevel_max()) {
+		SPDK_ERRLOG("Invalid lz4 compression level %d\n", accel_task->comp.level);
+		return -EINVAL;
+	}
+
+	_sw_lz4_prefs_init(&prefs, accel_task->comp.level, accel_task->nbytes);
+	rc = LZ4F_compressBegin(sw_ch->lz4_cctx, sw_ch->lz4_buf, sw_ch->lz4_buf_size, &prefs);
+	if (LZ4F_isError(rc)) {
+		SPDK_ERRLOG("LZ4F_compressBegin failed: %s\n", LZ4F_getErrorName(rc));
+		return -EINVAL;
+	}
+
+	/* The frame header is flushed with the first step */
+	sw_ch->lz4_buf_len = rc;
+	sw_ch->lz4_buf_pos = 0;
+	sw_ch->lz4_ended = false;
+
+	return 0;
 }
 
 static int
-_sw_accel_decompress(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+_sw_lz4_compress(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+		 struct sw_accel_comp_buf *out, bool last)
 {
+	uint8_t *dst;
+	size_t len, rc;
+
+	for (;;) {
+		len = spdk_min(sw_ch->lz4_buf_len - sw_ch->lz4_buf_pos, out->len - out->pos);
+		if (len > 0) {
+			memcpy(out->buf + out->pos, sw_ch->lz4_buf + sw_ch->lz4_buf_pos, len);
+			out->pos += len;
+			sw_ch->lz4_buf_pos += len;
+		}
+		if (sw_ch->lz4_buf_pos < sw_ch->lz4_buf_len) {
+			return 1;
+		}
+		if (sw_ch->lz4_ended) {
+			return 0;
+		}
+
+		/* LZ4F requires room for the worst case output of a whole block, compress
+		 * straight to the destination only if it has that much space left.
+		 */
+		if (out->len - out->pos >= sw_ch->lz4_buf_size) {
+			dst = out->buf + out->pos;
+		} else {
+			dst = sw_ch->lz4_buf;
+		}
+
+		if (in->pos < in->len) {
+			len = spdk_min(in->len - in->pos, SW_ACCEL_LZ4_BLOCK_SIZE);
+			rc = LZ4F_compressUpdate(sw_ch->lz4_cctx, dst, sw_ch->lz4_buf_size,
+						 in->buf + in->pos, len, NULL);
+			in->pos += len;
+		} else if (last) {
+			rc = LZ4F_compressEnd(sw_ch->lz4_cctx, dst, sw_ch->lz4_buf_size, NULL);
+			sw_ch->lz4_ended = true;
+		} else {
+			return 1;
+		}
+
+		if (spdk_unlikely(LZ4F_isError(rc))) {
+			SPDK_ERRLOG("lz4 compression failed: %s\n", LZ4F_getErrorName(rc));
+			return -EIO;
+		}
+
+		if (dst == sw_ch->lz4_buf) {
+			sw_ch->lz4_buf_len = rc;
+			sw_ch->lz4_buf_pos = 0;
+		} else {
+			out->pos += rc;
+			sw_ch->lz4_buf_len = 0;
+			sw_ch->lz4_buf_pos = 0;
+		}
+	}
+}
+
+static int
+_sw_lz4_decompress_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	LZ4F_resetDecompressionContext(sw_ch->lz4_dctx);
+
+	return 0;
+}
+
+static int
+_sw_lz4_decompress(struct sw_accel_io_channel *sw_ch, struct sw_accel_comp_buf *in,
+		   struct sw_accel_comp_buf *out, bool last)
+{
+	size_t in_len = in->len, out_len = out->len;
+	size_t rc;
+
+	rc = LZ4F_decompress(sw_ch->lz4_dctx, out->buf, &out_len, in->buf, &in_len, NULL);
+	in->pos = in_len;
+	out->pos = out_len;
+	if (spdk_unlikely(LZ4F_isError(rc))) {
+		SPDK_ERRLOG("LZ4F_decompress failed: %s\n", LZ4F_getErrorName(rc));
+		return -EIO;
+	}
+
+	return rc == 0 ? 0 : 1;
+}
+#endif
+
+static const struct sw_accel_comp_ops g_sw_comp_ops[SPDK_ACCEL_COMP_ALGO_LAST] = {
 #ifdef SPDK_CONFIG_ISAL
+	[SPDK_ACCEL_COMP_ALGO_DEFLATE] = {
+		.compress_begin = _sw_deflate_begin,
+		.compress = _sw_deflate,
+		.decompress_begin = _sw_inflate_begin,
+		.decompress = _sw_inflate,
+	},
+#endif
+#ifdef SPDK_CONFIG_LZ4
+	[SPDK_ACCEL_COMP_ALGO_LZ4] = {
+		.compress_begin = _sw_lz4_compress_begin,
+		.compress = _sw_lz4_compress,
+		.decompress_begin = _sw_lz4_decompress_begin,
+		.decompress = _sw_lz4_decompress,
+	},
+#endif
+#ifdef SPDK_CONFIG_ZSTD
+	[SPDK_ACCEL_COMP_ALGO_ZSTD] = {
+		.compress_begin = _sw_zstd_compress_begin,
+		.compress = _sw_zstd_compress,
+		.decompress_begin = _sw_zstd_decompress_begin,
+		.decompress = _sw_zstd_decompress,
+	},
+#endif
+};
+
+static bool
+sw_accel_supports_comp_algo(enum spdk_accel_comp_algo algo)
+{
+	return algo < SPDK_ACCEL_COMP_ALGO_LAST && g_sw_comp_ops[algo].compress != NULL;
+}
+
+static int
+_sw_accel_comp_begin(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_comp_stream *stream = &sw_ch->comp;
+	const struct sw_accel_comp_ops *ops = &g_sw_comp_ops[accel_task->comp.algo];
+	sw_accel_comp_begin_fn begin_fn;
 	int rc;
 
-	sw_ch->state.next_in = accel_task->src;
-	sw_ch->state.avail_in = accel_task->nbytes;
-	sw_ch->state.next_out = accel_task->dst;
-	sw_ch->state.avail_out = accel_task->nbytes_dst;
+	if (accel_task->op_code == ACCEL_OPC_COMPRESS) {
+		begin_fn = ops->compress_begin;
+	} else {
+		begin_fn = ops->decompress_begin;
+	}
+
+	if (begin_fn == NULL) {
+		SPDK_ERRLOG("Compression algorithm %u is not supported by the software engine.\n",
+			    accel_task->comp.algo);
+		return -ENOTSUP;
+	}
+
+	if (accel_task->v.iovcnt == 0) {
+		stream->src_iov.iov_base = accel_task->src;
+		stream->src_iov.iov_len = accel_task->nbytes;
+		stream->dst_iov.iov_base = accel_task->dst;
+		stream->dst_iov.iov_len = accel_task->nbytes_dst;
+		_sw_iov_pos_init(&stream->src, &stream->src_iov, 1);
+		_sw_iov_pos_init(&stream->dst, &stream->dst_iov, 1);
+	} else {
+		_sw_iov_pos_init(&stream->src, accel_task->v.iovs, accel_task->v.iovcnt);
+		_sw_iov_pos_init(&stream->dst, accel_task->d.iovs, accel_task->d.iovcnt);
+	}
+
+	stream->in_remaining = accel_task->nbytes;
+	stream->produced = 0;
+
+	rc = begin_fn(sw_ch, accel_task);
+	if (rc != 0) {
+		return rc;
+	}
+
+	stream->task = accel_task;
+
+	return 0;
+}
+
+/* Runs a compress or decompress task.  Tasks with a chunk size are stopped with -EAGAIN after
+ * consuming that much input and are resumed by the next call.
+ */
+static int
+_sw_accel_comp(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_comp_stream *stream = &sw_ch->comp;
+	const struct sw_accel_comp_ops *ops = &g_sw_comp_ops[accel_task->comp.algo];
+	sw_accel_comp_step_fn step_fn;
+	struct sw_accel_comp_buf in, out;
+	uint64_t budget;
+	bool last;
+	int rc;
+
+	if (stream->task != accel_task) {
+		rc = _sw_accel_comp_begin(sw_ch, accel_task);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	step_fn = accel_task->op_code == ACCEL_OPC_COMPRESS ? ops->compress : ops->decompress;
+	budget = accel_task->comp.chunk_size != 0 ? accel_task->comp.chunk_size : UINT64_MAX;
+
+	do {
+		if (budget == 0) {
+			return -EAGAIN;
+		}
+
+		/* ISA-L counts the available bytes in 32 bits */
+		in.buf = _sw_iov_pos_seg(&stream->src, &in.len);
+		in.len = spdk_min(in.len, spdk_min(budget, UINT32_MAX));
+		in.pos = 0;
+		out.buf = _sw_iov_pos_seg(&stream->dst, &out.len);
+		out.len = spdk_min(out.len, UINT32_MAX);
+		out.pos = 0;
+		last = in.len == stream->in_remaining;
+
+		rc = step_fn(sw_ch, &in, &out, last);
+
+		_sw_iov_pos_xfer(&stream->src, NULL, in.pos, false);
+		_sw_iov_pos_xfer(&stream->dst, NULL, out.pos, true);
+		stream->in_remaining -= in.pos;
+		stream->produced += out.pos;
+		budget -= in.pos;
+
+		if (rc == 1 && in.pos == 0 && out.pos == 0) {
+			/* Stuck, either out of space or the compressed data is truncated */
+			rc = out.len == 0 ? -ENOSPC : -EINVAL;
+		}
+	} while (rc == 1);
 
-	rc = isal_inflate_stateless(&sw_ch->state);
-	if (rc) {
-		SPDK_ERRLOG("isal_inflate_stateless retunred error %d.\n", rc);
+	stream->task = NULL;
+	if (rc == 0 && accel_task->output_size != NULL) {
+		*accel_task->output_size = stream->produced;
 	}
+
 	return rc;
-#else
-	SPDK_ERRLOG("ISAL option is required to use software decompression.\n");
-	return -EINVAL;
-#endif
 }
 
 static int
-sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task)
+_sw_accel_execute_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
 {
-	struct sw_accel_io_channel *sw_ch = spdk_io_channel_get_ctx(ch);
-	struct spdk_accel_task *tmp;
 	int rc = 0;
 
-	do {
-		switch (accel_task->op_code) {
-		case ACCEL_OPC_COPY:
-			rc = _check_flags(accel_task->flags);
-			if (rc == 0) {
-				_sw_accel_copy(accel_task->dst, accel_task->src, accel_task->nbytes, accel_task->flags);
-			}
-			break;
-		case ACCEL_OPC_FILL:
-			rc = _check_flags(accel_task->flags);
-			if (rc == 0) {
-				_sw_accel_fill(accel_task->dst, accel_task->fill_pattern, accel_task->nbytes, accel_task->flags);
-			}
-			break;
-		case ACCEL_OPC_DUALCAST:
-			rc = _check_flags(accel_task->flags);
-			if (rc == 0) {
-				_sw_accel_dualcast(accel_task->dst, accel_task->dst2, accel_task->src, accel_task->nbytes,
-						   accel_task->flags);
-			}
-			break;
-		case ACCEL_OPC_COMPARE:
-			rc = _sw_accel_compare(accel_task->src, accel_task->src2, accel_task->nbytes);
-			break;
-		case ACCEL_OPC_CRC32C:
+	switch (accel_task->op_code) {
+	case ACCEL_OPC_COPY:
+		rc = _check_flags(accel_task->flags);
+		if (rc == 0) {
+			_sw_accel_copy(accel_task->dst, accel_task->src, accel_task->nbytes, accel_task->flags);
+		}
+		break;
+	case ACCEL_OPC_FILL:
+		rc = _check_flags(accel_task->flags);
+		if (rc == 0) {
+			_sw_accel_fill(accel_task->dst, accel_task->fill_pattern, accel_task->nbytes, accel_task->flags);
+		}
+		break;
+	case ACCEL_OPC_DUALCAST:
+		rc = _check_flags(accel_task->flags);
+		if (rc == 0) {
+			_sw_accel_dualcast(accel_task->dst, accel_task->dst2, accel_task->src, accel_task->nbytes,
+					   accel_task->flags);
+		}
+		break;
+	case ACCEL_OPC_COMPARE:
+		rc = _sw_accel_compare(accel_task->src, accel_task->src2, accel_task->nbytes);
+		break;
+	case ACCEL_OPC_CRC32C:
+		if (accel_task->v.iovcnt == 0) {
+			_sw_accel_crc32c(accel_task->crc_dst, accel_task->src, accel_task->seed, accel_task->nbytes);
+		} else {
+			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->v.iovs, accel_task->v.iovcnt, accel_task->seed);
+		}
+		break;
+	case ACCEL_OPC_COPY_CRC32C:
+		rc = _check_flags(accel_task->flags);
+		if (rc == 0) {
 			if (accel_task->v.iovcnt == 0) {
+				_sw_accel_copy(accel_task->dst, accel_task->src, accel_task->nbytes, accel_task->flags);
 				_sw_accel_crc32c(accel_task->crc_dst, accel_task->src, accel_task->seed, accel_task->nbytes);
 			} else {
+				_sw_accel_copyv(accel_task->dst, accel_task->v.iovs, accel_task->v.iovcnt, accel_task->flags);
 				_sw_accel_crc32cv(accel_task->crc_dst, accel_task->v.iovs, accel_task->v.iovcnt, accel_task->seed);
 			}
-			break;
-		case ACCEL_OPC_COPY_CRC32C:
-			rc = _check_flags(accel_task->flags);
-			if (rc == 0) {
-				if (accel_task->v.iovcnt == 0) {
-					_sw_accel_copy(accel_task->dst, accel_task->src, accel_task->nbytes, accel_task->flags);
-					_sw_accel_crc32c(accel_task->crc_dst, accel_task->src, accel_task->seed, accel_task->nbytes);
-				} else {
-					_sw_accel_copyv(accel_task->dst, accel_task->v.iovs, accel_task->v.iovcnt, accel_task->flags);
-					_sw_accel_crc32cv(accel_task->crc_dst, accel_task->v.iovs, accel_task->v.iovcnt, accel_task->seed);
-				}
-			}
-			break;
-		case ACCEL_OPC_COMPRESS:
-			rc = _sw_accel_compress(sw_ch, accel_task);
-			break;
-		case ACCEL_OPC_DECOMPRESS:
-			rc = _sw_accel_decompress(sw_ch, accel_task);
-			break;
-		default:
-			assert(false);
+		}
+		break;
+	case ACCEL_OPC_COMPRESS:
+	case ACCEL_OPC_DECOMPRESS:
+		rc = _sw_accel_comp(sw_ch, accel_task);
+		break;
+	case ACCEL_OPC_XOR:
+		rc = spdk_xor_gen(accel_task->dst, accel_task->nsrcs.srcs, accel_task->nsrcs.cnt,
+				  accel_task->nbytes);
+		break;
+	case ACCEL_OPC_PQ_GEN:
+		rc = spdk_xor_gen_pq(accel_task->dst, accel_task->dst2, accel_task->nsrcs.srcs,
+				     accel_task->nsrcs.cnt, accel_task->nbytes);
+		break;
+	case ACCEL_OPC_ENCRYPT:
+		rc = _sw_accel_crypto(sw_ch, accel_task, 1);
+		break;
+	case ACCEL_OPC_DECRYPT:
+		rc = _sw_accel_crypto(sw_ch, accel_task, 0);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	return rc;
+}
+
+/* Queues accel_task and the tasks linked after it behind the task executed in chunks */
+static void
+_sw_accel_queue_tasks(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct spdk_accel_task *tmp;
+
+	do {
+		tmp = TAILQ_NEXT(accel_task, link);
+		TAILQ_INSERT_TAIL(&sw_ch->tasks_to_execute, accel_task, link);
+		accel_task = tmp;
+	} while (accel_task);
+}
+
+static void
+_sw_accel_execute_queued_tasks(struct sw_accel_io_channel *sw_ch)
+{
+	struct spdk_accel_task *accel_task;
+	int rc;
+
+	while ((accel_task = TAILQ_FIRST(&sw_ch->tasks_to_execute))) {
+		rc = _sw_accel_execute_task(sw_ch, accel_task);
+		if (sw_ch->comp.task == accel_task) {
+			/* Not done yet, continue with the next chunk on the next poll */
 			break;
 		}
 
+		TAILQ_REMOVE(&sw_ch->tasks_to_execute, accel_task, link);
+		_add_to_comp_list(sw_ch, accel_task, rc);
+	}
+}
+
+static int
+sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_io_channel *sw_ch = spdk_io_channel_get_ctx(ch);
+	struct spdk_accel_task *tmp;
+	int rc;
+
+	/* Keep the order of the tasks (and the compression state) while a task is being
+	 * executed in chunks.
+	 */
+	if (spdk_unlikely(!TAILQ_EMPTY(&sw_ch->tasks_to_execute))) {
+		_sw_accel_queue_tasks(sw_ch, accel_task);
+		return 0;
+	}
+
+	do {
 		tmp = TAILQ_NEXT(accel_task, link);
 
+		rc = _sw_accel_execute_task(sw_ch, accel_task);
+		if (spdk_unlikely(sw_ch->comp.task == accel_task)) {
+			_sw_accel_queue_tasks(sw_ch, accel_task);
+			break;
+		}
+
 		_add_to_comp_list(sw_ch, accel_task, rc);
 
 		accel_task = tmp;
@@ -299,7 +1062,11 @@ static struct spdk_accel_module_if g_sw_module = {
 	.name			= "software",
 	.supports_opcode	= sw_accel_supports_opcode,
 	.get_io_channel		= sw_accel_get_io_channel,
-	.submit_tasks		= sw_accel_submit_tasks
+	.submit_tasks		= sw_accel_submit_tasks,
+	.ordered_tasks		= true,
+	.crypto_key_init	= sw_accel_crypto_key_init,
+	.crypto_key_deinit	= sw_accel_crypto_key_deinit,
+	.supports_comp_algo	= sw_accel_supports_comp_algo,
 };
 
 static int
@@ -309,8 +1076,11 @@ accel_comp_poll(void *arg)
 	TAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
 	struct spdk_accel_task		*accel_task;
 
+	/* Resume the task executed in chunks along with the ones waiting for it */
+	_sw_accel_execute_queued_tasks(sw_ch);
+
 	if (TAILQ_EMPTY(&sw_ch->tasks_to_complete)) {
-		return SPDK_POLLER_IDLE;
+		return TAILQ_EMPTY(&sw_ch->tasks_to_execute) ? SPDK_POLLER_IDLE : SPDK_POLLER_BUSY;
 	}
 
 	TAILQ_INIT(&tasks_to_complete);
@@ -324,37 +1094,94 @@ accel_comp_poll(void *arg)
 	return SPDK_POLLER_BUSY;
 }
 
+static void
+_sw_accel_channel_free(struct sw_accel_io_channel *sw_ch)
+{
+#ifdef SPDK_CONFIG_ISAL
+	free(sw_ch->deflate_buf);
+#endif
+#ifdef SPDK_CONFIG_ZSTD
+	ZSTD_freeCCtx(sw_ch->zstd_cctx);
+	ZSTD_freeDCtx(sw_ch->zstd_dctx);
+#endif
+#ifdef SPDK_CONFIG_LZ4
+	LZ4F_freeCompressionContext(sw_ch->lz4_cctx);
+	LZ4F_freeDecompressionContext(sw_ch->lz4_dctx);
+	free(sw_ch->lz4_buf);
+#endif
+	EVP_CIPHER_CTX_free(sw_ch->crypto_ctx);
+	free(sw_ch->crypto_buf);
+}
+
+/* Allocate the streaming contexts of the compression libraries. */
 static int
-sw_accel_create_cb(void *io_device, void *ctx_buf)
+_sw_accel_comp_ctx_init(struct sw_accel_io_channel *sw_ch)
 {
-	struct sw_accel_io_channel *sw_ch = ctx_buf;
+#ifdef SPDK_CONFIG_LZ4
+	LZ4F_preferences_t prefs;
+#endif
 
-	TAILQ_INIT(&sw_ch->tasks_to_complete);
-	sw_ch->completion_poller = SPDK_POLLER_REGISTER(accel_comp_poll, sw_ch, 0);
+#ifdef SPDK_CONFIG_ZSTD
+	sw_ch->zstd_cctx = ZSTD_createCCtx();
+	sw_ch->zstd_dctx = ZSTD_createDCtx();
+	if (sw_ch->zstd_cctx == NULL || sw_ch->zstd_dctx == NULL) {
+		SPDK_ERRLOG("Could not allocate zstd contexts\n");
+		return -ENOMEM;
+	}
+#endif
 
-#ifdef SPDK_CONFIG_ISAL
-	isal_deflate_stateless_init(&sw_ch->stream);
-	sw_ch->stream.level = 1;
-	sw_ch->stream.level_buf = calloc(1, ISAL_DEF_LVL1_DEFAULT);
-	if (sw_ch->stream.level_buf == NULL) {
-		SPDK_ERRLOG("Could not allocate isal internal buffer\n");
+#ifdef SPDK_CONFIG_LZ4
+	if (LZ4F_isError(LZ4F_createCompressionContext(&sw_ch->lz4_cctx, LZ4F_VERSION)) ||
+	    LZ4F_isError(LZ4F_createDecompressionContext(&sw_ch->lz4_dctx, LZ4F_VERSION))) {
+		SPDK_ERRLOG("Could not allocate lz4 contexts\n");
+		return -ENOMEM;
+	}
+
+	/* The bound doesn't depend on the level or the content size */
+	_sw_lz4_prefs_init(&prefs, 0, 0);
+	sw_ch->lz4_buf_size = LZ4F_compressBound(SW_ACCEL_LZ4_BLOCK_SIZE, &prefs);
+	sw_ch->lz4_buf = malloc(sw_ch->lz4_buf_size);
+	if (sw_ch->lz4_buf == NULL) {
+		SPDK_ERRLOG("Could not allocate lz4 staging buffer\n");
 		return -ENOMEM;
 	}
-	sw_ch->stream.level_buf_size = ISAL_DEF_LVL1_DEFAULT;
-	isal_inflate_init(&sw_ch->state);
 #endif
 
 	return 0;
 }
 
+static int
+sw_accel_create_cb(void *io_device, void *ctx_buf)
+{
+	struct sw_accel_io_channel *sw_ch = ctx_buf;
+	int rc;
+
+	sw_ch->crypto_ctx = EVP_CIPHER_CTX_new();
+	if (sw_ch->crypto_ctx == NULL) {
+		SPDK_ERRLOG("Could not allocate the cipher context\n");
+		return -ENOMEM;
+	}
+
+	rc = _sw_accel_comp_ctx_init(sw_ch);
+	if (rc != 0) {
+		_sw_accel_channel_free(sw_ch);
+		return rc;
+	}
+
+	TAILQ_INIT(&sw_ch->tasks_to_execute);
+	TAILQ_INIT(&sw_ch->tasks_to_complete);
+	sw_ch->completion_poller = SPDK_POLLER_REGISTER(accel_comp_poll, sw_ch, 0);
+
+	return 0;
+}
+
 static void
 sw_accel_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct sw_accel_io_channel *sw_ch = ctx_buf;
 
-#ifdef SPDK_CONFIG_ISAL
-	free(sw_ch->stream.level_buf);
-#endif
+	assert(TAILQ_EMPTY(&sw_ch->tasks_to_execute));
+	_sw_accel_channel_free(sw_ch);
 
 	spdk_poller_unregister(&sw_ch->completion_poller);
 }
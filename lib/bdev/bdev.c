@@ -19,6 +19,7 @@
 #include "spdk/util.h"
 #include "spdk/trace.h"
 #include "spdk/dma.h"
+#include "spdk/accel.h"
 
 #include "spdk/bdev_module.h"
 #include "spdk/log.h"
@@ -38,6 +39,13 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_AUTO_EXAMINE			true
 #define BUF_SMALL_POOL_SIZE			8191
 #define BUF_LARGE_POOL_SIZE			1023
+#define BUF_SMALL_CACHE_SIZE			128
+#define BUF_LARGE_CACHE_SIZE			16
+#define BUF_CACHE_BATCH_SIZE			32
+/* Minimum time between two rebalances of the same buffer cache. A thread starved again
+ *  within this interval defers the next rebalance instead of messaging all threads each time.
+ */
+#define BUF_CACHE_REBALANCE_INTERVAL_USEC	1000
 #define NOMEM_THRESHOLD_COUNT			8
 
 #define SPDK_BDEV_QOS_TIMESLICE_IN_USEC		1000
@@ -50,6 +58,11 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 
 #define SPDK_BDEV_POOL_ALIGNMENT 512
 
+/* Always-on latency histograms use 16 buckets per power of two, which keeps
+ * the relative error of reported percentiles within ~6%.
+ */
+#define SPDK_BDEV_LATENCY_HISTOGRAM_BUCKET_SHIFT 4
+
 /* The maximum number of children requests for a UNMAP or WRITE ZEROES command
  * when splitting into children requests at a time.
  */
@@ -121,6 +134,8 @@ static struct spdk_bdev_opts	g_bdev_opts = {
 	.bdev_auto_examine = SPDK_BDEV_AUTO_EXAMINE,
 	.small_buf_pool_size = BUF_SMALL_POOL_SIZE,
 	.large_buf_pool_size = BUF_LARGE_POOL_SIZE,
+	.small_buf_cache_size = BUF_SMALL_CACHE_SIZE,
+	.large_buf_cache_size = BUF_LARGE_CACHE_SIZE,
 };
 
 static spdk_bdev_init_cb	g_init_cb_fn = NULL;
@@ -177,10 +192,40 @@ struct spdk_bdev_qos {
 	struct spdk_poller *poller;
 };
 
+/* Free data buffer held by a per-thread buffer cache. The link is stored in the buffer itself. */
+struct bdev_buf {
+	STAILQ_ENTRY(bdev_buf)	stailq;
+};
+
+struct bdev_buf_cache {
+	STAILQ_HEAD(, bdev_buf)	bufs;
+	uint32_t		count;
+
+	/* High watermark. The cache is refilled from and drained to the global pool in batches. */
+	uint32_t		size;
+
+	/* Set while other threads are asked to return their cached buffers to the global pool. */
+	bool			rebalancing;
+
+	/* Set when a rebalance was requested before next_rebalance_tsc and is deferred. */
+	bool			rebalance_pending;
+	uint64_t		next_rebalance_tsc;
+};
+
 struct spdk_bdev_mgmt_channel {
 	bdev_io_stailq_t need_buf_small;
 	bdev_io_stailq_t need_buf_large;
 
+	/*
+	 * Each thread also keeps a cache of small and large data buffers
+	 *  so that most buffer allocations do not touch the global pools.
+	 *  Buffers are returned to the global pools when a cache goes
+	 *  above its size, or when another thread is starved of buffers.
+	 */
+	struct bdev_buf_cache buf_small_cache;
+	struct bdev_buf_cache buf_large_cache;
+	struct spdk_poller *buf_rebalance_poller;
+
 	/*
 	 * Each thread keeps a cache of bdev_io - this allows
 	 *  bdev threads which are *not* DPDK threads to still
@@ -266,6 +311,9 @@ struct spdk_bdev_channel {
 
 	struct spdk_histogram_data *histogram;
 
+	/* Latency statistics of successfully completed I/O, always collected. */
+	struct spdk_bdev_latency_stat latency_stat;
+
 #ifdef SPDK_CONFIG_VTUNE
 	uint64_t		start_tsc;
 	uint64_t		interval_tsc;
@@ -295,6 +343,7 @@ struct spdk_bdev_desc {
 	bool				closed;
 	bool				write;
 	bool				memory_domains_supported;
+	bool				accel_sequence_supported[SPDK_BDEV_NUM_IO_TYPES];
 	pthread_mutex_t			mutex;
 	uint32_t			refs;
 	TAILQ_HEAD(, media_event_entry)	pending_media_events;
@@ -314,6 +363,14 @@ struct spdk_bdev_iostat_ctx {
 	void *cb_arg;
 };
 
+struct spdk_bdev_latency_stat_ctx {
+	struct spdk_bdev_latency_stat *stat;
+	bool reset;
+	int rc;
+	spdk_bdev_get_device_latency_stat_cb cb;
+	void *cb_arg;
+};
+
 struct set_qos_limit_ctx {
 	void (*cb_fn)(void *cb_arg, int status);
 	void *cb_arg;
@@ -379,10 +436,12 @@ spdk_bdev_get_opts(struct spdk_bdev_opts *opts, size_t opts_size)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(small_buf_pool_size);
 	SET_FIELD(large_buf_pool_size);
+	SET_FIELD(small_buf_cache_size);
+	SET_FIELD(large_buf_cache_size);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 32, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 40, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -426,6 +485,21 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 		return -1;
 	}
 
+	if (offsetof(struct spdk_bdev_opts, large_buf_cache_size) + sizeof(opts->large_buf_cache_size) <=
+	    opts->opts_size) {
+		if (opts->small_buf_cache_size > opts->small_buf_pool_size / 2) {
+			SPDK_ERRLOG("small_buf_cache_size must be at most %" PRIu32 "\n",
+				    opts->small_buf_pool_size / 2);
+			return -1;
+		}
+
+		if (opts->large_buf_cache_size > opts->large_buf_pool_size / 2) {
+			SPDK_ERRLOG("large_buf_cache_size must be at most %" PRIu32 "\n",
+				    opts->large_buf_pool_size / 2);
+			return -1;
+		}
+	}
+
 #define SET_FIELD(field) \
         if (offsetof(struct spdk_bdev_opts, field) + sizeof(opts->field) <= opts->opts_size) { \
                 g_bdev_opts.field = opts->field; \
@@ -436,6 +510,8 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(small_buf_pool_size);
 	SET_FIELD(large_buf_pool_size);
+	SET_FIELD(small_buf_cache_size);
+	SET_FIELD(large_buf_cache_size);
 
 	g_bdev_opts.opts_size = opts->opts_size;
 
@@ -957,6 +1033,220 @@ _bdev_io_set_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t len)
 	_bdev_io_set_md_buf(bdev_io);
 }
 
+static inline uint32_t
+bdev_buf_cache_batch_size(struct bdev_buf_cache *cache)
+{
+	return spdk_min(spdk_max(cache->size / 2, 1), BUF_CACHE_BATCH_SIZE);
+}
+
+static void *
+bdev_buf_cache_get(struct bdev_buf_cache *cache, struct spdk_mempool *pool)
+{
+	struct bdev_buf *buf;
+	void *bufs[BUF_CACHE_BATCH_SIZE];
+	uint32_t i, count;
+
+	buf = STAILQ_FIRST(&cache->bufs);
+	if (spdk_likely(buf != NULL)) {
+		STAILQ_REMOVE_HEAD(&cache->bufs, stailq);
+		cache->count--;
+		return buf;
+	}
+
+	if (cache->size == 0) {
+		return spdk_mempool_get(pool);
+	}
+
+	/* Refill the cache in one batch. If the pool cannot provide a whole batch,
+	 *  try to get at least the one buffer needed now.
+	 */
+	count = bdev_buf_cache_batch_size(cache);
+	if (spdk_mempool_get_bulk(pool, bufs, count) != 0) {
+		return spdk_mempool_get(pool);
+	}
+
+	for (i = 1; i < count; i++) {
+		buf = bufs[i];
+		STAILQ_INSERT_HEAD(&cache->bufs, buf, stailq);
+	}
+	cache->count = count - 1;
+
+	return bufs[0];
+}
+
+static void
+bdev_buf_cache_put(struct bdev_buf_cache *cache, struct spdk_mempool *pool, void *_buf)
+{
+	struct bdev_buf *buf = _buf;
+	void *bufs[BUF_CACHE_BATCH_SIZE];
+	uint32_t i, count;
+
+	if (spdk_likely(cache->count < cache->size)) {
+		STAILQ_INSERT_HEAD(&cache->bufs, buf, stailq);
+		cache->count++;
+		return;
+	}
+
+	if (cache->size == 0) {
+		spdk_mempool_put(pool, _buf);
+		return;
+	}
+
+	/* The cache is full. Return this buffer together with a batch of cached buffers. */
+	count = bdev_buf_cache_batch_size(cache);
+	bufs[0] = _buf;
+	for (i = 1; i < count; i++) {
+		buf = STAILQ_FIRST(&cache->bufs);
+		assert(buf != NULL);
+		STAILQ_REMOVE_HEAD(&cache->bufs, stailq);
+		bufs[i] = buf;
+	}
+	cache->count -= count - 1;
+
+	spdk_mempool_put_bulk(pool, bufs, count);
+}
+
+static void
+bdev_buf_cache_release(struct bdev_buf_cache *cache, struct spdk_mempool *pool)
+{
+	struct bdev_buf *buf;
+
+	while ((buf = STAILQ_FIRST(&cache->bufs)) != NULL) {
+		STAILQ_REMOVE_HEAD(&cache->bufs, stailq);
+		spdk_mempool_put(pool, buf);
+	}
+
+	cache->count = 0;
+}
+
+struct bdev_buf_rebalance_ctx {
+	struct spdk_io_channel	*mgmt_io_ch;
+	bool			large;
+};
+
+static void
+bdev_mgmt_channel_release_bufs(struct spdk_io_channel_iter *i)
+{
+	struct bdev_buf_rebalance_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bdev_mgmt_channel *mgmt_ch = spdk_io_channel_get_ctx(ch);
+
+	if (ctx->large) {
+		bdev_buf_cache_release(&mgmt_ch->buf_large_cache, g_bdev_mgr.buf_large_pool);
+	} else {
+		bdev_buf_cache_release(&mgmt_ch->buf_small_cache, g_bdev_mgr.buf_small_pool);
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+bdev_mgmt_channel_rebalance_bufs_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct bdev_buf_rebalance_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_bdev_mgmt_channel *mgmt_ch = spdk_io_channel_get_ctx(ctx->mgmt_io_ch);
+	struct spdk_mempool *pool;
+	bdev_io_stailq_t *stailq;
+	struct spdk_bdev_io *bdev_io;
+	void *buf;
+
+	if (ctx->large) {
+		mgmt_ch->buf_large_cache.rebalancing = false;
+		pool = g_bdev_mgr.buf_large_pool;
+		stailq = &mgmt_ch->need_buf_large;
+	} else {
+		mgmt_ch->buf_small_cache.rebalancing = false;
+		pool = g_bdev_mgr.buf_small_pool;
+		stailq = &mgmt_ch->need_buf_small;
+	}
+
+	/* Hand the buffers returned by other threads to the I/Os waiting on this thread. */
+	while (!STAILQ_EMPTY(stailq)) {
+		buf = spdk_mempool_get(pool);
+		if (buf == NULL) {
+			break;
+		}
+
+		bdev_io = STAILQ_FIRST(stailq);
+		STAILQ_REMOVE_HEAD(stailq, internal.buf_link);
+		_bdev_io_set_buf(bdev_io, buf, bdev_io->internal.buf_len);
+	}
+
+	spdk_put_io_channel(ctx->mgmt_io_ch);
+	free(ctx);
+}
+
+static void bdev_mgmt_channel_rebalance_bufs(struct spdk_bdev_mgmt_channel *mgmt_ch, bool large);
+
+static int
+bdev_mgmt_channel_rebalance_bufs_poll(void *arg)
+{
+	struct spdk_bdev_mgmt_channel *mgmt_ch = arg;
+
+	spdk_poller_unregister(&mgmt_ch->buf_rebalance_poller);
+
+	if (mgmt_ch->buf_small_cache.rebalance_pending) {
+		bdev_mgmt_channel_rebalance_bufs(mgmt_ch, false);
+	}
+	if (mgmt_ch->buf_large_cache.rebalance_pending) {
+		bdev_mgmt_channel_rebalance_bufs(mgmt_ch, true);
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+/*
+ * Ask all threads to return the buffers held in their caches to the global pool.
+ *  I/Os waiting for a buffer on the current thread are retried when all threads
+ *  have responded. A cache is rebalanced at most once per
+ *  BUF_CACHE_REBALANCE_INTERVAL_USEC, later requests are deferred until then.
+ */
+static void
+bdev_mgmt_channel_rebalance_bufs(struct spdk_bdev_mgmt_channel *mgmt_ch, bool large)
+{
+	struct bdev_buf_cache *cache;
+	struct bdev_buf_rebalance_ctx *ctx;
+	uint64_t now, delay_us;
+
+	cache = large ? &mgmt_ch->buf_large_cache : &mgmt_ch->buf_small_cache;
+	if (cache->rebalancing) {
+		return;
+	}
+
+	now = spdk_get_ticks();
+	if (now < cache->next_rebalance_tsc) {
+		cache->rebalance_pending = true;
+		if (mgmt_ch->buf_rebalance_poller == NULL) {
+			delay_us = (cache->next_rebalance_tsc - now) * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
+			mgmt_ch->buf_rebalance_poller = SPDK_POLLER_REGISTER(bdev_mgmt_channel_rebalance_bufs_poll,
+							mgmt_ch, delay_us);
+		}
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return;
+	}
+
+	/* Hold a reference so that the management channel outlives the iteration. */
+	ctx->mgmt_io_ch = spdk_get_io_channel(&g_bdev_mgr);
+	if (ctx->mgmt_io_ch == NULL) {
+		free(ctx);
+		return;
+	}
+	assert(spdk_io_channel_get_ctx(ctx->mgmt_io_ch) == mgmt_ch);
+
+	ctx->large = large;
+	cache->rebalancing = true;
+	cache->rebalance_pending = false;
+	cache->next_rebalance_tsc = now + BUF_CACHE_REBALANCE_INTERVAL_USEC * spdk_get_ticks_hz() /
+				    SPDK_SEC_TO_USEC;
+
+	spdk_for_each_channel(&g_bdev_mgr, bdev_mgmt_channel_release_bufs, ctx,
+			      bdev_mgmt_channel_rebalance_bufs_done);
+}
+
 static void
 _bdev_io_put_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t buf_len)
 {
@@ -964,6 +1254,7 @@ _bdev_io_put_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t buf_len)
 	struct spdk_mempool *pool;
 	struct spdk_bdev_io *tmp;
 	bdev_io_stailq_t *stailq;
+	struct bdev_buf_cache *cache;
 	struct spdk_bdev_mgmt_channel *ch;
 	uint64_t md_len, alignment;
 
@@ -975,13 +1266,15 @@ _bdev_io_put_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t buf_len)
 	    SPDK_BDEV_POOL_ALIGNMENT) {
 		pool = g_bdev_mgr.buf_small_pool;
 		stailq = &ch->need_buf_small;
+		cache = &ch->buf_small_cache;
 	} else {
 		pool = g_bdev_mgr.buf_large_pool;
 		stailq = &ch->need_buf_large;
+		cache = &ch->buf_large_cache;
 	}
 
 	if (STAILQ_EMPTY(stailq)) {
-		spdk_mempool_put(pool, buf);
+		bdev_buf_cache_put(cache, pool, buf);
 	} else {
 		tmp = STAILQ_FIRST(stailq);
 		STAILQ_REMOVE_HEAD(stailq, internal.buf_link);
@@ -1201,8 +1494,10 @@ bdev_io_get_buf(struct spdk_bdev_io *bdev_io, uint64_t len)
 	struct spdk_bdev *bdev = bdev_io->bdev;
 	struct spdk_mempool *pool;
 	bdev_io_stailq_t *stailq;
+	struct bdev_buf_cache *cache;
 	struct spdk_bdev_mgmt_channel *mgmt_ch;
 	uint64_t alignment, md_len;
+	bool large;
 	void *buf;
 
 	alignment = spdk_bdev_get_buf_align(bdev);
@@ -1222,16 +1517,26 @@ bdev_io_get_buf(struct spdk_bdev_io *bdev_io, uint64_t len)
 
 	if (len + alignment + md_len <= SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_SMALL_BUF_MAX_SIZE) +
 	    SPDK_BDEV_POOL_ALIGNMENT) {
+		large = false;
 		pool = g_bdev_mgr.buf_small_pool;
 		stailq = &mgmt_ch->need_buf_small;
+		cache = &mgmt_ch->buf_small_cache;
 	} else {
+		large = true;
 		pool = g_bdev_mgr.buf_large_pool;
 		stailq = &mgmt_ch->need_buf_large;
+		cache = &mgmt_ch->buf_large_cache;
 	}
 
-	buf = spdk_mempool_get(pool);
+	buf = bdev_buf_cache_get(cache, pool);
 	if (!buf) {
+		if (large) {
+			bdev_io->internal.ch->stat.num_large_buf_waits++;
+		} else {
+			bdev_io->internal.ch->stat.num_small_buf_waits++;
+		}
 		STAILQ_INSERT_TAIL(stailq, bdev_io, internal.buf_link);
+		bdev_mgmt_channel_rebalance_bufs(mgmt_ch, large);
 	} else {
 		_bdev_io_set_buf(bdev_io, buf, len);
 	}
@@ -1350,6 +1655,8 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "bdev_io_pool_size", g_bdev_opts.bdev_io_pool_size);
 	spdk_json_write_named_uint32(w, "bdev_io_cache_size", g_bdev_opts.bdev_io_cache_size);
 	spdk_json_write_named_bool(w, "bdev_auto_examine", g_bdev_opts.bdev_auto_examine);
+	spdk_json_write_named_uint32(w, "small_buf_cache_size", g_bdev_opts.small_buf_cache_size);
+	spdk_json_write_named_uint32(w, "large_buf_cache_size", g_bdev_opts.large_buf_cache_size);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -1381,6 +1688,16 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_array_end(w);
 }
 
+/*
+ * Scale the per-thread data buffer cache with the number of cores, so that no more than
+ *  half of the pool ends up in the caches. The configured cache size is the upper bound.
+ */
+static uint32_t
+bdev_buf_cache_size(uint32_t cache_size, uint32_t pool_size)
+{
+	return spdk_min(cache_size, pool_size / (2 * spdk_env_get_core_count()));
+}
+
 static int
 bdev_mgmt_channel_create(void *io_device, void *ctx_buf)
 {
@@ -1391,6 +1708,13 @@ bdev_mgmt_channel_create(void *io_device, void *ctx_buf)
 	STAILQ_INIT(&ch->need_buf_small);
 	STAILQ_INIT(&ch->need_buf_large);
 
+	STAILQ_INIT(&ch->buf_small_cache.bufs);
+	ch->buf_small_cache.size = bdev_buf_cache_size(g_bdev_opts.small_buf_cache_size,
+				   g_bdev_opts.small_buf_pool_size);
+	STAILQ_INIT(&ch->buf_large_cache.bufs);
+	ch->buf_large_cache.size = bdev_buf_cache_size(g_bdev_opts.large_buf_cache_size,
+				   g_bdev_opts.large_buf_pool_size);
+
 	STAILQ_INIT(&ch->per_thread_cache);
 	ch->bdev_io_cache_size = g_bdev_opts.bdev_io_cache_size;
 
@@ -1423,6 +1747,10 @@ bdev_mgmt_channel_destroy(void *io_device, void *ctx_buf)
 		SPDK_ERRLOG("Module channel list wasn't empty on mgmt channel free\n");
 	}
 
+	spdk_poller_unregister(&ch->buf_rebalance_poller);
+	bdev_buf_cache_release(&ch->buf_small_cache, g_bdev_mgr.buf_small_pool);
+	bdev_buf_cache_release(&ch->buf_large_cache, g_bdev_mgr.buf_large_pool);
+
 	while (!STAILQ_EMPTY(&ch->per_thread_cache)) {
 		bdev_io = STAILQ_FIRST(&ch->per_thread_cache);
 		STAILQ_REMOVE_HEAD(&ch->per_thread_cache, internal.buf_link);
@@ -1591,9 +1919,11 @@ spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 	/**
 	 * Ensure no more than half of the total buffers end up local caches, by
 	 *   using spdk_env_get_core_count() to determine how many local caches we need
-	 *   to account for.
+	 *   to account for.  The mempool cache is not used if the per-thread buffer
+	 *   cache of the management channel is enabled.
 	 */
-	cache_size = BUF_SMALL_POOL_SIZE / (2 * spdk_env_get_core_count());
+	cache_size = g_bdev_opts.small_buf_cache_size ? 0 :
+		     BUF_SMALL_POOL_SIZE / (2 * spdk_env_get_core_count());
 	snprintf(mempool_name, sizeof(mempool_name), "buf_small_pool_%d", getpid());
 
 	g_bdev_mgr.buf_small_pool = spdk_mempool_create(mempool_name,
@@ -1608,7 +1938,8 @@ spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 		return;
 	}
 
-	cache_size = BUF_LARGE_POOL_SIZE / (2 * spdk_env_get_core_count());
+	cache_size = g_bdev_opts.large_buf_cache_size ? 0 :
+		     BUF_LARGE_POOL_SIZE / (2 * spdk_env_get_core_count());
 	snprintf(mempool_name, sizeof(mempool_name), "buf_large_pool_%d", getpid());
 
 	g_bdev_mgr.buf_large_pool = spdk_mempool_create(mempool_name,
@@ -2238,15 +2569,27 @@ bdev_queue_io_wait_with_cb(struct spdk_bdev_io *bdev_io, spdk_bdev_io_wait_cb cb
 	}
 }
 
+static inline uint32_t
+bdev_rw_io_boundary(struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev *bdev = bdev_io->bdev;
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE && bdev->split_on_write_unit) {
+		return bdev->write_unit_size;
+	} else if (bdev->split_on_optimal_io_boundary) {
+		return bdev->optimal_io_boundary;
+	}
+
+	return 0;
+}
+
 static bool
 bdev_rw_should_split(struct spdk_bdev_io *bdev_io)
 {
-	uint32_t io_boundary = bdev_io->bdev->optimal_io_boundary;
+	uint32_t io_boundary = bdev_rw_io_boundary(bdev_io);
 	uint32_t max_size = bdev_io->bdev->max_segment_size;
 	int max_segs = bdev_io->bdev->max_num_segments;
 
-	io_boundary = bdev_io->bdev->split_on_optimal_io_boundary ? io_boundary : 0;
-
 	if (spdk_likely(!io_boundary && !max_segs && !max_size)) {
 		return false;
 	}
@@ -2448,7 +2791,7 @@ _bdev_rw_split(void *_bdev_io)
 	uint32_t to_next_boundary, to_next_boundary_bytes, to_last_block_bytes;
 	uint32_t iovcnt, iov_len, child_iovsize;
 	uint32_t blocklen = bdev->blocklen;
-	uint32_t io_boundary = bdev->optimal_io_boundary;
+	uint32_t io_boundary = bdev_rw_io_boundary(bdev_io);
 	uint32_t max_segment_size = bdev->max_segment_size;
 	uint32_t max_child_iovcnt = bdev->max_num_segments;
 	void *md_buf = NULL;
@@ -2457,7 +2800,7 @@ _bdev_rw_split(void *_bdev_io)
 	max_segment_size = max_segment_size ? max_segment_size : UINT32_MAX;
 	max_child_iovcnt = max_child_iovcnt ? spdk_min(max_child_iovcnt, BDEV_IO_NUM_CHILD_IOV) :
 			   BDEV_IO_NUM_CHILD_IOV;
-	io_boundary = bdev->split_on_optimal_io_boundary ? io_boundary : UINT32_MAX;
+	io_boundary = io_boundary ? io_boundary : UINT32_MAX;
 
 	remaining = bdev_io->u.bdev.split_remaining_num_blocks;
 	current_offset = bdev_io->u.bdev.split_current_offset_blocks;
@@ -2624,11 +2967,24 @@ static void
 parent_bdev_io_complete(void *ctx, int rc)
 {
 	struct spdk_bdev_io *parent_io = ctx;
+	struct spdk_accel_sequence *seq = parent_io->internal.accel_sequence;
 
 	if (rc) {
 		parent_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
 	}
 
+	if (spdk_unlikely(seq != NULL)) {
+		parent_io->internal.accel_sequence = NULL;
+		if (parent_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+			/* The data that was read can be transformed now */
+			assert(parent_io->type == SPDK_BDEV_IO_TYPE_READ);
+			spdk_accel_sequence_finish(seq, parent_bdev_io_complete, parent_io);
+			return;
+		}
+
+		spdk_accel_sequence_abort(seq);
+	}
+
 	parent_io->internal.cb(parent_io, parent_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS,
 			       parent_io->internal.caller_ctx);
 }
@@ -2828,14 +3184,31 @@ bdev_io_range_is_locked(struct spdk_bdev_io *bdev_io, struct lba_range *range)
 	}
 }
 
+static void bdev_io_submit_continue(struct spdk_bdev_io *bdev_io);
+
+static void
+bdev_io_submit_sequence_cb(void *ctx, int status)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+
+	bdev_io->internal.accel_sequence = NULL;
+	if (spdk_unlikely(status != 0)) {
+		SPDK_ERRLOG("Failed to execute accel sequence, status=%d\n", status);
+		bdev_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
+		bdev_io->internal.submit_tsc = spdk_get_ticks();
+		bdev_io_complete(bdev_io);
+		return;
+	}
+
+	bdev_io_submit_continue(bdev_io);
+}
+
 void
 bdev_io_submit(struct spdk_bdev_io *bdev_io)
 {
-	struct spdk_bdev *bdev = bdev_io->bdev;
-	struct spdk_thread *thread = spdk_bdev_io_get_thread(bdev_io);
 	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
 
-	assert(thread != NULL);
+	assert(spdk_bdev_io_get_thread(bdev_io) != NULL);
 	assert(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
 
 	if (!TAILQ_EMPTY(&ch->locked_ranges)) {
@@ -2851,6 +3224,24 @@ bdev_io_submit(struct spdk_bdev_io *bdev_io)
 
 	TAILQ_INSERT_TAIL(&ch->io_submitted, bdev_io, internal.ch_link);
 
+	if (spdk_unlikely(bdev_io->internal.accel_sequence != NULL) &&
+	    bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		/* The data needs to be transformed before it's written */
+		spdk_accel_sequence_finish(bdev_io->internal.accel_sequence,
+					   bdev_io_submit_sequence_cb, bdev_io);
+		return;
+	}
+
+	bdev_io_submit_continue(bdev_io);
+}
+
+static void
+bdev_io_submit_continue(struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_bdev *bdev = bdev_io->bdev;
+	struct spdk_thread *thread = spdk_bdev_io_get_thread(bdev_io);
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+
 	if (bdev_io_should_split(bdev_io)) {
 		bdev_io->internal.submit_tsc = spdk_get_ticks();
 		spdk_trace_record_tsc(bdev_io->internal.submit_tsc, TRACE_BDEV_IO_START, 0, 0,
@@ -2903,19 +3294,44 @@ _bdev_io_ext_use_bounce_buffer(struct spdk_bdev_io *bdev_io)
 				       bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 }
 
+static inline struct spdk_accel_sequence *
+_bdev_io_ext_opts_get_sequence(struct spdk_bdev_ext_io_opts *opts)
+{
+	if (opts->size < offsetof(struct spdk_bdev_ext_io_opts, accel_sequence) +
+	    sizeof(opts->accel_sequence)) {
+		return NULL;
+	}
+
+	return opts->accel_sequence;
+}
+
 static inline void
 _bdev_io_submit_ext(struct spdk_bdev_desc *desc, struct spdk_bdev_io *bdev_io,
 		    struct spdk_bdev_ext_io_opts *opts, bool copy_opts)
 {
 	if (opts) {
 		bool use_pull_push = opts->memory_domain && !desc->memory_domains_supported;
+		/*
+		 * The bdev layer executes the sequence if the module doesn't support it or the I/O
+		 * gets split, as it can't be shared by the child I/Os.
+		 */
+		bool exec_sequence = _bdev_io_ext_opts_get_sequence(opts) != NULL &&
+				     (!desc->accel_sequence_supported[bdev_io->type] ||
+				      bdev_io_should_split(bdev_io));
 		assert(opts->size <= sizeof(*opts));
 		/*
 		 * copy if size is smaller than opts struct to avoid having to check size
 		 * on every access to bdev_io->u.bdev.ext_opts
 		 */
-		if (copy_opts || use_pull_push || opts->size < sizeof(*opts)) {
+		if (copy_opts || use_pull_push || exec_sequence || opts->size < sizeof(*opts)) {
 			_bdev_io_copy_ext_opts(bdev_io, opts);
+			if (exec_sequence) {
+				/* Hide the sequence from the module and from the child I/Os */
+				bdev_io->internal.accel_sequence =
+					bdev_io->internal.ext_opts_copy.accel_sequence;
+				bdev_io->internal.ext_opts_copy.accel_sequence = NULL;
+				bdev_io->internal.ext_opts = &bdev_io->internal.ext_opts_copy;
+			}
 			if (use_pull_push) {
 				_bdev_io_ext_use_bounce_buffer(bdev_io);
 				return;
@@ -2959,6 +3375,7 @@ bdev_io_init(struct spdk_bdev_io *bdev_io,
 	bdev_io->internal.get_buf_cb = NULL;
 	bdev_io->internal.get_aux_buf_cb = NULL;
 	bdev_io->internal.ext_opts = NULL;
+	bdev_io->internal.accel_sequence = NULL;
 	bdev_io->internal.data_transfer_cpl = NULL;
 }
 
@@ -3338,6 +3755,7 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 
 	memset(&ch->stat, 0, sizeof(ch->stat));
 	ch->stat.ticks_rate = spdk_get_ticks_hz();
+	memset(&ch->latency_stat, 0, sizeof(ch->latency_stat));
 	ch->io_outstanding = 0;
 	TAILQ_INIT(&ch->queued_resets);
 	TAILQ_INIT(&ch->locked_ranges);
@@ -3554,6 +3972,100 @@ bdev_io_stat_add(struct spdk_bdev_io_stat *total, struct spdk_bdev_io_stat *add)
 	total->read_latency_ticks += add->read_latency_ticks;
 	total->write_latency_ticks += add->write_latency_ticks;
 	total->unmap_latency_ticks += add->unmap_latency_ticks;
+	total->num_small_buf_waits += add->num_small_buf_waits;
+	total->num_large_buf_waits += add->num_large_buf_waits;
+}
+
+static inline void
+bdev_io_latency_tally(struct spdk_bdev_io_latency *latency, uint64_t ticks)
+{
+	if (latency->num_ios == 0 || ticks < latency->min_ticks) {
+		latency->min_ticks = ticks;
+	}
+	if (ticks > latency->max_ticks) {
+		latency->max_ticks = ticks;
+	}
+	latency->num_ios++;
+
+	/* Histograms are allocated on the first completion of each I/O type so that
+	 * channels only pay the memory cost for the I/O types they actually see.
+	 */
+	if (spdk_unlikely(latency->histogram == NULL)) {
+		latency->histogram = spdk_histogram_data_alloc_sized(SPDK_BDEV_LATENCY_HISTOGRAM_BUCKET_SHIFT);
+		if (latency->histogram == NULL) {
+			return;
+		}
+	}
+
+	spdk_histogram_data_tally(latency->histogram, ticks);
+}
+
+static int
+bdev_latency_stat_add(struct spdk_bdev_latency_stat *total, struct spdk_bdev_latency_stat *add)
+{
+	struct spdk_bdev_io_latency *dst, *src;
+	int i, rc = 0;
+
+	for (i = 0; i < SPDK_BDEV_NUM_LATENCY_IO_TYPES; i++) {
+		dst = &total->io_type[i];
+		src = &add->io_type[i];
+
+		if (src->num_ios == 0) {
+			continue;
+		}
+
+		if (dst->num_ios == 0 || src->min_ticks < dst->min_ticks) {
+			dst->min_ticks = src->min_ticks;
+		}
+		dst->max_ticks = spdk_max(dst->max_ticks, src->max_ticks);
+		dst->num_ios += src->num_ios;
+
+		if (src->histogram == NULL) {
+			continue;
+		}
+
+		if (dst->histogram == NULL) {
+			dst->histogram = spdk_histogram_data_alloc_sized(SPDK_BDEV_LATENCY_HISTOGRAM_BUCKET_SHIFT);
+			if (dst->histogram == NULL) {
+				rc = -ENOMEM;
+				continue;
+			}
+		}
+
+		spdk_histogram_data_merge(dst->histogram, src->histogram);
+	}
+
+	return rc;
+}
+
+static void
+bdev_latency_stat_reset(struct spdk_bdev_latency_stat *stat)
+{
+	struct spdk_bdev_io_latency *latency;
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_NUM_LATENCY_IO_TYPES; i++) {
+		latency = &stat->io_type[i];
+
+		latency->num_ios = 0;
+		latency->min_ticks = 0;
+		latency->max_ticks = 0;
+		if (latency->histogram != NULL) {
+			spdk_histogram_data_reset(latency->histogram);
+		}
+	}
+}
+
+void
+spdk_bdev_latency_stat_clear(struct spdk_bdev_latency_stat *stat)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_NUM_LATENCY_IO_TYPES; i++) {
+		spdk_histogram_data_free(stat->io_type[i].histogram);
+	}
+
+	memset(stat, 0, sizeof(*stat));
 }
 
 static void
@@ -3581,6 +4093,10 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 	/* This channel is going away, so add its statistics into the bdev so that they don't get lost. */
 	pthread_mutex_lock(&ch->bdev->internal.mutex);
 	bdev_io_stat_add(&ch->bdev->internal.stat, &ch->stat);
+	if (bdev_latency_stat_add(&ch->bdev->internal.latency_stat, &ch->latency_stat) != 0) {
+		SPDK_WARNLOG("Unable to save latency statistics of channel %p for bdev %s\n",
+			     ch, ch->bdev->name);
+	}
 	pthread_mutex_unlock(&ch->bdev->internal.mutex);
 
 	bdev_abort_all_queued_io(&ch->queued_resets, ch);
@@ -3591,6 +4107,8 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 		spdk_histogram_data_free(ch->histogram);
 	}
 
+	spdk_bdev_latency_stat_clear(&ch->latency_stat);
+
 	bdev_channel_destroy_resource(ch);
 }
 
@@ -4325,7 +4843,10 @@ _bdev_io_check_opts(struct spdk_bdev_ext_io_opts *opts, struct iovec *iov)
 	       sizeof(opts->metadata) &&
 	       opts->size <= sizeof(*opts) &&
 	       /* When memory domain is used, the user must provide data buffers */
-	       (!opts->memory_domain || (iov && iov[0].iov_base));
+	       (!opts->memory_domain || (iov && iov[0].iov_base)) &&
+	       /* Same for accel sequences, which can't operate on memory domains */
+	       (!_bdev_io_ext_opts_get_sequence(opts) ||
+		(!opts->memory_domain && iov && iov[0].iov_base));
 }
 
 int
@@ -5313,6 +5834,73 @@ spdk_bdev_get_device_stat(struct spdk_bdev *bdev, struct spdk_bdev_io_stat *stat
 			      bdev_get_device_stat_done);
 }
 
+static void
+bdev_get_device_latency_stat_done(struct spdk_io_channel_iter *i, int status)
+{
+	void *io_device = spdk_io_channel_iter_get_io_device(i);
+	struct spdk_bdev_latency_stat_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb(__bdev_from_io_dev(io_device), ctx->stat, ctx->cb_arg, ctx->rc);
+	free(ctx);
+}
+
+static void
+bdev_get_each_channel_latency_stat(struct spdk_io_channel_iter *i)
+{
+	struct spdk_bdev_latency_stat_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bdev_channel *channel = spdk_io_channel_get_ctx(ch);
+	int rc;
+
+	rc = bdev_latency_stat_add(ctx->stat, &channel->latency_stat);
+	if (rc != 0 && ctx->rc == 0) {
+		ctx->rc = rc;
+	}
+
+	if (ctx->reset) {
+		bdev_latency_stat_reset(&channel->latency_stat);
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+void
+spdk_bdev_get_device_latency_stat(struct spdk_bdev *bdev, struct spdk_bdev_latency_stat *stat,
+				  bool reset, spdk_bdev_get_device_latency_stat_cb cb, void *cb_arg)
+{
+	struct spdk_bdev_latency_stat_ctx *ctx;
+
+	assert(bdev != NULL);
+	assert(stat != NULL);
+	assert(cb != NULL);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		SPDK_ERRLOG("Unable to allocate memory for spdk_bdev_latency_stat_ctx\n");
+		cb(bdev, stat, cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->stat = stat;
+	ctx->reset = reset;
+	ctx->cb = cb;
+	ctx->cb_arg = cb_arg;
+
+	/* Start with the statistics from previously deleted channels. */
+	pthread_mutex_lock(&bdev->internal.mutex);
+	ctx->rc = bdev_latency_stat_add(stat, &bdev->internal.latency_stat);
+	if (reset) {
+		bdev_latency_stat_reset(&bdev->internal.latency_stat);
+	}
+	pthread_mutex_unlock(&bdev->internal.mutex);
+
+	/* Then iterate and merge the statistics from each existing channel. */
+	spdk_for_each_channel(__bdev_to_io_dev(bdev),
+			      bdev_get_each_channel_latency_stat,
+			      ctx,
+			      bdev_get_device_latency_stat_done);
+}
+
 int
 spdk_bdev_nvme_admin_passthru(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 			      const struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes,
@@ -5496,7 +6084,8 @@ bdev_abort_io(struct spdk_bdev_desc *desc, struct spdk_bdev_channel *channel,
 	bdev_io->type = SPDK_BDEV_IO_TYPE_ABORT;
 	bdev_io_init(bdev_io, bdev, cb_arg, cb);
 
-	if (bdev->split_on_optimal_io_boundary && bdev_io_should_split(bio_to_abort)) {
+	if ((bdev->split_on_optimal_io_boundary || bdev->split_on_write_unit) &&
+	    bdev_io_should_split(bio_to_abort)) {
 		bdev_io->u.bdev.abort.bio_cb_arg = bio_to_abort;
 
 		/* Parent abort request is not submitted directly, but to manage its
@@ -5675,6 +6264,20 @@ spdk_bdev_queue_io_wait(struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 	return 0;
 }
 
+static void
+bdev_io_complete_sequence_cb(void *ctx, int status)
+{
+	struct spdk_bdev_io *bdev_io = ctx;
+
+	bdev_io->internal.accel_sequence = NULL;
+	if (spdk_unlikely(status != 0)) {
+		SPDK_ERRLOG("Failed to execute accel sequence, status=%d\n", status);
+		bdev_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	bdev_io_complete(bdev_io);
+}
+
 static inline void
 bdev_io_complete(void *ctx)
 {
@@ -5701,6 +6304,19 @@ bdev_io_complete(void *ctx)
 		return;
 	}
 
+	if (spdk_unlikely(bdev_io->internal.accel_sequence != NULL)) {
+		if (bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+			/* The data that was read can be transformed now */
+			assert(bdev_io->type == SPDK_BDEV_IO_TYPE_READ);
+			spdk_accel_sequence_finish(bdev_io->internal.accel_sequence,
+						   bdev_io_complete_sequence_cb, bdev_io);
+			return;
+		}
+
+		spdk_accel_sequence_abort(bdev_io->internal.accel_sequence);
+		bdev_io->internal.accel_sequence = NULL;
+	}
+
 	tsc = spdk_get_ticks();
 	tsc_diff = tsc - bdev_io->internal.submit_tsc;
 	spdk_trace_record_tsc(tsc, TRACE_BDEV_IO_DONE, 0, 0, (uintptr_t)bdev_io,
@@ -5718,18 +6334,30 @@ bdev_io_complete(void *ctx)
 			bdev_io->internal.ch->stat.bytes_read += bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
 			bdev_io->internal.ch->stat.num_read_ops++;
 			bdev_io->internal.ch->stat.read_latency_ticks += tsc_diff;
+			bdev_io_latency_tally(&bdev_ch->latency_stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_READ],
+					      tsc_diff);
 			break;
 		case SPDK_BDEV_IO_TYPE_WRITE:
 			bdev_io->internal.ch->stat.bytes_written += bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
 			bdev_io->internal.ch->stat.num_write_ops++;
 			bdev_io->internal.ch->stat.write_latency_ticks += tsc_diff;
+			bdev_io_latency_tally(&bdev_ch->latency_stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_WRITE],
+					      tsc_diff);
 			break;
 		case SPDK_BDEV_IO_TYPE_UNMAP:
 			bdev_io->internal.ch->stat.bytes_unmapped += bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
 			bdev_io->internal.ch->stat.num_unmap_ops++;
 			bdev_io->internal.ch->stat.unmap_latency_ticks += tsc_diff;
+			bdev_io_latency_tally(&bdev_ch->latency_stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_UNMAP],
+					      tsc_diff);
+			break;
+		case SPDK_BDEV_IO_TYPE_FLUSH:
+			bdev_io_latency_tally(&bdev_ch->latency_stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_FLUSH],
+					      tsc_diff);
 			break;
 		case SPDK_BDEV_IO_TYPE_ZCOPY:
+			bdev_io_latency_tally(&bdev_ch->latency_stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_ZCOPY],
+					      tsc_diff);
 			/* Track the data in the start phase only */
 			if (bdev_io->u.bdev.zcopy.start) {
 				if (bdev_io->u.bdev.zcopy.populate) {
@@ -6175,6 +6803,7 @@ bdev_destroy_cb(void *io_device)
 
 	pthread_mutex_destroy(&bdev->internal.mutex);
 	free(bdev->internal.qos);
+	spdk_bdev_latency_stat_clear(&bdev->internal.latency_stat);
 
 	rc = bdev->fn_table->destruct(bdev->ctxt);
 	if (rc < 0) {
@@ -6443,6 +7072,7 @@ bdev_desc_alloc(struct spdk_bdev *bdev, spdk_bdev_event_cb_t event_cb, void *eve
 {
 	struct spdk_bdev_desc *desc;
 	unsigned int event_id;
+	int i;
 
 	desc = calloc(1, sizeof(*desc));
 	if (desc == NULL) {
@@ -6454,6 +7084,12 @@ bdev_desc_alloc(struct spdk_bdev *bdev, spdk_bdev_event_cb_t event_cb, void *eve
 	TAILQ_INIT(&desc->free_media_events);
 
 	desc->memory_domains_supported = spdk_bdev_get_memory_domains(bdev, NULL, 0) > 0;
+	if (bdev->fn_table->accel_sequence_supported != NULL) {
+		for (i = 0; i < SPDK_BDEV_NUM_IO_TYPES; i++) {
+			desc->accel_sequence_supported[i] =
+				bdev->fn_table->accel_sequence_supported(bdev->ctxt, i);
+		}
+	}
 	desc->callback.event_fn = event_cb;
 	desc->callback.ctx = event_ctx;
 	pthread_mutex_init(&desc->mutex, NULL);
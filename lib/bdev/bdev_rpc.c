@@ -26,6 +26,8 @@ struct spdk_rpc_set_bdev_opts {
 	bool bdev_auto_examine;
 	uint32_t small_buf_pool_size;
 	uint32_t large_buf_pool_size;
+	uint32_t small_buf_cache_size;
+	uint32_t large_buf_cache_size;
 };
 
 static const struct spdk_json_object_decoder rpc_set_bdev_opts_decoders[] = {
@@ -34,6 +36,8 @@ static const struct spdk_json_object_decoder rpc_set_bdev_opts_decoders[] = {
 	{"bdev_auto_examine", offsetof(struct spdk_rpc_set_bdev_opts, bdev_auto_examine), spdk_json_decode_bool, true},
 	{"small_buf_pool_size", offsetof(struct spdk_rpc_set_bdev_opts, small_buf_pool_size), spdk_json_decode_uint32, true},
 	{"large_buf_pool_size", offsetof(struct spdk_rpc_set_bdev_opts, large_buf_pool_size), spdk_json_decode_uint32, true},
+	{"small_buf_cache_size", offsetof(struct spdk_rpc_set_bdev_opts, small_buf_cache_size), spdk_json_decode_uint32, true},
+	{"large_buf_cache_size", offsetof(struct spdk_rpc_set_bdev_opts, large_buf_cache_size), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -47,6 +51,8 @@ rpc_bdev_set_options(struct spdk_jsonrpc_request *request, const struct spdk_jso
 	rpc_opts.bdev_io_cache_size = UINT32_MAX;
 	rpc_opts.small_buf_pool_size = UINT32_MAX;
 	rpc_opts.large_buf_pool_size = UINT32_MAX;
+	rpc_opts.small_buf_cache_size = UINT32_MAX;
+	rpc_opts.large_buf_cache_size = UINT32_MAX;
 	rpc_opts.bdev_auto_examine = true;
 
 	if (params != NULL) {
@@ -73,6 +79,12 @@ rpc_bdev_set_options(struct spdk_jsonrpc_request *request, const struct spdk_jso
 	if (rpc_opts.large_buf_pool_size != UINT32_MAX) {
 		bdev_opts.large_buf_pool_size = rpc_opts.large_buf_pool_size;
 	}
+	if (rpc_opts.small_buf_cache_size != UINT32_MAX) {
+		bdev_opts.small_buf_cache_size = rpc_opts.small_buf_cache_size;
+	}
+	if (rpc_opts.large_buf_cache_size != UINT32_MAX) {
+		bdev_opts.large_buf_cache_size = rpc_opts.large_buf_cache_size;
+	}
 
 	rc = spdk_bdev_set_opts(&bdev_opts);
 
@@ -160,12 +172,14 @@ SPDK_RPC_REGISTER("bdev_examine", rpc_bdev_examine_bdev, SPDK_RPC_RUNTIME)
 struct rpc_bdev_get_iostat_ctx {
 	int bdev_count;
 	int rc;
+	bool reset_latency;
 	struct spdk_jsonrpc_request *request;
 	struct spdk_json_write_ctx *w;
 };
 
 struct rpc_bdev_iostat {
 	struct spdk_bdev_io_stat stat;
+	struct spdk_bdev_latency_stat latency_stat;
 	struct rpc_bdev_get_iostat_ctx *ctx;
 	struct spdk_bdev_desc *desc;
 };
@@ -205,12 +219,41 @@ rpc_bdev_get_iostat_done(struct rpc_bdev_get_iostat_ctx *ctx)
 }
 
 static void
-rpc_bdev_get_iostat_cb(struct spdk_bdev *bdev,
-		       struct spdk_bdev_io_stat *stat, void *cb_arg, int rc)
+rpc_bdev_write_io_latency(struct spdk_json_write_ctx *w, const char *name,
+			  struct spdk_bdev_io_latency *latency)
+{
+	uint64_t p50 = 0, p99 = 0, p999 = 0;
+
+	if (latency->histogram != NULL) {
+		/* Percentiles are upper bounds of histogram buckets, so they are capped
+		 * to the highest latency actually seen.
+		 */
+		p50 = spdk_min(spdk_histogram_data_get_percentile(latency->histogram, 50.0),
+			       latency->max_ticks);
+		p99 = spdk_min(spdk_histogram_data_get_percentile(latency->histogram, 99.0),
+			       latency->max_ticks);
+		p999 = spdk_min(spdk_histogram_data_get_percentile(latency->histogram, 99.9),
+				latency->max_ticks);
+	}
+
+	spdk_json_write_named_object_begin(w, name);
+	spdk_json_write_named_uint64(w, "num_ops", latency->num_ios);
+	spdk_json_write_named_uint64(w, "min_ticks", latency->min_ticks);
+	spdk_json_write_named_uint64(w, "max_ticks", latency->max_ticks);
+	spdk_json_write_named_uint64(w, "p50_ticks", p50);
+	spdk_json_write_named_uint64(w, "p99_ticks", p99);
+	spdk_json_write_named_uint64(w, "p999_ticks", p999);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_bdev_get_latency_stat_cb(struct spdk_bdev *bdev,
+			     struct spdk_bdev_latency_stat *latency_stat, void *cb_arg, int rc)
 {
 	struct rpc_bdev_iostat *_stat = cb_arg;
 	struct rpc_bdev_get_iostat_ctx *ctx = _stat->ctx;
 	struct spdk_json_write_ctx *w = ctx->w;
+	struct spdk_bdev_io_stat *stat = &_stat->stat;
 
 	if (rc != 0 || ctx->rc != 0) {
 		if (ctx->rc == 0) {
@@ -219,7 +262,7 @@ rpc_bdev_get_iostat_cb(struct spdk_bdev *bdev,
 		goto done;
 	}
 
-	assert(stat == &_stat->stat);
+	assert(latency_stat == &_stat->latency_stat);
 
 	spdk_json_write_object_begin(w);
 
@@ -243,6 +286,10 @@ rpc_bdev_get_iostat_cb(struct spdk_bdev *bdev,
 
 	spdk_json_write_named_uint64(w, "unmap_latency_ticks", stat->unmap_latency_ticks);
 
+	spdk_json_write_named_uint64(w, "num_small_buf_waits", stat->num_small_buf_waits);
+
+	spdk_json_write_named_uint64(w, "num_large_buf_waits", stat->num_large_buf_waits);
+
 	if (spdk_bdev_get_qd_sampling_period(bdev)) {
 		spdk_json_write_named_uint64(w, "queue_depth_polling_period",
 					     spdk_bdev_get_qd_sampling_period(bdev));
@@ -255,17 +302,56 @@ rpc_bdev_get_iostat_cb(struct spdk_bdev *bdev,
 					     spdk_bdev_get_weighted_io_time(bdev));
 	}
 
+	spdk_json_write_named_object_begin(w, "latency");
+	rpc_bdev_write_io_latency(w, "read",
+				  &latency_stat->io_type[SPDK_BDEV_LATENCY_IO_TYPE_READ]);
+	rpc_bdev_write_io_latency(w, "write",
+				  &latency_stat->io_type[SPDK_BDEV_LATENCY_IO_TYPE_WRITE]);
+	rpc_bdev_write_io_latency(w, "unmap",
+				  &latency_stat->io_type[SPDK_BDEV_LATENCY_IO_TYPE_UNMAP]);
+	rpc_bdev_write_io_latency(w, "flush",
+				  &latency_stat->io_type[SPDK_BDEV_LATENCY_IO_TYPE_FLUSH]);
+	rpc_bdev_write_io_latency(w, "zcopy",
+				  &latency_stat->io_type[SPDK_BDEV_LATENCY_IO_TYPE_ZCOPY]);
+	spdk_json_write_object_end(w);
+
 	spdk_json_write_object_end(w);
 
 done:
 	rpc_bdev_get_iostat_done(ctx);
 
+	spdk_bdev_latency_stat_clear(&_stat->latency_stat);
 	spdk_bdev_close(_stat->desc);
 	free(_stat);
 }
 
+static void
+rpc_bdev_get_iostat_cb(struct spdk_bdev *bdev,
+		       struct spdk_bdev_io_stat *stat, void *cb_arg, int rc)
+{
+	struct rpc_bdev_iostat *_stat = cb_arg;
+	struct rpc_bdev_get_iostat_ctx *ctx = _stat->ctx;
+
+	if (rc != 0 || ctx->rc != 0) {
+		if (ctx->rc == 0) {
+			ctx->rc = rc;
+		}
+		rpc_bdev_get_iostat_done(ctx);
+
+		spdk_bdev_close(_stat->desc);
+		free(_stat);
+		return;
+	}
+
+	assert(stat == &_stat->stat);
+
+	spdk_bdev_get_device_latency_stat(bdev, &_stat->latency_stat, ctx->reset_latency,
+					  rpc_bdev_get_latency_stat_cb, _stat);
+}
+
 struct rpc_bdev_get_iostat {
 	char *name;
+	bool reset_latency;
 };
 
 static void
@@ -276,6 +362,7 @@ free_rpc_bdev_get_iostat(struct rpc_bdev_get_iostat *r)
 
 static const struct spdk_json_object_decoder rpc_bdev_get_iostat_decoders[] = {
 	{"name", offsetof(struct rpc_bdev_get_iostat, name), spdk_json_decode_string, true},
+	{"reset_latency", offsetof(struct rpc_bdev_get_iostat, reset_latency), spdk_json_decode_bool, true},
 };
 
 static int
@@ -352,6 +439,7 @@ rpc_bdev_get_iostat(struct spdk_jsonrpc_request *request,
 	 */
 	ctx->bdev_count++;
 	ctx->request = request;
+	ctx->reset_latency = req.reset_latency;
 
 	if (desc != NULL) {
 		_stat = calloc(1, sizeof(struct rpc_bdev_iostat));
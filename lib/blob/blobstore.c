@@ -13,6 +13,7 @@
 #include "spdk/thread.h"
 #include "spdk/bit_array.h"
 #include "spdk/bit_pool.h"
+#include "spdk/barrier.h"
 #include "spdk/likely.h"
 #include "spdk/util.h"
 #include "spdk/string.h"
@@ -28,8 +29,17 @@ static int bs_register_md_thread(struct spdk_blob_store *bs);
 static int bs_unregister_md_thread(struct spdk_blob_store *bs);
 static void blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno);
 static void blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-		uint64_t cluster, uint32_t extent, struct spdk_blob_md_page *page,
+		uint64_t cluster, uint32_t extent, struct spdk_blob_md_page *page, bool cow_map,
 		spdk_blob_op_complete cb_fn, void *cb_arg);
+static void blob_cow_map_update_on_md_thread(struct spdk_blob *blob, struct spdk_blob_cow_map *map,
+		uint32_t cluster_num, uint32_t io_unit, uint32_t num_io_units,
+		struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg);
+static void blob_cow_map_compact_start_on_md_thread(struct spdk_blob *blob,
+		struct spdk_blob_cow_map *map, uint32_t cluster_num,
+		spdk_blob_op_complete cb_fn, void *cb_arg);
+static void blob_cow_map_compact_finish_on_md_thread(struct spdk_blob *blob,
+		struct spdk_blob_cow_map *map, uint32_t cluster_num, struct spdk_blob_md_page *page,
+		int bserrno, spdk_blob_op_complete cb_fn, void *cb_arg);
 
 static int blob_set_xattr(struct spdk_blob *blob, const char *name, const void *value,
 			  uint16_t value_len, bool internal);
@@ -39,6 +49,7 @@ static int blob_remove_xattr(struct spdk_blob *blob, const char *name, bool inte
 
 static void blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num,
 				   struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg);
+static void blob_sync_md(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg);
 
 static int
 blob_id_cmp(struct spdk_blob *blob1, struct spdk_blob *blob2)
@@ -132,6 +143,200 @@ blob_insert_cluster(struct spdk_blob *blob, uint32_t cluster_num, uint64_t clust
 	return 0;
 }
 
+static inline uint32_t
+bs_io_units_per_cluster(const struct spdk_blob_store *bs)
+{
+	return bs->cluster_sz / bs->io_unit_size;
+}
+
+static inline size_t
+bs_cow_map_desc_size(const struct spdk_blob_store *bs)
+{
+	return sizeof(struct spdk_blob_md_descriptor_cow_map) +
+	       spdk_divide_round_up(bs_io_units_per_cluster(bs), CHAR_BIT);
+}
+
+static inline struct spdk_blob_cow_map *
+blob_get_cow_map(const struct spdk_blob *blob, uint64_t cluster_num)
+{
+	if (spdk_likely(blob->cow_maps == NULL) || cluster_num >= blob->cow_map_array_size) {
+		return NULL;
+	}
+
+	/* The array is published before its size, see blob_cow_map_array_resize() */
+	spdk_smp_rmb();
+
+	return blob->cow_maps[cluster_num];
+}
+
+static struct spdk_blob_cow_map *
+blob_cow_map_alloc(struct spdk_blob_store *bs)
+{
+	struct spdk_blob_cow_map *map;
+
+	map = calloc(1, sizeof(*map));
+	if (map == NULL) {
+		return NULL;
+	}
+
+	map->io_units = spdk_bit_array_create(bs_io_units_per_cluster(bs));
+	if (map->io_units == NULL) {
+		free(map);
+		return NULL;
+	}
+	TAILQ_INIT(&map->waiters);
+
+	return map;
+}
+
+static void
+blob_cow_map_free(struct spdk_blob_cow_map *map)
+{
+	assert(TAILQ_EMPTY(&map->waiters));
+	spdk_bit_array_free(&map->io_units);
+	free(map);
+}
+
+static void
+blob_cow_map_array_free_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	free(spdk_io_channel_iter_get_ctx(i));
+}
+
+static void
+blob_cow_map_array_release(struct spdk_io_channel_iter *i)
+{
+	/* Once this runs, I/O on the channel's thread can no longer hold the old array */
+	spdk_for_each_channel_continue(i, 0);
+}
+
+/* I/O looks up the maps without locking, so the array is never reallocated in place.
+ * A larger copy is published instead and the old one is freed only after every
+ * channel of the blobstore has passed a message. */
+static int
+blob_cow_map_array_resize(struct spdk_blob *blob, size_t size)
+{
+	struct spdk_blob_cow_map **tmp, **old = blob->cow_maps;
+
+	if (size <= blob->cow_map_array_size) {
+		return 0;
+	}
+
+	tmp = calloc(size, sizeof(*tmp));
+	if (tmp == NULL) {
+		return -ENOMEM;
+	}
+	if (old != NULL) {
+		memcpy(tmp, old, sizeof(*tmp) * blob->cow_map_array_size);
+	}
+
+	blob->cow_maps = tmp;
+	spdk_smp_wmb();
+	blob->cow_map_array_size = size;
+
+	if (old != NULL) {
+		spdk_for_each_channel(blob->bs, blob_cow_map_array_release, old,
+				      blob_cow_map_array_free_cpl);
+	}
+
+	return 0;
+}
+
+/* The map can still be referenced by I/O in flight, so keep it around until the blob is freed. */
+static void
+blob_retire_cow_map(struct spdk_blob *blob, uint64_t cluster_num)
+{
+	struct spdk_blob_cow_map *map = blob->cow_maps[cluster_num];
+
+	assert(map != NULL);
+	blob->cow_maps[cluster_num] = NULL;
+	map->retired = true;
+	TAILQ_INSERT_TAIL(&blob->retired_cow_maps, map, link);
+}
+
+static void
+blob_free_cow_maps(struct spdk_blob *blob)
+{
+	struct spdk_blob_cow_map *map, *tmp;
+	size_t i;
+
+	for (i = 0; i < blob->cow_map_array_size; i++) {
+		if (blob->cow_maps[i] != NULL) {
+			blob_cow_map_free(blob->cow_maps[i]);
+		}
+	}
+	free(blob->cow_maps);
+	blob->cow_maps = NULL;
+	blob->cow_map_array_size = 0;
+
+	TAILQ_FOREACH_SAFE(map, &blob->retired_cow_maps, link, tmp) {
+		TAILQ_REMOVE(&blob->retired_cow_maps, map, link);
+		blob_cow_map_free(map);
+	}
+}
+
+/* Partially populated clusters are only created for thin clones using extent table,
+ * since the maps are persisted in extent pages. */
+static inline bool
+blob_sub_cluster_cow(const struct spdk_blob *blob)
+{
+	return blob->bs->sub_cluster_cow && blob->use_extent_table &&
+	       blob->parent_id != SPDK_BLOBID_INVALID;
+}
+
+/* Given an io_unit offset into a blob, look up if it was written to the blob,
+ * as opposed to still being backed by the parent. */
+static inline bool
+blob_io_unit_is_written(struct spdk_blob *blob, uint64_t io_unit)
+{
+	struct spdk_blob_cow_map *map;
+
+	if (!bs_io_unit_is_allocated(blob, io_unit)) {
+		return false;
+	}
+
+	/* The map is published before the cluster is inserted */
+	spdk_smp_rmb();
+
+	map = blob_get_cow_map(blob, bs_io_unit_to_cluster_number(blob, io_unit));
+	if (spdk_likely(map == NULL)) {
+		return true;
+	}
+
+	return spdk_bit_array_get(map->io_units, io_unit % bs_io_units_per_cluster(blob->bs));
+}
+
+/* Given an io_unit offset into a blob, look up the number of io_units until the
+ * next cluster boundary. Within a partially populated cluster, stop at the end of
+ * the run of io_units located on the same device instead.
+ */
+static inline uint64_t
+blob_num_io_units_to_boundary(struct spdk_blob *blob, uint64_t io_unit)
+{
+	struct spdk_blob_cow_map *map;
+	uint32_t boundary, offset, next;
+
+	boundary = bs_num_io_units_to_cluster_boundary(blob, io_unit);
+
+	map = blob_get_cow_map(blob, bs_io_unit_to_cluster_number(blob, io_unit));
+	if (spdk_likely(map == NULL)) {
+		return boundary;
+	}
+
+	offset = bs_io_units_per_cluster(blob->bs) - boundary;
+	if (spdk_bit_array_get(map->io_units, offset)) {
+		next = spdk_bit_array_find_first_clear(map->io_units, offset);
+	} else {
+		next = spdk_bit_array_find_first_set(map->io_units, offset);
+	}
+
+	if (next == UINT32_MAX) {
+		return boundary;
+	}
+
+	return next - offset;
+}
+
 static int
 bs_allocate_cluster(struct spdk_blob *blob, uint32_t cluster_num,
 		    uint64_t *cluster, uint32_t *lowest_free_md_page, bool update_map)
@@ -283,6 +488,7 @@ blob_alloc(struct spdk_blob_store *bs, spdk_blob_id id)
 	TAILQ_INIT(&blob->xattrs_internal);
 	TAILQ_INIT(&blob->pending_persists);
 	TAILQ_INIT(&blob->persists_to_complete);
+	TAILQ_INIT(&blob->retired_cow_maps);
 
 	return blob;
 }
@@ -314,6 +520,13 @@ blob_free(struct spdk_blob *blob)
 	free(blob->active.pages);
 	free(blob->clean.pages);
 
+	blob_free_cow_maps(blob);
+
+	if (blob->md_journal_dirty) {
+		TAILQ_REMOVE(&blob->bs->md_journal->dirty_blobs, blob, md_journal_link);
+	}
+	spdk_bit_array_free(&blob->md_journal_eps);
+
 	xattrs_free(&blob->xattrs);
 	xattrs_free(&blob->xattrs_internal);
 
@@ -531,6 +744,42 @@ blob_deserialize_xattr(struct spdk_blob *blob,
 }
 
 
+static int
+blob_deserialize_cow_map(struct spdk_blob *blob, const struct spdk_blob_md_descriptor_cow_map *desc)
+{
+	struct spdk_blob_cow_map *map;
+	int rc;
+
+	if (desc->length != bs_cow_map_desc_size(blob->bs) - sizeof(struct spdk_blob_md_descriptor)) {
+		return -EINVAL;
+	}
+
+	/* Extent page descriptor describing the cluster has to be parsed first */
+	if (desc->cluster_idx >= blob->active.num_clusters ||
+	    blob->active.clusters[desc->cluster_idx] == 0) {
+		return -EINVAL;
+	}
+
+	rc = blob_cow_map_array_resize(blob, blob->active.cluster_array_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (blob->cow_maps[desc->cluster_idx] != NULL) {
+		return -EINVAL;
+	}
+
+	map = blob_cow_map_alloc(blob->bs);
+	if (map == NULL) {
+		return -ENOMEM;
+	}
+
+	spdk_bit_array_load_mask(map->io_units, desc->io_unit_mask);
+	blob->cow_maps[desc->cluster_idx] = map;
+
+	return 0;
+}
+
 static int
 blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 {
@@ -767,6 +1016,23 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 			if (rc != 0) {
 				return rc;
 			}
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_COW_MAP) {
+			int rc;
+
+			rc = blob_deserialize_cow_map(blob, (struct spdk_blob_md_descriptor_cow_map *)desc);
+			if (rc != 0) {
+				return rc;
+			}
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_MD_JOURNAL) {
+			struct spdk_blob_md_descriptor_md_journal *desc_md_journal;
+
+			desc_md_journal = (struct spdk_blob_md_descriptor_md_journal *)desc;
+
+			if (desc_md_journal->length != sizeof(*desc_md_journal) - sizeof(*desc)) {
+				return -EINVAL;
+			}
+
+			blob->md_journal_seq = desc_md_journal->seq;
 		} else {
 			/* Unrecognized descriptor type.  Do not fail - just continue to the
 			 *  next descriptor.  If this descriptor is associated with some feature
@@ -1115,8 +1381,11 @@ blob_serialize_extent_page(const struct spdk_blob *blob,
 			   uint64_t cluster, struct spdk_blob_md_page *page)
 {
 	struct spdk_blob_md_descriptor_extent_page *desc_extent;
+	struct spdk_blob_md_descriptor_cow_map *desc_cow_map;
+	struct spdk_blob_cow_map *map;
 	uint64_t i, extent_idx;
 	uint64_t lba, lba_per_cluster;
+	uint8_t *buf;
 	uint64_t start_cluster_idx = (cluster / SPDK_EXTENTS_PER_EP) * SPDK_EXTENTS_PER_EP;
 
 	desc_extent = (struct spdk_blob_md_descriptor_extent_page *) page->descriptors;
@@ -1135,6 +1404,26 @@ blob_serialize_extent_page(const struct spdk_blob *blob,
 	}
 	desc_extent->length = sizeof(desc_extent->start_cluster_idx) +
 			      sizeof(desc_extent->cluster_idx[0]) * extent_idx;
+
+	/* Copy-on-write maps of partially populated clusters follow the extent page descriptor */
+	buf = (uint8_t *)desc_extent + sizeof(struct spdk_blob_md_descriptor) + desc_extent->length;
+	for (i = start_cluster_idx; i < start_cluster_idx + extent_idx; i++) {
+		map = blob_get_cow_map(blob, i);
+		if (map == NULL) {
+			continue;
+		}
+
+		assert(buf + bs_cow_map_desc_size(blob->bs) <= page->descriptors + sizeof(page->descriptors));
+		desc_cow_map = (struct spdk_blob_md_descriptor_cow_map *)buf;
+		desc_cow_map->type = SPDK_MD_DESCRIPTOR_TYPE_COW_MAP;
+		desc_cow_map->length = bs_cow_map_desc_size(blob->bs) - sizeof(struct spdk_blob_md_descriptor);
+		desc_cow_map->cluster_idx = i;
+		spdk_bit_array_store_mask(map->io_units, desc_cow_map->io_unit_mask);
+		buf += bs_cow_map_desc_size(blob->bs);
+	}
+
+	/* Terminate the descriptor list, the page might be reused */
+	memset(buf, 0, page->descriptors + sizeof(page->descriptors) - buf);
 }
 
 static void
@@ -1159,6 +1448,22 @@ blob_serialize_flags(const struct spdk_blob *blob,
 	*buf_sz -= sizeof(*desc);
 }
 
+static void
+blob_serialize_md_journal(uint64_t md_journal_seq, uint8_t *buf, size_t *buf_sz)
+{
+	struct spdk_blob_md_descriptor_md_journal *desc;
+
+	/* Serialized right after the flags, in the first page */
+	assert(*buf_sz >= sizeof(*desc));
+
+	desc = (struct spdk_blob_md_descriptor_md_journal *)buf;
+	desc->type = SPDK_MD_DESCRIPTOR_TYPE_MD_JOURNAL;
+	desc->length = sizeof(*desc) - sizeof(struct spdk_blob_md_descriptor);
+	desc->seq = md_journal_seq;
+
+	*buf_sz -= sizeof(*desc);
+}
+
 static int
 blob_serialize_xattrs(const struct spdk_blob *blob,
 		      const struct spdk_xattr_tailq *xattrs, bool internal,
@@ -1212,8 +1517,8 @@ blob_serialize_xattrs(const struct spdk_blob *blob,
 }
 
 static int
-blob_serialize(const struct spdk_blob *blob, struct spdk_blob_md_page **pages,
-	       uint32_t *page_count)
+blob_serialize(const struct spdk_blob *blob, uint64_t md_journal_seq,
+	       struct spdk_blob_md_page **pages, uint32_t *page_count)
 {
 	struct spdk_blob_md_page		*cur_page;
 	int					rc;
@@ -1241,6 +1546,12 @@ blob_serialize(const struct spdk_blob *blob, struct spdk_blob_md_page **pages,
 	blob_serialize_flags(blob, buf, &remaining_sz);
 	buf += sizeof(struct spdk_blob_md_descriptor_flags);
 
+	if (blob->bs->md_journal != NULL) {
+		/* Serialize the last journal record reflected in metadata */
+		blob_serialize_md_journal(md_journal_seq, buf, &remaining_sz);
+		buf += sizeof(struct spdk_blob_md_descriptor_md_journal);
+	}
+
 	/* Serialize xattrs */
 	rc = blob_serialize_xattrs(blob, &blob->xattrs, false,
 				   pages, cur_page, page_count, &buf, &remaining_sz);
@@ -1584,6 +1895,11 @@ struct spdk_blob_persist_ctx {
 	uint32_t			next_extent_page;
 	struct spdk_blob_md_page	*extent_page;
 
+	/* Last journal record reflected in the metadata being written */
+	uint64_t			md_journal_seq;
+	/* Extent page updated only in the journal, being written */
+	uint32_t			md_journal_ep;
+
 	spdk_bs_sequence_t		*seq;
 	spdk_bs_sequence_cpl		cb_fn;
 	void				*cb_arg;
@@ -1623,6 +1939,21 @@ blob_persist_complete_cb(void *arg)
 	free(ctx);
 }
 
+static void
+blob_md_journal_persisted(struct spdk_blob *blob, uint64_t md_journal_seq)
+{
+	if (blob->bs->md_journal == NULL) {
+		return;
+	}
+
+	blob->md_journal_seq = md_journal_seq;
+	if (blob->md_journal_dirty && blob->md_journal_last_seq <= md_journal_seq) {
+		/* All records of this blob are reflected in its metadata now */
+		TAILQ_REMOVE(&blob->bs->md_journal->dirty_blobs, blob, md_journal_link);
+		blob->md_journal_dirty = false;
+	}
+}
+
 static void
 blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx, int bserrno)
 {
@@ -1631,6 +1962,7 @@ blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx
 
 	if (bserrno == 0) {
 		blob_mark_clean(blob);
+		blob_md_journal_persisted(blob, ctx->md_journal_seq);
 	}
 
 	assert(ctx == TAILQ_FIRST(&blob->persists_to_complete));
@@ -1740,6 +2072,10 @@ blob_persist_clear_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserr
 		if (blob->active.clusters[i] != 0) {
 			bs_release_cluster(bs, cluster_num);
 		}
+
+		if (blob_get_cow_map(blob, i) != NULL) {
+			blob_retire_cow_map(blob, i);
+		}
 	}
 	pthread_mutex_unlock(&bs->used_clusters_mutex);
 
@@ -2026,6 +2362,10 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 		blob->active.clusters = tmp;
 		blob->active.cluster_array_size = sz;
 
+		if (blob->cow_maps != NULL && blob_cow_map_array_resize(blob, sz) != 0) {
+			return -ENOMEM;
+		}
+
 		/* Expand the extents table, only if enough clusters were added */
 		if (new_num_ep > current_num_ep && blob->use_extent_table) {
 			ep_tmp = realloc(blob->active.extent_pages, sizeof(*blob->active.extent_pages) * new_num_ep);
@@ -2070,7 +2410,7 @@ blob_persist_generate_new_md(struct spdk_blob_persist_ctx *ctx)
 	int rc;
 
 	/* Generate the new metadata */
-	rc = blob_serialize(blob, &ctx->pages, &blob->active.num_pages);
+	rc = blob_serialize(blob, ctx->md_journal_seq, &ctx->pages, &blob->active.num_pages);
 	if (rc < 0) {
 		blob_persist_complete(seq, ctx, rc);
 		return;
@@ -2169,21 +2509,11 @@ blob_persist_write_extent_pages(spdk_bs_sequence_t *seq, void *cb_arg, int bserr
 }
 
 static void
-blob_persist_start(struct spdk_blob_persist_ctx *ctx)
+blob_persist_resize_extent_pages(struct spdk_blob_persist_ctx *ctx)
 {
 	spdk_bs_sequence_t *seq = ctx->seq;
 	struct spdk_blob *blob = ctx->blob;
 
-	if (blob->active.num_pages == 0) {
-		/* This is the signal that the blob should be deleted.
-		 * Immediately jump to the clean up routine. */
-		assert(blob->clean.num_pages > 0);
-		blob->state = SPDK_BLOB_STATE_CLEAN;
-		blob_persist_zero_pages(seq, ctx, 0);
-		return;
-
-	}
-
 	if (blob->clean.num_clusters < blob->active.num_clusters) {
 		/* Blob was resized up */
 		assert(blob->clean.num_extent_pages <= blob->active.num_extent_pages);
@@ -2201,6 +2531,90 @@ blob_persist_start(struct spdk_blob_persist_ctx *ctx)
 	blob_persist_write_extent_pages(seq, ctx, 0);
 }
 
+static void
+blob_persist_write_journal_eps(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_persist_ctx	*ctx = cb_arg;
+	struct spdk_blob		*blob = ctx->blob;
+	uint32_t			i;
+	uint32_t			page_count = 0;
+	int				rc;
+
+	if (ctx->extent_page != NULL) {
+		spdk_free(ctx->extent_page);
+		ctx->extent_page = NULL;
+	}
+
+	if (bserrno != 0) {
+		/* Extent page has to be written on the next persist */
+		spdk_bit_array_set(blob->md_journal_eps, ctx->md_journal_ep);
+		blob_persist_complete(seq, ctx, bserrno);
+		return;
+	}
+
+	/* Write out Extent Pages with clusters allocated only in the journal */
+	i = spdk_bit_array_find_first_set(blob->md_journal_eps, 0);
+	while (i != UINT32_MAX) {
+		spdk_bit_array_clear(blob->md_journal_eps, i);
+		if (i < blob->active.num_extent_pages && blob->active.extent_pages[i] != 0) {
+			break;
+		}
+		/* Extent page was released by resize in the meantime */
+		i = spdk_bit_array_find_first_set(blob->md_journal_eps, i);
+	}
+
+	if (i == UINT32_MAX) {
+		blob_persist_resize_extent_pages(ctx);
+		return;
+	}
+
+	assert(spdk_bit_array_get(blob->bs->used_md_pages, blob->active.extent_pages[i]));
+	ctx->md_journal_ep = i;
+	rc = blob_serialize_add_page(blob, &ctx->extent_page, &page_count, &ctx->extent_page);
+	if (rc < 0) {
+		spdk_bit_array_set(blob->md_journal_eps, i);
+		blob_persist_complete(seq, ctx, rc);
+		return;
+	}
+
+	blob_serialize_extent_page(blob, i * SPDK_EXTENTS_PER_EP, ctx->extent_page);
+
+	ctx->extent_page->crc = blob_md_page_calc_crc(ctx->extent_page);
+
+	bs_sequence_write_dev(seq, ctx->extent_page,
+			      bs_md_page_to_lba(blob->bs, blob->active.extent_pages[i]),
+			      bs_byte_to_lba(blob->bs, SPDK_BS_PAGE_SIZE),
+			      blob_persist_write_journal_eps, ctx);
+}
+
+static void
+blob_persist_start(struct spdk_blob_persist_ctx *ctx)
+{
+	spdk_bs_sequence_t *seq = ctx->seq;
+	struct spdk_blob *blob = ctx->blob;
+
+	if (blob->active.num_pages == 0) {
+		/* This is the signal that the blob should be deleted.
+		 * Immediately jump to the clean up routine. */
+		assert(blob->clean.num_pages > 0);
+		blob->state = SPDK_BLOB_STATE_CLEAN;
+		blob_persist_zero_pages(seq, ctx, 0);
+		return;
+
+	}
+
+	if (blob->bs->md_journal != NULL) {
+		/* Records appended from now on might not be reflected in the extent pages */
+		ctx->md_journal_seq = blob->bs->md_journal->next_seq - 1;
+		if (blob->md_journal_eps != NULL) {
+			blob_persist_write_journal_eps(seq, ctx, 0);
+			return;
+		}
+	}
+
+	blob_persist_resize_extent_pages(ctx);
+}
+
 static void
 blob_persist_dirty_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
@@ -2237,6 +2651,10 @@ blob_persist_dirty(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	if (ctx->super->size == 0) {
 		ctx->super->size = ctx->blob->bs->dev->blockcnt * ctx->blob->bs->dev->blocklen;
 	}
+	if (ctx->blob->bs->md_journal != NULL) {
+		/* Sequence numbers below this might be found in blob metadata after a crash */
+		ctx->super->md_journal_next_seq = ctx->blob->bs->md_journal->next_seq;
+	}
 
 	bs_write_super(seq, ctx->blob->bs, ctx->super, blob_persist_dirty_cpl, ctx);
 }
@@ -2301,35 +2719,111 @@ struct spdk_blob_copy_cluster_ctx {
 	uint64_t page;
 	uint64_t new_cluster;
 	uint32_t new_extent_page;
+	uint32_t cluster_number;
 	spdk_bs_sequence_t *seq;
 	struct spdk_blob_md_page *new_cluster_page;
-};
 
-static void
-blob_allocate_and_copy_cluster_cpl(void *cb_arg, int bserrno)
-{
-	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
-	struct spdk_bs_request_set *set = (struct spdk_bs_request_set *)ctx->seq;
-	TAILQ_HEAD(, spdk_bs_request_set) requests;
+	/* Map of the partially populated cluster being written or compacted */
+	struct spdk_blob_cow_map *cow_map;
+	/* Next io_unit to look at when compacting the cluster */
+	uint32_t next_io_unit;
+	/* User op completed by the map update, instead of being re-executed */
 	spdk_bs_user_op_t *op;
+};
 
-	TAILQ_INIT(&requests);
-	TAILQ_SWAP(&set->channel->need_cluster_alloc, &requests, spdk_bs_request_set, link);
-
-	while (!TAILQ_EMPTY(&requests)) {
-		op = TAILQ_FIRST(&requests);
-		TAILQ_REMOVE(&requests, op, link);
-		if (bserrno == 0) {
-			bs_user_op_execute(op);
-		} else {
-			bs_user_op_abort(op, bserrno);
-		}
+static struct spdk_blob_md_page *
+bs_channel_get_cluster_page(struct spdk_bs_channel *ch)
+{
+	if (!ch->new_cluster_page_used) {
+		ch->new_cluster_page_used = true;
+		memset(ch->new_cluster_page, 0, SPDK_BS_PAGE_SIZE);
+		return ch->new_cluster_page;
 	}
 
+	/* Another cluster is being inserted from this channel */
+	return spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0, NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+}
+
+static void
+bs_channel_put_cluster_page(struct spdk_bs_channel *ch, struct spdk_blob_md_page *page)
+{
+	if (page == ch->new_cluster_page) {
+		ch->new_cluster_page_used = false;
+	} else {
+		spdk_free(page);
+	}
+}
+
+static void
+blob_copy_cluster_ctx_free(struct spdk_bs_channel *ch, struct spdk_blob_copy_cluster_ctx *ctx)
+{
+	bs_channel_put_cluster_page(ch, ctx->new_cluster_page);
 	spdk_free(ctx->buf);
 	free(ctx);
 }
 
+static inline bool
+bs_user_op_in_cluster(spdk_bs_user_op_t *op, struct spdk_blob *blob, uint32_t cluster_number)
+{
+	return op->u.user_op.blob == blob &&
+	       bs_io_unit_to_cluster_number(blob, op->u.user_op.offset) == cluster_number;
+}
+
+/* Check if an op of the channel is already allocating the cluster or updating its map */
+static bool
+bs_cluster_alloc_pending(struct spdk_bs_channel *ch, struct spdk_blob *blob,
+			 uint32_t cluster_number)
+{
+	spdk_bs_user_op_t *op;
+
+	TAILQ_FOREACH(op, &ch->need_cluster_alloc, link) {
+		if (bs_user_op_in_cluster(op, blob, cluster_number)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void
+blob_allocate_and_copy_cluster_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+	struct spdk_bs_request_set *set = (struct spdk_bs_request_set *)ctx->seq;
+	struct spdk_bs_channel *ch = set->channel;
+	TAILQ_HEAD(, spdk_bs_request_set) requests;
+	spdk_bs_user_op_t *op, *tmp;
+
+	/* Only the ops targeting this cluster waited for it */
+	TAILQ_INIT(&requests);
+	TAILQ_FOREACH_SAFE(op, &ch->need_cluster_alloc, link, tmp) {
+		if (bs_user_op_in_cluster(op, ctx->blob, ctx->cluster_number)) {
+			TAILQ_REMOVE(&ch->need_cluster_alloc, op, link);
+			TAILQ_INSERT_TAIL(&requests, op, link);
+		}
+	}
+
+	if (ctx->op != NULL) {
+		/* Data of this op was already written to the cluster */
+		op = TAILQ_FIRST(&requests);
+		assert(op == ctx->op);
+		TAILQ_REMOVE(&requests, op, link);
+		bs_user_op_abort(op, bserrno);
+	}
+
+	while (!TAILQ_EMPTY(&requests)) {
+		op = TAILQ_FIRST(&requests);
+		TAILQ_REMOVE(&requests, op, link);
+		if (bserrno == 0) {
+			bs_user_op_execute(op);
+		} else {
+			bs_user_op_abort(op, bserrno);
+		}
+	}
+
+	blob_copy_cluster_ctx_free(ch, ctx);
+}
+
 static void
 blob_insert_cluster_cpl(void *cb_arg, int bserrno)
 {
@@ -2357,7 +2851,6 @@ static void
 blob_write_copy_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
 	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
-	uint32_t cluster_number;
 
 	if (bserrno) {
 		/* The write failed, so jump to the final completion handler */
@@ -2365,10 +2858,9 @@ blob_write_copy_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
-	cluster_number = bs_page_to_cluster(ctx->blob->bs, ctx->page);
-
-	blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-					 ctx->new_extent_page, ctx->new_cluster_page, blob_insert_cluster_cpl, ctx);
+	blob_insert_cluster_on_md_thread(ctx->blob, ctx->cluster_number, ctx->new_cluster,
+					 ctx->new_extent_page, ctx->new_cluster_page, false,
+					 blob_insert_cluster_cpl, ctx);
 }
 
 static void
@@ -2389,6 +2881,163 @@ blob_write_copy(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 			      blob_write_copy_cpl, ctx);
 }
 
+static void
+blob_read_copy(struct spdk_blob_copy_cluster_ctx *ctx, spdk_bs_sequence_cpl cb_fn)
+{
+	/* Read cluster from backing device */
+	bs_sequence_read_bs_dev(ctx->seq, ctx->blob->back_bs_dev, ctx->buf,
+				bs_dev_page_to_lba(ctx->blob->back_bs_dev, ctx->page),
+				bs_dev_byte_to_lba(ctx->blob->back_bs_dev, ctx->blob->bs->cluster_sz),
+				cb_fn, ctx);
+}
+
+static int
+blob_copy_cluster_alloc_buf(struct spdk_blob_copy_cluster_ctx *ctx)
+{
+	ctx->buf = spdk_malloc(ctx->blob->bs->cluster_sz, ctx->blob->back_bs_dev->blocklen,
+			       NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!ctx->buf) {
+		SPDK_ERRLOG("DMA allocation for cluster of size = %" PRIu32 " failed.\n",
+			    ctx->blob->bs->cluster_sz);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void
+blob_insert_cow_cluster_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+
+	if (bserrno != -ENOBUFS) {
+		blob_insert_cluster_cpl(ctx, bserrno);
+		return;
+	}
+
+	/* Extent page has no room left for another map, copy the whole cluster instead */
+	bserrno = blob_copy_cluster_alloc_buf(ctx);
+	if (bserrno != 0) {
+		blob_insert_cluster_cpl(ctx, bserrno);
+		return;
+	}
+
+	blob_read_copy(ctx, blob_write_copy);
+}
+
+static void
+blob_cow_write_update_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+
+	if (bserrno == -EAGAIN) {
+		/* The cluster was compacted while the data was written,
+		 * write it again to the now fully populated cluster. */
+		ctx->op = NULL;
+		bserrno = 0;
+	}
+
+	bs_sequence_finish(ctx->seq, bserrno);
+}
+
+static void
+blob_cow_write_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+	struct spdk_bs_user_op_args *args = &ctx->op->u.user_op;
+
+	if (bserrno != 0) {
+		bs_sequence_finish(seq, bserrno);
+		return;
+	}
+
+	blob_cow_map_update_on_md_thread(ctx->blob, ctx->cow_map, ctx->cluster_number,
+					 args->offset % bs_io_units_per_cluster(ctx->blob->bs), args->length,
+					 ctx->new_cluster_page, blob_cow_write_update_cpl, ctx);
+}
+
+/* Write the user op directly to a partially populated cluster, then mark the io_units as written. */
+static void
+blob_cow_write(struct spdk_blob_copy_cluster_ctx *ctx)
+{
+	spdk_bs_user_op_t *op = ctx->op;
+	struct spdk_bs_user_op_args *args = &op->u.user_op;
+	uint64_t lba = bs_blob_io_unit_to_lba(ctx->blob, args->offset);
+
+	switch (args->type) {
+	case SPDK_BLOB_WRITE:
+		bs_sequence_write_dev(ctx->seq, args->payload, lba, args->length,
+				      blob_cow_write_cpl, ctx);
+		break;
+	case SPDK_BLOB_WRITEV:
+		ctx->seq->ext_io_opts = op->ext_io_opts;
+		bs_sequence_writev_dev(ctx->seq, args->payload, args->iovcnt, lba, args->length,
+				       blob_cow_write_cpl, ctx);
+		break;
+	case SPDK_BLOB_WRITE_ZEROES:
+		bs_sequence_write_zeroes_dev(ctx->seq, lba, args->length, blob_cow_write_cpl, ctx);
+		break;
+	default:
+		assert(false);
+		bs_sequence_finish(ctx->seq, -EINVAL);
+		break;
+	}
+}
+
+static void
+blob_compact_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+
+	bs_sequence_finish(ctx->seq, bserrno);
+}
+
+static void
+blob_compact_write_next(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+	struct spdk_bit_array *io_units = ctx->cow_map->io_units;
+	uint32_t start, end;
+	uint64_t lba;
+
+	if (bserrno == 0) {
+		/* The map can't change while compacting, copy the io_units not written yet */
+		start = spdk_bit_array_find_first_clear(io_units, ctx->next_io_unit);
+		if (start != UINT32_MAX) {
+			end = spdk_bit_array_find_first_set(io_units, start);
+			if (end == UINT32_MAX) {
+				end = spdk_bit_array_capacity(io_units);
+			}
+			ctx->next_io_unit = end;
+
+			lba = ctx->blob->active.clusters[ctx->cluster_number] + start;
+			bs_sequence_write_dev(seq, ctx->buf + (uint64_t)start * ctx->blob->bs->io_unit_size,
+					      lba, end - start, blob_compact_write_next, ctx);
+			return;
+		}
+	}
+
+	blob_cow_map_compact_finish_on_md_thread(ctx->blob, ctx->cow_map, ctx->cluster_number,
+			ctx->new_cluster_page, bserrno, blob_compact_cpl, ctx);
+}
+
+static void
+blob_compact_start_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
+
+	if (bserrno != 0) {
+		if (bserrno == -EALREADY) {
+			/* Cluster got fully populated in the meantime */
+			bserrno = 0;
+		}
+		bs_sequence_finish(ctx->seq, bserrno);
+		return;
+	}
+
+	blob_read_copy(ctx, blob_compact_write_next);
+}
+
 static void
 bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 			     struct spdk_io_channel *_ch,
@@ -2397,20 +3046,14 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	struct spdk_bs_cpl cpl;
 	struct spdk_bs_channel *ch;
 	struct spdk_blob_copy_cluster_ctx *ctx;
+	struct spdk_blob_cow_map *cow_map = NULL;
 	uint32_t cluster_start_page;
 	uint32_t cluster_number;
+	bool sub_cluster_cow = false;
 	int rc;
 
 	ch = spdk_io_channel_get_ctx(_ch);
 
-	if (!TAILQ_EMPTY(&ch->need_cluster_alloc)) {
-		/* There are already operations pending. Queue this user op
-		 * and return because it will be re-executed when the outstanding
-		 * cluster allocation completes. */
-		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
-		return;
-	}
-
 	/* Round the io_unit offset down to the first page in the cluster */
 	cluster_start_page = bs_io_unit_to_cluster_start(blob, io_unit);
 
@@ -2418,6 +3061,29 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	 * cluster is supposed to be at. */
 	cluster_number = bs_io_unit_to_cluster_number(blob, io_unit);
 
+	if (bs_cluster_alloc_pending(ch, blob, cluster_number)) {
+		/* There are already operations pending on this cluster. Queue
+		 * this user op and return because it will be re-executed when the
+		 * outstanding cluster allocation completes. Ops targeting other
+		 * clusters are not held back. */
+		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
+		return;
+	}
+
+	if (bs_io_unit_is_allocated(blob, io_unit)) {
+		/* Partially populated cluster. It is written to directly or,
+		 * for the dummy read used by inflate, compacted. */
+		cow_map = blob_get_cow_map(blob, cluster_number);
+		if (cow_map == NULL) {
+			/* Cluster got fully populated in the meantime */
+			bs_user_op_execute(op);
+			return;
+		}
+	} else if (op->u.user_op.type != SPDK_BLOB_READ) {
+		/* Track written io_units instead of copying the cluster from the parent */
+		sub_cluster_cow = blob_sub_cluster_cow(blob);
+	}
+
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
 		bs_user_op_abort(op, -ENOMEM);
@@ -2428,19 +3094,58 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 
 	ctx->blob = blob;
 	ctx->page = cluster_start_page;
-	ctx->new_cluster_page = ch->new_cluster_page;
-	memset(ctx->new_cluster_page, 0, SPDK_BS_PAGE_SIZE);
+	ctx->cluster_number = cluster_number;
+	ctx->new_cluster_page = bs_channel_get_cluster_page(ch);
+	if (!ctx->new_cluster_page) {
+		free(ctx);
+		bs_user_op_abort(op, -ENOMEM);
+		return;
+	}
 
-	if (blob->parent_id != SPDK_BLOBID_INVALID) {
-		ctx->buf = spdk_malloc(blob->bs->cluster_sz, blob->back_bs_dev->blocklen,
-				       NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-		if (!ctx->buf) {
-			SPDK_ERRLOG("DMA allocation for cluster of size = %" PRIu32 " failed.\n",
-				    blob->bs->cluster_sz);
-			free(ctx);
+	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+	cpl.u.blob_basic.cb_fn = blob_allocate_and_copy_cluster_cpl;
+	cpl.u.blob_basic.cb_arg = ctx;
+
+	if (cow_map != NULL) {
+		ctx->cow_map = cow_map;
+
+		if (op->u.user_op.type == SPDK_BLOB_READ) {
+			rc = blob_copy_cluster_alloc_buf(ctx);
+			if (rc != 0) {
+				blob_copy_cluster_ctx_free(ch, ctx);
+				bs_user_op_abort(op, rc);
+				return;
+			}
+		} else {
+			ctx->op = op;
+		}
+
+		ctx->seq = bs_sequence_start(_ch, &cpl);
+		if (!ctx->seq) {
+			blob_copy_cluster_ctx_free(ch, ctx);
 			bs_user_op_abort(op, -ENOMEM);
 			return;
 		}
+
+		/* Queue the user op to block other incoming operations */
+		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
+
+		if (ctx->op != NULL) {
+			blob_cow_write(ctx);
+		} else {
+			blob_cow_map_compact_start_on_md_thread(blob, cow_map, cluster_number,
+					blob_compact_start_cpl, ctx);
+		}
+		return;
+	}
+
+	if (blob->parent_id != SPDK_BLOBID_INVALID && !sub_cluster_cow) {
+		rc = blob_copy_cluster_alloc_buf(ctx);
+		if (rc != 0) {
+			blob_copy_cluster_ctx_free(ch, ctx);
+			bs_user_op_abort(op, rc);
+			return;
+		}
 	}
 
 	pthread_mutex_lock(&blob->bs->used_clusters_mutex);
@@ -2448,23 +3153,17 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 				 false);
 	pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
 	if (rc != 0) {
-		spdk_free(ctx->buf);
-		free(ctx);
+		blob_copy_cluster_ctx_free(ch, ctx);
 		bs_user_op_abort(op, rc);
 		return;
 	}
 
-	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	cpl.u.blob_basic.cb_fn = blob_allocate_and_copy_cluster_cpl;
-	cpl.u.blob_basic.cb_arg = ctx;
-
 	ctx->seq = bs_sequence_start(_ch, &cpl);
 	if (!ctx->seq) {
 		pthread_mutex_lock(&blob->bs->used_clusters_mutex);
 		bs_release_cluster(blob->bs, ctx->new_cluster);
 		pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
-		spdk_free(ctx->buf);
-		free(ctx);
+		blob_copy_cluster_ctx_free(ch, ctx);
 		bs_user_op_abort(op, -ENOMEM);
 		return;
 	}
@@ -2472,15 +3171,16 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	/* Queue the user op to block other incoming operations */
 	TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
 
-	if (blob->parent_id != SPDK_BLOBID_INVALID) {
-		/* Read cluster from backing device */
-		bs_sequence_read_bs_dev(ctx->seq, blob->back_bs_dev, ctx->buf,
-					bs_dev_page_to_lba(blob->back_bs_dev, cluster_start_page),
-					bs_dev_byte_to_lba(blob->back_bs_dev, blob->bs->cluster_sz),
-					blob_write_copy, ctx);
+	if (ctx->buf != NULL) {
+		blob_read_copy(ctx, blob_write_copy);
+	} else if (sub_cluster_cow) {
+		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
+						 ctx->new_extent_page, ctx->new_cluster_page, true,
+						 blob_insert_cow_cluster_cpl, ctx);
 	} else {
 		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-						 ctx->new_extent_page, ctx->new_cluster_page, blob_insert_cluster_cpl, ctx);
+						 ctx->new_extent_page, ctx->new_cluster_page, false,
+						 blob_insert_cluster_cpl, ctx);
 	}
 }
 
@@ -2490,7 +3190,7 @@ blob_calculate_lba_and_lba_count(struct spdk_blob *blob, uint64_t io_unit, uint6
 {
 	*lba_count = length;
 
-	if (!bs_io_unit_is_allocated(blob, io_unit)) {
+	if (!blob_io_unit_is_written(blob, io_unit)) {
 		assert(blob->back_bs_dev != NULL);
 		*lba = bs_io_unit_to_back_dev_lba(blob, io_unit);
 		*lba_count = bs_io_unit_to_back_dev_lba(blob, *lba_count);
@@ -2555,8 +3255,7 @@ blob_request_submit_op_split_next(void *cb_arg, int bserrno)
 		offset = ctx->io_unit_offset;
 		length = ctx->io_units_remaining;
 		buf = ctx->curr_payload;
-		op_length = spdk_min(length, bs_num_io_units_to_cluster_boundary(blob,
-				     offset));
+		op_length = spdk_min(length, blob_num_io_units_to_boundary(blob, offset));
 
 		/* Update length and payload for next operation */
 		ctx->io_units_remaining -= op_length;
@@ -2796,7 +3495,7 @@ blob_request_submit_op(struct spdk_blob *blob, struct spdk_io_channel *_channel,
 		cb_fn(cb_arg, -EINVAL);
 		return;
 	}
-	if (length <= bs_num_io_units_to_cluster_boundary(blob, offset)) {
+	if (length <= blob_num_io_units_to_boundary(blob, offset)) {
 		blob_request_submit_op_single(_channel, blob, payload, offset, length,
 					      cb_fn, cb_arg, op_type);
 	} else {
@@ -2845,7 +3544,7 @@ rw_iov_split_next(void *cb_arg, int bserrno)
 	}
 
 	io_unit_offset = ctx->io_unit_offset;
-	io_units_to_boundary = bs_num_io_units_to_cluster_boundary(blob, io_unit_offset);
+	io_units_to_boundary = blob_num_io_units_to_boundary(blob, io_unit_offset);
 	io_units_count = spdk_min(ctx->io_units_remaining, io_units_to_boundary);
 	/*
 	 * Get index and offset into the original iov array for our current position in the I/O sequence.
@@ -2936,7 +3635,7 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 	 *  in a batch.  That would also require creating an intermediate spdk_bs_cpl that would get called
 	 *  when the batch was completed, to allow for freeing the memory for the iov arrays.
 	 */
-	if (spdk_likely(length <= bs_num_io_units_to_cluster_boundary(blob, offset))) {
+	if (spdk_likely(length <= blob_num_io_units_to_boundary(blob, offset))) {
 		uint64_t lba_count;
 		uint64_t lba;
 		bool is_allocated;
@@ -3148,6 +3847,64 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 	channel->dev->destroy_channel(channel->dev, channel->dev_channel);
 }
 
+static void
+bs_md_journal_free(struct spdk_blob_store *bs)
+{
+	struct spdk_bs_md_journal *journal = bs->md_journal;
+	int i;
+
+	if (journal == NULL) {
+		return;
+	}
+
+	assert(TAILQ_EMPTY(&journal->dirty_blobs));
+	for (i = 0; i < 2; i++) {
+		spdk_free(journal->batches[i].pages);
+	}
+	free(journal->slot_seq);
+	free(journal);
+	bs->md_journal = NULL;
+}
+
+static int
+bs_md_journal_alloc(struct spdk_blob_store *bs, uint32_t start, uint32_t len)
+{
+	struct spdk_bs_md_journal *journal;
+	int i;
+
+	journal = calloc(1, sizeof(*journal));
+	if (journal == NULL) {
+		return -ENOMEM;
+	}
+	bs->md_journal = journal;
+
+	journal->bs = bs;
+	journal->start = start;
+	journal->len = len;
+	journal->next_seq = 1;
+	TAILQ_INIT(&journal->dirty_blobs);
+
+	journal->slot_seq = calloc(len, sizeof(*journal->slot_seq));
+	if (journal->slot_seq == NULL) {
+		bs_md_journal_free(bs);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < 2; i++) {
+		journal->batches[i].pages = spdk_zmalloc(SPDK_BLOB_MD_JOURNAL_BATCH_PAGES * SPDK_BS_PAGE_SIZE,
+					    SPDK_BS_PAGE_SIZE, NULL, SPDK_ENV_SOCKET_ID_ANY,
+					    SPDK_MALLOC_DMA);
+		if (journal->batches[i].pages == NULL) {
+			bs_md_journal_free(bs);
+			return -ENOMEM;
+		}
+		TAILQ_INIT(&journal->batches[i].reqs);
+	}
+	journal->open = &journal->batches[0];
+
+	return 0;
+}
+
 static void
 bs_dev_destroy(void *io_device)
 {
@@ -3168,6 +3925,7 @@ bs_dev_destroy(void *io_device)
 	spdk_bit_array_free(&bs->used_blobids);
 	spdk_bit_array_free(&bs->used_md_pages);
 	spdk_bit_pool_free(&bs->used_clusters);
+	bs_md_journal_free(bs);
 	/*
 	 * If this function is called for any reason except a successful unload,
 	 * the unload_cpl type will be NONE and this will be a nop.
@@ -3310,6 +4068,8 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts, size_t opts_size)
 	SET_FIELD(iter_cb_fn, NULL);
 	SET_FIELD(iter_cb_arg, NULL);
 	SET_FIELD(force_recover, false);
+	SET_FIELD(sub_cluster_cow, false);
+	SET_FIELD(md_journal_pages, 0);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -3324,6 +4084,13 @@ bs_opts_verify(struct spdk_bs_opts *opts)
 		return -1;
 	}
 
+	if (opts->md_journal_pages != 0 &&
+	    opts->md_journal_pages < 2 * SPDK_BLOB_MD_JOURNAL_BATCH_PAGES) {
+		SPDK_ERRLOG("Metadata journal requires at least %d pages\n",
+			    2 * SPDK_BLOB_MD_JOURNAL_BATCH_PAGES);
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -3331,21 +4098,55 @@ bs_opts_verify(struct spdk_bs_opts *opts)
 
 /* spdk_bs_load_ctx is used for init, load, unload and dump code paths. */
 
+enum spdk_bs_load_replay_type {
+	BS_LOAD_REPLAY_SCAN,
+	BS_LOAD_REPLAY_CHAIN,
+	BS_LOAD_REPLAY_EXTENT,
+};
+
+struct spdk_bs_load_replay_req {
+	struct spdk_bs_load_ctx			*ctx;
+	enum spdk_bs_load_replay_type		type;
+	uint32_t				page_num;
+	uint32_t				num_pages;
+	struct spdk_blob_md_page		*pages;
+	TAILQ_ENTRY(spdk_bs_load_replay_req)	link;
+};
+
 struct spdk_bs_load_ctx {
 	struct spdk_blob_store		*bs;
 	struct spdk_bs_super_block	*super;
 
 	struct spdk_bs_md_mask		*mask;
-	bool				in_page_chain;
-	uint32_t			page_index;
+	struct spdk_bs_md_mask		*used_clusters_mask;
+	struct spdk_bs_md_mask		*used_blobids_mask;
 	uint32_t			cur_page;
 	struct spdk_blob_md_page	*page;
 
+	/* These fields are used in the metadata replay on dirty shutdown recovery. */
+	struct spdk_blob_md_page	*replay_buf;
+	struct spdk_bs_load_replay_req	*replay_reqs;
+	TAILQ_HEAD(, spdk_bs_load_replay_req) replay_free_reqs;
+	uint32_t			replay_outstanding;
+	bool				replay_submitting;
+	int				replay_rc;
+	uint32_t			scan_page;
+	uint32_t			*chain_page_num;
+	uint64_t			chain_pages_array_size;
+	uint64_t			num_chain_pages;
+	uint64_t			next_chain_page;
 	uint64_t			num_extent_pages;
+	uint64_t			next_extent_page;
 	uint32_t			*extent_page_num;
-	struct spdk_blob_md_page	*extent_pages;
 	struct spdk_bit_array		*used_clusters;
 
+	/* These fields are used in the metadata journal replay. */
+	struct spdk_bs_md_journal_page			*journal_pages;
+	struct spdk_bs_md_journal_record_cluster	*journal_records;
+	uint64_t					num_journal_records;
+	uint64_t					next_journal_record;
+	struct spdk_bit_array				*journal_clusters;
+
 	spdk_bs_sequence_t			*seq;
 	spdk_blob_op_with_handle_complete	iter_cb_fn;
 	void					*iter_cb_arg;
@@ -3435,6 +4236,7 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->io_unit_size = dev->blocklen;
 
 	bs->max_channel_ops = opts->max_channel_ops;
+	bs->sub_cluster_cow = opts->sub_cluster_cow;
 	bs->super_blob = SPDK_BLOBID_INVALID;
 	memcpy(&bs->bstype, &opts->bstype, sizeof(opts->bstype));
 
@@ -3773,9 +4575,11 @@ bs_load_iter(void *arg, struct spdk_blob *blob, int bserrno)
 static void bs_dump_read_md_page(spdk_bs_sequence_t *seq, void *cb_arg);
 
 static void
-bs_load_complete(struct spdk_bs_load_ctx *ctx)
+bs_load_iter_start(struct spdk_bs_load_ctx *ctx)
 {
-	ctx->bs->used_clusters = spdk_bit_pool_create_from_array(ctx->used_clusters);
+	if (ctx->bs->used_clusters == NULL) {
+		ctx->bs->used_clusters = spdk_bit_pool_create_from_array(ctx->used_clusters);
+	}
 	if (ctx->dumping) {
 		bs_dump_read_md_page(ctx->seq, ctx);
 		return;
@@ -3783,155 +4587,478 @@ bs_load_complete(struct spdk_bs_load_ctx *ctx)
 	spdk_bs_iter_first(ctx->bs, bs_load_iter, ctx);
 }
 
-static void
-bs_load_used_blobids_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+static int
+bs_load_md_journal_alloc(struct spdk_bs_load_ctx *ctx)
 {
-	struct spdk_bs_load_ctx *ctx = cb_arg;
 	int rc;
 
-	/* The type must be correct */
-	assert(ctx->mask->type == SPDK_MD_MASK_TYPE_USED_BLOBIDS);
-
-	/* The length of the mask (in bits) must not be greater than
-	 * the length of the buffer (converted to bits) */
-	assert(ctx->mask->length <= (ctx->super->used_blobid_mask_len * SPDK_BS_PAGE_SIZE * 8));
-
-	/* The length of the mask must be exactly equal to the size
-	 * (in pages) of the metadata region */
-	assert(ctx->mask->length == ctx->super->md_len);
+	if (ctx->super->version < SPDK_BS_MD_JOURNAL_VERSION || ctx->super->md_journal_len == 0) {
+		return 0;
+	}
 
-	rc = spdk_bit_array_resize(&ctx->bs->used_blobids, ctx->mask->length);
+	rc = bs_md_journal_alloc(ctx->bs, ctx->super->md_journal_start, ctx->super->md_journal_len);
 	if (rc < 0) {
-		spdk_free(ctx->mask);
-		bs_load_ctx_fail(ctx, rc);
-		return;
+		return rc;
 	}
 
-	spdk_bit_array_load_mask(ctx->bs->used_blobids, ctx->mask->mask);
-	bs_load_complete(ctx);
+	/* Replay of the journal picks up the sequence numbers where they were left */
+	ctx->bs->md_journal->next_seq = spdk_max(ctx->super->md_journal_next_seq,
+					ctx->super->md_journal_seq + 1);
+	return 0;
 }
 
+static void bs_load_md_journal_replay_next(struct spdk_bs_load_ctx *ctx);
+
 static void
-bs_load_used_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_load_md_journal_close_cpl(void *cb_arg, int bserrno)
 {
 	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint64_t		lba, lba_count, mask_size;
-	int			rc;
 
 	if (bserrno != 0) {
-		bs_load_ctx_fail(ctx, bserrno);
-		return;
+		SPDK_ERRLOG("Failed to close blob 0x%" PRIx64 " after journal replay\n", ctx->blobid);
 	}
 
-	/* The type must be correct */
-	assert(ctx->mask->type == SPDK_MD_MASK_TYPE_USED_CLUSTERS);
-	/* The length of the mask (in bits) must not be greater than the length of the buffer (converted to bits) */
-	assert(ctx->mask->length <= (ctx->super->used_cluster_mask_len * sizeof(
-					     struct spdk_blob_md_page) * 8));
-	/*
-	 * The length of the mask must be equal to or larger than the total number of clusters. It may be
-	 * larger than the total nubmer of clusters due to a failure spdk_bs_grow.
-	 */
-	assert(ctx->mask->length >= ctx->bs->total_clusters);
-	if (ctx->mask->length > ctx->bs->total_clusters) {
-		SPDK_WARNLOG("Shrink the used_custers mask length to total_clusters");
-		ctx->mask->length = ctx->bs->total_clusters;
+	bs_load_md_journal_replay_next(ctx);
+}
+
+static void
+bs_load_md_journal_sync_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx *ctx = cb_arg;
+
+	if (bserrno != 0) {
+		SPDK_ERRLOG("Failed to persist journal records of blob 0x%" PRIx64 "\n", ctx->blobid);
 	}
 
-	rc = spdk_bit_array_resize(&ctx->used_clusters, ctx->mask->length);
-	if (rc < 0) {
-		spdk_free(ctx->mask);
-		bs_load_ctx_fail(ctx, rc);
+	spdk_blob_close(ctx->blob, bs_load_md_journal_close_cpl, ctx);
+}
+
+static void
+bs_load_md_journal_apply(struct spdk_bs_load_ctx *ctx, struct spdk_blob *blob,
+			 const struct spdk_bs_md_journal_record_cluster *record)
+{
+	struct spdk_blob_store	*bs = ctx->bs;
+	uint32_t		*extent_page;
+	uint32_t		page_num;
+	uint64_t		lba;
+
+	if (record->hdr.seq <= blob->md_journal_seq) {
+		/* Already reflected in blob metadata */
 		return;
 	}
 
-	spdk_bit_array_load_mask(ctx->used_clusters, ctx->mask->mask);
-	ctx->bs->num_free_clusters = spdk_bit_array_count_clear(ctx->used_clusters);
-	assert(ctx->bs->num_free_clusters <= ctx->bs->total_clusters);
+	if (record->cluster_num >= blob->active.num_clusters ||
+	    record->cluster_idx >= bs->total_clusters) {
+		SPDK_ERRLOG("Invalid journal record %" PRIu64 " of blob 0x%" PRIx64 "\n",
+			    record->hdr.seq, blob->id);
+		return;
+	}
 
-	spdk_free(ctx->mask);
+	lba = bs_cluster_to_lba(bs, record->cluster_idx);
+	if (blob->active.clusters[record->cluster_num] != 0) {
+		if (blob->active.clusters[record->cluster_num] != lba) {
+			SPDK_ERRLOG("Journal record %" PRIu64 " conflicts with cluster %" PRIu32
+				    " of blob 0x%" PRIx64 "\n", record->hdr.seq, record->cluster_num, blob->id);
+		}
+		return;
+	}
 
-	/* Read the used blobids mask */
-	mask_size = ctx->super->used_blobid_mask_len * SPDK_BS_PAGE_SIZE;
-	ctx->mask = spdk_zmalloc(mask_size, 0x1000, NULL, SPDK_ENV_SOCKET_ID_ANY,
-				 SPDK_MALLOC_DMA);
-	if (!ctx->mask) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
+	if (!spdk_bit_array_get(ctx->journal_clusters, record->cluster_idx)) {
+		SPDK_ERRLOG("Journal record %" PRIu64 " of blob 0x%" PRIx64 " uses allocated cluster %"
+			    PRIu32 "\n", record->hdr.seq, blob->id, record->cluster_idx);
 		return;
 	}
-	lba = bs_page_to_lba(ctx->bs, ctx->super->used_blobid_mask_start);
-	lba_count = bs_page_to_lba(ctx->bs, ctx->super->used_blobid_mask_len);
-	bs_sequence_read_dev(seq, ctx->mask, lba, lba_count,
-			     bs_load_used_blobids_cpl, ctx);
+
+	if (blob->use_extent_table) {
+		extent_page = bs_cluster_to_extent_page(blob, record->cluster_num);
+		if (*extent_page == 0) {
+			page_num = spdk_bit_array_find_first_clear(bs->used_md_pages, 0);
+			if (page_num == UINT32_MAX) {
+				SPDK_ERRLOG("No metadata page for journal record %" PRIu64 "\n", record->hdr.seq);
+				return;
+			}
+			bs_claim_md_page(bs, page_num);
+			*extent_page = page_num;
+		}
+
+		if (spdk_bit_array_resize(&blob->md_journal_eps, blob->active.extent_pages_array_size) != 0) {
+			SPDK_ERRLOG("Failed to apply journal record %" PRIu64 "\n", record->hdr.seq);
+			return;
+		}
+		spdk_bit_array_set(blob->md_journal_eps, record->cluster_num / SPDK_EXTENTS_PER_EP);
+	}
+
+	/* Cluster was claimed when reading the journal */
+	spdk_bit_array_clear(ctx->journal_clusters, record->cluster_idx);
+	bs->num_free_clusters--;
+	blob_insert_cluster(blob, record->cluster_num, record->cluster_idx);
+	blob->state = SPDK_BLOB_STATE_DIRTY;
 }
 
 static void
-bs_load_used_pages_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_load_md_journal_open_cpl(void *cb_arg, struct spdk_blob *blob, int bserrno)
 {
 	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint64_t		lba, lba_count, mask_size;
-	int			rc;
+	struct spdk_bs_md_journal_record_cluster *record;
+
+	if (bserrno != 0) {
+		/* Blob was deleted after the records were written */
+		SPDK_DEBUGLOG(blob, "Skipping journal records of blob 0x%" PRIx64 ": %d\n",
+			      ctx->blobid, bserrno);
+	}
+
+	while (ctx->next_journal_record < ctx->num_journal_records) {
+		record = &ctx->journal_records[ctx->next_journal_record];
+		if (record->hdr.blobid != ctx->blobid) {
+			break;
+		}
+		if (bserrno == 0 && !blob->md_ro) {
+			bs_load_md_journal_apply(ctx, blob, record);
+		}
+		ctx->next_journal_record++;
+	}
+
+	if (bserrno != 0) {
+		bs_load_md_journal_replay_next(ctx);
+		return;
+	}
+
+	ctx->blob = blob;
+	if (blob->state == SPDK_BLOB_STATE_DIRTY) {
+		blob_sync_md(blob, bs_load_md_journal_sync_cpl, ctx);
+	} else {
+		spdk_blob_close(blob, bs_load_md_journal_close_cpl, ctx);
+	}
+}
+
+static void
+bs_load_md_journal_replay_next(struct spdk_bs_load_ctx *ctx)
+{
+	uint32_t cluster_idx;
+
+	if (ctx->next_journal_record == ctx->num_journal_records) {
+		/* Release clusters of records that were not applied */
+		cluster_idx = spdk_bit_array_find_first_set(ctx->journal_clusters, 0);
+		while (cluster_idx != UINT32_MAX) {
+			spdk_bit_pool_free_bit(ctx->bs->used_clusters, cluster_idx);
+			cluster_idx = spdk_bit_array_find_first_set(ctx->journal_clusters, cluster_idx + 1);
+		}
+
+		spdk_bit_array_free(&ctx->journal_clusters);
+		free(ctx->journal_records);
+		ctx->journal_records = NULL;
+		ctx->blob = NULL;
+		bs_load_iter_start(ctx);
+		return;
+	}
+
+	ctx->blobid = ctx->journal_records[ctx->next_journal_record].hdr.blobid;
+	spdk_bs_open_blob(ctx->bs, ctx->blobid, bs_load_md_journal_open_cpl, ctx);
+}
+
+static int
+bs_load_md_journal_record_cmp(const void *a, const void *b)
+{
+	const struct spdk_bs_md_journal_record *r1 = a;
+	const struct spdk_bs_md_journal_record *r2 = b;
+
+	if (r1->blobid != r2->blobid) {
+		return r1->blobid < r2->blobid ? -1 : 1;
+	}
+
+	return r1->seq < r2->seq ? -1 : r1->seq > r2->seq;
+}
+
+static int
+bs_load_md_journal_parse(struct spdk_bs_load_ctx *ctx)
+{
+	struct spdk_bs_md_journal		*journal = ctx->bs->md_journal;
+	struct spdk_bs_md_journal_page		*page;
+	struct spdk_bs_md_journal_record	*record;
+	uint64_t				max_seq = 0, array_size = 0, i;
+	uint32_t				slot, offset, head = 0, cluster_idx;
+	void					*tmp;
+
+	for (slot = 0; slot < journal->len; slot++) {
+		page = &ctx->journal_pages[slot];
+		if (page->seq == 0 || page->length > sizeof(page->records) ||
+		    page->crc != blob_md_page_calc_crc(page)) {
+			continue;
+		}
+
+		offset = 0;
+		while (offset + sizeof(*record) <= page->length) {
+			record = (struct spdk_bs_md_journal_record *)&page->records[offset];
+			if (record->length < sizeof(*record) || offset + record->length > page->length) {
+				break;
+			}
+			offset += record->length;
+
+			if (record->seq > max_seq) {
+				max_seq = record->seq;
+				head = (slot + 1) % journal->len;
+			}
+
+			if (record->seq <= ctx->super->md_journal_seq ||
+			    record->type != SPDK_MD_JOURNAL_RECORD_CLUSTER ||
+			    record->length != sizeof(struct spdk_bs_md_journal_record_cluster)) {
+				continue;
+			}
+
+			if (ctx->num_journal_records == array_size) {
+				array_size = spdk_max(array_size * 2, 64);
+				tmp = realloc(ctx->journal_records, array_size * sizeof(*ctx->journal_records));
+				if (tmp == NULL) {
+					return -ENOMEM;
+				}
+				ctx->journal_records = tmp;
+			}
+			memcpy(&ctx->journal_records[ctx->num_journal_records++], record, record->length);
+		}
+	}
+
+	/* Records replayed now are persisted in blob metadata, start with an empty journal.
+	 * Sequence numbers of records that were not written before a crash might be
+	 * already used in blob metadata, skip them. */
+	journal->head = head;
+	journal->used = 0;
+	journal->next_seq = spdk_max(journal->next_seq, max_seq + 1) +
+			    SPDK_BLOB_MD_JOURNAL_MAX_PENDING_RECORDS;
+
+	qsort(ctx->journal_records, ctx->num_journal_records, sizeof(*ctx->journal_records),
+	      bs_load_md_journal_record_cmp);
+
+	/* Blobs are opened to apply the records, which requires clusters in
+	 * their metadata to be allocated. Claim clusters of the records upfront,
+	 * the ones not applied are released after the replay. */
+	ctx->journal_clusters = spdk_bit_array_create(ctx->bs->total_clusters);
+	if (ctx->journal_clusters == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < ctx->num_journal_records; i++) {
+		cluster_idx = ctx->journal_records[i].cluster_idx;
+		if (cluster_idx < ctx->bs->total_clusters &&
+		    !spdk_bit_array_get(ctx->used_clusters, cluster_idx)) {
+			spdk_bit_array_set(ctx->used_clusters, cluster_idx);
+			spdk_bit_array_set(ctx->journal_clusters, cluster_idx);
+		}
+	}
+
+	return 0;
+}
+
+static void
+bs_load_md_journal_read_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx *ctx = cb_arg;
+
+	if (bserrno == 0) {
+		bserrno = bs_load_md_journal_parse(ctx);
+	}
+
+	spdk_free(ctx->journal_pages);
+	ctx->journal_pages = NULL;
 
 	if (bserrno != 0) {
+		spdk_bit_array_free(&ctx->journal_clusters);
+		free(ctx->journal_records);
 		bs_load_ctx_fail(ctx, bserrno);
 		return;
 	}
 
+	SPDK_DEBUGLOG(blob, "Replaying %" PRIu64 " metadata journal records\n", ctx->num_journal_records);
+
+	ctx->bs->used_clusters = spdk_bit_pool_create_from_array(ctx->used_clusters);
+
+	ctx->next_journal_record = 0;
+	bs_load_md_journal_replay_next(ctx);
+}
+
+static void
+bs_load_complete(struct spdk_bs_load_ctx *ctx)
+{
+	struct spdk_bs_md_journal *journal = ctx->bs->md_journal;
+
+	if (journal == NULL || ctx->dumping) {
+		bs_load_iter_start(ctx);
+		return;
+	}
+
+	/* Apply cluster allocations not reflected in blob metadata yet */
+	ctx->journal_pages = spdk_zmalloc((uint64_t)journal->len * SPDK_BS_PAGE_SIZE, SPDK_BS_PAGE_SIZE,
+					  NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (ctx->journal_pages == NULL) {
+		bs_load_ctx_fail(ctx, -ENOMEM);
+		return;
+	}
+
+	bs_sequence_read_dev(ctx->seq, ctx->journal_pages, bs_page_to_lba(ctx->bs, journal->start),
+			     bs_byte_to_lba(ctx->bs, (uint64_t)journal->len * SPDK_BS_PAGE_SIZE),
+			     bs_load_md_journal_read_cpl, ctx);
+}
+
+static int
+bs_load_used_blobids(struct spdk_bs_load_ctx *ctx, struct spdk_bs_md_mask *mask)
+{
+	int rc;
+
+	/* The type must be correct */
+	assert(mask->type == SPDK_MD_MASK_TYPE_USED_BLOBIDS);
+
+	/* The length of the mask (in bits) must not be greater than
+	 * the length of the buffer (converted to bits) */
+	assert(mask->length <= (ctx->super->used_blobid_mask_len * SPDK_BS_PAGE_SIZE * 8));
+
+	/* The length of the mask must be exactly equal to the size
+	 * (in pages) of the metadata region */
+	assert(mask->length == ctx->super->md_len);
+
+	rc = spdk_bit_array_resize(&ctx->bs->used_blobids, mask->length);
+	if (rc < 0) {
+		return rc;
+	}
+
+	spdk_bit_array_load_mask(ctx->bs->used_blobids, mask->mask);
+	return 0;
+}
+
+static int
+bs_load_used_clusters(struct spdk_bs_load_ctx *ctx, struct spdk_bs_md_mask *mask)
+{
+	int rc;
+
+	/* The type must be correct */
+	assert(mask->type == SPDK_MD_MASK_TYPE_USED_CLUSTERS);
+	/* The length of the mask (in bits) must not be greater than the length of the buffer (converted to bits) */
+	assert(mask->length <= (ctx->super->used_cluster_mask_len * sizeof(
+					struct spdk_blob_md_page) * 8));
+	/*
+	 * The length of the mask must be equal to or larger than the total number of clusters. It may be
+	 * larger than the total nubmer of clusters due to a failure spdk_bs_grow.
+	 */
+	assert(mask->length >= ctx->bs->total_clusters);
+	if (mask->length > ctx->bs->total_clusters) {
+		SPDK_WARNLOG("Shrink the used_custers mask length to total_clusters");
+		mask->length = ctx->bs->total_clusters;
+	}
+
+	rc = spdk_bit_array_resize(&ctx->used_clusters, mask->length);
+	if (rc < 0) {
+		return rc;
+	}
+
+	spdk_bit_array_load_mask(ctx->used_clusters, mask->mask);
+	ctx->bs->num_free_clusters = spdk_bit_array_count_clear(ctx->used_clusters);
+	assert(ctx->bs->num_free_clusters <= ctx->bs->total_clusters);
+
+	return 0;
+}
+
+static int
+bs_load_used_pages(struct spdk_bs_load_ctx *ctx, struct spdk_bs_md_mask *mask)
+{
+	int rc;
+
 	/* The type must be correct */
-	assert(ctx->mask->type == SPDK_MD_MASK_TYPE_USED_PAGES);
+	assert(mask->type == SPDK_MD_MASK_TYPE_USED_PAGES);
 	/* The length of the mask (in bits) must not be greater than the length of the buffer (converted to bits) */
-	assert(ctx->mask->length <= (ctx->super->used_page_mask_len * SPDK_BS_PAGE_SIZE *
-				     8));
+	assert(mask->length <= (ctx->super->used_page_mask_len * SPDK_BS_PAGE_SIZE *
+				8));
 	/* The length of the mask must be exactly equal to the size (in pages) of the metadata region */
-	if (ctx->mask->length != ctx->super->md_len) {
+	if (mask->length != ctx->super->md_len) {
 		SPDK_ERRLOG("mismatched md_len in used_pages mask: "
 			    "mask->length=%" PRIu32 " super->md_len=%" PRIu32 "\n",
-			    ctx->mask->length, ctx->super->md_len);
+			    mask->length, ctx->super->md_len);
 		assert(false);
 	}
 
-	rc = spdk_bit_array_resize(&ctx->bs->used_md_pages, ctx->mask->length);
+	rc = spdk_bit_array_resize(&ctx->bs->used_md_pages, mask->length);
 	if (rc < 0) {
-		spdk_free(ctx->mask);
-		bs_load_ctx_fail(ctx, rc);
-		return;
+		return rc;
 	}
 
-	spdk_bit_array_load_mask(ctx->bs->used_md_pages, ctx->mask->mask);
+	spdk_bit_array_load_mask(ctx->bs->used_md_pages, mask->mask);
+	return 0;
+}
+
+static void
+bs_load_free_used_masks(struct spdk_bs_load_ctx *ctx)
+{
 	spdk_free(ctx->mask);
+	ctx->mask = NULL;
+	spdk_free(ctx->used_clusters_mask);
+	ctx->used_clusters_mask = NULL;
+	spdk_free(ctx->used_blobids_mask);
+	ctx->used_blobids_mask = NULL;
+}
 
-	/* Read the used clusters mask */
-	mask_size = ctx->super->used_cluster_mask_len * SPDK_BS_PAGE_SIZE;
-	ctx->mask = spdk_zmalloc(mask_size, 0x1000, NULL, SPDK_ENV_SOCKET_ID_ANY,
-				 SPDK_MALLOC_DMA);
-	if (!ctx->mask) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
+static void
+bs_load_used_masks_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_load_ctx *ctx = cb_arg;
+	int rc;
+
+	if (bserrno != 0) {
+		bs_load_free_used_masks(ctx);
+		bs_load_ctx_fail(ctx, bserrno);
 		return;
 	}
-	lba = bs_page_to_lba(ctx->bs, ctx->super->used_cluster_mask_start);
-	lba_count = bs_page_to_lba(ctx->bs, ctx->super->used_cluster_mask_len);
-	bs_sequence_read_dev(seq, ctx->mask, lba, lba_count,
-			     bs_load_used_clusters_cpl, ctx);
+
+	rc = bs_load_used_pages(ctx, ctx->mask);
+	if (rc == 0) {
+		rc = bs_load_used_clusters(ctx, ctx->used_clusters_mask);
+	}
+	if (rc == 0) {
+		rc = bs_load_used_blobids(ctx, ctx->used_blobids_mask);
+	}
+
+	bs_load_free_used_masks(ctx);
+	if (rc != 0) {
+		bs_load_ctx_fail(ctx, rc);
+		return;
+	}
+
+	bs_load_complete(ctx);
+}
+
+static struct spdk_bs_md_mask *
+bs_load_alloc_used_mask(uint32_t mask_len)
+{
+	return spdk_zmalloc(mask_len * SPDK_BS_PAGE_SIZE, 0x1000, NULL,
+			    SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
 }
 
 static void
-bs_load_read_used_pages(struct spdk_bs_load_ctx *ctx)
+bs_load_read_used_masks(struct spdk_bs_load_ctx *ctx)
 {
-	uint64_t lba, lba_count, mask_size;
+	struct spdk_bs_super_block *super = ctx->super;
+	spdk_bs_batch_t *batch;
 
-	/* Read the used pages mask */
-	mask_size = ctx->super->used_page_mask_len * SPDK_BS_PAGE_SIZE;
-	ctx->mask = spdk_zmalloc(mask_size, 0x1000, NULL,
-				 SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->mask) {
+	/* The used pages, used clusters and used blobids masks do not depend on
+	 * each other, so read all of them at once. */
+	ctx->mask = bs_load_alloc_used_mask(super->used_page_mask_len);
+	ctx->used_clusters_mask = bs_load_alloc_used_mask(super->used_cluster_mask_len);
+	ctx->used_blobids_mask = bs_load_alloc_used_mask(super->used_blobid_mask_len);
+	if (!ctx->mask || !ctx->used_clusters_mask || !ctx->used_blobids_mask) {
+		bs_load_free_used_masks(ctx);
 		bs_load_ctx_fail(ctx, -ENOMEM);
 		return;
 	}
 
-	lba = bs_page_to_lba(ctx->bs, ctx->super->used_page_mask_start);
-	lba_count = bs_page_to_lba(ctx->bs, ctx->super->used_page_mask_len);
-	bs_sequence_read_dev(ctx->seq, ctx->mask, lba, lba_count,
-			     bs_load_used_pages_cpl, ctx);
+	batch = bs_sequence_to_batch(ctx->seq, bs_load_used_masks_cpl, ctx);
+
+	bs_batch_read_dev(batch, ctx->mask,
+			  bs_page_to_lba(ctx->bs, super->used_page_mask_start),
+			  bs_page_to_lba(ctx->bs, super->used_page_mask_len));
+	bs_batch_read_dev(batch, ctx->used_clusters_mask,
+			  bs_page_to_lba(ctx->bs, super->used_cluster_mask_start),
+			  bs_page_to_lba(ctx->bs, super->used_cluster_mask_len));
+	bs_batch_read_dev(batch, ctx->used_blobids_mask,
+			  bs_page_to_lba(ctx->bs, super->used_blobid_mask_start),
+			  bs_page_to_lba(ctx->bs, super->used_blobid_mask_len));
+
+	bs_batch_close(batch);
 }
 
 static int
@@ -4021,6 +5148,10 @@ bs_load_replay_md_parse_page(struct spdk_bs_load_ctx *ctx, struct spdk_blob_md_p
 			/* Skip this item */
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_FLAGS) {
 			/* Skip this item */
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_COW_MAP) {
+			/* Skip this item */
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_MD_JOURNAL) {
+			/* Skip this item */
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_EXTENT_TABLE) {
 			struct spdk_blob_md_descriptor_extent_table *desc_extent_table;
 			uint32_t num_extent_pages = ctx->num_extent_pages;
@@ -4104,10 +5235,19 @@ bs_load_cur_extent_page_valid(struct spdk_blob_md_page *page)
 		return false;
 	}
 
-	/* It has to be the only descriptor in the page. */
-	if (desc_len + sizeof(*desc) <= sizeof(page->descriptors)) {
+	/* It can only be followed by copy-on-write maps of the clusters it describes. */
+	while (desc_len + sizeof(*desc) <= sizeof(page->descriptors)) {
 		desc = (struct spdk_blob_md_descriptor *)((uintptr_t)page->descriptors + desc_len);
-		if (desc->length != 0) {
+		if (desc->length == 0) {
+			break;
+		}
+
+		if (desc->type != SPDK_MD_DESCRIPTOR_TYPE_COW_MAP) {
+			return false;
+		}
+
+		desc_len += sizeof(*desc) + desc->length;
+		if (desc_len > sizeof(page->descriptors)) {
 			return false;
 		}
 	}
@@ -4116,10 +5256,9 @@ bs_load_cur_extent_page_valid(struct spdk_blob_md_page *page)
 }
 
 static bool
-bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
+bs_load_md_page_valid(struct spdk_blob_md_page *page, uint32_t page_num)
 {
 	uint32_t crc;
-	struct spdk_blob_md_page *page = ctx->page;
 
 	crc = blob_md_page_calc_crc(page);
 	if (crc != page->crc) {
@@ -4128,7 +5267,7 @@ bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
 
 	/* First page of a sequence should match the blobid. */
 	if (page->sequence_num == 0 &&
-	    bs_page_to_blobid(ctx->cur_page) != page->id) {
+	    bs_page_to_blobid(page_num) != page->id) {
 		return false;
 	}
 	assert(bs_load_cur_extent_page_valid(page) == false);
@@ -4136,8 +5275,6 @@ bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
 	return true;
 }
 
-static void bs_load_replay_cur_md_page(struct spdk_bs_load_ctx *ctx);
-
 static void
 bs_load_write_used_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
@@ -4190,164 +5327,275 @@ bs_load_write_used_md(struct spdk_bs_load_ctx *ctx)
 }
 
 static void
-bs_load_replay_md_chain_cpl(struct spdk_bs_load_ctx *ctx)
+bs_load_replay_md_done(struct spdk_bs_load_ctx *ctx)
 {
 	uint64_t num_md_clusters;
 	uint64_t i;
+	int rc = ctx->replay_rc;
+
+	spdk_free(ctx->replay_buf);
+	ctx->replay_buf = NULL;
+	free(ctx->replay_reqs);
+	ctx->replay_reqs = NULL;
+	free(ctx->chain_page_num);
+	ctx->chain_page_num = NULL;
+	free(ctx->extent_page_num);
+	ctx->extent_page_num = NULL;
+	ctx->num_extent_pages = 0;
+
+	if (rc != 0) {
+		bs_load_ctx_fail(ctx, rc);
+		return;
+	}
+
+	/* Claim all of the clusters used by the metadata */
+	num_md_clusters = spdk_divide_round_up(
+				  ctx->super->md_start + ctx->super->md_len, ctx->bs->pages_per_cluster);
+	for (i = 0; i < num_md_clusters; i++) {
+		spdk_bit_array_set(ctx->used_clusters, i);
+	}
+	ctx->bs->num_free_clusters -= num_md_clusters;
+	bs_load_write_used_md(ctx);
+}
+
+static int
+bs_load_replay_md_page(struct spdk_bs_load_ctx *ctx, struct spdk_blob_md_page *page,
+		       uint32_t page_num)
+{
+	bs_claim_md_page(ctx->bs, page_num);
+	if (page->sequence_num == 0) {
+		SPDK_NOTICELOG("Recover: blob %" PRIu32 "\n", page_num);
+		spdk_bit_array_set(ctx->bs->used_blobids, page_num);
+	}
+	if (bs_load_replay_md_parse_page(ctx, page)) {
+		return -EILSEQ;
+	}
+
+	if (page->next != SPDK_INVALID_MD_PAGE) {
+		if (page->next >= ctx->super->md_len) {
+			return -EILSEQ;
+		}
+		/* At most one page per chain is queued, and new chains are not
+		 * started while any page is queued. */
+		assert(ctx->num_chain_pages - ctx->next_chain_page < ctx->chain_pages_array_size);
+		ctx->chain_page_num[ctx->num_chain_pages++ % ctx->chain_pages_array_size] = page->next;
+	}
+
+	return 0;
+}
+
+static int
+bs_load_replay_scan_pages(struct spdk_bs_load_ctx *ctx, struct spdk_bs_load_replay_req *req)
+{
+	struct spdk_blob_md_page *page;
+	uint32_t page_num;
+	uint32_t i;
+	int rc;
 
-	ctx->in_page_chain = false;
+	for (i = 0; i < req->num_pages; i++) {
+		page = &req->pages[i];
+		page_num = req->page_num + i;
 
-	do {
-		ctx->page_index++;
-	} while (spdk_bit_array_get(ctx->bs->used_md_pages, ctx->page_index) == true);
+		/* Only the first page of each chain starts replay of a blob. Other pages
+		 * are reached by following the chain. */
+		if (spdk_bit_array_get(ctx->bs->used_md_pages, page_num) ||
+		    bs_load_md_page_valid(page, page_num) == false ||
+		    page->sequence_num != 0) {
+			continue;
+		}
 
-	if (ctx->page_index < ctx->super->md_len) {
-		ctx->cur_page = ctx->page_index;
-		bs_load_replay_cur_md_page(ctx);
-	} else {
-		/* Claim all of the clusters used by the metadata */
-		num_md_clusters = spdk_divide_round_up(
-					  ctx->super->md_start + ctx->super->md_len, ctx->bs->pages_per_cluster);
-		for (i = 0; i < num_md_clusters; i++) {
-			spdk_bit_array_set(ctx->used_clusters, i);
+		rc = bs_load_replay_md_page(ctx, page, page_num);
+		if (rc != 0) {
+			return rc;
 		}
-		ctx->bs->num_free_clusters -= num_md_clusters;
-		spdk_free(ctx->page);
-		bs_load_write_used_md(ctx);
 	}
+
+	return 0;
 }
 
-static void
-bs_load_replay_extent_page_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+static int
+bs_load_replay_chain_page(struct spdk_bs_load_ctx *ctx, struct spdk_bs_load_replay_req *req)
 {
-	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint32_t page_num;
-	uint64_t i;
+	struct spdk_blob_md_page *page = req->pages;
 
-	if (bserrno != 0) {
-		spdk_free(ctx->extent_pages);
-		bs_load_ctx_fail(ctx, bserrno);
-		return;
+	/* A page that is not valid ends the chain, same as a page already
+	 * claimed or another first page would. */
+	if (spdk_bit_array_get(ctx->bs->used_md_pages, req->page_num) ||
+	    bs_load_md_page_valid(page, req->page_num) == false ||
+	    page->sequence_num == 0) {
+		return 0;
 	}
 
-	for (i = 0; i < ctx->num_extent_pages; i++) {
-		/* Extent pages are only read when present within in chain md.
-		 * Integrity of md is not right if that page was not a valid extent page. */
-		if (bs_load_cur_extent_page_valid(&ctx->extent_pages[i]) != true) {
-			spdk_free(ctx->extent_pages);
-			bs_load_ctx_fail(ctx, -EILSEQ);
-			return;
-		}
+	return bs_load_replay_md_page(ctx, page, req->page_num);
+}
 
-		page_num = ctx->extent_page_num[i];
-		spdk_bit_array_set(ctx->bs->used_md_pages, page_num);
-		if (bs_load_replay_md_parse_page(ctx, &ctx->extent_pages[i])) {
-			spdk_free(ctx->extent_pages);
-			bs_load_ctx_fail(ctx, -EILSEQ);
-			return;
-		}
+static int
+bs_load_replay_extent_page(struct spdk_bs_load_ctx *ctx, struct spdk_bs_load_replay_req *req)
+{
+	/* Extent pages are only read when present within in chain md.
+	 * Integrity of md is not right if that page was not a valid extent page. */
+	if (bs_load_cur_extent_page_valid(req->pages) != true) {
+		return -EILSEQ;
 	}
 
-	spdk_free(ctx->extent_pages);
-	free(ctx->extent_page_num);
-	ctx->extent_page_num = NULL;
-	ctx->num_extent_pages = 0;
+	spdk_bit_array_set(ctx->bs->used_md_pages, req->page_num);
+	if (bs_load_replay_md_parse_page(ctx, req->pages)) {
+		return -EILSEQ;
+	}
 
-	bs_load_replay_md_chain_cpl(ctx);
+	return 0;
 }
 
+static void bs_load_replay_md_submit(struct spdk_bs_load_ctx *ctx);
+
 static void
-bs_load_replay_extent_pages(struct spdk_bs_load_ctx *ctx)
+bs_load_replay_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
-	spdk_bs_batch_t *batch;
-	uint32_t page;
-	uint64_t lba;
-	uint64_t i;
+	struct spdk_bs_load_replay_req *req = cb_arg;
+	struct spdk_bs_load_ctx *ctx = req->ctx;
+	int rc = bserrno;
 
-	ctx->extent_pages = spdk_zmalloc(SPDK_BS_PAGE_SIZE * ctx->num_extent_pages, 0,
-					 NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->extent_pages) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
-		return;
+	bs_sequence_finish(seq, 0);
+	ctx->replay_outstanding--;
+
+	/* Pages are parsed as soon as they arrive, while the other reads are
+	 * still in progress. */
+	if (rc == 0 && ctx->replay_rc == 0) {
+		switch (req->type) {
+		case BS_LOAD_REPLAY_SCAN:
+			rc = bs_load_replay_scan_pages(ctx, req);
+			break;
+		case BS_LOAD_REPLAY_CHAIN:
+			rc = bs_load_replay_chain_page(ctx, req);
+			break;
+		case BS_LOAD_REPLAY_EXTENT:
+			rc = bs_load_replay_extent_page(ctx, req);
+			break;
+		}
+	}
+
+	if (rc != 0 && ctx->replay_rc == 0) {
+		ctx->replay_rc = rc;
 	}
 
-	batch = bs_sequence_to_batch(ctx->seq, bs_load_replay_extent_page_cpl, ctx);
+	TAILQ_INSERT_TAIL(&ctx->replay_free_reqs, req, link);
+	bs_load_replay_md_submit(ctx);
+}
 
-	for (i = 0; i < ctx->num_extent_pages; i++) {
-		page = ctx->extent_page_num[i];
-		assert(page < ctx->super->md_len);
-		lba = bs_md_page_to_lba(ctx->bs, page);
-		bs_batch_read_dev(batch, &ctx->extent_pages[i], lba,
-				  bs_byte_to_lba(ctx->bs, SPDK_BS_PAGE_SIZE));
+static bool
+bs_load_replay_md_next(struct spdk_bs_load_ctx *ctx, struct spdk_bs_load_replay_req *req)
+{
+	/* Finish the blobs already found before scanning for new ones, so that
+	 * the amount of pending work stays bounded. */
+	if (ctx->next_extent_page < ctx->num_extent_pages) {
+		req->type = BS_LOAD_REPLAY_EXTENT;
+		req->page_num = ctx->extent_page_num[ctx->next_extent_page];
+		req->num_pages = 1;
+	} else if (ctx->next_chain_page < ctx->num_chain_pages) {
+		req->type = BS_LOAD_REPLAY_CHAIN;
+		req->page_num = ctx->chain_page_num[ctx->next_chain_page % ctx->chain_pages_array_size];
+		req->num_pages = 1;
+	} else if (ctx->scan_page < ctx->super->md_len) {
+		req->type = BS_LOAD_REPLAY_SCAN;
+		req->page_num = ctx->scan_page;
+		req->num_pages = spdk_min(SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES,
+					  ctx->super->md_len - ctx->scan_page);
+	} else {
+		return false;
 	}
 
-	bs_batch_close(batch);
+	return true;
 }
 
 static void
-bs_load_replay_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_load_replay_md_submit(struct spdk_bs_load_ctx *ctx)
 {
-	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint32_t page_num;
-	struct spdk_blob_md_page *page;
+	struct spdk_bs_load_replay_req *req;
+	struct spdk_bs_cpl cpl;
+	spdk_bs_sequence_t *seq;
 
-	if (bserrno != 0) {
-		bs_load_ctx_fail(ctx, bserrno);
+	/* Reads completing inline are picked up by the loop below. */
+	if (ctx->replay_submitting) {
 		return;
 	}
+	ctx->replay_submitting = true;
 
-	page_num = ctx->cur_page;
-	page = ctx->page;
-	if (bs_load_cur_md_page_valid(ctx) == true) {
-		if (page->sequence_num == 0 || ctx->in_page_chain == true) {
-			bs_claim_md_page(ctx->bs, page_num);
-			if (page->sequence_num == 0) {
-				SPDK_NOTICELOG("Recover: blob %" PRIu32 "\n", page_num);
-				spdk_bit_array_set(ctx->bs->used_blobids, page_num);
-			}
-			if (bs_load_replay_md_parse_page(ctx, page)) {
-				bs_load_ctx_fail(ctx, -EILSEQ);
-				return;
-			}
-			if (page->next != SPDK_INVALID_MD_PAGE) {
-				ctx->in_page_chain = true;
-				ctx->cur_page = page->next;
-				bs_load_replay_cur_md_page(ctx);
-				return;
+	cpl.type = SPDK_BS_CPL_TYPE_NONE;
+	while (ctx->replay_rc == 0) {
+		req = TAILQ_FIRST(&ctx->replay_free_reqs);
+		if (req == NULL || !bs_load_replay_md_next(ctx, req)) {
+			break;
+		}
+
+		seq = bs_sequence_start(ctx->bs->md_channel, &cpl);
+		if (seq == NULL) {
+			/* Wait for outstanding reads to release their requests. */
+			if (ctx->replay_outstanding == 0) {
+				ctx->replay_rc = -ENOMEM;
 			}
-			if (ctx->num_extent_pages != 0) {
-				bs_load_replay_extent_pages(ctx);
-				return;
+			break;
+		}
+
+		switch (req->type) {
+		case BS_LOAD_REPLAY_SCAN:
+			ctx->scan_page += req->num_pages;
+			break;
+		case BS_LOAD_REPLAY_CHAIN:
+			ctx->next_chain_page++;
+			break;
+		case BS_LOAD_REPLAY_EXTENT:
+			assert(req->page_num < ctx->super->md_len);
+			if (++ctx->next_extent_page == ctx->num_extent_pages) {
+				ctx->next_extent_page = 0;
+				ctx->num_extent_pages = 0;
 			}
+			break;
 		}
+
+		TAILQ_REMOVE(&ctx->replay_free_reqs, req, link);
+		ctx->replay_outstanding++;
+		bs_sequence_read_dev(seq, req->pages, bs_md_page_to_lba(ctx->bs, req->page_num),
+				     bs_byte_to_lba(ctx->bs, req->num_pages * SPDK_BS_PAGE_SIZE),
+				     bs_load_replay_md_cpl, req);
 	}
-	bs_load_replay_md_chain_cpl(ctx);
-}
 
-static void
-bs_load_replay_cur_md_page(struct spdk_bs_load_ctx *ctx)
-{
-	uint64_t lba;
+	ctx->replay_submitting = false;
 
-	assert(ctx->cur_page < ctx->super->md_len);
-	lba = bs_md_page_to_lba(ctx->bs, ctx->cur_page);
-	bs_sequence_read_dev(ctx->seq, ctx->page, lba,
-			     bs_byte_to_lba(ctx->bs, SPDK_BS_PAGE_SIZE),
-			     bs_load_replay_md_cpl, ctx);
+	if (ctx->replay_outstanding == 0) {
+		bs_load_replay_md_done(ctx);
+	}
 }
 
 static void
 bs_load_replay_md(struct spdk_bs_load_ctx *ctx)
 {
-	ctx->page_index = 0;
-	ctx->cur_page = 0;
-	ctx->page = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0,
-				 NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->page) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
+	struct spdk_bs_load_replay_req *req;
+	uint32_t i;
+
+	/* Metadata region is scanned with large sequential reads, while chains of
+	 * the blobs found and their extent pages are followed with separate reads.
+	 * All of them share a window of SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH requests. */
+	ctx->scan_page = 0;
+	ctx->chain_pages_array_size = SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH * SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES;
+	ctx->chain_page_num = calloc(ctx->chain_pages_array_size, sizeof(uint32_t));
+	ctx->replay_reqs = calloc(SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH, sizeof(*ctx->replay_reqs));
+	ctx->replay_buf = spdk_zmalloc(SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH * SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES *
+				       SPDK_BS_PAGE_SIZE, 0, NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!ctx->chain_page_num || !ctx->replay_reqs || !ctx->replay_buf) {
+		ctx->replay_rc = -ENOMEM;
+		bs_load_replay_md_done(ctx);
 		return;
 	}
-	bs_load_replay_cur_md_page(ctx);
+
+	TAILQ_INIT(&ctx->replay_free_reqs);
+	for (i = 0; i < SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH; i++) {
+		req = &ctx->replay_reqs[i];
+		req->ctx = ctx;
+		req->pages = &ctx->replay_buf[i * SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES];
+		TAILQ_INSERT_TAIL(&ctx->replay_free_reqs, req, link);
+	}
+
+	bs_load_replay_md_submit(ctx);
 }
 
 static void
@@ -4421,7 +5669,7 @@ bs_parse_super(struct spdk_bs_load_ctx *ctx)
 	ctx->bs->super_blob = ctx->super->super_blob;
 	memcpy(&ctx->bs->bstype, &ctx->super->bstype, sizeof(ctx->super->bstype));
 
-	return 0;
+	return bs_load_md_journal_alloc(ctx);
 }
 
 static void
@@ -4432,7 +5680,7 @@ bs_load_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	int		rc;
 	static const char zeros[SPDK_BLOBSTORE_TYPE_LENGTH];
 
-	if (ctx->super->version > SPDK_BS_VERSION ||
+	if (ctx->super->version > SPDK_BS_MD_JOURNAL_VERSION ||
 	    ctx->super->version < SPDK_BS_INITIAL_VERSION) {
 		bs_load_ctx_fail(ctx, -EILSEQ);
 		return;
@@ -4478,7 +5726,7 @@ bs_load_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	if (ctx->super->used_blobid_mask_len == 0 || ctx->super->clean == 0 || ctx->force_recover) {
 		bs_recover(ctx);
 	} else {
-		bs_load_read_used_pages(ctx);
+		bs_load_read_used_masks(ctx);
 	}
 }
 
@@ -4511,12 +5759,14 @@ bs_opts_copy(struct spdk_bs_opts *src, struct spdk_bs_opts *dst)
 	SET_FIELD(iter_cb_fn);
 	SET_FIELD(iter_cb_arg);
 	SET_FIELD(force_recover);
+	SET_FIELD(sub_cluster_cow);
+	SET_FIELD(md_journal_pages);
 
 	dst->opts_size = src->opts_size;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 72, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -4689,6 +5939,7 @@ bs_dump_print_type_flags(struct spdk_bs_load_ctx *ctx, struct spdk_blob_md_descr
 		ADD_FLAG(SPDK_BLOB_THIN_PROV),
 		ADD_FLAG(SPDK_BLOB_INTERNAL_XATTR),
 		ADD_FLAG(SPDK_BLOB_EXTENT_TABLE),
+		ADD_FLAG(SPDK_BLOB_COW_MAP),
 	};
 	static struct type_flag_desc data_ro[] = {
 		ADD_FLAG(SPDK_BLOB_READ_ONLY),
@@ -4816,6 +6067,17 @@ bs_dump_print_md_page(struct spdk_bs_load_ctx *ctx)
 			bs_dump_print_type_flags(ctx, desc);
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_EXTENT_TABLE) {
 			bs_dump_print_extent_table(ctx, desc);
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_COW_MAP) {
+			struct spdk_blob_md_descriptor_cow_map *desc_cow_map;
+
+			desc_cow_map = (struct spdk_blob_md_descriptor_cow_map *)desc;
+			fprintf(ctx->fp, "Copy-on-write map - Cluster: %" PRIu32 " Length: %" PRIu32 "\n",
+				desc_cow_map->cluster_idx, desc_cow_map->length);
+		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_MD_JOURNAL) {
+			struct spdk_blob_md_descriptor_md_journal *desc_md_journal;
+
+			desc_md_journal = (struct spdk_blob_md_descriptor_md_journal *)desc;
+			fprintf(ctx->fp, "Metadata journal sequence: %" PRIu64 "\n", desc_md_journal->seq);
 		} else {
 			/* Error */
 			fprintf(ctx->fp, "Unknown descriptor type %" PRIu8 "\n", desc->type);
@@ -4901,6 +6163,11 @@ bs_dump_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	fprintf(ctx->fp, "Used Blob ID Mask Length: %" PRIu32 "\n", ctx->super->used_blobid_mask_len);
 	fprintf(ctx->fp, "Metadata Start: %" PRIu32 "\n", ctx->super->md_start);
 	fprintf(ctx->fp, "Metadata Length: %" PRIu32 "\n", ctx->super->md_len);
+	if (ctx->super->version >= SPDK_BS_MD_JOURNAL_VERSION) {
+		fprintf(ctx->fp, "Metadata Journal Start: %" PRIu32 "\n", ctx->super->md_journal_start);
+		fprintf(ctx->fp, "Metadata Journal Length: %" PRIu32 "\n", ctx->super->md_journal_len);
+		fprintf(ctx->fp, "Metadata Journal Sequence: %" PRIu64 "\n", ctx->super->md_journal_seq);
+	}
 
 	ctx->cur_page = 0;
 	ctx->page = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0,
@@ -4916,7 +6183,7 @@ bs_dump_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
-	bs_load_read_used_pages(ctx);
+	bs_load_read_used_masks(ctx);
 }
 
 void
@@ -5129,6 +6396,24 @@ spdk_bs_init(struct spdk_bs_dev *dev, struct spdk_bs_opts *o,
 					   SPDK_BS_PAGE_SIZE);
 	num_md_pages += ctx->super->used_blobid_mask_len;
 
+	if (opts.md_journal_pages != 0) {
+		/* The journal is cleared along with the rest of metadata space */
+		rc = bs_md_journal_alloc(bs, num_md_pages, opts.md_journal_pages);
+		if (rc < 0) {
+			spdk_free(ctx->super);
+			spdk_bit_array_free(&ctx->used_clusters);
+			free(ctx);
+			bs_free(bs);
+			cb_fn(cb_arg, NULL, rc);
+			return;
+		}
+		ctx->super->version = SPDK_BS_MD_JOURNAL_VERSION;
+		ctx->super->md_journal_start = num_md_pages;
+		ctx->super->md_journal_len = opts.md_journal_pages;
+		ctx->super->md_journal_next_seq = bs->md_journal->next_seq;
+		num_md_pages += opts.md_journal_pages;
+	}
+
 	/* The metadata region size was chosen above */
 	ctx->super->md_start = bs->md_start = num_md_pages;
 	ctx->super->md_len = bs->md_len;
@@ -5310,6 +6595,11 @@ bs_unload_write_used_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bse
 	}
 
 	ctx->super->clean = 1;
+	if (ctx->bs->md_journal != NULL) {
+		/* All blobs are closed, so every record is reflected in blob metadata */
+		ctx->super->md_journal_seq = ctx->bs->md_journal->next_seq - 1;
+		ctx->super->md_journal_next_seq = ctx->bs->md_journal->next_seq;
+	}
 
 	bs_write_super(seq, ctx->bs, ctx->super, bs_unload_write_super_cpl, ctx);
 }
@@ -5373,6 +6663,14 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 		return;
 	}
 
+	if (bs->md_journal != NULL && (bs->md_journal->writing != NULL ||
+				       bs->md_journal->open->num_pages > 0 ||
+				       bs->md_journal->checkpointing)) {
+		SPDK_ERRLOG("Blobstore metadata journal is still in use\n");
+		cb_fn(cb_arg, -EBUSY);
+		return;
+	}
+
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
 		cb_fn(cb_arg, -ENOMEM);
@@ -5911,6 +7209,8 @@ bs_snapshot_swap_cluster_maps(struct spdk_blob *blob1, struct spdk_blob *blob2)
 {
 	uint64_t *cluster_temp;
 	uint32_t *extent_page_temp;
+	struct spdk_blob_cow_map **cow_maps_temp;
+	size_t cow_map_array_size_temp;
 
 	cluster_temp = blob1->active.clusters;
 	blob1->active.clusters = blob2->active.clusters;
@@ -5919,6 +7219,14 @@ bs_snapshot_swap_cluster_maps(struct spdk_blob *blob1, struct spdk_blob *blob2)
 	extent_page_temp = blob1->active.extent_pages;
 	blob1->active.extent_pages = blob2->active.extent_pages;
 	blob2->active.extent_pages = extent_page_temp;
+
+	cow_maps_temp = blob1->cow_maps;
+	blob1->cow_maps = blob2->cow_maps;
+	blob2->cow_maps = cow_maps_temp;
+
+	cow_map_array_size_temp = blob1->cow_map_array_size;
+	blob1->cow_map_array_size = blob2->cow_map_array_size;
+	blob2->cow_map_array_size = cow_map_array_size_temp;
 }
 
 static void
@@ -6368,8 +7676,8 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 
 	assert(blob != NULL);
 
-	if (blob->active.clusters[cluster] != 0) {
-		/* Cluster is already allocated */
+	if (blob->active.clusters[cluster] != 0 && blob_get_cow_map(blob, cluster) == NULL) {
+		/* Cluster is already allocated and fully populated */
 		return false;
 	}
 
@@ -6468,7 +7776,9 @@ bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 	 */
 	clusters_needed = 0;
 	for (i = 0; i < _blob->active.num_clusters; i++) {
-		if (bs_cluster_needs_allocation(_blob, i, ctx->allocate_all)) {
+		/* Partially populated clusters are compacted in place */
+		if (_blob->active.clusters[i] == 0 &&
+		    bs_cluster_needs_allocation(_blob, i, ctx->allocate_all)) {
 			clusters_needed++;
 		}
 	}
@@ -6653,6 +7963,7 @@ struct delete_snapshot_ctx {
 	void *cb_arg;
 	int bserrno;
 	uint32_t next_extent_page;
+	uint64_t next_cluster;
 };
 
 static void
@@ -6901,6 +8212,12 @@ delete_snapshot_sync_snapshot_xattr_cpl(void *cb_arg, int bserrno)
 	for (i = 0; i < ctx->snapshot->active.num_clusters && i < ctx->clone->active.num_clusters; i++) {
 		if (ctx->clone->active.clusters[i] == 0) {
 			ctx->clone->active.clusters[i] = ctx->snapshot->active.clusters[i];
+
+			if (blob_get_cow_map(ctx->snapshot, i) != NULL) {
+				ctx->clone->cow_maps[i] = ctx->snapshot->cow_maps[i];
+				ctx->snapshot->cow_maps[i] = NULL;
+				ctx->clone->invalid_flags |= SPDK_BLOB_COW_MAP;
+			}
 		}
 	}
 	ctx->next_extent_page = 0;
@@ -6908,17 +8225,8 @@ delete_snapshot_sync_snapshot_xattr_cpl(void *cb_arg, int bserrno)
 }
 
 static void
-delete_snapshot_freeze_io_cb(void *cb_arg, int bserrno)
+delete_snapshot_mark_pending_removal(struct delete_snapshot_ctx *ctx)
 {
-	struct delete_snapshot_ctx *ctx = cb_arg;
-
-	if (bserrno) {
-		SPDK_ERRLOG("Failed to freeze I/O on clone\n");
-		ctx->bserrno = bserrno;
-		delete_snapshot_cleanup_clone(ctx, 0);
-		return;
-	}
-
 	/* Temporarily override md_ro flag for snapshot for MD modification */
 	ctx->snapshot_md_ro = ctx->snapshot->md_ro;
 	ctx->snapshot->md_ro = false;
@@ -6934,6 +8242,82 @@ delete_snapshot_freeze_io_cb(void *cb_arg, int bserrno)
 	spdk_blob_sync_md(ctx->snapshot, delete_snapshot_sync_snapshot_xattr_cpl, ctx);
 }
 
+/* Io_units not written to a partially populated cluster of the clone are read
+ * from the snapshot. Copy them over before the snapshot data goes away. */
+static void
+delete_snapshot_compact_clone_next(void *cb_arg, int bserrno)
+{
+	struct delete_snapshot_ctx *ctx = cb_arg;
+	struct spdk_blob *clone = ctx->clone;
+	struct spdk_blob *snapshot = ctx->snapshot;
+	struct spdk_bs_cpl cpl;
+	spdk_bs_user_op_t *op;
+	uint64_t offset;
+
+	if (bserrno) {
+		SPDK_ERRLOG("Failed to compact clusters of clone\n");
+		ctx->bserrno = bserrno;
+		delete_snapshot_cleanup_clone(ctx, 0);
+		return;
+	}
+
+	for (; ctx->next_cluster < clone->active.num_clusters &&
+	     ctx->next_cluster < snapshot->active.num_clusters; ctx->next_cluster++) {
+		if (blob_get_cow_map(clone, ctx->next_cluster) != NULL &&
+		    snapshot->active.clusters[ctx->next_cluster] != 0) {
+			break;
+		}
+	}
+
+	if (ctx->next_cluster < clone->active.num_clusters &&
+	    ctx->next_cluster < snapshot->active.num_clusters) {
+		offset = bs_cluster_to_lba(clone->bs, ctx->next_cluster);
+		ctx->next_cluster++;
+
+		/* Use a dummy 0B read as a context for cluster compaction */
+		cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+		cpl.u.blob_basic.cb_fn = delete_snapshot_compact_clone_next;
+		cpl.u.blob_basic.cb_arg = ctx;
+
+		op = bs_user_op_alloc(clone->bs->md_channel, &cpl, SPDK_BLOB_READ, clone,
+				      NULL, 0, offset, 0);
+		if (!op) {
+			delete_snapshot_compact_clone_next(ctx, -ENOMEM);
+			return;
+		}
+
+		bs_allocate_and_copy_cluster(clone, clone->bs->md_channel, offset, op);
+		return;
+	}
+
+	/* Maps of partially populated snapshot clusters are handed over to the clone */
+	if (snapshot->cow_maps != NULL) {
+		ctx->bserrno = blob_cow_map_array_resize(clone, clone->active.cluster_array_size);
+		if (ctx->bserrno != 0) {
+			delete_snapshot_cleanup_clone(ctx, 0);
+			return;
+		}
+	}
+
+	delete_snapshot_mark_pending_removal(ctx);
+}
+
+static void
+delete_snapshot_freeze_io_cb(void *cb_arg, int bserrno)
+{
+	struct delete_snapshot_ctx *ctx = cb_arg;
+
+	if (bserrno) {
+		SPDK_ERRLOG("Failed to freeze I/O on clone\n");
+		ctx->bserrno = bserrno;
+		delete_snapshot_cleanup_clone(ctx, 0);
+		return;
+	}
+
+	ctx->next_cluster = 0;
+	delete_snapshot_compact_clone_next(ctx, 0);
+}
+
 static void
 delete_snapshot_open_clone_cb(void *cb_arg, struct spdk_blob *clone, int bserrno)
 {
@@ -7302,57 +8686,277 @@ spdk_blob_set_read_only(struct spdk_blob *blob)
 }
 /* END spdk_blob_set_read_only */
 
-/* START spdk_blob_sync_md */
+/* START spdk_blob_sync_md */
+
+static void
+blob_sync_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob *blob = cb_arg;
+
+	if (bserrno == 0 && (blob->data_ro_flags & SPDK_BLOB_READ_ONLY)) {
+		blob->data_ro = true;
+		blob->md_ro = true;
+	}
+
+	bs_sequence_finish(seq, bserrno);
+}
+
+static void
+blob_sync_md(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_cpl	cpl;
+	spdk_bs_sequence_t	*seq;
+
+	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+	cpl.u.blob_basic.cb_fn = cb_fn;
+	cpl.u.blob_basic.cb_arg = cb_arg;
+
+	seq = bs_sequence_start(blob->bs->md_channel, &cpl);
+	if (!seq) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	blob_persist(seq, blob, blob_sync_md_cpl, blob);
+}
+
+void
+spdk_blob_sync_md(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	blob_verify_md_op(blob);
+
+	SPDK_DEBUGLOG(blob, "Syncing blob %" PRIu64 "\n", blob->id);
+
+	if (blob->md_ro) {
+		assert(blob->state == SPDK_BLOB_STATE_CLEAN);
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	blob_sync_md(blob, cb_fn, cb_arg);
+}
+
+/* END spdk_blob_sync_md */
+
+/* START metadata journal */
+
+static void bs_md_journal_checkpoint_next(struct spdk_bs_md_journal *journal);
+
+static void
+bs_md_journal_checkpoint_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_md_journal *journal = cb_arg;
+
+	if (bserrno != 0) {
+		/* Records stay in the journal until the next checkpoint */
+		SPDK_ERRLOG("Failed to checkpoint metadata journal: %d\n", bserrno);
+		journal->checkpointing = false;
+		return;
+	}
+
+	bs_md_journal_checkpoint_next(journal);
+}
+
+static void
+bs_md_journal_checkpoint_next(struct spdk_bs_md_journal *journal)
+{
+	struct spdk_blob	*blob;
+	uint32_t		tail;
+
+	TAILQ_FOREACH(blob, &journal->dirty_blobs, md_journal_link) {
+		if (blob->md_journal_seq < journal->checkpoint_seq) {
+			blob->state = SPDK_BLOB_STATE_DIRTY;
+			blob_sync_md(blob, bs_md_journal_checkpoint_cpl, journal);
+			return;
+		}
+	}
+
+	/* Records up to the checkpoint are reflected in blob metadata,
+	 * release the slots holding them. The page still being filled
+	 * in the open batch cannot be released. */
+	while (journal->used > 0) {
+		tail = (journal->head + journal->len - journal->used) % journal->len;
+		if (journal->slot_seq[tail] > journal->checkpoint_seq ||
+		    (journal->open->num_pages > 0 && tail == journal->open->slot)) {
+			break;
+		}
+		journal->used--;
+	}
+
+	journal->checkpointing = false;
+}
+
+static void
+bs_md_journal_checkpoint(struct spdk_bs_md_journal *journal)
+{
+	if (journal->checkpointing) {
+		return;
+	}
+
+	SPDK_DEBUGLOG(blob, "Checkpointing metadata journal up to %" PRIu64 "\n", journal->next_seq - 1);
+
+	journal->checkpointing = true;
+	journal->checkpoint_seq = journal->next_seq - 1;
+	bs_md_journal_checkpoint_next(journal);
+}
+
+static void bs_md_journal_flush(struct spdk_bs_md_journal *journal);
 
 static void
-blob_sync_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_md_journal_write_cpl(void *cb_arg, int bserrno)
 {
-	struct spdk_blob *blob = cb_arg;
+	struct spdk_bs_md_journal		*journal = cb_arg;
+	struct spdk_bs_md_journal_batch		*batch = journal->writing;
+	struct spdk_bs_md_journal_req		*req;
+	TAILQ_HEAD(, spdk_bs_md_journal_req)	reqs;
 
-	if (bserrno == 0 && (blob->data_ro_flags & SPDK_BLOB_READ_ONLY)) {
-		blob->data_ro = true;
-		blob->md_ro = true;
+	if (bserrno != 0) {
+		SPDK_ERRLOG("Failed to write metadata journal: %d\n", bserrno);
+	}
+
+	TAILQ_INIT(&reqs);
+	TAILQ_SWAP(&batch->reqs, &reqs, spdk_bs_md_journal_req, link);
+	batch->num_pages = 0;
+	journal->writing = NULL;
+
+	while (!TAILQ_EMPTY(&reqs)) {
+		req = TAILQ_FIRST(&reqs);
+		TAILQ_REMOVE(&reqs, req, link);
+		req->cb_fn(req->cb_arg, bserrno);
+	}
+
+	if (journal->used * 2 >= journal->len) {
+		bs_md_journal_checkpoint(journal);
 	}
 
+	/* Records appended while this batch was written */
+	bs_md_journal_flush(journal);
+}
+
+static void
+bs_md_journal_write_dev_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
 	bs_sequence_finish(seq, bserrno);
 }
 
 static void
-blob_sync_md(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+bs_md_journal_flush(struct spdk_bs_md_journal *journal)
 {
-	struct spdk_bs_cpl	cpl;
-	spdk_bs_sequence_t	*seq;
+	struct spdk_blob_store		*bs = journal->bs;
+	struct spdk_bs_md_journal_batch	*batch = journal->open;
+	struct spdk_bs_cpl		cpl;
+	spdk_bs_sequence_t		*seq;
+	uint32_t			i;
 
-	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	cpl.u.blob_basic.cb_fn = cb_fn;
-	cpl.u.blob_basic.cb_arg = cb_arg;
+	if (journal->writing != NULL || batch->num_pages == 0) {
+		return;
+	}
 
-	seq = bs_sequence_start(blob->bs->md_channel, &cpl);
+	journal->writing = batch;
+	journal->open = batch == &journal->batches[0] ? &journal->batches[1] : &journal->batches[0];
+	assert(journal->open->num_pages == 0);
+
+	for (i = 0; i < batch->num_pages; i++) {
+		batch->pages[i].crc = blob_md_page_calc_crc(&batch->pages[i]);
+	}
+
+	cpl.type = SPDK_BS_CPL_TYPE_BS_BASIC;
+	cpl.u.bs_basic.cb_fn = bs_md_journal_write_cpl;
+	cpl.u.bs_basic.cb_arg = journal;
+
+	seq = bs_sequence_start(bs->md_channel, &cpl);
 	if (!seq) {
-		cb_fn(cb_arg, -ENOMEM);
+		bs_md_journal_write_cpl(journal, -ENOMEM);
 		return;
 	}
 
-	blob_persist(seq, blob, blob_sync_md_cpl, blob);
+	bs_sequence_write_dev(seq, batch->pages, bs_page_to_lba(bs, journal->start + batch->slot),
+			      bs_byte_to_lba(bs, batch->num_pages * SPDK_BS_PAGE_SIZE),
+			      bs_md_journal_write_dev_cpl, journal);
 }
 
-void
-spdk_blob_sync_md(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+static void
+bs_md_journal_flush_msg(void *arg)
 {
-	blob_verify_md_op(blob);
+	struct spdk_bs_md_journal *journal = arg;
 
-	SPDK_DEBUGLOG(blob, "Syncing blob %" PRIu64 "\n", blob->id);
+	journal->flush_scheduled = false;
+	bs_md_journal_flush(journal);
+}
 
-	if (blob->md_ro) {
-		assert(blob->state == SPDK_BLOB_STATE_CLEAN);
-		cb_fn(cb_arg, 0);
-		return;
+/* Append a record to the journal. Records appended in the same thread
+ * iteration are written together, req is completed once the record is
+ * on disk. Returns an error if the record does not fit, in which case
+ * the change has to be persisted in blob metadata instead.
+ */
+static int
+bs_md_journal_append(struct spdk_blob *blob, struct spdk_bs_md_journal_record *record,
+		     struct spdk_bs_md_journal_req *req)
+{
+	struct spdk_blob_store			*bs = blob->bs;
+	struct spdk_bs_md_journal		*journal = bs->md_journal;
+	struct spdk_bs_md_journal_batch		*batch;
+	struct spdk_bs_md_journal_page		*page = NULL;
+	uint32_t				slot;
+
+	if (journal == NULL || bs->clean) {
+		/* Blobstore has to be marked dirty, for the journal to be replayed on load */
+		return -ENOTSUP;
 	}
 
-	blob_sync_md(blob, cb_fn, cb_arg);
+	batch = journal->open;
+	if (batch->num_pages > 0) {
+		page = &batch->pages[batch->num_pages - 1];
+		if (page->length + record->length > sizeof(page->records)) {
+			page = NULL;
+		}
+	}
+
+	if (page == NULL) {
+		if (batch->num_pages == SPDK_BLOB_MD_JOURNAL_BATCH_PAGES ||
+		    journal->used == journal->len) {
+			return -ENOSPC;
+		}
+
+		if (batch->num_pages == 0) {
+			batch->slot = journal->head;
+		} else if (journal->head == 0) {
+			/* Pages of a batch are written at once, the batch cannot wrap */
+			return -ENOSPC;
+		}
+
+		page = &batch->pages[batch->num_pages++];
+		memset(page, 0, sizeof(*page));
+		journal->head = (journal->head + 1) % journal->len;
+		journal->used++;
+	}
+
+	slot = batch->slot + (page - batch->pages);
+
+	record->seq = journal->next_seq++;
+	if (page->seq == 0) {
+		page->seq = record->seq;
+	}
+	memcpy(&page->records[page->length], record, record->length);
+	page->length += record->length;
+	journal->slot_seq[slot] = record->seq;
+
+	blob->md_journal_last_seq = record->seq;
+	if (!blob->md_journal_dirty) {
+		TAILQ_INSERT_TAIL(&journal->dirty_blobs, blob, md_journal_link);
+		blob->md_journal_dirty = true;
+	}
+
+	TAILQ_INSERT_TAIL(&batch->reqs, req, link);
+	if (!journal->flush_scheduled && journal->writing == NULL) {
+		journal->flush_scheduled = true;
+		spdk_thread_send_msg(bs->md_thread, bs_md_journal_flush_msg, journal);
+	}
+
+	return 0;
 }
 
-/* END spdk_blob_sync_md */
+/* END metadata journal */
 
 struct spdk_blob_insert_cluster_ctx {
 	struct spdk_thread	*thread;
@@ -7361,9 +8965,11 @@ struct spdk_blob_insert_cluster_ctx {
 	uint32_t		cluster;	/* cluster on disk */
 	uint32_t		extent_page;	/* extent page on disk */
 	struct spdk_blob_md_page *page; /* preallocated extent page */
+	bool			cow_map;	/* track written io_units in the cluster */
 	int			rc;
 	spdk_blob_op_complete	cb_fn;
 	void			*cb_arg;
+	struct spdk_bs_md_journal_req md_journal_req;
 };
 
 static void
@@ -7435,11 +9041,137 @@ blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster
 			      blob_persist_extent_page_cpl, page);
 }
 
+static int
+blob_insert_cow_map(struct spdk_blob *blob, uint32_t cluster_num)
+{
+	struct spdk_blob_cow_map *map;
+	uint64_t start_cluster_idx, i;
+	size_t desc_size;
+	int rc;
+
+	if (blob->active.clusters[cluster_num] != 0) {
+		return -EEXIST;
+	}
+
+	/* Room for a fully populated extent page descriptor is always kept,
+	 * the maps share the rest of the extent page. */
+	desc_size = sizeof(struct spdk_blob_md_descriptor_extent_page) +
+		    SPDK_EXTENTS_PER_EP * sizeof(uint32_t) + bs_cow_map_desc_size(blob->bs);
+	start_cluster_idx = (cluster_num / SPDK_EXTENTS_PER_EP) * SPDK_EXTENTS_PER_EP;
+	for (i = start_cluster_idx; i < start_cluster_idx + SPDK_EXTENTS_PER_EP; i++) {
+		if (blob_get_cow_map(blob, i) != NULL) {
+			desc_size += bs_cow_map_desc_size(blob->bs);
+		}
+	}
+	if (desc_size > SPDK_BS_MAX_DESC_SIZE) {
+		return -ENOBUFS;
+	}
+
+	rc = blob_cow_map_array_resize(blob, blob->active.cluster_array_size);
+	if (rc != 0) {
+		return rc;
+	}
+
+	map = blob_cow_map_alloc(blob->bs);
+	if (map == NULL) {
+		return -ENOMEM;
+	}
+
+	/* I/O has to see the map before the cluster, or it would read the
+	 * parts not written yet from the cluster instead of the parent. */
+	blob->cow_maps[cluster_num] = map;
+	spdk_smp_wmb();
+
+	return 0;
+}
+
+/* Log the allocation in the metadata journal, instead of persisting
+ * blob metadata. Returns an error if the journal cannot be used. */
+static int
+blob_insert_cluster_journal(struct spdk_blob_insert_cluster_ctx *ctx)
+{
+	struct spdk_blob				*blob = ctx->blob;
+	struct spdk_bs_md_journal_record_cluster	record = {};
+	uint32_t					*extent_page = NULL;
+	int						rc;
+
+	if (blob->bs->md_journal == NULL) {
+		return -ENOTSUP;
+	}
+
+	if (blob->use_extent_table) {
+		extent_page = bs_cluster_to_extent_page(blob, ctx->cluster_num);
+		if (*extent_page == 0) {
+			/* New extent page has to be referenced from the extent table */
+			return -ENOTSUP;
+		}
+
+		rc = spdk_bit_array_resize(&blob->md_journal_eps, blob->active.extent_pages_array_size);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	record.hdr.type = SPDK_MD_JOURNAL_RECORD_CLUSTER;
+	record.hdr.length = sizeof(record);
+	record.hdr.blobid = blob->id;
+	record.cluster_num = ctx->cluster_num;
+	record.cluster_idx = ctx->cluster;
+
+	ctx->md_journal_req.cb_fn = blob_insert_cluster_msg_cb;
+	ctx->md_journal_req.cb_arg = ctx;
+
+	rc = bs_md_journal_append(blob, &record.hdr, &ctx->md_journal_req);
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* Written back on the next persist of the blob */
+	if (extent_page != NULL) {
+		spdk_bit_array_set(blob->md_journal_eps, ctx->cluster_num / SPDK_EXTENTS_PER_EP);
+	} else {
+		blob->state = SPDK_BLOB_STATE_DIRTY;
+	}
+
+	return 0;
+}
+
+static void
+blob_insert_cluster_sync_flags_cb(void *arg, int bserrno)
+{
+	struct spdk_blob_insert_cluster_ctx *ctx = arg;
+	uint32_t *extent_page;
+
+	if (bserrno != 0) {
+		blob_insert_cluster_msg_cb(ctx, bserrno);
+		return;
+	}
+
+	extent_page = bs_cluster_to_extent_page(ctx->blob, ctx->cluster_num);
+	blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
+			       blob_insert_cluster_msg_cb, ctx);
+}
+
 static void
 blob_insert_cluster_msg(void *arg)
 {
 	struct spdk_blob_insert_cluster_ctx *ctx = arg;
 	uint32_t *extent_page;
+	bool sync_flags = false;
+
+	if (ctx->cow_map) {
+		ctx->rc = blob_insert_cow_map(ctx->blob, ctx->cluster_num);
+		if (ctx->rc != 0) {
+			spdk_thread_send_msg(ctx->thread, blob_insert_cluster_msg_cpl, ctx);
+			return;
+		}
+
+		if (!(ctx->blob->invalid_flags & SPDK_BLOB_COW_MAP)) {
+			/* Blobstore versions unaware of the maps must not open this blob */
+			ctx->blob->invalid_flags |= SPDK_BLOB_COW_MAP;
+			sync_flags = true;
+		}
+	}
 
 	ctx->rc = blob_insert_cluster(ctx->blob, ctx->cluster_num, ctx->cluster);
 	if (ctx->rc != 0) {
@@ -7448,6 +9180,9 @@ blob_insert_cluster_msg(void *arg)
 	}
 
 	if (ctx->blob->use_extent_table == false) {
+		if (blob_insert_cluster_journal(ctx) == 0) {
+			return;
+		}
 		/* Extent table is not used, proceed with sync of md that will only use extents_rle. */
 		ctx->blob->state = SPDK_BLOB_STATE_DIRTY;
 		blob_sync_md(ctx->blob, blob_insert_cluster_msg_cb, ctx);
@@ -7471,6 +9206,15 @@ blob_insert_cluster_msg(void *arg)
 			bs_release_md_page(ctx->blob->bs, ctx->extent_page);
 			ctx->extent_page = 0;
 		}
+		if (!ctx->cow_map && blob_insert_cluster_journal(ctx) == 0) {
+			return;
+		}
+		if (sync_flags) {
+			/* Persist the flag before the extent page holding the first map */
+			ctx->blob->state = SPDK_BLOB_STATE_DIRTY;
+			blob_sync_md(ctx->blob, blob_insert_cluster_sync_flags_cb, ctx);
+			return;
+		}
 		/* Extent page already allocated.
 		 * Every cluster allocation, requires just an update of single extent page. */
 		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
@@ -7481,7 +9225,7 @@ blob_insert_cluster_msg(void *arg)
 static void
 blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
 				 uint64_t cluster, uint32_t extent_page, struct spdk_blob_md_page *page,
-				 spdk_blob_op_complete cb_fn, void *cb_arg)
+				 bool cow_map, spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_blob_insert_cluster_ctx *ctx;
 
@@ -7497,12 +9241,200 @@ blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
 	ctx->cluster = cluster;
 	ctx->extent_page = extent_page;
 	ctx->page = page;
+	ctx->cow_map = cow_map;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
 
 	spdk_thread_send_msg(blob->bs->md_thread, blob_insert_cluster_msg, ctx);
 }
 
+struct spdk_blob_cow_map_update_ctx {
+	struct spdk_thread		*thread;
+	struct spdk_blob		*blob;
+	struct spdk_blob_cow_map	*map;
+	uint32_t			cluster_num;
+	uint32_t			io_unit;	/* first io_unit in cluster written */
+	uint32_t			num_io_units;
+	struct spdk_blob_md_page	*page;	/* preallocated extent page */
+	int				rc;
+	spdk_blob_op_complete		cb_fn;
+	void				*cb_arg;
+	TAILQ_ENTRY(spdk_blob_cow_map_update_ctx) link;
+};
+
+static void
+blob_cow_map_msg_cpl(void *arg)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+
+	ctx->cb_fn(ctx->cb_arg, ctx->rc);
+	free(ctx);
+}
+
+static void
+blob_cow_map_msg_cb(void *arg, int bserrno)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+
+	ctx->rc = bserrno;
+	spdk_thread_send_msg(ctx->thread, blob_cow_map_msg_cpl, ctx);
+}
+
+static inline bool
+blob_cow_map_is_current(struct spdk_blob_cow_map_update_ctx *ctx)
+{
+	/* Map was retired, or moved to a snapshot along with the cluster */
+	return !ctx->map->retired && blob_get_cow_map(ctx->blob, ctx->cluster_num) == ctx->map;
+}
+
+static void
+blob_cow_map_update_msg(void *arg)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+	uint32_t *extent_page;
+	uint32_t i;
+
+	if (ctx->map->compacting) {
+		/* The io_units just written might get overwritten with the data copied
+		 * from the parent. Wait for the compaction to finish and let the op
+		 * write its data again. */
+		TAILQ_INSERT_TAIL(&ctx->map->waiters, ctx, link);
+		return;
+	}
+
+	if (!blob_cow_map_is_current(ctx)) {
+		blob_cow_map_msg_cb(ctx, -EAGAIN);
+		return;
+	}
+
+	for (i = ctx->io_unit; i < ctx->io_unit + ctx->num_io_units; i++) {
+		spdk_bit_array_set(ctx->map->io_units, i);
+	}
+
+	if (spdk_bit_array_count_clear(ctx->map->io_units) == 0) {
+		blob_retire_cow_map(ctx->blob, ctx->cluster_num);
+	}
+
+	extent_page = bs_cluster_to_extent_page(ctx->blob, ctx->cluster_num);
+	assert(*extent_page != 0);
+	blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
+			       blob_cow_map_msg_cb, ctx);
+}
+
+static void
+blob_cow_map_compact_start_msg(void *arg)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+
+	if (!blob_cow_map_is_current(ctx)) {
+		blob_cow_map_msg_cb(ctx, -EALREADY);
+		return;
+	}
+
+	if (ctx->map->compacting) {
+		blob_cow_map_msg_cb(ctx, -EBUSY);
+		return;
+	}
+
+	ctx->map->compacting = true;
+	blob_cow_map_msg_cb(ctx, 0);
+}
+
+static void
+blob_cow_map_compact_done(void *arg, int bserrno)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+	struct spdk_blob_cow_map_update_ctx *waiter;
+
+	ctx->map->compacting = false;
+
+	while (!TAILQ_EMPTY(&ctx->map->waiters)) {
+		waiter = TAILQ_FIRST(&ctx->map->waiters);
+		TAILQ_REMOVE(&ctx->map->waiters, waiter, link);
+		blob_cow_map_msg_cb(waiter, -EAGAIN);
+	}
+
+	blob_cow_map_msg_cb(ctx, bserrno);
+}
+
+static void
+blob_cow_map_compact_finish_msg(void *arg)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx = arg;
+	uint32_t *extent_page;
+	uint32_t i;
+
+	assert(ctx->map->compacting);
+
+	if (ctx->rc != 0 || !blob_cow_map_is_current(ctx)) {
+		blob_cow_map_compact_done(ctx, ctx->rc);
+		return;
+	}
+
+	for (i = 0; i < spdk_bit_array_capacity(ctx->map->io_units); i++) {
+		spdk_bit_array_set(ctx->map->io_units, i);
+	}
+	blob_retire_cow_map(ctx->blob, ctx->cluster_num);
+
+	extent_page = bs_cluster_to_extent_page(ctx->blob, ctx->cluster_num);
+	assert(*extent_page != 0);
+	blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
+			       blob_cow_map_compact_done, ctx);
+}
+
+static void
+blob_cow_map_send_msg(struct spdk_blob *blob, struct spdk_blob_cow_map *map, uint32_t cluster_num,
+		      uint32_t io_unit, uint32_t num_io_units, struct spdk_blob_md_page *page, int rc,
+		      spdk_msg_fn fn, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_blob_cow_map_update_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->thread = spdk_get_thread();
+	ctx->blob = blob;
+	ctx->map = map;
+	ctx->cluster_num = cluster_num;
+	ctx->io_unit = io_unit;
+	ctx->num_io_units = num_io_units;
+	ctx->page = page;
+	ctx->rc = rc;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_thread_send_msg(blob->bs->md_thread, fn, ctx);
+}
+
+static void
+blob_cow_map_update_on_md_thread(struct spdk_blob *blob, struct spdk_blob_cow_map *map,
+				 uint32_t cluster_num, uint32_t io_unit, uint32_t num_io_units,
+				 struct spdk_blob_md_page *page, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	blob_cow_map_send_msg(blob, map, cluster_num, io_unit, num_io_units, page, 0,
+			      blob_cow_map_update_msg, cb_fn, cb_arg);
+}
+
+static void
+blob_cow_map_compact_start_on_md_thread(struct spdk_blob *blob, struct spdk_blob_cow_map *map,
+					uint32_t cluster_num, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	blob_cow_map_send_msg(blob, map, cluster_num, 0, 0, NULL, 0,
+			      blob_cow_map_compact_start_msg, cb_fn, cb_arg);
+}
+
+static void
+blob_cow_map_compact_finish_on_md_thread(struct spdk_blob *blob, struct spdk_blob_cow_map *map,
+		uint32_t cluster_num, struct spdk_blob_md_page *page,
+		int bserrno, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	blob_cow_map_send_msg(blob, map, cluster_num, 0, 0, page, bserrno,
+			      blob_cow_map_compact_finish_msg, cb_fn, cb_arg);
+}
+
 /* START spdk_blob_close */
 
 static void
@@ -7555,6 +9487,11 @@ spdk_blob_close(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_ar
 		return;
 	}
 
+	if (blob->open_ref == 1 && blob->md_journal_dirty) {
+		/* Write back records from the journal before the blob goes away */
+		blob->state = SPDK_BLOB_STATE_DIRTY;
+	}
+
 	/* Sync metadata */
 	blob_persist(seq, blob, blob_close_cpl, blob);
 }
@@ -8089,12 +10026,18 @@ bs_load_grow_continue(struct spdk_bs_load_ctx *ctx)
 	ctx->bs->super_blob = ctx->super->super_blob;
 	memcpy(&ctx->bs->bstype, &ctx->super->bstype, sizeof(ctx->super->bstype));
 
+	rc = bs_load_md_journal_alloc(ctx);
+	if (rc < 0) {
+		bs_load_ctx_fail(ctx, rc);
+		return;
+	}
+
 	if (ctx->super->used_blobid_mask_len == 0 || ctx->super->clean == 0) {
 		SPDK_ERRLOG("Can not grow an unclean blobstore, please load it normally to clean it.\n");
 		bs_load_ctx_fail(ctx, -EIO);
 		return;
 	} else {
-		bs_load_read_used_pages(ctx);
+		bs_load_read_used_masks(ctx);
 	}
 }
 
@@ -8200,7 +10143,7 @@ bs_grow_load_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	uint32_t	crc;
 	static const char zeros[SPDK_BLOBSTORE_TYPE_LENGTH];
 
-	if (ctx->super->version > SPDK_BS_VERSION ||
+	if (ctx->super->version > SPDK_BS_MD_JOURNAL_VERSION ||
 	    ctx->super->version < SPDK_BS_INITIAL_VERSION) {
 		bs_load_ctx_fail(ctx, -EILSEQ);
 		return;
@@ -26,6 +26,17 @@
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
 
+/* Number of metadata reads kept in flight when replaying metadata during recovery. */
+#define SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH 16
+/* Number of metadata pages read at once when scanning the metadata region during recovery. */
+#define SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES 32
+/* Maximum number of metadata journal pages written at once. */
+#define SPDK_BLOB_MD_JOURNAL_BATCH_PAGES 8
+/* Maximum number of records appended to the metadata journal, but not written yet. */
+#define SPDK_BLOB_MD_JOURNAL_MAX_PENDING_RECORDS (2 * SPDK_BLOB_MD_JOURNAL_BATCH_PAGES * \
+		(SPDK_SIZEOF_MEMBER(struct spdk_bs_md_journal_page, records) / \
+		 sizeof(struct spdk_bs_md_journal_record_cluster)))
+
 struct spdk_xattr {
 	uint32_t	index;
 	uint16_t	value_len;
@@ -90,6 +101,25 @@ enum spdk_blob_state {
 
 TAILQ_HEAD(spdk_xattr_tailq, spdk_xattr);
 
+/* Copy-on-write map of a partially populated cluster of a thin clone.
+ * A set bit means the io_unit was written to the blob, a clear bit means it
+ * still has to be read from the backing device.
+ */
+struct spdk_blob_cow_map {
+	struct spdk_bit_array		*io_units;
+
+	/* Missing io_units are being copied from the backing device */
+	bool				compacting;
+
+	/* The cluster was filled in and the map is no longer in use */
+	bool				retired;
+
+	/* Map updates waiting for the compaction to finish */
+	TAILQ_HEAD(, spdk_blob_cow_map_update_ctx) waiters;
+
+	TAILQ_ENTRY(spdk_blob_cow_map)	link;
+};
+
 struct spdk_blob_list {
 	spdk_blob_id id;
 	size_t clone_count;
@@ -147,6 +177,69 @@ struct spdk_blob {
 	/* Number of data clusters retrieved from extent table,
 	 * that many have to be read from extent pages. */
 	uint64_t	remaining_clusters_in_et;
+
+	/* Copy-on-write maps of partially populated clusters, indexed
+	 * by cluster number. NULL entries are fully populated or
+	 * unallocated clusters. Allocated on first use. */
+	struct spdk_blob_cow_map	**cow_maps;
+	size_t				cow_map_array_size;
+
+	/* Maps that are no longer used, but can still be referenced
+	 * by in flight I/O. Released when the blob is freed. */
+	TAILQ_HEAD(, spdk_blob_cow_map) retired_cow_maps;
+
+	/* Last metadata journal record reflected in the on-disk metadata */
+	uint64_t	md_journal_seq;
+	/* Last metadata journal record of this blob */
+	uint64_t	md_journal_last_seq;
+	/* Extent pages updated only in the metadata journal */
+	struct spdk_bit_array		*md_journal_eps;
+	/* The blob has journal records not yet written back to its metadata */
+	bool				md_journal_dirty;
+	TAILQ_ENTRY(spdk_blob)		md_journal_link;
+};
+
+struct spdk_bs_md_journal_req {
+	spdk_blob_op_complete			cb_fn;
+	void					*cb_arg;
+	TAILQ_ENTRY(spdk_bs_md_journal_req)	link;
+};
+
+/* Journal pages written at once to a contiguous range of journal slots */
+struct spdk_bs_md_journal_batch {
+	struct spdk_bs_md_journal_page		*pages;
+	uint32_t				slot; /* Slot of the first page */
+	uint32_t				num_pages;
+
+	/* Requests completed once the batch is written */
+	TAILQ_HEAD(, spdk_bs_md_journal_req)	reqs;
+};
+
+/* Ring of journal pages between the used_blobid mask and the metadata region.
+ * Records of the slots from the tail up to the head are not reflected in blob
+ * metadata yet. Slots are released once the blobs are checkpointed.
+ */
+struct spdk_bs_md_journal {
+	struct spdk_blob_store			*bs;
+
+	uint32_t				start; /* Offset from beginning of disk, in pages */
+	uint32_t				len; /* Count, in pages */
+	uint32_t				head; /* Next slot to write */
+	uint32_t				used; /* Slots not released yet */
+
+	/* Sequence number of the last record in each slot */
+	uint64_t				*slot_seq;
+	uint64_t				next_seq;
+
+	struct spdk_bs_md_journal_batch		batches[2];
+	struct spdk_bs_md_journal_batch		*open;
+	struct spdk_bs_md_journal_batch		*writing;
+	bool					flush_scheduled;
+
+	/* Blobs with records not reflected in their metadata */
+	TAILQ_HEAD(, spdk_blob)			dirty_blobs;
+	bool					checkpointing;
+	uint64_t				checkpoint_seq;
 };
 
 struct spdk_blob_store {
@@ -175,6 +268,12 @@ struct spdk_blob_store {
 	uint8_t				pages_per_cluster_shift;
 	uint32_t			io_unit_size;
 
+	/* Allocate clusters of thin clones without a full copy from the parent */
+	bool				sub_cluster_cow;
+
+	/* Journal of cluster allocations, NULL if not enabled */
+	struct spdk_bs_md_journal	*md_journal;
+
 	spdk_blob_id			super_blob;
 	struct spdk_bs_type		bstype;
 
@@ -198,7 +297,9 @@ struct spdk_bs_channel {
 
 	/* This page is only used during insert of a new cluster. */
 	struct spdk_blob_md_page	*new_cluster_page;
+	bool				new_cluster_page_used;
 
+	/* User ops waiting for the allocation or map update of the cluster they target */
 	TAILQ_HEAD(, spdk_bs_request_set) need_cluster_alloc;
 	TAILQ_HEAD(, spdk_bs_request_set) queued_io;
 };
@@ -230,6 +331,7 @@ struct spdk_blob_bs_dev {
  */
 #define SPDK_BS_INITIAL_VERSION 1
 #define SPDK_BS_VERSION 3 /* current version */
+#define SPDK_BS_MD_JOURNAL_VERSION 4 /* version with metadata journal */
 
 #pragma pack(push, 1)
 
@@ -267,6 +369,14 @@ struct spdk_bs_md_mask {
  * with 0's being unallocated clusters. It is NOT part of
  * serialized metadata chain for a blob. */
 #define SPDK_MD_DESCRIPTOR_TYPE_EXTENT_PAGE 6
+/* COW_MAP descriptor holds a bitmap of io_units written to
+ * a partially populated cluster of a thin clone. It follows the
+ * EXTENT_PAGE descriptor in the extent page containing the cluster. */
+#define SPDK_MD_DESCRIPTOR_TYPE_COW_MAP 7
+/* MD_JOURNAL descriptor holds the sequence number of the last metadata
+ * journal record reflected in the blob metadata. Records with higher
+ * sequence numbers are applied to the blob during load. */
+#define SPDK_MD_DESCRIPTOR_TYPE_MD_JOURNAL 8
 
 struct spdk_blob_md_descriptor_xattr {
 	uint8_t		type;
@@ -312,10 +422,30 @@ struct spdk_blob_md_descriptor_extent_page {
 	uint32_t	cluster_idx[0];
 };
 
+struct spdk_blob_md_descriptor_cow_map {
+	uint8_t		type;
+	uint32_t	length;
+
+	/* Cluster index in the blob */
+	uint32_t	cluster_idx;
+
+	/* One bit per io_unit in the cluster */
+	uint8_t		io_unit_mask[0];
+};
+
+struct spdk_blob_md_descriptor_md_journal {
+	uint8_t		type;
+	uint32_t	length;
+
+	uint64_t	seq;
+};
+
 #define SPDK_BLOB_THIN_PROV (1ULL << 0)
 #define SPDK_BLOB_INTERNAL_XATTR (1ULL << 1)
 #define SPDK_BLOB_EXTENT_TABLE (1ULL << 2)
-#define SPDK_BLOB_INVALID_FLAGS_MASK	(SPDK_BLOB_THIN_PROV | SPDK_BLOB_INTERNAL_XATTR | SPDK_BLOB_EXTENT_TABLE)
+#define SPDK_BLOB_COW_MAP (1ULL << 3)
+#define SPDK_BLOB_INVALID_FLAGS_MASK	(SPDK_BLOB_THIN_PROV | SPDK_BLOB_INTERNAL_XATTR | SPDK_BLOB_EXTENT_TABLE | \
+					 SPDK_BLOB_COW_MAP)
 
 #define SPDK_BLOB_READ_ONLY (1ULL << 0)
 #define SPDK_BLOB_DATA_RO_FLAGS_MASK	SPDK_BLOB_READ_ONLY
@@ -404,11 +534,44 @@ struct spdk_bs_super_block {
 	uint64_t	size; /* size of blobstore in bytes */
 	uint32_t	io_unit_size; /* Size of io unit in bytes */
 
-	uint8_t		reserved[4000];
+	uint32_t	md_journal_start; /* Offset from beginning of disk, in pages */
+	uint32_t	md_journal_len; /* Count, in pages */
+	uint64_t	md_journal_seq; /* Last journal record reflected in blob metadata */
+	uint64_t	md_journal_next_seq; /* Lower bound of the next journal record */
+
+	uint8_t		reserved[3976];
 	uint32_t	crc;
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_super_block) == 0x1000, "Invalid super block size");
 
+#define SPDK_MD_JOURNAL_RECORD_CLUSTER 1
+
+struct spdk_bs_md_journal_record {
+	uint8_t		type;
+	uint16_t	length;
+	uint64_t	seq;
+	spdk_blob_id	blobid;
+};
+
+/* Cluster allocated to a thin provisioned blob */
+struct spdk_bs_md_journal_record_cluster {
+	struct spdk_bs_md_journal_record	hdr;
+
+	uint32_t	cluster_num; /* Cluster index in the blob */
+	uint32_t	cluster_idx; /* Cluster index on disk */
+};
+
+struct spdk_bs_md_journal_page {
+	uint64_t	seq; /* Sequence number of the first record, 0 for unused page */
+	uint32_t	length; /* Bytes of records */
+
+	uint8_t		records[4080];
+
+	uint32_t	crc;
+};
+SPDK_STATIC_ASSERT(SPDK_BS_PAGE_SIZE == sizeof(struct spdk_bs_md_journal_page),
+		   "Invalid md journal page size");
+
 #pragma pack(pop)
 
 struct spdk_bs_dev *bs_create_zeroes_dev(void);
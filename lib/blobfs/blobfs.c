@@ -31,7 +31,6 @@
 
 static uint64_t g_fs_cache_size = BLOBFS_DEFAULT_CACHE_SIZE;
 static struct spdk_mempool *g_cache_pool;
-static TAILQ_HEAD(, spdk_file) g_caches = TAILQ_HEAD_INITIALIZER(g_caches);
 static struct spdk_poller *g_cache_pool_mgmt_poller;
 static struct spdk_thread *g_cache_pool_thread;
 #define BLOBFS_CACHE_POOL_POLL_PERIOD_IN_US 1000ULL
@@ -76,15 +75,251 @@ SPDK_TRACE_REGISTER_FN(blobfs_trace, "blobfs", TRACE_GROUP_BLOBFS)
 	spdk_trace_register_description_ext(opts, SPDK_COUNTOF(opts));
 }
 
+#define CACHE_READAHEAD_THRESHOLD	(128 * 1024)
+#define CACHE_READAHEAD_MIN_BUFFERS	2
+#define CACHE_READAHEAD_MAX_BUFFERS	16
+#define CACHE_RECLAIM_BATCH		64
+#define CACHE_EVICT_SCAN_LIMIT		32
+
+/*
+ * Cache buffers of all files are managed by a single ARC (Adaptive Replacement
+ *  Cache).  Buffers accessed once since they were cached are kept on the recent
+ *  list, buffers accessed again are moved to the frequent list.  Evicted buffers
+ *  leave a ghost entry behind, and a later miss on a ghost grows the target size
+ *  of the list it was evicted from.  The lists are protected by g_cache_lock,
+ *  which must be taken after the file lock.
+ */
+enum cache_list {
+	CACHE_LIST_NONE = 0,
+	CACHE_LIST_RECENT,
+	CACHE_LIST_FREQUENT,
+};
+
+struct cache_ghost {
+	spdk_blob_id			blobid;
+	uint64_t			offset;
+	enum cache_list			list;
+	TAILQ_ENTRY(cache_ghost)	tailq;
+	LIST_ENTRY(cache_ghost)		hash_link;
+};
+
+/* Buffer missed once by a random read, hashed like the ghost entries */
+struct cache_miss_entry {
+	spdk_blob_id			blobid;
+	uint64_t			offset;
+};
+
+struct blobfs_cache {
+	/* Cached buffers in LRU order, the least recently used one first */
+	TAILQ_HEAD(, cache_buffer)	recent;
+	TAILQ_HEAD(, cache_buffer)	frequent;
+	uint64_t			num_recent;
+	uint64_t			num_frequent;
+
+	/* Ghost entries of buffers evicted from the recent and frequent lists */
+	TAILQ_HEAD(, cache_ghost)	recent_ghosts;
+	TAILQ_HEAD(, cache_ghost)	frequent_ghosts;
+	TAILQ_HEAD(, cache_ghost)	free_ghosts;
+	uint64_t			num_recent_ghosts;
+	uint64_t			num_frequent_ghosts;
+	struct cache_ghost		*ghosts;
+	LIST_HEAD(, cache_ghost)	*ghost_hash;
+	uint64_t			ghost_hash_mask;
+
+	/* Buffers missed once, a second miss admits the buffer into the cache */
+	struct cache_miss_entry		*missed;
+
+	/* Adaptive target size of the recent list */
+	uint64_t			target_recent;
+	uint64_t			num_buffers;
+
+	struct spdk_fs_cache_stats	stats;
+};
+
+static struct blobfs_cache g_cache;
+static pthread_mutex_t g_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+cache_init(uint64_t num_buffers)
+{
+	uint64_t i, hash_size;
+
+	memset(&g_cache, 0, sizeof(g_cache));
+	TAILQ_INIT(&g_cache.recent);
+	TAILQ_INIT(&g_cache.frequent);
+	TAILQ_INIT(&g_cache.recent_ghosts);
+	TAILQ_INIT(&g_cache.frequent_ghosts);
+	TAILQ_INIT(&g_cache.free_ghosts);
+	g_cache.num_buffers = num_buffers;
+
+	hash_size = spdk_align64pow2(spdk_max(num_buffers, 2));
+	g_cache.ghosts = calloc(num_buffers, sizeof(*g_cache.ghosts));
+	g_cache.ghost_hash = calloc(hash_size, sizeof(*g_cache.ghost_hash));
+	g_cache.missed = calloc(hash_size, sizeof(*g_cache.missed));
+	if (g_cache.ghosts == NULL || g_cache.ghost_hash == NULL || g_cache.missed == NULL) {
+		free(g_cache.ghosts);
+		free(g_cache.ghost_hash);
+		free(g_cache.missed);
+		g_cache.ghosts = NULL;
+		g_cache.ghost_hash = NULL;
+		g_cache.missed = NULL;
+		return -ENOMEM;
+	}
+
+	g_cache.ghost_hash_mask = hash_size - 1;
+	for (i = 0; i < num_buffers; i++) {
+		TAILQ_INSERT_TAIL(&g_cache.free_ghosts, &g_cache.ghosts[i], tailq);
+	}
+	for (i = 0; i < hash_size; i++) {
+		g_cache.missed[i].blobid = SPDK_BLOBID_INVALID;
+	}
+
+	return 0;
+}
+
+static void
+cache_fini(void)
+{
+	assert(TAILQ_EMPTY(&g_cache.recent));
+	assert(TAILQ_EMPTY(&g_cache.frequent));
+
+	free(g_cache.ghosts);
+	free(g_cache.ghost_hash);
+	free(g_cache.missed);
+	memset(&g_cache, 0, sizeof(g_cache));
+}
+
+static void
+cache_list_insert(struct cache_buffer *buf, enum cache_list list, bool lru)
+{
+	assert(buf->list == CACHE_LIST_NONE);
+
+	buf->list = list;
+	if (list == CACHE_LIST_RECENT) {
+		if (lru) {
+			TAILQ_INSERT_HEAD(&g_cache.recent, buf, tailq);
+		} else {
+			TAILQ_INSERT_TAIL(&g_cache.recent, buf, tailq);
+		}
+		g_cache.num_recent++;
+	} else {
+		assert(list == CACHE_LIST_FREQUENT);
+		if (lru) {
+			TAILQ_INSERT_HEAD(&g_cache.frequent, buf, tailq);
+		} else {
+			TAILQ_INSERT_TAIL(&g_cache.frequent, buf, tailq);
+		}
+		g_cache.num_frequent++;
+	}
+}
+
+static void
+cache_list_remove(struct cache_buffer *buf)
+{
+	if (buf->list == CACHE_LIST_RECENT) {
+		TAILQ_REMOVE(&g_cache.recent, buf, tailq);
+		g_cache.num_recent--;
+	} else {
+		assert(buf->list == CACHE_LIST_FREQUENT);
+		TAILQ_REMOVE(&g_cache.frequent, buf, tailq);
+		g_cache.num_frequent--;
+	}
+	buf->list = CACHE_LIST_NONE;
+}
+
+static uint64_t
+cache_ghost_hash(spdk_blob_id blobid, uint64_t offset)
+{
+	return ((offset >> CACHE_BUFFER_SHIFT) + blobid * 0x9E3779B97F4A7C15ULL) &
+	       g_cache.ghost_hash_mask;
+}
+
+static struct cache_ghost *
+cache_ghost_find(spdk_blob_id blobid, uint64_t offset)
+{
+	struct cache_ghost *ghost;
+
+	if (g_cache.ghost_hash == NULL) {
+		return NULL;
+	}
+
+	LIST_FOREACH(ghost, &g_cache.ghost_hash[cache_ghost_hash(blobid, offset)], hash_link) {
+		if (ghost->blobid == blobid && ghost->offset == offset) {
+			return ghost;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+cache_ghost_remove(struct cache_ghost *ghost)
+{
+	if (ghost->list == CACHE_LIST_RECENT) {
+		TAILQ_REMOVE(&g_cache.recent_ghosts, ghost, tailq);
+		g_cache.num_recent_ghosts--;
+	} else {
+		assert(ghost->list == CACHE_LIST_FREQUENT);
+		TAILQ_REMOVE(&g_cache.frequent_ghosts, ghost, tailq);
+		g_cache.num_frequent_ghosts--;
+	}
+
+	LIST_REMOVE(ghost, hash_link);
+	ghost->list = CACHE_LIST_NONE;
+	TAILQ_INSERT_TAIL(&g_cache.free_ghosts, ghost, tailq);
+}
+
+static void
+cache_ghost_add(spdk_blob_id blobid, uint64_t offset, enum cache_list list)
+{
+	struct cache_ghost *ghost;
+
+	if (TAILQ_EMPTY(&g_cache.free_ghosts)) {
+		/* Recycle the oldest entry of the longer ghost list */
+		if (g_cache.num_recent_ghosts >= g_cache.num_frequent_ghosts) {
+			ghost = TAILQ_FIRST(&g_cache.recent_ghosts);
+		} else {
+			ghost = TAILQ_FIRST(&g_cache.frequent_ghosts);
+		}
+		if (ghost == NULL) {
+			return;
+		}
+		cache_ghost_remove(ghost);
+	}
+
+	ghost = TAILQ_FIRST(&g_cache.free_ghosts);
+	TAILQ_REMOVE(&g_cache.free_ghosts, ghost, tailq);
+
+	ghost->blobid = blobid;
+	ghost->offset = offset;
+	ghost->list = list;
+	if (list == CACHE_LIST_RECENT) {
+		TAILQ_INSERT_TAIL(&g_cache.recent_ghosts, ghost, tailq);
+		g_cache.num_recent_ghosts++;
+	} else {
+		TAILQ_INSERT_TAIL(&g_cache.frequent_ghosts, ghost, tailq);
+		g_cache.num_frequent_ghosts++;
+	}
+	LIST_INSERT_HEAD(&g_cache.ghost_hash[cache_ghost_hash(blobid, offset)], ghost, hash_link);
+}
+
 void
 cache_buffer_free(struct cache_buffer *cache_buffer)
 {
+	/* Buffers are unlinked by the eviction path before being freed, and the
+	 *  list of a buffer can only change under the lock of its file, which the
+	 *  caller holds.
+	 */
+	if (cache_buffer->list != CACHE_LIST_NONE) {
+		pthread_mutex_lock(&g_cache_lock);
+		cache_list_remove(cache_buffer);
+		pthread_mutex_unlock(&g_cache_lock);
+	}
+
 	spdk_mempool_put(g_cache_pool, cache_buffer->buf);
 	free(cache_buffer);
 }
 
-#define CACHE_READAHEAD_THRESHOLD	(128 * 1024)
-
 struct spdk_file {
 	struct spdk_filesystem	*fs;
 	struct spdk_blob	*blob;
@@ -97,6 +332,8 @@ struct spdk_file {
 	uint64_t		append_pos;
 	uint64_t		seq_byte_count;
 	uint64_t		next_seq_offset;
+	/* number of cache buffers to read ahead of a sequential reader */
+	uint32_t		ra_window;
 	uint32_t		priority;
 	TAILQ_ENTRY(spdk_file)	tailq;
 	spdk_blob_id		blobid;
@@ -106,7 +343,6 @@ struct spdk_file {
 	struct cache_tree	*tree;
 	TAILQ_HEAD(open_requests_head, spdk_fs_request) open_requests;
 	TAILQ_HEAD(sync_requests_head, spdk_fs_request) sync_requests;
-	TAILQ_ENTRY(spdk_file)	cache_tailq;
 };
 
 struct spdk_deleted_file {
@@ -262,6 +498,11 @@ __start_cache_pool_mgmt(void *ctx)
 		assert(false);
 	}
 
+	if (cache_init(g_fs_cache_size / CACHE_BUFFER_SIZE) != 0) {
+		SPDK_ERRLOG("Could not allocate cache ghost entries, evicted buffers "
+			    "will not be tracked\n");
+	}
+
 	assert(g_cache_pool_mgmt_poller == NULL);
 	g_cache_pool_mgmt_poller = SPDK_POLLER_REGISTER(_blobfs_cache_pool_reclaim, NULL,
 				   BLOBFS_CACHE_POOL_POLL_PERIOD_IN_US);
@@ -277,6 +518,10 @@ __stop_cache_pool_mgmt(void *ctx)
 	spdk_mempool_free(g_cache_pool);
 	g_cache_pool = NULL;
 
+	pthread_mutex_lock(&g_cache_lock);
+	cache_fini();
+	pthread_mutex_unlock(&g_cache_lock);
+
 	spdk_thread_exit(g_cache_pool_thread);
 }
 
@@ -1176,7 +1421,9 @@ fs_open_blob_create_cb(void *ctx, int bserrno)
 		args->file = file;
 	}
 
+	pthread_spin_lock(&file->lock);
 	file->ref_count++;
+	pthread_spin_unlock(&file->lock);
 	TAILQ_INSERT_TAIL(&file->open_requests, req, args.op.open.tailq);
 	if (file->ref_count == 1) {
 		assert(file->blob == NULL);
@@ -1980,112 +2227,206 @@ spdk_fs_get_cache_size(void)
 
 static void __file_flush(void *ctx);
 
-/* Try to free some cache buffers from this file.
- */
-static int
-reclaim_cache_buffers(struct spdk_file *file)
+static bool
+cache_buffer_evictable(struct spdk_file *file, struct cache_buffer *buf)
 {
-	int rc;
+	return !buf->in_progress && buf->bytes_filled == buf->bytes_flushed && buf != file->last;
+}
 
-	BLOBFS_TRACE(file, "free=%s\n", file->name);
+/* Must be called with g_cache_lock held. */
+static bool
+cache_evict_from_list(enum cache_list list)
+{
+	struct cache_buffer *buf, *tmp;
+	struct spdk_file *file;
+	uint32_t scanned = 0;
 
-	/* The function is safe to be called with any threads, while the file
-	 * lock maybe locked by other thread for now, so try to get the file
-	 * lock here.
-	 */
-	rc = pthread_spin_trylock(&file->lock);
-	if (rc != 0) {
-		return -1;
-	}
+	buf = list == CACHE_LIST_RECENT ? TAILQ_FIRST(&g_cache.recent) : TAILQ_FIRST(&g_cache.frequent);
+	for (; buf != NULL && scanned < CACHE_EVICT_SCAN_LIMIT; buf = tmp, scanned++) {
+		tmp = TAILQ_NEXT(buf, tailq);
+		file = buf->file;
+
+		/* Readers take the file lock before g_cache_lock, so only try to get it
+		 *  here and skip the buffer if the file is busy.
+		 */
+		if (pthread_spin_trylock(&file->lock) != 0) {
+			continue;
+		}
 
-	if (file->tree->present_mask == 0) {
+		if (!cache_buffer_evictable(file, buf)) {
+			pthread_spin_unlock(&file->lock);
+			continue;
+		}
+
+		cache_list_remove(buf);
+		if (!buf->scanned) {
+			cache_ghost_add(file->blobid, buf->offset, list);
+		}
+		if (buf->readahead) {
+			/* Nobody read this buffer, so the file reads ahead too far. */
+			g_cache.stats.readahead_unused++;
+			if (file->ra_window > CACHE_READAHEAD_MIN_BUFFERS) {
+				file->ra_window /= 2;
+			}
+		}
+		g_cache.stats.evictions++;
+
+		BLOBFS_TRACE(file, "evict offset=%jx\n", buf->offset);
+		tree_remove_buffer(file->tree, buf);
 		pthread_spin_unlock(&file->lock);
-		return -1;
+
+		return true;
 	}
-	tree_free_buffers(file->tree);
 
-	TAILQ_REMOVE(&g_caches, file, cache_tailq);
-	/* If not freed, put it in the end of the queue */
-	if (file->tree->present_mask != 0) {
-		TAILQ_INSERT_TAIL(&g_caches, file, cache_tailq);
-	} else {
-		file->last = NULL;
+	return false;
+}
+
+/* Must be called with g_cache_lock held. */
+static bool
+cache_evict_buffer(void)
+{
+	if (g_cache.num_recent > 0 &&
+	    (g_cache.num_recent > g_cache.target_recent || g_cache.num_frequent == 0)) {
+		return cache_evict_from_list(CACHE_LIST_RECENT) ||
+		       cache_evict_from_list(CACHE_LIST_FREQUENT);
 	}
-	pthread_spin_unlock(&file->lock);
 
-	return 0;
+	return cache_evict_from_list(CACHE_LIST_FREQUENT) ||
+	       cache_evict_from_list(CACHE_LIST_RECENT);
 }
 
 static int
 _blobfs_cache_pool_reclaim(void *arg)
 {
-	struct spdk_file *file, *tmp;
-	int rc;
+	uint32_t count = 0;
 
 	if (!blobfs_cache_pool_need_reclaim()) {
 		return SPDK_POLLER_IDLE;
 	}
 
-	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
-		if (!file->open_for_writing &&
-		    file->priority == SPDK_FILE_PRIORITY_LOW) {
-			rc = reclaim_cache_buffers(file);
-			if (rc < 0) {
-				continue;
-			}
-			if (!blobfs_cache_pool_need_reclaim()) {
-				return SPDK_POLLER_BUSY;
-			}
+	pthread_mutex_lock(&g_cache_lock);
+	while (count < CACHE_RECLAIM_BATCH && blobfs_cache_pool_need_reclaim()) {
+		if (!cache_evict_buffer()) {
 			break;
 		}
+		count++;
 	}
+	pthread_mutex_unlock(&g_cache_lock);
 
-	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
-		if (!file->open_for_writing) {
-			rc = reclaim_cache_buffers(file);
-			if (rc < 0) {
-				continue;
-			}
-			if (!blobfs_cache_pool_need_reclaim()) {
-				return SPDK_POLLER_BUSY;
-			}
-			break;
-		}
-	}
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
 
-	TAILQ_FOREACH_SAFE(file, &g_caches, cache_tailq, tmp) {
-		rc = reclaim_cache_buffers(file);
-		if (rc < 0) {
-			continue;
+/* Link a newly cached buffer into the replacement lists. */
+static void
+cache_buffer_admit(struct spdk_file *file, struct cache_buffer *buf)
+{
+	struct cache_ghost *ghost;
+	enum cache_list list = CACHE_LIST_RECENT;
+	uint64_t delta;
+
+	pthread_mutex_lock(&g_cache_lock);
+	ghost = cache_ghost_find(file->blobid, buf->offset);
+	if (ghost != NULL) {
+		/* The buffer was evicted too early, so grow the target size of the
+		 *  list it was evicted from.  Either way it has been accessed again,
+		 *  so it goes to the frequent list.
+		 */
+		if (ghost->list == CACHE_LIST_RECENT) {
+			delta = spdk_max(g_cache.num_frequent_ghosts / g_cache.num_recent_ghosts, 1);
+			g_cache.target_recent = spdk_min(g_cache.target_recent + delta, g_cache.num_buffers);
+			g_cache.stats.recent_ghost_hits++;
+		} else {
+			delta = spdk_max(g_cache.num_recent_ghosts / g_cache.num_frequent_ghosts, 1);
+			g_cache.target_recent -= spdk_min(delta, g_cache.target_recent);
+			g_cache.stats.frequent_ghost_hits++;
 		}
-		break;
+		cache_ghost_remove(ghost);
+		list = CACHE_LIST_FREQUENT;
+	} else if (file->priority == SPDK_FILE_PRIORITY_HIGH) {
+		list = CACHE_LIST_FREQUENT;
 	}
 
-	return SPDK_POLLER_BUSY;
+	cache_list_insert(buf, list, false);
+	pthread_mutex_unlock(&g_cache_lock);
 }
 
+/* Account a read served from a cached buffer. */
 static void
-_add_file_to_cache_pool(void *ctx)
+cache_buffer_touch(struct cache_buffer *buf, bool sequential)
 {
-	struct spdk_file *file = ctx;
+	pthread_mutex_lock(&g_cache_lock);
+	g_cache.stats.hits++;
+
+	if (buf->list == CACHE_LIST_RECENT && sequential) {
+		/* A sequential reader is unlikely to come back to this data soon, so
+		 *  make it the first candidate for eviction.  This keeps large scans,
+		 *  like compaction, from flushing the rest of the cache.
+		 */
+		cache_list_remove(buf);
+		cache_list_insert(buf, CACHE_LIST_RECENT, true);
+		buf->scanned = true;
+	} else if (buf->list == CACHE_LIST_RECENT && buf->readahead) {
+		/* First access of a prefetched buffer */
+		cache_list_remove(buf);
+		cache_list_insert(buf, CACHE_LIST_RECENT, false);
+	} else if (!sequential) {
+		cache_list_remove(buf);
+		cache_list_insert(buf, CACHE_LIST_FREQUENT, false);
+		buf->scanned = false;
+	}
 
-	TAILQ_INSERT_TAIL(&g_caches, file, cache_tailq);
+	buf->readahead = false;
+	pthread_mutex_unlock(&g_cache_lock);
 }
 
-static void
-_remove_file_from_cache_pool(void *ctx)
+/*
+ * Account a read which missed the cache buffer at the given buffer aligned offset
+ *  and return whether the buffer should be filled.  Filling reads the whole
+ *  buffer, so it's only worth it for data that was cached before (a ghost hit) or
+ *  that is missed for the second time.  Otherwise only the requested range is read.
+ */
+static bool
+cache_miss(struct spdk_file *file, uint64_t offset)
 {
-	struct spdk_file *file = ctx;
+	struct cache_miss_entry *entry;
+	bool fill = true;
+
+	pthread_mutex_lock(&g_cache_lock);
+	g_cache.stats.misses++;
 
-	TAILQ_REMOVE(&g_caches, file, cache_tailq);
+	/* Without the tracking tables every miss fills the buffer */
+	if (g_cache.missed != NULL && cache_ghost_find(file->blobid, offset) == NULL) {
+		entry = &g_cache.missed[cache_ghost_hash(file->blobid, offset)];
+		if (entry->blobid == file->blobid && entry->offset == offset) {
+			entry->blobid = SPDK_BLOBID_INVALID;
+		} else {
+			entry->blobid = file->blobid;
+			entry->offset = offset;
+			fill = false;
+		}
+	}
+	pthread_mutex_unlock(&g_cache_lock);
+
+	return fill;
+}
+
+void
+spdk_fs_get_cache_stats(struct spdk_fs_cache_stats *stats)
+{
+	pthread_mutex_lock(&g_cache_lock);
+	*stats = g_cache.stats;
+	stats->recent_buffers = g_cache.num_recent;
+	stats->frequent_buffers = g_cache.num_frequent;
+	stats->target_recent_buffers = g_cache.target_recent;
+	stats->total_buffers = g_cache.num_buffers;
+	pthread_mutex_unlock(&g_cache_lock);
 }
 
 static struct cache_buffer *
-cache_insert_buffer(struct spdk_file *file, uint64_t offset)
+cache_insert_buffer(struct spdk_file *file, uint64_t offset, bool wait)
 {
 	struct cache_buffer *buf;
 	int count = 0;
-	bool need_update = false;
 
 	buf = calloc(1, sizeof(*buf));
 	if (buf == NULL) {
@@ -2098,6 +2439,10 @@ cache_insert_buffer(struct spdk_file *file, uint64_t offset)
 		if (buf->buf) {
 			break;
 		}
+		if (!wait) {
+			free(buf);
+			return NULL;
+		}
 		if (count++ == 100) {
 			SPDK_ERRLOG("Could not allocate cache buffer for file=%p on offset=%jx\n",
 				    file, offset);
@@ -2109,15 +2454,10 @@ cache_insert_buffer(struct spdk_file *file, uint64_t offset)
 
 	buf->buf_size = CACHE_BUFFER_SIZE;
 	buf->offset = offset;
+	buf->file = file;
 
-	if (file->tree->present_mask == 0) {
-		need_update = true;
-	}
 	file->tree = tree_insert_buffer(file->tree, buf);
-
-	if (need_update) {
-		spdk_thread_send_msg(g_cache_pool_thread, _add_file_to_cache_pool, file);
-	}
+	cache_buffer_admit(file, buf);
 
 	return buf;
 }
@@ -2130,7 +2470,7 @@ cache_append_buffer(struct spdk_file *file)
 	assert(file->last == NULL || file->last->bytes_filled == file->last->buf_size);
 	assert((file->append_pos % CACHE_BUFFER_SIZE) == 0);
 
-	last = cache_insert_buffer(file, file->append_pos);
+	last = cache_insert_buffer(file, file->append_pos, true);
 	if (last == NULL) {
 		SPDK_DEBUGLOG(blobfs, "cache_insert_buffer failed\n");
 		return NULL;
@@ -2500,6 +2840,13 @@ spdk_file_write(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 	return 0;
 }
 
+static void __file_close_async(struct spdk_file *file, struct spdk_fs_request *req);
+
+static void
+__readahead_put_file_done(void *ctx, int fserrno)
+{
+}
+
 static void
 __readahead_done(void *ctx, int bserrno)
 {
@@ -2511,12 +2858,19 @@ __readahead_done(void *ctx, int bserrno)
 	BLOBFS_TRACE(file, "offset=%jx\n", cache_buffer->offset);
 
 	pthread_spin_lock(&file->lock);
-	cache_buffer->bytes_filled = args->op.readahead.length;
-	cache_buffer->bytes_flushed = args->op.readahead.length;
 	cache_buffer->in_progress = false;
+	if (bserrno == 0) {
+		cache_buffer->bytes_filled = args->op.readahead.length;
+		cache_buffer->bytes_flushed = args->op.readahead.length;
+	} else {
+		tree_remove_buffer(file->tree, cache_buffer);
+	}
 	pthread_spin_unlock(&file->lock);
 
-	free_fs_request(req);
+	/* Drop the reference taken by cache_fill_buffer(), the last one closes the file */
+	args->fn.file_op = __readahead_put_file_done;
+	args->arg = NULL;
+	__file_close_async(file, req);
 }
 
 static void
@@ -2547,14 +2901,14 @@ __next_cache_buffer_offset(uint64_t offset)
 	return (offset + CACHE_BUFFER_SIZE) & ~(CACHE_TREE_LEVEL_MASK(0));
 }
 
+/* Fill the cache buffer at the given buffer aligned offset in the background. */
 static void
-check_readahead(struct spdk_file *file, uint64_t offset,
-		struct spdk_fs_channel *channel)
+cache_fill_buffer(struct spdk_file *file, uint64_t offset, bool readahead,
+		  struct spdk_fs_channel *channel)
 {
 	struct spdk_fs_request *req;
 	struct spdk_fs_cb_args *args;
 
-	offset = __next_cache_buffer_offset(offset);
 	if (tree_find_buffer(file->tree, offset) != NULL || file->length <= offset) {
 		return;
 	}
@@ -2569,14 +2923,25 @@ check_readahead(struct spdk_file *file, uint64_t offset,
 
 	args->file = file;
 	args->op.readahead.offset = offset;
-	args->op.readahead.cache_buffer = cache_insert_buffer(file, offset);
+	args->op.readahead.cache_buffer = cache_insert_buffer(file, offset, false);
 	if (!args->op.readahead.cache_buffer) {
 		BLOBFS_TRACE(file, "Cannot allocate buf for offset=%jx\n", offset);
 		free_fs_request(req);
 		return;
 	}
 
+	/* The buffer points to the file, so keep the file open and from being deleted
+	 *  until the fill completes.
+	 */
+	file->ref_count++;
+
 	args->op.readahead.cache_buffer->in_progress = true;
+	if (readahead) {
+		args->op.readahead.cache_buffer->readahead = true;
+		pthread_mutex_lock(&g_cache_lock);
+		g_cache.stats.readahead_buffers++;
+		pthread_mutex_unlock(&g_cache_lock);
+	}
 	if (file->length < (offset + CACHE_BUFFER_SIZE)) {
 		args->op.readahead.length = file->length & (CACHE_BUFFER_SIZE - 1);
 	} else {
@@ -2585,6 +2950,18 @@ check_readahead(struct spdk_file *file, uint64_t offset,
 	file->fs->send_request(__readahead, req);
 }
 
+static void
+check_readahead(struct spdk_file *file, uint64_t offset,
+		struct spdk_fs_channel *channel)
+{
+	uint32_t i;
+
+	offset = __next_cache_buffer_offset(offset);
+	for (i = 0; i < file->ra_window; i++) {
+		cache_fill_buffer(file, offset + (uint64_t)i * CACHE_BUFFER_SIZE, true, channel);
+	}
+}
+
 int64_t
 spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 	       void *payload, uint64_t offset, uint64_t length)
@@ -2593,8 +2970,9 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 	uint64_t final_offset, final_length;
 	uint32_t sub_reads = 0;
 	struct cache_buffer *buf;
-	uint64_t read_len;
+	uint64_t read_len, buf_offset;
 	struct rw_from_file_arg arg = {};
+	bool sequential;
 
 	pthread_spin_lock(&file->lock);
 
@@ -2616,9 +2994,14 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 	}
 	file->seq_byte_count += length;
 	file->next_seq_offset = offset + length;
-	if (file->seq_byte_count >= CACHE_READAHEAD_THRESHOLD) {
+	sequential = file->seq_byte_count >= CACHE_READAHEAD_THRESHOLD;
+	if (sequential) {
+		if (file->ra_window == 0) {
+			file->ra_window = CACHE_READAHEAD_MIN_BUFFERS;
+		}
 		check_readahead(file, offset, channel);
-		check_readahead(file, offset + CACHE_BUFFER_SIZE, channel);
+	} else {
+		file->ra_window = 0;
 	}
 
 	arg.channel = channel;
@@ -2634,6 +3017,15 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 
 		buf = tree_find_filled_buffer(file->tree, offset);
 		if (buf == NULL) {
+			buf_offset = offset & ~(uint64_t)(CACHE_BUFFER_SIZE - 1);
+			/* Random reads admit whole buffers into the cache.  Partial buffers
+			 *  at the end of the file are skipped since appends bypassing the
+			 *  cache could make them stale.
+			 */
+			if (cache_miss(file, buf_offset) && !sequential &&
+			    NEXT_CACHE_BUFFER_OFFSET(offset) <= file->length) {
+				cache_fill_buffer(file, buf_offset, false, channel);
+			}
 			pthread_spin_unlock(&file->lock);
 			ret = __send_rw_from_file(file, payload, offset, length, true, &arg);
 			pthread_spin_lock(&file->lock);
@@ -2647,12 +3039,11 @@ spdk_file_read(struct spdk_file *file, struct spdk_fs_thread_ctx *ctx,
 			}
 			BLOBFS_TRACE(file, "read %p offset=%ju length=%ju\n", payload, offset, read_len);
 			memcpy(payload, &buf->buf[offset - buf->offset], read_len);
-			if ((offset + read_len) % CACHE_BUFFER_SIZE == 0) {
-				tree_remove_buffer(file->tree, buf);
-				if (file->tree->present_mask == 0) {
-					spdk_thread_send_msg(g_cache_pool_thread, _remove_file_from_cache_pool, file);
-				}
+			if (sequential && buf->readahead) {
+				/* The stream caught up with data read ahead for it, so widen the window. */
+				file->ra_window = spdk_min(file->ra_window * 2, CACHE_READAHEAD_MAX_BUFFERS);
 			}
+			cache_buffer_touch(buf, sequential);
 		}
 
 		if (ret == 0) {
@@ -2884,35 +3275,18 @@ spdk_file_get_id(struct spdk_file *file, void *id, size_t size)
 	return sizeof(spdk_blob_id);
 }
 
-static void
-_file_free(void *ctx)
-{
-	struct spdk_file *file = ctx;
-
-	TAILQ_REMOVE(&g_caches, file, cache_tailq);
-
-	free(file->name);
-	free(file->tree);
-	free(file);
-}
-
 static void
 file_free(struct spdk_file *file)
 {
 	BLOBFS_TRACE(file, "free=%s\n", file->name);
 	pthread_spin_lock(&file->lock);
-	if (file->tree->present_mask == 0) {
-		pthread_spin_unlock(&file->lock);
-		free(file->name);
-		free(file->tree);
-		free(file);
-		return;
-	}
-
 	tree_free_buffers(file->tree);
 	assert(file->tree->present_mask == 0);
-	spdk_thread_send_msg(g_cache_pool_thread, _file_free, file);
 	pthread_spin_unlock(&file->lock);
+
+	free(file->name);
+	free(file->tree);
+	free(file);
 }
 
 SPDK_LOG_REGISTER_COMPONENT(blobfs)
@@ -6,6 +6,10 @@
 #ifndef SPDK_TREE_H_
 #define SPDK_TREE_H_
 
+#include "spdk/queue.h"
+
+struct spdk_file;
+
 struct cache_buffer {
 	uint8_t			*buf;
 	uint64_t		offset;
@@ -13,6 +17,14 @@ struct cache_buffer {
 	uint32_t		bytes_filled;
 	uint32_t		bytes_flushed;
 	bool			in_progress;
+	/* filled by readahead and not read yet */
+	bool			readahead;
+	/* consumed by a sequential reader, evicted without leaving a ghost entry */
+	bool			scanned;
+	/* replacement list the buffer is linked on */
+	uint8_t			list;
+	struct spdk_file	*file;
+	TAILQ_ENTRY(cache_buffer)	tailq;
 };
 
 #define CACHE_BUFFER_SHIFT (18)
@@ -202,6 +202,12 @@ _rpc_thread_get_stats(void *arg)
 		spdk_json_write_named_uint64(ctx->w, "active_pollers_count", active_pollers_count);
 		spdk_json_write_named_uint64(ctx->w, "timed_pollers_count", timed_pollers_count);
 		spdk_json_write_named_uint64(ctx->w, "paused_pollers_count", paused_pollers_count);
+		spdk_json_write_named_uint64(ctx->w, "msg_count", stats.msg_count);
+		spdk_json_write_named_uint64(ctx->w, "msg_samples", stats.msg_samples);
+		spdk_json_write_named_uint64(ctx->w, "msg_queue_depth_total", stats.msg_queue_depth_total);
+		spdk_json_write_named_uint64(ctx->w, "msg_queue_depth_max", stats.msg_queue_depth_max);
+		spdk_json_write_named_uint64(ctx->w, "msg_latency_total", stats.msg_latency_total_tsc);
+		spdk_json_write_named_uint64(ctx->w, "msg_latency_max", stats.msg_latency_max_tsc);
 		spdk_json_write_object_end(ctx->w);
 	}
 }
@@ -226,6 +232,7 @@ rpc_get_poller(struct spdk_poller *poller, struct spdk_json_write_ctx *w)
 {
 	struct spdk_poller_stats stats;
 	uint64_t period_ticks;
+	int i, num_buckets;
 
 	period_ticks = spdk_poller_get_period_ticks(poller);
 	spdk_poller_get_stats(poller, &stats);
@@ -239,6 +246,20 @@ rpc_get_poller(struct spdk_poller *poller, struct spdk_json_write_ctx *w)
 	if (period_ticks) {
 		spdk_json_write_named_uint64(w, "period_ticks", period_ticks);
 	}
+	spdk_json_write_named_uint64(w, "total_run_ticks", stats.total_run_ticks);
+	spdk_json_write_named_uint64(w, "max_run_ticks", stats.max_run_ticks);
+
+	/* Trailing empty buckets are omitted to keep the output short */
+	for (num_buckets = SPDK_POLLER_RUN_TIME_BUCKETS; num_buckets > 0; num_buckets--) {
+		if (stats.run_time_histogram[num_buckets - 1] != 0) {
+			break;
+		}
+	}
+	spdk_json_write_named_array_begin(w, "run_time_histogram");
+	for (i = 0; i < num_buckets; i++) {
+		spdk_json_write_uint64(w, stats.run_time_histogram[i]);
+	}
+	spdk_json_write_array_end(w);
 	spdk_json_write_object_end(w);
 }
 
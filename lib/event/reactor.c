@@ -44,6 +44,8 @@ static struct spdk_scheduler *g_scheduler = NULL;
 static struct spdk_reactor *g_scheduling_reactor;
 bool g_scheduling_in_progress = false;
 static uint64_t g_scheduler_period = 0;
+/* How many times per scheduling period the scheduler gets a chance to steal a thread */
+#define SCHEDULER_STEAL_CHECKS_PER_PERIOD 10
 static uint32_t g_scheduler_core_number;
 static struct spdk_scheduler_core_info *g_core_infos = NULL;
 
@@ -828,6 +830,77 @@ _reactors_scheduler_gather_metrics(void *arg1, void *arg2)
 	spdk_event_call(evt);
 }
 
+/* Runs on the source core of a steal and picks the thread to hand over to the destination core */
+static void
+_reactor_steal_thread(void *arg1, void *arg2)
+{
+	struct spdk_reactor *reactor;
+	struct spdk_lw_thread *lw_thread, *stolen = NULL;
+	struct spdk_thread *thread;
+	struct spdk_thread_stats stats;
+	uint32_t dst_lcore = (uint32_t)(uintptr_t)arg1;
+	uint64_t busy, target, diff, best_diff = UINT64_MAX;
+
+	reactor = spdk_reactor_get(spdk_env_get_current_core());
+	assert(reactor != NULL);
+
+	/* A scheduling period started in the meantime, let it decide instead. */
+	if (g_scheduling_in_progress || reactor->thread_count <= 1) {
+		return;
+	}
+
+	/* Pick the thread that splits the load of this core most evenly. */
+	target = (reactor->busy_tsc - g_core_infos[reactor->lcore].total_busy_tsc) / 2;
+	TAILQ_FOREACH(lw_thread, &reactor->threads, link) {
+		thread = spdk_thread_get_from_ctx(lw_thread);
+		if (lw_thread->resched ||
+		    !spdk_cpuset_get_cpu(spdk_thread_get_cpumask(thread), dst_lcore)) {
+			continue;
+		}
+
+		spdk_set_thread(thread);
+		spdk_thread_get_stats(&stats);
+		spdk_set_thread(NULL);
+
+		busy = stats.busy_tsc - lw_thread->total_stats.busy_tsc;
+		diff = busy > target ? busy - target : target - busy;
+		if (diff < best_diff) {
+			best_diff = diff;
+			stolen = lw_thread;
+		}
+	}
+
+	if (stolen == NULL) {
+		return;
+	}
+
+	SPDK_DEBUGLOG(reactor, "Moving thread %s from core %u to core %u\n",
+		      spdk_thread_get_name(spdk_thread_get_from_ctx(stolen)), reactor->lcore, dst_lcore);
+
+	stolen->lcore = dst_lcore;
+	stolen->resched = true;
+}
+
+static void
+_reactors_scheduler_steal(void)
+{
+	struct spdk_scheduler *scheduler = spdk_scheduler_get();
+	struct spdk_event *evt;
+	uint32_t src_lcore, dst_lcore;
+
+	if (scheduler == NULL || scheduler->steal == NULL ||
+	    !scheduler->steal(&src_lcore, &dst_lcore)) {
+		return;
+	}
+
+	evt = spdk_event_allocate(src_lcore, _reactor_steal_thread, (void *)(uintptr_t)dst_lcore,
+				  NULL);
+	if (evt == NULL) {
+		return;
+	}
+	spdk_event_call(evt);
+}
+
 static int _reactor_schedule_thread(struct spdk_thread *thread);
 static uint64_t g_rusage_period;
 
@@ -922,6 +995,7 @@ reactor_run(void *arg)
 	struct spdk_lw_thread	*lw_thread, *tmp;
 	char			thread_name[32];
 	uint64_t		last_sched = 0;
+	uint64_t		last_steal = 0;
 
 	SPDK_NOTICELOG("Reactor started on core %u\n", reactor->lcore);
 
@@ -957,6 +1031,15 @@ reactor_run(void *arg)
 			_reactors_scheduler_gather_metrics(NULL, NULL);
 		}
 
+		if (spdk_unlikely(g_scheduler_period > 0 &&
+				  (reactor->tsc_last - last_steal) >
+				  g_scheduler_period / SCHEDULER_STEAL_CHECKS_PER_PERIOD &&
+				  reactor == g_scheduling_reactor &&
+				  !g_scheduling_in_progress)) {
+			last_steal = reactor->tsc_last;
+			_reactors_scheduler_steal();
+		}
+
 		if (g_reactor_state != SPDK_REACTOR_STATE_RUNNING) {
 			break;
 		}
@@ -63,6 +63,9 @@ struct ftl_band_md {
 
 	/* CRC32 checksum of the associated P2L map when band is in closed state */
 	uint32_t			p2l_map_checksum;
+
+	/* Sequence id of the band close, used for estimating the age of band's data */
+	uint64_t			close_seq_id;
 } __attribute__((aligned(FTL_BLOCK_SIZE)));
 
 SPDK_STATIC_ASSERT(sizeof(struct ftl_band_md) == FTL_BLOCK_SIZE, "Incorrect metadata size");
@@ -73,8 +73,6 @@ ftl_band_rq_write(struct ftl_band *band, struct ftl_rq *rq)
 	}
 }
 
-static void ftl_band_rq_bdev_read(void *_entry);
-
 static void
 read_rq_end(struct spdk_bdev_io *bdev_io, bool success, void *arg)
 {
@@ -82,12 +80,8 @@ read_rq_end(struct spdk_bdev_io *bdev_io, bool success, void *arg)
 	struct ftl_band *band = entry->io.band;
 	struct ftl_rq *rq = ftl_rq_from_entry(entry);
 
+	/* Failed reads are reported to the owner, which decides whether to retry them */
 	rq->success = success;
-	if (spdk_unlikely(!success)) {
-		ftl_band_rq_bdev_read(entry);
-		spdk_bdev_free_io(bdev_io);
-		return;
-	}
 
 	assert(band->queue_depth > 0);
 	band->queue_depth--;
@@ -320,6 +314,7 @@ band_map_write_cb(struct ftl_basic_rq *brq)
 
 		band_map_crc = spdk_crc32c_update(p2l_map->band_map,
 						  ftl_tail_md_num_blocks(dev) * FTL_BLOCK_SIZE, 0);
+		band->md->close_seq_id = ++dev->band_close_seq_id;
 		memcpy(p2l_map->band_dma_md, band->md, region->entry_size * FTL_BLOCK_SIZE);
 		p2l_map->band_dma_md->state = FTL_BAND_STATE_CLOSED;
 		p2l_map->band_dma_md->p2l_map_checksum = band_map_crc;
@@ -390,19 +385,15 @@ read_tail_md_cb(struct ftl_basic_rq *brq)
 	ftl_band_md_cb cb;
 	void *priv;
 
-	if (spdk_unlikely(!brq->success)) {
-		/* Retries the read in case of error */
-		ftl_band_basic_rq_read(band, &band->metadata_rq);
-		return;
-	}
-
 	cb = band->owner.md_fn;
 	band->owner.md_fn = NULL;
 
 	priv = band->owner.priv;
 	band->owner.priv = NULL;
 
-	status = FTL_MD_SUCCESS;
+	if (spdk_likely(brq->success)) {
+		status = FTL_MD_SUCCESS;
+	}
 
 	cb(band, priv, status);
 }
@@ -16,6 +16,7 @@
 #include "ftl_band.h"
 #include "ftl_io.h"
 #include "ftl_debug.h"
+#include "ftl_reloc.h"
 #include "ftl_internal.h"
 #include "mngt/ftl_mngt.h"
 
@@ -73,6 +74,11 @@ ftl_shutdown_complete(struct spdk_ftl_dev *dev)
 		return false;
 	}
 
+	if (!ftl_reloc_is_halted(dev->reloc)) {
+		ftl_reloc_halt(dev->reloc);
+		return false;
+	}
+
 	if (!ftl_writer_is_halted(&dev->writer_user)) {
 		ftl_writer_halt(&dev->writer_user);
 		return false;
@@ -493,6 +499,7 @@ ftl_core_poller(void *ctx)
 	ftl_process_io_queue(dev);
 	ftl_writer_run(&dev->writer_user);
 	ftl_writer_run(&dev->writer_gc);
+	ftl_reloc(dev->reloc);
 	ftl_nv_cache_process(dev);
 	ftl_l2p_process(dev);
 
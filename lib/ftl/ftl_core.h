@@ -145,6 +145,12 @@ struct spdk_ftl_dev {
 
 	/* Writer for GC IOs */
 	struct ftl_writer		writer_gc;
+
+	/* Band relocator feeding the GC writer */
+	struct ftl_reloc		*reloc;
+
+	/* Sequence id of the most recently closed band */
+	uint64_t			band_close_seq_id;
 };
 
 void ftl_apply_limits(struct spdk_ftl_dev *dev);
@@ -200,6 +206,13 @@ ftl_check_core_thread(const struct spdk_ftl_dev *dev)
 	return dev->core_thread == spdk_get_thread();
 }
 
+static inline bool
+ftl_l2p_is_paged(const struct spdk_ftl_dev *dev)
+{
+	/* The L2P is paged through a DRAM cache only if its size is limited */
+	return dev->conf.l2p_dram_limit != 0;
+}
+
 static inline int
 ftl_addr_packed(const struct spdk_ftl_dev *dev)
 {
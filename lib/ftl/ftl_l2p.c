@@ -7,10 +7,11 @@
 #include "ftl_band.h"
 #include "ftl_nv_cache.h"
 #include "ftl_l2p_flat.h"
+#include "ftl_l2p_cache.h"
 
 
 /* TODO: Verify why function pointers had worse performance than compile time constants */
-#define FTL_L2P_OP(name)	ftl_l2p_flat_ ## name
+#define FTL_L2P_OP(name)	(ftl_l2p_is_paged(dev) ? ftl_l2p_cache_ ## name : ftl_l2p_flat_ ## name)
 
 
 int
@@ -69,12 +70,24 @@ ftl_l2p_get(struct spdk_ftl_dev *dev, uint64_t lba)
 	return FTL_L2P_OP(get)(dev, lba);
 }
 
+bool
+ftl_l2p_peek(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr *addr)
+{
+	return FTL_L2P_OP(peek)(dev, lba, addr);
+}
+
 void
 ftl_l2p_clear(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
 {
 	FTL_L2P_OP(clear)(dev, cb, cb_ctx);
 }
 
+void
+ftl_l2p_persist(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
+{
+	FTL_L2P_OP(persist)(dev, cb, cb_ctx);
+}
+
 void
 ftl_l2p_process(struct spdk_ftl_dev *dev)
 {
@@ -40,7 +40,16 @@ void ftl_l2p_pin_skip(struct spdk_ftl_dev *dev, ftl_l2p_pin_cb cb, void *cb_ctx,
 void ftl_l2p_set(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr addr);
 ftl_addr ftl_l2p_get(struct spdk_ftl_dev *dev, uint64_t lba);
 
+/**
+ * @brief Looks up the address of an LBA which isn't pinned
+ *
+ * @return false if the L2P page holding the entry isn't resident in DRAM, the lookup
+ * must be then redone after pinning the LBA
+ */
+bool ftl_l2p_peek(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr *addr);
+
 void ftl_l2p_clear(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx);
+void ftl_l2p_persist(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx);
 void ftl_l2p_restore(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx);
 void ftl_l2p_process(struct spdk_ftl_dev *dev);
 bool ftl_l2p_is_halted(struct spdk_ftl_dev *dev);
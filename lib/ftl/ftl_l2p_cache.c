@@ -0,0 +1,682 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/env.h"
+#include "spdk/queue.h"
+
+#include "ftl_l2p.h"
+#include "ftl_core.h"
+#include "ftl_utils.h"
+#include "ftl_l2p_cache.h"
+#include "utils/ftl_addr_utils.h"
+#include "utils/ftl_md.h"
+
+/*
+ * Paged L2P cache
+ *
+ * The L2P table is kept in the L2P region of the NV cache and divided into pages of a single
+ * FTL block, each holding lbas_in_page consecutive entries. Only a subset of the pages, limited
+ * by the l2p_dram_limit configuration option, is resident in DRAM at any given time.
+ *
+ * Pinning an LBA range makes all of its pages resident and protects them from eviction until
+ * the range is unpinned. Missing pages are read asynchronously and the pin completes once all
+ * of them are available. Pins which cannot get enough free pages are deferred (in FIFO order)
+ * until the eviction frees some. Unpinned pages are kept on an LRU list - clean pages are
+ * evicted right away, dirty ones are written back to the NV cache first.
+ */
+
+/* Maximum number of page writes issued at once (by either eviction or persist) */
+#define FTL_L2P_CACHE_FLUSH_QD		64
+
+/* Minimum number of pages which must fit in the DRAM limit */
+#define FTL_L2P_CACHE_MIN_PAGES		256
+
+/* Percentage of the resident pages kept free for page-ins */
+#define FTL_L2P_CACHE_FREE_PCT		5
+
+enum ftl_l2p_page_state {
+	/* Page is being read from the NV cache */
+	FTL_L2P_PAGE_STATE_PAGE_IN,
+
+	/* Page is resident and its entries may be accessed */
+	FTL_L2P_PAGE_STATE_READY,
+};
+
+struct ftl_l2p_page {
+	/* Index of the page within the L2P */
+	uint64_t page_no;
+
+	enum ftl_l2p_page_state state;
+
+	/* Number of pins keeping the page resident */
+	uint64_t pin_ref_cnt;
+
+	/* Number of updates done since the last write back was started */
+	uint64_t updates;
+
+	/* Number of updates covered by the write back in progress */
+	uint64_t flush_updates;
+
+	/* Page is being written back to the NV cache */
+	bool flushing;
+
+	/* Page is on the LRU list */
+	bool on_lru;
+
+	/* FTL_BLOCK_SIZE DMA buffer holding the entries */
+	void *page_buffer;
+
+	struct ftl_l2p_cache *cache;
+
+	struct ftl_md_io_entry_ctx ctx;
+
+	/* Link on either the free or the LRU list */
+	TAILQ_ENTRY(ftl_l2p_page) list_entry;
+};
+
+TAILQ_HEAD(ftl_l2p_page_list, ftl_l2p_page);
+
+struct ftl_l2p_cache {
+	struct spdk_ftl_dev *dev;
+
+	/* Metadata object of the L2P region */
+	struct ftl_md *md;
+
+	/* Resident page of given number, NULL if it's not in DRAM */
+	struct ftl_l2p_page **page_map;
+
+	/* Total number of pages of the L2P */
+	uint64_t num_pages;
+
+	/* Number of LBAs mapped by a single page */
+	uint64_t lbas_in_page;
+
+	/* Page descriptors and their buffers */
+	struct ftl_l2p_page *pages;
+	void *page_buffers;
+	uint64_t max_pages;
+
+	/* Number of free pages the eviction tries to maintain */
+	uint64_t evict_threshold;
+
+	struct ftl_l2p_page_list free_pages;
+	uint64_t num_free;
+
+	/* Unpinned resident pages, most recently used first */
+	struct ftl_l2p_page_list lru;
+
+	/* Pins waiting for free pages */
+	TAILQ_HEAD(, ftl_l2p_pin_ctx) deferred_pins;
+
+	/* Pins waiting for page-ins to complete */
+	TAILQ_HEAD(, ftl_l2p_pin_ctx) pending_pins;
+
+	/* Number of page reads and writes in progress */
+	uint64_t ios_in_flight;
+
+	/* Number of page writes in progress */
+	uint64_t flush_qd;
+
+	bool halt;
+
+	struct {
+		bool active;
+		uint64_t next_page;
+		ftl_l2p_cb cb;
+		void *cb_ctx;
+	} persist;
+};
+
+static struct ftl_md *
+get_l2p_md(struct spdk_ftl_dev *dev)
+{
+	return dev->layout.md[FTL_LAYOUT_REGION_TYPE_L2P];
+}
+
+static inline uint64_t
+l2p_cache_page_no(struct ftl_l2p_cache *cache, uint64_t lba)
+{
+	return lba / cache->lbas_in_page;
+}
+
+static inline struct ftl_l2p_page *
+l2p_cache_get_page(struct ftl_l2p_cache *cache, uint64_t lba)
+{
+	struct ftl_l2p_page *page = cache->page_map[l2p_cache_page_no(cache, lba)];
+
+	assert(page);
+	assert(page->state == FTL_L2P_PAGE_STATE_READY);
+	assert(page->pin_ref_cnt);
+
+	return page;
+}
+
+static void
+l2p_cache_lru_add(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	assert(!page->on_lru);
+	page->on_lru = true;
+	TAILQ_INSERT_HEAD(&cache->lru, page, list_entry);
+}
+
+static void
+l2p_cache_lru_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	assert(page->on_lru);
+	page->on_lru = false;
+	TAILQ_REMOVE(&cache->lru, page, list_entry);
+}
+
+static struct ftl_l2p_page *
+l2p_cache_page_alloc(struct ftl_l2p_cache *cache, uint64_t page_no)
+{
+	struct ftl_l2p_page *page = TAILQ_FIRST(&cache->free_pages);
+
+	assert(page);
+	assert(!cache->page_map[page_no]);
+
+	TAILQ_REMOVE(&cache->free_pages, page, list_entry);
+	cache->num_free--;
+
+	page->page_no = page_no;
+	page->pin_ref_cnt = 0;
+	page->updates = 0;
+	page->flush_updates = 0;
+	page->flushing = false;
+	page->on_lru = false;
+	cache->page_map[page_no] = page;
+
+	return page;
+}
+
+static void
+l2p_cache_page_free(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	assert(!page->pin_ref_cnt);
+	assert(!page->updates);
+	assert(!page->flushing);
+	assert(!page->on_lru);
+
+	cache->page_map[page->page_no] = NULL;
+	TAILQ_INSERT_TAIL(&cache->free_pages, page, list_entry);
+	cache->num_free++;
+}
+
+static bool
+l2p_cache_pin_ready(struct ftl_l2p_cache *cache, const struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	uint64_t page_no = l2p_cache_page_no(cache, pin_ctx->lba);
+	uint64_t last = l2p_cache_page_no(cache, pin_ctx->lba + pin_ctx->count - 1);
+
+	for (; page_no <= last; page_no++) {
+		if (cache->page_map[page_no]->state != FTL_L2P_PAGE_STATE_READY) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void
+l2p_cache_complete_pending_pins(struct ftl_l2p_cache *cache)
+{
+	struct ftl_l2p_pin_ctx *pin_ctx, *tmp;
+
+	TAILQ_FOREACH_SAFE(pin_ctx, &cache->pending_pins, link, tmp) {
+		if (l2p_cache_pin_ready(cache, pin_ctx)) {
+			TAILQ_REMOVE(&cache->pending_pins, pin_ctx, link);
+			ftl_l2p_pin_complete(cache->dev, 0, pin_ctx);
+		}
+	}
+}
+
+static void
+l2p_cache_page_in_cb(int status, void *cb_arg)
+{
+	struct ftl_l2p_page *page = cb_arg;
+	struct ftl_l2p_cache *cache = page->cache;
+
+	if (status) {
+		ftl_abort();
+	}
+
+	assert(cache->ios_in_flight);
+	cache->ios_in_flight--;
+
+	page->state = FTL_L2P_PAGE_STATE_READY;
+	l2p_cache_complete_pending_pins(cache);
+}
+
+static void
+l2p_cache_page_in(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	page->state = FTL_L2P_PAGE_STATE_PAGE_IN;
+	cache->ios_in_flight++;
+
+	ftl_md_read_entry(cache->md, page->page_no, page->page_buffer, NULL,
+			  l2p_cache_page_in_cb, page, &page->ctx);
+}
+
+static void
+l2p_cache_persist_next(struct ftl_l2p_cache *cache);
+
+static void
+l2p_cache_flush_cb(int status, void *cb_arg)
+{
+	struct ftl_l2p_page *page = cb_arg;
+	struct ftl_l2p_cache *cache = page->cache;
+
+	assert(cache->ios_in_flight);
+	assert(cache->flush_qd);
+	cache->ios_in_flight--;
+	cache->flush_qd--;
+
+	page->flushing = false;
+	if (!status) {
+		/* Updates done during the write back keep the page dirty */
+		page->updates -= page->flush_updates;
+	}
+	page->flush_updates = 0;
+
+	if (!page->pin_ref_cnt) {
+		if (page->updates) {
+			/* Failed or outdated write back, retry on the next eviction pass */
+			page->on_lru = true;
+			TAILQ_INSERT_TAIL(&cache->lru, page, list_entry);
+		} else {
+			l2p_cache_page_free(cache, page);
+		}
+	}
+
+	if (cache->persist.active) {
+		if (status) {
+			cache->persist.active = false;
+			cache->persist.cb(cache->dev, status, cache->persist.cb_ctx);
+			return;
+		}
+		l2p_cache_persist_next(cache);
+	}
+}
+
+static void
+l2p_cache_page_flush(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	assert(page->state == FTL_L2P_PAGE_STATE_READY);
+	assert(!page->flushing);
+	assert(!page->on_lru);
+
+	page->flushing = true;
+	page->flush_updates = page->updates;
+	cache->ios_in_flight++;
+	cache->flush_qd++;
+
+	ftl_md_persist_entry(cache->md, page->page_no, page->page_buffer, NULL,
+			     l2p_cache_flush_cb, page, &page->ctx);
+}
+
+static uint64_t
+l2p_cache_pin_missing_pages(struct ftl_l2p_cache *cache, const struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	uint64_t page_no = l2p_cache_page_no(cache, pin_ctx->lba);
+	uint64_t last = l2p_cache_page_no(cache, pin_ctx->lba + pin_ctx->count - 1);
+	uint64_t missing = 0;
+
+	for (; page_no <= last; page_no++) {
+		if (!cache->page_map[page_no]) {
+			missing++;
+		}
+	}
+
+	return missing;
+}
+
+static bool
+l2p_cache_try_pin(struct ftl_l2p_cache *cache, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	uint64_t first = l2p_cache_page_no(cache, pin_ctx->lba);
+	uint64_t last = l2p_cache_page_no(cache, pin_ctx->lba + pin_ctx->count - 1);
+	uint64_t page_no;
+	struct ftl_l2p_page *page;
+
+	assert(last - first < cache->max_pages);
+
+	/* Take all the pages at once, so concurrent pins can't deadlock on partial ranges */
+	if (l2p_cache_pin_missing_pages(cache, pin_ctx) > cache->num_free) {
+		return false;
+	}
+
+	for (page_no = first; page_no <= last; page_no++) {
+		page = cache->page_map[page_no];
+		if (!page) {
+			page = l2p_cache_page_alloc(cache, page_no);
+			l2p_cache_page_in(cache, page);
+		} else if (page->on_lru) {
+			l2p_cache_lru_remove(cache, page);
+		}
+
+		page->pin_ref_cnt++;
+	}
+
+	if (l2p_cache_pin_ready(cache, pin_ctx)) {
+		ftl_l2p_pin_complete(cache->dev, 0, pin_ctx);
+	} else {
+		TAILQ_INSERT_TAIL(&cache->pending_pins, pin_ctx, link);
+	}
+
+	return true;
+}
+
+void
+ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+
+	assert(dev->num_lbas >= pin_ctx->lba + pin_ctx->count);
+	assert(pin_ctx->count);
+
+	/* Keep the pins in order, so the large ones don't starve */
+	if (!TAILQ_EMPTY(&cache->deferred_pins) || !l2p_cache_try_pin(cache, pin_ctx)) {
+		TAILQ_INSERT_TAIL(&cache->deferred_pins, pin_ctx, link);
+	}
+}
+
+void
+ftl_l2p_cache_unpin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	uint64_t page_no = l2p_cache_page_no(cache, lba);
+	uint64_t last = l2p_cache_page_no(cache, lba + count - 1);
+	struct ftl_l2p_page *page;
+
+	assert(dev->num_lbas >= lba + count);
+
+	for (; page_no <= last; page_no++) {
+		page = cache->page_map[page_no];
+		assert(page);
+		assert(page->pin_ref_cnt);
+
+		page->pin_ref_cnt--;
+		if (!page->pin_ref_cnt && !page->flushing) {
+			l2p_cache_lru_add(cache, page);
+		}
+	}
+}
+
+ftl_addr
+ftl_l2p_cache_get(struct spdk_ftl_dev *dev, uint64_t lba)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	struct ftl_l2p_page *page = l2p_cache_get_page(cache, lba);
+
+	assert(dev->num_lbas > lba);
+
+	return ftl_addr_load(dev, page->page_buffer, lba % cache->lbas_in_page);
+}
+
+void
+ftl_l2p_cache_set(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr addr)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	struct ftl_l2p_page *page = l2p_cache_get_page(cache, lba);
+
+	assert(dev->num_lbas > lba);
+
+	ftl_addr_store(dev, page->page_buffer, lba % cache->lbas_in_page, addr);
+	page->updates++;
+}
+
+bool
+ftl_l2p_cache_peek(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr *addr)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	struct ftl_l2p_page *page = cache->page_map[l2p_cache_page_no(cache, lba)];
+
+	assert(dev->num_lbas > lba);
+
+	if (!page || page->state != FTL_L2P_PAGE_STATE_READY) {
+		return false;
+	}
+
+	*addr = ftl_addr_load(dev, page->page_buffer, lba % cache->lbas_in_page);
+	return true;
+}
+
+static void
+md_cb(struct spdk_ftl_dev *dev, struct ftl_md *md, int status)
+{
+	ftl_l2p_cb cb = md->owner.private;
+	void *cb_ctx = md->owner.cb_ctx;
+
+	cb(dev, status, cb_ctx);
+}
+
+void
+ftl_l2p_cache_clear(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	struct ftl_md *md = cache->md;
+
+	/* Clearing is only done on startup, before any page could have been loaded */
+	assert(cache->num_free == cache->max_pages);
+
+	md->cb = md_cb;
+	md->owner.cb_ctx = cb_ctx;
+	md->owner.private = cb;
+	ftl_md_clear(md, (int)FTL_ADDR_INVALID, NULL);
+}
+
+static void
+l2p_cache_persist_next(struct ftl_l2p_cache *cache)
+{
+	struct ftl_l2p_page *page;
+
+	while (cache->persist.next_page < cache->num_pages &&
+	       cache->flush_qd < FTL_L2P_CACHE_FLUSH_QD) {
+		page = cache->page_map[cache->persist.next_page++];
+		if (!page || !page->updates) {
+			continue;
+		}
+
+		assert(!page->pin_ref_cnt);
+		assert(!page->flushing);
+		l2p_cache_lru_remove(cache, page);
+		l2p_cache_page_flush(cache, page);
+	}
+
+	if (cache->persist.next_page == cache->num_pages && !cache->flush_qd) {
+		cache->persist.active = false;
+		cache->persist.cb(cache->dev, 0, cache->persist.cb_ctx);
+	}
+}
+
+void
+ftl_l2p_cache_persist(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+
+	/* Persist is done on shutdown, once the cache doesn't have any IO in progress */
+	assert(!cache->ios_in_flight);
+	assert(!cache->persist.active);
+
+	cache->persist.active = true;
+	cache->persist.next_page = 0;
+	cache->persist.cb = cb;
+	cache->persist.cb_ctx = cb_ctx;
+
+	l2p_cache_persist_next(cache);
+}
+
+static void
+l2p_cache_evict(struct ftl_l2p_cache *cache)
+{
+	struct ftl_l2p_pin_ctx *pin_ctx = TAILQ_FIRST(&cache->deferred_pins);
+	uint64_t target = cache->evict_threshold;
+	struct ftl_l2p_page *page;
+
+	if (pin_ctx) {
+		target += l2p_cache_pin_missing_pages(cache, pin_ctx);
+	}
+
+	/* Pages being written back will be freed on completion, unless they get used again */
+	while (cache->num_free + cache->flush_qd < target) {
+		page = TAILQ_LAST(&cache->lru, ftl_l2p_page_list);
+		if (!page) {
+			break;
+		}
+
+		if (page->updates) {
+			if (cache->flush_qd >= FTL_L2P_CACHE_FLUSH_QD) {
+				break;
+			}
+
+			l2p_cache_lru_remove(cache, page);
+			l2p_cache_page_flush(cache, page);
+		} else {
+			l2p_cache_lru_remove(cache, page);
+			l2p_cache_page_free(cache, page);
+		}
+	}
+}
+
+void
+ftl_l2p_cache_process(struct spdk_ftl_dev *dev)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+	struct ftl_l2p_pin_ctx *pin_ctx;
+
+	if (!cache->halt) {
+		l2p_cache_evict(cache);
+	}
+
+	while ((pin_ctx = TAILQ_FIRST(&cache->deferred_pins))) {
+		TAILQ_REMOVE(&cache->deferred_pins, pin_ctx, link);
+		if (!l2p_cache_try_pin(cache, pin_ctx)) {
+			TAILQ_INSERT_HEAD(&cache->deferred_pins, pin_ctx, link);
+			break;
+		}
+	}
+}
+
+bool
+ftl_l2p_cache_is_halted(struct spdk_ftl_dev *dev)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+
+	return !cache->ios_in_flight && TAILQ_EMPTY(&cache->deferred_pins) &&
+	       TAILQ_EMPTY(&cache->pending_pins);
+}
+
+void
+ftl_l2p_cache_halt(struct spdk_ftl_dev *dev)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+
+	cache->halt = true;
+}
+
+static uint64_t
+l2p_cache_max_pages(struct spdk_ftl_dev *dev, uint64_t num_pages)
+{
+	uint64_t dram_limit = dev->conf.l2p_dram_limit * MiB;
+	uint64_t page_map_size = num_pages * sizeof(struct ftl_l2p_page *);
+
+	if (dram_limit <= page_map_size) {
+		return 0;
+	}
+
+	return spdk_min(num_pages, (dram_limit - page_map_size) /
+			(FTL_BLOCK_SIZE + sizeof(struct ftl_l2p_page)));
+}
+
+static void
+l2p_cache_free(struct ftl_l2p_cache *cache)
+{
+	spdk_free(cache->page_buffers);
+	free(cache->pages);
+	free(cache->page_map);
+	free(cache);
+}
+
+int
+ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
+{
+	struct ftl_l2p_cache *cache;
+	struct ftl_l2p_page *page;
+	uint64_t i;
+
+	if (dev->num_lbas == 0) {
+		FTL_ERRLOG(dev, "Invalid l2p table size\n");
+		return -1;
+	}
+
+	if (dev->l2p) {
+		FTL_ERRLOG(dev, "L2p table already allocated\n");
+		return -1;
+	}
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache) {
+		FTL_ERRLOG(dev, "Failed to allocate l2p cache\n");
+		return -1;
+	}
+
+	cache->dev = dev;
+	cache->md = get_l2p_md(dev);
+	cache->lbas_in_page = dev->layout.l2p.lbas_in_page;
+	cache->num_pages = spdk_divide_round_up(dev->num_lbas, cache->lbas_in_page);
+	assert(cache->num_pages <= cache->md->region->num_entries);
+	TAILQ_INIT(&cache->free_pages);
+	TAILQ_INIT(&cache->lru);
+	TAILQ_INIT(&cache->deferred_pins);
+	TAILQ_INIT(&cache->pending_pins);
+
+	cache->max_pages = l2p_cache_max_pages(dev, cache->num_pages);
+	if (cache->max_pages < spdk_min(cache->num_pages, FTL_L2P_CACHE_MIN_PAGES)) {
+		FTL_ERRLOG(dev, "L2P DRAM limit of %zuMiB is too small\n", dev->conf.l2p_dram_limit);
+		goto error;
+	}
+	cache->evict_threshold = spdk_max(1, cache->max_pages * FTL_L2P_CACHE_FREE_PCT / 100);
+
+	cache->page_map = calloc(cache->num_pages, sizeof(*cache->page_map));
+	cache->pages = calloc(cache->max_pages, sizeof(*cache->pages));
+	cache->page_buffers = spdk_zmalloc(cache->max_pages * FTL_BLOCK_SIZE, FTL_BLOCK_SIZE, NULL,
+					   SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!cache->page_map || !cache->pages || !cache->page_buffers) {
+		FTL_ERRLOG(dev, "Failed to allocate l2p cache pages\n");
+		goto error;
+	}
+
+	for (i = 0; i < cache->max_pages; i++) {
+		page = &cache->pages[i];
+		page->cache = cache;
+		page->page_buffer = (char *)cache->page_buffers + i * FTL_BLOCK_SIZE;
+		TAILQ_INSERT_TAIL(&cache->free_pages, page, list_entry);
+	}
+	cache->num_free = cache->max_pages;
+
+	FTL_NOTICELOG(dev, "L2P cache pages:                %"PRIu64" of %"PRIu64"\n",
+		      cache->max_pages, cache->num_pages);
+
+	dev->l2p = cache;
+	return 0;
+error:
+	l2p_cache_free(cache);
+	return -1;
+}
+
+void
+ftl_l2p_cache_deinit(struct spdk_ftl_dev *dev)
+{
+	struct ftl_l2p_cache *cache = dev->l2p;
+
+	if (!cache) {
+		return;
+	}
+
+	assert(!cache->ios_in_flight);
+	l2p_cache_free(cache);
+
+	dev->l2p = NULL;
+}
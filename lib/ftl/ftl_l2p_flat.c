@@ -55,6 +55,13 @@ ftl_l2p_flat_get(struct spdk_ftl_dev *dev, uint64_t lba)
 	return ftl_addr_load(dev, l2p_flat->l2p, lba);
 }
 
+bool
+ftl_l2p_flat_peek(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr *addr)
+{
+	*addr = ftl_l2p_flat_get(dev, lba);
+	return true;
+}
+
 static void
 md_cb(struct spdk_ftl_dev *dev, struct ftl_md *md, int status)
 {
@@ -80,6 +87,17 @@ ftl_l2p_flat_clear(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
 	ftl_md_persist(md);
 }
 
+void
+ftl_l2p_flat_persist(struct spdk_ftl_dev *dev, ftl_l2p_cb cb, void *cb_ctx)
+{
+	struct ftl_md *md = get_l2p_md(dev);
+
+	md->cb = md_cb;
+	md->owner.cb_ctx = cb_ctx;
+	md->owner.private = cb;
+	ftl_md_persist(md);
+}
+
 static int
 ftl_l2p_flat_init_dram(struct spdk_ftl_dev *dev, struct ftl_l2p_flat *l2p_flat,
 		       size_t l2p_size)
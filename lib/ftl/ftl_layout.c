@@ -156,6 +156,11 @@ setup_layout_nvc(struct spdk_ftl_dev *dev)
 	region->prev.version = 0;
 	region->current.offset = offset;
 	region->current.blocks = blocks_region(layout->l2p.addr_size * dev->num_lbas);
+	if (ftl_l2p_is_paged(dev)) {
+		/* Each entry is a single L2P page, paged in and out by the L2P cache */
+		region->entry_size = 1;
+		region->num_entries = region->current.blocks;
+	}
 	set_region_bdev_nvc(region, dev);
 	offset += region->current.blocks;
 
@@ -0,0 +1,774 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk/crc32.h"
+#include "spdk/likely.h"
+#include "spdk/queue.h"
+#include "spdk/util.h"
+
+#include "ftl_reloc.h"
+#include "ftl_core.h"
+#include "ftl_band.h"
+#include "ftl_io.h"
+#include "ftl_l2p.h"
+#include "ftl_writer.h"
+#include "utils/ftl_defs.h"
+
+/* Number of P2L entries checked in a single poll, bounds the time spent on scanning
+ * a band which is mostly invalid
+ */
+#define FTL_RELOC_MAX_SCAN_BLOCKS 4096
+
+enum ftl_reloc_move_state {
+	FTL_RELOC_STATE_READ,
+	FTL_RELOC_STATE_PIN,
+	FTL_RELOC_STATE_WRITE,
+};
+
+struct ftl_reloc_move {
+	struct ftl_reloc		*reloc;
+
+	/* Request used for both reading the blocks from the victim band and writing them
+	 * through the GC writer
+	 */
+	struct ftl_rq			*rq;
+
+	enum ftl_reloc_move_state	state;
+
+	/* Number of valid entries collected from the P2L map */
+	uint32_t			num_entries;
+
+	/* Contiguous run of entries not yet submitted for reading */
+	uint32_t			run_idx;
+	uint32_t			run_len;
+
+	/* Set once no more entries will be added to the move */
+	bool				filled;
+
+	/* Set if any of the reads of the move failed, all its blocks are then read again */
+	bool				read_failed;
+
+	TAILQ_ENTRY(ftl_reloc_move)	qentry;
+};
+
+struct ftl_reloc {
+	struct spdk_ftl_dev		*dev;
+
+	/* Maximum number of moves in flight */
+	uint64_t			max_qdepth;
+
+	/* Array of moves, max_qdepth entries */
+	struct ftl_reloc_move		*moves;
+
+	TAILQ_HEAD(, ftl_reloc_move)	free_queue;
+
+	/* Number of moves in flight */
+	uint64_t			num_active;
+
+	/* Move currently being filled from the P2L map */
+	struct ftl_reloc_move		*fill;
+
+	/* Band being relocated */
+	struct ftl_band			*band;
+
+	/* P2L map of the band has been read and verified */
+	bool				band_ready;
+
+	/* Next P2L entry of the band to be checked */
+	uint64_t			offset;
+
+	/* Number of valid blocks of the band when it was selected */
+	uint64_t			band_valid;
+
+	/* Band's write iterator, restored if the band is put back on the shut list */
+	ftl_addr			band_iter_addr;
+	uint64_t			band_iter_offset;
+
+	/* Number of blocks user writes are allowed to consume */
+	uint64_t			user_credit;
+
+	/* Credit remainder, in 1 / band_valid units */
+	uint64_t			user_credit_rem;
+
+	bool				halt;
+};
+
+static void reloc_move_pin(struct ftl_reloc_move *mv);
+
+uint64_t
+ftl_reloc_band_score(const struct ftl_band *band, uint64_t close_seq_id)
+{
+	uint64_t valid = band->p2l_map.num_valid;
+	uint64_t user_blocks = ftl_band_user_blocks(band);
+	uint64_t age;
+
+	if (valid == 0) {
+		/* Nothing to move, the band can be freed right away */
+		return UINT64_MAX;
+	}
+
+	if (valid >= user_blocks) {
+		return 0;
+	}
+
+	/* Age is measured in band closes since this band was closed */
+	assert(close_seq_id >= band->md->close_seq_id);
+	age = close_seq_id - band->md->close_seq_id + 1;
+
+	/*
+	 * Cost-benefit policy: the benefit is the free space reclaimed weighted by the age
+	 * of the data (cold bands are less likely to be invalidated any further), the cost
+	 * is reading and writing the valid blocks. With u being the band's utilization:
+	 * (1 - u) * age / 2u, the constant factor is omitted.
+	 */
+	return (user_blocks - valid) * age / valid;
+}
+
+static struct ftl_band *
+reloc_select_band(struct ftl_reloc *reloc)
+{
+	struct spdk_ftl_dev *dev = reloc->dev;
+	struct ftl_band *band, *victim = NULL;
+	uint64_t score, best = 0;
+
+	TAILQ_FOREACH(band, &dev->shut_bands, queue_entry) {
+		if (band->md->state != FTL_BAND_STATE_CLOSED) {
+			continue;
+		}
+
+		score = ftl_reloc_band_score(band, dev->band_close_seq_id);
+		if (score == UINT64_MAX) {
+			return band;
+		}
+
+		if (score > best) {
+			best = score;
+			victim = band;
+		}
+	}
+
+	return victim;
+}
+
+static uint64_t
+reloc_qdepth(const struct ftl_reloc *reloc)
+{
+	uint64_t qdepth;
+
+	switch (reloc->dev->limit) {
+	case SPDK_FTL_LIMIT_CRIT:
+	case SPDK_FTL_LIMIT_HIGH:
+		qdepth = reloc->max_qdepth;
+		break;
+	case SPDK_FTL_LIMIT_LOW:
+		qdepth = reloc->max_qdepth / 2;
+		break;
+	case SPDK_FTL_LIMIT_START:
+		qdepth = reloc->max_qdepth / 4;
+		break;
+	default:
+		qdepth = 0;
+		break;
+	}
+
+	/* Once started, always finish relocating the band */
+	if (reloc->band) {
+		qdepth = spdk_max(qdepth, 1);
+	}
+
+	return qdepth;
+}
+
+static bool
+reloc_throttle_active(const struct ftl_reloc *reloc)
+{
+	return reloc->band && reloc->dev->limit <= SPDK_FTL_LIMIT_LOW;
+}
+
+static void
+reloc_add_credit(struct ftl_reloc *reloc, uint64_t num_blocks)
+{
+	uint64_t user_blocks = ftl_band_user_blocks(reloc->band);
+	uint64_t gain;
+
+	if (reloc->band_valid == 0) {
+		gain = user_blocks;
+	} else {
+		/* Every relocated block gets the band closer to being freed, which reclaims
+		 * (B - V) blocks at the cost of V GC writes
+		 */
+		gain = num_blocks * (user_blocks - reloc->band_valid) + reloc->user_credit_rem;
+		reloc->user_credit_rem = gain % reloc->band_valid;
+		gain /= reloc->band_valid;
+	}
+
+	reloc->user_credit = spdk_min(reloc->user_credit + gain, user_blocks);
+}
+
+bool
+ftl_reloc_user_write_allowed(struct ftl_reloc *reloc, uint64_t num_blocks)
+{
+	if (!reloc_throttle_active(reloc)) {
+		return true;
+	}
+
+	if (reloc->user_credit < num_blocks) {
+		return false;
+	}
+
+	reloc->user_credit -= num_blocks;
+	return true;
+}
+
+static struct ftl_reloc_move *
+reloc_move_get(struct ftl_reloc *reloc)
+{
+	struct ftl_reloc_move *mv;
+
+	mv = TAILQ_FIRST(&reloc->free_queue);
+	if (!mv) {
+		return NULL;
+	}
+	TAILQ_REMOVE(&reloc->free_queue, mv, qentry);
+
+	mv->state = FTL_RELOC_STATE_READ;
+	mv->num_entries = 0;
+	mv->run_idx = 0;
+	mv->run_len = 0;
+	mv->filled = false;
+	mv->read_failed = false;
+	mv->rq->iter.idx = 0;
+	mv->rq->iter.count = 0;
+	mv->rq->iter.qd = 0;
+
+	reloc->num_active++;
+
+	return mv;
+}
+
+static void
+reloc_move_put(struct ftl_reloc_move *mv)
+{
+	struct ftl_reloc *reloc = mv->reloc;
+
+	assert(reloc->num_active > 0);
+	reloc->num_active--;
+	TAILQ_INSERT_TAIL(&reloc->free_queue, mv, qentry);
+}
+
+static void
+reloc_move_read(struct ftl_reloc_move *mv)
+{
+	struct ftl_reloc *reloc = mv->reloc;
+	struct ftl_band *band = reloc->band;
+	struct ftl_rq *rq = mv->rq;
+	ftl_addr addr;
+
+	if (!mv->run_len) {
+		return;
+	}
+
+	addr = rq->entries[mv->run_idx].addr;
+	band->md->iter.addr = addr;
+	band->md->iter.offset = ftl_band_block_offset_from_addr(band, addr);
+
+	rq->iter.idx = mv->run_idx;
+	rq->iter.count = mv->run_len;
+	rq->iter.qd++;
+
+	ftl_band_rq_read(band, rq);
+
+	mv->run_len = 0;
+}
+
+static void
+reloc_move_read_again(struct ftl_reloc_move *mv)
+{
+	struct ftl_rq *rq = mv->rq;
+	uint32_t i;
+
+	assert(mv->filled);
+	assert(!rq->iter.qd);
+
+	mv->read_failed = false;
+	mv->run_len = 0;
+
+	/* Split the entries into the same contiguous runs they were read in before */
+	for (i = 0; i < mv->num_entries; i++) {
+		if (mv->run_len && rq->entries[mv->run_idx].addr + mv->run_len != rq->entries[i].addr) {
+			reloc_move_read(mv);
+		}
+
+		if (!mv->run_len) {
+			mv->run_idx = i;
+		}
+		mv->run_len++;
+	}
+
+	reloc_move_read(mv);
+}
+
+static void
+reloc_move_read_done(struct ftl_reloc_move *mv)
+{
+	if (spdk_unlikely(mv->read_failed)) {
+		/* IO error, retry reading */
+		reloc_move_read_again(mv);
+		return;
+	}
+
+	reloc_move_pin(mv);
+}
+
+static void
+reloc_move_add(struct ftl_reloc_move *mv, uint64_t lba, ftl_addr addr)
+{
+	struct ftl_rq_entry *entry = &mv->rq->entries[mv->num_entries];
+
+	if (mv->run_len && mv->rq->entries[mv->run_idx].addr + mv->run_len != addr) {
+		reloc_move_read(mv);
+	}
+
+	if (!mv->run_len) {
+		mv->run_idx = mv->num_entries;
+	}
+
+	entry->lba = lba;
+	entry->addr = addr;
+	entry->owner.priv = NULL;
+
+	mv->run_len++;
+	mv->num_entries++;
+}
+
+static void
+reloc_move_filled(struct ftl_reloc_move *mv)
+{
+	struct ftl_reloc *reloc = mv->reloc;
+	struct ftl_rq *rq = mv->rq;
+	struct ftl_rq_entry *entry;
+	uint64_t i;
+
+	assert(reloc->fill == mv);
+	reloc->fill = NULL;
+
+	reloc_move_read(mv);
+	mv->filled = true;
+
+	if (!mv->num_entries) {
+		reloc_move_put(mv);
+		return;
+	}
+
+	/* Pad the rest of the request, the writer always writes full transfer units */
+	for (i = mv->num_entries; i < rq->num_blocks; i++) {
+		entry = &rq->entries[i];
+		entry->lba = FTL_LBA_INVALID;
+		entry->addr = FTL_ADDR_INVALID;
+		entry->owner.priv = NULL;
+	}
+
+	if (!rq->iter.qd) {
+		reloc_move_read_done(mv);
+	}
+}
+
+static void
+reloc_move_write(struct ftl_reloc_move *mv)
+{
+	struct spdk_ftl_dev *dev = mv->reloc->dev;
+	struct ftl_rq *rq = mv->rq;
+	struct ftl_rq_entry *entry;
+	uint64_t i, num_valid = 0;
+
+	for (i = 0; i < rq->num_blocks; i++) {
+		entry = &rq->entries[i];
+		if (entry->lba == FTL_LBA_INVALID) {
+			continue;
+		}
+
+		/* The block may have been overwritten by the user while it was read */
+		if (ftl_l2p_get(dev, entry->lba) != entry->addr) {
+			ftl_l2p_unpin(dev, entry->lba, 1);
+			entry->lba = FTL_LBA_INVALID;
+			entry->addr = FTL_ADDR_INVALID;
+			continue;
+		}
+
+		num_valid++;
+	}
+
+	if (!num_valid) {
+		reloc_move_put(mv);
+		return;
+	}
+
+	mv->state = FTL_RELOC_STATE_WRITE;
+	ftl_writer_queue_rq(&dev->writer_gc, rq);
+}
+
+static void
+_reloc_move_pin(void *_mv)
+{
+	struct ftl_reloc_move *mv = _mv;
+
+	reloc_move_pin(mv);
+}
+
+static void
+reloc_move_pin_cb(struct spdk_ftl_dev *dev, int status, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	struct ftl_reloc_move *mv = pin_ctx->cb_ctx;
+	struct ftl_rq *rq = mv->rq;
+
+	if (status) {
+		rq->iter.status = status;
+		pin_ctx->lba = FTL_LBA_INVALID;
+	}
+
+	if (--rq->iter.remaining == 0) {
+		if (rq->iter.status) {
+			/* unpin and try again */
+			ftl_rq_unpin(rq);
+			spdk_thread_send_msg(spdk_get_thread(), _reloc_move_pin, mv);
+			return;
+		}
+
+		reloc_move_write(mv);
+	}
+}
+
+static void
+reloc_move_pin(struct ftl_reloc_move *mv)
+{
+	struct spdk_ftl_dev *dev = mv->reloc->dev;
+	struct ftl_rq *rq = mv->rq;
+	struct ftl_rq_entry *entry;
+	uint64_t i;
+
+	mv->state = FTL_RELOC_STATE_PIN;
+	rq->iter.idx = 0;
+	rq->iter.count = rq->num_blocks;
+	rq->iter.remaining = rq->num_blocks;
+	rq->iter.status = 0;
+
+	for (i = 0; i < rq->num_blocks; i++) {
+		entry = &rq->entries[i];
+		if (entry->lba == FTL_LBA_INVALID) {
+			ftl_l2p_pin_skip(dev, reloc_move_pin_cb, mv, &entry->l2p_pin_ctx);
+		} else {
+			ftl_l2p_pin(dev, entry->lba, 1, reloc_move_pin_cb, mv, &entry->l2p_pin_ctx);
+		}
+	}
+}
+
+static void
+reloc_move_write_done(struct ftl_reloc_move *mv)
+{
+	struct ftl_reloc *reloc = mv->reloc;
+	struct spdk_ftl_dev *dev = reloc->dev;
+	struct ftl_rq *rq = mv->rq;
+	struct ftl_band *band = rq->io.band;
+	struct ftl_rq_entry *entry;
+	ftl_addr addr;
+	uint64_t i, num_moved = 0;
+
+	if (spdk_unlikely(!rq->success)) {
+		/* IO error retry writing */
+		ftl_writer_queue_rq(&dev->writer_gc, rq);
+		return;
+	}
+
+	/* Update L2P table */
+	addr = rq->io.addr;
+	for (i = 0, entry = rq->entries; i < rq->num_blocks; i++, entry++) {
+		if (entry->lba != FTL_LBA_INVALID) {
+			ftl_l2p_update_base(dev, entry->lba, addr, entry->addr);
+			ftl_l2p_unpin(dev, entry->lba, 1);
+			num_moved++;
+		}
+
+		addr = ftl_band_next_addr(band, addr, 1);
+	}
+
+	reloc_add_credit(reloc, num_moved);
+	reloc_move_put(mv);
+}
+
+static void
+reloc_move_cb(struct ftl_rq *rq)
+{
+	struct ftl_reloc_move *mv = rq->owner.priv;
+
+	switch (mv->state) {
+	case FTL_RELOC_STATE_READ:
+		assert(rq->iter.qd > 0);
+		if (spdk_unlikely(!rq->success)) {
+			mv->read_failed = true;
+		}
+
+		if (--rq->iter.qd == 0 && mv->filled) {
+			reloc_move_read_done(mv);
+		}
+		break;
+	case FTL_RELOC_STATE_WRITE:
+		reloc_move_write_done(mv);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+static void
+reloc_band_put_back(struct ftl_reloc *reloc)
+{
+	struct spdk_ftl_dev *dev = reloc->dev;
+	struct ftl_band *band = reloc->band;
+
+	band->md->iter.addr = reloc->band_iter_addr;
+	band->md->iter.offset = reloc->band_iter_offset;
+
+	ftl_band_release_p2l_map(band);
+	TAILQ_INSERT_HEAD(&dev->shut_bands, band, queue_entry);
+	reloc->band = NULL;
+}
+
+static void
+reloc_read_tail_md_cb(struct ftl_band *band, void *ctx, enum ftl_md_status status)
+{
+	struct ftl_reloc *reloc = ctx;
+	struct spdk_ftl_dev *dev = reloc->dev;
+	uint32_t band_map_crc;
+
+	if (spdk_unlikely(status != FTL_MD_SUCCESS)) {
+		/* The band is picked again, and its P2L map read again, on one of the next polls */
+		FTL_ERRLOG(dev, "Failed to read band %u P2L map, relocation postponed\n", band->id);
+		reloc_band_put_back(reloc);
+		return;
+	}
+
+	band_map_crc = spdk_crc32c_update(band->p2l_map.band_map,
+					  ftl_tail_md_num_blocks(dev) * FTL_BLOCK_SIZE, 0);
+	if (spdk_unlikely(band_map_crc != band->md->p2l_map_checksum)) {
+		FTL_ERRLOG(dev, "Band %u P2L map checksum mismatch, cannot relocate\n", band->id);
+		ftl_abort();
+	}
+
+	reloc->band_ready = true;
+}
+
+static void
+reloc_band_start(struct ftl_reloc *reloc, struct ftl_band *band)
+{
+	struct spdk_ftl_dev *dev = reloc->dev;
+
+	if (ftl_band_alloc_p2l_map(band)) {
+		/* Out of P2L buffers, try again later */
+		return;
+	}
+
+	TAILQ_REMOVE(&dev->shut_bands, band, queue_entry);
+
+	reloc->band = band;
+	reloc->band_ready = false;
+	reloc->offset = 0;
+	reloc->band_valid = band->p2l_map.num_valid;
+	reloc->band_iter_addr = band->md->iter.addr;
+	reloc->band_iter_offset = band->md->iter.offset;
+	reloc->user_credit_rem = 0;
+
+	FTL_DEBUGLOG(dev, "Relocating band %u, valid blocks: %"PRIu64"\n", band->id,
+		     reloc->band_valid);
+
+	if (!reloc->band_valid) {
+		reloc_add_credit(reloc, 0);
+		reloc->offset = ftl_band_user_blocks(band);
+		reloc->band_ready = true;
+		return;
+	}
+
+	ftl_band_read_tail_brq_md(band, reloc_read_tail_md_cb, reloc);
+}
+
+static void
+reloc_band_finish(struct ftl_reloc *reloc)
+{
+	struct spdk_ftl_dev *dev = reloc->dev;
+	struct ftl_band *band = reloc->band;
+
+	if (spdk_unlikely(band->p2l_map.num_valid)) {
+		/* All blocks pointed to by the L2P have been moved, the counter is stale */
+		FTL_DEBUGLOG(dev, "Band %u relocated with %zu blocks still marked valid\n",
+			     band->id, band->p2l_map.num_valid);
+		band->p2l_map.num_valid = 0;
+	}
+
+	reloc->band = NULL;
+	ftl_band_free(band);
+}
+
+static void
+reloc_scan(struct ftl_reloc *reloc)
+{
+	struct spdk_ftl_dev *dev = reloc->dev;
+	struct ftl_band *band = reloc->band;
+	uint64_t user_blocks = ftl_band_user_blocks(band);
+	uint64_t qdepth = reloc_qdepth(reloc);
+	uint64_t budget = FTL_RELOC_MAX_SCAN_BLOCKS;
+	struct ftl_reloc_move *mv;
+	ftl_addr addr, current_addr;
+	uint64_t lba;
+
+	while (reloc->offset < user_blocks && budget > 0) {
+		mv = reloc->fill;
+		if (!mv) {
+			if (reloc->num_active >= qdepth) {
+				break;
+			}
+
+			mv = reloc->fill = reloc_move_get(reloc);
+			if (!mv) {
+				break;
+			}
+		}
+
+		budget--;
+		lba = band->p2l_map.band_map[reloc->offset];
+		addr = ftl_band_addr_from_block_offset(band, reloc->offset);
+		reloc->offset++;
+
+		if (lba == FTL_LBA_INVALID || lba >= dev->num_lbas) {
+			continue;
+		}
+
+		/* Blocks whose L2P page isn't resident are checked again once pinned */
+		if (ftl_l2p_peek(dev, lba, &current_addr) && current_addr != addr) {
+			continue;
+		}
+
+		reloc_move_add(mv, lba, addr);
+		if (mv->num_entries == mv->rq->num_blocks) {
+			reloc_move_filled(mv);
+		}
+	}
+
+	if (reloc->offset == user_blocks && reloc->fill) {
+		reloc_move_filled(reloc->fill);
+	}
+}
+
+void
+ftl_reloc(struct ftl_reloc *reloc)
+{
+	struct ftl_band *band;
+
+	if (spdk_unlikely(reloc->halt)) {
+		if (reloc->fill) {
+			reloc_move_filled(reloc->fill);
+		}
+
+		if (reloc->band && reloc->band_ready && !reloc->num_active) {
+			reloc_band_put_back(reloc);
+		}
+		return;
+	}
+
+	if (!reloc->band && reloc_qdepth(reloc)) {
+		band = reloc_select_band(reloc);
+		if (band) {
+			reloc_band_start(reloc, band);
+		}
+	}
+
+	if (!reloc->band || !reloc->band_ready) {
+		return;
+	}
+
+	reloc_scan(reloc);
+
+	if (reloc->offset == ftl_band_user_blocks(reloc->band) && !reloc->num_active) {
+		reloc_band_finish(reloc);
+	}
+}
+
+void
+ftl_reloc_halt(struct ftl_reloc *reloc)
+{
+	reloc->halt = true;
+}
+
+void
+ftl_reloc_resume(struct ftl_reloc *reloc)
+{
+	reloc->halt = false;
+}
+
+bool
+ftl_reloc_is_halted(const struct ftl_reloc *reloc)
+{
+	return reloc->halt && !reloc->band && !reloc->num_active;
+}
+
+void
+ftl_reloc_free(struct ftl_reloc *reloc)
+{
+	uint64_t i;
+
+	if (!reloc) {
+		return;
+	}
+
+	if (reloc->moves) {
+		for (i = 0; i < reloc->max_qdepth; i++) {
+			ftl_rq_del(reloc->moves[i].rq);
+		}
+	}
+
+	free(reloc->moves);
+	free(reloc);
+}
+
+struct ftl_reloc *
+ftl_reloc_init(struct spdk_ftl_dev *dev)
+{
+	struct ftl_reloc *reloc;
+	struct ftl_reloc_move *mv;
+	uint64_t i;
+
+	reloc = calloc(1, sizeof(*reloc));
+	if (!reloc) {
+		return NULL;
+	}
+
+	reloc->dev = dev;
+	reloc->halt = true;
+	reloc->max_qdepth = dev->sb->max_reloc_qdepth;
+	TAILQ_INIT(&reloc->free_queue);
+
+	reloc->moves = calloc(reloc->max_qdepth, sizeof(*reloc->moves));
+	if (!reloc->moves) {
+		goto error;
+	}
+
+	for (i = 0; i < reloc->max_qdepth; i++) {
+		mv = &reloc->moves[i];
+		mv->reloc = reloc;
+		mv->rq = ftl_rq_new(dev, dev->md_size);
+		if (!mv->rq) {
+			goto error;
+		}
+
+		mv->rq->owner.priv = mv;
+		mv->rq->owner.cb = reloc_move_cb;
+		TAILQ_INSERT_TAIL(&reloc->free_queue, mv, qentry);
+	}
+
+	return reloc;
+error:
+	ftl_reloc_free(reloc);
+	return NULL;
+}
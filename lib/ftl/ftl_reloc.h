@@ -0,0 +1,54 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#ifndef FTL_RELOC_H
+#define FTL_RELOC_H
+
+#include "spdk/stdinc.h"
+
+struct spdk_ftl_dev;
+struct ftl_reloc;
+struct ftl_band;
+
+/**
+ * @brief Allocates the band relocator of the device
+ *
+ * The queue depth of the relocator (number of moves in flight) is limited by the
+ * superblock's max_reloc_qdepth.
+ */
+struct ftl_reloc *ftl_reloc_init(struct spdk_ftl_dev *dev);
+
+void ftl_reloc_free(struct ftl_reloc *reloc);
+
+/**
+ * @brief Runs the relocator - selects a victim band when free bands are running low,
+ * scans its P2L map and queues the blocks which are still valid to the GC writer
+ */
+void ftl_reloc(struct ftl_reloc *reloc);
+
+void ftl_reloc_halt(struct ftl_reloc *reloc);
+
+void ftl_reloc_resume(struct ftl_reloc *reloc);
+
+bool ftl_reloc_is_halted(const struct ftl_reloc *reloc);
+
+/**
+ * @brief Checks if user (compaction) writes of given size may proceed
+ *
+ * While the device is short on free bands, each block relocated by the GC earns the
+ * user writes the amount of space reclaimed by moving it. The credit is consumed when
+ * the write is allowed.
+ */
+bool ftl_reloc_user_write_allowed(struct ftl_reloc *reloc, uint64_t num_blocks);
+
+/**
+ * @brief Calculates the cost-benefit score of relocating the band, higher is better
+ *
+ * @param band Closed band
+ * @param close_seq_id Sequence id of the most recently closed band on the device
+ */
+uint64_t ftl_reloc_band_score(const struct ftl_band *band, uint64_t close_seq_id);
+
+#endif /* FTL_RELOC_H */
@@ -7,6 +7,7 @@
 
 #include "ftl_writer.h"
 #include "ftl_band.h"
+#include "ftl_reloc.h"
 
 void
 ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
@@ -149,6 +150,12 @@ ftl_writer_run(struct ftl_writer *writer)
 
 		/* Finally we can write to band */
 		rq = TAILQ_FIRST(&writer->rq_queue);
+		if (writer->writer_type == FTL_BAND_TYPE_COMPACTION &&
+		    !ftl_reloc_user_write_allowed(writer->dev->reloc, rq->num_blocks)) {
+			/* Let the GC catch up first */
+			return;
+		}
+
 		TAILQ_REMOVE(&writer->rq_queue, rq, qentry);
 		ftl_band_rq_write(writer->band, rq);
 	}
@@ -179,6 +179,8 @@ ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *
 			ftl_band_set_state(band, FTL_BAND_STATE_FREE);
 		} else {
 			num_shut++;
+			dev->band_close_seq_id = spdk_max(dev->band_close_seq_id,
+							  band->md->close_seq_id);
 		}
 	}
 
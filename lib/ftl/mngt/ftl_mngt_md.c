@@ -25,7 +25,7 @@ ftl_mngt_init_layout(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 }
 
 static bool
-is_buffer_needed(enum ftl_layout_region_type type)
+is_buffer_needed(struct spdk_ftl_dev *dev, enum ftl_layout_region_type type)
 {
 	switch (type) {
 #ifdef SPDK_FTL_VSS_EMU
@@ -39,6 +39,10 @@ is_buffer_needed(enum ftl_layout_region_type type)
 	case FTL_LAYOUT_REGION_TYPE_BAND_MD_MIRROR:
 		return false;
 
+	case FTL_LAYOUT_REGION_TYPE_L2P:
+		/* L2P pages are kept in the L2P cache */
+		return !ftl_l2p_is_paged(dev);
+
 	default:
 		return true;
 	}
@@ -62,7 +66,7 @@ ftl_mngt_init_md(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 			continue;
 		}
 		layout->md[i] = ftl_md_create(dev, region->current.blocks, region->vss_blksz, region->name,
-					      !is_buffer_needed(i), region);
+					      !is_buffer_needed(dev, i), region);
 		if (NULL == layout->md[i]) {
 			ftl_mngt_fail_step(mngt);
 			return;
@@ -10,6 +10,7 @@
 #include "ftl_band.h"
 #include "ftl_internal.h"
 #include "ftl_nv_cache.h"
+#include "ftl_reloc.h"
 #include "ftl_debug.h"
 
 void
@@ -101,6 +102,27 @@ ftl_mngt_deinit_nv_cache(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt
 	ftl_mngt_next_step(mngt);
 }
 
+void
+ftl_mngt_init_reloc(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
+{
+	dev->reloc = ftl_reloc_init(dev);
+	if (!dev->reloc) {
+		FTL_ERRLOG(dev, "Unable to initialize band relocation\n");
+		ftl_mngt_fail_step(mngt);
+		return;
+	}
+
+	ftl_mngt_next_step(mngt);
+}
+
+void
+ftl_mngt_deinit_reloc(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
+{
+	ftl_reloc_free(dev->reloc);
+	dev->reloc = NULL;
+	ftl_mngt_next_step(mngt);
+}
+
 static void
 user_clear_cb(struct spdk_ftl_dev *dev, struct ftl_md *md, int status)
 {
@@ -142,6 +164,7 @@ ftl_mngt_finalize_startup(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mng
 
 	ftl_writer_resume(&dev->writer_user);
 	ftl_writer_resume(&dev->writer_gc);
+	ftl_reloc_resume(dev->reloc);
 	ftl_nv_cache_resume(&dev->nv_cache);
 
 	ftl_mngt_next_step(mngt);
@@ -31,6 +31,10 @@ static const struct ftl_mngt_process_desc desc_shutdown = {
 			.name = "Dump statistics",
 			.action = ftl_mngt_dump_stats
 		},
+		{
+			.name = "Persist L2P",
+			.action = ftl_mngt_persist_l2p
+		},
 		{
 			.name = "Deinitialize L2P",
 			.action = ftl_mngt_deinit_l2p
@@ -92,6 +92,11 @@ static const struct ftl_mngt_process_desc desc_startup = {
 			.action = ftl_mngt_init_nv_cache,
 			.cleanup = ftl_mngt_deinit_nv_cache
 		},
+		{
+			.name = "Initialize relocation",
+			.action = ftl_mngt_init_reloc,
+			.cleanup = ftl_mngt_deinit_reloc
+		},
 		{
 			.name = "Initialize bands metadata",
 			.action = ftl_mngt_init_bands_md
@@ -872,10 +872,12 @@ ftl_md_set_region(struct ftl_md *md,
 	assert(region->current.blocks <= md->data_blocks);
 	md->region = region;
 
-	if (md->vss_data) {
+	if (md->vss_data || md->entry_vss_dma_buf) {
 		union ftl_md_vss vss = {0};
 		vss.version.md_version = region->current.version;
-		ftl_md_vss_buf_init(md->vss_data, md->data_blocks, &vss);
+		if (md->vss_data) {
+			ftl_md_vss_buf_init(md->vss_data, md->data_blocks, &vss);
+		}
 		if (region->entry_size) {
 			assert(md->entry_vss_dma_buf);
 			ftl_md_vss_buf_init(md->entry_vss_dma_buf, region->entry_size, &vss);
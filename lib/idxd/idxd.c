@@ -1427,6 +1427,18 @@ spdk_idxd_process_events(struct spdk_idxd_io_channel *chan)
 	return rc;
 }
 
+int
+spdk_idxd_flush(struct spdk_idxd_io_channel *chan)
+{
+	assert(chan != NULL);
+
+	if (chan->batch == NULL) {
+		return 0;
+	}
+
+	return idxd_batch_submit(chan, NULL, NULL);
+}
+
 void
 idxd_impl_register(struct spdk_idxd_impl *impl)
 {
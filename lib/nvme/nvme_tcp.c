@@ -435,6 +435,7 @@ data_crc32_accel_done(void *cb_arg, int status)
 		return;
 	}
 
+	pdu->data_digest_crc32 = nvme_tcp_pdu_pad_data_digest(pdu, pdu->data_digest_crc32);
 	pdu->data_digest_crc32 ^= SPDK_CRC32C_XOR;
 	MAKE_DIGEST_WORD(pdu->data_digest, pdu->data_digest_crc32);
 
@@ -451,10 +452,9 @@ pdu_data_crc32_compute(struct nvme_tcp_pdu *pdu)
 	/* Data Digest */
 	if (pdu->data_len > 0 && g_nvme_tcp_ddgst[pdu->hdr.common.pdu_type] &&
 	    tqpair->flags.host_ddgst_enable) {
-		/* Only suport this limited case for the first step */
 		if ((nvme_qpair_get_state(&tqpair->qpair) >= NVME_QPAIR_CONNECTED) &&
 		    (tgroup != NULL && tgroup->group.group->accel_fn_table.submit_accel_crc32c) &&
-		    spdk_likely(!pdu->dif_ctx && (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0))) {
+		    nvme_tcp_pdu_offload_data_digest(pdu)) {
 			tgroup->group.group->accel_fn_table.submit_accel_crc32c(tgroup->group.group->ctx,
 					&pdu->data_digest_crc32, pdu->data_iov,
 					pdu->data_iovcnt, 0, data_crc32_accel_done, pdu);
@@ -1101,6 +1101,7 @@ tcp_data_recv_crc32_done(void *cb_arg, int status)
 		goto end;
 	}
 
+	pdu->data_digest_crc32 = nvme_tcp_pdu_pad_data_digest(pdu, pdu->data_digest_crc32);
 	pdu->data_digest_crc32 ^= SPDK_CRC32C_XOR;
 	rc = MATCH_DIGEST_WORD(pdu->data_digest, pdu->data_digest_crc32);
 	if (rc == 0) {
@@ -1136,11 +1137,11 @@ nvme_tcp_pdu_payload_handle(struct nvme_tcp_qpair *tqpair,
 		/* But if the data digest is enabled, tcp_req cannot be NULL */
 		assert(tcp_req != NULL);
 		tgroup = nvme_tcp_poll_group(tqpair->qpair.poll_group);
-		/* Only suport this limitated case for the first step */
+		/* The digest is checked asynchronously on the copy of the PDU kept by the request,
+		 * so that the next PDU can be received in the meantime */
 		if ((nvme_qpair_get_state(&tqpair->qpair) >= NVME_QPAIR_CONNECTED) &&
 		    (tgroup != NULL && tgroup->group.group->accel_fn_table.submit_accel_crc32c) &&
-		    spdk_likely(!pdu->dif_ctx && (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)
-				&& !tcp_req->pdu_in_use)) {
+		    nvme_tcp_pdu_offload_data_digest(pdu) && !tcp_req->pdu_in_use) {
 
 			tcp_req->pdu_in_use = true;
 			tcp_req->pdu->hdr = pdu->hdr;
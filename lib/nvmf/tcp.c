@@ -928,6 +928,15 @@ _tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 	}
 }
 
+static void
+data_crc32_set(struct nvme_tcp_pdu *pdu)
+{
+	pdu->data_digest_crc32 ^= SPDK_CRC32C_XOR;
+	MAKE_DIGEST_WORD(pdu->data_digest, pdu->data_digest_crc32);
+
+	_tcp_write_pdu(pdu);
+}
+
 static void
 data_crc32_accel_done(void *cb_arg, int status)
 {
@@ -939,32 +948,29 @@ data_crc32_accel_done(void *cb_arg, int status)
 		return;
 	}
 
-	pdu->data_digest_crc32 ^= SPDK_CRC32C_XOR;
-	MAKE_DIGEST_WORD(pdu->data_digest, pdu->data_digest_crc32);
-
-	_tcp_write_pdu(pdu);
+	pdu->data_digest_crc32 = nvme_tcp_pdu_pad_data_digest(pdu, pdu->data_digest_crc32);
+	data_crc32_set(pdu);
 }
 
 static void
 pdu_data_crc32_compute(struct nvme_tcp_pdu *pdu)
 {
 	struct spdk_nvmf_tcp_qpair *tqpair = pdu->qpair;
-	int rc = 0;
+	int rc;
 
 	/* Data Digest */
 	if (pdu->data_len > 0 && g_nvme_tcp_ddgst[pdu->hdr.common.pdu_type] && tqpair->host_ddgst_enable) {
-		/* Only suport this limitated case for the first step */
-		if (spdk_likely(!pdu->dif_ctx && (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)
-				&& tqpair->group)) {
+		if (nvme_tcp_pdu_offload_data_digest(pdu) && tqpair->group) {
 			rc = spdk_accel_submit_crc32cv(tqpair->group->accel_channel, &pdu->data_digest_crc32, pdu->data_iov,
 						       pdu->data_iovcnt, 0, data_crc32_accel_done, pdu);
 			if (spdk_likely(rc == 0)) {
 				return;
 			}
-		} else {
-			pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
 		}
-		data_crc32_accel_done(pdu, rc);
+
+		/* Small PDUs, or the accel framework is out of resources */
+		pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
+		data_crc32_set(pdu);
 	} else {
 		_tcp_write_pdu(pdu);
 	}
@@ -1828,19 +1834,11 @@ _nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp
 }
 
 static void
-data_crc32_calc_done(void *cb_arg, int status)
+data_crc32_check(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
 {
-	struct nvme_tcp_pdu *pdu = cb_arg;
-	struct spdk_nvmf_tcp_qpair *tqpair = pdu->qpair;
 	struct spdk_nvmf_tcp_req *tcp_req;
 	struct spdk_nvme_cpl *rsp;
 
-	/* async crc32 calculation is failed and use direct calculation to check */
-	if (spdk_unlikely(status)) {
-		SPDK_ERRLOG("Data digest on tqpair=(%p) with pdu=%p failed to be calculated asynchronously\n",
-			    tqpair, pdu);
-		pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
-	}
 	pdu->data_digest_crc32 ^= SPDK_CRC32C_XOR;
 	if (!MATCH_DIGEST_WORD(pdu->data_digest, pdu->data_digest_crc32)) {
 		SPDK_ERRLOG("Data digest error on tqpair=(%p) with pdu=%p\n", tqpair, pdu);
@@ -1852,26 +1850,44 @@ data_crc32_calc_done(void *cb_arg, int status)
 	_nvmf_tcp_pdu_payload_handle(tqpair, pdu);
 }
 
+static void
+data_crc32_calc_done(void *cb_arg, int status)
+{
+	struct nvme_tcp_pdu *pdu = cb_arg;
+	struct spdk_nvmf_tcp_qpair *tqpair = pdu->qpair;
+
+	/* async crc32 calculation is failed and use direct calculation to check */
+	if (spdk_unlikely(status)) {
+		SPDK_ERRLOG("Data digest on tqpair=(%p) with pdu=%p failed to be calculated asynchronously\n",
+			    tqpair, pdu);
+		pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
+	} else {
+		pdu->data_digest_crc32 = nvme_tcp_pdu_pad_data_digest(pdu, pdu->data_digest_crc32);
+	}
+	data_crc32_check(tqpair, pdu);
+}
+
 static void
 nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
 {
-	int rc = 0;
+	int rc;
 	assert(tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD);
 	tqpair->pdu_in_progress = NULL;
 	nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
 	SPDK_DEBUGLOG(nvmf_tcp, "enter\n");
 	/* check data digest if need */
 	if (pdu->ddgst_enable) {
-		if (!pdu->dif_ctx && tqpair->group && (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)) {
+		/* The digest is checked asynchronously, while the next PDU is already being received */
+		if (nvme_tcp_pdu_offload_data_digest(pdu) && tqpair->group) {
 			rc = spdk_accel_submit_crc32cv(tqpair->group->accel_channel, &pdu->data_digest_crc32, pdu->data_iov,
 						       pdu->data_iovcnt, 0, data_crc32_calc_done, pdu);
 			if (spdk_likely(rc == 0)) {
 				return;
 			}
-		} else {
-			pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
 		}
-		data_crc32_calc_done(pdu, rc);
+
+		pdu->data_digest_crc32 = nvme_tcp_pdu_calc_data_digest(pdu);
+		data_crc32_check(tqpair, pdu);
 	} else {
 		_nvmf_tcp_pdu_payload_handle(tqpair, pdu);
 	}
@@ -469,6 +469,28 @@ spdk_sock_readv(struct spdk_sock *sock, struct iovec *iov, int iovcnt)
 	return sock->net_impl->readv(sock, iov, iovcnt);
 }
 
+int
+spdk_sock_recv_next(struct spdk_sock *sock, void **buf, void **ctx)
+{
+	if (sock == NULL || sock->flags.closed) {
+		errno = EBADF;
+		return -1;
+	}
+
+	/* The buffers come from the pool of the poll group */
+	if (sock->group_impl == NULL) {
+		errno = EPERM;
+		return -1;
+	}
+
+	if (sock->net_impl->recv_next == NULL) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	return sock->net_impl->recv_next(sock, buf, ctx);
+}
+
 void
 spdk_sock_readv_async(struct spdk_sock *sock, struct spdk_sock_request *req)
 {
@@ -576,6 +598,7 @@ spdk_sock_group_create(void *ctx)
 	}
 
 	STAILQ_INIT(&group->group_impls);
+	STAILQ_INIT(&group->pool);
 
 	STAILQ_FOREACH_FROM(impl, &g_net_impls, link) {
 		group_impl = impl->group_impl_create();
@@ -592,6 +615,30 @@ spdk_sock_group_create(void *ctx)
 	return group;
 }
 
+int
+spdk_sock_group_provide_buf(struct spdk_sock_group *group, void *buf, size_t len, void *ctx)
+{
+	struct spdk_sock_group_provided_buf *provided;
+
+	/* The header of the pool is kept in the buffer itself */
+	if (buf == NULL || len < SPDK_SOCK_GROUP_BUF_MIN_LEN) {
+		return -EINVAL;
+	}
+
+	provided = (struct spdk_sock_group_provided_buf *)buf;
+	provided->len = len;
+	provided->ctx = ctx;
+	STAILQ_INSERT_HEAD(&group->pool, provided, link);
+
+	return 0;
+}
+
+size_t
+spdk_sock_group_reclaim_buf(struct spdk_sock_group *group, void **buf, void **ctx)
+{
+	return spdk_sock_group_get_buf(group, buf, ctx);
+}
+
 void *
 spdk_sock_group_get_ctx(struct spdk_sock_group *group)
 {
@@ -749,6 +796,12 @@ spdk_sock_group_close(struct spdk_sock_group **group)
 		}
 	}
 
+	/* The buffers of the pool belong to the user, who has to reclaim them first */
+	if (!STAILQ_EMPTY(&(*group)->pool)) {
+		errno = EBUSY;
+		return -1;
+	}
+
 	STAILQ_FOREACH_SAFE(group_impl, &(*group)->group_impls, link, tmp) {
 		rc = group_impl->net_impl->group_impl_close(group_impl);
 		if (rc != 0) {
@@ -826,6 +879,30 @@ spdk_sock_impl_set_opts(const char *impl_name, const struct spdk_sock_impl_opts
 	return impl->set_opts(opts, len);
 }
 
+int
+spdk_sock_impl_get_stats(const char *impl_name, struct spdk_sock_impl_stats *stats, size_t *len)
+{
+	struct spdk_net_impl *impl;
+
+	if (!impl_name || !stats || !len) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	impl = sock_get_impl_by_name(impl_name);
+	if (!impl) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!impl->get_stats) {
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	return impl->get_stats(stats, len);
+}
+
 void
 spdk_sock_write_config_json(struct spdk_json_write_ctx *w)
 {
@@ -867,6 +944,8 @@ spdk_sock_write_config_json(struct spdk_json_write_ctx *w)
 			spdk_json_write_named_uint32(w, "zerocopy_threshold", opts.zerocopy_threshold);
 			spdk_json_write_named_uint32(w, "tls_version", opts.tls_version);
 			spdk_json_write_named_bool(w, "enable_ktls", opts.enable_ktls);
+			spdk_json_write_named_uint32(w, "recv_pipe_idle_timeout", opts.recv_pipe_idle_timeout);
+			spdk_json_write_named_uint64(w, "group_recv_pipe_limit", opts.group_recv_pipe_limit);
 			if (opts.psk_key) {
 				spdk_json_write_named_string(w, "psk_key", opts.psk_key);
 			}
@@ -54,6 +54,8 @@ rpc_sock_impl_get_options(struct spdk_jsonrpc_request *request,
 	spdk_json_write_named_uint32(w, "zerocopy_threshold", sock_opts.zerocopy_threshold);
 	spdk_json_write_named_uint32(w, "tls_version", sock_opts.tls_version);
 	spdk_json_write_named_bool(w, "enable_ktls", sock_opts.enable_ktls);
+	spdk_json_write_named_uint32(w, "recv_pipe_idle_timeout", sock_opts.recv_pipe_idle_timeout);
+	spdk_json_write_named_uint64(w, "group_recv_pipe_limit", sock_opts.group_recv_pipe_limit);
 	if (sock_opts.psk_key) {
 		spdk_json_write_named_string(w, "psk_key", sock_opts.psk_key);
 	}
@@ -67,6 +69,46 @@ rpc_sock_impl_get_options(struct spdk_jsonrpc_request *request,
 SPDK_RPC_REGISTER("sock_impl_get_options", rpc_sock_impl_get_options,
 		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
 
+static void
+rpc_sock_impl_get_stats(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	char *impl_name = NULL;
+	struct spdk_sock_impl_stats stats = {};
+	struct spdk_json_write_ctx *w;
+	size_t len;
+	int rc;
+
+	/* Reuse get_opts decoder */
+	if (spdk_json_decode_object(params, rpc_sock_impl_get_opts_decoders,
+				    SPDK_COUNTOF(rpc_sock_impl_get_opts_decoders), &impl_name)) {
+		SPDK_ERRLOG("spdk_json_decode_object() failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "Invalid parameters");
+		return;
+	}
+
+	len = sizeof(stats);
+	rc = spdk_sock_impl_get_stats(impl_name, &stats, &len);
+	free(impl_name);
+	if (rc) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 spdk_strerror(errno));
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "recv_pipe_bytes", stats.recv_pipe_bytes);
+	spdk_json_write_named_uint64(w, "recv_pipes", stats.recv_pipes);
+	spdk_json_write_named_uint64(w, "recv_pipe_grows", stats.recv_pipe_grows);
+	spdk_json_write_named_uint64(w, "recv_pipe_shrinks", stats.recv_pipe_shrinks);
+	spdk_json_write_named_uint64(w, "recv_pipe_limit_hits", stats.recv_pipe_limit_hits);
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+SPDK_RPC_REGISTER("sock_impl_get_stats", rpc_sock_impl_get_stats, SPDK_RPC_RUNTIME)
+
 struct spdk_rpc_sock_impl_set_opts {
 	char *impl_name;
 	struct spdk_sock_impl_opts sock_opts;
@@ -124,6 +166,14 @@ static const struct spdk_json_object_decoder rpc_sock_impl_set_opts_decoders[] =
 	{
 		"psk_identity", offsetof(struct spdk_rpc_sock_impl_set_opts, sock_opts.psk_identity),
 		spdk_json_decode_string, true
+	},
+	{
+		"recv_pipe_idle_timeout", offsetof(struct spdk_rpc_sock_impl_set_opts, sock_opts.recv_pipe_idle_timeout),
+		spdk_json_decode_uint32, true
+	},
+	{
+		"group_recv_pipe_limit", offsetof(struct spdk_rpc_sock_impl_set_opts, sock_opts.group_recv_pipe_limit),
+		spdk_json_decode_uint64, true
 	}
 };
 
@@ -64,6 +64,9 @@ struct spdk_poller {
 	uint64_t			next_run_tick;
 	uint64_t			run_count;
 	uint64_t			busy_count;
+	uint64_t			total_run_ticks;
+	uint64_t			max_run_ticks;
+	uint64_t			run_time_histogram[SPDK_POLLER_RUN_TIME_BUCKETS];
 	uint64_t			id;
 	spdk_poller_fn			fn;
 	void				*arg;
@@ -186,6 +189,7 @@ RB_GENERATE_STATIC(io_channel_tree, spdk_io_channel, node, io_channel_cmp);
 struct spdk_msg {
 	spdk_msg_fn		fn;
 	void			*arg;
+	uint64_t		send_tsc;
 
 	SLIST_ENTRY(spdk_msg)	link;
 };
@@ -647,6 +651,27 @@ spdk_thread_get_from_ctx(void *ctx)
 	return SPDK_CONTAINEROF(ctx, struct spdk_thread, ctx);
 }
 
+static inline void
+thread_update_msg_stats(struct spdk_thread *thread, uint32_t count, size_t remaining,
+			uint64_t oldest_send_tsc)
+{
+	struct spdk_thread_stats *stats = &thread->stats;
+	uint64_t depth = count + remaining;
+	uint64_t now = spdk_get_ticks();
+	uint64_t latency = now > oldest_send_tsc ? now - oldest_send_tsc : 0;
+
+	stats->msg_count += count;
+	stats->msg_samples++;
+	stats->msg_queue_depth_total += depth;
+	stats->msg_latency_total_tsc += latency;
+	if (depth > stats->msg_queue_depth_max) {
+		stats->msg_queue_depth_max = depth;
+	}
+	if (latency > stats->msg_latency_max_tsc) {
+		stats->msg_latency_max_tsc = latency;
+	}
+}
+
 static inline uint32_t
 msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 {
@@ -682,6 +707,11 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 		return 0;
 	}
 
+	/* Sample the queue once per batch.  The first message is the oldest one, so its
+	 * queueing time is the worst case for this batch. */
+	thread_update_msg_stats(thread, count, spdk_ring_count(thread->messages),
+				((struct spdk_msg *)messages[0])->send_tsc);
+
 	for (i = 0; i < count; i++) {
 		struct spdk_msg *msg = messages[i];
 
@@ -769,9 +799,35 @@ thread_update_stats(struct spdk_thread *thread, uint64_t end,
 	thread->tsc_last = end;
 }
 
+static inline void
+poller_update_stats(struct spdk_poller *poller, int rc, uint64_t ticks)
+{
+	uint32_t bucket;
+
+	poller->run_count++;
+	if (rc > 0) {
+		poller->busy_count++;
+	}
+
+	poller->total_run_ticks += ticks;
+	if (ticks > poller->max_run_ticks) {
+		poller->max_run_ticks = ticks;
+	}
+
+	bucket = ticks > 0 ? 63 - __builtin_clzll(ticks) : 0;
+	bucket = spdk_min(bucket, SPDK_POLLER_RUN_TIME_BUCKETS - 1);
+	poller->run_time_histogram[bucket]++;
+}
+
+/*
+ * tsc holds the tick count at which the poller starts running and is updated to the tick
+ * count at which it finished, so that consecutive pollers need only one spdk_get_ticks()
+ * call each.
+ */
 static inline int
-thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
+thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller, uint64_t *tsc)
 {
+	uint64_t start = *tsc;
 	int rc;
 
 	switch (poller->state) {
@@ -794,10 +850,8 @@ thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
 	poller->state = SPDK_POLLER_STATE_RUNNING;
 	rc = poller->fn(poller->arg);
 
-	poller->run_count++;
-	if (rc > 0) {
-		poller->busy_count++;
-	}
+	*tsc = spdk_get_ticks();
+	poller_update_stats(poller, rc, *tsc - start);
 
 #ifdef DEBUG
 	if (rc == -1) {
@@ -831,8 +885,9 @@ thread_execute_poller(struct spdk_thread *thread, struct spdk_poller *poller)
 
 static inline int
 thread_execute_timed_poller(struct spdk_thread *thread, struct spdk_poller *poller,
-			    uint64_t now)
+			    uint64_t now, uint64_t *tsc)
 {
+	uint64_t start = *tsc;
 	int rc;
 
 	switch (poller->state) {
@@ -853,10 +908,8 @@ thread_execute_timed_poller(struct spdk_thread *thread, struct spdk_poller *poll
 	poller->state = SPDK_POLLER_STATE_RUNNING;
 	rc = poller->fn(poller->arg);
 
-	poller->run_count++;
-	if (rc > 0) {
-		poller->busy_count++;
-	}
+	*tsc = spdk_get_ticks();
+	poller_update_stats(poller, rc, *tsc - start);
 
 #ifdef DEBUG
 	if (rc == -1) {
@@ -894,6 +947,7 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 	uint32_t msg_count;
 	struct spdk_poller *poller, *tmp;
 	spdk_msg_fn critical_msg;
+	uint64_t tsc;
 	int rc = 0;
 
 	thread->tsc_last = now;
@@ -910,11 +964,13 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 		rc = 1;
 	}
 
+	tsc = spdk_get_ticks();
+
 	TAILQ_FOREACH_REVERSE_SAFE(poller, &thread->active_pollers,
 				   active_pollers_head, tailq, tmp) {
 		int poller_rc;
 
-		poller_rc = thread_execute_poller(thread, poller);
+		poller_rc = thread_execute_poller(thread, poller, &tsc);
 		if (poller_rc > rc) {
 			rc = poller_rc;
 		}
@@ -939,7 +995,7 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 			thread->first_timed_poller = tmp;
 		}
 
-		timer_rc = thread_execute_timed_poller(thread, poller, now);
+		timer_rc = thread_execute_timed_poller(thread, poller, now, &tsc);
 		if (timer_rc > rc) {
 			rc = timer_rc;
 		}
@@ -1214,6 +1270,7 @@ spdk_thread_send_msg(const struct spdk_thread *thread, spdk_msg_fn fn, void *ctx
 
 	msg->fn = fn;
 	msg->arg = ctx;
+	msg->send_tsc = spdk_get_ticks();
 
 	rc = spdk_ring_enqueue(thread->messages, (void **)&msg, 1, NULL);
 	if (rc != 1) {
@@ -1748,6 +1805,10 @@ spdk_poller_get_stats(struct spdk_poller *poller, struct spdk_poller_stats *stat
 {
 	stats->run_count = poller->run_count;
 	stats->busy_count = poller->busy_count;
+	stats->total_run_ticks = poller->total_run_ticks;
+	stats->max_run_ticks = poller->max_run_ticks;
+	memcpy(stats->run_time_histogram, poller->run_time_histogram,
+	       sizeof(stats->run_time_histogram));
 }
 
 struct spdk_poller *
@@ -0,0 +1,203 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/xor.h"
+#include "spdk/config.h"
+#include "spdk/util.h"
+
+/* Multiply each of the bytes packed in a word by 2 in GF(2^8) with the 0x11d polynomial. */
+static inline uint64_t
+gf_mul2_u64(uint64_t v)
+{
+	uint64_t mask = v & 0x8080808080808080ULL;
+
+	mask = (mask << 1) - (mask >> 7);
+
+	return ((v << 1) & 0xfefefefefefefefeULL) ^ (mask & 0x1d1d1d1d1d1d1d1dULL);
+}
+
+static inline uint8_t
+gf_mul2_u8(uint8_t v)
+{
+	return (uint8_t)(v << 1) ^ ((v & 0x80) ? 0x1d : 0);
+}
+
+static bool
+xor_buffers_aligned(void *dest1, void *dest2, void **sources, uint32_t n, size_t len,
+		    size_t alignment)
+{
+	uintptr_t align = (uintptr_t)dest1 | (uintptr_t)dest2 | len;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		align |= (uintptr_t)sources[i];
+	}
+
+	return (align & (alignment - 1)) == 0;
+}
+
+static void
+xor_gen_basic(void *dest, void **sources, uint32_t n, size_t len)
+{
+	uint32_t i;
+	size_t off;
+
+	if (xor_buffers_aligned(dest, NULL, sources, n, len, sizeof(uint64_t))) {
+		uint64_t *d = dest;
+
+		for (off = 0; off < len / sizeof(uint64_t); off++) {
+			uint64_t v = ((uint64_t *)sources[0])[off];
+
+			for (i = 1; i < n; i++) {
+				v ^= ((uint64_t *)sources[i])[off];
+			}
+			d[off] = v;
+		}
+	} else {
+		uint8_t *d = dest;
+
+		for (off = 0; off < len; off++) {
+			uint8_t v = ((uint8_t *)sources[0])[off];
+
+			for (i = 1; i < n; i++) {
+				v ^= ((uint8_t *)sources[i])[off];
+			}
+			d[off] = v;
+		}
+	}
+}
+
+/*
+ * Q is evaluated with Horner's rule starting from the last source, so that source i
+ * ends up multiplied by 2^i. This matches the layout used by ISA-L's pq_gen().
+ */
+static void
+xor_gen_pq_basic(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	uint32_t i;
+	size_t off;
+
+	if (xor_buffers_aligned(p, q, sources, n, len, sizeof(uint64_t))) {
+		uint64_t *dp = p, *dq = q;
+
+		for (off = 0; off < len / sizeof(uint64_t); off++) {
+			uint64_t vp, vq;
+
+			vp = vq = ((uint64_t *)sources[n - 1])[off];
+			for (i = n - 1; i > 0; i--) {
+				uint64_t s = ((uint64_t *)sources[i - 1])[off];
+
+				vp ^= s;
+				vq = gf_mul2_u64(vq) ^ s;
+			}
+			dp[off] = vp;
+			dq[off] = vq;
+		}
+	} else {
+		uint8_t *dp = p, *dq = q;
+
+		for (off = 0; off < len; off++) {
+			uint8_t vp, vq;
+
+			vp = vq = ((uint8_t *)sources[n - 1])[off];
+			for (i = n - 1; i > 0; i--) {
+				uint8_t s = ((uint8_t *)sources[i - 1])[off];
+
+				vp ^= s;
+				vq = gf_mul2_u8(vq) ^ s;
+			}
+			dp[off] = vp;
+			dq[off] = vq;
+		}
+	}
+}
+
+#ifdef SPDK_CONFIG_ISAL
+#include "isa-l/include/raid.h"
+
+/* ISA-L picks the SSE, AVX2 or AVX-512 kernels at runtime, all of which work on 32B aligned buffers */
+#define SPDK_XOR_BUF_ALIGN 32
+#define SPDK_XOR_ISAL_MAX_SOURCES 64
+
+static int
+xor_gen_isal(void *dest, void **sources, uint32_t n, size_t len)
+{
+	void *buffers[SPDK_XOR_ISAL_MAX_SOURCES + 1];
+
+	if (n > SPDK_XOR_ISAL_MAX_SOURCES || len > INT_MAX ||
+	    !xor_buffers_aligned(dest, NULL, sources, n, len, SPDK_XOR_BUF_ALIGN)) {
+		xor_gen_basic(dest, sources, n, len);
+		return 0;
+	}
+
+	memcpy(buffers, sources, n * sizeof(buffers[0]));
+	buffers[n] = dest;
+
+	return xor_gen(n + 1, len, buffers) == 0 ? 0 : -EINVAL;
+}
+
+static int
+xor_gen_pq_isal(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	void *buffers[SPDK_XOR_ISAL_MAX_SOURCES + 2];
+
+	if (n > SPDK_XOR_ISAL_MAX_SOURCES || len > INT_MAX ||
+	    !xor_buffers_aligned(p, q, sources, n, len, SPDK_XOR_BUF_ALIGN)) {
+		xor_gen_pq_basic(p, q, sources, n, len);
+		return 0;
+	}
+
+	memcpy(buffers, sources, n * sizeof(buffers[0]));
+	buffers[n] = p;
+	buffers[n + 1] = q;
+
+	return pq_gen(n + 2, len, buffers) == 0 ? 0 : -EINVAL;
+}
+
+#define xor_gen_impl xor_gen_isal
+#define xor_gen_pq_impl xor_gen_pq_isal
+#else
+#define SPDK_XOR_BUF_ALIGN sizeof(uint64_t)
+
+static int
+xor_gen_impl(void *dest, void **sources, uint32_t n, size_t len)
+{
+	xor_gen_basic(dest, sources, n, len);
+	return 0;
+}
+
+static int
+xor_gen_pq_impl(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	xor_gen_pq_basic(p, q, sources, n, len);
+	return 0;
+}
+#endif
+
+int
+spdk_xor_gen(void *dest, void **sources, uint32_t n, size_t len)
+{
+	if (n < 2) {
+		return -EINVAL;
+	}
+
+	return xor_gen_impl(dest, sources, n, len);
+}
+
+int
+spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	if (n < 2) {
+		return -EINVAL;
+	}
+
+	return xor_gen_pq_impl(p, q, sources, n, len);
+}
+
+size_t
+spdk_xor_get_optimal_alignment(void)
+{
+	return SPDK_XOR_BUF_ALIGN;
+}
@@ -322,6 +322,14 @@ ifneq ($(CONFIG_NVME_CUSE)$(CONFIG_FUSE),nn)
 SYS_LIBS += -lfuse3
 endif
 
+ifeq ($(CONFIG_ZSTD),y)
+SYS_LIBS += -lzstd
+endif
+
+ifeq ($(CONFIG_LZ4),y)
+SYS_LIBS += -llz4
+endif
+
 ifeq ($(OS).$(CC_TYPE),Windows.gcc)
 # Include libssp.a for stack-protector and _FORTIFY_SOURCE
 SYS_LIBS += -l:libssp.a
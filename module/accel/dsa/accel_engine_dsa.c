@@ -268,6 +268,25 @@ queue_tasks:
 	return 0;
 }
 
+static int
+dsa_submit_batch(struct spdk_io_channel *ch, struct spdk_accel_task *first_task)
+{
+	struct idxd_io_channel *chan = spdk_io_channel_get_ctx(ch);
+	int rc;
+
+	rc = dsa_submit_tasks(ch, first_task);
+	if (rc != 0 || chan->state != IDXD_CHANNEL_ACTIVE) {
+		return rc;
+	}
+
+	/* Don't wait for the poller to submit the batch descriptor the tasks were put in.  If
+	 * there are no free descriptors, the poller submits it once some are completed.
+	 */
+	spdk_idxd_flush(chan->chan);
+
+	return 0;
+}
+
 static int
 idxd_poll(void *arg)
 {
@@ -332,7 +351,8 @@ static struct spdk_accel_module_if g_dsa_module = {
 	.name			= "dsa",
 	.supports_opcode	= dsa_supports_opcode,
 	.get_io_channel		= dsa_get_io_channel,
-	.submit_tasks		= dsa_submit_tasks
+	.submit_tasks		= dsa_submit_tasks,
+	.submit_batch		= dsa_submit_batch,
 };
 
 SPDK_ACCEL_MODULE_REGISTER(dsa, &g_dsa_module)
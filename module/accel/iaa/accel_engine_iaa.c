@@ -212,6 +212,23 @@ queue_tasks:
 	return 0;
 }
 
+static int
+iaa_submit_batch(struct spdk_io_channel *ch, struct spdk_accel_task *first_task)
+{
+	struct idxd_io_channel *chan = spdk_io_channel_get_ctx(ch);
+	int rc;
+
+	rc = iaa_submit_tasks(ch, first_task);
+	if (rc != 0 || chan->state != IDXD_CHANNEL_ACTIVE) {
+		return rc;
+	}
+
+	/* Same as for DSA, ring the doorbell now rather than on the next poll */
+	spdk_idxd_flush(chan->chan);
+
+	return 0;
+}
+
 static int
 idxd_poll(void *arg)
 {
@@ -272,7 +289,8 @@ static struct spdk_accel_module_if g_iaa_module = {
 	.name			= "iaa",
 	.supports_opcode	= iaa_supports_opcode,
 	.get_io_channel		= iaa_get_io_channel,
-	.submit_tasks		= iaa_submit_tasks
+	.submit_tasks		= iaa_submit_tasks,
+	.submit_batch		= iaa_submit_batch,
 };
 
 SPDK_ACCEL_MODULE_REGISTER(iaa, &g_iaa_module)
@@ -48,6 +48,7 @@ static int g_mbuf_offset;
 #define ISAL_PMD "compress_isal"
 #define QAT_PMD "compress_qat"
 #define MLX5_PMD "mlx5_pci"
+#define ACCEL_PMD "accel"
 #define NUM_MBUFS		8192
 #define POOL_CACHE_SIZE		256
 
@@ -91,6 +92,14 @@ struct vbdev_comp_op {
 	TAILQ_ENTRY(vbdev_comp_op)	link;
 };
 
+/* Context for a compression operation submitted to the accel framework */
+struct vbdev_comp_accel_op {
+	struct vbdev_compress			*comp_bdev;
+	struct spdk_reduce_vol_cb_args		*reduce_args;
+	uint32_t				output_size;
+	TAILQ_ENTRY(vbdev_comp_accel_op)	link;
+};
+
 struct vbdev_comp_delete_ctx {
 	spdk_delete_compress_complete	cb_fn;
 	void				*cb_arg;
@@ -107,6 +116,7 @@ struct vbdev_compress {
 	struct comp_io_channel		*comp_ch;	/* channel associated with this bdev */
 	char				*drv_name;	/* name of the compression device driver */
 	struct comp_device_qp		*device_qp;
+	struct spdk_io_channel		*accel_ch;	/* accel channel when drv_name is ACCEL_PMD */
 	struct spdk_thread		*reduce_thread;
 	pthread_mutex_t			reduce_lock;
 	uint32_t			ch_count;
@@ -119,6 +129,7 @@ struct vbdev_compress {
 	bool				orphaned;	/* base bdev claimed but comp_bdev not registered */
 	int				reduce_errno;
 	TAILQ_HEAD(, vbdev_comp_op)	queued_comp_ops;
+	TAILQ_HEAD(, vbdev_comp_accel_op)	free_accel_ops;
 	TAILQ_ENTRY(vbdev_compress)	link;
 	struct spdk_thread		*thread;	/* thread where base device is opened */
 };
@@ -173,12 +184,44 @@ static struct rte_comp_xform g_decomp_xform = {
 
 static void vbdev_compress_examine(struct spdk_bdev *bdev);
 static int vbdev_compress_claim(struct vbdev_compress *comp_bdev);
+static void _comp_resubmit_queued_op(struct vbdev_compress *comp_bdev);
 static void vbdev_compress_queue_io(struct spdk_bdev_io *bdev_io);
 struct vbdev_compress *_prepare_for_load_init(struct spdk_bdev_desc *bdev_desc, uint32_t lb_size);
 static void vbdev_compress_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
 static void comp_bdev_ch_destroy_cb(void *io_device, void *ctx_buf);
 static void vbdev_compress_delete_done(void *cb_arg, int bdeverrno);
 
+static const char *g_comp_algo_names[SPDK_ACCEL_COMP_ALGO_LAST] = {
+	[SPDK_ACCEL_COMP_ALGO_DEFLATE] = "deflate",
+	[SPDK_ACCEL_COMP_ALGO_LZ4] = "lz4",
+	[SPDK_ACCEL_COMP_ALGO_ZSTD] = "zstd",
+};
+
+const char *
+compress_get_algo_name(enum spdk_accel_comp_algo algo)
+{
+	if (algo >= SPDK_ACCEL_COMP_ALGO_LAST) {
+		return NULL;
+	}
+
+	return g_comp_algo_names[algo];
+}
+
+int
+compress_parse_algo_name(const char *name, enum spdk_accel_comp_algo *algo)
+{
+	int i;
+
+	for (i = 0; i < SPDK_ACCEL_COMP_ALGO_LAST; i++) {
+		if (strcmp(name, g_comp_algo_names[i]) == 0) {
+			*algo = i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
 /* Dummy function used by DPDK to free ext attached buffers
  * to mbufs, we free them ourselves but this callback has to
  * be here.
@@ -500,6 +543,97 @@ _setup_compress_mbuf(struct rte_mbuf **mbufs, int *mbuf_total, uint64_t *total_l
 	return 0;
 }
 
+static int
+_queue_comp_op(struct spdk_reduce_backing_dev *backing_dev, struct iovec *src_iovs,
+	       int src_iovcnt, struct iovec *dst_iovs,
+	       int dst_iovcnt, bool compress, void *cb_arg)
+{
+	struct vbdev_compress *comp_bdev = SPDK_CONTAINEROF(backing_dev, struct vbdev_compress,
+					   backing_dev);
+	struct vbdev_comp_op *op_to_queue;
+
+	op_to_queue = calloc(1, sizeof(struct vbdev_comp_op));
+	if (op_to_queue == NULL) {
+		SPDK_ERRLOG("unable to allocate operation for queueing.\n");
+		return -ENOMEM;
+	}
+	op_to_queue->backing_dev = backing_dev;
+	op_to_queue->src_iovs = src_iovs;
+	op_to_queue->src_iovcnt = src_iovcnt;
+	op_to_queue->dst_iovs = dst_iovs;
+	op_to_queue->dst_iovcnt = dst_iovcnt;
+	op_to_queue->compress = compress;
+	op_to_queue->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&comp_bdev->queued_comp_ops,
+			  op_to_queue,
+			  link);
+	return 0;
+}
+
+/* Completion callback for operations submitted to the accel framework. */
+static void
+_accel_comp_done(void *cb_arg, int status)
+{
+	struct vbdev_comp_accel_op *op = cb_arg;
+	struct vbdev_compress *comp_bdev = op->comp_bdev;
+	struct spdk_reduce_vol_cb_args *reduce_args = op->reduce_args;
+	uint32_t output_size = op->output_size;
+
+	TAILQ_INSERT_HEAD(&comp_bdev->free_accel_ops, op, link);
+
+	/* Reduce will simply store uncompressed on neg errno value, which is what
+	 * happens to incompressible chunks (-ENOSPC).
+	 */
+	reduce_args->cb_fn(reduce_args->cb_arg, status == 0 ? (int)output_size : status);
+
+	_comp_resubmit_queued_op(comp_bdev);
+}
+
+static int
+_accel_compress_operation(struct vbdev_compress *comp_bdev, struct iovec *src_iovs,
+			  int src_iovcnt, struct iovec *dst_iovs, int dst_iovcnt,
+			  bool compress, struct spdk_reduce_vol_cb_args *reduce_args)
+{
+	struct spdk_accel_comp_opts opts = {};
+	struct vbdev_comp_accel_op *op;
+	int rc;
+
+	op = TAILQ_FIRST(&comp_bdev->free_accel_ops);
+	if (op != NULL) {
+		TAILQ_REMOVE(&comp_bdev->free_accel_ops, op, link);
+	} else {
+		op = calloc(1, sizeof(*op));
+		if (op == NULL) {
+			return -ENOMEM;
+		}
+	}
+	op->comp_bdev = comp_bdev;
+	op->reduce_args = reduce_args;
+	op->output_size = 0;
+
+	/* The algorithm is persisted in the volume's params, so a volume is always
+	 * decompressed with the algorithm it was written with.
+	 */
+	opts.size = sizeof(opts);
+	opts.algo = comp_bdev->params.comp_algo;
+	opts.level = comp_bdev->params.comp_level;
+
+	if (compress == true) {
+		rc = spdk_accel_submit_compress_ext(comp_bdev->accel_ch, dst_iovs, dst_iovcnt,
+						    src_iovs, src_iovcnt, &op->output_size, &opts, 0,
+						    _accel_comp_done, op);
+	} else {
+		rc = spdk_accel_submit_decompress_ext(comp_bdev->accel_ch, dst_iovs, dst_iovcnt,
+						      src_iovs, src_iovcnt, &op->output_size, &opts, 0,
+						      _accel_comp_done, op);
+	}
+	if (rc != 0) {
+		TAILQ_INSERT_HEAD(&comp_bdev->free_accel_ops, op, link);
+	}
+
+	return rc;
+}
+
 static int
 _compress_operation(struct spdk_reduce_backing_dev *backing_dev, struct iovec *src_iovs,
 		    int src_iovcnt, struct iovec *dst_iovs,
@@ -511,14 +645,24 @@ _compress_operation(struct spdk_reduce_backing_dev *backing_dev, struct iovec *s
 	struct rte_comp_op *comp_op;
 	struct rte_mbuf *src_mbufs[MAX_MBUFS_PER_OP];
 	struct rte_mbuf *dst_mbufs[MAX_MBUFS_PER_OP];
-	uint8_t cdev_id = comp_bdev->device_qp->device->cdev_id;
+	uint8_t cdev_id;
 	uint64_t total_length = 0;
 	int rc = 0;
-	struct vbdev_comp_op *op_to_queue;
 	int src_mbuf_total = src_iovcnt;
 	int dst_mbuf_total = dst_iovcnt;
 	bool device_error = false;
 
+	if (comp_bdev->accel_ch != NULL) {
+		rc = _accel_compress_operation(comp_bdev, src_iovs, src_iovcnt, dst_iovs, dst_iovcnt,
+					       compress, reduce_cb_arg);
+		if (rc != -ENOMEM) {
+			return rc;
+		}
+		return _queue_comp_op(backing_dev, src_iovs, src_iovcnt, dst_iovs, dst_iovcnt,
+				      compress, cb_arg);
+	}
+
+	cdev_id = comp_bdev->device_qp->device->cdev_id;
 	assert(src_iovcnt < MAX_MBUFS_PER_OP);
 
 #ifdef DEBUG
@@ -635,22 +779,33 @@ error_get_op:
 		return rc;
 	}
 
-	op_to_queue = calloc(1, sizeof(struct vbdev_comp_op));
-	if (op_to_queue == NULL) {
-		SPDK_ERRLOG("unable to allocate operation for queueing.\n");
-		return -ENOMEM;
+	return _queue_comp_op(backing_dev, src_iovs, src_iovcnt, dst_iovs, dst_iovcnt,
+			      compress, cb_arg);
+}
+
+/* Check if there are any pending comp ops to process, only pull one
+ * at a time off as _compress_operation() may re-queue the op.
+ */
+static void
+_comp_resubmit_queued_op(struct vbdev_compress *comp_bdev)
+{
+	struct vbdev_comp_op *op_to_resubmit;
+	int rc;
+
+	if (!TAILQ_EMPTY(&comp_bdev->queued_comp_ops)) {
+		op_to_resubmit = TAILQ_FIRST(&comp_bdev->queued_comp_ops);
+		rc = _compress_operation(op_to_resubmit->backing_dev,
+					 op_to_resubmit->src_iovs,
+					 op_to_resubmit->src_iovcnt,
+					 op_to_resubmit->dst_iovs,
+					 op_to_resubmit->dst_iovcnt,
+					 op_to_resubmit->compress,
+					 op_to_resubmit->cb_arg);
+		if (rc == 0) {
+			TAILQ_REMOVE(&comp_bdev->queued_comp_ops, op_to_resubmit, link);
+			free(op_to_resubmit);
+		}
 	}
-	op_to_queue->backing_dev = backing_dev;
-	op_to_queue->src_iovs = src_iovs;
-	op_to_queue->src_iovcnt = src_iovcnt;
-	op_to_queue->dst_iovs = dst_iovs;
-	op_to_queue->dst_iovcnt = dst_iovcnt;
-	op_to_queue->compress = compress;
-	op_to_queue->cb_arg = cb_arg;
-	TAILQ_INSERT_TAIL(&comp_bdev->queued_comp_ops,
-			  op_to_queue,
-			  link);
-	return 0;
 }
 
 /* Poller for the DPDK compression driver. */
@@ -662,8 +817,7 @@ comp_dev_poller(void *args)
 	struct rte_comp_op *deq_ops[NUM_MAX_INFLIGHT_OPS];
 	uint16_t num_deq;
 	struct spdk_reduce_vol_cb_args *reduce_args;
-	struct vbdev_comp_op *op_to_resubmit;
-	int rc, i;
+	int i;
 
 	num_deq = rte_compressdev_dequeue_burst(cdev_id, comp_bdev->device_qp->qp, deq_ops,
 						NUM_MAX_INFLIGHT_OPS);
@@ -695,23 +849,7 @@ comp_dev_poller(void *args)
 		 */
 		rte_comp_op_free(deq_ops[i]);
 
-		/* Check if there are any pending comp ops to process, only pull one
-		 * at a time off as _compress_operation() may re-queue the op.
-		 */
-		if (!TAILQ_EMPTY(&comp_bdev->queued_comp_ops)) {
-			op_to_resubmit = TAILQ_FIRST(&comp_bdev->queued_comp_ops);
-			rc = _compress_operation(op_to_resubmit->backing_dev,
-						 op_to_resubmit->src_iovs,
-						 op_to_resubmit->src_iovcnt,
-						 op_to_resubmit->dst_iovs,
-						 op_to_resubmit->dst_iovcnt,
-						 op_to_resubmit->compress,
-						 op_to_resubmit->cb_arg);
-			if (rc == 0) {
-				TAILQ_REMOVE(&comp_bdev->queued_comp_ops, op_to_resubmit, link);
-				free(op_to_resubmit);
-			}
-		}
+		_comp_resubmit_queued_op(comp_bdev);
 	}
 	return num_deq == 0 ? SPDK_POLLER_IDLE : SPDK_POLLER_BUSY;
 }
@@ -1084,6 +1222,9 @@ vbdev_compress_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(&comp_bdev->comp_bdev));
 	spdk_json_write_named_string(w, "base_bdev_name", spdk_bdev_get_name(comp_bdev->base_bdev));
 	spdk_json_write_named_string(w, "compression_pmd", comp_bdev->drv_name);
+	spdk_json_write_named_string(w, "comp_algo",
+				     compress_get_algo_name(comp_bdev->params.comp_algo));
+	spdk_json_write_named_int32(w, "comp_level", comp_bdev->params.comp_level);
 	spdk_json_write_object_end(w);
 
 	return 0;
@@ -1344,7 +1485,23 @@ _prepare_for_load_init(struct spdk_bdev_desc *bdev_desc, uint32_t lb_size)
 static bool
 _set_pmd(struct vbdev_compress *comp_dev)
 {
-	if (g_opts == COMPRESS_PMD_AUTO) {
+	if (comp_dev->params.comp_algo >= SPDK_ACCEL_COMP_ALGO_LAST) {
+		SPDK_ERRLOG("Unknown compression algorithm %u.\n", comp_dev->params.comp_algo);
+		return false;
+	}
+
+	/* The DPDK compressdev PMDs are only set up for deflate, anything else
+	 * has to go through the accel framework.
+	 */
+	if (comp_dev->params.comp_algo != SPDK_ACCEL_COMP_ALGO_DEFLATE ||
+	    g_opts == COMPRESS_PMD_ACCEL_ONLY) {
+		if (!spdk_accel_comp_algo_supported(comp_dev->params.comp_algo)) {
+			SPDK_ERRLOG("Compression algorithm %s is not supported by accel.\n",
+				    compress_get_algo_name(comp_dev->params.comp_algo));
+			return false;
+		}
+		comp_dev->drv_name = ACCEL_PMD;
+	} else if (g_opts == COMPRESS_PMD_AUTO) {
 		if (g_qat_available) {
 			comp_dev->drv_name = QAT_PMD;
 		} else if (g_mlx5_pci_available) {
@@ -1368,7 +1525,8 @@ _set_pmd(struct vbdev_compress *comp_dev)
 
 /* Call reducelib to initialize a new volume */
 static int
-vbdev_init_reduce(const char *bdev_name, const char *pm_path, uint32_t lb_size)
+vbdev_init_reduce(const char *bdev_name, const char *pm_path, uint32_t lb_size,
+		  enum spdk_accel_comp_algo comp_algo, int32_t comp_level)
 {
 	struct spdk_bdev_desc *bdev_desc = NULL;
 	struct vbdev_compress *meta_ctx;
@@ -1387,6 +1545,9 @@ vbdev_init_reduce(const char *bdev_name, const char *pm_path, uint32_t lb_size)
 		return -EINVAL;
 	}
 
+	meta_ctx->params.comp_algo = comp_algo;
+	meta_ctx->params.comp_level = comp_level;
+
 	if (_set_pmd(meta_ctx) == false) {
 		SPDK_ERRLOG("could not find required pmd\n");
 		free(meta_ctx);
@@ -1406,6 +1567,28 @@ vbdev_init_reduce(const char *bdev_name, const char *pm_path, uint32_t lb_size)
 	return 0;
 }
 
+static void
+_comp_bdev_assign_qp(struct vbdev_compress *comp_bdev)
+{
+	struct comp_device_qp *device_qp;
+
+	pthread_mutex_lock(&g_comp_device_qp_lock);
+	TAILQ_FOREACH(device_qp, &g_comp_device_qp, link) {
+		if (strcmp(device_qp->device->cdev_info.driver_name, comp_bdev->drv_name) == 0) {
+			if (device_qp->thread == spdk_get_thread()) {
+				comp_bdev->device_qp = device_qp;
+				break;
+			}
+			if (device_qp->thread == NULL) {
+				comp_bdev->device_qp = device_qp;
+				device_qp->thread = spdk_get_thread();
+				break;
+			}
+		}
+	}
+	pthread_mutex_unlock(&g_comp_device_qp_lock);
+}
+
 /* We provide this callback for the SPDK channel code to create a channel using
  * the channel struct we provided in our module get_io_channel() entry point. Here
  * we get and save off an underlying base channel of the device below us so that
@@ -1416,7 +1599,7 @@ static int
 comp_bdev_ch_create_cb(void *io_device, void *ctx_buf)
 {
 	struct vbdev_compress *comp_bdev = io_device;
-	struct comp_device_qp *device_qp;
+	bool use_accel = strcmp(comp_bdev->drv_name, ACCEL_PMD) == 0;
 
 	/* Now set the reduce channel if it's not already set. */
 	pthread_mutex_lock(&comp_bdev->reduce_lock);
@@ -1429,28 +1612,29 @@ comp_bdev_ch_create_cb(void *io_device, void *ctx_buf)
 
 		comp_bdev->base_ch = spdk_bdev_get_io_channel(comp_bdev->base_desc);
 		comp_bdev->reduce_thread = spdk_get_thread();
-		comp_bdev->poller = SPDK_POLLER_REGISTER(comp_dev_poller, comp_bdev, 0);
-		/* Now assign a q pair */
-		pthread_mutex_lock(&g_comp_device_qp_lock);
-		TAILQ_FOREACH(device_qp, &g_comp_device_qp, link) {
-			if (strcmp(device_qp->device->cdev_info.driver_name, comp_bdev->drv_name) == 0) {
-				if (device_qp->thread == spdk_get_thread()) {
-					comp_bdev->device_qp = device_qp;
-					break;
-				}
-				if (device_qp->thread == NULL) {
-					comp_bdev->device_qp = device_qp;
-					device_qp->thread = spdk_get_thread();
-					break;
-				}
-			}
+		if (use_accel) {
+			/* The accel framework completes operations from its own pollers. */
+			TAILQ_INIT(&comp_bdev->free_accel_ops);
+			comp_bdev->accel_ch = spdk_accel_engine_get_io_channel();
+		} else {
+			comp_bdev->poller = SPDK_POLLER_REGISTER(comp_dev_poller, comp_bdev, 0);
+			/* Now assign a q pair */
+			_comp_bdev_assign_qp(comp_bdev);
 		}
-		pthread_mutex_unlock(&g_comp_device_qp_lock);
 	}
 	comp_bdev->ch_count++;
 	pthread_mutex_unlock(&comp_bdev->reduce_lock);
 
-	if (comp_bdev->device_qp != NULL) {
+	if (use_accel) {
+		if (comp_bdev->accel_ch == NULL) {
+			SPDK_ERRLOG("could not get accel channel for comp_bdev %p\n", comp_bdev);
+			return -ENOMEM;
+		}
+		/* Accel engines walk the iovecs themselves. */
+		comp_bdev->backing_dev.sgl_in = true;
+		comp_bdev->backing_dev.sgl_out = true;
+		return 0;
+	} else if (comp_bdev->device_qp != NULL) {
 		uint64_t comp_feature_flags =
 			comp_bdev->device_qp->device->cdev_info.capabilities[RTE_COMP_ALGO_DEFLATE].comp_feature_flags;
 
@@ -1475,9 +1659,20 @@ _channel_cleanup(struct vbdev_compress *comp_bdev)
 	 * on the same thread so we leave the device_qp element
 	 * alone for this comp_bdev and just clear the reduce thread.
 	 */
+	struct vbdev_comp_accel_op *op;
+
 	spdk_put_io_channel(comp_bdev->base_ch);
 	comp_bdev->reduce_thread = NULL;
 	spdk_poller_unregister(&comp_bdev->poller);
+
+	if (comp_bdev->accel_ch != NULL) {
+		spdk_put_io_channel(comp_bdev->accel_ch);
+		comp_bdev->accel_ch = NULL;
+		while ((op = TAILQ_FIRST(&comp_bdev->free_accel_ops))) {
+			TAILQ_REMOVE(&comp_bdev->free_accel_ops, op, link);
+			free(op);
+		}
+	}
 }
 
 /* Used to reroute destroy_ch to the correct thread */
@@ -1516,7 +1711,8 @@ comp_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
 
 /* RPC entry point for compression vbdev creation. */
 int
-create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_size)
+create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_size,
+		     enum spdk_accel_comp_algo comp_algo, int32_t comp_level)
 {
 	struct vbdev_compress *comp_bdev = NULL;
 
@@ -1525,13 +1721,23 @@ create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_siz
 		return -EINVAL;
 	}
 
+	if (comp_algo >= SPDK_ACCEL_COMP_ALGO_LAST) {
+		SPDK_ERRLOG("Unknown compression algorithm %d\n", comp_algo);
+		return -EINVAL;
+	}
+
+	if (comp_level < INT16_MIN || comp_level > INT16_MAX) {
+		SPDK_ERRLOG("Compression level %d out of range\n", comp_level);
+		return -EINVAL;
+	}
+
 	TAILQ_FOREACH(comp_bdev, &g_vbdev_comp, link) {
 		if (strcmp(bdev_name, comp_bdev->base_bdev->name) == 0) {
 			SPDK_ERRLOG("Bass bdev %s already being used for a compress bdev\n", bdev_name);
 			return -EBUSY;
 		}
 	}
-	return vbdev_init_reduce(bdev_name, pm_path, lb_size);
+	return vbdev_init_reduce(bdev_name, pm_path, lb_size, comp_algo, comp_level);
 }
 
 /* On init, just init the compress drivers. All metadata is stored on disk. */
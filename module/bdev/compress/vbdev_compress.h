@@ -10,6 +10,7 @@
 #include "spdk/stdinc.h"
 
 #include "spdk/bdev.h"
+#include "spdk/accel.h"
 
 #define LB_SIZE_4K	0x1000UL
 #define LB_SIZE_512B	0x200UL
@@ -50,6 +51,7 @@ enum compress_pmd {
 	COMPRESS_PMD_QAT_ONLY,
 	COMPRESS_PMD_ISAL_ONLY,
 	COMPRESS_PMD_MLX5_PCI_ONLY,
+	COMPRESS_PMD_ACCEL_ONLY,
 	COMPRESS_PMD_MAX
 };
 
@@ -65,7 +67,25 @@ typedef void (*spdk_delete_compress_complete)(void *cb_arg, int bdeverrno);
  * \param lb_size Logical block size for the compressed volume in bytes. Must be 4K or 512.
  * \return 0 on success, other on failure.
  */
-int create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_size);
+/**
+ * Get the name of a compression algorithm as used by the RPC interface.
+ *
+ * \param algo Compression algorithm.
+ * \return name of the algorithm, or NULL if algo is invalid.
+ */
+const char *compress_get_algo_name(enum spdk_accel_comp_algo algo);
+
+/**
+ * Parse the name of a compression algorithm.
+ *
+ * \param name Name of the algorithm.
+ * \param algo Set to the matching algorithm on success.
+ * \return 0 on success, -EINVAL if the name is unknown.
+ */
+int compress_parse_algo_name(const char *name, enum spdk_accel_comp_algo *algo);
+
+int create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_size,
+			 enum spdk_accel_comp_algo comp_algo, int32_t comp_level);
 
 /**
  * Delete compress bdev.
@@ -116,6 +116,8 @@ struct rpc_construct_compress {
 	char *base_bdev_name;
 	char *pm_path;
 	uint32_t lb_size;
+	enum spdk_accel_comp_algo comp_algo;
+	int32_t comp_level;
 };
 
 /* Free the allocated memory resource after the RPC handling. */
@@ -126,11 +128,31 @@ free_rpc_construct_compress(struct rpc_construct_compress *r)
 	free(r->pm_path);
 }
 
+static int
+rpc_decode_comp_algo(const struct spdk_json_val *val, void *out)
+{
+	enum spdk_accel_comp_algo *algo = out;
+	char *name = NULL;
+	int rc;
+
+	rc = spdk_json_decode_string(val, &name);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = compress_parse_algo_name(name, algo);
+	free(name);
+
+	return rc;
+}
+
 /* Structure to decode the input parameters for this RPC method. */
 static const struct spdk_json_object_decoder rpc_construct_compress_decoders[] = {
 	{"base_bdev_name", offsetof(struct rpc_construct_compress, base_bdev_name), spdk_json_decode_string},
 	{"pm_path", offsetof(struct rpc_construct_compress, pm_path), spdk_json_decode_string},
 	{"lb_size", offsetof(struct rpc_construct_compress, lb_size), spdk_json_decode_uint32, true},
+	{"comp_algo", offsetof(struct rpc_construct_compress, comp_algo), rpc_decode_comp_algo, true},
+	{"comp_level", offsetof(struct rpc_construct_compress, comp_level), spdk_json_decode_int32, true},
 };
 
 /* Decode the parameters for this RPC method and properly construct the compress
@@ -154,7 +176,8 @@ rpc_bdev_compress_create(struct spdk_jsonrpc_request *request,
 		goto cleanup;
 	}
 
-	rc = create_compress_bdev(req.base_bdev_name, req.pm_path, req.lb_size);
+	rc = create_compress_bdev(req.base_bdev_name, req.pm_path, req.lb_size, req.comp_algo,
+				  req.comp_level);
 	if (rc != 0) {
 		if (rc == -EBUSY) {
 			spdk_jsonrpc_send_error_response(request, rc, "Base bdev already in use for compression.");
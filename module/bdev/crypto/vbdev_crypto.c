@@ -7,6 +7,7 @@
 
 #include "vbdev_crypto.h"
 
+#include "spdk/accel.h"
 #include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/endian.h"
@@ -33,7 +34,7 @@ static int g_mbuf_offset;
  * Note that the string names are defined by the DPDK PMD in question so be
  * sure to use the exact names.
  */
-#define MAX_NUM_DRV_TYPES 3
+#define MAX_NUM_DRV_TYPES 4
 
 /* The VF spread is the number of queue pairs between virtual functions, we use this to
  * load balance the QAT device.
@@ -42,7 +43,7 @@ static int g_mbuf_offset;
 static uint8_t g_qat_total_qp = 0;
 static uint8_t g_next_qat_index;
 
-const char *g_driver_names[MAX_NUM_DRV_TYPES] = { AESNI_MB, QAT, MLX5 };
+const char *g_driver_names[MAX_NUM_DRV_TYPES] = { AESNI_MB, QAT, MLX5, ACCEL_CRYPTO };
 
 /* Global list of available crypto devices. */
 struct vbdev_dev {
@@ -149,6 +150,7 @@ struct vbdev_crypto {
 	struct rte_cryptodev_sym_session *session_encrypt;	/* encryption session for this bdev */
 	struct rte_cryptodev_sym_session *session_decrypt;	/* decryption session for this bdev */
 	struct rte_crypto_sym_xform	cipher_xform;		/* crypto control struct for this bdev */
+	struct spdk_accel_crypto_key	*accel_key;		/* key used with ACCEL_CRYPTO */
 	TAILQ_ENTRY(vbdev_crypto)	link;
 	struct spdk_thread		*thread;		/* thread where base device is opened */
 };
@@ -184,6 +186,7 @@ struct crypto_io_channel {
 	struct spdk_io_channel		*base_ch;		/* IO channel of base device */
 	struct spdk_poller		*poller;		/* completion poller */
 	struct device_qp		*device_qp;		/* unique device/qp combination for this channel */
+	struct spdk_io_channel		*accel_channel;		/* accel channel used with ACCEL_CRYPTO */
 	TAILQ_HEAD(, spdk_bdev_io)	pending_cry_ios;	/* outstanding operations to the crypto device */
 	struct spdk_io_channel_iter	*iter;			/* used with for_each_channel in reset */
 	TAILQ_HEAD(, vbdev_crypto_op)	queued_cry_ops;		/* queued for re-submission to CryptoDev */
@@ -828,6 +831,75 @@ mbuf_attach_buf(struct spdk_bdev_io *bdev_io, struct rte_mbuf *mbuf,
 	return phys_len;
 }
 
+static void
+_crypto_accel_operation_done(void *cb_arg, int status)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+	struct crypto_bdev_io *io_ctx = (struct crypto_bdev_io *)bdev_io->driver_ctx;
+	struct crypto_io_channel *crypto_ch = io_ctx->crypto_ch;
+
+	/* Same as with crypto_dev_poller(), fail the IO if there's an outstanding reset. */
+	if (status != 0 || crypto_ch->iter != NULL) {
+		io_ctx->bdev_io_status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	_crypto_operation_complete(bdev_io);
+
+	if (crypto_ch->iter && TAILQ_EMPTY(&crypto_ch->pending_cry_ios)) {
+		SPDK_NOTICELOG("Channel %p has been quiesced.\n", crypto_ch);
+		spdk_for_each_channel_continue(crypto_ch->iter, 0);
+		crypto_ch->iter = NULL;
+	}
+}
+
+/* With ACCEL_CRYPTO the whole bdev_io is a single accel operation using the LBA of its first
+ * block as the IV, the accel engine increments it for each following block.  Unlike with
+ * cryptodev, there are no mbufs or crypto ops to allocate.
+ */
+static int
+_crypto_accel_operation(struct spdk_bdev_io *bdev_io, enum rte_crypto_cipher_operation crypto_op,
+			void *aux_buf)
+{
+	struct crypto_bdev_io *io_ctx = (struct crypto_bdev_io *)bdev_io->driver_ctx;
+	struct crypto_io_channel *crypto_ch = io_ctx->crypto_ch;
+	struct vbdev_crypto *crypto_bdev = io_ctx->crypto_bdev;
+	uint32_t crypto_len = crypto_bdev->crypto_bdev.blocklen;
+	uint64_t alignment = spdk_bdev_get_buf_align(&crypto_bdev->crypto_bdev);
+	int rc;
+
+	TAILQ_INSERT_TAIL(&crypto_ch->pending_cry_ios, bdev_io, module_link);
+	io_ctx->on_pending_list = true;
+
+	if (crypto_op == RTE_CRYPTO_CIPHER_OP_ENCRYPT) {
+		/* Encrypt into the aux buffer, just like with cryptodev. */
+		io_ctx->aux_buf_iov.iov_len = bdev_io->u.bdev.num_blocks * crypto_len;
+		io_ctx->aux_buf_raw = aux_buf;
+		io_ctx->aux_buf_iov.iov_base = (void *)(((uintptr_t)aux_buf + (alignment - 1)) &
+							~(alignment - 1));
+		io_ctx->aux_offset_blocks = bdev_io->u.bdev.offset_blocks;
+		io_ctx->aux_num_blocks = bdev_io->u.bdev.num_blocks;
+
+		rc = spdk_accel_submit_encrypt(crypto_ch->accel_channel, crypto_bdev->accel_key,
+					       &io_ctx->aux_buf_iov, 1,
+					       bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					       bdev_io->u.bdev.offset_blocks, crypto_len, 0,
+					       _crypto_accel_operation_done, bdev_io);
+	} else {
+		rc = spdk_accel_submit_decrypt(crypto_ch->accel_channel, crypto_bdev->accel_key,
+					       bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					       bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					       bdev_io->u.bdev.offset_blocks, crypto_len, 0,
+					       _crypto_accel_operation_done, bdev_io);
+	}
+
+	if (rc != 0) {
+		TAILQ_REMOVE(&crypto_ch->pending_cry_ios, bdev_io, module_link);
+		io_ctx->on_pending_list = false;
+	}
+
+	return rc;
+}
+
 /* We're either encrypting on the way down or decrypting on the way back. */
 static int
 _crypto_operation(struct spdk_bdev_io *bdev_io, enum rte_crypto_cipher_operation crypto_op,
@@ -837,7 +909,7 @@ _crypto_operation(struct spdk_bdev_io *bdev_io, enum rte_crypto_cipher_operation
 	uint32_t cryop_cnt = bdev_io->u.bdev.num_blocks;
 	struct crypto_bdev_io *io_ctx = (struct crypto_bdev_io *)bdev_io->driver_ctx;
 	struct crypto_io_channel *crypto_ch = io_ctx->crypto_ch;
-	uint8_t cdev_id = crypto_ch->device_qp->device->cdev_id;
+	uint8_t cdev_id;
 	uint32_t crypto_len = io_ctx->crypto_bdev->crypto_bdev.blocklen;
 	uint64_t total_length = bdev_io->u.bdev.num_blocks * crypto_len;
 	int rc;
@@ -857,6 +929,11 @@ _crypto_operation(struct spdk_bdev_io *bdev_io, enum rte_crypto_cipher_operation
 
 	assert((bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen) <= CRYPTO_MAX_IO);
 
+	if (crypto_ch->accel_channel != NULL) {
+		return _crypto_accel_operation(bdev_io, crypto_op, aux_buf);
+	}
+	cdev_id = crypto_ch->device_qp->device->cdev_id;
+
 	/* Get the number of source mbufs that we need. These will always be 1:1 because we
 	 * don't support chaining. The reason we don't is because of our decision to use
 	 * LBA as IV, there can be no case where we'd need >1 mbuf per crypto op or the
@@ -1113,6 +1190,14 @@ _ch_quiesce(struct spdk_io_channel_iter *i)
 	struct crypto_io_channel *crypto_ch = spdk_io_channel_get_ctx(ch);
 
 	crypto_ch->iter = i;
+
+	/* Accel channels have no poller, their completions check the iter instead. */
+	if (crypto_ch->accel_channel != NULL && TAILQ_EMPTY(&crypto_ch->pending_cry_ios)) {
+		crypto_ch->iter = NULL;
+		spdk_for_each_channel_continue(i, 0);
+		return;
+	}
+
 	/* When the poller runs, it will see the non-NULL iter and handle
 	 * the quiesce.
 	 */
@@ -1370,8 +1455,12 @@ _device_unregister_cb(void *io_device)
 	struct vbdev_crypto *crypto_bdev = io_device;
 
 	/* Done with this crypto_bdev. */
-	rte_cryptodev_sym_session_free(crypto_bdev->session_decrypt);
-	rte_cryptodev_sym_session_free(crypto_bdev->session_encrypt);
+	if (crypto_bdev->accel_key != NULL) {
+		spdk_accel_crypto_key_destroy(crypto_bdev->accel_key);
+	} else {
+		rte_cryptodev_sym_session_free(crypto_bdev->session_decrypt);
+		rte_cryptodev_sym_session_free(crypto_bdev->session_encrypt);
+	}
 	crypto_bdev->opts = NULL;
 	free(crypto_bdev->crypto_bdev.name);
 	free(crypto_bdev);
@@ -1590,12 +1679,23 @@ crypto_bdev_ch_create_cb(void *io_device, void *ctx_buf)
 	struct device_qp *device_qp = NULL;
 
 	crypto_ch->base_ch = spdk_bdev_get_io_channel(crypto_bdev->base_desc);
-	crypto_ch->poller = SPDK_POLLER_REGISTER(crypto_dev_poller, crypto_ch, 0);
 	crypto_ch->device_qp = NULL;
 
-	/* Assign a device/qp combination that is unique per channel per PMD. */
-	_assign_device_qp(crypto_bdev, device_qp, crypto_ch);
-	assert(crypto_ch->device_qp);
+	if (crypto_bdev->accel_key != NULL) {
+		/* The accel framework completes the operations, no need for a poller. */
+		crypto_ch->accel_channel = spdk_accel_engine_get_io_channel();
+		if (crypto_ch->accel_channel == NULL) {
+			SPDK_ERRLOG("Failed to get accel channel\n");
+			spdk_put_io_channel(crypto_ch->base_ch);
+			return -ENOMEM;
+		}
+	} else {
+		crypto_ch->poller = SPDK_POLLER_REGISTER(crypto_dev_poller, crypto_ch, 0);
+
+		/* Assign a device/qp combination that is unique per channel per PMD. */
+		_assign_device_qp(crypto_bdev, device_qp, crypto_ch);
+		assert(crypto_ch->device_qp);
+	}
 
 	/* We use this queue to track outstanding IO in our layer. */
 	TAILQ_INIT(&crypto_ch->pending_cry_ios);
@@ -1615,11 +1715,15 @@ crypto_bdev_ch_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct crypto_io_channel *crypto_ch = ctx_buf;
 
-	pthread_mutex_lock(&g_device_qp_lock);
-	crypto_ch->device_qp->in_use = false;
-	pthread_mutex_unlock(&g_device_qp_lock);
+	if (crypto_ch->accel_channel != NULL) {
+		spdk_put_io_channel(crypto_ch->accel_channel);
+	} else {
+		pthread_mutex_lock(&g_device_qp_lock);
+		crypto_ch->device_qp->in_use = false;
+		pthread_mutex_unlock(&g_device_qp_lock);
 
-	spdk_poller_unregister(&crypto_ch->poller);
+		spdk_poller_unregister(&crypto_ch->poller);
+	}
 	spdk_put_io_channel(crypto_ch->base_ch);
 }
 
@@ -1841,6 +1945,32 @@ static struct spdk_bdev_module crypto_if = {
 
 SPDK_BDEV_MODULE_REGISTER(crypto, &crypto_if)
 
+/* Create the key for the accel framework, it's used in place of the cryptodev sessions. */
+static int
+vbdev_crypto_accel_key_create(struct vbdev_crypto *vbdev)
+{
+	struct spdk_accel_crypto_key_create_param param = {
+		.cipher = ACCEL_AES_XTS,
+		.key = vbdev->opts->key,
+		.key_size = vbdev->opts->key_size,
+		.key2 = vbdev->opts->key2,
+		.key2_size = vbdev->opts->key2_size,
+	};
+	int rc;
+
+	if (strcmp(vbdev->opts->cipher, AES_XTS) != 0) {
+		SPDK_ERRLOG("Invalid cipher name %s for %s.\n", vbdev->opts->cipher, ACCEL_CRYPTO);
+		return -EINVAL;
+	}
+
+	rc = spdk_accel_crypto_key_create(&param, &vbdev->accel_key);
+	if (rc) {
+		SPDK_ERRLOG("Failed to create accel crypto key: error %d\n", rc);
+	}
+
+	return rc;
+}
+
 static int
 vbdev_crypto_claim(const char *bdev_name)
 {
@@ -1910,6 +2040,9 @@ vbdev_crypto_claim(const char *bdev_name)
 		} else if (strcmp(name->opts->drv_name, MLX5) == 0) {
 			vbdev->crypto_bdev.required_alignment = bdev->required_alignment;
 			SPDK_NOTICELOG("MLX5 using cipher: %s\n", name->opts->cipher);
+		} else if (strcmp(name->opts->drv_name, ACCEL_CRYPTO) == 0) {
+			vbdev->crypto_bdev.required_alignment = bdev->required_alignment;
+			SPDK_NOTICELOG("Accel framework using cipher: %s\n", name->opts->cipher);
 		} else {
 			vbdev->crypto_bdev.required_alignment = bdev->required_alignment;
 			SPDK_NOTICELOG("AESNI_MB using cipher: %s\n", name->opts->cipher);
@@ -1954,6 +2087,14 @@ vbdev_crypto_claim(const char *bdev_name)
 			goto error_claim;
 		}
 
+		if (strcmp(vbdev->opts->drv_name, ACCEL_CRYPTO) == 0) {
+			rc = vbdev_crypto_accel_key_create(vbdev);
+			if (rc) {
+				goto error_cant_find_devid;
+			}
+			goto register_bdev;
+		}
+
 		/* To init the session we have to get the cryptoDev device ID for this vbdev */
 		TAILQ_FOREACH(device, &g_vbdev_devs, link) {
 			if (strcmp(device->cdev_info.driver_name, vbdev->opts->drv_name) == 0) {
@@ -2021,6 +2162,7 @@ vbdev_crypto_claim(const char *bdev_name)
 			goto error_session_init;
 		}
 
+register_bdev:
 		rc = spdk_bdev_register(&vbdev->crypto_bdev);
 		if (rc < 0) {
 			SPDK_ERRLOG("Failed to register vbdev: error %d\n", rc);
@@ -2036,6 +2178,11 @@ vbdev_crypto_claim(const char *bdev_name)
 
 	/* Error cleanup paths. */
 error_bdev_register:
+	if (vbdev->accel_key != NULL) {
+		spdk_accel_crypto_key_destroy(vbdev->accel_key);
+		vbdev->accel_key = NULL;
+		goto error_cant_find_devid;
+	}
 error_session_init:
 	rte_cryptodev_sym_session_free(vbdev->session_decrypt);
 error_session_de_create:
@@ -19,10 +19,12 @@
 #define QAT "crypto_qat"
 #define QAT_ASYM "crypto_qat_asym"
 #define MLX5 "mlx5_pci"
+/* Not a DPDK PMD, crypto operations are submitted to the accel framework instead */
+#define ACCEL_CRYPTO "accel"
 
 /* Supported ciphers */
 #define AES_CBC "AES_CBC" /* QAT and AESNI_MB */
-#define AES_XTS "AES_XTS" /* QAT and MLX5 */
+#define AES_XTS "AES_XTS" /* QAT, MLX5 and ACCEL_CRYPTO */
 
 /* Specific to AES_CBC. */
 #define AES_CBC_KEY_LENGTH	     16
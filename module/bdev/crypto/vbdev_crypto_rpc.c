@@ -52,7 +52,7 @@ create_crypto_opts(struct rpc_construct_crypto *rpc,
 		   struct spdk_jsonrpc_request *request)
 {
 	struct vbdev_crypto_opts *opts;
-	int key_size, key2_size;
+	int key_size, key2_size, expected_key2_size;
 
 	if (strcmp(rpc->crypto_pmd, AESNI_MB) == 0 && strcmp(rpc->cipher, AES_XTS) == 0) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
@@ -67,6 +67,13 @@ create_crypto_opts(struct rpc_construct_crypto *rpc,
 		return NULL;
 	}
 
+	if (strcmp(rpc->crypto_pmd, ACCEL_CRYPTO) == 0 && strcmp(rpc->cipher, AES_XTS) != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Invalid cipher. %s is not available on %s.",
+						     rpc->cipher, ACCEL_CRYPTO);
+		return NULL;
+	}
+
 	if (strcmp(rpc->cipher, AES_XTS) == 0 && rpc->key2 == NULL) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
 						 "Invalid key. A 2nd key is needed for AES_XTS.");
@@ -122,6 +129,19 @@ create_crypto_opts(struct rpc_construct_crypto *rpc,
 							     AES_XTS_512_BLOCK_KEY_LENGTH * 2);
 			goto error_invalid_key;
 		}
+	} else if (strcmp(opts->drv_name, ACCEL_CRYPTO) == 0) {
+		/* Only AES-XTS supported, with 128 or 256 bit keys. */
+		key_size = strnlen(rpc->key, (AES_XTS_256_BLOCK_KEY_LENGTH * 2) + 1);
+		if (key_size != AES_XTS_128_BLOCK_KEY_LENGTH * 2 &&
+		    key_size != AES_XTS_256_BLOCK_KEY_LENGTH * 2) {
+			spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							     "Invalid AES_XTS key string length for %s: %d. "
+							     "Supported sizes in hex form: %d or %d.",
+							     ACCEL_CRYPTO, key_size,
+							     AES_XTS_128_BLOCK_KEY_LENGTH * 2,
+							     AES_XTS_256_BLOCK_KEY_LENGTH * 2);
+			goto error_invalid_key;
+		}
 	} else {
 		if (strncmp(rpc->cipher, AES_XTS, sizeof(AES_XTS)) == 0) {
 			/* AES_XTS for qat uses 128bit key. */
@@ -155,12 +175,18 @@ create_crypto_opts(struct rpc_construct_crypto *rpc,
 	if (strncmp(rpc->cipher, AES_XTS, sizeof(AES_XTS)) == 0) {
 		opts->cipher = AES_XTS;
 		assert(rpc->key2);
-		key2_size = strnlen(rpc->key2, (AES_XTS_TWEAK_KEY_LENGTH * 2) + 1);
-		if (key2_size != AES_XTS_TWEAK_KEY_LENGTH * 2) {
+		/* The accel framework uses a tweak key of the same size as the data key. */
+		if (strcmp(opts->drv_name, ACCEL_CRYPTO) == 0) {
+			expected_key2_size = key_size;
+		} else {
+			expected_key2_size = AES_XTS_TWEAK_KEY_LENGTH * 2;
+		}
+		key2_size = strnlen(rpc->key2, expected_key2_size + 1);
+		if (key2_size != expected_key2_size) {
 			spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
 							     "Invalid AES_XTS key2 length %d. "
 							     "Supported size in hex form: %d.",
-							     key2_size, AES_XTS_TWEAK_KEY_LENGTH * 2);
+							     key2_size, expected_key2_size);
 			goto error_invalid_key2;
 		}
 		opts->key2 = unhexlify(rpc->key2);
@@ -195,6 +195,66 @@ bdev_malloc_writev(struct malloc_disk *mdisk, struct spdk_io_channel *ch,
 	}
 }
 
+static void
+bdev_malloc_sequence(struct malloc_disk *mdisk, struct spdk_io_channel *ch,
+		     struct malloc_task *task, struct spdk_accel_sequence *seq,
+		     struct iovec *iov, int iovcnt, size_t len, uint64_t offset, bool read)
+{
+	void *buf = mdisk->malloc_buf + offset;
+	int i, rc = 0;
+
+	if (bdev_malloc_check_iov_len(iov, iovcnt, len)) {
+		spdk_accel_sequence_abort(seq);
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(task),
+				      SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	SPDK_DEBUGLOG(bdev_malloc, "%s %zu bytes at offset %#" PRIx64 " with sequence, iovcnt=%d\n",
+		      read ? "read" : "wrote", len, offset, iovcnt);
+
+	task->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	task->num_outstanding = 1;
+
+	/* The data needs to be read before the operations of the sequence are executed */
+	if (read) {
+		spdk_accel_sequence_reverse(seq);
+	}
+
+	for (i = 0; i < iovcnt; i++) {
+		if (read) {
+			rc = spdk_accel_append_copy(&seq, ch, iov[i].iov_base, buf, iov[i].iov_len,
+						    0, NULL, NULL);
+		} else {
+			rc = spdk_accel_append_copy(&seq, ch, buf, iov[i].iov_base, iov[i].iov_len,
+						    0, NULL, NULL);
+		}
+		if (rc != 0) {
+			break;
+		}
+
+		buf += iov[i].iov_len;
+	}
+
+	if (read) {
+		spdk_accel_sequence_reverse(seq);
+	}
+
+	if (rc != 0) {
+		spdk_accel_sequence_abort(seq);
+		malloc_done(task, rc);
+		return;
+	}
+
+	spdk_accel_sequence_finish(seq, malloc_done, task);
+}
+
+static struct spdk_accel_sequence *
+bdev_malloc_get_sequence(struct spdk_bdev_io *bdev_io)
+{
+	return bdev_io->u.bdev.ext_opts ? bdev_io->u.bdev.ext_opts->accel_sequence : NULL;
+}
+
 static int
 bdev_malloc_unmap(struct malloc_disk *mdisk,
 		  struct spdk_io_channel *ch,
@@ -213,9 +273,24 @@ static int
 _bdev_malloc_submit_request(struct malloc_channel *mch, struct spdk_bdev_io *bdev_io)
 {
 	uint32_t block_size = bdev_io->bdev->blocklen;
+	struct spdk_accel_sequence *seq;
 
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
+		seq = bdev_malloc_get_sequence(bdev_io);
+		if (seq != NULL) {
+			bdev_malloc_sequence((struct malloc_disk *)bdev_io->bdev->ctxt,
+					     mch->accel_channel,
+					     (struct malloc_task *)bdev_io->driver_ctx,
+					     seq,
+					     bdev_io->u.bdev.iovs,
+					     bdev_io->u.bdev.iovcnt,
+					     bdev_io->u.bdev.num_blocks * block_size,
+					     bdev_io->u.bdev.offset_blocks * block_size,
+					     true);
+			return 0;
+		}
+
 		if (bdev_io->u.bdev.iovs[0].iov_base == NULL) {
 			assert(bdev_io->u.bdev.iovcnt == 1);
 			bdev_io->u.bdev.iovs[0].iov_base =
@@ -237,6 +312,20 @@ _bdev_malloc_submit_request(struct malloc_channel *mch, struct spdk_bdev_io *bde
 		return 0;
 
 	case SPDK_BDEV_IO_TYPE_WRITE:
+		seq = bdev_malloc_get_sequence(bdev_io);
+		if (seq != NULL) {
+			bdev_malloc_sequence((struct malloc_disk *)bdev_io->bdev->ctxt,
+					     mch->accel_channel,
+					     (struct malloc_task *)bdev_io->driver_ctx,
+					     seq,
+					     bdev_io->u.bdev.iovs,
+					     bdev_io->u.bdev.iovcnt,
+					     bdev_io->u.bdev.num_blocks * block_size,
+					     bdev_io->u.bdev.offset_blocks * block_size,
+					     false);
+			return 0;
+		}
+
 		bdev_malloc_writev((struct malloc_disk *)bdev_io->bdev->ctxt,
 				   mch->accel_channel,
 				   (struct malloc_task *)bdev_io->driver_ctx,
@@ -325,6 +414,18 @@ bdev_malloc_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	}
 }
 
+static bool
+bdev_malloc_accel_sequence_supported(void *ctx, enum spdk_bdev_io_type type)
+{
+	switch (type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static struct spdk_io_channel *
 bdev_malloc_get_io_channel(void *ctx)
 {
@@ -359,6 +460,7 @@ static const struct spdk_bdev_fn_table malloc_fn_table = {
 	.io_type_supported	= bdev_malloc_io_type_supported,
 	.get_io_channel		= bdev_malloc_get_io_channel,
 	.write_config_json	= bdev_malloc_write_json_config,
+	.accel_sequence_supported	= bdev_malloc_accel_sequence_supported,
 };
 
 int
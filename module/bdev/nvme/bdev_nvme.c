@@ -90,6 +90,9 @@ struct nvme_bdev_io {
 
 	/* How many times the current I/O was retried. */
 	int32_t retry_count;
+
+	/** Submission timestamp used to track per io_path latency. Zero if not tracked. */
+	uint64_t submit_tsc;
 };
 
 struct nvme_probe_skip_entry {
@@ -620,6 +623,12 @@ _bdev_nvme_delete_io_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_io_pat
 	ch = spdk_io_channel_from_ctx(ctrlr_ch);
 	spdk_put_io_channel(ch);
 
+	/* Outstanding I/Os still account their completion to the path */
+	if (io_path->num_outstanding_io > 0) {
+		io_path->deleted = true;
+		return;
+	}
+
 	free(io_path);
 }
 
@@ -645,6 +654,9 @@ bdev_nvme_create_bdev_channel_cb(void *io_device, void *ctx_buf)
 	TAILQ_INIT(&nbdev_ch->retry_io_list);
 
 	pthread_mutex_lock(&nbdev->mutex);
+	nbdev_ch->mp_policy = nbdev->mp_policy;
+	nbdev_ch->mp_selector = nbdev->mp_selector;
+
 	TAILQ_FOREACH(nvme_ns, &nbdev->nvme_ns_list, tailq) {
 		rc = _bdev_nvme_add_io_path(nbdev_ch, nvme_ns);
 		if (rc != 0) {
@@ -757,6 +769,10 @@ nvme_io_path_is_connected(struct nvme_io_path *io_path)
 static inline bool
 nvme_io_path_is_available(struct nvme_io_path *io_path)
 {
+	if (spdk_unlikely(io_path->deleted)) {
+		return false;
+	}
+
 	if (spdk_unlikely(!nvme_io_path_is_connected(io_path))) {
 		return false;
 	}
@@ -901,6 +917,63 @@ _bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 	return non_optimized;
 }
 
+static inline uint64_t
+nvme_io_path_get_load(struct nvme_bdev_channel *nbdev_ch, struct nvme_io_path *io_path)
+{
+	if (nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH) {
+		return io_path->num_outstanding_io;
+	}
+
+	/* Expected time to drain the queue of the path including the next I/O. */
+	return io_path->io_latency_ewma_ticks * (io_path->num_outstanding_io + 1);
+}
+
+static struct nvme_io_path *
+bdev_nvme_find_least_loaded_io_path(struct nvme_bdev_channel *nbdev_ch,
+				    struct nvme_io_path *prev)
+{
+	struct nvme_io_path *io_path, *start, *optimized = NULL, *non_optimized = NULL;
+	uint64_t load, optimized_load = UINT64_MAX, non_optimized_load = UINT64_MAX;
+
+	/* Start next to the previous path so that ties are broken in round-robin order. */
+	start = nvme_io_path_get_next(nbdev_ch, prev);
+
+	io_path = start;
+	do {
+		if (spdk_likely(nvme_io_path_is_connected(io_path) &&
+				!io_path->nvme_ns->ana_state_updating)) {
+			load = nvme_io_path_get_load(nbdev_ch, io_path);
+
+			switch (io_path->nvme_ns->ana_state) {
+			case SPDK_NVME_ANA_OPTIMIZED_STATE:
+				if (optimized == NULL || load < optimized_load) {
+					optimized = io_path;
+					optimized_load = load;
+				}
+				break;
+			case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+				if (non_optimized == NULL || load < non_optimized_load) {
+					non_optimized = io_path;
+					non_optimized_load = load;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		io_path = nvme_io_path_get_next(nbdev_ch, io_path);
+	} while (io_path != start);
+
+	/* Non-optimized paths are used only if there is no optimized path. */
+	if (optimized != NULL) {
+		nbdev_ch->current_io_path = optimized;
+	} else {
+		nbdev_ch->current_io_path = non_optimized;
+	}
+
+	return nbdev_ch->current_io_path;
+}
+
 static inline struct nvme_io_path *
 bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 {
@@ -910,11 +983,62 @@ bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 
 	if (spdk_likely(nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE)) {
 		return nbdev_ch->current_io_path;
-	} else {
+	}
+
+	switch (nbdev_ch->mp_selector) {
+	case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
+	case BDEV_NVME_MP_SELECTOR_MIN_LATENCY:
+		return bdev_nvme_find_least_loaded_io_path(nbdev_ch, nbdev_ch->current_io_path);
+	default:
 		return bdev_nvme_find_next_io_path(nbdev_ch, nbdev_ch->current_io_path);
 	}
 }
 
+static inline void
+nvme_io_path_start_io(struct nvme_bdev_io *bio)
+{
+	bio->io_path->num_outstanding_io++;
+	bio->submit_tsc = spdk_get_ticks();
+}
+
+/* Weight of the latest sample in the latency EWMA is 1 / 2^NVME_IO_PATH_EWMA_SHIFT. */
+#define NVME_IO_PATH_EWMA_SHIFT	3
+
+static inline void
+nvme_io_path_end_io(struct nvme_bdev_io *bio)
+{
+	struct nvme_io_path *io_path = bio->io_path;
+	uint64_t latency;
+
+	if (bio->submit_tsc == 0) {
+		return;
+	}
+
+	assert(io_path != NULL);
+	assert(io_path->num_outstanding_io > 0);
+	io_path->num_outstanding_io--;
+
+	latency = spdk_get_ticks() - bio->submit_tsc;
+	bio->submit_tsc = 0;
+
+	if (spdk_unlikely(io_path->deleted)) {
+		/* The path is gone, so the I/O must not refer to it anymore */
+		bio->io_path = NULL;
+		if (io_path->num_outstanding_io == 0) {
+			free(io_path);
+		}
+		return;
+	}
+
+	if (io_path->io_latency_ewma_ticks == 0) {
+		io_path->io_latency_ewma_ticks = latency;
+	} else {
+		io_path->io_latency_ewma_ticks = io_path->io_latency_ewma_ticks -
+						 (io_path->io_latency_ewma_ticks >> NVME_IO_PATH_EWMA_SHIFT) +
+						 (latency >> NVME_IO_PATH_EWMA_SHIFT);
+	}
+}
+
 /* Return true if there is any io_path whose qpair is active or ctrlr is not failed,
  * or false otherwise.
  *
@@ -1037,6 +1161,8 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 
 	assert(!bdev_nvme_io_type_is_admin(bdev_io->type));
 
+	nvme_io_path_end_io(bio);
+
 	if (spdk_likely(spdk_nvme_cpl_is_success(cpl))) {
 		goto complete;
 	}
@@ -1048,7 +1174,14 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 
 	nbdev_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
 
-	assert(bio->io_path != NULL);
+	if (spdk_unlikely(bio->io_path == NULL)) {
+		/* The I/O path was deleted while the I/O was outstanding. Retry it on
+		 * another path. */
+		nbdev_ch->current_io_path = NULL;
+		delay_ms = 0;
+		goto retry;
+	}
+
 	nvme_ctrlr = bio->io_path->qpair->ctrlr;
 
 	if (spdk_nvme_cpl_is_path_error(cpl) ||
@@ -1076,6 +1209,7 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 		}
 	}
 
+retry:
 	if (any_io_path_may_become_available(nbdev_ch)) {
 		bdev_nvme_queue_retry_io(nbdev_ch, bio, delay_ms);
 		return;
@@ -1093,6 +1227,8 @@ bdev_nvme_io_complete(struct nvme_bdev_io *bio, int rc)
 	struct nvme_bdev_channel *nbdev_ch;
 	enum spdk_bdev_io_status io_status;
 
+	nvme_io_path_end_io(bio);
+
 	switch (rc) {
 	case 0:
 		io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
@@ -2098,6 +2234,7 @@ bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 
 	spdk_trace_record(TRACE_BDEV_NVME_IO_START, 0, 0, (uintptr_t)nbdev_io, (uintptr_t)bdev_io);
 	nbdev_io->io_path = bdev_nvme_find_io_path(nbdev_ch);
+	nbdev_io->submit_tsc = 0;
 	if (spdk_unlikely(!nbdev_io->io_path)) {
 		if (!bdev_nvme_io_type_is_admin(bdev_io->type)) {
 			rc = -ENXIO;
@@ -2107,6 +2244,8 @@ bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 		/* Admin commands do not use the optimal I/O path.
 		 * Simply fall through even if it is not found.
 		 */
+	} else if (!bdev_nvme_io_type_is_admin(bdev_io->type)) {
+		nvme_io_path_start_io(nbdev_io);
 	}
 
 	switch (bdev_io->type) {
@@ -2725,6 +2864,22 @@ nvme_bdev_get_mp_policy_str(struct nvme_bdev *nbdev)
 	}
 }
 
+static const char *
+nvme_bdev_get_mp_selector_str(struct nvme_bdev *nbdev)
+{
+	switch (nbdev->mp_selector) {
+	case BDEV_NVME_MP_SELECTOR_ROUND_ROBIN:
+		return "round_robin";
+	case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
+		return "queue_depth";
+	case BDEV_NVME_MP_SELECTOR_MIN_LATENCY:
+		return "min_latency";
+	default:
+		assert(false);
+		return "invalid";
+	}
+}
+
 static int
 bdev_nvme_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 {
@@ -2738,6 +2893,9 @@ bdev_nvme_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	}
 	spdk_json_write_array_end(w);
 	spdk_json_write_named_string(w, "mp_policy", nvme_bdev_get_mp_policy_str(nvme_bdev));
+	if (nvme_bdev->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE) {
+		spdk_json_write_named_string(w, "mp_selector", nvme_bdev_get_mp_selector_str(nvme_bdev));
+	}
 	pthread_mutex_unlock(&nvme_bdev->mutex);
 
 	return 0;
@@ -3023,6 +3181,7 @@ nvme_bdev_create(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ns *nvme_ns)
 
 	bdev->ref = 1;
 	bdev->mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE;
+	bdev->mp_selector = BDEV_NVME_MP_SELECTOR_ROUND_ROBIN;
 	TAILQ_INIT(&bdev->nvme_ns_list);
 	TAILQ_INSERT_TAIL(&bdev->nvme_ns_list, nvme_ns, tailq);
 	bdev->opal = nvme_ctrlr->opal_dev != NULL;
@@ -3830,6 +3989,7 @@ _bdev_nvme_set_multipath_policy(struct spdk_io_channel_iter *i)
 	struct nvme_bdev *nbdev = spdk_io_channel_get_io_device(_ch);
 
 	nbdev_ch->mp_policy = nbdev->mp_policy;
+	nbdev_ch->mp_selector = nbdev->mp_selector;
 	nbdev_ch->current_io_path = NULL;
 
 	spdk_for_each_channel_continue(i, 0);
@@ -3837,6 +3997,7 @@ _bdev_nvme_set_multipath_policy(struct spdk_io_channel_iter *i)
 
 void
 bdev_nvme_set_multipath_policy(const char *name, enum bdev_nvme_multipath_policy policy,
+			       enum bdev_nvme_multipath_selector selector,
 			       bdev_nvme_set_multipath_policy_cb cb_fn, void *cb_arg)
 {
 	struct bdev_nvme_set_multipath_policy_ctx *ctx;
@@ -3873,6 +4034,7 @@ bdev_nvme_set_multipath_policy(const char *name, enum bdev_nvme_multipath_policy
 
 	pthread_mutex_lock(&nbdev->mutex);
 	nbdev->mp_policy = policy;
+	nbdev->mp_selector = selector;
 	pthread_mutex_unlock(&nbdev->mutex);
 
 	spdk_for_each_channel(nbdev,
@@ -6715,6 +6877,9 @@ nvme_io_path_info_json(struct spdk_json_write_ctx *w, struct nvme_io_path *io_pa
 	spdk_json_write_named_bool(w, "current", io_path == io_path->nbdev_ch->current_io_path);
 	spdk_json_write_named_bool(w, "connected", nvme_io_path_is_connected(io_path));
 	spdk_json_write_named_bool(w, "accessible", nvme_ns_is_accessible(nvme_ns));
+	spdk_json_write_named_uint32(w, "outstanding_io", io_path->num_outstanding_io);
+	spdk_json_write_named_uint64(w, "latency_ewma_us",
+				     io_path->io_latency_ewma_ticks * SPDK_SEC_TO_USEC / spdk_get_ticks_hz());
 
 	spdk_json_write_named_object_begin(w, "transport");
 	spdk_json_write_named_string(w, "trtype", trid->trstring);
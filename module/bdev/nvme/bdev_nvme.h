@@ -25,6 +25,12 @@ enum bdev_nvme_multipath_policy {
 	BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
 };
 
+enum bdev_nvme_multipath_selector {
+	BDEV_NVME_MP_SELECTOR_ROUND_ROBIN = 1,
+	BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	BDEV_NVME_MP_SELECTOR_MIN_LATENCY,
+};
+
 typedef void (*spdk_bdev_create_nvme_fn)(void *ctx, size_t bdev_count, int rc);
 typedef void (*spdk_bdev_nvme_start_discovery_fn)(void *ctx, int status);
 typedef void (*spdk_bdev_nvme_stop_discovery_fn)(void *ctx);
@@ -150,6 +156,7 @@ struct nvme_bdev {
 	pthread_mutex_t			mutex;
 	int				ref;
 	enum bdev_nvme_multipath_policy	mp_policy;
+	enum bdev_nvme_multipath_selector mp_selector;
 	TAILQ_HEAD(, nvme_ns)		nvme_ns_list;
 	bool				opal;
 	TAILQ_ENTRY(nvme_bdev)		tailq;
@@ -182,11 +189,19 @@ struct nvme_io_path {
 	/* The following are used to update io_path cache of the nvme_bdev_channel. */
 	struct nvme_bdev_channel	*nbdev_ch;
 	TAILQ_ENTRY(nvme_io_path)	tailq;
+
+	/* The following are used by the queue_depth and min_latency selectors. */
+	uint32_t			num_outstanding_io;
+	uint64_t			io_latency_ewma_ticks;
+
+	/* Set if the path was deleted while I/Os were outstanding. The last of them frees it. */
+	bool				deleted;
 };
 
 struct nvme_bdev_channel {
 	struct nvme_io_path			*current_io_path;
 	enum bdev_nvme_multipath_policy		mp_policy;
+	enum bdev_nvme_multipath_selector	mp_selector;
 	STAILQ_HEAD(, nvme_io_path)		io_path_list;
 	TAILQ_HEAD(retry_io_head, spdk_bdev_io)	retry_io_list;
 	struct spdk_poller			*retry_io_poller;
@@ -322,10 +337,13 @@ typedef void (*bdev_nvme_set_multipath_policy_cb)(void *cb_arg, int rc);
  *
  * \param name NVMe bdev name
  * \param policy Multipath policy (active-passive or active-active)
+ * \param selector Path selector used by active-active policy (round-robin,
+ * queue-depth or min-latency). Ignored for active-passive policy.
  * \param cb_fn Function to be called back after completion.
  */
 void bdev_nvme_set_multipath_policy(const char *name,
 				    enum bdev_nvme_multipath_policy policy,
+				    enum bdev_nvme_multipath_selector selector,
 				    bdev_nvme_set_multipath_policy_cb cb_fn,
 				    void *cb_arg);
 
@@ -106,6 +106,11 @@ raid_bdev_create_cb(void *io_device, void *ctx_buf)
 		return -ENOMEM;
 	}
 	for (i = 0; i < raid_ch->num_channels; i++) {
+		if (raid_bdev->base_bdev_info[i].removed) {
+			/* Base bdev was removed and the raid bdev runs degraded */
+			continue;
+		}
+
 		/*
 		 * Get the spdk_io_channel for all the base bdevs. This is used during
 		 * split logic to send the respective child bdev ios to respective base
@@ -114,19 +119,29 @@ raid_bdev_create_cb(void *io_device, void *ctx_buf)
 		raid_ch->base_channel[i] = spdk_bdev_get_io_channel(
 						   raid_bdev->base_bdev_info[i].desc);
 		if (!raid_ch->base_channel[i]) {
-			uint8_t j;
-
-			for (j = 0; j < i; j++) {
-				spdk_put_io_channel(raid_ch->base_channel[j]);
-			}
-			free(raid_ch->base_channel);
-			raid_ch->base_channel = NULL;
 			SPDK_ERRLOG("Unable to create io channel for base bdev\n");
-			return -ENOMEM;
+			goto err;
+		}
+	}
+
+	if (raid_bdev->module->get_io_channel) {
+		raid_ch->module_channel = raid_bdev->module->get_io_channel(raid_bdev);
+		if (!raid_ch->module_channel) {
+			SPDK_ERRLOG("Unable to create io channel for raid module\n");
+			goto err;
 		}
 	}
 
 	return 0;
+err:
+	for (i = 0; i < raid_ch->num_channels; i++) {
+		if (raid_ch->base_channel[i] != NULL) {
+			spdk_put_io_channel(raid_ch->base_channel[i]);
+		}
+	}
+	free(raid_ch->base_channel);
+	raid_ch->base_channel = NULL;
+	return -ENOMEM;
 }
 
 /*
@@ -149,10 +164,16 @@ raid_bdev_destroy_cb(void *io_device, void *ctx_buf)
 
 	assert(raid_ch != NULL);
 	assert(raid_ch->base_channel);
+
+	if (raid_ch->module_channel) {
+		spdk_put_io_channel(raid_ch->module_channel);
+	}
+
 	for (i = 0; i < raid_ch->num_channels; i++) {
-		/* Free base bdev channels */
-		assert(raid_ch->base_channel[i] != NULL);
-		spdk_put_io_channel(raid_ch->base_channel[i]);
+		/* Free base bdev channels, skipping the ones of removed base bdevs */
+		if (raid_ch->base_channel[i] != NULL) {
+			spdk_put_io_channel(raid_ch->base_channel[i]);
+		}
 	}
 	free(raid_ch->base_channel);
 	raid_ch->base_channel = NULL;
@@ -400,6 +421,12 @@ raid_bdev_submit_reset_request(struct raid_bdev_io *raid_io)
 		i = raid_io->base_bdev_io_submitted;
 		base_info = &raid_bdev->base_bdev_info[i];
 		base_ch = raid_io->raid_ch->base_channel[i];
+		if (base_ch == NULL) {
+			/* Base bdev was removed, there is nothing to reset */
+			raid_io->base_bdev_io_submitted++;
+			raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_SUCCESS);
+			continue;
+		}
 		ret = spdk_bdev_reset(base_info->desc, base_ch,
 				      raid_base_bdev_reset_complete, raid_io);
 		if (ret == 0) {
@@ -515,7 +542,7 @@ _raid_bdev_io_type_supported(struct raid_bdev *raid_bdev, enum spdk_bdev_io_type
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		if (base_info->bdev == NULL) {
-			assert(false);
+			assert(raid_bdev->num_base_bdevs_degraded > 0);
 			continue;
 		}
 
@@ -603,6 +630,7 @@ raid_bdev_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "destruct_called", raid_bdev->destruct_called);
 	spdk_json_write_named_uint32(w, "num_base_bdevs", raid_bdev->num_base_bdevs);
 	spdk_json_write_named_uint32(w, "num_base_bdevs_discovered", raid_bdev->num_base_bdevs_discovered);
+	spdk_json_write_named_uint32(w, "num_base_bdevs_degraded", raid_bdev->num_base_bdevs_degraded);
 	spdk_json_write_name(w, "base_bdevs_list");
 	spdk_json_write_array_begin(w);
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
@@ -662,9 +690,16 @@ raid_bdev_get_memory_domains(void *ctx, struct spdk_memory_domain **domains, int
 	uint32_t i;
 	int domains_count = 0, rc;
 
+	if (!raid_bdev->module->memory_domains_supported) {
+		return 0;
+	}
+
 	/* First loop to get the number of memory domains */
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
 		base_bdev = raid_bdev->base_bdev_info[i].bdev;
+		if (base_bdev == NULL) {
+			continue;
+		}
 		rc = spdk_bdev_get_memory_domains(base_bdev, NULL, 0);
 		if (rc < 0) {
 			return rc;
@@ -678,6 +713,9 @@ raid_bdev_get_memory_domains(void *ctx, struct spdk_memory_domain **domains, int
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
 		base_bdev = raid_bdev->base_bdev_info[i].bdev;
+		if (base_bdev == NULL) {
+			continue;
+		}
 		rc = spdk_bdev_get_memory_domains(base_bdev, domains, array_size);
 		if (rc < 0) {
 			return rc;
@@ -791,7 +829,8 @@ raid_bdev_config_add(const char *raid_name, uint32_t strip_size, uint8_t num_bas
 		return -EEXIST;
 	}
 
-	if (spdk_u32_is_pow2(strip_size) == false) {
+	/* RAID1 doesn't stripe the data, the strip size is optional for it */
+	if ((strip_size != 0 || level != RAID1) && spdk_u32_is_pow2(strip_size) == false) {
 		SPDK_ERRLOG("Invalid strip size %" PRIu32 "\n", strip_size);
 		return -EINVAL;
 	}
@@ -879,6 +918,8 @@ static struct {
 } g_raid_level_names[] = {
 	{ "raid0", RAID0 },
 	{ "0", RAID0 },
+	{ "raid1", RAID1 },
+	{ "1", RAID1 },
 	{ "raid5f", RAID5F },
 	{ "5f", RAID5F },
 	{ "concat", CONCAT },
@@ -1148,12 +1189,14 @@ raid_bdev_alloc_base_bdev_resource(struct raid_bdev *raid_bdev, const char *bdev
 
 	SPDK_DEBUGLOG(bdev_raid, "bdev %s is claimed\n", bdev_name);
 
-	assert(raid_bdev->state != RAID_BDEV_STATE_ONLINE);
+	assert(raid_bdev->state != RAID_BDEV_STATE_ONLINE || raid_bdev->num_base_bdevs_degraded > 0);
 	assert(base_bdev_slot < raid_bdev->num_base_bdevs);
 
 	raid_bdev->base_bdev_info[base_bdev_slot].thread = spdk_get_thread();
 	raid_bdev->base_bdev_info[base_bdev_slot].bdev = bdev;
 	raid_bdev->base_bdev_info[base_bdev_slot].desc = desc;
+	raid_bdev->base_bdev_info[base_bdev_slot].removed = false;
+	spdk_uuid_copy(&raid_bdev->base_bdev_info[base_bdev_slot].uuid, spdk_bdev_get_uuid(bdev));
 	raid_bdev->num_base_bdevs_discovered++;
 	assert(raid_bdev->num_base_bdevs_discovered <= raid_bdev->num_base_bdevs);
 
@@ -1261,7 +1304,8 @@ raid_bdev_deconfigure(struct raid_bdev *raid_bdev, raid_bdev_destruct_cb cb_fn,
 		return;
 	}
 
-	assert(raid_bdev->num_base_bdevs == raid_bdev->num_base_bdevs_discovered);
+	assert(raid_bdev->num_base_bdevs - raid_bdev->num_base_bdevs_degraded <=
+	       raid_bdev->num_base_bdevs_discovered);
 	TAILQ_REMOVE(&g_raid_bdev_configured_list, raid_bdev, state_link);
 	raid_bdev->state = RAID_BDEV_STATE_OFFLINE;
 	assert(raid_bdev->num_base_bdevs_discovered);
@@ -1303,6 +1347,200 @@ raid_bdev_find_by_base_bdev(struct spdk_bdev *base_bdev, struct raid_bdev **_rai
 	return false;
 }
 
+static void
+raid_bdev_channel_remove_base_bdev(struct spdk_io_channel_iter *i)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_iter_get_io_device(i);
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	uint8_t idx = base_info - raid_bdev->base_bdev_info;
+
+	SPDK_DEBUGLOG(bdev_raid, "slot: %u raid_ch: %p\n", idx, raid_ch);
+
+	if (raid_ch->base_channel[idx] != NULL) {
+		spdk_put_io_channel(raid_ch->base_channel[idx]);
+		raid_ch->base_channel[idx] = NULL;
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+raid_bdev_channels_remove_base_bdev_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_iter_get_io_device(i);
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+
+	/* The descriptor may have been already closed by raid_bdev_destruct() */
+	if (base_info->desc != NULL) {
+		raid_bdev_free_base_bdev_resource(raid_bdev, base_info);
+	}
+
+	SPDK_NOTICELOG("raid bdev %s is running degraded with %u of %u base bdevs\n",
+		       raid_bdev->bdev.name, raid_bdev->num_base_bdevs - raid_bdev->num_base_bdevs_degraded,
+		       raid_bdev->num_base_bdevs);
+}
+
+/*
+ * brief:
+ * raid_bdev_degrade function keeps the raid bdev online after one of its
+ * base bdevs got removed. The base bdev's IO channels are released from all
+ * raid bdev IO channels and the raid module is expected to handle the missing
+ * base bdev (NULL base_channel) from then on.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * base_info - raid base bdev info of the removed base bdev
+ * returns:
+ * none
+ */
+static void
+raid_bdev_degrade(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info)
+{
+	base_info->removed = true;
+	raid_bdev->num_base_bdevs_degraded++;
+	base_info->dirty_tracked = true;
+
+	spdk_for_each_channel(raid_bdev, raid_bdev_channel_remove_base_bdev, base_info,
+			      raid_bdev_channels_remove_base_bdev_done);
+}
+
+static void
+raid_bdev_channel_add_base_bdev(struct spdk_io_channel_iter *i)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_iter_get_io_device(i);
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	uint8_t idx = base_info - raid_bdev->base_bdev_info;
+
+	SPDK_DEBUGLOG(bdev_raid, "slot: %u raid_ch: %p\n", idx, raid_ch);
+
+	/* Channels created after the base bdev was added back already have it */
+	if (raid_ch->base_channel[idx] == NULL) {
+		raid_ch->base_channel[idx] = spdk_bdev_get_io_channel(base_info->desc);
+		if (raid_ch->base_channel[idx] == NULL) {
+			SPDK_ERRLOG("Unable to create io channel for base bdev\n");
+			spdk_for_each_channel_continue(i, -ENOMEM);
+			return;
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+raid_bdev_channels_add_base_bdev_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_iter_get_io_device(i);
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+
+	if (status != 0 || base_info->remove_scheduled) {
+		raid_bdev_resync_base_bdev_done(raid_bdev, base_info, status ? status : -ENODEV);
+		return;
+	}
+
+	SPDK_NOTICELOG("resync of base bdev %s of raid bdev %s started\n",
+		       base_info->bdev->name, raid_bdev->bdev.name);
+
+	raid_bdev->module->resync_base_bdev(raid_bdev, base_info);
+}
+
+/*
+ * brief:
+ * raid_bdev_resync_base_bdev_done function is called by the raid module when
+ * the resync of a base bdev added back to a degraded raid bdev finished. On
+ * success the base bdev becomes a regular member of the raid bdev again,
+ * otherwise it is removed from the raid bdev.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * base_info - raid base bdev info of the resynced base bdev
+ * status - 0 on success, negative errno otherwise
+ * returns:
+ * none
+ */
+void
+raid_bdev_resync_base_bdev_done(struct raid_bdev *raid_bdev,
+				struct raid_base_bdev_info *base_info, int status)
+{
+	assert(base_info->resyncing);
+	assert(raid_bdev->num_base_bdevs_degraded > 0);
+
+	base_info->resyncing = false;
+
+	if (status == 0 && !base_info->remove_scheduled) {
+		raid_bdev->num_base_bdevs_degraded--;
+		base_info->dirty_tracked = false;
+		SPDK_NOTICELOG("resync of base bdev %s of raid bdev %s finished\n",
+			       base_info->bdev->name, raid_bdev->bdev.name);
+		return;
+	}
+
+	if (status != 0 && status != -ENODEV) {
+		SPDK_ERRLOG("resync of base bdev %s of raid bdev %s failed: %s\n",
+			    base_info->bdev->name, raid_bdev->bdev.name, spdk_strerror(-status));
+	}
+
+	base_info->remove_scheduled = true;
+	base_info->removed = true;
+	spdk_for_each_channel(raid_bdev, raid_bdev_channel_remove_base_bdev, base_info,
+			      raid_bdev_channels_remove_base_bdev_done);
+}
+
+/*
+ * brief:
+ * raid_bdev_readd_base_device function adds a base bdev, which was removed
+ * before, back to an online and degraded raid bdev. The base bdev is added to
+ * all raid bdev IO channels and then handed over to the raid module to be
+ * resynced. Only a base bdev with the UUID recorded when it was first added,
+ * whose writes were tracked while it was missing, may be resynced partially.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * bdev_name - base bdev name
+ * base_bdev_slot - position of the base bdev
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+static int
+raid_bdev_readd_base_device(struct raid_bdev *raid_bdev, const char *bdev_name,
+			    uint8_t base_bdev_slot)
+{
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[base_bdev_slot];
+	struct spdk_uuid uuid;
+	int rc;
+
+	if (raid_bdev->module->resync_base_bdev == NULL || raid_bdev->destroy_started ||
+	    base_info->bdev != NULL) {
+		SPDK_DEBUGLOG(bdev_raid, "raid bdev '%s' is online, can't add base bdev '%s'\n",
+			      raid_bdev->bdev.name, bdev_name);
+		return -EBUSY;
+	}
+
+	spdk_uuid_copy(&uuid, &base_info->uuid);
+
+	rc = raid_bdev_alloc_base_bdev_resource(raid_bdev, bdev_name, base_bdev_slot);
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* A full resync requested before stays pending until the raid module starts it */
+	base_info->full_resync = base_info->full_resync || !base_info->dirty_tracked ||
+				 spdk_uuid_compare(&uuid, &base_info->uuid) != 0;
+	if (base_info->full_resync) {
+		SPDK_NOTICELOG("base bdev %s of raid bdev %s will be resynced in full\n",
+			       bdev_name, raid_bdev->bdev.name);
+	}
+
+	base_info->remove_scheduled = false;
+	base_info->resyncing = true;
+
+	spdk_for_each_channel(raid_bdev, raid_bdev_channel_add_base_bdev, base_info,
+			      raid_bdev_channels_add_base_bdev_done);
+
+	return 0;
+}
+
 /*
  * brief:
  * raid_bdev_remove_base_bdev function is called by below layers when base_bdev
@@ -1344,6 +1582,22 @@ raid_bdev_remove_base_bdev(struct spdk_bdev *base_bdev)
 		}
 	}
 
+	if (base_info->resyncing) {
+		/*
+		 * The base bdev is already accounted as degraded. The raid module will
+		 * notice remove_scheduled, stop the resync and call
+		 * raid_bdev_resync_base_bdev_done(), which releases the base bdev.
+		 */
+		return;
+	}
+
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE && !raid_bdev->destroy_started &&
+	    raid_bdev->num_base_bdevs_degraded < raid_bdev->module->base_bdevs_max_degraded &&
+	    raid_bdev->num_base_bdevs_degraded + 1 < raid_bdev->num_base_bdevs) {
+		raid_bdev_degrade(raid_bdev, base_info);
+		return;
+	}
+
 	raid_bdev_deconfigure(raid_bdev, NULL, NULL);
 }
 
@@ -1465,6 +1719,11 @@ raid_bdev_add_base_device(struct raid_bdev_config *raid_cfg, const char *bdev_na
 		return -ENODEV;
 	}
 
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE) {
+		/* A removed base bdev showed up again while the raid bdev is running degraded */
+		return raid_bdev_readd_base_device(raid_bdev, bdev_name, base_bdev_slot);
+	}
+
 	rc = raid_bdev_alloc_base_bdev_resource(raid_bdev, bdev_name, base_bdev_slot);
 	if (rc != 0) {
 		if (rc != -ENODEV) {
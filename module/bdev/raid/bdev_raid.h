@@ -11,6 +11,7 @@
 enum raid_level {
 	INVALID_RAID_LEVEL	= -1,
 	RAID0			= 0,
+	RAID1			= 1,
 	RAID5F			= 95, /* 0x5f */
 	CONCAT			= 99,
 };
@@ -58,6 +59,36 @@ struct raid_base_bdev_info {
 	 */
 	bool			remove_scheduled;
 
+	/*
+	 * Set as soon as the removal of the base bdev from an online raid bdev,
+	 * which keeps running degraded without it, starts. IO channels of the raid
+	 * bdev created from then on don't get an IO channel of this base bdev.
+	 */
+	bool			removed;
+
+	/*
+	 * Set while a base bdev that was added back to an online, degraded raid
+	 * bdev is being resynchronized by the raid module. Such base bdev receives
+	 * writes, but must not be used to serve reads.
+	 */
+	bool			resyncing;
+
+	/*
+	 * Set once the raid bdev runs degraded without this base bdev, i.e. the
+	 * raid module tracks the regions written while the base bdev is missing.
+	 */
+	bool			dirty_tracked;
+
+	/*
+	 * Set when a base bdev added back must be resynced in full instead of only
+	 * its dirty regions, because it is not the same bdev that was removed or
+	 * because writes were not tracked while it was missing.
+	 */
+	bool			full_resync;
+
+	/* UUID of the base bdev, used to recognize it when it's added back */
+	struct spdk_uuid	uuid;
+
 	/* thread where base device is opened */
 	struct spdk_thread	*thread;
 };
@@ -79,7 +110,10 @@ struct raid_bdev_io {
 	/* Used for tracking progress on io requests sent to member disks. */
 	uint64_t			base_bdev_io_remaining;
 	uint8_t				base_bdev_io_submitted;
-	uint8_t				base_bdev_io_status;
+	enum spdk_bdev_io_status	base_bdev_io_status;
+
+	/* Private data for the raid module */
+	void				*module_private;
 };
 
 /*
@@ -133,6 +167,12 @@ struct raid_bdev {
 	/* Set to true if destroy of this raid bdev is started. */
 	bool				destroy_started;
 
+	/*
+	 * Number of base bdevs that were removed while the raid bdev was online
+	 * and which the raid bdev is operating without (degraded mode).
+	 */
+	uint8_t				num_base_bdevs_degraded;
+
 	/* Module for RAID-level specific operations */
 	struct raid_bdev_module		*module;
 
@@ -199,6 +239,9 @@ struct raid_bdev_io_channel {
 
 	/* Number of IO channels */
 	uint8_t			num_channels;
+
+	/* Private raid module IO channel */
+	struct spdk_io_channel	*module_channel;
 };
 
 /* TAIL heads for various raid bdev lists */
@@ -244,6 +287,13 @@ struct raid_bdev_module {
 	 */
 	uint8_t base_bdevs_max_degraded;
 
+	/*
+	 * Set if the module passes the data buffers of the IOs to the base bdevs
+	 * without accessing them, so the memory domains of the base bdevs can be
+	 * exposed by the raid bdev.
+	 */
+	bool memory_domains_supported;
+
 	/*
 	 * Called when the raid is starting, right before changing the state to
 	 * online and registering the bdev. Parameters of the bdev like blockcnt
@@ -265,6 +315,22 @@ struct raid_bdev_module {
 	/* Handler for requests without payload (flush, unmap). Optional. */
 	void (*submit_null_payload_request)(struct raid_bdev_io *raid_io);
 
+	/*
+	 * Called when the bdev's IO channel is created to get the module's private IO channel.
+	 * Optional.
+	 */
+	struct spdk_io_channel *(*get_io_channel)(struct raid_bdev *raid_bdev);
+
+	/*
+	 * Called when a removed base bdev shows up again while the raid bdev is
+	 * online and degraded. The base bdev is already added to all raid bdev IO
+	 * channels at this point, so it receives new writes. The module has to bring
+	 * the remaining data of the base bdev up to date and then call
+	 * raid_bdev_resync_base_bdev_done(). Optional - if not provided, removed base
+	 * bdevs can't be added back to an online raid bdev.
+	 */
+	void (*resync_base_bdev)(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info);
+
 	TAILQ_ENTRY(raid_bdev_module) link;
 };
 
@@ -285,5 +351,7 @@ bool raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed
 void raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
 			     struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn);
 void raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status);
+void raid_bdev_resync_base_bdev_done(struct raid_bdev *raid_bdev,
+				     struct raid_base_bdev_info *base_info, int status);
 
 #endif /* SPDK_BDEV_RAID_INTERNAL_H */
@@ -230,7 +230,7 @@ rpc_bdev_raid_create(struct spdk_jsonrpc_request *request,
 		goto cleanup;
 	}
 
-	if (req.strip_size_kb == 0) {
+	if (req.strip_size_kb == 0 && req.level != RAID1) {
 		spdk_jsonrpc_send_error_response(request, EINVAL, "strip size not specified");
 		goto cleanup;
 	}
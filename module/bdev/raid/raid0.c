@@ -362,6 +362,7 @@ raid0_start(struct raid_bdev *raid_bdev)
 static struct raid_bdev_module g_raid0_module = {
 	.level = RAID0,
 	.base_bdevs_min = 1,
+	.memory_domains_supported = true,
 	.start = raid0_start,
 	.submit_rw_request = raid0_submit_rw_request,
 	.submit_null_payload_request = raid0_submit_null_payload_request,
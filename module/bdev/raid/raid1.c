@@ -0,0 +1,867 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "bdev_raid.h"
+
+#include "spdk/env.h"
+#include "spdk/likely.h"
+#include "spdk/log.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+/* Granularity of the dirty region tracking */
+#define RAID1_REGION_SIZE_KB 1024
+
+#define RAID1_REGION_NONE UINT64_MAX
+
+struct raid1_resync {
+	/* The raid1 info of the resynced raid bdev */
+	struct raid1_info *r1info;
+
+	/* The base bdev being resynced */
+	struct raid_base_bdev_info *base_info;
+
+	/* Index of the base bdev being resynced */
+	uint8_t idx;
+
+	/* IO channels of the base bdevs, acquired on demand */
+	struct spdk_io_channel **base_channels;
+	uint8_t num_base_channels;
+
+	/* Buffer for the region being copied */
+	void *buf;
+
+	/* The region being copied */
+	uint64_t region;
+
+	/* Index of the base bdev the current region is read from */
+	uint8_t source_idx;
+
+	/* Set when the raid bdev is stopped, the resync is dropped on the next completion */
+	bool aborted;
+
+	struct spdk_bdev_io_wait_entry waitq_entry;
+
+	TAILQ_ENTRY(raid1_resync) link;
+};
+
+struct raid1_info {
+	/* The parent raid bdev */
+	struct raid_bdev *raid_bdev;
+
+	/* Number of blocks of a dirty region, as a bit shift */
+	uint32_t region_shift;
+
+	/* Number of dirty regions */
+	uint64_t num_regions;
+
+	/*
+	 * Bitmaps of regions written while the base bdev was missing, one per base
+	 * bdev. Updated from any thread, so only accessed atomically.
+	 */
+	uint64_t **dirty_regions;
+
+	/*
+	 * Region currently copied by the resync of the base bdev, one per base bdev.
+	 * RAID1_REGION_NONE if the base bdev is not being resynced.
+	 */
+	uint64_t *resync_region;
+
+	/* Resyncs in progress */
+	TAILQ_HEAD(, raid1_resync) resyncs;
+};
+
+struct raid1_io_channel {
+	/* Index of the base bdev that served the last read */
+	uint8_t last_read_idx;
+
+	/* Number of reads outstanding on each base bdev */
+	uint32_t reads_outstanding[0];
+};
+
+static inline uint64_t
+raid1_region_blocks(struct raid1_info *r1info)
+{
+	return 1ULL << r1info->region_shift;
+}
+
+static inline void
+raid1_region_set_dirty(struct raid1_info *r1info, uint8_t idx, uint64_t region)
+{
+	__atomic_fetch_or(&r1info->dirty_regions[idx][region / 64], 1ULL << (region % 64),
+			  __ATOMIC_SEQ_CST);
+}
+
+static inline bool
+raid1_region_test_and_clear_dirty(struct raid1_info *r1info, uint8_t idx, uint64_t region)
+{
+	uint64_t mask = 1ULL << (region % 64);
+
+	return __atomic_fetch_and(&r1info->dirty_regions[idx][region / 64], ~mask,
+				  __ATOMIC_SEQ_CST) & mask;
+}
+
+static uint64_t
+raid1_find_dirty_region(struct raid1_info *r1info, uint8_t idx, uint64_t start)
+{
+	uint64_t region, word;
+
+	for (region = start; region < r1info->num_regions; region++) {
+		word = __atomic_load_n(&r1info->dirty_regions[idx][region / 64], __ATOMIC_SEQ_CST);
+		if (word == 0) {
+			/* Skip the rest of this word */
+			region |= 63;
+			continue;
+		}
+		if (word & (1ULL << (region % 64))) {
+			return region;
+		}
+	}
+
+	return RAID1_REGION_NONE;
+}
+
+static void
+raid1_mark_dirty(struct raid1_info *r1info, uint8_t idx, uint64_t offset_blocks,
+		 uint64_t num_blocks)
+{
+	uint64_t region = offset_blocks >> r1info->region_shift;
+	uint64_t last = (offset_blocks + num_blocks - 1) >> r1info->region_shift;
+
+	for (; region <= last; region++) {
+		raid1_region_set_dirty(r1info, idx, region);
+	}
+}
+
+/*
+ * A write that completes while the resync copies the written region may have
+ * raced with the copy and be overwritten with stale data on the resynced base
+ * bdev. Mark such region dirty again so that the resync copies it once more.
+ */
+static void
+raid1_resync_check_write(struct raid1_info *r1info, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct raid_bdev *raid_bdev = r1info->raid_bdev;
+	uint64_t first = offset_blocks >> r1info->region_shift;
+	uint64_t last = (offset_blocks + num_blocks - 1) >> r1info->region_shift;
+	uint64_t region;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		region = __atomic_load_n(&r1info->resync_region[i], __ATOMIC_SEQ_CST);
+		if (spdk_unlikely(region != RAID1_REGION_NONE && region >= first && region <= last)) {
+			raid1_region_set_dirty(r1info, i, region);
+		}
+	}
+}
+
+static void raid1_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid1_submit_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid1_submit_rw_request(raid_io);
+}
+
+static void
+raid1_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+	struct raid1_io_channel *r1ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+
+	assert(r1ch->reads_outstanding[raid_io->base_bdev_io_submitted] > 0);
+	r1ch->reads_outstanding[raid_io->base_bdev_io_submitted]--;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete(raid_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/*
+ * brief:
+ * raid1_channel_select_read_base_bdev function selects the base bdev with the
+ * lowest number of reads outstanding on this channel, so that a slow or busy
+ * base bdev doesn't determine the read latency of the raid bdev. Ties are broken
+ * in a round-robin fashion.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * raid_ch - pointer to raid bdev io channel
+ * returns:
+ * index of the selected base bdev, UINT8_MAX if no base bdev can serve reads
+ */
+static uint8_t
+raid1_channel_select_read_base_bdev(struct raid_bdev *raid_bdev,
+				    struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_io_channel *r1ch = spdk_io_channel_get_ctx(raid_ch->module_channel);
+	uint32_t min_reads = UINT32_MAX;
+	uint8_t idx = UINT8_MAX;
+	uint8_t i, n;
+
+	for (n = 1; n <= raid_bdev->num_base_bdevs; n++) {
+		i = (r1ch->last_read_idx + n) % raid_bdev->num_base_bdevs;
+
+		if (raid_ch->base_channel[i] == NULL || raid_bdev->base_bdev_info[i].resyncing) {
+			continue;
+		}
+
+		if (r1ch->reads_outstanding[i] < min_reads) {
+			min_reads = r1ch->reads_outstanding[i];
+			idx = i;
+		}
+	}
+
+	if (idx != UINT8_MAX) {
+		r1ch->last_read_idx = idx;
+	}
+
+	return idx;
+}
+
+static void
+raid1_submit_read_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
+	struct raid1_io_channel *r1ch = spdk_io_channel_get_ctx(raid_ch->module_channel);
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t idx;
+	int ret;
+
+	idx = raid1_channel_select_read_base_bdev(raid_bdev, raid_ch);
+	if (spdk_unlikely(idx == UINT8_MAX)) {
+		SPDK_ERRLOG("No base bdev available for read\n");
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	base_info = &raid_bdev->base_bdev_info[idx];
+	base_ch = raid_ch->base_channel[idx];
+
+	/* Remember the base bdev to update the channel's outstanding reads on completion */
+	raid_io->base_bdev_io_submitted = idx;
+
+	ret = spdk_bdev_readv_blocks_ext(base_info->desc, base_ch,
+					 bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					 bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
+					 raid1_read_complete, raid_io, bdev_io->u.bdev.ext_opts);
+	if (spdk_likely(ret == 0)) {
+		r1ch->reads_outstanding[idx]++;
+	} else if (ret == -ENOMEM) {
+		raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+					_raid1_submit_rw_request);
+	} else {
+		SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+		assert(false);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+raid1_write_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+	struct spdk_bdev_io *parent_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+	uint8_t i;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid1_resync_check_write(r1info, parent_io->u.bdev.offset_blocks,
+				 parent_io->u.bdev.num_blocks);
+
+	if (!success) {
+		/*
+		 * The mirrors may differ now. It's not known which base bdev failed,
+		 * so mark the regions dirty on all of them to have the written data
+		 * copied if any of them gets resynced later.
+		 */
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			raid1_mark_dirty(r1info, i, parent_io->u.bdev.offset_blocks,
+					 parent_io->u.bdev.num_blocks);
+		}
+	}
+
+	raid_bdev_io_complete_part(raid_io, 1, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+				   SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/*
+ * brief:
+ * raid1_submit_write_request function submits the write to all base bdevs.
+ * Base bdevs which are missing are skipped and the written regions are marked
+ * dirty for them. It will submit as many writes as possible unless one base io
+ * request fails with -ENOMEM, in which case it will queue itself for later
+ * submission.
+ * params:
+ * raid_io - pointer to raid bdev io
+ * returns:
+ * none
+ */
+static void
+raid1_submit_write_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t idx;
+	int ret;
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+	}
+
+	while (raid_io->base_bdev_io_submitted < raid_bdev->num_base_bdevs) {
+		idx = raid_io->base_bdev_io_submitted;
+		base_info = &raid_bdev->base_bdev_info[idx];
+		base_ch = raid_io->raid_ch->base_channel[idx];
+
+		if (base_ch == NULL) {
+			/* The base bdev is missing, remember what it needs when it's back */
+			raid1_mark_dirty(r1info, idx, bdev_io->u.bdev.offset_blocks,
+					 bdev_io->u.bdev.num_blocks);
+			raid_io->base_bdev_io_submitted++;
+			if (raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_SUCCESS)) {
+				return;
+			}
+			continue;
+		}
+
+		ret = spdk_bdev_writev_blocks_ext(base_info->desc, base_ch,
+						  bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+						  bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks,
+						  raid1_write_complete, raid_io, bdev_io->u.bdev.ext_opts);
+		if (spdk_likely(ret == 0)) {
+			raid_io->base_bdev_io_submitted++;
+		} else if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+						_raid1_submit_rw_request);
+			return;
+		} else {
+			SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+			assert(false);
+			raid_bdev_io_complete_part(raid_io,
+						   raid_bdev->num_base_bdevs - raid_io->base_bdev_io_submitted,
+						   SPDK_BDEV_IO_STATUS_FAILED);
+			return;
+		}
+	}
+}
+
+static void
+raid1_submit_rw_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		raid1_submit_read_request(raid_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		raid1_submit_write_request(raid_io);
+		break;
+	default:
+		SPDK_ERRLOG("Recvd not supported io type %u\n", bdev_io->type);
+		assert(false);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static void raid1_submit_null_payload_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid1_submit_null_payload_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid1_submit_null_payload_request(raid_io);
+}
+
+static void
+raid1_base_io_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete_part(raid_io, 1, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+				   SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/*
+ * brief:
+ * raid1_submit_null_payload_request function submits io requests without
+ * payload, like FLUSH and UNMAP, to all base bdevs. Unmapped regions are marked
+ * dirty for missing base bdevs.
+ * params:
+ * raid_io - pointer to raid bdev io
+ * returns:
+ * none
+ */
+static void
+raid1_submit_null_payload_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t idx;
+	int ret;
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+	}
+
+	while (raid_io->base_bdev_io_submitted < raid_bdev->num_base_bdevs) {
+		idx = raid_io->base_bdev_io_submitted;
+		base_info = &raid_bdev->base_bdev_info[idx];
+		base_ch = raid_io->raid_ch->base_channel[idx];
+
+		if (base_ch == NULL) {
+			if (bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP) {
+				raid1_mark_dirty(r1info, idx, bdev_io->u.bdev.offset_blocks,
+						 bdev_io->u.bdev.num_blocks);
+			}
+			raid_io->base_bdev_io_submitted++;
+			if (raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_SUCCESS)) {
+				return;
+			}
+			continue;
+		}
+
+		switch (bdev_io->type) {
+		case SPDK_BDEV_IO_TYPE_UNMAP:
+			ret = spdk_bdev_unmap_blocks(base_info->desc, base_ch,
+						     bdev_io->u.bdev.offset_blocks,
+						     bdev_io->u.bdev.num_blocks,
+						     raid1_base_io_complete, raid_io);
+			break;
+		case SPDK_BDEV_IO_TYPE_FLUSH:
+			ret = spdk_bdev_flush_blocks(base_info->desc, base_ch,
+						     bdev_io->u.bdev.offset_blocks,
+						     bdev_io->u.bdev.num_blocks,
+						     raid1_base_io_complete, raid_io);
+			break;
+		default:
+			SPDK_ERRLOG("submit request, invalid io type with null payload %u\n", bdev_io->type);
+			assert(false);
+			ret = -EIO;
+		}
+
+		if (spdk_likely(ret == 0)) {
+			raid_io->base_bdev_io_submitted++;
+		} else if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+						_raid1_submit_null_payload_request);
+			return;
+		} else {
+			SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+			assert(false);
+			raid_bdev_io_complete_part(raid_io,
+						   raid_bdev->num_base_bdevs - raid_io->base_bdev_io_submitted,
+						   SPDK_BDEV_IO_STATUS_FAILED);
+			return;
+		}
+	}
+}
+
+static void
+raid1_resync_free(struct raid1_resync *resync)
+{
+	uint8_t i;
+
+	/* Called also for aborted resyncs, after r1info is gone */
+	for (i = 0; i < resync->num_base_channels; i++) {
+		if (resync->base_channels[i] != NULL) {
+			spdk_put_io_channel(resync->base_channels[i]);
+		}
+	}
+	free(resync->base_channels);
+	spdk_dma_free(resync->buf);
+	free(resync);
+}
+
+static void
+raid1_resync_finish(struct raid1_resync *resync, int status)
+{
+	struct raid1_info *r1info = resync->r1info;
+	struct raid_bdev *raid_bdev = r1info->raid_bdev;
+	struct raid_base_bdev_info *base_info = resync->base_info;
+
+	__atomic_store_n(&r1info->resync_region[resync->idx], RAID1_REGION_NONE, __ATOMIC_SEQ_CST);
+	TAILQ_REMOVE(&r1info->resyncs, resync, link);
+	raid1_resync_free(resync);
+
+	raid_bdev_resync_base_bdev_done(raid_bdev, base_info, status);
+}
+
+static struct spdk_io_channel *
+raid1_resync_get_base_channel(struct raid1_resync *resync, uint8_t idx)
+{
+	struct raid_base_bdev_info *base_info = &resync->r1info->raid_bdev->base_bdev_info[idx];
+
+	if (resync->base_channels[idx] == NULL) {
+		resync->base_channels[idx] = spdk_bdev_get_io_channel(base_info->desc);
+	}
+
+	return resync->base_channels[idx];
+}
+
+/* Find a base bdev that holds valid data of the whole raid bdev */
+static uint8_t
+raid1_resync_select_source(struct raid1_resync *resync)
+{
+	struct raid_bdev *raid_bdev = resync->r1info->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		base_info = &raid_bdev->base_bdev_info[i];
+		if (base_info->desc != NULL && !base_info->remove_scheduled && !base_info->resyncing) {
+			return i;
+		}
+	}
+
+	return UINT8_MAX;
+}
+
+static void raid1_resync_next(struct raid1_resync *resync);
+static void raid1_resync_copy_region(void *ctx);
+
+static void
+raid1_resync_queue_io_wait(struct raid1_resync *resync, uint8_t idx)
+{
+	struct raid_base_bdev_info *base_info = &resync->r1info->raid_bdev->base_bdev_info[idx];
+
+	resync->waitq_entry.bdev = base_info->bdev;
+	resync->waitq_entry.cb_fn = raid1_resync_copy_region;
+	resync->waitq_entry.cb_arg = resync;
+	spdk_bdev_queue_io_wait(base_info->bdev, resync->base_channels[idx], &resync->waitq_entry);
+}
+
+static void
+raid1_resync_region_failed(struct raid1_resync *resync, int status)
+{
+	raid1_region_set_dirty(resync->r1info, resync->idx, resync->region);
+	raid1_resync_finish(resync, status);
+}
+
+static void
+raid1_resync_write_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid1_resync *resync = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (resync->aborted) {
+		raid1_resync_free(resync);
+		return;
+	}
+
+	if (!success) {
+		raid1_resync_region_failed(resync, -EIO);
+		return;
+	}
+
+	resync->region++;
+	raid1_resync_next(resync);
+}
+
+static void
+raid1_resync_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid1_resync *resync = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (resync->aborted) {
+		raid1_resync_free(resync);
+		return;
+	}
+
+	if (!success) {
+		raid1_resync_region_failed(resync, -EIO);
+		return;
+	}
+
+	/* The source is done, from now on a retry after ENOMEM repeats only the write */
+	resync->source_idx = UINT8_MAX;
+	raid1_resync_copy_region(resync);
+}
+
+static void
+raid1_resync_copy_region(void *ctx)
+{
+	struct raid1_resync *resync = ctx;
+	struct raid1_info *r1info = resync->r1info;
+	struct raid_bdev *raid_bdev = r1info->raid_bdev;
+	uint64_t offset_blocks = resync->region << r1info->region_shift;
+	uint64_t num_blocks = spdk_min(raid1_region_blocks(r1info),
+				       raid_bdev->bdev.blockcnt - offset_blocks);
+	struct spdk_io_channel *ch;
+	uint8_t idx;
+	int ret;
+
+	if (resync->aborted) {
+		raid1_resync_free(resync);
+		return;
+	}
+
+	if (resync->source_idx != UINT8_MAX) {
+		idx = resync->source_idx;
+		ch = raid1_resync_get_base_channel(resync, idx);
+		if (ch == NULL) {
+			raid1_resync_region_failed(resync, -ENOMEM);
+			return;
+		}
+		ret = spdk_bdev_read_blocks(raid_bdev->base_bdev_info[idx].desc, ch, resync->buf,
+					    offset_blocks, num_blocks, raid1_resync_read_complete, resync);
+	} else {
+		idx = resync->idx;
+		ch = raid1_resync_get_base_channel(resync, idx);
+		if (ch == NULL) {
+			raid1_resync_region_failed(resync, -ENOMEM);
+			return;
+		}
+		ret = spdk_bdev_write_blocks(resync->base_info->desc, ch, resync->buf,
+					     offset_blocks, num_blocks, raid1_resync_write_complete, resync);
+	}
+
+	if (ret == -ENOMEM) {
+		raid1_resync_queue_io_wait(resync, idx);
+	} else if (ret != 0) {
+		raid1_resync_region_failed(resync, ret);
+	}
+}
+
+/*
+ * brief:
+ * raid1_resync_next function copies the next dirty region of the resynced base
+ * bdev from one of the in-sync base bdevs. The region is published as being
+ * copied and marked clean before reading it, so that writes completing during
+ * the copy can mark it dirty again. The resync finishes when no dirty region
+ * is left.
+ * params:
+ * resync - resync context
+ * returns:
+ * none
+ */
+static void
+raid1_resync_next(struct raid1_resync *resync)
+{
+	struct raid1_info *r1info = resync->r1info;
+
+	if (resync->base_info->remove_scheduled) {
+		raid1_resync_finish(resync, -ENODEV);
+		return;
+	}
+
+	resync->region = raid1_find_dirty_region(r1info, resync->idx, resync->region);
+	if (resync->region == RAID1_REGION_NONE) {
+		/* Regions before the cursor could have been dirtied again */
+		resync->region = raid1_find_dirty_region(r1info, resync->idx, 0);
+		if (resync->region == RAID1_REGION_NONE) {
+			raid1_resync_finish(resync, 0);
+			return;
+		}
+	}
+
+	resync->source_idx = raid1_resync_select_source(resync);
+	if (resync->source_idx == UINT8_MAX) {
+		SPDK_ERRLOG("No in-sync base bdev to resync from\n");
+		raid1_resync_finish(resync, -ENODEV);
+		return;
+	}
+
+	__atomic_store_n(&r1info->resync_region[resync->idx], resync->region, __ATOMIC_SEQ_CST);
+	raid1_region_test_and_clear_dirty(r1info, resync->idx, resync->region);
+
+	raid1_resync_copy_region(resync);
+}
+
+static void
+raid1_resync_base_bdev(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info)
+{
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid1_resync *resync;
+
+	if (base_info->bdev->blockcnt < raid_bdev->bdev.blockcnt ||
+	    base_info->bdev->blocklen != raid_bdev->bdev.blocklen) {
+		SPDK_ERRLOG("Base bdev %s doesn't match raid bdev %s geometry\n",
+			    base_info->bdev->name, raid_bdev->bdev.name);
+		raid_bdev_resync_base_bdev_done(raid_bdev, base_info, -EINVAL);
+		return;
+	}
+
+	resync = calloc(1, sizeof(*resync));
+	if (resync == NULL) {
+		raid_bdev_resync_base_bdev_done(raid_bdev, base_info, -ENOMEM);
+		return;
+	}
+
+	resync->r1info = r1info;
+	resync->base_info = base_info;
+	resync->idx = base_info - raid_bdev->base_bdev_info;
+
+	if (base_info->full_resync) {
+		/* The dirty regions say nothing about the contents of this base bdev */
+		raid1_mark_dirty(r1info, resync->idx, 0, raid_bdev->bdev.blockcnt);
+		base_info->full_resync = false;
+	}
+
+	resync->base_channels = calloc(raid_bdev->num_base_bdevs, sizeof(struct spdk_io_channel *));
+	resync->num_base_channels = raid_bdev->num_base_bdevs;
+	resync->buf = spdk_dma_malloc(raid1_region_blocks(r1info) * raid_bdev->bdev.blocklen,
+				      spdk_bdev_get_buf_align(&raid_bdev->bdev), NULL);
+	if (resync->base_channels == NULL || resync->buf == NULL) {
+		free(resync->base_channels);
+		spdk_dma_free(resync->buf);
+		free(resync);
+		raid_bdev_resync_base_bdev_done(raid_bdev, base_info, -ENOMEM);
+		return;
+	}
+
+	TAILQ_INSERT_TAIL(&r1info->resyncs, resync, link);
+
+	raid1_resync_next(resync);
+}
+
+static int
+raid1_ioch_create(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+raid1_ioch_destroy(void *io_device, void *ctx_buf)
+{
+}
+
+static void
+raid1_info_free(struct raid1_info *r1info)
+{
+	uint8_t i;
+
+	if (r1info->dirty_regions != NULL) {
+		for (i = 0; i < r1info->raid_bdev->num_base_bdevs; i++) {
+			free(r1info->dirty_regions[i]);
+		}
+	}
+	free(r1info->dirty_regions);
+	free(r1info->resync_region);
+	free(r1info);
+}
+
+static int
+raid1_start(struct raid_bdev *raid_bdev)
+{
+	uint64_t min_blockcnt = UINT64_MAX;
+	struct raid_base_bdev_info *base_info;
+	struct raid1_info *r1info;
+	uint32_t region_blocks;
+	uint8_t i;
+
+	r1info = calloc(1, sizeof(*r1info));
+	if (!r1info) {
+		SPDK_ERRLOG("Failed to allocate r1info\n");
+		return -ENOMEM;
+	}
+	r1info->raid_bdev = raid_bdev;
+	TAILQ_INIT(&r1info->resyncs);
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		min_blockcnt = spdk_min(min_blockcnt, base_info->bdev->blockcnt);
+	}
+
+	region_blocks = spdk_max(RAID1_REGION_SIZE_KB * 1024u >> raid_bdev->blocklen_shift, 1u);
+	r1info->region_shift = spdk_u32log2(region_blocks);
+	r1info->num_regions = SPDK_CEIL_DIV(min_blockcnt, raid1_region_blocks(r1info));
+
+	r1info->dirty_regions = calloc(raid_bdev->num_base_bdevs, sizeof(uint64_t *));
+	r1info->resync_region = calloc(raid_bdev->num_base_bdevs, sizeof(uint64_t));
+	if (!r1info->dirty_regions || !r1info->resync_region) {
+		SPDK_ERRLOG("Failed to allocate r1info\n");
+		raid1_info_free(r1info);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		r1info->dirty_regions[i] = calloc(SPDK_CEIL_DIV(r1info->num_regions, 64), sizeof(uint64_t));
+		if (!r1info->dirty_regions[i]) {
+			SPDK_ERRLOG("Failed to allocate dirty region bitmap\n");
+			raid1_info_free(r1info);
+			return -ENOMEM;
+		}
+		r1info->resync_region[i] = RAID1_REGION_NONE;
+	}
+
+	raid_bdev->bdev.blockcnt = min_blockcnt;
+	raid_bdev->module_private = r1info;
+
+	spdk_io_device_register(r1info, raid1_ioch_create, raid1_ioch_destroy,
+				sizeof(struct raid1_io_channel) +
+				raid_bdev->num_base_bdevs * sizeof(uint32_t), NULL);
+
+	return 0;
+}
+
+static void
+raid1_io_device_unregister_done(void *io_device)
+{
+	struct raid1_info *r1info = io_device;
+
+	raid1_info_free(r1info);
+}
+
+static void
+raid1_stop(struct raid_bdev *raid_bdev)
+{
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid1_resync *resync;
+
+	/* Resyncs always have an IO in flight, they are freed on its completion */
+	while ((resync = TAILQ_FIRST(&r1info->resyncs))) {
+		TAILQ_REMOVE(&r1info->resyncs, resync, link);
+		resync->aborted = true;
+		resync->base_info->resyncing = false;
+	}
+
+	spdk_io_device_unregister(r1info, raid1_io_device_unregister_done);
+}
+
+static struct spdk_io_channel *
+raid1_get_io_channel(struct raid_bdev *raid_bdev)
+{
+	struct raid1_info *r1info = raid_bdev->module_private;
+
+	return spdk_get_io_channel(r1info);
+}
+
+static struct raid_bdev_module g_raid1_module = {
+	.level = RAID1,
+	.base_bdevs_min = 2,
+	.base_bdevs_max_degraded = UINT8_MAX,
+	.memory_domains_supported = true,
+	.start = raid1_start,
+	.stop = raid1_stop,
+	.submit_rw_request = raid1_submit_rw_request,
+	.submit_null_payload_request = raid1_submit_null_payload_request,
+	.get_io_channel = raid1_get_io_channel,
+	.resync_base_bdev = raid1_resync_base_bdev,
+};
+RAID_MODULE_REGISTER(&g_raid1_module)
+
+SPDK_LOG_REGISTER_COMPONENT(bdev_raid1)
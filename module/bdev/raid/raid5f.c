@@ -9,8 +9,82 @@
 #include "spdk/thread.h"
 #include "spdk/string.h"
 #include "spdk/util.h"
+#include "spdk/likely.h"
 
 #include "spdk/log.h"
+#include "spdk/xor.h"
+
+/* Maximum concurrent full stripe writes per io channel */
+#define RAID5F_MAX_STRIPES 32
+
+/* Maximum concurrent degraded reads, reconstructing data from parity, per io channel */
+#define RAID5F_MAX_RECONSTRUCT_REQS 4
+
+/* Initial number of iovecs allocated per chunk */
+#define RAID5F_CHUNK_IOVCNT_INITIAL 4
+
+struct chunk {
+	/* Corresponds to base_bdev index */
+	uint8_t index;
+
+	/* Array of iovecs */
+	struct iovec *iovs;
+
+	/* Number of used iovecs */
+	int iovcnt;
+
+	/* Total number of available iovecs in the array */
+	int iovcnt_max;
+};
+
+enum stripe_request_type {
+	/* Full stripe write with parity generation */
+	STRIPE_REQ_WRITE,
+
+	/* Read of a missing chunk's data reconstructed from the remaining chunks */
+	STRIPE_REQ_RECONSTRUCT,
+};
+
+struct stripe_request {
+	enum stripe_request_type type;
+
+	struct raid5f_io_channel *r5ch;
+
+	/* The associated raid_bdev_io */
+	struct raid_bdev_io *raid_io;
+
+	/* The stripe's index in the raid array. */
+	uint64_t stripe_index;
+
+	/* The stripe's parity chunk */
+	struct chunk *parity_chunk;
+
+	union {
+		struct {
+			/* Buffer for stripe parity */
+			void *parity_buf;
+		} write;
+
+		struct {
+			/* The chunk which data is reconstructed */
+			struct chunk *chunk;
+
+			/* Offset of the reconstructed range in the chunk */
+			uint64_t chunk_offset;
+
+			/* Length of the reconstructed range */
+			uint64_t chunk_blocks;
+
+			/* Buffers for the range read from each chunk, indexed by chunk index */
+			void **chunk_buffers;
+		} reconstruct;
+	};
+
+	TAILQ_ENTRY(stripe_request) link;
+
+	/* Array of chunks corresponding to base_bdevs */
+	struct chunk chunks[0];
+};
 
 struct raid5f_info {
 	/* The parent raid bdev */
@@ -21,18 +95,699 @@ struct raid5f_info {
 
 	/* Number of stripes on this array */
 	uint64_t total_stripes;
+
+	/* Number of chunks in a stripe, including the parity chunk */
+	uint8_t stripe_chunks;
+
+	/* Alignment for buffer allocation */
+	size_t buf_alignment;
+};
+
+struct raid5f_io_channel {
+	/* All available stripe requests on this channel */
+	TAILQ_HEAD(, stripe_request) free_stripe_requests;
+
+	/* All available reconstruct requests on this channel */
+	TAILQ_HEAD(, stripe_request) free_reconstruct_requests;
+
+	/* Array of iovec iterators for each data chunk */
+	struct iov_iter {
+		struct iovec *iovs;
+		int iovcnt;
+		int index;
+		size_t offset;
+	} *chunk_iov_iters;
+
+	/* Array of source buffer pointers for parity calculation */
+	void **chunk_xor_buffers;
 };
 
+#define __CHUNK_IN_RANGE(req, c) \
+	c < req->chunks + raid5f_ch_to_r5f_info(req->r5ch)->stripe_chunks
+
+#define FOR_EACH_CHUNK_FROM(req, c, from) \
+	for (c = from; __CHUNK_IN_RANGE(req, c); c++)
+
+#define FOR_EACH_CHUNK(req, c) \
+	FOR_EACH_CHUNK_FROM(req, c, req->chunks)
+
+#define __NEXT_DATA_CHUNK(req, c) \
+	c == req->parity_chunk ? c+1 : c
+
+#define FOR_EACH_DATA_CHUNK(req, c) \
+	for (c = __NEXT_DATA_CHUNK(req, req->chunks); __CHUNK_IN_RANGE(req, c); \
+	     c = __NEXT_DATA_CHUNK(req, c+1))
+
+static inline struct raid5f_info *
+raid5f_ch_to_r5f_info(struct raid5f_io_channel *r5ch)
+{
+	return spdk_io_channel_get_io_device(spdk_io_channel_from_ctx(r5ch));
+}
+
+static inline struct stripe_request *
+raid5f_chunk_stripe_req(struct chunk *chunk)
+{
+	return SPDK_CONTAINEROF((chunk - chunk->index), struct stripe_request, chunks);
+}
+
 static inline uint8_t
 raid5f_stripe_data_chunks_num(const struct raid_bdev *raid_bdev)
 {
 	return raid_bdev->num_base_bdevs - raid_bdev->module->base_bdevs_max_degraded;
 }
 
+static inline uint8_t
+raid5f_stripe_parity_chunk_index(const struct raid_bdev *raid_bdev, uint64_t stripe_index)
+{
+	return raid5f_stripe_data_chunks_num(raid_bdev) - stripe_index % raid_bdev->num_base_bdevs;
+}
+
+static inline struct spdk_io_channel *
+raid5f_chunk_base_channel(struct chunk *chunk)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+
+	return stripe_req->raid_io->raid_ch->base_channel[chunk->index];
+}
+
+static inline void
+raid5f_stripe_request_release(struct stripe_request *stripe_req)
+{
+	if (stripe_req->type == STRIPE_REQ_WRITE) {
+		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests, stripe_req, link);
+	} else {
+		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_reconstruct_requests, stripe_req, link);
+	}
+}
+
+static int
+raid5f_xor_stripe(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+	size_t remaining = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	uint8_t n_src = raid5f_stripe_data_chunks_num(raid_bdev);
+	void *dest = stripe_req->write.parity_buf;
+	struct chunk *chunk;
+	uint8_t c;
+	int ret;
+
+	c = 0;
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		struct iov_iter *iov_iter = &r5ch->chunk_iov_iters[c++];
+
+		iov_iter->iovs = chunk->iovs;
+		iov_iter->iovcnt = chunk->iovcnt;
+		iov_iter->index = 0;
+		iov_iter->offset = 0;
+	}
+
+	while (remaining > 0) {
+		size_t len = remaining;
+		uint8_t i;
+
+		for (i = 0; i < n_src; i++) {
+			struct iov_iter *iov_iter = &r5ch->chunk_iov_iters[i];
+			struct iovec *iov = &iov_iter->iovs[iov_iter->index];
+
+			len = spdk_min(len, iov->iov_len - iov_iter->offset);
+			r5ch->chunk_xor_buffers[i] = iov->iov_base + iov_iter->offset;
+		}
+
+		assert(len > 0);
+
+		ret = spdk_xor_gen(dest, r5ch->chunk_xor_buffers, n_src, len);
+		if (spdk_unlikely(ret)) {
+			SPDK_ERRLOG("stripe xor failed\n");
+			return ret;
+		}
+
+		for (i = 0; i < n_src; i++) {
+			struct iov_iter *iov_iter = &r5ch->chunk_iov_iters[i];
+			struct iovec *iov = &iov_iter->iovs[iov_iter->index];
+
+			iov_iter->offset += len;
+			if (iov_iter->offset == iov->iov_len) {
+				iov_iter->offset = 0;
+				iov_iter->index++;
+			}
+		}
+
+		dest += len;
+		remaining -= len;
+	}
+
+	return 0;
+}
+
+static int
+raid5f_xor_reconstruct(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+	struct chunk *chunk;
+	size_t offset = 0;
+	uint8_t n_src;
+	int i, ret;
+
+	for (i = 0; i < bdev_io->u.bdev.iovcnt; i++) {
+		struct iovec *iov = &bdev_io->u.bdev.iovs[i];
+
+		n_src = 0;
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk != stripe_req->reconstruct.chunk) {
+				r5ch->chunk_xor_buffers[n_src++] =
+					stripe_req->reconstruct.chunk_buffers[chunk->index] + offset;
+			}
+		}
+
+		ret = spdk_xor_gen(iov->iov_base, r5ch->chunk_xor_buffers, n_src, iov->iov_len);
+		if (spdk_unlikely(ret)) {
+			SPDK_ERRLOG("reconstruct xor failed\n");
+			return ret;
+		}
+		offset += iov->iov_len;
+	}
+
+	return 0;
+}
+
+static void
+raid5f_stripe_request_complete_part(struct stripe_request *stripe_req, uint64_t completed,
+				    enum spdk_bdev_io_status status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	assert(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_io->base_bdev_io_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining > 0) {
+		return;
+	}
+
+	if (stripe_req->type == STRIPE_REQ_RECONSTRUCT &&
+	    raid_io->base_bdev_io_status == SPDK_BDEV_IO_STATUS_SUCCESS &&
+	    raid5f_xor_reconstruct(stripe_req) != 0) {
+		raid_io->base_bdev_io_status = SPDK_BDEV_IO_STATUS_FAILED;
+	}
+
+	raid5f_stripe_request_release(stripe_req);
+	raid_bdev_io_complete(raid_io, raid_io->base_bdev_io_status);
+}
+
+static void
+raid5f_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct chunk *chunk = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid5f_stripe_request_complete_part(raid5f_chunk_stripe_req(chunk), 1,
+					    success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+					    SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid5f_stripe_request_submit_chunks(struct stripe_request *stripe_req);
+
+static void
+raid5f_chunk_submit_retry(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+	struct stripe_request *stripe_req = raid_io->module_private;
+
+	raid5f_stripe_request_submit_chunks(stripe_req);
+}
+
+static int
+raid5f_chunk_submit(struct chunk *chunk)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk->index];
+	struct spdk_io_channel *base_ch = raid_io->raid_ch->base_channel[chunk->index];
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	uint64_t base_offset_blocks = (stripe_req->stripe_index << raid_bdev->strip_size_shift);
+	struct spdk_bdev_ext_io_opts *ext_opts;
+	int ret;
+
+	if (stripe_req->type == STRIPE_REQ_WRITE) {
+		/* Data chunks map the buffers of the raid IO, the parity chunk has its own */
+		ext_opts = chunk != stripe_req->parity_chunk ? bdev_io->u.bdev.ext_opts : NULL;
+		ret = spdk_bdev_writev_blocks_ext(base_info->desc, base_ch, chunk->iovs, chunk->iovcnt,
+						  base_offset_blocks, raid_bdev->strip_size,
+						  raid5f_chunk_complete_bdev_io, chunk, ext_opts);
+	} else {
+		/*
+		 * All chunks are read to the buffers of the stripe request and the data is
+		 * reconstructed from them to the buffers of the raid IO.
+		 */
+		ret = spdk_bdev_readv_blocks_ext(base_info->desc, base_ch, chunk->iovs, chunk->iovcnt,
+						 base_offset_blocks + stripe_req->reconstruct.chunk_offset,
+						 stripe_req->reconstruct.chunk_blocks,
+						 raid5f_chunk_complete_bdev_io, chunk, NULL);
+	}
+
+	if (spdk_unlikely(ret)) {
+		if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+						raid5f_chunk_submit_retry);
+		} else {
+			/*
+			 * Implicitly complete any I/Os not yet submitted as FAILED. If completing
+			 * these means there are no more to complete for the stripe request, the
+			 * stripe request is released as well.
+			 */
+			uint64_t base_bdev_io_not_submitted = raid_bdev->num_base_bdevs -
+							      raid_io->base_bdev_io_submitted;
+
+			raid5f_stripe_request_complete_part(stripe_req, base_bdev_io_not_submitted,
+							    SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+
+	return ret;
+}
+
+static void
+raid5f_stripe_request_submit_chunks(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct chunk *start = &stripe_req->chunks[raid_io->base_bdev_io_submitted];
+	struct chunk *chunk;
+
+	FOR_EACH_CHUNK_FROM(stripe_req, chunk, start) {
+		if (spdk_unlikely(raid5f_chunk_base_channel(chunk) == NULL)) {
+			enum spdk_bdev_io_status status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+			/*
+			 * The base bdev of this chunk is missing. Writes skip it, the data can be
+			 * recovered from the other chunks. Reads can reconstruct only one chunk.
+			 */
+			if (stripe_req->type == STRIPE_REQ_RECONSTRUCT &&
+			    chunk != stripe_req->reconstruct.chunk) {
+				status = SPDK_BDEV_IO_STATUS_FAILED;
+			}
+
+			raid_io->base_bdev_io_submitted++;
+			raid5f_stripe_request_complete_part(stripe_req, 1, status);
+			continue;
+		}
+
+		if (spdk_unlikely(raid5f_chunk_submit(chunk) != 0)) {
+			break;
+		}
+		raid_io->base_bdev_io_submitted++;
+	}
+}
+
+static int
+raid5f_stripe_request_map_iovecs(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req->raid_io->raid_bdev;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(stripe_req->raid_io);
+	const struct iovec *raid_io_iovs = bdev_io->u.bdev.iovs;
+	int raid_io_iovcnt = bdev_io->u.bdev.iovcnt;
+	struct chunk *chunk;
+	int raid_io_iov_idx = 0;
+	size_t raid_io_offset = 0;
+	size_t raid_io_iov_offset = 0;
+	int i;
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		int chunk_iovcnt = 0;
+		uint64_t len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+		size_t off = raid_io_iov_offset;
+
+		for (i = raid_io_iov_idx; i < raid_io_iovcnt; i++) {
+			chunk_iovcnt++;
+			off += raid_io_iovs[i].iov_len;
+			if (off >= raid_io_offset + len) {
+				break;
+			}
+		}
+
+		assert(raid_io_iov_idx + chunk_iovcnt <= raid_io_iovcnt);
+
+		if (chunk_iovcnt > chunk->iovcnt_max) {
+			struct iovec *iovs = chunk->iovs;
+
+			iovs = realloc(iovs, chunk_iovcnt * sizeof(*iovs));
+			if (!iovs) {
+				return -ENOMEM;
+			}
+			chunk->iovs = iovs;
+			chunk->iovcnt_max = chunk_iovcnt;
+		}
+		chunk->iovcnt = chunk_iovcnt;
+
+		for (i = 0; i < chunk_iovcnt; i++) {
+			struct iovec *chunk_iov = &chunk->iovs[i];
+			const struct iovec *raid_io_iov = &raid_io_iovs[raid_io_iov_idx];
+			size_t chunk_iov_offset = raid_io_offset - raid_io_iov_offset;
+
+			chunk_iov->iov_base = raid_io_iov->iov_base + chunk_iov_offset;
+			chunk_iov->iov_len = spdk_min(len, raid_io_iov->iov_len - chunk_iov_offset);
+			raid_io_offset += chunk_iov->iov_len;
+			len -= chunk_iov->iov_len;
+
+			if (raid_io_offset >= raid_io_iov_offset + raid_io_iov->iov_len) {
+				raid_io_iov_idx++;
+				raid_io_iov_offset += raid_io_iov->iov_len;
+			}
+		}
+
+		if (spdk_unlikely(len > 0)) {
+			return -EINVAL;
+		}
+	}
+
+	stripe_req->parity_chunk->iovs[0].iov_base = stripe_req->write.parity_buf;
+	stripe_req->parity_chunk->iovs[0].iov_len = raid_bdev->strip_size <<
+			raid_bdev->blocklen_shift;
+	stripe_req->parity_chunk->iovcnt = 1;
+
+	return 0;
+}
+
+static int
+raid5f_submit_write_request(struct raid_bdev_io *raid_io, uint64_t stripe_index)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+	struct stripe_request *stripe_req;
+	int ret;
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	stripe_req->stripe_index = stripe_index;
+	stripe_req->parity_chunk = stripe_req->chunks + raid5f_stripe_parity_chunk_index(raid_bdev,
+				   stripe_req->stripe_index);
+	stripe_req->raid_io = raid_io;
+
+	ret = raid5f_stripe_request_map_iovecs(stripe_req);
+	if (spdk_unlikely(ret)) {
+		return ret;
+	}
+
+	/* No need to calculate parity if the parity chunk's base bdev is missing */
+	if (raid5f_chunk_base_channel(stripe_req->parity_chunk) != NULL) {
+		ret = raid5f_xor_stripe(stripe_req);
+		if (spdk_unlikely(ret)) {
+			return ret;
+		}
+	}
+
+	TAILQ_REMOVE(&r5ch->free_stripe_requests, stripe_req, link);
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+
+	raid5f_stripe_request_submit_chunks(stripe_req);
+
+	return 0;
+}
+
+static int
+raid5f_submit_reconstruct_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+				  uint8_t chunk_idx, uint64_t chunk_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_reconstruct_requests);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	TAILQ_REMOVE(&r5ch->free_reconstruct_requests, stripe_req, link);
+
+	stripe_req->stripe_index = stripe_index;
+	stripe_req->parity_chunk = stripe_req->chunks + raid5f_stripe_parity_chunk_index(raid_bdev,
+				   stripe_req->stripe_index);
+	stripe_req->raid_io = raid_io;
+	stripe_req->reconstruct.chunk = &stripe_req->chunks[chunk_idx];
+	stripe_req->reconstruct.chunk_offset = chunk_offset;
+	stripe_req->reconstruct.chunk_blocks = bdev_io->u.bdev.num_blocks;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->iovs[0].iov_base = stripe_req->reconstruct.chunk_buffers[chunk->index];
+		chunk->iovs[0].iov_len = bdev_io->u.bdev.num_blocks << raid_bdev->blocklen_shift;
+		chunk->iovcnt = 1;
+	}
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+
+	raid5f_stripe_request_submit_chunks(stripe_req);
+
+	return 0;
+}
+
+static void
+raid5f_chunk_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete(raid_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid5f_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid5f_submit_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid5f_submit_rw_request(raid_io);
+}
+
+static int
+raid5f_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			   uint64_t stripe_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t chunk_data_idx = stripe_offset >> raid_bdev->strip_size_shift;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+	uint8_t chunk_idx = chunk_data_idx < p_idx ? chunk_data_idx : chunk_data_idx + 1;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk_idx];
+	struct spdk_io_channel *base_ch = raid_io->raid_ch->base_channel[chunk_idx];
+	uint64_t chunk_offset = stripe_offset - (chunk_data_idx << raid_bdev->strip_size_shift);
+	uint64_t base_offset_blocks = (stripe_index << raid_bdev->strip_size_shift) + chunk_offset;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	int ret;
+
+	if (spdk_unlikely(base_ch == NULL)) {
+		/* The base bdev is missing, reconstruct the data from the other chunks */
+		return raid5f_submit_reconstruct_request(raid_io, stripe_index, chunk_idx, chunk_offset);
+	}
+
+	ret = spdk_bdev_readv_blocks_ext(base_info->desc, base_ch, bdev_io->u.bdev.iovs,
+					 bdev_io->u.bdev.iovcnt,
+					 base_offset_blocks, bdev_io->u.bdev.num_blocks, raid5f_chunk_read_complete, raid_io,
+					 bdev_io->u.bdev.ext_opts);
+
+	if (spdk_unlikely(ret == -ENOMEM)) {
+		raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+					_raid5f_submit_rw_request);
+		return 0;
+	}
+
+	return ret;
+}
+
 static void
 raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 {
-	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint64_t offset_blocks = bdev_io->u.bdev.offset_blocks;
+	uint64_t stripe_index = offset_blocks / r5f_info->stripe_blocks;
+	uint64_t stripe_offset = offset_blocks % r5f_info->stripe_blocks;
+	int ret;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		assert(bdev_io->u.bdev.num_blocks <= raid_bdev->strip_size);
+		ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		if (spdk_unlikely(stripe_offset != 0 ||
+				  bdev_io->u.bdev.num_blocks != r5f_info->stripe_blocks)) {
+			SPDK_ERRLOG("Partial stripe writes are not supported (offset %" PRIu64
+				    ", num_blocks %" PRIu64 ")\n", offset_blocks, bdev_io->u.bdev.num_blocks);
+			ret = -EINVAL;
+			break;
+		}
+		ret = raid5f_submit_write_request(raid_io, stripe_index);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	if (spdk_unlikely(ret)) {
+		raid_bdev_io_complete(raid_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+raid5f_stripe_request_free(struct stripe_request *stripe_req, uint8_t stripe_chunks)
+{
+	uint8_t i;
+
+	for (i = 0; i < stripe_chunks; i++) {
+		free(stripe_req->chunks[i].iovs);
+	}
+
+	if (stripe_req->type == STRIPE_REQ_WRITE) {
+		spdk_dma_free(stripe_req->write.parity_buf);
+	} else if (stripe_req->reconstruct.chunk_buffers != NULL) {
+		for (i = 0; i < stripe_chunks; i++) {
+			spdk_dma_free(stripe_req->reconstruct.chunk_buffers[i]);
+		}
+		free(stripe_req->reconstruct.chunk_buffers);
+	}
+
+	free(stripe_req);
+}
+
+static struct stripe_request *
+raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_type type)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	uint32_t buf_len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	uint8_t i;
+
+	stripe_req = calloc(1, sizeof(*stripe_req) +
+			    sizeof(struct chunk) * r5f_info->stripe_chunks);
+	if (!stripe_req) {
+		return NULL;
+	}
+
+	stripe_req->r5ch = r5ch;
+	stripe_req->type = type;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->index = chunk - stripe_req->chunks;
+		chunk->iovcnt_max = RAID5F_CHUNK_IOVCNT_INITIAL;
+		chunk->iovs = calloc(chunk->iovcnt_max, sizeof(chunk->iovs[0]));
+		if (!chunk->iovs) {
+			goto err;
+		}
+	}
+
+	if (type == STRIPE_REQ_WRITE) {
+		stripe_req->write.parity_buf = spdk_dma_malloc(buf_len, r5f_info->buf_alignment, NULL);
+		if (!stripe_req->write.parity_buf) {
+			goto err;
+		}
+	} else {
+		stripe_req->reconstruct.chunk_buffers = calloc(r5f_info->stripe_chunks, sizeof(void *));
+		if (!stripe_req->reconstruct.chunk_buffers) {
+			goto err;
+		}
+
+		for (i = 0; i < r5f_info->stripe_chunks; i++) {
+			stripe_req->reconstruct.chunk_buffers[i] = spdk_dma_malloc(buf_len,
+					r5f_info->buf_alignment, NULL);
+			if (!stripe_req->reconstruct.chunk_buffers[i]) {
+				goto err;
+			}
+		}
+	}
+
+	return stripe_req;
+err:
+	raid5f_stripe_request_free(stripe_req, r5f_info->stripe_chunks);
+	return NULL;
+}
+
+static void
+raid5f_ioch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid5f_io_channel *r5ch = ctx_buf;
+	struct raid5f_info *r5f_info = io_device;
+	struct stripe_request *stripe_req;
+
+	while ((stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests))) {
+		TAILQ_REMOVE(&r5ch->free_stripe_requests, stripe_req, link);
+		raid5f_stripe_request_free(stripe_req, r5f_info->stripe_chunks);
+	}
+
+	while ((stripe_req = TAILQ_FIRST(&r5ch->free_reconstruct_requests))) {
+		TAILQ_REMOVE(&r5ch->free_reconstruct_requests, stripe_req, link);
+		raid5f_stripe_request_free(stripe_req, r5f_info->stripe_chunks);
+	}
+
+	free(r5ch->chunk_iov_iters);
+	free(r5ch->chunk_xor_buffers);
+}
+
+static int
+raid5f_ioch_create(void *io_device, void *ctx_buf)
+{
+	struct raid5f_io_channel *r5ch = ctx_buf;
+	struct raid5f_info *r5f_info = io_device;
+	struct stripe_request *stripe_req;
+	int i;
+
+	TAILQ_INIT(&r5ch->free_stripe_requests);
+	TAILQ_INIT(&r5ch->free_reconstruct_requests);
+
+	for (i = 0; i < RAID5F_MAX_STRIPES; i++) {
+		stripe_req = raid5f_stripe_request_alloc(r5ch, STRIPE_REQ_WRITE);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests, stripe_req, link);
+	}
+
+	for (i = 0; i < RAID5F_MAX_RECONSTRUCT_REQS; i++) {
+		stripe_req = raid5f_stripe_request_alloc(r5ch, STRIPE_REQ_RECONSTRUCT);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r5ch->free_reconstruct_requests, stripe_req, link);
+	}
+
+	r5ch->chunk_iov_iters = calloc(r5f_info->stripe_chunks, sizeof(r5ch->chunk_iov_iters[0]));
+	if (!r5ch->chunk_iov_iters) {
+		goto err;
+	}
+
+	r5ch->chunk_xor_buffers = calloc(r5f_info->stripe_chunks, sizeof(r5ch->chunk_xor_buffers[0]));
+	if (!r5ch->chunk_xor_buffers) {
+		goto err;
+	}
+
+	return 0;
+err:
+	SPDK_ERRLOG("Failed to initialize io channel\n");
+	raid5f_ioch_destroy(r5f_info, r5ch);
+	return -ENOMEM;
 }
 
 static int
@@ -41,6 +796,7 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	uint64_t min_blockcnt = UINT64_MAX;
 	struct raid_base_bdev_info *base_info;
 	struct raid5f_info *r5f_info;
+	size_t alignment = 0;
 
 	r5f_info = calloc(1, sizeof(*r5f_info));
 	if (!r5f_info) {
@@ -51,26 +807,52 @@ raid5f_start(struct raid_bdev *raid_bdev)
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		min_blockcnt = spdk_min(min_blockcnt, base_info->bdev->blockcnt);
+		alignment = spdk_max(alignment, spdk_bdev_get_buf_align(base_info->bdev));
 	}
 
 	r5f_info->total_stripes = min_blockcnt / raid_bdev->strip_size;
 	r5f_info->stripe_blocks = raid_bdev->strip_size * raid5f_stripe_data_chunks_num(raid_bdev);
+	r5f_info->stripe_chunks = raid_bdev->num_base_bdevs;
+	r5f_info->buf_alignment = spdk_max(alignment, spdk_xor_get_optimal_alignment());
 
 	raid_bdev->bdev.blockcnt = r5f_info->stripe_blocks * r5f_info->total_stripes;
-	raid_bdev->bdev.optimal_io_boundary = r5f_info->stripe_blocks;
+	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
 	raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
+	raid_bdev->bdev.split_on_write_unit = true;
 
 	raid_bdev->module_private = r5f_info;
 
+	spdk_io_device_register(r5f_info, raid5f_ioch_create, raid5f_ioch_destroy,
+				sizeof(struct raid5f_io_channel), NULL);
+
 	return 0;
 }
 
+static void
+raid5f_io_device_unregister_done(void *io_device)
+{
+	struct raid5f_info *r5f_info = io_device;
+
+	free(r5f_info);
+}
+
 static void
 raid5f_stop(struct raid_bdev *raid_bdev)
 {
 	struct raid5f_info *r5f_info = raid_bdev->module_private;
 
-	free(r5f_info);
+	/* The raid bdev's io channels may still hold raid5f io channels at this point.
+	 * r5f_info is released only after all of them are destroyed. */
+	spdk_io_device_unregister(r5f_info, raid5f_io_device_unregister_done);
+}
+
+static struct spdk_io_channel *
+raid5f_get_io_channel(struct raid_bdev *raid_bdev)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+
+	return spdk_get_io_channel(r5f_info);
 }
 
 static struct raid_bdev_module g_raid5f_module = {
@@ -80,6 +862,7 @@ static struct raid_bdev_module g_raid5f_module = {
 	.start = raid5f_start,
 	.stop = raid5f_stop,
 	.submit_rw_request = raid5f_submit_rw_request,
+	.get_io_channel = raid5f_get_io_channel,
 };
 RAID_MODULE_REGISTER(&g_raid5f_module)
 
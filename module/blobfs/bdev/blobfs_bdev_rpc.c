@@ -60,6 +60,40 @@ rpc_blobfs_set_cache_size(struct spdk_jsonrpc_request *request,
 SPDK_RPC_REGISTER("blobfs_set_cache_size", rpc_blobfs_set_cache_size,
 		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
 
+static void
+rpc_blobfs_get_cache_stats(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct spdk_json_write_ctx *w;
+	struct spdk_fs_cache_stats stats;
+
+	if (params != NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "blobfs_get_cache_stats requires no parameters");
+		return;
+	}
+
+	spdk_fs_get_cache_stats(&stats);
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "hits", stats.hits);
+	spdk_json_write_named_uint64(w, "misses", stats.misses);
+	spdk_json_write_named_uint64(w, "evictions", stats.evictions);
+	spdk_json_write_named_uint64(w, "recent_ghost_hits", stats.recent_ghost_hits);
+	spdk_json_write_named_uint64(w, "frequent_ghost_hits", stats.frequent_ghost_hits);
+	spdk_json_write_named_uint64(w, "readahead_buffers", stats.readahead_buffers);
+	spdk_json_write_named_uint64(w, "readahead_unused", stats.readahead_unused);
+	spdk_json_write_named_uint64(w, "recent_buffers", stats.recent_buffers);
+	spdk_json_write_named_uint64(w, "frequent_buffers", stats.frequent_buffers);
+	spdk_json_write_named_uint64(w, "target_recent_buffers", stats.target_recent_buffers);
+	spdk_json_write_named_uint64(w, "total_buffers", stats.total_buffers);
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+
+SPDK_RPC_REGISTER("blobfs_get_cache_stats", rpc_blobfs_get_cache_stats, SPDK_RPC_RUNTIME)
+
 struct rpc_blobfs_detect {
 	char *bdev_name;
 
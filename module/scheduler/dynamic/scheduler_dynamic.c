@@ -8,6 +8,7 @@
 #include "spdk/event.h"
 #include "spdk/log.h"
 #include "spdk/env.h"
+#include "spdk/tree.h"
 
 #include "spdk/thread.h"
 #include "spdk_internal/event.h"
@@ -20,13 +21,41 @@ struct core_stats {
 	uint64_t busy;
 	uint64_t idle;
 	uint32_t thread_count;
+	/* Reactor counters at the last balance or steal, used to measure the load since then */
+	uint64_t last_busy_tsc;
+	uint64_t last_idle_tsc;
 };
 
 static struct core_stats *g_cores;
 
+/* Load of a thread predicted from its recent scheduling periods, used in bin packing mode. */
+struct thread_load {
+	uint64_t		thread_id;
+	/* Predicted percentage of time the thread will be busy */
+	uint8_t			load;
+	uint64_t		generation;
+	RB_ENTRY(thread_load)	node;
+};
+
+static int
+thread_load_cmp(struct thread_load *load1, struct thread_load *load2)
+{
+	return (load1->thread_id < load2->thread_id ? -1 : load1->thread_id > load2->thread_id);
+}
+
+static RB_HEAD(thread_load_tree, thread_load) g_thread_loads = RB_INITIALIZER(g_thread_loads);
+RB_GENERATE_STATIC(thread_load_tree, thread_load, node, thread_load_cmp);
+
+static uint64_t g_balance_generation;
+
+/* Weight in percent of the previous prediction when averaging thread load over periods */
+#define LOAD_HISTORY_WEIGHT 50
+
 uint8_t g_scheduler_load_limit = 20;
 uint8_t g_scheduler_core_limit = 80;
 uint8_t g_scheduler_core_busy = 95;
+bool g_scheduler_bin_packing = false;
+bool g_scheduler_work_stealing = false;
 
 static uint8_t
 _busy_pct(uint64_t busy, uint64_t idle)
@@ -229,6 +258,233 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 	return current_lcore;
 }
 
+static uint64_t
+_get_period_tsc(void)
+{
+	return spdk_scheduler_get_period() * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+}
+
+static void
+_predict_thread_load(struct spdk_scheduler_thread_info *thread_info)
+{
+	struct thread_load find = {}, *load;
+	uint64_t period_tsc = _get_period_tsc();
+	uint8_t current_load = _get_thread_load(thread_info);
+
+	find.thread_id = thread_info->thread_id;
+	load = RB_FIND(thread_load_tree, &g_thread_loads, &find);
+	if (load == NULL) {
+		load = calloc(1, sizeof(*load));
+		if (load == NULL) {
+			/* Fall back to the load from the last period. */
+			load = &find;
+		} else {
+			load->thread_id = thread_info->thread_id;
+			RB_INSERT(thread_load_tree, &g_thread_loads, load);
+		}
+		load->load = current_load;
+	} else {
+		load->load = (load->load * LOAD_HISTORY_WEIGHT +
+			      current_load * (100 - LOAD_HISTORY_WEIGHT)) / 100;
+	}
+	load->generation = g_balance_generation;
+
+	/* Express the prediction in ticks of a full scheduling period, so that loads of threads
+	 * that were moved or created in the middle of the last period can be compared. */
+	thread_info->current_stats.busy_tsc = period_tsc * load->load / 100;
+	thread_info->current_stats.idle_tsc = period_tsc - thread_info->current_stats.busy_tsc;
+	g_cores[thread_info->lcore].busy += thread_info->current_stats.busy_tsc;
+}
+
+static void
+_predict_loads(struct spdk_scheduler_core_info *cores_info)
+{
+	struct thread_load *load, *tmp;
+	uint64_t period_tsc = _get_period_tsc();
+	uint32_t i;
+
+	g_balance_generation++;
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		g_cores[i].busy = 0;
+	}
+
+	_foreach_thread(cores_info, _predict_thread_load);
+
+	/* Forget about threads that no longer exist. */
+	RB_FOREACH_SAFE(load, thread_load_tree, &g_thread_loads, tmp) {
+		if (load->generation != g_balance_generation) {
+			RB_REMOVE(thread_load_tree, &g_thread_loads, load);
+			free(load);
+		}
+	}
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		g_cores[i].idle = period_tsc - spdk_min(period_tsc, g_cores[i].busy);
+	}
+}
+
+static void
+_place_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
+{
+	struct core_stats *dst = &g_cores[dst_core];
+	uint64_t busy_tsc = thread_info->current_stats.busy_tsc;
+
+	SPDK_DTRACE_PROBE2(dynsched_move, thread_info, dst_core);
+
+	dst->busy += spdk_min(UINT64_MAX - dst->busy, busy_tsc);
+	dst->idle -= spdk_min(dst->idle, busy_tsc);
+	dst->thread_count++;
+
+	thread_info->lcore = dst_core;
+}
+
+static void
+_unplace_thread(struct spdk_scheduler_thread_info *thread_info)
+{
+	struct core_stats *src = &g_cores[thread_info->lcore];
+	uint64_t busy_tsc = thread_info->current_stats.busy_tsc;
+
+	src->busy -= spdk_min(src->busy, busy_tsc);
+	src->idle += spdk_min(UINT64_MAX - src->idle, busy_tsc);
+	assert(src->thread_count > 0);
+	src->thread_count--;
+}
+
+static bool
+_can_core_pack_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
+{
+	struct core_stats *dst = &g_cores[dst_core];
+	uint64_t busy_tsc = thread_info->current_stats.busy_tsc;
+
+	/* A thread can always be placed on an empty core. */
+	if (dst->thread_count == 0) {
+		return true;
+	}
+
+	if (dst->idle < busy_tsc) {
+		return false;
+	}
+
+	return _busy_pct(dst->busy + busy_tsc, dst->idle - busy_tsc) < g_scheduler_core_limit;
+}
+
+/*
+ * Pick a core for a thread using best fit: the fullest core that can still take the
+ * thread, so that the remaining cores can be switched to interrupt mode. Cores on
+ * the same NUMA node as the one the thread currently runs on are always preferred.
+ * If no core can fit the thread, the least busy core is used.
+ */
+static uint32_t
+_find_packing_core(struct spdk_scheduler_thread_info *thread_info, uint32_t src_core)
+{
+	struct spdk_thread *thread;
+	struct spdk_cpuset *cpumask;
+	uint32_t i, socket_id, best = SPDK_ENV_LCORE_ID_ANY, least_busy = SPDK_ENV_LCORE_ID_ANY;
+	bool local, best_local = false, least_busy_local = false;
+
+	thread = spdk_thread_get_by_id(thread_info->thread_id);
+	if (thread == NULL) {
+		return src_core;
+	}
+	cpumask = spdk_thread_get_cpumask(thread);
+	socket_id = spdk_env_get_socket_id(src_core);
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (!spdk_cpuset_get_cpu(cpumask, i)) {
+			continue;
+		}
+		local = spdk_env_get_socket_id(i) == socket_id;
+
+		if (least_busy == SPDK_ENV_LCORE_ID_ANY || (local && !least_busy_local) ||
+		    (local == least_busy_local && g_cores[i].busy < g_cores[least_busy].busy)) {
+			least_busy = i;
+			least_busy_local = local;
+		}
+
+		if (!_can_core_pack_thread(thread_info, i)) {
+			continue;
+		}
+
+		if (best == SPDK_ENV_LCORE_ID_ANY || (local && !best_local) ||
+		    (local == best_local && (g_cores[i].idle < g_cores[best].idle ||
+					     (g_cores[i].idle == g_cores[best].idle && i == src_core)))) {
+			best = i;
+			best_local = local;
+		}
+	}
+
+	if (best != SPDK_ENV_LCORE_ID_ANY) {
+		return best;
+	}
+
+	return least_busy != SPDK_ENV_LCORE_ID_ANY ? least_busy : src_core;
+}
+
+static int
+_thread_load_desc_cmp(const void *a, const void *b)
+{
+	uint64_t busy1 = (*(struct spdk_scheduler_thread_info * const *)a)->current_stats.busy_tsc;
+	uint64_t busy2 = (*(struct spdk_scheduler_thread_info * const *)b)->current_stats.busy_tsc;
+
+	if (busy1 == busy2) {
+		return 0;
+	}
+
+	return busy1 > busy2 ? -1 : 1;
+}
+
+static void _balance_active(struct spdk_scheduler_thread_info *thread_info);
+
+/* Distribute active threads with first fit decreasing bin packing, starting from the busiest. */
+static void
+_balance_pack(struct spdk_scheduler_core_info *cores_info)
+{
+	struct spdk_scheduler_core_info *core;
+	struct spdk_scheduler_thread_info **threads, *thread_info;
+	uint32_t i, j, count = 0, src_core;
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		count += cores_info[i].threads_count;
+	}
+	if (count == 0) {
+		return;
+	}
+
+	threads = calloc(count, sizeof(*threads));
+	if (threads == NULL) {
+		SPDK_ERRLOG("Failed to allocate memory for bin packing, using default balancing.\n");
+		_foreach_thread(cores_info, _balance_active);
+		return;
+	}
+
+	count = 0;
+	SPDK_ENV_FOREACH_CORE(i) {
+		core = &cores_info[i];
+		for (j = 0; j < core->threads_count; j++) {
+			thread_info = &core->thread_infos[j];
+			if (_get_thread_load(thread_info) >= g_scheduler_load_limit) {
+				threads[count++] = thread_info;
+			}
+		}
+	}
+
+	qsort(threads, count, sizeof(*threads), _thread_load_desc_cmp);
+
+	/* Take all active threads off their cores first, so that each of them is placed
+	 * against the load of the threads already packed. */
+	for (i = 0; i < count; i++) {
+		_unplace_thread(threads[i]);
+	}
+
+	for (i = 0; i < count; i++) {
+		src_core = threads[i]->lcore;
+		_place_thread(threads[i], _find_packing_core(threads[i], src_core));
+	}
+
+	free(threads);
+}
+
 static int
 init(void)
 {
@@ -255,6 +511,13 @@ init(void)
 static void
 deinit(void)
 {
+	struct thread_load *load, *tmp;
+
+	RB_FOREACH_SAFE(load, thread_load_tree, &g_thread_loads, tmp) {
+		RB_REMOVE(thread_load_tree, &g_thread_loads, load);
+		free(load);
+	}
+
 	free(g_cores);
 	g_cores = NULL;
 	spdk_governor_set(NULL);
@@ -301,15 +564,27 @@ balance(struct spdk_scheduler_core_info *cores_info, uint32_t cores_count)
 		g_cores[i].thread_count = cores_info[i].threads_count;
 		g_cores[i].busy = cores_info[i].current_busy_tsc;
 		g_cores[i].idle = cores_info[i].current_idle_tsc;
+		g_cores[i].last_busy_tsc = cores_info[i].total_busy_tsc;
+		g_cores[i].last_idle_tsc = cores_info[i].total_idle_tsc;
 		SPDK_DTRACE_PROBE2(dynsched_core_info, i, &cores_info[i]);
 	}
 	main_core = &g_cores[g_main_lcore];
 
+	/* In bin packing mode, thread and core loads are replaced by predictions
+	 * based on the previous periods. */
+	if (g_scheduler_bin_packing) {
+		_predict_loads(cores_info);
+	}
+
 	/* Distribute threads in two passes, to make sure updated core stats are considered on each pass.
 	 * 1) Move all idle threads to main core. */
 	_foreach_thread(cores_info, _balance_idle);
 	/* 2) Distribute active threads across all cores. */
-	_foreach_thread(cores_info, _balance_active);
+	if (g_scheduler_bin_packing) {
+		_balance_pack(cores_info);
+	} else {
+		_foreach_thread(cores_info, _balance_active);
+	}
 
 	/* Switch unused cores to interrupt mode and switch cores to polled mode
 	 * if they will be used after rebalancing */
@@ -353,16 +628,96 @@ balance(struct spdk_scheduler_core_info *cores_info, uint32_t cores_count)
 	}
 }
 
+/*
+ * Called between scheduling periods to let a core that is mostly idle take a thread from
+ * an overloaded core, instead of waiting for the next balance. Reactor counters of other
+ * cores are read without synchronization, so they might be slightly stale, which is
+ * acceptable for this heuristic.
+ */
+static bool
+steal(uint32_t *src_lcore, uint32_t *dst_lcore)
+{
+	struct spdk_reactor *reactor;
+	uint32_t i, src = SPDK_ENV_LCORE_ID_ANY, dst = SPDK_ENV_LCORE_ID_ANY;
+	uint8_t busy_pct, src_pct = 0, dst_pct = 0;
+	bool dst_local = false, local;
+
+	if (!g_scheduler_work_stealing) {
+		return false;
+	}
+
+	/* Find the most overloaded core that has a thread to give away. */
+	SPDK_ENV_FOREACH_CORE(i) {
+		reactor = spdk_reactor_get(i);
+		if (reactor->in_interrupt || reactor->thread_count <= 1) {
+			continue;
+		}
+		busy_pct = _busy_pct(reactor->busy_tsc - g_cores[i].last_busy_tsc,
+				     reactor->idle_tsc - g_cores[i].last_idle_tsc);
+		if (busy_pct >= g_scheduler_core_busy && busy_pct > src_pct) {
+			src = i;
+			src_pct = busy_pct;
+		}
+	}
+	if (src == SPDK_ENV_LCORE_ID_ANY) {
+		return false;
+	}
+
+	/* Find the least busy polling core to take it, preferring the same NUMA node. */
+	SPDK_ENV_FOREACH_CORE(i) {
+		reactor = spdk_reactor_get(i);
+		if (i == src || reactor->in_interrupt) {
+			continue;
+		}
+		busy_pct = _busy_pct(reactor->busy_tsc - g_cores[i].last_busy_tsc,
+				     reactor->idle_tsc - g_cores[i].last_idle_tsc);
+		if (busy_pct >= g_scheduler_load_limit) {
+			continue;
+		}
+		local = spdk_env_get_socket_id(i) == spdk_env_get_socket_id(src);
+		if (dst == SPDK_ENV_LCORE_ID_ANY || (local && !dst_local) ||
+		    (local == dst_local && busy_pct < dst_pct)) {
+			dst = i;
+			dst_pct = busy_pct;
+			dst_local = local;
+		}
+	}
+	if (dst == SPDK_ENV_LCORE_ID_ANY) {
+		return false;
+	}
+
+	/* Measure the load of both cores from now on, so that the same pair is not
+	 * picked again before the moved thread has a chance to change it. */
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (i == src || i == dst) {
+			reactor = spdk_reactor_get(i);
+			g_cores[i].last_busy_tsc = reactor->busy_tsc;
+			g_cores[i].last_idle_tsc = reactor->idle_tsc;
+		}
+	}
+
+	SPDK_DTRACE_PROBE2(dynsched_steal, src, dst);
+
+	*src_lcore = src;
+	*dst_lcore = dst;
+
+	return true;
+}
+
 struct json_scheduler_opts {
 	uint8_t load_limit;
 	uint8_t core_limit;
 	uint8_t core_busy;
+	bool bin_packing;
+	bool work_stealing;
 };
 
 static const struct spdk_json_object_decoder sched_decoders[] = {
 	{"load_limit", offsetof(struct json_scheduler_opts, load_limit), spdk_json_decode_uint8, true},
 	{"core_limit", offsetof(struct json_scheduler_opts, core_limit), spdk_json_decode_uint8, true},
 	{"core_busy", offsetof(struct json_scheduler_opts, core_busy), spdk_json_decode_uint8, true},
+	{"bin_packing", offsetof(struct json_scheduler_opts, bin_packing), spdk_json_decode_bool, true},
+	{"work_stealing", offsetof(struct json_scheduler_opts, work_stealing), spdk_json_decode_bool, true},
 };
 
 static int
@@ -373,6 +728,8 @@ set_opts(const struct spdk_json_val *opts)
 	scheduler_opts.load_limit = g_scheduler_load_limit;
 	scheduler_opts.core_limit = g_scheduler_core_limit;
 	scheduler_opts.core_busy = g_scheduler_core_busy;
+	scheduler_opts.bin_packing = g_scheduler_bin_packing;
+	scheduler_opts.work_stealing = g_scheduler_work_stealing;
 
 	if (opts != NULL) {
 		if (spdk_json_decode_object_relaxed(opts, sched_decoders,
@@ -388,6 +745,12 @@ set_opts(const struct spdk_json_val *opts)
 	g_scheduler_core_limit = scheduler_opts.core_limit;
 	SPDK_NOTICELOG("Setting scheduler core busy to %d\n", scheduler_opts.core_busy);
 	g_scheduler_core_busy = scheduler_opts.core_busy;
+	SPDK_NOTICELOG("Setting scheduler bin packing to %s\n",
+		       scheduler_opts.bin_packing ? "on" : "off");
+	g_scheduler_bin_packing = scheduler_opts.bin_packing;
+	SPDK_NOTICELOG("Setting scheduler work stealing to %s\n",
+		       scheduler_opts.work_stealing ? "on" : "off");
+	g_scheduler_work_stealing = scheduler_opts.work_stealing;
 
 	return 0;
 }
@@ -398,6 +761,8 @@ get_opts(struct spdk_json_write_ctx *ctx)
 	spdk_json_write_named_uint8(ctx, "load_limit", g_scheduler_load_limit);
 	spdk_json_write_named_uint8(ctx, "core_limit", g_scheduler_core_limit);
 	spdk_json_write_named_uint8(ctx, "core_busy", g_scheduler_core_busy);
+	spdk_json_write_named_bool(ctx, "bin_packing", g_scheduler_bin_packing);
+	spdk_json_write_named_bool(ctx, "work_stealing", g_scheduler_work_stealing);
 }
 
 static struct spdk_scheduler scheduler_dynamic = {
@@ -405,6 +770,7 @@ static struct spdk_scheduler scheduler_dynamic = {
 	.init = init,
 	.deinit = deinit,
 	.balance = balance,
+	.steal = steal,
 	.set_opts = set_opts,
 	.get_opts = get_opts,
 };
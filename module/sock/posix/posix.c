@@ -33,6 +33,10 @@
 
 #define MAX_TMPBUF 1024
 #define PORTNUMLEN 32
+/* Size an adaptive receive pipe is allocated with and never shrunk below */
+#define RECV_PIPE_INIT_SIZE (64 * 1024)
+/* Period of checking adaptive receive pipes of a sock group for idle sockets */
+#define RECV_PIPE_CHECK_PERIOD_US 100000
 
 #if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
 #define SPDK_ZEROCOPY
@@ -47,6 +51,11 @@ struct spdk_posix_sock {
 	struct spdk_pipe	*recv_pipe;
 	void			*recv_buf;
 	int			recv_buf_sz;
+	/* Size the adaptive receive pipe can grow to */
+	int			recv_pipe_max_sz;
+	/* Most bytes held by the adaptive receive pipe since the last check */
+	int			recv_pipe_peak;
+	uint64_t		recv_tsc;
 	bool			pipe_has_data;
 	bool			socket_has_data;
 	bool			zcopy;
@@ -66,6 +75,9 @@ struct spdk_posix_sock_group_impl {
 	int				fd;
 	struct spdk_has_data_list	socks_with_data;
 	int				placement_id;
+	/* Size of the receive pipes of the sockets in the group */
+	uint64_t			recv_pipe_bytes;
+	uint64_t			recv_pipe_check_tsc;
 };
 
 static struct spdk_sock_impl_opts g_spdk_posix_sock_impl_opts = {
@@ -80,9 +92,14 @@ static struct spdk_sock_impl_opts g_spdk_posix_sock_impl_opts = {
 	.tls_version = 0,
 	.enable_ktls = false,
 	.psk_key = NULL,
-	.psk_identity = NULL
+	.psk_identity = NULL,
+	.recv_pipe_idle_timeout = 0,
+	.group_recv_pipe_limit = 0
 };
 
+/* Shared by the posix and ssl implementations */
+static struct spdk_sock_impl_stats g_posix_sock_impl_stats;
+
 static struct spdk_sock_map g_map = {
 	.entries = STAILQ_HEAD_INITIALIZER(g_map.entries),
 	.mtx = PTHREAD_MUTEX_INITIALIZER
@@ -122,6 +139,8 @@ posix_sock_copy_impl_opts(struct spdk_sock_impl_opts *dest, const struct spdk_so
 	SET_FIELD(enable_ktls);
 	SET_FIELD(psk_key);
 	SET_FIELD(psk_identity);
+	SET_FIELD(recv_pipe_idle_timeout);
+	SET_FIELD(group_recv_pipe_limit);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -158,6 +177,32 @@ posix_sock_impl_set_opts(const struct spdk_sock_impl_opts *opts, size_t len)
 	return 0;
 }
 
+static int
+posix_sock_impl_get_stats(struct spdk_sock_impl_stats *stats, size_t *len)
+{
+	struct spdk_sock_impl_stats tmp;
+
+	if (!stats || !len) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	tmp.recv_pipe_bytes = __atomic_load_n(&g_posix_sock_impl_stats.recv_pipe_bytes,
+					      __ATOMIC_RELAXED);
+	tmp.recv_pipes = __atomic_load_n(&g_posix_sock_impl_stats.recv_pipes, __ATOMIC_RELAXED);
+	tmp.recv_pipe_grows = __atomic_load_n(&g_posix_sock_impl_stats.recv_pipe_grows,
+					      __ATOMIC_RELAXED);
+	tmp.recv_pipe_shrinks = __atomic_load_n(&g_posix_sock_impl_stats.recv_pipe_shrinks,
+						__ATOMIC_RELAXED);
+	tmp.recv_pipe_limit_hits = __atomic_load_n(&g_posix_sock_impl_stats.recv_pipe_limit_hits,
+				   __ATOMIC_RELAXED);
+
+	*len = spdk_min(*len, sizeof(tmp));
+	memcpy(stats, &tmp, *len);
+
+	return 0;
+}
+
 static void
 posix_opts_get_impl_opts(const struct spdk_sock_opts *opts, struct spdk_sock_impl_opts *dest)
 {
@@ -246,6 +291,36 @@ enum posix_sock_create_type {
 	SPDK_SOCK_CREATE_CONNECT,
 };
 
+static inline bool
+posix_sock_adaptive_pipe(struct spdk_posix_sock *sock)
+{
+	return sock->base.impl_opts.enable_recv_pipe && sock->base.impl_opts.recv_pipe_idle_timeout > 0;
+}
+
+static void
+posix_sock_account_pipe(struct spdk_posix_sock *sock, int old_sz, int new_sz)
+{
+	struct spdk_posix_sock_group_impl *group = __posix_group_impl(sock->base.group_impl);
+	int64_t delta = (int64_t)new_sz - old_sz;
+
+	if (group != NULL) {
+		group->recv_pipe_bytes += delta;
+	}
+
+	__atomic_fetch_add(&g_posix_sock_impl_stats.recv_pipe_bytes, delta, __ATOMIC_RELAXED);
+	if (old_sz == 0) {
+		__atomic_fetch_add(&g_posix_sock_impl_stats.recv_pipes, 1, __ATOMIC_RELAXED);
+	} else if (new_sz == 0) {
+		__atomic_fetch_sub(&g_posix_sock_impl_stats.recv_pipes, 1, __ATOMIC_RELAXED);
+	}
+
+	if (delta > 0) {
+		__atomic_fetch_add(&g_posix_sock_impl_stats.recv_pipe_grows, 1, __ATOMIC_RELAXED);
+	} else {
+		__atomic_fetch_add(&g_posix_sock_impl_stats.recv_pipe_shrinks, 1, __ATOMIC_RELAXED);
+	}
+}
+
 static int
 posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 {
@@ -262,10 +337,14 @@ posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 
 	/* If the new size is 0, just free the pipe */
 	if (sz == 0) {
+		if (sock->recv_pipe != NULL) {
+			posix_sock_account_pipe(sock, sock->recv_buf_sz, 0);
+		}
 		spdk_pipe_destroy(sock->recv_pipe);
 		free(sock->recv_buf);
 		sock->recv_pipe = NULL;
 		sock->recv_buf = NULL;
+		sock->recv_buf_sz = 0;
 		return 0;
 	} else if (sz < MIN_SOCK_PIPE_SIZE) {
 		SPDK_ERRLOG("The size of the pipe must be larger than %d\n", MIN_SOCK_PIPE_SIZE);
@@ -306,6 +385,8 @@ posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 		free(sock->recv_buf);
 	}
 
+	posix_sock_account_pipe(sock, sock->recv_pipe != NULL ? sock->recv_buf_sz : 0, sz);
+
 	sock->recv_buf_sz = sz;
 	sock->recv_buf = new_buf;
 	sock->recv_pipe = new_pipe;
@@ -313,6 +394,37 @@ posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 	return 0;
 }
 
+/* Allocate the adaptive receive pipe of the socket or double its size, within the limit
+ * of the sock group */
+static void
+posix_sock_grow_pipe(struct spdk_posix_sock *sock)
+{
+	struct spdk_posix_sock_group_impl *group = __posix_group_impl(sock->base.group_impl);
+	uint64_t limit = sock->base.impl_opts.group_recv_pipe_limit;
+	int cur_sz, sz;
+
+	cur_sz = sock->recv_pipe != NULL ? sock->recv_buf_sz : 0;
+	if (cur_sz == 0) {
+		sz = spdk_min(RECV_PIPE_INIT_SIZE, sock->recv_pipe_max_sz);
+	} else {
+		sz = spdk_min(cur_sz * 2, sock->recv_pipe_max_sz);
+	}
+
+	if (sz <= cur_sz || sz < MIN_SOCK_PIPE_SIZE) {
+		return;
+	}
+
+	if (group != NULL && limit != 0 && group->recv_pipe_bytes - cur_sz + sz > limit) {
+		__atomic_fetch_add(&g_posix_sock_impl_stats.recv_pipe_limit_hits, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	/* On failure the socket keeps using its current pipe */
+	if (posix_sock_alloc_pipe(sock, sz) == 0 && cur_sz == 0) {
+		sock->recv_tsc = spdk_get_ticks();
+	}
+}
+
 static int
 posix_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
 {
@@ -321,7 +433,16 @@ posix_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
 
 	assert(sock != NULL);
 
-	if (_sock->impl_opts.enable_recv_pipe) {
+	if (posix_sock_adaptive_pipe(sock)) {
+		/* The pipe is allocated on demand, only shrink it if it's too large */
+		sock->recv_pipe_max_sz = sz;
+		if (sock->recv_pipe != NULL && sock->recv_buf_sz > sz) {
+			rc = posix_sock_alloc_pipe(sock, sz);
+			if (rc) {
+				return rc;
+			}
+		}
+	} else if (_sock->impl_opts.enable_recv_pipe) {
 		rc = posix_sock_alloc_pipe(sock, sz);
 		if (rc) {
 			return rc;
@@ -1085,8 +1206,7 @@ posix_sock_close(struct spdk_sock *_sock)
 	 * memory. */
 	close(sock->fd);
 
-	spdk_pipe_destroy(sock->recv_pipe);
-	free(sock->recv_buf);
+	posix_sock_alloc_pipe(sock, 0);
 	free(sock);
 
 	return 0;
@@ -1396,6 +1516,16 @@ posix_sock_read(struct spdk_posix_sock *sock)
 		sock->socket_has_data = false;
 	}
 
+	if (posix_sock_adaptive_pipe(sock)) {
+		sock->recv_tsc = spdk_get_ticks();
+		sock->recv_pipe_peak = spdk_max(sock->recv_pipe_peak,
+						(int)spdk_pipe_reader_bytes_available(sock->recv_pipe));
+		if (bytes_recvd == bytes_avail) {
+			/* The pipe is full while there's likely more data pending */
+			posix_sock_grow_pipe(sock);
+		}
+	}
+
 	return bytes_recvd;
 }
 
@@ -1407,6 +1537,18 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 	int rc, i;
 	size_t len;
 
+	if (sock->recv_pipe == NULL && posix_sock_adaptive_pipe(sock)) {
+		len = 0;
+		for (i = 0; i < iovcnt; i++) {
+			len += iov[i].iov_len;
+		}
+
+		/* Small reads are served from the pipe, so that they don't each need a syscall */
+		if (len < MIN_SOCK_PIPE_SIZE) {
+			posix_sock_grow_pipe(sock);
+		}
+	}
+
 	if (sock->recv_pipe == NULL) {
 		assert(sock->pipe_has_data == false);
 		if (group && sock->socket_has_data) {
@@ -1460,6 +1602,33 @@ posix_sock_recv(struct spdk_sock *sock, void *buf, size_t len)
 	return posix_sock_readv(sock, iov, 1);
 }
 
+static int
+posix_sock_recv_next(struct spdk_sock *_sock, void **buf, void **ctx)
+{
+	struct spdk_sock_group *group = _sock->group_impl->group;
+	struct iovec iov;
+	ssize_t rc;
+
+	iov.iov_len = spdk_sock_group_get_buf(group, &iov.iov_base, ctx);
+	if (iov.iov_len == 0) {
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	/* Like any other read, this goes directly to the buffer only if it's at least
+	 * MIN_SOCK_PIPE_SIZE bytes long and the receive pipe is empty. Smaller buffers
+	 * are still filled through the pipe. */
+	rc = posix_sock_readv(_sock, &iov, 1);
+	if (rc <= 0) {
+		spdk_sock_group_provide_buf(group, iov.iov_base, iov.iov_len, *ctx);
+		return rc;
+	}
+
+	*buf = iov.iov_base;
+
+	return rc;
+}
+
 static void
 posix_sock_readv_async(struct spdk_sock *sock, struct spdk_sock_request *req)
 {
@@ -1720,6 +1889,10 @@ posix_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group, struct spdk_
 		return rc;
 	}
 
+	if (sock->recv_pipe != NULL) {
+		group->recv_pipe_bytes += sock->recv_buf_sz;
+	}
+
 	/* switched from another polling group due to scheduling */
 	if (spdk_unlikely(sock->recv_pipe != NULL  &&
 			  (spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0))) {
@@ -1758,6 +1931,11 @@ posix_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group, struct sp
 		spdk_sock_map_release(&g_map, sock->placement_id);
 	}
 
+	if (sock->recv_pipe != NULL) {
+		assert(group->recv_pipe_bytes >= (uint64_t)sock->recv_buf_sz);
+		group->recv_pipe_bytes -= sock->recv_buf_sz;
+	}
+
 #if defined(SPDK_EPOLL)
 	struct epoll_event event;
 
@@ -1781,6 +1959,32 @@ posix_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group, struct sp
 	return rc;
 }
 
+/* Release the adaptive receive pipes of idle sockets and shrink the ones that are mostly empty */
+static void
+posix_sock_group_check_pipes(struct spdk_posix_sock_group_impl *group, uint64_t now)
+{
+	struct spdk_sock *_sock;
+	struct spdk_posix_sock *sock;
+	uint64_t idle_ticks;
+	int min_sz;
+
+	TAILQ_FOREACH(_sock, &group->base.socks, link) {
+		sock = __posix_sock(_sock);
+		if (sock->recv_pipe == NULL || sock->pipe_has_data || !posix_sock_adaptive_pipe(sock)) {
+			continue;
+		}
+
+		idle_ticks = (uint64_t)_sock->impl_opts.recv_pipe_idle_timeout * spdk_get_ticks_hz() / 1000;
+		min_sz = spdk_min(RECV_PIPE_INIT_SIZE, sock->recv_pipe_max_sz);
+		if (now - sock->recv_tsc >= idle_ticks) {
+			posix_sock_alloc_pipe(sock, 0);
+		} else if (sock->recv_pipe_peak < sock->recv_buf_sz / 4 && sock->recv_buf_sz / 2 >= min_sz) {
+			posix_sock_alloc_pipe(sock, sock->recv_buf_sz / 2);
+		}
+		sock->recv_pipe_peak = 0;
+	}
+}
+
 static int
 posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 			   struct spdk_sock **socks)
@@ -1789,6 +1993,7 @@ posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	struct spdk_sock *sock, *tmp;
 	int num_events, i, rc;
 	struct spdk_posix_sock *psock, *ptmp;
+	uint64_t now;
 #if defined(SPDK_EPOLL)
 	struct epoll_event events[MAX_EVENTS_PER_POLL];
 #elif defined(SPDK_KEVENT)
@@ -1851,6 +2056,15 @@ posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 		}
 	}
 
+	if (group->recv_pipe_bytes > 0) {
+		now = spdk_get_ticks();
+		if (now >= group->recv_pipe_check_tsc) {
+			posix_sock_group_check_pipes(group, now);
+			group->recv_pipe_check_tsc = now + RECV_PIPE_CHECK_PERIOD_US * spdk_get_ticks_hz() /
+						     SPDK_SEC_TO_USEC;
+		}
+	}
+
 	assert(max_events > 0);
 
 #if defined(SPDK_EPOLL)
@@ -1989,6 +2203,7 @@ static struct spdk_net_impl g_posix_net_impl = {
 	.recv		= posix_sock_recv,
 	.readv		= posix_sock_readv,
 	.readv_async	= posix_sock_readv_async,
+	.recv_next	= posix_sock_recv_next,
 	.writev		= posix_sock_writev,
 	.writev_async	= posix_sock_writev_async,
 	.flush		= posix_sock_flush,
@@ -2006,6 +2221,7 @@ static struct spdk_net_impl g_posix_net_impl = {
 	.group_impl_close	= posix_sock_group_impl_close,
 	.get_opts	= posix_sock_impl_get_opts,
 	.set_opts	= posix_sock_impl_set_opts,
+	.get_stats	= posix_sock_impl_get_stats,
 };
 
 SPDK_NET_IMPL_REGISTER(posix, &g_posix_net_impl, DEFAULT_SOCK_PRIORITY);
@@ -2031,6 +2247,7 @@ static struct spdk_net_impl g_ssl_net_impl = {
 	.close		= posix_sock_close,
 	.recv		= posix_sock_recv,
 	.readv		= posix_sock_readv,
+	.recv_next	= posix_sock_recv_next,
 	.writev		= posix_sock_writev,
 	.writev_async	= posix_sock_writev_async,
 	.flush		= posix_sock_flush,
@@ -2048,6 +2265,7 @@ static struct spdk_net_impl g_ssl_net_impl = {
 	.group_impl_close	= posix_sock_group_impl_close,
 	.get_opts	= posix_sock_impl_get_opts,
 	.set_opts	= posix_sock_impl_set_opts,
+	.get_stats	= posix_sock_impl_get_stats,
 };
 
 SPDK_NET_IMPL_REGISTER(ssl, &g_ssl_net_impl, DEFAULT_SOCK_PRIORITY);
@@ -26,18 +26,39 @@
 #define PORTNUMLEN 32
 #define SPDK_SOCK_GROUP_QUEUE_DEPTH 4096
 #define SPDK_SOCK_CMG_INFO_SIZE (sizeof(struct cmsghdr) + sizeof(struct sock_extended_err))
+/* Size an adaptive receive pipe is allocated with and never shrunk below */
+#define RECV_PIPE_INIT_SIZE (64 * 1024)
+/* Period of checking adaptive receive pipes of a sock group for idle sockets */
+#define RECV_PIPE_CHECK_PERIOD_US 100000
 
 enum spdk_sock_task_type {
 	SPDK_SOCK_TASK_POLLIN = 0,
 	SPDK_SOCK_TASK_ERRQUEUE,
 	SPDK_SOCK_TASK_WRITE,
 	SPDK_SOCK_TASK_CANCEL,
+	SPDK_SOCK_TASK_RECV,
 };
 
 #if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
 #define SPDK_ZEROCOPY
 #endif
 
+/* Multishot receive into provided buffer rings and sparse registered file tables
+ * require liburing 2.3 or newer. Kernel support is detected at runtime. */
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_CQE_F_BUFFER)
+#define SPDK_URING_RECV_MULTISHOT
+
+/* Buffer group ID of the provided buffer ring */
+#define SPDK_URING_RECV_BGID 0
+/* Number of provided receive buffers per sock group, must be a power of 2 */
+#define SPDK_URING_RECV_BUF_COUNT 1024
+#define SPDK_URING_RECV_BUF_SIZE (16 * 1024)
+/* Maximum number of provided buffers copied out by a single readv */
+#define SPDK_URING_RECV_IOV_MAX 16
+/* Size of the registered file table of each sock group */
+#define SPDK_URING_FIXED_FILES SPDK_SOCK_GROUP_QUEUE_DEPTH
+#endif
+
 enum spdk_uring_sock_task_status {
 	SPDK_URING_SOCK_TASK_NOT_IN_USE = 0,
 	SPDK_URING_SOCK_TASK_IN_PROCESS,
@@ -55,6 +76,16 @@ struct spdk_uring_task {
 	STAILQ_ENTRY(spdk_uring_task)		link;
 };
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+struct spdk_uring_buf {
+	/* Bytes received into the buffer */
+	uint32_t				len;
+	/* Bytes already copied out of the buffer */
+	uint32_t				offset;
+	STAILQ_ENTRY(spdk_uring_buf)		link;
+};
+#endif
+
 struct spdk_uring_sock {
 	struct spdk_sock			base;
 	int					fd;
@@ -67,12 +98,26 @@ struct spdk_uring_sock {
 	struct spdk_pipe			*recv_pipe;
 	void					*recv_buf;
 	int					recv_buf_sz;
+	/* Size the adaptive receive pipe can grow to */
+	int					recv_pipe_max_sz;
+	/* Most bytes held by the adaptive receive pipe since the last check */
+	int					recv_pipe_peak;
+	uint64_t				recv_tsc;
 	bool					zcopy;
 	bool					pending_recv;
 	int					zcopy_send_flags;
 	int					connection_status;
 	int					placement_id;
 	uint8_t					buf[SPDK_SOCK_CMG_INFO_SIZE];
+#ifdef SPDK_URING_RECV_MULTISHOT
+	struct spdk_uring_task			recv_task;
+	/* Provided buffers filled by the multishot receive, in the order of the data */
+	STAILQ_HEAD(, spdk_uring_buf)		recv_bufs;
+	bool					recv_eof;
+	int					recv_errno;
+	/* Index in the sock group's registered file table, or -1 */
+	int					fixed_fd;
+#endif
 	TAILQ_ENTRY(spdk_uring_sock)		link;
 };
 
@@ -85,6 +130,21 @@ struct spdk_uring_sock_group_impl {
 	uint32_t				io_queued;
 	uint32_t				io_avail;
 	struct pending_recv_list		pending_recv;
+	/* Size of the receive pipes of the sockets in the group */
+	uint64_t				recv_pipe_bytes;
+	uint64_t				recv_pipe_check_tsc;
+#ifdef SPDK_URING_RECV_MULTISHOT
+	/* Provided buffer ring shared by the sockets of the group. It's set up when the first
+	 * socket using the receive pipe is added, NULL until then or if not supported. */
+	struct io_uring_buf_ring		*buf_ring;
+	uint8_t					*buf_pool;
+	struct spdk_uring_buf			*bufs;
+	bool					buf_ring_probed;
+	bool					recv_multishot;
+	/* Stack of free indexes in the registered file table, NULL if not supported */
+	int					*free_fixed_fds;
+	uint32_t				num_free_fixed_fds;
+#endif
 };
 
 static struct spdk_sock_impl_opts g_spdk_uring_sock_impl_opts = {
@@ -99,9 +159,13 @@ static struct spdk_sock_impl_opts g_spdk_uring_sock_impl_opts = {
 	.tls_version = 0,
 	.enable_ktls = false,
 	.psk_key = NULL,
-	.psk_identity = NULL
+	.psk_identity = NULL,
+	.recv_pipe_idle_timeout = 0,
+	.group_recv_pipe_limit = 0
 };
 
+static struct spdk_sock_impl_stats g_uring_sock_impl_stats;
+
 static struct spdk_sock_map g_map = {
 	.entries = STAILQ_HEAD_INITIALIZER(g_map.entries),
 	.mtx = PTHREAD_MUTEX_INITIALIZER
@@ -118,6 +182,54 @@ uring_sock_map_cleanup(void)
 #define __uring_sock(sock) (struct spdk_uring_sock *)sock
 #define __uring_group_impl(group) (struct spdk_uring_sock_group_impl *)group
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+/* Sockets using the receive pipe are served by the group's multishot receive instead */
+static inline bool
+uring_sock_recv_multishot(struct spdk_uring_sock *sock)
+{
+	return sock->group != NULL && sock->group->recv_multishot &&
+	       sock->base.impl_opts.enable_recv_pipe;
+}
+
+static inline uint8_t *
+uring_group_buf_addr(struct spdk_uring_sock_group_impl *group, struct spdk_uring_buf *buf)
+{
+	return group->buf_pool + (size_t)(buf - group->bufs) * SPDK_URING_RECV_BUF_SIZE;
+}
+
+static void
+uring_group_put_buf(struct spdk_uring_sock_group_impl *group, struct spdk_uring_buf *buf)
+{
+	io_uring_buf_ring_add(group->buf_ring, uring_group_buf_addr(group, buf), SPDK_URING_RECV_BUF_SIZE,
+			      buf - group->bufs, io_uring_buf_ring_mask(SPDK_URING_RECV_BUF_COUNT), 0);
+	io_uring_buf_ring_advance(group->buf_ring, 1);
+}
+#endif
+
+static inline void
+uring_sock_sqe_set_file(struct spdk_uring_sock *sock, struct io_uring_sqe *sqe)
+{
+#ifdef SPDK_URING_RECV_MULTISHOT
+	if (sock->fixed_fd >= 0) {
+		sqe->fd = sock->fixed_fd;
+		sqe->flags |= IOSQE_FIXED_FILE;
+	}
+#endif
+}
+
+static inline bool
+uring_sock_recv_pending(struct spdk_uring_sock *sock)
+{
+	if (sock->recv_pipe != NULL && spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0) {
+		return true;
+	}
+#ifdef SPDK_URING_RECV_MULTISHOT
+	return !STAILQ_EMPTY(&sock->recv_bufs) || sock->recv_eof || sock->recv_errno != 0;
+#else
+	return false;
+#endif
+}
+
 static void
 uring_sock_copy_impl_opts(struct spdk_sock_impl_opts *dest, const struct spdk_sock_impl_opts *src,
 			  size_t len)
@@ -142,6 +254,8 @@ uring_sock_copy_impl_opts(struct spdk_sock_impl_opts *dest, const struct spdk_so
 	SET_FIELD(enable_ktls);
 	SET_FIELD(psk_key);
 	SET_FIELD(psk_identity);
+	SET_FIELD(recv_pipe_idle_timeout);
+	SET_FIELD(group_recv_pipe_limit);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -178,6 +292,32 @@ uring_sock_impl_set_opts(const struct spdk_sock_impl_opts *opts, size_t len)
 	return 0;
 }
 
+static int
+uring_sock_impl_get_stats(struct spdk_sock_impl_stats *stats, size_t *len)
+{
+	struct spdk_sock_impl_stats tmp;
+
+	if (!stats || !len) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	tmp.recv_pipe_bytes = __atomic_load_n(&g_uring_sock_impl_stats.recv_pipe_bytes,
+					      __ATOMIC_RELAXED);
+	tmp.recv_pipes = __atomic_load_n(&g_uring_sock_impl_stats.recv_pipes, __ATOMIC_RELAXED);
+	tmp.recv_pipe_grows = __atomic_load_n(&g_uring_sock_impl_stats.recv_pipe_grows,
+					      __ATOMIC_RELAXED);
+	tmp.recv_pipe_shrinks = __atomic_load_n(&g_uring_sock_impl_stats.recv_pipe_shrinks,
+						__ATOMIC_RELAXED);
+	tmp.recv_pipe_limit_hits = __atomic_load_n(&g_uring_sock_impl_stats.recv_pipe_limit_hits,
+				   __ATOMIC_RELAXED);
+
+	*len = spdk_min(*len, sizeof(tmp));
+	memcpy(stats, &tmp, *len);
+
+	return 0;
+}
+
 static void
 uring_opts_get_impl_opts(const struct spdk_sock_opts *opts, struct spdk_sock_impl_opts *dest)
 {
@@ -266,6 +406,35 @@ enum uring_sock_create_type {
 	SPDK_SOCK_CREATE_CONNECT,
 };
 
+static inline bool
+uring_sock_adaptive_pipe(struct spdk_uring_sock *sock)
+{
+	return sock->base.impl_opts.enable_recv_pipe && sock->base.impl_opts.recv_pipe_idle_timeout > 0;
+}
+
+static void
+uring_sock_account_pipe(struct spdk_uring_sock *sock, int old_sz, int new_sz)
+{
+	int64_t delta = (int64_t)new_sz - old_sz;
+
+	if (sock->group != NULL) {
+		sock->group->recv_pipe_bytes += delta;
+	}
+
+	__atomic_fetch_add(&g_uring_sock_impl_stats.recv_pipe_bytes, delta, __ATOMIC_RELAXED);
+	if (old_sz == 0) {
+		__atomic_fetch_add(&g_uring_sock_impl_stats.recv_pipes, 1, __ATOMIC_RELAXED);
+	} else if (new_sz == 0) {
+		__atomic_fetch_sub(&g_uring_sock_impl_stats.recv_pipes, 1, __ATOMIC_RELAXED);
+	}
+
+	if (delta > 0) {
+		__atomic_fetch_add(&g_uring_sock_impl_stats.recv_pipe_grows, 1, __ATOMIC_RELAXED);
+	} else {
+		__atomic_fetch_add(&g_uring_sock_impl_stats.recv_pipe_shrinks, 1, __ATOMIC_RELAXED);
+	}
+}
+
 static int
 uring_sock_alloc_pipe(struct spdk_uring_sock *sock, int sz)
 {
@@ -282,10 +451,14 @@ uring_sock_alloc_pipe(struct spdk_uring_sock *sock, int sz)
 
 	/* If the new size is 0, just free the pipe */
 	if (sz == 0) {
+		if (sock->recv_pipe != NULL) {
+			uring_sock_account_pipe(sock, sock->recv_buf_sz, 0);
+		}
 		spdk_pipe_destroy(sock->recv_pipe);
 		free(sock->recv_buf);
 		sock->recv_pipe = NULL;
 		sock->recv_buf = NULL;
+		sock->recv_buf_sz = 0;
 		return 0;
 	} else if (sz < MIN_SOCK_PIPE_SIZE) {
 		SPDK_ERRLOG("The size of the pipe must be larger than %d\n", MIN_SOCK_PIPE_SIZE);
@@ -326,6 +499,8 @@ uring_sock_alloc_pipe(struct spdk_uring_sock *sock, int sz)
 		free(sock->recv_buf);
 	}
 
+	uring_sock_account_pipe(sock, sock->recv_pipe != NULL ? sock->recv_buf_sz : 0, sz);
+
 	sock->recv_buf_sz = sz;
 	sock->recv_buf = new_buf;
 	sock->recv_pipe = new_pipe;
@@ -333,6 +508,36 @@ uring_sock_alloc_pipe(struct spdk_uring_sock *sock, int sz)
 	return 0;
 }
 
+/* Allocate the adaptive receive pipe of the socket or double its size, within the limit
+ * of the sock group */
+static void
+uring_sock_grow_pipe(struct spdk_uring_sock *sock)
+{
+	uint64_t limit = sock->base.impl_opts.group_recv_pipe_limit;
+	int cur_sz, sz;
+
+	cur_sz = sock->recv_pipe != NULL ? sock->recv_buf_sz : 0;
+	if (cur_sz == 0) {
+		sz = spdk_min(RECV_PIPE_INIT_SIZE, sock->recv_pipe_max_sz);
+	} else {
+		sz = spdk_min(cur_sz * 2, sock->recv_pipe_max_sz);
+	}
+
+	if (sz <= cur_sz || sz < MIN_SOCK_PIPE_SIZE) {
+		return;
+	}
+
+	if (sock->group != NULL && limit != 0 && sock->group->recv_pipe_bytes - cur_sz + sz > limit) {
+		__atomic_fetch_add(&g_uring_sock_impl_stats.recv_pipe_limit_hits, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	/* On failure the socket keeps using its current pipe */
+	if (uring_sock_alloc_pipe(sock, sz) == 0 && cur_sz == 0) {
+		sock->recv_tsc = spdk_get_ticks();
+	}
+}
+
 static int
 uring_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
 {
@@ -341,7 +546,17 @@ uring_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
 
 	assert(sock != NULL);
 
-	if (_sock->impl_opts.enable_recv_pipe) {
+	if (uring_sock_adaptive_pipe(sock)) {
+		/* The pipe is allocated on demand, only shrink it if it's too large */
+		sock->recv_pipe_max_sz = sz;
+		if (sock->recv_pipe != NULL && sock->recv_buf_sz > sz) {
+			rc = uring_sock_alloc_pipe(sock, sz);
+			if (rc) {
+				SPDK_ERRLOG("unable to shrink recvbuf to sz=%d on sock=%p\n", sz, _sock);
+				return rc;
+			}
+		}
+	} else if (_sock->impl_opts.enable_recv_pipe) {
 		rc = uring_sock_alloc_pipe(sock, sz);
 		if (rc) {
 			SPDK_ERRLOG("unable to allocate sufficient recvbuf with sz=%d on sock=%p\n", sz, _sock);
@@ -402,6 +617,10 @@ uring_sock_alloc(int fd, struct spdk_sock_impl_opts *impl_opts, bool enable_zero
 
 	sock->fd = fd;
 	memcpy(&sock->base.impl_opts, impl_opts, sizeof(*impl_opts));
+#ifdef SPDK_URING_RECV_MULTISHOT
+	STAILQ_INIT(&sock->recv_bufs);
+	sock->fixed_fd = -1;
+#endif
 
 #if defined(__linux__)
 	flag = 1;
@@ -706,8 +925,7 @@ uring_sock_close(struct spdk_sock *_sock)
 	 * memory. */
 	close(sock->fd);
 
-	spdk_pipe_destroy(sock->recv_pipe);
-	free(sock->recv_buf);
+	uring_sock_alloc_pipe(sock, 0);
 	free(sock);
 
 	return 0;
@@ -741,7 +959,7 @@ uring_sock_recv_from_pipe(struct spdk_uring_sock *sock, struct iovec *diov, int
 	spdk_pipe_reader_advance(sock->recv_pipe, bytes);
 
 	/* If we drained the pipe, take it off the level-triggered list */
-	if (sock->base.group_impl && spdk_pipe_reader_bytes_available(sock->recv_pipe) == 0) {
+	if (sock->base.group_impl && !uring_sock_recv_pending(sock)) {
 		group = __uring_group_impl(sock->base.group_impl);
 		TAILQ_REMOVE(&group->pending_recv, sock, link);
 		sock->pending_recv = false;
@@ -750,6 +968,110 @@ uring_sock_recv_from_pipe(struct spdk_uring_sock *sock, struct iovec *diov, int
 	return bytes;
 }
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+static ssize_t
+uring_sock_recv_from_bufs(struct spdk_uring_sock *sock, struct iovec *diov, int diovcnt)
+{
+	struct spdk_uring_sock_group_impl *group = sock->group;
+	struct iovec siov[SPDK_URING_RECV_IOV_MAX];
+	struct spdk_uring_buf *buf;
+	int siovcnt = 0;
+	size_t bytes, remaining, len;
+
+	STAILQ_FOREACH(buf, &sock->recv_bufs, link) {
+		if (siovcnt == SPDK_URING_RECV_IOV_MAX) {
+			break;
+		}
+		siov[siovcnt].iov_base = uring_group_buf_addr(group, buf) + buf->offset;
+		siov[siovcnt].iov_len = buf->len - buf->offset;
+		siovcnt++;
+	}
+
+	if (siovcnt == 0) {
+		if (sock->recv_errno != 0) {
+			errno = -sock->recv_errno;
+			return -1;
+		} else if (sock->recv_eof) {
+			return 0;
+		}
+		errno = EAGAIN;
+		return -1;
+	}
+
+	bytes = spdk_iovcpy(siov, siovcnt, diov, diovcnt);
+	if (bytes == 0) {
+		/* The only way this happens is if diov is 0 length */
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Hand the drained buffers back to the kernel */
+	remaining = bytes;
+	while (remaining > 0) {
+		buf = STAILQ_FIRST(&sock->recv_bufs);
+		assert(buf != NULL);
+		len = spdk_min(remaining, buf->len - buf->offset);
+		buf->offset += len;
+		remaining -= len;
+		if (buf->offset == buf->len) {
+			STAILQ_REMOVE_HEAD(&sock->recv_bufs, link);
+			uring_group_put_buf(group, buf);
+		}
+	}
+
+	if (sock->pending_recv && !uring_sock_recv_pending(sock)) {
+		TAILQ_REMOVE(&group->pending_recv, sock, link);
+		sock->pending_recv = false;
+	}
+
+	return bytes;
+}
+
+/* Move the data left in the provided buffers to the receive pipe, so that it can still
+ * be read once the socket leaves the sock group */
+static void
+uring_sock_recv_bufs_to_pipe(struct spdk_uring_sock *sock)
+{
+	struct spdk_uring_sock_group_impl *group = sock->group;
+	struct spdk_uring_buf *buf;
+	struct iovec siov, diov[2];
+	int avail = 0, pending = 0, sz;
+	ssize_t bytes;
+
+	STAILQ_FOREACH(buf, &sock->recv_bufs, link) {
+		pending += buf->len - buf->offset;
+	}
+
+	if (pending > 0) {
+		if (sock->recv_pipe != NULL) {
+			avail = spdk_pipe_reader_bytes_available(sock->recv_pipe);
+		}
+
+		if (sock->recv_pipe == NULL || sock->recv_buf_sz - avail < pending) {
+			sz = spdk_max(avail + pending, spdk_max(sock->recv_buf_sz, MIN_SOCK_PIPE_SIZE));
+			if (uring_sock_alloc_pipe(sock, sz) != 0) {
+				SPDK_ERRLOG("Failed to keep %d received bytes of sock=%p\n", pending, sock);
+				sock->recv_errno = -ENOMEM;
+				pending = 0;
+			}
+		}
+	}
+
+	while ((buf = STAILQ_FIRST(&sock->recv_bufs)) != NULL) {
+		STAILQ_REMOVE_HEAD(&sock->recv_bufs, link);
+		if (pending > 0) {
+			siov.iov_base = uring_group_buf_addr(group, buf) + buf->offset;
+			siov.iov_len = buf->len - buf->offset;
+			spdk_pipe_writer_get_buffer(sock->recv_pipe, siov.iov_len, diov);
+			bytes = spdk_iovcpy(&siov, 1, diov, 2);
+			assert(bytes == (ssize_t)siov.iov_len);
+			spdk_pipe_writer_advance(sock->recv_pipe, bytes);
+		}
+		uring_group_put_buf(group, buf);
+	}
+}
+#endif
+
 static inline ssize_t
 sock_readv(int fd, struct iovec *iov, int iovcnt)
 {
@@ -765,12 +1087,13 @@ static inline ssize_t
 uring_sock_read(struct spdk_uring_sock *sock)
 {
 	struct iovec iov[2];
-	int bytes;
+	int bytes, avail;
 	struct spdk_uring_sock_group_impl *group;
 
 	bytes = spdk_pipe_writer_get_buffer(sock->recv_pipe, sock->recv_buf_sz, iov);
 
 	if (bytes > 0) {
+		avail = bytes;
 		bytes = sock_readv(sock->fd, iov, 2);
 		if (bytes > 0) {
 			spdk_pipe_writer_advance(sock->recv_pipe, bytes);
@@ -779,6 +1102,16 @@ uring_sock_read(struct spdk_uring_sock *sock)
 				TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
 				sock->pending_recv = true;
 			}
+
+			if (uring_sock_adaptive_pipe(sock)) {
+				sock->recv_tsc = spdk_get_ticks();
+				sock->recv_pipe_peak = spdk_max(sock->recv_pipe_peak,
+								(int)spdk_pipe_reader_bytes_available(sock->recv_pipe));
+				if (bytes == avail) {
+					/* The pipe is full while there's likely more data pending */
+					uring_sock_grow_pipe(sock);
+				}
+			}
 		}
 	}
 
@@ -792,6 +1125,37 @@ uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 	int rc, i;
 	size_t len;
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	/* The socket mustn't be read directly while the multishot receive is armed, as the
+	 * data would be reordered. Data left in the pipe when the socket joined the group
+	 * is consumed first. */
+	if (uring_sock_recv_multishot(sock) || !STAILQ_EMPTY(&sock->recv_bufs)) {
+		if (sock->recv_pipe != NULL && spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0) {
+			return uring_sock_recv_from_pipe(sock, iov, iovcnt);
+		}
+		return uring_sock_recv_from_bufs(sock, iov, iovcnt);
+	}
+
+	/* The multishot receive hit an error before the socket left the group */
+	if (spdk_unlikely(sock->recv_errno != 0) &&
+	    (sock->recv_pipe == NULL || spdk_pipe_reader_bytes_available(sock->recv_pipe) == 0)) {
+		errno = -sock->recv_errno;
+		return -1;
+	}
+#endif
+
+	if (sock->recv_pipe == NULL && uring_sock_adaptive_pipe(sock)) {
+		len = 0;
+		for (i = 0; i < iovcnt; i++) {
+			len += iov[i].iov_len;
+		}
+
+		/* Small reads are served from the pipe, so that they don't each need a syscall */
+		if (len < MIN_SOCK_PIPE_SIZE) {
+			uring_sock_grow_pipe(sock);
+		}
+	}
+
 	if (sock->recv_pipe == NULL) {
 		return sock_readv(sock->fd, iov, iovcnt);
 	}
@@ -1014,6 +1378,7 @@ _sock_prep_errqueue(struct spdk_sock *_sock)
 
 	sqe = io_uring_get_sqe(&sock->group->uring);
 	io_uring_prep_recvmsg(sqe, sock->fd, &task->msg, MSG_ERRQUEUE);
+	uring_sock_sqe_set_file(sock, sqe);
 	io_uring_sqe_set_data(sqe, task);
 	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
 }
@@ -1058,16 +1423,104 @@ _sock_flush(struct spdk_sock *_sock)
 
 	sqe = io_uring_get_sqe(&sock->group->uring);
 	io_uring_prep_sendmsg(sqe, sock->fd, &sock->write_task.msg, flags);
+	uring_sock_sqe_set_file(sock, sqe);
+	io_uring_sqe_set_data(sqe, task);
+	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
+}
+
+#ifdef SPDK_URING_RECV_MULTISHOT
+static void
+_sock_prep_recv(struct spdk_sock *_sock)
+{
+	struct spdk_uring_sock *sock = __uring_sock(_sock);
+	struct spdk_uring_task *task = &sock->recv_task;
+	struct io_uring_sqe *sqe;
+
+	/* Nothing more can be received after EOF or an error */
+	if (task->status == SPDK_URING_SOCK_TASK_IN_PROCESS || sock->recv_eof || sock->recv_errno != 0) {
+		return;
+	}
+
+	assert(sock->group != NULL);
+	sock->group->io_queued++;
+
+	sqe = io_uring_get_sqe(&sock->group->uring);
+	io_uring_prep_recv_multishot(sqe, sock->fd, NULL, 0, 0);
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = SPDK_URING_RECV_BGID;
+	uring_sock_sqe_set_file(sock, sqe);
 	io_uring_sqe_set_data(sqe, task);
 	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
 }
 
+static void
+_sock_recv_complete(struct spdk_uring_sock *sock, int status, uint32_t cqe_flags)
+{
+	struct spdk_uring_sock_group_impl *group = sock->group;
+	struct spdk_uring_buf *buf;
+
+	if (!(cqe_flags & IORING_CQE_F_MORE)) {
+		/* The receive has terminated, it's armed again on the next poll */
+		group->io_inflight--;
+		group->io_avail++;
+		sock->recv_task.status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
+	}
+
+	if (status > 0) {
+		assert(cqe_flags & IORING_CQE_F_BUFFER);
+		buf = &group->bufs[cqe_flags >> IORING_CQE_BUFFER_SHIFT];
+		buf->len = status;
+		buf->offset = 0;
+		STAILQ_INSERT_TAIL(&sock->recv_bufs, buf, link);
+	} else if (status == 0) {
+		sock->recv_eof = true;
+	} else {
+		switch (status) {
+		case -ENOBUFS:
+			/* All provided buffers are in use, the receive is armed again on
+			 * the next poll */
+		case -ECANCELED:
+			return;
+		case -EINVAL:
+			if (STAILQ_EMPTY(&sock->recv_bufs)) {
+				/* The kernel doesn't support multishot receive */
+				SPDK_NOTICELOG("Multishot receive not supported, falling back to poll\n");
+				group->recv_multishot = false;
+				return;
+			}
+		/* fallthrough */
+		default:
+			sock->recv_errno = status;
+			break;
+		}
+	}
+
+	if (sock->base.cb_fn != NULL && !sock->pending_recv) {
+		sock->pending_recv = true;
+		TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
+	}
+}
+#endif
+
 static void
 _sock_prep_pollin(struct spdk_sock *_sock)
 {
 	struct spdk_uring_sock *sock = __uring_sock(_sock);
 	struct spdk_uring_task *task = &sock->pollin_task;
 	struct io_uring_sqe *sqe;
+	short events = POLLIN | POLLERR;
+
+#ifdef SPDK_URING_RECV_MULTISHOT
+	if (uring_sock_recv_multishot(sock)) {
+		_sock_prep_recv(_sock);
+		/* Data is delivered by the multishot receive, poll only for the errors
+		 * signaling zero copy completions */
+		if (!sock->zcopy) {
+			return;
+		}
+		events = POLLERR;
+	}
+#endif
 
 	/* Do not prepare pollin event */
 	if (task->status == SPDK_URING_SOCK_TASK_IN_PROCESS || (sock->pending_recv && !sock->zcopy)) {
@@ -1078,7 +1531,8 @@ _sock_prep_pollin(struct spdk_sock *_sock)
 	sock->group->io_queued++;
 
 	sqe = io_uring_get_sqe(&sock->group->uring);
-	io_uring_prep_poll_add(sqe, sock->fd, POLLIN | POLLERR);
+	io_uring_prep_poll_add(sqe, sock->fd, events);
+	uring_sock_sqe_set_file(sock, sqe);
 	io_uring_sqe_set_data(sqe, task);
 	task->status = SPDK_URING_SOCK_TASK_IN_PROCESS;
 }
@@ -1129,9 +1583,22 @@ sock_uring_group_reap(struct spdk_uring_sock_group_impl *group, int max, int max
 		assert(sock != NULL);
 		assert(sock->group != NULL);
 		assert(sock->group == group);
+		status = cqe->res;
+
+#ifdef SPDK_URING_RECV_MULTISHOT
+		if (task->type == SPDK_SOCK_TASK_RECV) {
+			uint32_t flags = cqe->flags;
+
+			/* Completions of a receive that stays armed count towards max as well,
+			 * otherwise a busy socket could keep the loop going indefinitely */
+			io_uring_cqe_seen(&group->uring, cqe);
+			_sock_recv_complete(sock, status, flags);
+			continue;
+		}
+#endif
+
 		sock->group->io_inflight--;
 		sock->group->io_avail++;
-		status = cqe->res;
 		io_uring_cqe_seen(&group->uring, cqe);
 
 		task->status = SPDK_URING_SOCK_TASK_NOT_IN_USE;
@@ -1195,8 +1662,7 @@ sock_uring_group_reap(struct spdk_uring_sock_group_impl *group, int max, int max
 			break;
 		}
 
-		if (spdk_unlikely(sock->base.cb_fn == NULL) ||
-		    (sock->recv_pipe == NULL || spdk_pipe_reader_bytes_available(sock->recv_pipe) == 0)) {
+		if (spdk_unlikely(sock->base.cb_fn == NULL) || !uring_sock_recv_pending(sock)) {
 			sock->pending_recv = false;
 			TAILQ_REMOVE(&group->pending_recv, sock, link);
 			if (spdk_unlikely(sock->base.cb_fn == NULL)) {
@@ -1334,6 +1800,30 @@ uring_sock_writev_async(struct spdk_sock *_sock, struct spdk_sock_request *req)
 	}
 }
 
+static int
+uring_sock_recv_next(struct spdk_sock *_sock, void **buf, void **ctx)
+{
+	struct spdk_sock_group *group = _sock->group_impl->group;
+	struct iovec iov;
+	ssize_t rc;
+
+	iov.iov_len = spdk_sock_group_get_buf(group, &iov.iov_base, ctx);
+	if (iov.iov_len == 0) {
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	rc = uring_sock_readv(_sock, &iov, 1);
+	if (rc <= 0) {
+		spdk_sock_group_provide_buf(group, iov.iov_base, iov.iov_len, *ctx);
+		return rc;
+	}
+
+	*buf = iov.iov_base;
+
+	return rc;
+}
+
 static void
 uring_sock_readv_async(struct spdk_sock *sock, struct spdk_sock_request *req)
 {
@@ -1436,6 +1926,123 @@ uring_sock_group_impl_get_optimal(struct spdk_sock *_sock, struct spdk_sock_grou
 	return NULL;
 }
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+static void
+uring_sock_group_setup_buf_ring(struct spdk_uring_sock_group_impl *group)
+{
+	struct io_uring_buf_reg reg = {};
+	uint32_t i;
+	int rc;
+
+	/* Don't retry if the kernel doesn't support it */
+	group->buf_ring_probed = true;
+
+	group->bufs = calloc(SPDK_URING_RECV_BUF_COUNT, sizeof(*group->bufs));
+	if (group->bufs == NULL) {
+		return;
+	}
+
+	rc = posix_memalign((void **)&group->buf_ring, 0x1000,
+			    SPDK_URING_RECV_BUF_COUNT * sizeof(struct io_uring_buf));
+	if (rc != 0) {
+		group->buf_ring = NULL;
+		goto err;
+	}
+
+	rc = posix_memalign((void **)&group->buf_pool, 0x1000,
+			    (size_t)SPDK_URING_RECV_BUF_COUNT * SPDK_URING_RECV_BUF_SIZE);
+	if (rc != 0) {
+		group->buf_pool = NULL;
+		goto err;
+	}
+
+	reg.ring_addr = (uint64_t)(uintptr_t)group->buf_ring;
+	reg.ring_entries = SPDK_URING_RECV_BUF_COUNT;
+	reg.bgid = SPDK_URING_RECV_BGID;
+	rc = io_uring_register_buf_ring(&group->uring, &reg, 0);
+	if (rc != 0) {
+		SPDK_DEBUGLOG(sock_uring, "Provided buffer rings not supported: %d\n", rc);
+		goto err;
+	}
+
+	io_uring_buf_ring_init(group->buf_ring);
+	for (i = 0; i < SPDK_URING_RECV_BUF_COUNT; i++) {
+		io_uring_buf_ring_add(group->buf_ring, uring_group_buf_addr(group, &group->bufs[i]),
+				      SPDK_URING_RECV_BUF_SIZE, i,
+				      io_uring_buf_ring_mask(SPDK_URING_RECV_BUF_COUNT), i);
+	}
+	io_uring_buf_ring_advance(group->buf_ring, SPDK_URING_RECV_BUF_COUNT);
+
+	group->recv_multishot = true;
+	return;
+err:
+	free(group->buf_pool);
+	free(group->buf_ring);
+	free(group->bufs);
+	group->buf_pool = NULL;
+	group->buf_ring = NULL;
+	group->bufs = NULL;
+}
+
+static void
+uring_sock_group_setup_fixed_files(struct spdk_uring_sock_group_impl *group)
+{
+	int i, rc;
+
+	rc = io_uring_register_files_sparse(&group->uring, SPDK_URING_FIXED_FILES);
+	if (rc != 0) {
+		SPDK_DEBUGLOG(sock_uring, "Sparse registered files not supported: %d\n", rc);
+		return;
+	}
+
+	group->free_fixed_fds = calloc(SPDK_URING_FIXED_FILES, sizeof(*group->free_fixed_fds));
+	if (group->free_fixed_fds == NULL) {
+		io_uring_unregister_files(&group->uring);
+		return;
+	}
+
+	for (i = SPDK_URING_FIXED_FILES - 1; i >= 0; i--) {
+		group->free_fixed_fds[group->num_free_fixed_fds++] = i;
+	}
+}
+
+static void
+uring_sock_group_add_fixed_file(struct spdk_uring_sock_group_impl *group,
+				struct spdk_uring_sock *sock)
+{
+	int idx;
+
+	assert(sock->fixed_fd == -1);
+	if (group->num_free_fixed_fds == 0) {
+		/* The sock keeps using its plain fd */
+		return;
+	}
+
+	idx = group->free_fixed_fds[--group->num_free_fixed_fds];
+	if (io_uring_register_files_update(&group->uring, idx, &sock->fd, 1) != 1) {
+		group->free_fixed_fds[group->num_free_fixed_fds++] = idx;
+		return;
+	}
+
+	sock->fixed_fd = idx;
+}
+
+static void
+uring_sock_group_remove_fixed_file(struct spdk_uring_sock_group_impl *group,
+				   struct spdk_uring_sock *sock)
+{
+	int fd = -1;
+
+	if (sock->fixed_fd == -1) {
+		return;
+	}
+
+	io_uring_register_files_update(&group->uring, sock->fixed_fd, &fd, 1);
+	group->free_fixed_fds[group->num_free_fixed_fds++] = sock->fixed_fd;
+	sock->fixed_fd = -1;
+}
+#endif
+
 static struct spdk_sock_group_impl *
 uring_sock_group_impl_create(void)
 {
@@ -1457,6 +2064,10 @@ uring_sock_group_impl_create(void)
 
 	TAILQ_INIT(&group_impl->pending_recv);
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	uring_sock_group_setup_fixed_files(group_impl);
+#endif
+
 	if (g_spdk_uring_sock_impl_opts.enable_placement_id == PLACEMENT_CPU) {
 		spdk_sock_map_insert(&g_map, spdk_env_get_current_core(), &group_impl->base);
 	}
@@ -1487,6 +2098,18 @@ uring_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group,
 	sock->cancel_task.sock = sock;
 	sock->cancel_task.type = SPDK_SOCK_TASK_CANCEL;
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	sock->recv_task.sock = sock;
+	sock->recv_task.type = SPDK_SOCK_TASK_RECV;
+
+	/* Groups without sockets using the receive pipe don't need the provided buffers */
+	if (!group->buf_ring_probed && sock->base.impl_opts.enable_recv_pipe) {
+		uring_sock_group_setup_buf_ring(group);
+	}
+
+	uring_sock_group_add_fixed_file(group, sock);
+#endif
+
 	/* switched from another polling group due to scheduling */
 	if (spdk_unlikely(sock->recv_pipe != NULL &&
 			  (spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0))) {
@@ -1495,6 +2118,10 @@ uring_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group,
 		TAILQ_INSERT_TAIL(&group->pending_recv, sock, link);
 	}
 
+	if (sock->recv_pipe != NULL) {
+		group->recv_pipe_bytes += sock->recv_buf_sz;
+	}
+
 	if (sock->placement_id != -1) {
 		rc = spdk_sock_map_insert(&g_map, sock->placement_id, &group->base);
 		if (rc != 0) {
@@ -1506,6 +2133,33 @@ uring_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group,
 	return 0;
 }
 
+/* Release the adaptive receive pipes of idle sockets and shrink the ones that are mostly empty */
+static void
+uring_sock_group_check_pipes(struct spdk_uring_sock_group_impl *group, uint64_t now)
+{
+	struct spdk_sock *_sock;
+	struct spdk_uring_sock *sock;
+	uint64_t idle_ticks;
+	int min_sz;
+
+	TAILQ_FOREACH(_sock, &group->base.socks, link) {
+		sock = __uring_sock(_sock);
+		if (sock->recv_pipe == NULL || spdk_pipe_reader_bytes_available(sock->recv_pipe) > 0 ||
+		    !uring_sock_adaptive_pipe(sock)) {
+			continue;
+		}
+
+		idle_ticks = (uint64_t)_sock->impl_opts.recv_pipe_idle_timeout * spdk_get_ticks_hz() / 1000;
+		min_sz = spdk_min(RECV_PIPE_INIT_SIZE, sock->recv_pipe_max_sz);
+		if (now - sock->recv_tsc >= idle_ticks) {
+			uring_sock_alloc_pipe(sock, 0);
+		} else if (sock->recv_pipe_peak < sock->recv_buf_sz / 4 && sock->recv_buf_sz / 2 >= min_sz) {
+			uring_sock_alloc_pipe(sock, sock->recv_buf_sz / 2);
+		}
+		sock->recv_pipe_peak = 0;
+	}
+}
+
 static int
 uring_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 			   struct spdk_sock **socks)
@@ -1515,6 +2169,7 @@ uring_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	int to_complete, to_submit;
 	struct spdk_sock *_sock, *tmp;
 	struct spdk_uring_sock *sock;
+	uint64_t now;
 
 	if (spdk_likely(socks)) {
 		TAILQ_FOREACH_SAFE(_sock, &group->base.socks, link, tmp) {
@@ -1525,6 +2180,15 @@ uring_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 			_sock_flush(_sock);
 			_sock_prep_pollin(_sock);
 		}
+
+		if (group->recv_pipe_bytes > 0) {
+			now = spdk_get_ticks();
+			if (now >= group->recv_pipe_check_tsc) {
+				uring_sock_group_check_pipes(group, now);
+				group->recv_pipe_check_tsc = now + RECV_PIPE_CHECK_PERIOD_US * spdk_get_ticks_hz() /
+							     SPDK_SEC_TO_USEC;
+			}
+		}
 	}
 
 	to_submit = group->io_queued;
@@ -1588,11 +2252,31 @@ uring_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group,
 		}
 	}
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	if (sock->recv_task.status != SPDK_URING_SOCK_TASK_NOT_IN_USE) {
+		_sock_prep_cancel_task(_sock, &sock->recv_task);
+		/* Since spdk_sock_group_remove_sock is not asynchronous interface, so
+		 * currently can use a while loop here. */
+		while ((sock->recv_task.status != SPDK_URING_SOCK_TASK_NOT_IN_USE) ||
+		       (sock->cancel_task.status != SPDK_URING_SOCK_TASK_NOT_IN_USE)) {
+			uring_sock_group_impl_poll(_group, 32, NULL);
+		}
+	}
+#endif
+
 	/* Make sure the cancelling the tasks above didn't cause sending new requests */
 	assert(sock->write_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
 	assert(sock->pollin_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
 	assert(sock->errqueue_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	assert(sock->recv_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
+	/* The provided buffers belong to the group, so move the data the sock hasn't
+	 * read yet to its receive pipe */
+	uring_sock_recv_bufs_to_pipe(sock);
+	uring_sock_group_remove_fixed_file(group, sock);
+#endif
+
 	if (sock->pending_recv) {
 		TAILQ_REMOVE(&group->pending_recv, sock, link);
 		sock->pending_recv = false;
@@ -1603,6 +2287,11 @@ uring_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group,
 		spdk_sock_map_release(&g_map, sock->placement_id);
 	}
 
+	if (sock->recv_pipe != NULL) {
+		assert(group->recv_pipe_bytes >= (uint64_t)sock->recv_buf_sz);
+		group->recv_pipe_bytes -= sock->recv_buf_sz;
+	}
+
 	sock->group = NULL;
 	return 0;
 }
@@ -1621,6 +2310,13 @@ uring_sock_group_impl_close(struct spdk_sock_group_impl *_group)
 
 	io_uring_queue_exit(&group->uring);
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+	free(group->free_fixed_fds);
+	free(group->buf_pool);
+	free(group->buf_ring);
+	free(group->bufs);
+#endif
+
 	if (g_spdk_uring_sock_impl_opts.enable_placement_id == PLACEMENT_CPU) {
 		spdk_sock_map_release(&g_map, spdk_env_get_current_core());
 	}
@@ -1651,6 +2347,7 @@ static struct spdk_net_impl g_uring_net_impl = {
 	.recv		= uring_sock_recv,
 	.readv		= uring_sock_readv,
 	.readv_async	= uring_sock_readv_async,
+	.recv_next	= uring_sock_recv_next,
 	.writev		= uring_sock_writev,
 	.writev_async	= uring_sock_writev_async,
 	.flush          = uring_sock_flush,
@@ -1668,6 +2365,8 @@ static struct spdk_net_impl g_uring_net_impl = {
 	.group_impl_close	= uring_sock_group_impl_close,
 	.get_opts		= uring_sock_impl_get_opts,
 	.set_opts		= uring_sock_impl_set_opts,
+	.get_stats		= uring_sock_impl_get_stats,
 };
 
 SPDK_NET_IMPL_REGISTER(uring, &g_uring_net_impl, DEFAULT_SOCK_PRIORITY + 1);
+SPDK_LOG_REGISTER_COMPONENT(sock_uring)
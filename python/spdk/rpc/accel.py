@@ -23,3 +23,8 @@ def accel_assign_opc(client, opname, engine):
     }
 
     return client.call('accel_assign_opc', params)
+
+
+def accel_get_stats(client):
+    """Get accel framework statistics."""
+    return client.call('accel_get_stats')
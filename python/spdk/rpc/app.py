@@ -33,12 +33,14 @@ def framework_get_reactors(client):
 
 
 def framework_set_scheduler(client, name, period=None, load_limit=None, core_limit=None,
-                            core_busy=None):
+                            core_busy=None, bin_packing=None, work_stealing=None):
     """Select threads scheduler that will be activated and its period.
 
     Args:
         name: Name of a scheduler
         period: Scheduler period in microseconds
+        bin_packing: Predict thread load and bin pack active threads (dynamic only)
+        work_stealing: Move threads off overloaded cores between periods (dynamic only)
     Returns:
         True or False
     """
@@ -51,6 +53,10 @@ def framework_set_scheduler(client, name, period=None, load_limit=None, core_lim
         params['core_limit'] = core_limit
     if core_busy is not None:
         params['core_busy'] = core_busy
+    if bin_packing is not None:
+        params['bin_packing'] = bin_packing
+    if work_stealing is not None:
+        params['work_stealing'] = work_stealing
     return client.call('framework_set_scheduler', params)
 
 
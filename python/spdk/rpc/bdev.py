@@ -1,5 +1,6 @@
 def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bdev_auto_examine=None,
-                     small_buf_pool_size=None, large_buf_pool_size=None):
+                     small_buf_pool_size=None, large_buf_pool_size=None,
+                     small_buf_cache_size=None, large_buf_cache_size=None):
     """Set parameters for the bdev subsystem.
 
     Args:
@@ -8,6 +9,8 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bd
         bdev_auto_examine: if set to false, the bdev layer will not examine every disks automatically (optional)
         small_buf_pool_size: maximum number of small buffer (8KB buffer) pool size (optional)
         large_buf_pool_size: maximum number of large buffer (64KB buffer) pool size (optional)
+        small_buf_cache_size: maximum number of small buffers cached per thread, 0 to disable (optional)
+        large_buf_cache_size: maximum number of large buffers cached per thread, 0 to disable (optional)
     """
     params = {}
 
@@ -21,6 +24,10 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bd
         params['small_buf_pool_size'] = small_buf_pool_size
     if large_buf_pool_size:
         params['large_buf_pool_size'] = large_buf_pool_size
+    if small_buf_cache_size is not None:
+        params['small_buf_cache_size'] = small_buf_cache_size
+    if large_buf_cache_size is not None:
+        params['large_buf_cache_size'] = large_buf_cache_size
     return client.call('bdev_set_options', params)
 
 
@@ -43,13 +50,15 @@ def bdev_wait_for_examine(client):
     return client.call('bdev_wait_for_examine')
 
 
-def bdev_compress_create(client, base_bdev_name, pm_path, lb_size):
+def bdev_compress_create(client, base_bdev_name, pm_path, lb_size, comp_algo=None, comp_level=None):
     """Construct a compress virtual block device.
 
     Args:
         base_bdev_name: name of the underlying base bdev
         pm_path: path to persistent memory
         lb_size: logical block size for the compressed vol in bytes.  Must be 4K or 512.
+        comp_algo: compression algorithm: deflate, lz4 or zstd (optional)
+        comp_level: compression level, 0 selects the algorithm's default (optional)
 
     Returns:
         Name of created virtual block device.
@@ -58,6 +67,10 @@ def bdev_compress_create(client, base_bdev_name, pm_path, lb_size):
 
     if lb_size:
         params['lb_size'] = lb_size
+    if comp_algo:
+        params['comp_algo'] = comp_algo
+    if comp_level is not None:
+        params['comp_level'] = comp_level
 
     return client.call('bdev_compress_create', params)
 
@@ -104,7 +117,7 @@ def bdev_crypto_create(client, base_bdev_name, name, crypto_pmd, key, cipher=Non
     Args:
         base_bdev_name: name of the underlying base bdev
         name: name for the crypto vbdev
-        crypto_pmd: name of of the DPDK crypto driver to use
+        crypto_pmd: name of of the DPDK crypto driver to use, or 'accel' to use the accel framework
         key: key
 
     Returns:
@@ -862,16 +875,19 @@ def bdev_nvme_set_preferred_path(client, name, cntlid):
     return client.call('bdev_nvme_set_preferred_path', params)
 
 
-def bdev_nvme_set_multipath_policy(client, name, policy):
+def bdev_nvme_set_multipath_policy(client, name, policy, selector=None):
     """Set multipath policy of the NVMe bdev
 
     Args:
         name: NVMe bdev name
         policy: Multipath policy (active_passive or active_active)
+        selector: Path selector for active_active policy (round_robin, queue_depth or min_latency) (optional)
     """
 
     params = {'name': name,
               'policy': policy}
+    if selector:
+        params['selector'] = selector
 
     return client.call('bdev_nvme_set_multipath_policy', params)
 
@@ -1404,11 +1420,12 @@ def bdev_get_bdevs(client, name=None, timeout=None):
     return client.call('bdev_get_bdevs', params)
 
 
-def bdev_get_iostat(client, name=None):
+def bdev_get_iostat(client, name=None, reset_latency=None):
     """Get I/O statistics for block devices.
 
     Args:
         name: bdev name to query (optional; if omitted, query all bdevs)
+        reset_latency: reset latency statistics after reading them (optional)
 
     Returns:
         I/O statistics for the requested block devices.
@@ -1416,6 +1433,8 @@ def bdev_get_iostat(client, name=None):
     params = {}
     if name:
         params['name'] = name
+    if reset_latency:
+        params['reset_latency'] = reset_latency
     return client.call('bdev_get_iostat', params)
 
 
@@ -55,3 +55,12 @@ def blobfs_set_cache_size(client, size_in_mb):
         'size_in_mb': size_in_mb
     }
     return client.call('blobfs_set_cache_size', params)
+
+
+def blobfs_get_cache_stats(client):
+    """Get statistics of the blobstore filesystem cache.
+
+    Returns:
+        Cache hit, miss, eviction and readahead counters and list sizes.
+    """
+    return client.call('blobfs_get_cache_stats')
@@ -11,6 +11,19 @@ def sock_impl_get_options(client, impl_name=None):
     return client.call('sock_impl_get_options', params)
 
 
+def sock_impl_get_stats(client, impl_name=None):
+    """Get statistics of the socket layer implementation.
+
+    Args:
+        impl_name: name of socket implementation, e.g. posix
+    """
+    params = {}
+
+    params['impl_name'] = impl_name
+
+    return client.call('sock_impl_get_stats', params)
+
+
 def sock_impl_set_options(client,
                           impl_name=None,
                           recv_buf_size=None,
@@ -24,7 +37,9 @@ def sock_impl_set_options(client,
                           tls_version=None,
                           enable_ktls=None,
                           psk_key=None,
-                          psk_identity=None):
+                          psk_identity=None,
+                          recv_pipe_idle_timeout=None,
+                          group_recv_pipe_limit=None):
     """Set parameters for the socket layer implementation.
 
     Args:
@@ -41,6 +56,8 @@ def sock_impl_set_options(client,
         enable_ktls: enable or disable Kernel TLS (optional)
         psk_key: set psk_key (optional)
         psk_identity: set psk_identity (optional)
+        recv_pipe_idle_timeout: release receive pipes of sockets idle for this many msec, 0 disables adaptive receive pipes (optional)
+        group_recv_pipe_limit: limit of adaptive receive pipe memory of a sock group in bytes, 0 means no limit (optional)
     """
     params = {}
 
@@ -69,6 +86,10 @@ def sock_impl_set_options(client,
         params['psk_key'] = psk_key
     if psk_identity is not None:
         params['psk_identity'] = psk_identity
+    if recv_pipe_idle_timeout is not None:
+        params['recv_pipe_idle_timeout'] = recv_pipe_idle_timeout
+    if group_recv_pipe_limit is not None:
+        params['group_recv_pipe_limit'] = group_recv_pipe_limit
 
     return client.call('sock_impl_set_options', params)
 
@@ -16,6 +16,8 @@ pip install pyyaml
 pacman -Sy --needed --noconfirm numactl nasm
 # Additional dependencies for ISA-L used in compression
 pacman -Sy --needed --noconfirm autoconf automake libtool help2man
+# Additional dependencies for zstd and lz4 used in the accel software engine
+pacman -Sy --needed --noconfirm zstd lz4
 if [[ $INSTALL_DEV_TOOLS == "true" ]]; then
 	# Tools for developers
 	pacman -Sy --needed --noconfirm git astyle autopep8 \
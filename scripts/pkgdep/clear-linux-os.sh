@@ -6,6 +6,8 @@ swupd bundle-add -y c-basic make dev-utils openssl devpkg-libiscsi \
 	storage-utils
 # Additional dependencies for ISA-L used in compression
 swupd bundle-add -y dev-utils-dev
+# Additional dependencies for zstd and lz4 used in the accel software engine
+swupd bundle-add -y devpkg-zstd devpkg-lz4
 # Additional dependencies for DPDK
 swupd bundle-add -y nasm sysadmin-basic
 # Additional dependencies for SPDK CLI
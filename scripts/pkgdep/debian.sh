@@ -38,6 +38,8 @@ fi
 apt-get install -y libnuma-dev
 # Additional dependencies for ISA-L used in compression
 apt-get install -y autoconf automake libtool help2man
+# Additional dependencies for zstd and lz4 used in the accel software engine
+apt-get install -y libzstd-dev liblz4-dev
 # Additional dependencies for USDT
 apt-get install -y systemtap-sdt-dev
 if [[ $INSTALL_DEV_TOOLS == "true" ]]; then
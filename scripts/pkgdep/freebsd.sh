@@ -6,6 +6,8 @@ pkg install -y gmake cunit openssl git bash misc/e2fsprogs-libuuid python \
 pkg install -g -y "py*-pyelftools-*" "py*-pandas"
 # Additional dependencies for ISA-L used in compression
 pkg install -y autoconf automake libtool help2man
+# Additional dependencies for zstd and lz4 used in the accel software engine
+pkg install -y archivers/zstd archivers/liblz4
 if [[ $INSTALL_DEV_TOOLS == "true" ]]; then
 	# Tools for developers
 	pkg install -y devel/astyle bash \
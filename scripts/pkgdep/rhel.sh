@@ -116,6 +116,8 @@ if ! echo "$ID $VERSION_ID" | grep -E -q 'rhel 7|centos 7'; then
 fi
 # Additional dependencies for ISA-L used in compression
 yum install -y autoconf automake libtool help2man
+# Additional dependencies for zstd and lz4 used in the accel software engine
+yum install -y libzstd-devel lz4-devel
 # Additional dependencies for DPDK
 yum install -y numactl-devel nasm
 # Additional dependencies for USDT
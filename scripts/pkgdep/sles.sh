@@ -8,6 +8,8 @@ zypper install -y gcc gcc-c++ make cunit-devel libaio-devel libopenssl-devel \
 zypper install -y libnuma-devel nasm
 # Additional dependencies for ISA-L used in compression
 zypper install -y autoconf automake libtool help2man
+# Additional dependencies for zstd and lz4 used in the accel software engine
+zypper install -y libzstd-devel liblz4-devel
 if [[ $INSTALL_DEV_TOOLS == "true" ]]; then
 	# Tools for developers
 	zypper install -y git-core lcov python3-pycodestyle sg3_utils \
@@ -161,7 +161,9 @@ if __name__ == "__main__":
                                         period=args.period,
                                         load_limit=args.load_limit,
                                         core_limit=args.core_limit,
-                                        core_busy=args.core_busy)
+                                        core_busy=args.core_busy,
+                                        bin_packing=args.bin_packing,
+                                        work_stealing=args.work_stealing)
 
     p = subparsers.add_parser(
         'framework_set_scheduler', help='Select thread scheduler that will be activated and its period (experimental)')
@@ -170,6 +172,14 @@ if __name__ == "__main__":
     p.add_argument('--load-limit', help="Scheduler load limit. Reserved for dynamic scheduler", type=int, required=False)
     p.add_argument('--core-limit', help="Scheduler core limit. Reserved for dynamic scheduler", type=int, required=False)
     p.add_argument('--core-busy', help="Scheduler core busy limit. Reserved for dynamic schedler", type=int, required=False)
+    p.add_argument('--bin-packing', help="Enable load prediction and bin packing of active threads. Reserved for dynamic scheduler",
+                   action='store_true', default=None)
+    p.add_argument('--no-bin-packing', help="Disable bin packing of active threads. Reserved for dynamic scheduler",
+                   dest='bin_packing', action='store_false', default=None)
+    p.add_argument('--work-stealing', help="Enable moving threads from overloaded cores between scheduling periods. Reserved for dynamic scheduler",
+                   action='store_true', default=None)
+    p.add_argument('--no-work-stealing', help="Disable moving threads between scheduling periods. Reserved for dynamic scheduler",
+                   dest='work_stealing', action='store_false', default=None)
     p.set_defaults(func=framework_set_scheduler)
 
     def framework_get_scheduler(args):
@@ -186,7 +196,9 @@ if __name__ == "__main__":
                                   bdev_io_cache_size=args.bdev_io_cache_size,
                                   bdev_auto_examine=args.bdev_auto_examine,
                                   small_buf_pool_size=args.small_buf_pool_size,
-                                  large_buf_pool_size=args.large_buf_pool_size)
+                                  large_buf_pool_size=args.large_buf_pool_size,
+                                  small_buf_cache_size=args.small_buf_cache_size,
+                                  large_buf_cache_size=args.large_buf_cache_size)
 
     p = subparsers.add_parser('bdev_set_options',
                               help="""Set options of bdev subsystem""")
@@ -194,6 +206,8 @@ if __name__ == "__main__":
     p.add_argument('-c', '--bdev-io-cache-size', help='Maximum number of bdev_io structures cached per thread', type=int)
     p.add_argument('-s', '--small-buf-pool-size', help='Maximum number of small buf (i.e., 8KB) pool size', type=int)
     p.add_argument('-l', '--large-buf-pool-size', help='Maximum number of large buf (i.e., 64KB) pool size', type=int)
+    p.add_argument('--small-buf-cache-size', help='Maximum number of small buf (i.e., 8KB) cached per thread', type=int)
+    p.add_argument('--large-buf-cache-size', help='Maximum number of large buf (i.e., 64KB) cached per thread', type=int)
     group = p.add_mutually_exclusive_group()
     group.add_argument('-e', '--enable-auto-examine', dest='bdev_auto_examine', help='Allow to auto examine', action='store_true')
     group.add_argument('-d', '--disable-auto-examine', dest='bdev_auto_examine', help='Not allow to auto examine', action='store_false')
@@ -220,12 +234,17 @@ if __name__ == "__main__":
         print_json(rpc.bdev.bdev_compress_create(args.client,
                                                  base_bdev_name=args.base_bdev_name,
                                                  pm_path=args.pm_path,
-                                                 lb_size=args.lb_size))
+                                                 lb_size=args.lb_size,
+                                                 comp_algo=args.comp_algo,
+                                                 comp_level=args.comp_level))
 
     p = subparsers.add_parser('bdev_compress_create', help='Add a compress vbdev')
     p.add_argument('-b', '--base-bdev-name', help="Name of the base bdev")
     p.add_argument('-p', '--pm-path', help="Path to persistent memory")
     p.add_argument('-l', '--lb-size', help="Compressed vol logical block size (optional, if used must be 512 or 4096)", type=int)
+    p.add_argument('-a', '--comp-algo', help="Compression algorithm: deflate, lz4 or zstd (optional, default deflate)",
+                   choices=['deflate', 'lz4', 'zstd'])
+    p.add_argument('-c', '--comp-level', help="Compression level (optional, 0 = algorithm default)", type=int)
     p.set_defaults(func=bdev_compress_create)
 
     def bdev_compress_delete(args):
@@ -240,7 +259,7 @@ if __name__ == "__main__":
         rpc.bdev.bdev_compress_set_pmd(args.client,
                                        pmd=args.pmd)
     p = subparsers.add_parser('bdev_compress_set_pmd', help='Set pmd option for a compress disk')
-    p.add_argument('-p', '--pmd', type=int, help='0 = auto-select, 1= QAT only, 2 = ISAL only, 3 = mlx5_pci only')
+    p.add_argument('-p', '--pmd', type=int, help='0 = auto-select, 1= QAT only, 2 = ISAL only, 3 = mlx5_pci only, 4 = accel only')
     p.set_defaults(func=bdev_compress_set_pmd)
 
     def bdev_compress_get_orphans(args):
@@ -794,12 +813,14 @@ if __name__ == "__main__":
     def bdev_nvme_set_multipath_policy(args):
         rpc.bdev.bdev_nvme_set_multipath_policy(args.client,
                                                 name=args.name,
-                                                policy=args.policy)
+                                                policy=args.policy,
+                                                selector=args.selector)
 
     p = subparsers.add_parser('bdev_nvme_set_multipath_policy',
                               help="""Set multipath policy of the NVMe bdev""")
     p.add_argument('-b', '--name', help='Name of the NVMe bdev', required=True)
     p.add_argument('-p', '--policy', help='Multipath policy (active_passive or active_active)', required=True)
+    p.add_argument('-s', '--selector', help='Path selector for active_active policy (round_robin, queue_depth or min_latency)')
     p.set_defaults(func=bdev_nvme_set_multipath_policy)
 
     def bdev_nvme_cuse_register(args):
@@ -1068,11 +1089,14 @@ if __name__ == "__main__":
 
     def bdev_get_iostat(args):
         print_dict(rpc.bdev.bdev_get_iostat(args.client,
-                                            name=args.name))
+                                            name=args.name,
+                                            reset_latency=args.reset_latency))
 
     p = subparsers.add_parser('bdev_get_iostat',
                               help='Display current I/O statistics of all the blockdevs or required blockdev.')
     p.add_argument('-b', '--name', help="Name of the Blockdev. Example: Nvme0n1", required=False)
+    p.add_argument('-r', '--reset-latency', help="Reset latency statistics after reading them",
+                   action='store_true', required=False)
     p.set_defaults(func=bdev_get_iostat)
 
     def bdev_enable_histogram(args):
@@ -1956,7 +1980,7 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p = subparsers.add_parser('bdev_raid_create', help='Create new raid bdev')
     p.add_argument('-n', '--name', help='raid bdev name', required=True)
     p.add_argument('-z', '--strip-size-kb', help='strip size in KB', type=int)
-    p.add_argument('-r', '--raid-level', help='raid level, raid0 and a special level concat are supported', required=True)
+    p.add_argument('-r', '--raid-level', help='raid level, raid0, raid1 and a special level concat are supported', required=True)
     p.add_argument('-b', '--base-bdevs', help='base bdevs name, whitespace separated list in quotes', required=True)
     p.set_defaults(func=bdev_raid_create)
 
@@ -2000,7 +2024,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                             uuid=args.uuid,
                                             cache=args.cache,
                                             overprovisioning=args.overprovisioning,
-                                            core_mask=args.core_mask))
+                                            core_mask=args.core_mask,
+                                            l2p_dram_limit=args.l2p_dram_limit))
 
     p = subparsers.add_parser('bdev_ftl_create', help='Add FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2014,6 +2039,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    ' to user (optional); default 20', type=int)
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
+    p.add_argument('--l2p-dram-limit', help='Maximum amount of DRAM (in MiB) used by the L2P cache '
+                   '(optional); by default the whole L2P is kept in DRAM', type=int)
     p.set_defaults(func=bdev_ftl_create)
 
     def bdev_ftl_load(args):
@@ -2023,7 +2050,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                           uuid=args.uuid,
                                           cache=args.cache,
                                           overprovisioning=args.overprovisioning,
-                                          core_mask=args.core_mask))
+                                          core_mask=args.core_mask,
+                                          l2p_dram_limit=args.l2p_dram_limit))
 
     p = subparsers.add_parser('bdev_ftl_load', help='Load FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2036,6 +2064,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    ' to user (optional); default 20', type=int)
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
+    p.add_argument('--l2p-dram-limit', help='Maximum amount of DRAM (in MiB) used by the L2P cache '
+                   '(optional); by default the whole L2P is kept in DRAM', type=int)
     p.set_defaults(func=bdev_ftl_load)
 
     def bdev_ftl_unload(args):
@@ -2583,6 +2613,12 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-e', '--engine', help='name of engine')
     p.set_defaults(func=accel_assign_opc)
 
+    def accel_get_stats(args):
+        print_dict(rpc.accel.accel_get_stats(args.client))
+
+    p = subparsers.add_parser('accel_get_stats', help='Display accel framework statistics.')
+    p.set_defaults(func=accel_get_stats)
+
     # ioat
     def ioat_scan_accel_engine(args):
         rpc.ioat.ioat_scan_accel_engine(args.client)
@@ -2825,6 +2861,12 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('size_in_mb', help='Cache size for blobfs in megabytes.', type=int)
     p.set_defaults(func=blobfs_set_cache_size)
 
+    def blobfs_get_cache_stats(args):
+        print_dict(rpc.blobfs.blobfs_get_cache_stats(args.client))
+
+    p = subparsers.add_parser('blobfs_get_cache_stats', help='Display statistics of the blobfs cache')
+    p.set_defaults(func=blobfs_get_cache_stats)
+
     # sock
     def sock_impl_get_options(args):
         print_json(rpc.sock.sock_impl_get_options(args.client,
@@ -2834,6 +2876,14 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
     p.set_defaults(func=sock_impl_get_options)
 
+    def sock_impl_get_stats(args):
+        print_json(rpc.sock.sock_impl_get_stats(args.client,
+                                                impl_name=args.impl))
+
+    p = subparsers.add_parser('sock_impl_get_stats', help="""Get statistics of socket layer implementation""")
+    p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
+    p.set_defaults(func=sock_impl_get_stats)
+
     def sock_impl_set_options(args):
         rpc.sock.sock_impl_set_options(args.client,
                                        impl_name=args.impl,
@@ -2848,7 +2898,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        tls_version=args.tls_version,
                                        enable_ktls=args.enable_ktls,
                                        psk_key=args.psk_key,
-                                       psk_identity=args.psk_identity)
+                                       psk_identity=args.psk_identity,
+                                       recv_pipe_idle_timeout=args.recv_pipe_idle_timeout,
+                                       group_recv_pipe_limit=args.group_recv_pipe_limit)
 
     p = subparsers.add_parser('sock_impl_set_options', help="""Set options of socket layer implementation""")
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
@@ -2879,9 +2931,14 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    action='store_false', dest='enable_ktls')
     p.add_argument('--psk-key', help='Set default PSK KEY', dest='psk_key')
     p.add_argument('--psk-identity', help='Set default PSK ID', dest='psk_identity')
+    p.add_argument('--recv-pipe-idle-timeout', help='Release receive pipes of sockets idle for this many msec, '
+                   '0 disables adaptive receive pipes', type=int)
+    p.add_argument('--group-recv-pipe-limit', help='Limit of adaptive receive pipe memory of a sock group in bytes, '
+                   '0 means no limit', type=int)
     p.set_defaults(func=sock_impl_set_options, enable_recv_pipe=None, enable_quickack=None,
                    enable_placement_id=None, enable_zerocopy_send_server=None, enable_zerocopy_send_client=None,
-                   zerocopy_threshold=None, tls_version=None, enable_ktls=None, psk_key=None, psk_identity=None)
+                   zerocopy_threshold=None, tls_version=None, enable_ktls=None, psk_key=None, psk_identity=None,
+                   recv_pipe_idle_timeout=None, group_recv_pipe_limit=None)
 
     def sock_set_default_impl(args):
         print_json(rpc.sock.sock_set_default_impl(args.client,
@@ -18,10 +18,13 @@
 #include "spdk/bit_array.h"
 #include "spdk/conf.h"
 #include "spdk/zipf.h"
+#include "spdk/histogram_data.h"
 
 #define BDEVPERF_CONFIG_MAX_FILENAME 1024
 #define BDEVPERF_CONFIG_UNDEFINED -1
 #define BDEVPERF_CONFIG_ERROR -2
+/* Upper bound of the period of the poller releasing rate limited I/O */
+#define BDEVPERF_RATE_LIMIT_MAX_POLL_US 1000
 
 struct bdevperf_task {
 	struct iovec			iov;
@@ -32,6 +35,7 @@ struct bdevperf_task {
 	uint64_t			offset_blocks;
 	struct bdevperf_task		*task_to_abort;
 	enum spdk_bdev_io_type		io_type;
+	uint64_t			submit_tsc;
 	TAILQ_ENTRY(bdevperf_task)	link;
 	struct spdk_bdev_io_wait_entry	bdev_io_wait;
 };
@@ -72,6 +76,7 @@ static struct spdk_cpuset g_all_cpuset;
 static struct spdk_poller *g_perf_timer = NULL;
 
 static void bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task);
+static void bdevperf_job_submit_next(struct bdevperf_job *job, struct bdevperf_task *task);
 static void rpc_perform_tests_cb(void);
 
 struct bdevperf_job {
@@ -115,6 +120,18 @@ struct bdevperf_job {
 	struct spdk_zipf		*zipf;
 	TAILQ_HEAD(, bdevperf_task)	task_list;
 	uint64_t			run_time_in_usec;
+
+	/* Rate limiting, tasks waiting for their turn are kept on rate_limited_tasks */
+	uint64_t			rate_ticks_per_io;
+	uint64_t			rate_next_tsc;
+	struct spdk_poller		*rate_poller;
+	TAILQ_HEAD(, bdevperf_task)	rate_limited_tasks;
+
+	/* Latency tracking and SLOs (in microseconds, 0 means no SLO) */
+	struct spdk_histogram_data	*latency;
+	uint64_t			slo_p50_us;
+	uint64_t			slo_p99_us;
+	uint64_t			slo_p9999_us;
 };
 
 struct spdk_bdevperf {
@@ -152,6 +169,11 @@ struct job_config {
 	int64_t				offset;
 	uint64_t			length;
 	enum job_config_rw		rw;
+	double				zipf_theta;
+	int				rate_iops;
+	int				slo_p50_us;
+	int				slo_p99_us;
+	int				slo_p9999_us;
 	TAILQ_ENTRY(job_config)	link;
 };
 
@@ -200,6 +222,13 @@ get_ema_io_per_second(struct bdevperf_job *job, uint64_t ema_period)
 	return job->ema_io_per_second;
 }
 
+static double
+get_latency_percentile_us(struct bdevperf_job *job, double percentile)
+{
+	return (double)spdk_histogram_data_get_percentile(job->latency, percentile) * 1000000 /
+	       spdk_get_ticks_hz();
+}
+
 static void
 performance_dump_job(struct bdevperf_aggregate_stats *stats, struct bdevperf_job *job)
 {
@@ -241,6 +270,11 @@ performance_dump_job(struct bdevperf_aggregate_stats *stats, struct bdevperf_job
 
 	printf("\t %-20s: %10.2f IOPS %10.2f MiB/s\n",
 	       job->name, io_per_second, mb_per_second);
+	if (job->latency != NULL) {
+		printf("\t %-20s: %10.2f p50 %10.2f p99 %10.2f p99.99 latency [us]\n", "",
+		       get_latency_percentile_us(job, 50.0), get_latency_percentile_us(job, 99.0),
+		       get_latency_percentile_us(job, 99.99));
+	}
 	if (failed_per_second != 0) {
 		printf("\t %-20s: %10.2f Fail/s %8.2f TO/s\n",
 		       "", failed_per_second, timeout_per_second);
@@ -253,6 +287,41 @@ performance_dump_job(struct bdevperf_aggregate_stats *stats, struct bdevperf_job
 	stats->total_timeout_per_second += timeout_per_second;
 }
 
+static bool
+check_latency_slo(struct bdevperf_job *job, const char *name, double percentile, uint64_t slo_us)
+{
+	double latency_us;
+	bool pass;
+
+	if (slo_us == 0) {
+		return true;
+	}
+
+	latency_us = get_latency_percentile_us(job, percentile);
+	pass = latency_us <= slo_us;
+	printf("\t %-20s: %-6s latency %10.2f us, SLO %10" PRIu64 " us: %s\n", "",
+	       name, latency_us, slo_us, pass ? "PASS" : "FAIL");
+
+	return pass;
+}
+
+/* Check the latency percentiles of a finished job against its SLOs */
+static bool
+check_job_slo(struct bdevperf_job *job)
+{
+	bool pass = true;
+
+	if (job->latency == NULL) {
+		return true;
+	}
+
+	pass &= check_latency_slo(job, "p50", 50.0, job->slo_p50_us);
+	pass &= check_latency_slo(job, "p99", 99.0, job->slo_p99_us);
+	pass &= check_latency_slo(job, "p99.99", 99.99, job->slo_p9999_us);
+
+	return pass;
+}
+
 static void
 generate_data(void *buf, int buf_len, int block_size, void *md_buf, int md_size,
 	      int num_blocks)
@@ -370,6 +439,7 @@ bdevperf_test_done(void *ctx)
 	struct bdevperf_task *task, *ttmp;
 	int rc;
 	uint64_t time_in_usec;
+	bool slo_failed = false;
 
 	if (g_time_in_usec) {
 		g_stats.io_time_in_usec = g_time_in_usec;
@@ -396,6 +466,9 @@ bdevperf_test_done(void *ctx)
 		TAILQ_REMOVE(&g_bdevperf.jobs, job, link);
 
 		performance_dump_job(&g_stats, job);
+		if (!check_job_slo(job)) {
+			slo_failed = true;
+		}
 
 		TAILQ_FOREACH_SAFE(task, &job->task_list, link, ttmp) {
 			TAILQ_REMOVE(&job->task_list, task, link);
@@ -408,6 +481,9 @@ bdevperf_test_done(void *ctx)
 			spdk_bit_array_free(&job->outstanding);
 		}
 		spdk_zipf_free(&job->zipf);
+		if (job->latency != NULL) {
+			spdk_histogram_data_free(job->latency);
+		}
 		free(job->name);
 		free(job);
 	}
@@ -419,6 +495,12 @@ bdevperf_test_done(void *ctx)
 		printf("\r %-28s: %10.2f Fail/s %8.2f TO/s\n",
 		       "", g_stats.total_failed_per_second, g_stats.total_timeout_per_second);
 	}
+	if (slo_failed) {
+		printf("\r Latency SLO was not met by at least one job\n");
+		if (g_run_rc == 0) {
+			g_run_rc = -ERANGE;
+		}
+	}
 	fflush(stdout);
 
 	rc = g_run_rc;
@@ -451,6 +533,7 @@ bdevperf_end_task(struct bdevperf_task *task)
 	TAILQ_INSERT_TAIL(&job->task_list, task, link);
 	if (job->is_draining) {
 		if (job->current_queue_depth == 0) {
+			spdk_poller_unregister(&job->rate_poller);
 			end_tsc = spdk_get_ticks() - g_start_tsc;
 			job->run_time_in_usec = end_tsc * 1000000 / spdk_get_ticks_hz();
 			spdk_put_io_channel(job->ch);
@@ -551,6 +634,9 @@ bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 
 	if (success) {
 		job->io_completed++;
+		if (job->latency != NULL) {
+			spdk_histogram_data_tally(job->latency, spdk_get_ticks() - task->submit_tsc);
+		}
 	} else {
 		job->io_failed++;
 	}
@@ -572,7 +658,7 @@ bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 	 * the one just completed.
 	 */
 	if (!job->is_draining) {
-		bdevperf_submit_single(job, task);
+		bdevperf_job_submit_next(job, task);
 	} else {
 		bdevperf_end_task(task);
 	}
@@ -843,6 +929,10 @@ bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 {
 	uint64_t offset_in_ios;
 
+	if (job->latency != NULL) {
+		task->submit_tsc = spdk_get_ticks();
+	}
+
 	if (job->zipf) {
 		offset_in_ios = spdk_zipf_generate(job->zipf);
 	} else if (job->is_random) {
@@ -912,6 +1002,77 @@ bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 	bdevperf_submit_task(task);
 }
 
+static bool
+bdevperf_job_rate_limited(struct bdevperf_job *job)
+{
+	uint64_t now, credit;
+
+	if (job->rate_ticks_per_io == 0) {
+		return false;
+	}
+
+	now = spdk_get_ticks();
+	if (job->rate_next_tsc > now) {
+		return true;
+	}
+
+	/* Don't let a job that fell behind accumulate more than a queue depth worth of credit */
+	credit = spdk_min(now, job->queue_depth * job->rate_ticks_per_io);
+	job->rate_next_tsc = spdk_max(job->rate_next_tsc, now - credit) + job->rate_ticks_per_io;
+
+	return false;
+}
+
+static void
+bdevperf_job_submit_next(struct bdevperf_job *job, struct bdevperf_task *task)
+{
+	if (bdevperf_job_rate_limited(job)) {
+		/* The task still counts as outstanding, so the job can't end before it's released */
+		job->current_queue_depth++;
+		TAILQ_INSERT_TAIL(&job->rate_limited_tasks, task, link);
+		return;
+	}
+
+	bdevperf_submit_single(job, task);
+}
+
+static int
+bdevperf_job_rate_poll(void *arg)
+{
+	struct bdevperf_job *job = arg;
+	TAILQ_HEAD(, bdevperf_task) tasks;
+	struct bdevperf_task *task;
+	int count = 0;
+
+	if (job->is_draining) {
+		spdk_poller_unregister(&job->rate_poller);
+
+		/* The last bdevperf_end_task() may end the job, so don't touch it afterwards */
+		TAILQ_INIT(&tasks);
+		TAILQ_CONCAT(&tasks, &job->rate_limited_tasks, link);
+		while ((task = TAILQ_FIRST(&tasks)) != NULL) {
+			TAILQ_REMOVE(&tasks, task, link);
+			job->current_queue_depth--;
+			bdevperf_end_task(task);
+		}
+
+		return SPDK_POLLER_BUSY;
+	}
+
+	while ((task = TAILQ_FIRST(&job->rate_limited_tasks)) != NULL) {
+		if (bdevperf_job_rate_limited(job)) {
+			break;
+		}
+
+		TAILQ_REMOVE(&job->rate_limited_tasks, task, link);
+		job->current_queue_depth--;
+		bdevperf_submit_single(job, task);
+		count++;
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
 static int reset_job(void *arg);
 
 static void
@@ -998,9 +1159,16 @@ bdevperf_job_run(void *ctx)
 
 	spdk_bdev_set_timeout(job->bdev_desc, g_timeout_in_sec, bdevperf_timeout_cb, job);
 
+	if (job->rate_ticks_per_io != 0) {
+		job->rate_next_tsc = spdk_get_ticks();
+		job->rate_poller = SPDK_POLLER_REGISTER(bdevperf_job_rate_poll, job,
+							spdk_min(job->rate_ticks_per_io * 1000000 / spdk_get_ticks_hz(),
+									BDEVPERF_RATE_LIMIT_MAX_POLL_US));
+	}
+
 	for (i = 0; i < job->queue_depth; i++) {
 		task = bdevperf_job_get_task(job);
-		bdevperf_submit_single(job, task);
+		bdevperf_job_submit_next(job, task);
 	}
 }
 
@@ -1319,8 +1487,28 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		job->ios_base = 0;
 	}
 
-	if (job->is_random && g_zipf_theta > 0) {
-		job->zipf = spdk_zipf_create(job->size_in_ios, g_zipf_theta, 0);
+	if (job->is_random && config->zipf_theta > 0) {
+		job->zipf = spdk_zipf_create(job->size_in_ios, config->zipf_theta, 0);
+	}
+
+	if (config->rate_iops > 0) {
+		job->rate_ticks_per_io = spdk_max(spdk_get_ticks_hz() / config->rate_iops, 1);
+	}
+
+	/* Latency is only tracked for job config files, to keep the CLI modes as lean as possible */
+	if (g_bdevperf_conf != NULL) {
+		job->latency = spdk_histogram_data_alloc();
+		if (job->latency == NULL) {
+			SPDK_ERRLOG("Could not allocate latency histogram for bdev %s\n",
+				    spdk_bdev_get_name(bdev));
+			spdk_zipf_free(&job->zipf);
+			free(job->name);
+			free(job);
+			return -ENOMEM;
+		}
+		job->slo_p50_us = config->slo_p50_us;
+		job->slo_p99_us = config->slo_p99_us;
+		job->slo_p9999_us = config->slo_p9999_us;
 	}
 
 	if (job->verify) {
@@ -1328,6 +1516,10 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		if (job->outstanding == NULL) {
 			SPDK_ERRLOG("Could not create outstanding array bitmap for bdev %s\n",
 				    spdk_bdev_get_name(bdev));
+			if (job->latency != NULL) {
+				spdk_histogram_data_free(job->latency);
+			}
+			spdk_zipf_free(&job->zipf);
 			free(job->name);
 			free(job);
 			return -ENOMEM;
@@ -1335,6 +1527,7 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 	}
 
 	TAILQ_INIT(&job->task_list);
+	TAILQ_INIT(&job->rate_limited_tasks);
 
 	task_num = job->queue_depth;
 	if (job->reset) {
@@ -1512,6 +1705,7 @@ make_cli_job_config(const char *filename, int64_t offset, uint64_t range)
 	config->rwmixread = g_rw_percentage;
 	config->offset = offset;
 	config->length = range;
+	config->zipf_theta = g_zipf_theta;
 	config->rw = parse_rw(g_workload_type, BDEVPERF_CONFIG_ERROR);
 	if ((int)config->rw == BDEVPERF_CONFIG_ERROR) {
 		return -EINVAL;
@@ -1693,6 +1887,31 @@ config_set_cli_args(struct job_config *config)
 	if (g_workload_type) {
 		config->rw = parse_rw(g_workload_type, config->rw);
 	}
+	if (g_zipf_theta > 0) {
+		config->zipf_theta = g_zipf_theta;
+	}
+}
+
+static int
+parse_zipf_option(struct spdk_conf_section *s, double def, double *theta)
+{
+	const char *val;
+	char *endptr;
+
+	val = spdk_conf_section_get_val(s, "zipf");
+	if (val == NULL) {
+		*theta = def;
+		return 0;
+	}
+
+	errno = 0;
+	*theta = strtod(val, &endptr);
+	if (errno || val == endptr || *endptr != '\0' || *theta < 0) {
+		fprintf(stderr, "Job '%s' has bad 'zipf' value.\n", spdk_conf_section_get_name(s));
+		return BDEVPERF_CONFIG_ERROR;
+	}
+
+	return 0;
 }
 
 static int
@@ -1738,6 +1957,12 @@ read_job_config(void)
 	/* length 0 means 100% */
 	global_default_config.length = 0;
 	global_default_config.rw = BDEVPERF_CONFIG_UNDEFINED;
+	global_default_config.zipf_theta = 0;
+	/* 0 means no rate limit and no latency SLOs */
+	global_default_config.rate_iops = 0;
+	global_default_config.slo_p50_us = 0;
+	global_default_config.slo_p99_us = 0;
+	global_default_config.slo_p9999_us = 0;
 	config_set_cli_args(&global_default_config);
 
 	if ((int)global_default_config.rw == BDEVPERF_CONFIG_ERROR) {
@@ -1838,6 +2063,30 @@ read_job_config(void)
 			goto error;
 		}
 
+		if (parse_zipf_option(s, global_config.zipf_theta, &config->zipf_theta) != 0) {
+			goto error;
+		}
+
+		config->rate_iops = parse_uint_option(s, "rate_iops", global_config.rate_iops);
+		if (config->rate_iops == BDEVPERF_CONFIG_ERROR) {
+			goto error;
+		}
+
+		config->slo_p50_us = parse_uint_option(s, "slo_p50_us", global_config.slo_p50_us);
+		if (config->slo_p50_us == BDEVPERF_CONFIG_ERROR) {
+			goto error;
+		}
+
+		config->slo_p99_us = parse_uint_option(s, "slo_p99_us", global_config.slo_p99_us);
+		if (config->slo_p99_us == BDEVPERF_CONFIG_ERROR) {
+			goto error;
+		}
+
+		config->slo_p9999_us = parse_uint_option(s, "slo_p9999_us", global_config.slo_p9999_us);
+		if (config->slo_p9999_us == BDEVPERF_CONFIG_ERROR) {
+			goto error;
+		}
+
 		if (is_global) {
 			config_set_cli_args(config);
 			global_config = *config;
@@ -38,4 +38,17 @@ create_job "job3"
 bdevperf_output=$($bdevperf -t 2 --json $jsonconf -j $testconf 2>&1)
 [[ $(get_num_jobs "$bdevperf_output") == "4" ]]
 cleanup
+#Test mixed, rate limited jobs with latency SLOs against the same bdev.
+create_job "job0" "randread" "Malloc0"
+cat <<- EOF >> "$testconf"
+	zipf=1.2
+	rate_iops=1000
+	slo_p9999_us=10000000
+EOF
+create_job "job1" "write" "Malloc0"
+bdevperf_output=$($bdevperf -t 2 --json $jsonconf -j $testconf 2>&1)
+[[ $(get_num_jobs "$bdevperf_output") == "2" ]]
+[[ $(echo "$bdevperf_output" | grep -c "p99.99 latency") -ge 2 ]]
+[[ $(echo "$bdevperf_output" | grep -c "SLO.*PASS") == "1" ]]
+cleanup
 trap - SIGINT SIGTERM EXIT
@@ -70,6 +70,7 @@ test_setup(void)
 	}
 	g_sw_ch = (struct sw_accel_io_channel *)((char *)g_engine_ch + sizeof(
 				struct spdk_io_channel));
+	TAILQ_INIT(&g_sw_ch->tasks_to_execute);
 	TAILQ_INIT(&g_sw_ch->tasks_to_complete);
 	g_accel_module.supports_opcode = _supports_opcode;
 	return 0;
@@ -78,6 +79,7 @@ test_setup(void)
 static int
 test_cleanup(void)
 {
+	accel_free_stats(&g_accel_ch->stats);
 	free(g_ch);
 	free(g_engine_ch);
 
@@ -452,6 +454,400 @@ test_spdk_accel_submit_copy_crc32c(void)
 	CU_ASSERT(expected_accel_task == &task);
 }
 
+static void
+test_spdk_accel_submit_xor(void)
+{
+	const uint64_t nbytes = TEST_SUBMIT_SIZE;
+	uint8_t dst[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src1[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src2[TEST_SUBMIT_SIZE] = {0};
+	void *sources[] = { src1, src2 };
+	uint32_t nsrcs = SPDK_COUNTOF(sources);
+	void *cb_arg = NULL;
+	int rc;
+	struct spdk_accel_task task;
+	struct spdk_accel_task *expected_accel_task = NULL;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+
+	/* Fail with less than two sources */
+	rc = spdk_accel_submit_xor(g_ch, dst, sources, 1, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_xor(g_ch, dst, sources, nsrcs, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == -ENOMEM);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+
+	/* accel submission OK. */
+	memset(src1, 0x5a, nbytes);
+	memset(src2, 0xa5, nbytes);
+	rc = spdk_accel_submit_xor(g_ch, dst, sources, nsrcs, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.nsrcs.srcs == sources);
+	CU_ASSERT(task.nsrcs.cnt == nsrcs);
+	CU_ASSERT(task.dst == dst);
+	CU_ASSERT(task.nbytes == nbytes);
+	CU_ASSERT(task.op_code == ACCEL_OPC_XOR);
+	memset(src1, 0xff, nbytes);
+	CU_ASSERT(memcmp(dst, src1, nbytes) == 0);
+	expected_accel_task = TAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, expected_accel_task, link);
+	CU_ASSERT(expected_accel_task == &task);
+	CU_ASSERT(task.status == 0);
+}
+
+static void
+test_spdk_accel_submit_pq_gen(void)
+{
+	const uint64_t nbytes = TEST_SUBMIT_SIZE;
+	uint8_t p[TEST_SUBMIT_SIZE] = {0};
+	uint8_t q[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src1[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src2[TEST_SUBMIT_SIZE] = {0};
+	uint8_t expected[TEST_SUBMIT_SIZE] = {0};
+	void *sources[] = { src1, src2 };
+	uint32_t nsrcs = SPDK_COUNTOF(sources);
+	void *cb_arg = NULL;
+	int rc;
+	struct spdk_accel_task task;
+	struct spdk_accel_task *expected_accel_task = NULL;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+
+	/* Fail with less than two sources */
+	rc = spdk_accel_submit_pq_gen(g_ch, p, q, sources, 1, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_pq_gen(g_ch, p, q, sources, nsrcs, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == -ENOMEM);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+
+	/* accel submission OK. With src1 = 0x01 and src2 = 0x80, P = 0x81 and
+	 * Q = 0x01 ^ 2 * 0x80 = 0x01 ^ 0x1d = 0x1c in GF(2^8). */
+	memset(src1, 0x01, nbytes);
+	memset(src2, 0x80, nbytes);
+	rc = spdk_accel_submit_pq_gen(g_ch, p, q, sources, nsrcs, nbytes, NULL, cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.nsrcs.srcs == sources);
+	CU_ASSERT(task.nsrcs.cnt == nsrcs);
+	CU_ASSERT(task.dst == p);
+	CU_ASSERT(task.dst2 == q);
+	CU_ASSERT(task.nbytes == nbytes);
+	CU_ASSERT(task.op_code == ACCEL_OPC_PQ_GEN);
+	memset(expected, 0x81, nbytes);
+	CU_ASSERT(memcmp(p, expected, nbytes) == 0);
+	memset(expected, 0x1c, nbytes);
+	CU_ASSERT(memcmp(q, expected, nbytes) == 0);
+	expected_accel_task = TAILQ_FIRST(&g_sw_ch->tasks_to_complete);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, expected_accel_task, link);
+	CU_ASSERT(expected_accel_task == &task);
+	CU_ASSERT(task.status == 0);
+}
+
+static void
+test_spdk_accel_submit_encrypt_decrypt(void)
+{
+	const uint8_t key[16] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+				  0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+				};
+	const uint8_t key2[16] = { 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+				   0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10
+				 };
+	struct spdk_accel_crypto_key_create_param param = {
+		.cipher = ACCEL_AES_XTS,
+		.key = key,
+		.key_size = sizeof(key),
+		.key2 = key,
+		.key2_size = sizeof(key),
+	};
+	const uint32_t block_size = TEST_SUBMIT_SIZE / 2;
+	uint8_t src[TEST_SUBMIT_SIZE], dst[TEST_SUBMIT_SIZE], block[TEST_SUBMIT_SIZE / 2];
+	struct iovec src_iov, dst_iovs[2], block_iov;
+	struct spdk_accel_crypto_key *crypto_key = NULL;
+	struct spdk_accel_task task;
+	int rc;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	g_accel_module.crypto_key_init = sw_accel_crypto_key_init;
+	g_accel_module.crypto_key_deinit = sw_accel_crypto_key_deinit;
+	g_sw_ch->crypto_ctx = EVP_CIPHER_CTX_new();
+	SPDK_CU_ASSERT_FATAL(g_sw_ch->crypto_ctx != NULL);
+
+	/* XTS requires two different keys */
+	rc = spdk_accel_crypto_key_create(&param, &crypto_key);
+	CU_ASSERT(rc == -EINVAL);
+	param.key2 = key2;
+	param.key2_size = 8;
+	rc = spdk_accel_crypto_key_create(&param, &crypto_key);
+	CU_ASSERT(rc == -EINVAL);
+	param.key2_size = sizeof(key2);
+	rc = spdk_accel_crypto_key_create(&param, &crypto_key);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(crypto_key != NULL);
+
+	memset(src, 0x5a, sizeof(src));
+	src_iov.iov_base = src;
+	src_iov.iov_len = sizeof(src);
+	/* Split the destination in the middle of the first block */
+	dst_iovs[0].iov_base = dst;
+	dst_iovs[0].iov_len = 10;
+	dst_iovs[1].iov_base = dst + 10;
+	dst_iovs[1].iov_len = sizeof(dst) - 10;
+
+	/* Fail with no tasks on _get_task() */
+	rc = spdk_accel_submit_encrypt(g_ch, crypto_key, dst_iovs, 2, &src_iov, 1, 7, block_size, 0,
+				       NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	rc = spdk_accel_submit_encrypt(g_ch, crypto_key, dst_iovs, 2, &src_iov, 1, 7, block_size, 0,
+				       NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.op_code == ACCEL_OPC_ENCRYPT);
+	CU_ASSERT(task.crypto_key == crypto_key);
+	CU_ASSERT(task.iv == 7);
+	CU_ASSERT(task.block_size == block_size);
+	CU_ASSERT(TAILQ_FIRST(&g_sw_ch->tasks_to_complete) == &task);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, &task, link);
+	CU_ASSERT(task.status == 0);
+	CU_ASSERT(memcmp(dst, src, block_size) != 0);
+	/* Identical plaintext blocks produce different ciphertext, as the tweak differs */
+	CU_ASSERT(memcmp(dst, dst + block_size, block_size) != 0);
+
+	/* Each block is encrypted on its own, with the tweak derived from its number */
+	block_iov.iov_base = block;
+	block_iov.iov_len = sizeof(block);
+	memcpy(block, src + block_size, block_size);
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	rc = spdk_accel_submit_encrypt(g_ch, crypto_key, &block_iov, 1, &block_iov, 1, 8, block_size,
+				       0, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, &task, link);
+	CU_ASSERT(memcmp(block, dst + block_size, block_size) == 0);
+
+	/* Decrypt in place */
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	rc = spdk_accel_submit_decrypt(g_ch, crypto_key, dst_iovs, 2, dst_iovs, 2, 7, block_size, 0,
+				       NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.op_code == ACCEL_OPC_DECRYPT);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, &task, link);
+	CU_ASSERT(task.status == 0);
+	CU_ASSERT(memcmp(dst, src, sizeof(src)) == 0);
+
+	/* The length must be a multiple of the block size */
+	dst_iovs[1].iov_len -= 1;
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	rc = spdk_accel_submit_decrypt(g_ch, crypto_key, dst_iovs, 2, dst_iovs, 2, 7, block_size, 0,
+				       NULL, NULL);
+	CU_ASSERT(rc == 0);
+	TAILQ_REMOVE(&g_sw_ch->tasks_to_complete, &task, link);
+	CU_ASSERT(task.status == -EINVAL);
+
+	spdk_accel_crypto_key_destroy(crypto_key);
+	EVP_CIPHER_CTX_free(g_sw_ch->crypto_ctx);
+	g_sw_ch->crypto_ctx = NULL;
+	free(g_sw_ch->crypto_buf);
+	g_sw_ch->crypto_buf = NULL;
+	g_sw_ch->crypto_buf_size = 0;
+	g_accel_module.crypto_key_init = NULL;
+	g_accel_module.crypto_key_deinit = NULL;
+}
+
+#define TEST_COMP_SIZE (16 * 1024)
+static bool g_comp_done;
+static int g_comp_status;
+
+static void
+comp_done_cb(void *cb_arg, int status)
+{
+	g_comp_done = true;
+	g_comp_status = status;
+}
+
+/* Poll the software engine until the operation completes, returns the number of polls */
+static int
+_comp_poll_until_done(void)
+{
+	int polls = 0;
+
+	while (!g_comp_done && polls < 1000) {
+		accel_comp_poll(g_sw_ch);
+		polls++;
+	}
+	CU_ASSERT(g_comp_done);
+
+	return polls;
+}
+
+static void
+_test_comp_round_trip(enum spdk_accel_comp_algo algo, uint32_t chunk_size)
+{
+	struct spdk_accel_comp_opts opts = {
+		.size = sizeof(opts),
+		.algo = algo,
+		.chunk_size = chunk_size,
+	};
+	struct accel_comp_stats *stats = g_accel_ch->stats.comp[algo];
+	struct accel_comp_stats prev[ACCEL_COMP_DIR_LAST];
+	uint8_t *src, *dst, *out;
+	struct iovec src_iovs[3], dst_iovs[2], out_iovs[2];
+	struct spdk_accel_task task = {};
+	uint32_t comp_size = 0, decomp_size = 0;
+	int polls, rc, i;
+
+	src = calloc(1, TEST_COMP_SIZE);
+	dst = calloc(1, TEST_COMP_SIZE);
+	out = calloc(1, TEST_COMP_SIZE);
+	SPDK_CU_ASSERT_FATAL(src != NULL && dst != NULL && out != NULL);
+	for (i = 0; i < TEST_COMP_SIZE; i++) {
+		src[i] = (i / 64) % 7 + (i % 3);
+	}
+	memcpy(prev, stats, sizeof(prev));
+
+	/* Uneven splits of both source and destination */
+	src_iovs[0].iov_base = src;
+	src_iovs[0].iov_len = 100;
+	src_iovs[1].iov_base = src + 100;
+	src_iovs[1].iov_len = 0;
+	src_iovs[2].iov_base = src + 100;
+	src_iovs[2].iov_len = TEST_COMP_SIZE - 100;
+	dst_iovs[0].iov_base = dst;
+	dst_iovs[0].iov_len = 17;
+	dst_iovs[1].iov_base = dst + 17;
+	dst_iovs[1].iov_len = TEST_COMP_SIZE - 17;
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	g_comp_done = false;
+	rc = spdk_accel_submit_compress_ext(g_ch, dst_iovs, 2, src_iovs, 3, &comp_size, &opts, 0,
+					    comp_done_cb, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.op_code == ACCEL_OPC_COMPRESS);
+	CU_ASSERT(task.nbytes == TEST_COMP_SIZE);
+	polls = _comp_poll_until_done();
+	CU_ASSERT(g_comp_status == 0);
+	CU_ASSERT(comp_size > 0 && comp_size < TEST_COMP_SIZE);
+	/* With a chunk size the operation is spread over several polls */
+	if (chunk_size != 0) {
+		CU_ASSERT(polls > 1);
+	} else {
+		CU_ASSERT(polls == 1);
+	}
+	CU_ASSERT(TAILQ_EMPTY(&g_sw_ch->tasks_to_execute));
+	CU_ASSERT(stats[ACCEL_COMP_DIR_COMPRESS].num_ops == prev[ACCEL_COMP_DIR_COMPRESS].num_ops + 1);
+	CU_ASSERT(stats[ACCEL_COMP_DIR_COMPRESS].bytes_in ==
+		  prev[ACCEL_COMP_DIR_COMPRESS].bytes_in + TEST_COMP_SIZE);
+	CU_ASSERT(stats[ACCEL_COMP_DIR_COMPRESS].bytes_out ==
+		  prev[ACCEL_COMP_DIR_COMPRESS].bytes_out + comp_size);
+
+	/* Decompress from a split source into a split destination */
+	src_iovs[0].iov_base = dst;
+	src_iovs[0].iov_len = 5;
+	src_iovs[1].iov_base = dst + 5;
+	src_iovs[1].iov_len = comp_size - 5;
+	out_iovs[0].iov_base = out;
+	out_iovs[0].iov_len = 4000;
+	out_iovs[1].iov_base = out + 4000;
+	out_iovs[1].iov_len = TEST_COMP_SIZE - 4000;
+
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	g_comp_done = false;
+	rc = spdk_accel_submit_decompress_ext(g_ch, out_iovs, 2, src_iovs, 2, &decomp_size, &opts, 0,
+					      comp_done_cb, NULL);
+	CU_ASSERT(rc == 0);
+	_comp_poll_until_done();
+	CU_ASSERT(g_comp_status == 0);
+	CU_ASSERT(decomp_size == TEST_COMP_SIZE);
+	CU_ASSERT(memcmp(src, out, TEST_COMP_SIZE) == 0);
+	CU_ASSERT(stats[ACCEL_COMP_DIR_DECOMPRESS].num_ops ==
+		  prev[ACCEL_COMP_DIR_DECOMPRESS].num_ops + 1);
+	CU_ASSERT(stats[ACCEL_COMP_DIR_DECOMPRESS].bytes_in ==
+		  prev[ACCEL_COMP_DIR_DECOMPRESS].bytes_in + comp_size);
+
+	/* A destination too small for the compressed data fails with -ENOSPC */
+	dst_iovs[0].iov_len = 8;
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	g_comp_done = false;
+	rc = spdk_accel_submit_compress_ext(g_ch, dst_iovs, 1, src_iovs, 2, NULL, &opts, 0,
+					    comp_done_cb, NULL);
+	CU_ASSERT(rc == 0);
+	_comp_poll_until_done();
+	CU_ASSERT(g_comp_status == -ENOSPC);
+	CU_ASSERT(stats[ACCEL_COMP_DIR_COMPRESS].num_failed ==
+		  prev[ACCEL_COMP_DIR_COMPRESS].num_failed + 1);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->task_pool) == &task);
+	TAILQ_REMOVE(&g_accel_ch->task_pool, &task, link);
+
+	free(src);
+	free(dst);
+	free(out);
+}
+
+static void
+test_spdk_accel_submit_compress_ext(void)
+{
+	struct spdk_accel_comp_opts opts = { .size = sizeof(opts) };
+	uint8_t src[TEST_SUBMIT_SIZE], dst[TEST_SUBMIT_SIZE];
+	struct iovec src_iov = { .iov_base = src, .iov_len = sizeof(src) };
+	struct iovec dst_iov = { .iov_base = dst, .iov_len = sizeof(dst) };
+	struct spdk_accel_task task = {};
+	int algo, rc;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	rc = _sw_accel_comp_ctx_init(g_sw_ch);
+	CU_ASSERT(rc == 0);
+
+	/* Unknown algorithms and out of range levels are rejected */
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	opts.algo = SPDK_ACCEL_COMP_ALGO_LAST;
+	rc = spdk_accel_submit_compress_ext(g_ch, &dst_iov, 1, &src_iov, 1, NULL, &opts, 0,
+					    comp_done_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+	opts.algo = SPDK_ACCEL_COMP_ALGO_DEFLATE;
+	opts.level = INT16_MAX + 1;
+	rc = spdk_accel_submit_compress_ext(g_ch, &dst_iov, 1, &src_iov, 1, NULL, &opts, 0,
+					    comp_done_cb, NULL);
+	CU_ASSERT(rc == -EINVAL);
+	opts.level = 0;
+
+	/* Engines without the callback only support deflate */
+	g_accel_module.supports_comp_algo = NULL;
+	CU_ASSERT(spdk_accel_comp_algo_supported(SPDK_ACCEL_COMP_ALGO_DEFLATE));
+	CU_ASSERT(!spdk_accel_comp_algo_supported(SPDK_ACCEL_COMP_ALGO_LZ4));
+	opts.algo = SPDK_ACCEL_COMP_ALGO_LZ4;
+	rc = spdk_accel_submit_decompress_ext(g_ch, &dst_iov, 1, &src_iov, 1, NULL, &opts, 0,
+					      comp_done_cb, NULL);
+	CU_ASSERT(rc == -ENOTSUP);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->task_pool) == &task);
+	TAILQ_REMOVE(&g_accel_ch->task_pool, &task, link);
+
+	g_accel_module.supports_comp_algo = sw_accel_supports_comp_algo;
+	for (algo = 0; algo < SPDK_ACCEL_COMP_ALGO_LAST; algo++) {
+		if (!spdk_accel_comp_algo_supported(algo)) {
+			TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+			opts.algo = algo;
+			rc = spdk_accel_submit_compress_ext(g_ch, &dst_iov, 1, &src_iov, 1, NULL, &opts,
+							    0, comp_done_cb, NULL);
+			CU_ASSERT(rc == -ENOTSUP);
+			TAILQ_REMOVE(&g_accel_ch->task_pool, &task, link);
+			continue;
+		}
+
+		_test_comp_round_trip(algo, 0);
+		_test_comp_round_trip(algo, 1024);
+	}
+
+	g_accel_module.supports_comp_algo = NULL;
+	_sw_accel_channel_free(g_sw_ch);
+	memset(&g_sw_ch->comp, 0, sizeof(g_sw_ch->comp));
+	g_sw_ch->crypto_ctx = NULL;
+	g_sw_ch->crypto_buf = NULL;
+}
+
 static void
 test_spdk_accel_module_find_by_name(void)
 {
@@ -523,6 +919,424 @@ test_spdk_accel_module_register(void)
 	CU_ASSERT(i == 4);
 }
 
+#define TEST_SEQ_NUM_TASKS 8
+static struct spdk_accel_task g_seq_tasks[TEST_SEQ_NUM_TASKS];
+static struct spdk_accel_sequence g_seq;
+
+static void
+ut_sequence_setup(void)
+{
+	int i;
+
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	for (i = 0; i < TEST_SEQ_NUM_TASKS; i++) {
+		g_seq_tasks[i].accel_ch = g_accel_ch;
+		TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &g_seq_tasks[i], link);
+	}
+
+	TAILQ_INIT(&g_accel_ch->seq_pool);
+	TAILQ_INSERT_TAIL(&g_accel_ch->seq_pool, &g_seq, link);
+	TAILQ_INIT(&g_accel_ch->buf_cache);
+	TAILQ_INIT(&g_accel_ch->bufs_in_use);
+	g_accel_ch->num_cached_bufs = 0;
+}
+
+static void
+ut_sequence_cleanup(void)
+{
+	struct accel_buffer *accel_buf;
+	struct spdk_accel_task *task;
+	int num_tasks = 0;
+
+	/* Everything should be back in the pools */
+	TAILQ_FOREACH(task, &g_accel_ch->task_pool, link) {
+		num_tasks++;
+	}
+	CU_ASSERT(num_tasks == TEST_SEQ_NUM_TASKS);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->seq_pool) == &g_seq);
+	CU_ASSERT(TAILQ_EMPTY(&g_accel_ch->bufs_in_use));
+	CU_ASSERT(TAILQ_EMPTY(&g_sw_ch->tasks_to_complete));
+
+	while ((accel_buf = TAILQ_FIRST(&g_accel_ch->buf_cache))) {
+		TAILQ_REMOVE(&g_accel_ch->buf_cache, accel_buf, link);
+		accel_free_buf(accel_buf);
+	}
+
+	g_accel_module.ordered_tasks = false;
+}
+
+static void
+ut_sequence_step_cb(void *cb_arg)
+{
+	int *num_steps = cb_arg;
+
+	(*num_steps)++;
+}
+
+static void
+ut_sequence_complete_cb(void *cb_arg, int status)
+{
+	int *seq_status = cb_arg;
+
+	*seq_status = status;
+}
+
+static int
+ut_sequence_num_submitted(void)
+{
+	struct spdk_accel_task *task;
+	int num_tasks = 0;
+
+	TAILQ_FOREACH(task, &g_sw_ch->tasks_to_complete, link) {
+		num_tasks++;
+	}
+
+	return num_tasks;
+}
+
+static void
+test_sequence_elide_copy(void)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	uint8_t dst[TEST_SUBMIT_SIZE], expected[TEST_SUBMIT_SIZE];
+	uint32_t crc = 0, expected_crc;
+	void *buf;
+	int num_steps = 0, status = -1;
+	int rc;
+
+	ut_sequence_setup();
+	g_accel_module.ordered_tasks = true;
+	memset(dst, 0, sizeof(dst));
+	memset(expected, 0xa5, sizeof(expected));
+	expected_crc = spdk_crc32c_update(expected, sizeof(expected), ~0u);
+
+	rc = spdk_accel_get_buf(g_ch, sizeof(dst), &buf);
+	CU_ASSERT(rc == 0);
+
+	/* fill(buf) -> copy(buf, dst) -> crc32c(dst): the fill can write to dst directly */
+	rc = spdk_accel_append_fill(&seq, g_ch, buf, 0xa5, sizeof(dst), 0,
+				    ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(seq == &g_seq);
+	rc = spdk_accel_append_copy(&seq, g_ch, dst, buf, sizeof(dst), 0,
+				    ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_append_crc32c(&seq, g_ch, &crc, dst, 0, sizeof(dst),
+				      ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(num_steps == 0);
+
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &status);
+
+	/* Both remaining steps are handed to the engine at once */
+	CU_ASSERT(ut_sequence_num_submitted() == 2);
+	CU_ASSERT(status == -1);
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(num_steps == 3);
+	CU_ASSERT(memcmp(dst, expected, sizeof(dst)) == 0);
+	CU_ASSERT(crc == expected_crc);
+
+	spdk_accel_put_buf(g_ch, buf);
+	CU_ASSERT(g_accel_ch->num_cached_bufs == 1);
+
+	ut_sequence_cleanup();
+}
+
+static void
+test_sequence_unordered_engine(void)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	uint8_t src[TEST_SUBMIT_SIZE], dst[TEST_SUBMIT_SIZE];
+	uint32_t crc = 0;
+	int num_steps = 0, status = -1;
+	int rc;
+
+	ut_sequence_setup();
+	memset(src, 0x5a, sizeof(src));
+	memset(dst, 0, sizeof(dst));
+
+	/* Neither buffer is owned by the framework, so nothing is elided */
+	rc = spdk_accel_append_copy(&seq, g_ch, dst, src, sizeof(src), 0,
+				    ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_append_crc32c(&seq, g_ch, &crc, dst, 0, sizeof(dst),
+				      ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+
+	spdk_accel_sequence_finish(seq, ut_sequence_complete_cb, &status);
+
+	/* The engine doesn't guarantee ordering, so the steps are submitted one by one */
+	CU_ASSERT(ut_sequence_num_submitted() == 1);
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(num_steps == 1);
+	CU_ASSERT(status == -1);
+	CU_ASSERT(ut_sequence_num_submitted() == 1);
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(num_steps == 2);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(memcmp(dst, src, sizeof(src)) == 0);
+	CU_ASSERT(crc == spdk_crc32c_update(src, sizeof(src), ~0u));
+
+	ut_sequence_cleanup();
+}
+
+static void
+test_sequence_reverse_abort(void)
+{
+	struct spdk_accel_sequence *seq = NULL;
+	uint8_t src[TEST_SUBMIT_SIZE], dst[TEST_SUBMIT_SIZE];
+	int num_steps = 0;
+	int rc;
+
+	ut_sequence_setup();
+
+	rc = spdk_accel_append_copy(&seq, g_ch, dst, src, sizeof(src), 0,
+				    ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_append_fill(&seq, g_ch, dst, 0, sizeof(dst), 0,
+				    ut_sequence_step_cb, &num_steps);
+	CU_ASSERT(rc == 0);
+
+	spdk_accel_sequence_reverse(seq);
+	CU_ASSERT(TAILQ_FIRST(&seq->tasks)->op_code == ACCEL_OPC_FILL);
+	CU_ASSERT(TAILQ_LAST(&seq->tasks, accel_sequence_tasks)->op_code == ACCEL_OPC_COPY);
+
+	/* The steps are released without being executed */
+	spdk_accel_sequence_abort(seq);
+	CU_ASSERT(num_steps == 2);
+	CU_ASSERT(ut_sequence_num_submitted() == 0);
+
+	/* Appending fails without a free sequence, but leaves the existing one intact */
+	seq = NULL;
+	TAILQ_REMOVE(&g_accel_ch->seq_pool, &g_seq, link);
+	rc = spdk_accel_append_copy(&seq, g_ch, dst, src, sizeof(src), 0, NULL, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+	CU_ASSERT(seq == NULL);
+	TAILQ_INSERT_TAIL(&g_accel_ch->seq_pool, &g_seq, link);
+
+	ut_sequence_cleanup();
+}
+
+static int g_hw_submit_rc;
+static int g_hw_complete_status;
+
+static int
+ut_hw_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *task)
+{
+	if (g_hw_submit_rc != 0) {
+		return g_hw_submit_rc;
+	}
+
+	spdk_accel_task_complete(task, g_hw_complete_status);
+	return 0;
+}
+
+static struct spdk_accel_module_if g_ut_hw_module = {
+	.name = "ut_hw",
+	.submit_tasks = ut_hw_submit_tasks,
+};
+
+static void
+test_sw_fallback_stats(void)
+{
+	struct accel_opc_stats *stats = &g_accel_ch->stats.opc[ACCEL_OPC_COPY];
+	uint8_t src[TEST_SUBMIT_SIZE], dst[TEST_SUBMIT_SIZE];
+	struct spdk_accel_task task = {};
+	int status, rc;
+
+	accel_free_stats(&g_accel_ch->stats);
+	memset(&g_accel_ch->stats, 0, sizeof(g_accel_ch->stats));
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	task.accel_ch = g_accel_ch;
+	TAILQ_INSERT_TAIL(&g_accel_ch->task_pool, &task, link);
+	g_engines_opc[ACCEL_OPC_COPY] = &g_ut_hw_module;
+	/* The module registration test replaced the real software module */
+	g_sw_engine_module = &g_sw_module;
+	g_accel_ch->sw_ch = g_engine_ch;
+	memset(src, 0x5a, sizeof(src));
+
+	/* The engine failing the submission hands the task over to the software engine */
+	g_hw_submit_rc = -EBUSY;
+	memset(dst, 0, sizeof(dst));
+	status = -1;
+	rc = spdk_accel_submit_copy(g_ch, dst, src, sizeof(src), 0, ut_sequence_complete_cb, &status);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(task.fallback == true);
+	CU_ASSERT(memcmp(dst, src, sizeof(src)) == 0);
+	CU_ASSERT(stats->num_submitted == 1);
+	CU_ASSERT(stats->num_fallbacks == 1);
+	CU_ASSERT(stats->num_completed == 0);
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(stats->num_completed == 1);
+	CU_ASSERT(stats->num_failed == 0);
+	CU_ASSERT(stats->bytes == sizeof(src));
+	CU_ASSERT(stats->min_tsc <= stats->max_tsc);
+	CU_ASSERT(stats->histogram != NULL);
+
+	/* So does completing it with a transient error */
+	g_hw_submit_rc = 0;
+	g_hw_complete_status = -ENOMEM;
+	memset(dst, 0, sizeof(dst));
+	status = -1;
+	rc = spdk_accel_submit_copy(g_ch, dst, src, sizeof(src), 0, ut_sequence_complete_cb, &status);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(status == -1);
+	CU_ASSERT(stats->num_fallbacks == 2);
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(memcmp(dst, src, sizeof(src)) == 0);
+	CU_ASSERT(stats->num_completed == 2);
+	CU_ASSERT(stats->bytes == 2 * sizeof(src));
+
+	/* Other errors are reported to the user */
+	g_hw_complete_status = -EIO;
+	status = -1;
+	rc = spdk_accel_submit_copy(g_ch, dst, src, sizeof(src), 0, ut_sequence_complete_cb, &status);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(status == -EIO);
+	CU_ASSERT(stats->num_fallbacks == 2);
+	CU_ASSERT(stats->num_failed == 1);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->task_pool) == &task);
+
+	/* Without the software channel the submission fails and the task is released */
+	g_accel_ch->sw_ch = NULL;
+	g_hw_submit_rc = -EBUSY;
+	rc = spdk_accel_submit_copy(g_ch, dst, src, sizeof(src), 0, ut_sequence_complete_cb, &status);
+	CU_ASSERT(rc == -EBUSY);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->task_pool) == &task);
+	CU_ASSERT(stats->num_submitted == 4);
+	CU_ASSERT(stats->num_failed == 2);
+	CU_ASSERT(stats->num_completed == 2);
+
+	/* Running out of tasks is counted too */
+	TAILQ_INIT(&g_accel_ch->task_pool);
+	rc = spdk_accel_submit_copy(g_ch, dst, src, sizeof(src), 0, ut_sequence_complete_cb, &status);
+	CU_ASSERT(rc == -ENOMEM);
+	CU_ASSERT(g_accel_ch->stats.num_task_exhausted == 1);
+	CU_ASSERT(stats->num_submitted == 4);
+
+	g_hw_submit_rc = 0;
+	g_hw_complete_status = 0;
+	g_engines_opc[ACCEL_OPC_COPY] = &g_accel_module;
+}
+
+static int g_ut_batch_calls;
+static int g_ut_batch_num_tasks;
+
+static int
+ut_batch_submit_batch(struct spdk_io_channel *ch, struct spdk_accel_task *first_task)
+{
+	struct spdk_accel_task *task;
+
+	g_ut_batch_calls++;
+	for (task = first_task; task != NULL; task = TAILQ_NEXT(task, link)) {
+		g_ut_batch_num_tasks++;
+	}
+
+	if (g_hw_submit_rc != 0) {
+		return g_hw_submit_rc;
+	}
+
+	return sw_accel_submit_tasks(ch, first_task);
+}
+
+static struct spdk_accel_module_if g_ut_batch_module = {
+	.name = "ut_batch",
+	.submit_tasks = sw_accel_submit_tasks,
+	.submit_batch = ut_batch_submit_batch,
+};
+
+static void
+test_batch(void)
+{
+	struct spdk_accel_batch batch_obj, *batch;
+	uint8_t src[TEST_SUBMIT_SIZE], dst[3][TEST_SUBMIT_SIZE], expected[TEST_SUBMIT_SIZE];
+	uint32_t crc = 0;
+	int status[4] = { -1, -1, -1, -1 };
+	uint64_t num_fills;
+	int rc;
+
+	ut_sequence_setup();
+	TAILQ_INIT(&g_accel_ch->batch_pool);
+	TAILQ_INSERT_TAIL(&g_accel_ch->batch_pool, &batch_obj, link);
+	g_engines_opc[ACCEL_OPC_FILL] = &g_ut_batch_module;
+	g_ut_batch_calls = 0;
+	g_ut_batch_num_tasks = 0;
+	num_fills = g_accel_ch->stats.opc[ACCEL_OPC_FILL].num_submitted;
+	memset(src, 0x5a, sizeof(src));
+	memset(dst, 0, sizeof(dst));
+
+	batch = spdk_accel_batch_begin(g_ch);
+	CU_ASSERT(batch == &batch_obj);
+	CU_ASSERT(spdk_accel_batch_begin(g_ch) == NULL);
+
+	rc = spdk_accel_batch_append_fill(batch, dst[0], 0xa5, sizeof(dst[0]), 0,
+					  ut_sequence_complete_cb, &status[0]);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_batch_append_copy(batch, dst[1], src, sizeof(src), 0,
+					  ut_sequence_complete_cb, &status[1]);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_batch_append_fill(batch, dst[2], 0xa5, sizeof(dst[2]), 0,
+					  ut_sequence_complete_cb, &status[2]);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_batch_append_crc32c(batch, &crc, src, 0, sizeof(src),
+					    ut_sequence_complete_cb, &status[3]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ut_sequence_num_submitted() == 0);
+
+	/* Both fills are handed to their engine's batch callback at once, the other engine
+	 * gets its tasks through submit_tasks().
+	 */
+	spdk_accel_batch_submit(batch);
+	CU_ASSERT(g_ut_batch_calls == 1);
+	CU_ASSERT(g_ut_batch_num_tasks == 2);
+	CU_ASSERT(ut_sequence_num_submitted() == 4);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->batch_pool) == &batch_obj);
+	CU_ASSERT(g_accel_ch->stats.opc[ACCEL_OPC_FILL].num_submitted == num_fills + 2);
+	CU_ASSERT(status[0] == -1);
+
+	accel_comp_poll(g_sw_ch);
+	CU_ASSERT(status[0] == 0 && status[1] == 0 && status[2] == 0 && status[3] == 0);
+	memset(expected, 0xa5, sizeof(expected));
+	CU_ASSERT(memcmp(dst[0], expected, sizeof(expected)) == 0);
+	CU_ASSERT(memcmp(dst[2], expected, sizeof(expected)) == 0);
+	CU_ASSERT(memcmp(dst[1], src, sizeof(src)) == 0);
+	CU_ASSERT(crc == spdk_crc32c_update(src, sizeof(src), ~0u));
+
+	/* Aborting a batch releases its operations without executing them */
+	batch = spdk_accel_batch_begin(g_ch);
+	SPDK_CU_ASSERT_FATAL(batch != NULL);
+	rc = spdk_accel_batch_append_compare(batch, src, dst[1], sizeof(src),
+					     ut_sequence_complete_cb, &status[0]);
+	CU_ASSERT(rc == 0);
+	rc = spdk_accel_batch_append_copy_crc32c(batch, dst[0], src, &crc, 0, sizeof(src), 0,
+						 ut_sequence_complete_cb, &status[1]);
+	CU_ASSERT(rc == 0);
+	spdk_accel_batch_abort(batch);
+	CU_ASSERT(status[0] == -ECANCELED);
+	CU_ASSERT(status[1] == -ECANCELED);
+	CU_ASSERT(ut_sequence_num_submitted() == 0);
+	CU_ASSERT(TAILQ_FIRST(&g_accel_ch->batch_pool) == &batch_obj);
+
+	/* Submission errors are reported through the callbacks */
+	g_accel_ch->sw_ch = NULL;
+	g_hw_submit_rc = -EBUSY;
+	batch = spdk_accel_batch_begin(g_ch);
+	SPDK_CU_ASSERT_FATAL(batch != NULL);
+	rc = spdk_accel_batch_append_fill(batch, dst[0], 0, sizeof(dst[0]), 0,
+					  ut_sequence_complete_cb, &status[0]);
+	CU_ASSERT(rc == 0);
+	spdk_accel_batch_submit(batch);
+	CU_ASSERT(status[0] == -EBUSY);
+	CU_ASSERT(ut_sequence_num_submitted() == 0);
+
+	g_hw_submit_rc = 0;
+	g_engines_opc[ACCEL_OPC_FILL] = &g_accel_module;
+	ut_sequence_cleanup();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -543,8 +1357,17 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_spdk_accel_submit_crc32c);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_crc32cv);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_copy_crc32c);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_xor);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_pq_gen);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_encrypt_decrypt);
+	CU_ADD_TEST(suite, test_spdk_accel_submit_compress_ext);
 	CU_ADD_TEST(suite, test_spdk_accel_module_find_by_name);
 	CU_ADD_TEST(suite, test_spdk_accel_module_register);
+	CU_ADD_TEST(suite, test_sequence_elide_copy);
+	CU_ADD_TEST(suite, test_sequence_unordered_engine);
+	CU_ADD_TEST(suite, test_sequence_reverse_abort);
+	CU_ADD_TEST(suite, test_sw_fallback_stats);
+	CU_ADD_TEST(suite, test_batch);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
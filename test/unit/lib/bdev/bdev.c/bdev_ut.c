@@ -22,6 +22,24 @@ DEFINE_STUB(spdk_memory_domain_get_dma_device_id, const char *, (struct spdk_mem
 DEFINE_STUB(spdk_memory_domain_get_dma_device_type, enum spdk_dma_device_type,
 	    (struct spdk_memory_domain *domain), 0);
 
+static struct spdk_accel_sequence *g_accel_sequence_finished;
+static struct spdk_accel_sequence *g_accel_sequence_aborted;
+static int g_accel_sequence_status;
+
+void
+spdk_accel_sequence_finish(struct spdk_accel_sequence *seq, spdk_accel_completion_cb cb_fn,
+			   void *cb_arg)
+{
+	g_accel_sequence_finished = seq;
+	cb_fn(cb_arg, g_accel_sequence_status);
+}
+
+void
+spdk_accel_sequence_abort(struct spdk_accel_sequence *seq)
+{
+	g_accel_sequence_aborted = seq;
+}
+
 static bool g_memory_domain_pull_data_called;
 static bool g_memory_domain_push_data_called;
 
@@ -1849,6 +1867,109 @@ bdev_io_boundary_split_test(void)
 	poll_threads();
 }
 
+static void
+bdev_io_write_unit_split_test(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	struct ut_expected_io *expected_io;
+	int rc;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 512;
+	bdev_opts.bdev_io_cache_size = 64;
+
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+
+	/* Write unit which is not a power of 2 and larger than the optimal I/O boundary */
+	bdev->write_unit_size = 12;
+	bdev->split_on_write_unit = true;
+	bdev->optimal_io_boundary = 4;
+	bdev->split_on_optimal_io_boundary = true;
+
+	/* Writes are split on the write unit only.
+	 * Offset 0, length 24, payload 0xF000
+	 *  Child - Offset 0, length 12, payload 0xF000
+	 *  Child - Offset 12, length 12, payload 0xF000 + 12 * 512
+	 */
+	g_io_done = false;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 0, 12, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 12 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 12, 12, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)(0xF000 + 12 * 512), 12 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 0, 24, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_io_done == false);
+
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	stub_complete_io(2);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	/* Write within a single write unit is not split */
+	g_io_done = false;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_WRITE, 12, 12, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 12 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_write_blocks(desc, io_ch, (void *)0xF000, 12, 12, io_done, NULL);
+	CU_ASSERT(rc == 0);
+
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+
+	/* Reads are still split on the optimal I/O boundary.
+	 * Offset 2, length 8, payload 0xF000
+	 *  Child - Offset 2, length 2, payload 0xF000
+	 *  Child - Offset 4, length 4, payload 0xF000 + 2 * 512
+	 *  Child - Offset 8, length 2, payload 0xF000 + 6 * 512
+	 */
+	g_io_done = false;
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_READ, 2, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)0xF000, 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_READ, 4, 4, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)(0xF000 + 2 * 512), 4 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_READ, 8, 2, 1);
+	ut_expected_io_set_iov(expected_io, 0, (void *)(0xF000 + 6 * 512), 2 * 512);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+
+	rc = spdk_bdev_read_blocks(desc, io_ch, (void *)0xF000, 2, 8, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_io_done == false);
+
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 3);
+	stub_complete_io(3);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 bdev_io_max_size_and_segment_split_test(void)
 {
@@ -3274,6 +3395,136 @@ bdev_histograms(void)
 	poll_threads();
 }
 
+static void
+latency_stat_cb(struct spdk_bdev *bdev, struct spdk_bdev_latency_stat *stat, void *cb_arg,
+		int rc)
+{
+	g_status = rc;
+}
+
+static void
+bdev_latency_stat(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *ch;
+	struct spdk_bdev_latency_stat stat = {};
+	struct spdk_bdev_io_latency *latency;
+	uint8_t buf[4096];
+	int rc, i;
+
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	bdev = allocate_bdev("bdev");
+
+	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
+
+	/* Nothing was completed yet */
+	g_status = -1;
+	spdk_bdev_get_device_latency_stat(bdev, &stat, false, latency_stat_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	for (i = 0; i < SPDK_BDEV_NUM_LATENCY_IO_TYPES; i++) {
+		CU_ASSERT(stat.io_type[i].num_ios == 0);
+		CU_ASSERT(stat.io_type[i].histogram == NULL);
+	}
+	spdk_bdev_latency_stat_clear(&stat);
+
+	/* Complete writes taking 10, 20 and 30 ticks and a read taking 100 ticks */
+	for (i = 1; i <= 3; i++) {
+		rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+		spdk_delay_us(10 * i);
+		stub_complete_io(1);
+		poll_threads();
+	}
+
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(100);
+	stub_complete_io(1);
+	poll_threads();
+
+	/* Failed I/O is not accounted */
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(1000);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_FAILED;
+	stub_complete_io(1);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+	poll_threads();
+
+	spdk_bdev_get_device_latency_stat(bdev, &stat, false, latency_stat_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	latency = &stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_WRITE];
+	CU_ASSERT(latency->num_ios == 3);
+	CU_ASSERT(latency->min_ticks == 10);
+	CU_ASSERT(latency->max_ticks == 30);
+	SPDK_CU_ASSERT_FATAL(latency->histogram != NULL);
+	CU_ASSERT(spdk_histogram_data_get_percentile(latency->histogram, 50.0) == 20);
+	CU_ASSERT(spdk_histogram_data_get_percentile(latency->histogram, 99.0) == 30);
+
+	latency = &stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_READ];
+	CU_ASSERT(latency->num_ios == 1);
+	CU_ASSERT(latency->min_ticks == 100);
+	CU_ASSERT(latency->max_ticks == 100);
+	SPDK_CU_ASSERT_FATAL(latency->histogram != NULL);
+	/* 100 falls into a bucket covering 100-103 */
+	CU_ASSERT(spdk_histogram_data_get_percentile(latency->histogram, 99.9) == 103);
+
+	CU_ASSERT(stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_UNMAP].num_ios == 0);
+	spdk_bdev_latency_stat_clear(&stat);
+
+	/* Statistics of a destroyed channel are kept by the bdev */
+	spdk_put_io_channel(ch);
+	poll_threads();
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
+
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	spdk_delay_us(5);
+	stub_complete_io(1);
+	poll_threads();
+
+	spdk_bdev_get_device_latency_stat(bdev, &stat, true, latency_stat_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	latency = &stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_WRITE];
+	CU_ASSERT(latency->num_ios == 4);
+	CU_ASSERT(latency->min_ticks == 5);
+	CU_ASSERT(latency->max_ticks == 30);
+	CU_ASSERT(stat.io_type[SPDK_BDEV_LATENCY_IO_TYPE_READ].num_ios == 1);
+	spdk_bdev_latency_stat_clear(&stat);
+
+	/* The previous query reset the latency statistics but not the I/O counters */
+	spdk_bdev_get_device_latency_stat(bdev, &stat, false, latency_stat_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	for (i = 0; i < SPDK_BDEV_NUM_LATENCY_IO_TYPES; i++) {
+		CU_ASSERT(stat.io_type[i].num_ios == 0);
+		CU_ASSERT(stat.io_type[i].max_ticks == 0);
+		if (stat.io_type[i].histogram != NULL) {
+			CU_ASSERT(spdk_histogram_data_get_percentile(stat.io_type[i].histogram, 50.0) == 0);
+		}
+	}
+	spdk_bdev_latency_stat_clear(&stat);
+
+	spdk_put_io_channel(ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 _bdev_compare(bool emulated)
 {
@@ -4988,6 +5239,126 @@ bdev_set_options_test(void)
 	bdev_opts.large_buf_pool_size = BUF_LARGE_POOL_SIZE + 3;
 	rc = spdk_bdev_set_opts(&bdev_opts);
 	CU_ASSERT(rc == 0);
+
+	/* Case6: Buffer cache must not hold more than half of the pool */
+	bdev_opts.small_buf_cache_size = (BUF_SMALL_POOL_SIZE + 3) / 2 + 1;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == -1);
+
+	bdev_opts.small_buf_cache_size = BUF_SMALL_CACHE_SIZE;
+	bdev_opts.large_buf_cache_size = (BUF_LARGE_POOL_SIZE + 3) / 2 + 1;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == -1);
+
+	bdev_opts.large_buf_cache_size = 0;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+}
+
+static void
+bdev_buf_cache_test(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_mgmt_channel *mgmt_ch;
+	struct spdk_bdev_opts bdev_opts = {}, orig_opts = {};
+	struct spdk_bdev_io_stat stat = {};
+	int rc, i;
+
+	spdk_bdev_get_opts(&orig_opts, sizeof(orig_opts));
+	bdev_opts = orig_opts;
+	bdev_opts.bdev_io_pool_size = SPDK_BDEV_IO_POOL_SIZE;
+	bdev_opts.bdev_io_cache_size = SPDK_BDEV_IO_CACHE_SIZE;
+	bdev_opts.small_buf_pool_size = BUF_SMALL_POOL_SIZE;
+	bdev_opts.large_buf_pool_size = BUF_LARGE_POOL_SIZE;
+	bdev_opts.small_buf_cache_size = 4;
+	bdev_opts.large_buf_cache_size = 2;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	mgmt_ch = bdev_ch->shared_resource->mgmt_ch;
+
+	/* The first buffer refills the cache by a batch of half of the cache size. */
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 1);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE - 2);
+
+	stub_complete_io(1);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 2);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE - 2);
+
+	/* Above the cache size, buffers are returned to the pool by a batch. */
+	for (i = 0; i < 6; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 6);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE - 6);
+
+	stub_complete_io(6);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 4);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE - 4);
+
+	/* Large buffers are cached separately. */
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 128, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(mgmt_ch->buf_large_cache.count == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_large_pool) == BUF_LARGE_POOL_SIZE - 1);
+	stub_complete_io(1);
+	CU_ASSERT(mgmt_ch->buf_large_cache.count == 1);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 4);
+
+	/* Simulate an empty pool. The I/O waits and other threads are asked to release
+	 * their cached buffers.
+	 */
+	bdev_buf_cache_release(&mgmt_ch->buf_small_cache, g_bdev_mgr.buf_small_pool);
+	MOCK_SET(spdk_mempool_get, NULL);
+
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+	CU_ASSERT(!STAILQ_EMPTY(&mgmt_ch->need_buf_small));
+	CU_ASSERT(mgmt_ch->buf_small_cache.rebalancing == true);
+
+	spdk_bdev_get_io_stat(bdev, io_ch, &stat);
+	CU_ASSERT(stat.num_small_buf_waits == 1);
+	CU_ASSERT(stat.num_large_buf_waits == 0);
+
+	/* The waiting I/O gets a buffer when all threads have responded. */
+	MOCK_CLEAR(spdk_mempool_get);
+	poll_threads();
+	CU_ASSERT(mgmt_ch->buf_small_cache.rebalancing == false);
+	CU_ASSERT(mgmt_ch->buf_large_cache.count == 1);
+	CU_ASSERT(STAILQ_EMPTY(&mgmt_ch->need_buf_small));
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+
+	stub_complete_io(1);
+	CU_ASSERT(mgmt_ch->buf_small_cache.count == 1);
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	fn_table.submit_request = stub_submit_request;
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+
+	rc = spdk_bdev_set_opts(&orig_opts);
+	CU_ASSERT(rc == 0);
 }
 
 static uint64_t
@@ -5280,6 +5651,158 @@ bdev_writev_readv_ext(void)
 	poll_threads();
 }
 
+static bool
+stub_accel_sequence_supported(void *ctx, enum spdk_bdev_io_type type)
+{
+	return type == SPDK_BDEV_IO_TYPE_READ || type == SPDK_BDEV_IO_TYPE_WRITE;
+}
+
+static void
+bdev_writev_readv_ext_accel_sequence(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_io *bdev_io;
+	struct spdk_accel_sequence *seq = (struct spdk_accel_sequence *)0xfeedbeef;
+	char io_buf[4096];
+	struct iovec iov = { .iov_base = io_buf, .iov_len = 512 };
+	struct spdk_bdev_ext_io_opts ext_io_opts = {
+		.accel_sequence = seq,
+		.size = sizeof(ext_io_opts)
+	};
+	int rc;
+
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+
+	/* Test 1, bdev doesn't support sequences, so it's executed before the data is written... */
+	g_io_done = false;
+	g_accel_sequence_finished = NULL;
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_accel_sequence_finished == seq);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	CU_ASSERT(bdev_io->u.bdev.ext_opts->accel_sequence == NULL);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* ... and after the data is read */
+	g_io_done = false;
+	g_accel_sequence_finished = NULL;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_accel_sequence_finished == NULL);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	CU_ASSERT(bdev_io->u.bdev.ext_opts->accel_sequence == NULL);
+	stub_complete_io(1);
+	CU_ASSERT(g_accel_sequence_finished == seq);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* Test 2, a failed sequence fails the I/O */
+	g_accel_sequence_status = -EIO;
+	g_io_done = false;
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+
+	g_io_done = false;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	g_accel_sequence_status = 0;
+
+	/* Test 3, the sequence of a failed read is aborted */
+	g_io_done = false;
+	g_accel_sequence_finished = NULL;
+	g_accel_sequence_aborted = NULL;
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_FAILED;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(1);
+	CU_ASSERT(g_accel_sequence_finished == NULL);
+	CU_ASSERT(g_accel_sequence_aborted == seq);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	/* Test 4, sequences require data buffers and can't be used with memory domains */
+	ext_io_opts.memory_domain = (struct spdk_memory_domain *)0xdeadbeef;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == -EINVAL);
+	ext_io_opts.memory_domain = NULL;
+
+	iov.iov_base = NULL;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == -EINVAL);
+	iov.iov_base = io_buf;
+
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+
+	/* Test 5, the sequence is passed to the bdevs supporting it */
+	fn_table.accel_sequence_supported = stub_accel_sequence_supported;
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+
+	g_io_done = false;
+	g_accel_sequence_finished = NULL;
+	rc = spdk_bdev_writev_blocks_ext(desc, io_ch, &iov, 1, 32, 1, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 1);
+	bdev_io = TAILQ_FIRST(&g_bdev_ut_channel->outstanding_io);
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	CU_ASSERT(bdev_io->u.bdev.ext_opts->accel_sequence == seq);
+	stub_complete_io(1);
+	CU_ASSERT(g_accel_sequence_finished == NULL);
+	CU_ASSERT(g_io_done == true);
+
+	/* Test 6, unless the I/O needs to be split */
+	bdev->optimal_io_boundary = 16;
+	bdev->split_on_optimal_io_boundary = true;
+	iov.iov_len = 8 * 512;
+
+	g_io_done = false;
+	rc = spdk_bdev_readv_blocks_ext(desc, io_ch, &iov, 1, 14, 8, io_done, NULL, &ext_io_opts);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 2);
+	TAILQ_FOREACH(bdev_io, &g_bdev_ut_channel->outstanding_io, module_link) {
+		CU_ASSERT(bdev_io->u.bdev.ext_opts->accel_sequence == NULL);
+	}
+	stub_complete_io(2);
+	CU_ASSERT(g_accel_sequence_finished == seq);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+
+	fn_table.accel_sequence_supported = NULL;
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 bdev_register_uuid_alias(void)
 {
@@ -5463,12 +5986,14 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_io_wait_test);
 	CU_ADD_TEST(suite, bdev_io_spans_split_test);
 	CU_ADD_TEST(suite, bdev_io_boundary_split_test);
+	CU_ADD_TEST(suite, bdev_io_write_unit_split_test);
 	CU_ADD_TEST(suite, bdev_io_max_size_and_segment_split_test);
 	CU_ADD_TEST(suite, bdev_io_mix_split_test);
 	CU_ADD_TEST(suite, bdev_io_split_with_io_wait);
 	CU_ADD_TEST(suite, bdev_io_alignment_with_boundary);
 	CU_ADD_TEST(suite, bdev_io_alignment);
 	CU_ADD_TEST(suite, bdev_histograms);
+	CU_ADD_TEST(suite, bdev_latency_stat);
 	CU_ADD_TEST(suite, bdev_write_zeroes);
 	CU_ADD_TEST(suite, bdev_compare_and_write);
 	CU_ADD_TEST(suite, bdev_compare);
@@ -5488,9 +6013,11 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_unmap);
 	CU_ADD_TEST(suite, bdev_write_zeroes_split_test);
 	CU_ADD_TEST(suite, bdev_set_options_test);
+	CU_ADD_TEST(suite, bdev_buf_cache_test);
 	CU_ADD_TEST(suite, bdev_multi_allocation);
 	CU_ADD_TEST(suite, bdev_get_memory_domains);
 	CU_ADD_TEST(suite, bdev_writev_readv_ext);
+	CU_ADD_TEST(suite, bdev_writev_readv_ext_accel_sequence);
 	CU_ADD_TEST(suite, bdev_register_uuid_alias);
 	CU_ADD_TEST(suite, bdev_unregister_by_name);
 	CU_ADD_TEST(suite, for_each_bdev_test);
@@ -286,6 +286,52 @@ DEFINE_STUB_V(spdk_reduce_vol_init, (struct spdk_reduce_vol_params *params,
 DEFINE_STUB_V(spdk_reduce_vol_destroy, (struct spdk_reduce_backing_dev *backing_dev,
 					spdk_reduce_vol_op_complete cb_fn, void *cb_arg));
 
+/* accel stubs */
+DEFINE_STUB(spdk_accel_engine_get_io_channel, struct spdk_io_channel *, (void),
+	    (struct spdk_io_channel *)0xfeedbeef);
+DEFINE_STUB(spdk_accel_comp_algo_supported, bool, (enum spdk_accel_comp_algo algo), true);
+
+static int ut_accel_submit_rc = 0;
+static enum spdk_accel_comp_algo ut_accel_algo;
+static uint32_t *ut_accel_output_size;
+static spdk_accel_completion_cb ut_accel_cb_fn;
+static void *ut_accel_cb_arg;
+
+static int
+ut_accel_submit(uint32_t *output_size, const struct spdk_accel_comp_opts *opts,
+		spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	if (ut_accel_submit_rc != 0) {
+		return ut_accel_submit_rc;
+	}
+
+	ut_accel_algo = opts->algo;
+	ut_accel_output_size = output_size;
+	ut_accel_cb_fn = cb_fn;
+	ut_accel_cb_arg = cb_arg;
+	return 0;
+}
+
+int
+spdk_accel_submit_compress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+			       uint32_t dst_iovcnt, struct iovec *src_iovs,
+			       uint32_t src_iovcnt, uint32_t *output_size,
+			       const struct spdk_accel_comp_opts *opts, int flags,
+			       spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	return ut_accel_submit(output_size, opts, cb_fn, cb_arg);
+}
+
+int
+spdk_accel_submit_decompress_ext(struct spdk_io_channel *ch, struct iovec *dst_iovs,
+				 uint32_t dst_iovcnt, struct iovec *src_iovs,
+				 uint32_t src_iovcnt, uint32_t *output_size,
+				 const struct spdk_accel_comp_opts *opts, int flags,
+				 spdk_accel_completion_cb cb_fn, void *cb_arg)
+{
+	return ut_accel_submit(output_size, opts, cb_fn, cb_arg);
+}
+
 /* DPDK stubs */
 #define DPDK_DYNFIELD_OFFSET offsetof(struct rte_mbuf, dynfield1[1])
 DEFINE_STUB(rte_mbuf_dynfield_register, int, (const struct rte_mbuf_dynfield *params),
@@ -1149,6 +1195,76 @@ test_supported_io(void)
 
 }
 
+static void
+_ut_accel_reduce_done(void *arg, int reduce_errno)
+{
+	*(int *)arg = reduce_errno;
+}
+
+static void
+test_compress_operation_accel(void)
+{
+	struct iovec src_iovs[2] = {};
+	struct iovec dst_iovs[2] = {};
+	struct spdk_reduce_vol_cb_args cb_arg;
+	struct vbdev_comp_accel_op *op;
+	int reduce_rc = 0;
+	int rc;
+
+	g_comp_bdev.accel_ch = (struct spdk_io_channel *)0xfeedbeef;
+	g_comp_bdev.params.comp_algo = SPDK_ACCEL_COMP_ALGO_ZSTD;
+	TAILQ_INIT(&g_comp_bdev.free_accel_ops);
+	cb_arg.cb_fn = _ut_accel_reduce_done;
+	cb_arg.cb_arg = &reduce_rc;
+
+	/* A successful compress reports the produced size to reduce. */
+	ut_accel_cb_fn = NULL;
+	rc = _compress_operation(&g_comp_bdev.backing_dev, src_iovs, 2, dst_iovs, 2, true, &cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(ut_accel_algo == SPDK_ACCEL_COMP_ALGO_ZSTD);
+	SPDK_CU_ASSERT_FATAL(ut_accel_cb_fn != NULL);
+	*ut_accel_output_size = 0x800;
+	ut_accel_cb_fn(ut_accel_cb_arg, 0);
+	CU_ASSERT(reduce_rc == 0x800);
+	CU_ASSERT(!TAILQ_EMPTY(&g_comp_bdev.free_accel_ops));
+
+	/* Incompressible data is handed back as an error so reduce stores it as is. */
+	ut_accel_cb_fn = NULL;
+	rc = _compress_operation(&g_comp_bdev.backing_dev, src_iovs, 2, dst_iovs, 2, true, &cb_arg);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(ut_accel_cb_fn != NULL);
+	ut_accel_cb_fn(ut_accel_cb_arg, -ENOSPC);
+	CU_ASSERT(reduce_rc == -ENOSPC);
+
+	/* Running out of accel tasks queues the op until the next completion. */
+	ut_accel_submit_rc = -ENOMEM;
+	rc = _compress_operation(&g_comp_bdev.backing_dev, src_iovs, 2, dst_iovs, 2, false, &cb_arg);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_comp_bdev.queued_comp_ops) == false);
+	ut_accel_submit_rc = 0;
+	ut_accel_cb_fn = NULL;
+	_comp_resubmit_queued_op(&g_comp_bdev);
+	CU_ASSERT(TAILQ_EMPTY(&g_comp_bdev.queued_comp_ops) == true);
+	SPDK_CU_ASSERT_FATAL(ut_accel_cb_fn != NULL);
+	*ut_accel_output_size = 0x4000;
+	ut_accel_cb_fn(ut_accel_cb_arg, 0);
+	CU_ASSERT(reduce_rc == 0x4000);
+
+	/* Any other submission error goes straight back to reduce. */
+	ut_accel_submit_rc = -EINVAL;
+	rc = _compress_operation(&g_comp_bdev.backing_dev, src_iovs, 2, dst_iovs, 2, true, &cb_arg);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(TAILQ_EMPTY(&g_comp_bdev.queued_comp_ops) == true);
+	ut_accel_submit_rc = 0;
+
+	while ((op = TAILQ_FIRST(&g_comp_bdev.free_accel_ops))) {
+		TAILQ_REMOVE(&g_comp_bdev.free_accel_ops, op, link);
+		free(op);
+	}
+	g_comp_bdev.params.comp_algo = SPDK_ACCEL_COMP_ALGO_DEFLATE;
+	g_comp_bdev.accel_ch = NULL;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1161,6 +1277,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("compress", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_compress_operation);
 	CU_ADD_TEST(suite, test_compress_operation_cross_boundary);
+	CU_ADD_TEST(suite, test_compress_operation_accel);
 	CU_ADD_TEST(suite, test_vbdev_compress_submit_request);
 	CU_ADD_TEST(suite, test_passthru);
 	CU_ADD_TEST(suite, test_initdrivers);
@@ -241,6 +241,21 @@ DEFINE_STUB(spdk_bdev_module_claim_bdev, int, (struct spdk_bdev *bdev, struct sp
 DEFINE_STUB_V(spdk_bdev_module_examine_done, (struct spdk_bdev_module *module));
 DEFINE_STUB(spdk_bdev_register, int, (struct spdk_bdev *vbdev), 0);
 
+/* accel stubs */
+DEFINE_STUB(spdk_accel_crypto_key_create, int,
+	    (const struct spdk_accel_crypto_key_create_param *param,
+	     struct spdk_accel_crypto_key **key), 0);
+DEFINE_STUB_V(spdk_accel_crypto_key_destroy, (struct spdk_accel_crypto_key *key));
+DEFINE_STUB(spdk_accel_engine_get_io_channel, struct spdk_io_channel *, (void), NULL);
+DEFINE_STUB(spdk_accel_submit_encrypt, int, (struct spdk_io_channel *ch,
+		struct spdk_accel_crypto_key *key, struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		struct iovec *src_iovs, uint32_t src_iovcnt, uint64_t iv, uint32_t block_size,
+		int flags, spdk_accel_completion_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_accel_submit_decrypt, int, (struct spdk_io_channel *ch,
+		struct spdk_accel_crypto_key *key, struct iovec *dst_iovs, uint32_t dst_iovcnt,
+		struct iovec *src_iovs, uint32_t src_iovcnt, uint64_t iv, uint32_t block_size,
+		int flags, spdk_accel_completion_cb cb_fn, void *cb_arg), 0);
+
 /* DPDK stubs */
 #define DPDK_DYNFIELD_OFFSET offsetof(struct rte_mbuf, dynfield1[1])
 DEFINE_STUB(rte_mbuf_dynfield_register, int, (const struct rte_mbuf_dynfield *params),
@@ -24,6 +24,9 @@ DEFINE_STUB(spdk_memory_domain_get_dma_device_id, const char *, (struct spdk_mem
 	    "test_domain");
 DEFINE_STUB(spdk_memory_domain_get_dma_device_type, enum spdk_dma_device_type,
 	    (struct spdk_memory_domain *domain), 0);
+DEFINE_STUB_V(spdk_accel_sequence_finish, (struct spdk_accel_sequence *seq,
+		spdk_accel_completion_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(spdk_accel_sequence_abort, (struct spdk_accel_sequence *seq));
 
 DEFINE_RETURN_MOCK(spdk_memory_domain_pull_data, int);
 int
@@ -2076,6 +2079,84 @@ unregister_during_reset(void)
 	teardown_test();
 }
 
+static void
+buf_cache_rebalance(void)
+{
+	struct spdk_io_channel *io_ch0, *io_ch1;
+	struct spdk_bdev_mgmt_channel *mgmt_ch0, *mgmt_ch1;
+	struct spdk_bdev_channel *bdev_ch;
+	void *buf;
+
+	setup_test();
+
+	set_thread(0);
+	io_ch0 = spdk_bdev_get_io_channel(g_desc);
+	SPDK_CU_ASSERT_FATAL(io_ch0 != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch0);
+	mgmt_ch0 = bdev_ch->shared_resource->mgmt_ch;
+
+	set_thread(1);
+	io_ch1 = spdk_bdev_get_io_channel(g_desc);
+	SPDK_CU_ASSERT_FATAL(io_ch1 != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch1);
+	mgmt_ch1 = bdev_ch->shared_resource->mgmt_ch;
+	CU_ASSERT(mgmt_ch0 != mgmt_ch1);
+
+	/* Fill the buffer cache of thread 1. */
+	buf = bdev_buf_cache_get(&mgmt_ch1->buf_small_cache, g_bdev_mgr.buf_small_pool);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	bdev_buf_cache_put(&mgmt_ch1->buf_small_cache, g_bdev_mgr.buf_small_pool, buf);
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == BUF_CACHE_BATCH_SIZE);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) ==
+		  BUF_SMALL_POOL_SIZE - BUF_CACHE_BATCH_SIZE);
+
+	/* Thread 0 is starved and asks thread 1 to release its cached buffers. */
+	set_thread(0);
+	bdev_mgmt_channel_rebalance_bufs(mgmt_ch0, false);
+	CU_ASSERT(mgmt_ch0->buf_small_cache.rebalancing == true);
+
+	/* The cache is released only by thread 1 itself. */
+	poll_thread(0);
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == BUF_CACHE_BATCH_SIZE);
+
+	poll_threads();
+	CU_ASSERT(mgmt_ch0->buf_small_cache.rebalancing == false);
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE);
+
+	/* Refill the buffer cache of thread 1. */
+	set_thread(1);
+	buf = bdev_buf_cache_get(&mgmt_ch1->buf_small_cache, g_bdev_mgr.buf_small_pool);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	bdev_buf_cache_put(&mgmt_ch1->buf_small_cache, g_bdev_mgr.buf_small_pool, buf);
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == BUF_CACHE_BATCH_SIZE);
+
+	/* A second rebalance within the interval is deferred until the interval elapses. */
+	set_thread(0);
+	bdev_mgmt_channel_rebalance_bufs(mgmt_ch0, false);
+	CU_ASSERT(mgmt_ch0->buf_small_cache.rebalancing == false);
+	CU_ASSERT(mgmt_ch0->buf_small_cache.rebalance_pending == true);
+	CU_ASSERT(mgmt_ch0->buf_rebalance_poller != NULL);
+
+	poll_threads();
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == BUF_CACHE_BATCH_SIZE);
+
+	spdk_delay_us(BUF_CACHE_REBALANCE_INTERVAL_USEC);
+	poll_threads();
+	CU_ASSERT(mgmt_ch0->buf_small_cache.rebalance_pending == false);
+	CU_ASSERT(mgmt_ch0->buf_rebalance_poller == NULL);
+	CU_ASSERT(mgmt_ch1->buf_small_cache.count == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == BUF_SMALL_POOL_SIZE);
+
+	set_thread(1);
+	spdk_put_io_channel(io_ch1);
+	set_thread(0);
+	spdk_put_io_channel(io_ch0);
+	poll_threads();
+
+	teardown_test();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -2104,6 +2185,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_set_io_timeout_mt);
 	CU_ADD_TEST(suite, lock_lba_range_then_submit_io);
 	CU_ADD_TEST(suite, unregister_during_reset);
+	CU_ADD_TEST(suite, buf_cache_rebalance);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -3523,6 +3523,7 @@ test_add_multi_io_paths_to_nbdev_ch(void)
 	struct spdk_io_channel *ch;
 	struct nvme_bdev_channel *nbdev_ch;
 	struct nvme_io_path *io_path1, *io_path2, *io_path3;
+	struct nvme_bdev_io bio = {};
 	struct spdk_uuid uuid1 = { .u.raw = { 0x1 } };
 	int rc;
 
@@ -3622,7 +3623,11 @@ test_add_multi_io_paths_to_nbdev_ch(void)
 	io_path3 = _bdev_nvme_get_io_path(nbdev_ch, nvme_ns3);
 	SPDK_CU_ASSERT_FATAL(io_path3 != NULL);
 
-	/* Check if I/O path is dynamically deleted from nvme_bdev_channel. */
+	/* Check if I/O path is dynamically deleted from nvme_bdev_channel, but is kept
+	 * until the I/O outstanding on it completes. */
+	bio.io_path = io_path2;
+	nvme_io_path_start_io(&bio);
+
 	rc = bdev_nvme_delete("nvme0", &path2);
 	CU_ASSERT(rc == 0);
 
@@ -3638,6 +3643,14 @@ test_add_multi_io_paths_to_nbdev_ch(void)
 	CU_ASSERT(_bdev_nvme_get_io_path(nbdev_ch, nvme_ns2) == NULL);
 	CU_ASSERT(_bdev_nvme_get_io_path(nbdev_ch, nvme_ns3) == io_path3);
 
+	CU_ASSERT(io_path2->deleted == true);
+	CU_ASSERT(io_path2->num_outstanding_io == 1);
+	CU_ASSERT(bio.io_path == io_path2);
+
+	/* The completion frees the path and detaches the I/O from it */
+	nvme_io_path_end_io(&bio);
+	CU_ASSERT(bio.io_path == NULL);
+
 	set_thread(0);
 
 	spdk_put_io_channel(ch);
@@ -6191,6 +6204,102 @@ test_find_next_io_path(void)
 	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
 }
 
+static void
+test_find_least_loaded_io_path(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {}, qpair3 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {}, ctrlr3 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr nvme_ctrlr3 = { .ctrlr = &ctrlr3, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_ctrlr_channel ctrlr_ch3 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_qpair nvme_qpair3 = { .ctrlr_ch = &ctrlr_ch3, .ctrlr = &nvme_ctrlr3, .qpair = &qpair3, };
+	struct nvme_ns nvme_ns1 = {}, nvme_ns2 = {}, nvme_ns3 = {};
+	struct nvme_io_path io_path1 = { .qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, };
+	struct nvme_io_path io_path2 = { .qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, };
+	struct nvme_io_path io_path3 = { .qpair = &nvme_qpair3, .nvme_ns = &nvme_ns3, };
+	struct nvme_bdev_io bio = {};
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path3, stailq);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	/* Ties are broken in round-robin order starting next to the current path. */
+	nbdev_ch.current_io_path = &io_path1;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path3);
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* The path with the fewest outstanding I/Os is selected. */
+	io_path1.num_outstanding_io = 4;
+	io_path2.num_outstanding_io = 2;
+	io_path3.num_outstanding_io = 3;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	CU_ASSERT(nbdev_ch.current_io_path == &io_path2);
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* Optimized paths are preferred even if non-optimized paths are less loaded. */
+	nvme_ns2.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path3);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* The min_latency selector weights outstanding I/Os by the latency average. */
+	nbdev_ch.mp_selector = BDEV_NVME_MP_SELECTOR_MIN_LATENCY;
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns3.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	io_path1.num_outstanding_io = 1;
+	io_path1.io_latency_ewma_ticks = 100;
+	io_path2.num_outstanding_io = 0;
+	io_path2.io_latency_ewma_ticks = 300;
+	io_path3.num_outstanding_io = 3;
+	io_path3.io_latency_ewma_ticks = 10;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path3);
+
+	io_path3.io_latency_ewma_ticks = 100;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* Completion updates the outstanding I/O count and the latency average. */
+	io_path1.num_outstanding_io = 0;
+	io_path1.io_latency_ewma_ticks = 0;
+	bio.io_path = &io_path1;
+
+	nvme_io_path_start_io(&bio);
+	CU_ASSERT(io_path1.num_outstanding_io == 1);
+	spdk_delay_us(80);
+	nvme_io_path_end_io(&bio);
+	CU_ASSERT(io_path1.num_outstanding_io == 0);
+	CU_ASSERT(io_path1.io_latency_ewma_ticks == 80);
+	CU_ASSERT(bio.submit_tsc == 0);
+
+	io_path1.io_latency_ewma_ticks = 800;
+	nvme_io_path_start_io(&bio);
+	spdk_delay_us(1600);
+	nvme_io_path_end_io(&bio);
+	CU_ASSERT(io_path1.io_latency_ewma_ticks == 800 - 100 + 200);
+
+	/* Completion of an I/O which was not counted does not change anything. */
+	nvme_io_path_end_io(&bio);
+	CU_ASSERT(io_path1.num_outstanding_io == 0);
+	CU_ASSERT(io_path1.io_latency_ewma_ticks == 900);
+}
+
 static void
 test_disable_auto_failback(void)
 {
@@ -6389,6 +6498,7 @@ main(int argc, const char **argv)
 	CU_ADD_TEST(suite, test_ana_transition);
 	CU_ADD_TEST(suite, test_set_preferred_path);
 	CU_ADD_TEST(suite, test_find_next_io_path);
+	CU_ADD_TEST(suite, test_find_least_loaded_io_path);
 	CU_ADD_TEST(suite, test_disable_auto_failback);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
@@ -123,6 +123,12 @@ spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
 	return &g_io_channel;
 }
 
+const struct spdk_uuid *
+spdk_bdev_get_uuid(const struct spdk_bdev *bdev)
+{
+	return &bdev->uuid;
+}
+
 static void
 set_test_opts(void)
 {
@@ -1301,6 +1307,19 @@ test_io_channel(void)
 	}
 	raid_bdev_destroy_cb(pbdev, ch_ctx);
 	CU_ASSERT(ch_ctx->base_channel == NULL);
+
+	/* A base bdev being removed is skipped even though it's still open */
+	pbdev->base_bdev_info[0].removed = true;
+	CU_ASSERT(raid_bdev_create_cb(pbdev, ch_ctx) == 0);
+	SPDK_CU_ASSERT_FATAL(ch_ctx->base_channel != NULL);
+	CU_ASSERT(pbdev->base_bdev_info[0].desc != NULL);
+	CU_ASSERT(ch_ctx->base_channel[0] == NULL);
+	for (i = 1; i < req.base_bdevs.num_base_bdevs; i++) {
+		CU_ASSERT(ch_ctx->base_channel[i] == &g_io_channel);
+	}
+	raid_bdev_destroy_cb(pbdev, ch_ctx);
+	CU_ASSERT(ch_ctx->base_channel == NULL);
+	pbdev->base_bdev_info[0].removed = false;
 	free_test_req(&req);
 
 	create_raid_bdev_delete_req(&destroy_req, "raid1", 0);
@@ -2037,6 +2056,8 @@ test_raid_level_conversions(void)
 	CU_ASSERT(raid_bdev_parse_raid_level("0") == RAID0);
 	CU_ASSERT(raid_bdev_parse_raid_level("raid0") == RAID0);
 	CU_ASSERT(raid_bdev_parse_raid_level("RAID0") == RAID0);
+	CU_ASSERT(raid_bdev_parse_raid_level("1") == RAID1);
+	CU_ASSERT(raid_bdev_parse_raid_level("raid1") == RAID1);
 
 	raid_str = raid_bdev_level_to_str(INVALID_RAID_LEVEL);
 	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
@@ -2044,6 +2065,8 @@ test_raid_level_conversions(void)
 	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
 	raid_str = raid_bdev_level_to_str(RAID0);
 	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid0") == 0);
+	raid_str = raid_bdev_level_to_str(RAID1);
+	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid1") == 0);
 }
 
 int
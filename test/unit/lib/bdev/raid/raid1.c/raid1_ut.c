@@ -0,0 +1,722 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid1.c"
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+					struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 64);
+DEFINE_STUB(spdk_bdev_unmap_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
+		void *cb_arg), 0);
+
+static enum spdk_bdev_io_status g_io_status;
+static uint32_t g_io_completions;
+static int g_resync_status;
+static bool g_resync_done;
+
+void
+raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	g_io_completions++;
+	g_io_status = status;
+}
+
+bool
+raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed,
+			   enum spdk_bdev_io_status status)
+{
+	SPDK_CU_ASSERT_FATAL(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_io->base_bdev_io_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_bdev_io_complete(raid_io, raid_io->base_bdev_io_status);
+		return true;
+	}
+
+	return false;
+}
+
+void
+raid_bdev_resync_base_bdev_done(struct raid_bdev *raid_bdev,
+				struct raid_base_bdev_info *base_info, int status)
+{
+	CU_ASSERT(g_resync_done == false);
+	CU_ASSERT(base_info->resyncing == true);
+	base_info->resyncing = false;
+	g_resync_done = true;
+	g_resync_status = status;
+}
+
+/* Memory backed base bdev */
+struct test_base_bdev {
+	void *buf;
+	size_t size;
+	uint32_t blocklen;
+	uint32_t reads;
+	uint32_t writes;
+};
+
+struct test_base_io {
+	struct spdk_bdev_io bdev_io;
+	struct test_base_bdev *base;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+	TAILQ_ENTRY(test_base_io) link;
+};
+
+static TAILQ_HEAD(, test_base_io) g_pending_base_ios = TAILQ_HEAD_INITIALIZER(g_pending_base_ios);
+
+static int
+test_base_rw(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt,
+	     uint64_t offset_blocks, uint64_t num_blocks, bool write,
+	     spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = (struct test_base_bdev *)desc;
+	size_t offset = offset_blocks * base->blocklen;
+	size_t len = num_blocks * base->blocklen;
+	struct test_base_io *io;
+	int i;
+
+	SPDK_CU_ASSERT_FATAL(offset + len <= base->size);
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->base = base;
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+
+	for (i = 0; i < iovcnt; i++) {
+		CU_ASSERT(iov[i].iov_len <= len);
+		if (write) {
+			memcpy(base->buf + offset, iov[i].iov_base, iov[i].iov_len);
+		} else {
+			memcpy(iov[i].iov_base, base->buf + offset, iov[i].iov_len);
+		}
+		offset += iov[i].iov_len;
+		len -= iov[i].iov_len;
+	}
+	CU_ASSERT(len == 0);
+
+	if (write) {
+		base->writes++;
+	} else {
+		base->reads++;
+	}
+
+	TAILQ_INSERT_TAIL(&g_pending_base_ios, io, link);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			    spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	return test_base_rw(desc, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			   spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	return test_base_rw(desc, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+int
+spdk_bdev_write_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = (struct test_base_bdev *)desc;
+	struct iovec iov = { .iov_base = buf, .iov_len = num_blocks * base->blocklen };
+
+	return test_base_rw(desc, &iov, 1, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = (struct test_base_bdev *)desc;
+	struct iovec iov = { .iov_base = buf, .iov_len = num_blocks * base->blocklen };
+
+	return test_base_rw(desc, &iov, 1, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+struct spdk_io_channel *
+spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
+{
+	/* The test base bdevs are registered as io devices */
+	return spdk_get_io_channel(desc);
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(SPDK_CONTAINEROF(bdev_io, struct test_base_io, bdev_io));
+}
+
+/* Complete the pending base bdev IOs, only the ones of the given base bdev if not NULL */
+static void
+complete_base_ios(struct test_base_bdev *base)
+{
+	struct test_base_io *io;
+	bool completed;
+
+	/* Completions may submit new IOs, repeat until there's nothing left to complete */
+	do {
+		completed = false;
+		TAILQ_FOREACH(io, &g_pending_base_ios, link) {
+			if (base == NULL || io->base == base) {
+				TAILQ_REMOVE(&g_pending_base_ios, io, link);
+				io->cb(&io->bdev_io, true, io->cb_arg);
+				completed = true;
+				break;
+			}
+		}
+	} while (completed);
+}
+
+#define TEST_BLOCKLEN 512
+#define TEST_REGION_BLOCKS (RAID1_REGION_SIZE_KB * 1024 / TEST_BLOCKLEN)
+#define TEST_BLOCKCNT (TEST_REGION_BLOCKS * 4 + 16)
+
+struct raid_io_info {
+	struct raid1_info *r1info;
+	struct raid_bdev_io_channel raid_ch;
+	struct test_base_bdev *base_bdevs;
+};
+
+static int
+test_setup(void)
+{
+	allocate_threads(1);
+	set_thread(0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	free_threads();
+
+	return 0;
+}
+
+static struct raid_bdev *
+create_raid_bdev(uint8_t num_base_bdevs, uint64_t *blockcnts)
+{
+	struct raid_bdev *raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	uint8_t i = 0;
+
+	raid_bdev = calloc(1, sizeof(*raid_bdev));
+	SPDK_CU_ASSERT_FATAL(raid_bdev != NULL);
+
+	raid_bdev->module = &g_raid1_module;
+	raid_bdev->num_base_bdevs = num_base_bdevs;
+	raid_bdev->base_bdev_info = calloc(raid_bdev->num_base_bdevs,
+					   sizeof(struct raid_base_bdev_info));
+	SPDK_CU_ASSERT_FATAL(raid_bdev->base_bdev_info != NULL);
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		base_info->bdev = calloc(1, sizeof(*base_info->bdev));
+		SPDK_CU_ASSERT_FATAL(base_info->bdev != NULL);
+
+		base_info->bdev->blockcnt = blockcnts[i++];
+		base_info->bdev->blocklen = TEST_BLOCKLEN;
+	}
+
+	raid_bdev->bdev.name = "raid1";
+	raid_bdev->bdev.blocklen = TEST_BLOCKLEN;
+	raid_bdev->blocklen_shift = spdk_u32log2(TEST_BLOCKLEN);
+
+	return raid_bdev;
+}
+
+static void
+delete_raid_bdev(struct raid_bdev *raid_bdev)
+{
+	struct raid_base_bdev_info *base_info;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		free(base_info->bdev);
+	}
+	free(raid_bdev->base_bdev_info);
+	free(raid_bdev);
+}
+
+static struct raid1_info *
+create_raid1(uint8_t num_base_bdevs, uint64_t *blockcnts)
+{
+	struct raid_bdev *raid_bdev = create_raid_bdev(num_base_bdevs, blockcnts);
+
+	SPDK_CU_ASSERT_FATAL(raid1_start(raid_bdev) == 0);
+
+	return raid_bdev->module_private;
+}
+
+static void
+delete_raid1(struct raid1_info *r1info)
+{
+	struct raid_bdev *raid_bdev = r1info->raid_bdev;
+
+	raid1_stop(raid_bdev);
+	poll_threads();
+
+	delete_raid_bdev(raid_bdev);
+}
+
+static void
+test_raid1_start(void)
+{
+	uint64_t blockcnts[] = { TEST_BLOCKCNT + 100, TEST_BLOCKCNT, TEST_BLOCKCNT + 1 };
+	struct raid1_info *r1info;
+	uint8_t i;
+
+	r1info = create_raid1(SPDK_COUNTOF(blockcnts), blockcnts);
+
+	CU_ASSERT_EQUAL(r1info->raid_bdev->bdev.blockcnt, TEST_BLOCKCNT);
+	CU_ASSERT_EQUAL(raid1_region_blocks(r1info), TEST_REGION_BLOCKS);
+	CU_ASSERT_EQUAL(r1info->num_regions, 5);
+	for (i = 0; i < SPDK_COUNTOF(blockcnts); i++) {
+		CU_ASSERT(raid1_find_dirty_region(r1info, i, 0) == RAID1_REGION_NONE);
+		CU_ASSERT(r1info->resync_region[i] == RAID1_REGION_NONE);
+	}
+
+	delete_raid1(r1info);
+}
+
+static void
+init_io_info(struct raid_io_info *io_info, uint8_t num_base_bdevs)
+{
+	uint64_t blockcnts[num_base_bdevs];
+	struct raid_bdev *raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	struct test_base_bdev *base;
+	uint8_t i;
+
+	for (i = 0; i < num_base_bdevs; i++) {
+		blockcnts[i] = TEST_BLOCKCNT;
+	}
+
+	memset(io_info, 0, sizeof(*io_info));
+	io_info->r1info = create_raid1(num_base_bdevs, blockcnts);
+	raid_bdev = io_info->r1info->raid_bdev;
+
+	io_info->base_bdevs = calloc(num_base_bdevs, sizeof(*io_info->base_bdevs));
+	SPDK_CU_ASSERT_FATAL(io_info->base_bdevs != NULL);
+
+	io_info->raid_ch.num_channels = num_base_bdevs;
+	io_info->raid_ch.base_channel = calloc(num_base_bdevs, sizeof(struct spdk_io_channel *));
+	SPDK_CU_ASSERT_FATAL(io_info->raid_ch.base_channel != NULL);
+
+	i = 0;
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		base = &io_info->base_bdevs[i];
+		base->blocklen = TEST_BLOCKLEN;
+		base->size = TEST_BLOCKCNT * TEST_BLOCKLEN;
+		base->buf = calloc(1, base->size);
+		SPDK_CU_ASSERT_FATAL(base->buf != NULL);
+		spdk_io_device_register(base, raid1_ioch_create, raid1_ioch_destroy, 0, NULL);
+
+		base_info->desc = (struct spdk_bdev_desc *)base;
+		/* Any non-NULL value, the channel is only passed to the stubs */
+		io_info->raid_ch.base_channel[i] = (struct spdk_io_channel *)base;
+		i++;
+	}
+
+	io_info->raid_ch.module_channel = raid1_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(io_info->raid_ch.module_channel != NULL);
+}
+
+static void
+deinit_io_info(struct raid_io_info *io_info)
+{
+	struct raid_bdev *raid_bdev = io_info->r1info->raid_bdev;
+	uint8_t i;
+
+	CU_ASSERT(TAILQ_EMPTY(&g_pending_base_ios));
+
+	spdk_put_io_channel(io_info->raid_ch.module_channel);
+	poll_threads();
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		spdk_io_device_unregister(&io_info->base_bdevs[i], NULL);
+		free(io_info->base_bdevs[i].buf);
+	}
+	poll_threads();
+	free(io_info->base_bdevs);
+	free(io_info->raid_ch.base_channel);
+
+	delete_raid1(io_info->r1info);
+}
+
+static struct spdk_bdev_io *
+start_io(struct raid_io_info *io_info, enum spdk_bdev_io_type type, struct iovec *iov,
+	 uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct raid_bdev *raid_bdev = io_info->r1info->raid_bdev;
+	struct spdk_bdev_io *bdev_io;
+	struct raid_bdev_io *raid_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(*raid_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+
+	bdev_io->bdev = &raid_bdev->bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = iov;
+	bdev_io->u.bdev.iovcnt = 1;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	raid_io = (struct raid_bdev_io *)bdev_io->driver_ctx;
+	raid_io->raid_bdev = raid_bdev;
+	raid_io->raid_ch = &io_info->raid_ch;
+	raid_io->base_bdev_io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	raid1_submit_rw_request(raid_io);
+
+	return bdev_io;
+}
+
+static enum spdk_bdev_io_status
+submit_io(struct raid_io_info *io_info, enum spdk_bdev_io_type type, void *buf,
+	  uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct spdk_bdev_io *bdev_io;
+	struct iovec iov = { .iov_base = buf, .iov_len = num_blocks * TEST_BLOCKLEN };
+
+	g_io_completions = 0;
+	bdev_io = start_io(io_info, type, &iov, offset_blocks, num_blocks);
+	complete_base_ios(NULL);
+	CU_ASSERT(g_io_completions == 1);
+
+	free(bdev_io);
+
+	return g_io_status;
+}
+
+static void
+fill_buf(void *buf, size_t len, uint64_t seed)
+{
+	uint8_t *b = buf;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		b[i] = (uint8_t)(seed * 31 + i * 7 + (i >> 8));
+	}
+}
+
+static void
+test_raid1_write(void)
+{
+	struct raid_io_info io_info;
+	uint64_t offset_blocks = TEST_REGION_BLOCKS - 8;
+	uint64_t num_blocks = 24;
+	size_t len = num_blocks * TEST_BLOCKLEN;
+	void *buf;
+	uint8_t i;
+
+	init_io_info(&io_info, 3);
+
+	buf = malloc(len);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	fill_buf(buf, len, 1);
+
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_WRITE, buf, offset_blocks, num_blocks) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(io_info.base_bdevs[i].writes == 1);
+		CU_ASSERT(memcmp(io_info.base_bdevs[i].buf + offset_blocks * TEST_BLOCKLEN, buf, len) == 0);
+		CU_ASSERT(raid1_find_dirty_region(io_info.r1info, i, 0) == RAID1_REGION_NONE);
+	}
+
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+static void
+test_raid1_read_balancing(void)
+{
+	struct raid_io_info io_info;
+	struct spdk_bdev_io *bdev_io[6];
+	struct iovec iov;
+	void *buf;
+	int i;
+
+	init_io_info(&io_info, 2);
+
+	buf = malloc(TEST_BLOCKLEN);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	iov.iov_base = buf;
+	iov.iov_len = TEST_BLOCKLEN;
+
+	/* Idle mirrors share the reads evenly */
+	g_io_completions = 0;
+	for (i = 0; i < 4; i++) {
+		bdev_io[i] = start_io(&io_info, SPDK_BDEV_IO_TYPE_READ, &iov, 0, 1);
+	}
+	CU_ASSERT(io_info.base_bdevs[0].reads == 2);
+	CU_ASSERT(io_info.base_bdevs[1].reads == 2);
+
+	/* Base bdev 1 is slow, new reads go to base bdev 0 until it catches up */
+	complete_base_ios(&io_info.base_bdevs[0]);
+	CU_ASSERT(g_io_completions == 2);
+	for (i = 4; i < 6; i++) {
+		bdev_io[i] = start_io(&io_info, SPDK_BDEV_IO_TYPE_READ, &iov, 0, 1);
+	}
+	CU_ASSERT(io_info.base_bdevs[0].reads == 4);
+	CU_ASSERT(io_info.base_bdevs[1].reads == 2);
+
+	g_io_completions = 0;
+	complete_base_ios(NULL);
+	CU_ASSERT(g_io_completions == 4);
+	for (i = 0; i < 6; i++) {
+		free(bdev_io[i]);
+	}
+
+	/* A missing base bdev is never read from */
+	io_info.raid_ch.base_channel[0] = NULL;
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_READ, buf, 0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_READ, buf, 0, 1) == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(io_info.base_bdevs[0].reads == 4);
+	CU_ASSERT(io_info.base_bdevs[1].reads == 4);
+	io_info.raid_ch.base_channel[0] = (struct spdk_io_channel *)&io_info.base_bdevs[0];
+
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+static void
+degraded_write(struct raid_io_info *io_info, void *buf, uint64_t offset_blocks,
+	       uint64_t num_blocks)
+{
+	fill_buf(buf, num_blocks * TEST_BLOCKLEN, offset_blocks);
+	CU_ASSERT(submit_io(io_info, SPDK_BDEV_IO_TYPE_WRITE, buf, offset_blocks, num_blocks) ==
+		  SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+start_resync(struct raid_io_info *io_info, uint8_t idx)
+{
+	struct raid_bdev *raid_bdev = io_info->r1info->raid_bdev;
+
+	io_info->raid_ch.base_channel[idx] = (struct spdk_io_channel *)&io_info->base_bdevs[idx];
+	raid_bdev->base_bdev_info[idx].resyncing = true;
+	g_resync_done = false;
+	raid1_resync_base_bdev(raid_bdev, &raid_bdev->base_bdev_info[idx]);
+}
+
+static void
+test_raid1_degraded_resync(void)
+{
+	struct raid_io_info io_info;
+	struct raid1_info *r1info;
+	void *buf;
+
+	init_io_info(&io_info, 2);
+	r1info = io_info.r1info;
+
+	buf = malloc(TEST_REGION_BLOCKS * TEST_BLOCKLEN);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	/* Writes while base bdev 1 is missing mark its regions dirty */
+	io_info.raid_ch.base_channel[1] = NULL;
+	degraded_write(&io_info, buf, 8, 8);
+	degraded_write(&io_info, buf, TEST_REGION_BLOCKS * 3 - 1, 2);
+	degraded_write(&io_info, buf, TEST_BLOCKCNT - 1, 1);
+
+	CU_ASSERT(io_info.base_bdevs[0].writes == 3);
+	CU_ASSERT(io_info.base_bdevs[1].writes == 0);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 0, 0) == RAID1_REGION_NONE);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 0) == 0);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 1) == 2);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 3) == 3);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 4) == 4);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 5) == RAID1_REGION_NONE);
+
+	/* Only the dirty regions are copied */
+	start_resync(&io_info, 1);
+	complete_base_ios(NULL);
+
+	CU_ASSERT(g_resync_done == true);
+	CU_ASSERT(g_resync_status == 0);
+	CU_ASSERT(io_info.base_bdevs[1].writes == 4);
+	CU_ASSERT(io_info.base_bdevs[0].reads == 4);
+	CU_ASSERT(g_io_completions == 1);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 0) == RAID1_REGION_NONE);
+	CU_ASSERT(r1info->resync_region[1] == RAID1_REGION_NONE);
+	CU_ASSERT(TAILQ_EMPTY(&r1info->resyncs));
+	CU_ASSERT(memcmp(io_info.base_bdevs[0].buf, io_info.base_bdevs[1].buf,
+			 io_info.base_bdevs[0].size) == 0);
+
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+static void
+test_raid1_full_resync(void)
+{
+	struct raid_io_info io_info;
+	struct raid1_info *r1info;
+	void *buf;
+
+	init_io_info(&io_info, 2);
+	r1info = io_info.r1info;
+
+	buf = malloc(TEST_BLOCKLEN);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	io_info.raid_ch.base_channel[1] = NULL;
+	degraded_write(&io_info, buf, 8, 1);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 1) == RAID1_REGION_NONE);
+
+	/* A base bdev that is not the removed one gets all regions copied */
+	r1info->raid_bdev->base_bdev_info[1].full_resync = true;
+	start_resync(&io_info, 1);
+	CU_ASSERT(r1info->raid_bdev->base_bdev_info[1].full_resync == false);
+	complete_base_ios(NULL);
+
+	CU_ASSERT(g_resync_done == true);
+	CU_ASSERT(g_resync_status == 0);
+	CU_ASSERT(io_info.base_bdevs[0].reads == r1info->num_regions);
+	CU_ASSERT(io_info.base_bdevs[1].writes == r1info->num_regions);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 0) == RAID1_REGION_NONE);
+	CU_ASSERT(memcmp(io_info.base_bdevs[0].buf, io_info.base_bdevs[1].buf,
+			 io_info.base_bdevs[0].size) == 0);
+
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+static void
+test_raid1_resync_write_race(void)
+{
+	struct raid_io_info io_info;
+	struct raid1_info *r1info;
+	struct spdk_bdev_io *bdev_io;
+	struct iovec iov;
+	void *buf;
+
+	init_io_info(&io_info, 2);
+	r1info = io_info.r1info;
+
+	buf = malloc(TEST_BLOCKLEN);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	io_info.raid_ch.base_channel[1] = NULL;
+	degraded_write(&io_info, buf, 0, 1);
+
+	/* The resync reads region 0 from base bdev 0 */
+	start_resync(&io_info, 1);
+	CU_ASSERT(r1info->resync_region[1] == 0);
+	CU_ASSERT(raid1_find_dirty_region(r1info, 1, 0) == RAID1_REGION_NONE);
+
+	/* A write to the region being copied completes in the meantime */
+	fill_buf(buf, TEST_BLOCKLEN, 100);
+	iov.iov_base = buf;
+	iov.iov_len = TEST_BLOCKLEN;
+	g_io_completions = 0;
+	bdev_io = start_io(&io_info, SPDK_BDEV_IO_TYPE_WRITE, &iov, 0, 1);
+	complete_base_ios(NULL);
+	CU_ASSERT(g_io_completions == 1);
+	free(bdev_io);
+
+	/* The region was copied twice and the mirrors are in sync */
+	CU_ASSERT(g_resync_done == true);
+	CU_ASSERT(g_resync_status == 0);
+	CU_ASSERT(io_info.base_bdevs[0].reads == 2);
+	CU_ASSERT(io_info.base_bdevs[1].writes == 3);
+	CU_ASSERT(memcmp(io_info.base_bdevs[1].buf, buf, TEST_BLOCKLEN) == 0);
+	CU_ASSERT(memcmp(io_info.base_bdevs[0].buf, io_info.base_bdevs[1].buf,
+			 io_info.base_bdevs[0].size) == 0);
+
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+static void
+test_raid1_resync_remove(void)
+{
+	struct raid_io_info io_info;
+	struct raid_bdev *raid_bdev;
+	void *buf;
+
+	init_io_info(&io_info, 2);
+	raid_bdev = io_info.r1info->raid_bdev;
+
+	buf = malloc(TEST_BLOCKLEN);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	io_info.raid_ch.base_channel[1] = NULL;
+	degraded_write(&io_info, buf, 0, 1);
+	degraded_write(&io_info, buf, TEST_REGION_BLOCKS, 1);
+
+	/* The base bdev goes away again while its first region is being copied */
+	start_resync(&io_info, 1);
+	raid_bdev->base_bdev_info[1].remove_scheduled = true;
+	complete_base_ios(NULL);
+
+	CU_ASSERT(g_resync_done == true);
+	CU_ASSERT(g_resync_status == -ENODEV);
+	CU_ASSERT(io_info.base_bdevs[1].writes == 1);
+	CU_ASSERT(raid1_find_dirty_region(io_info.r1info, 1, 0) == 1);
+	CU_ASSERT(io_info.r1info->resync_region[1] == RAID1_REGION_NONE);
+
+	raid_bdev->base_bdev_info[1].remove_scheduled = false;
+	free(buf);
+	deinit_io_info(&io_info);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid1", test_setup, test_cleanup);
+	CU_ADD_TEST(suite, test_raid1_start);
+	CU_ADD_TEST(suite, test_raid1_write);
+	CU_ADD_TEST(suite, test_raid1_read_balancing);
+	CU_ADD_TEST(suite, test_raid1_degraded_resync);
+	CU_ADD_TEST(suite, test_raid1_full_resync);
+	CU_ADD_TEST(suite, test_raid1_resync_write_race);
+	CU_ADD_TEST(suite, test_raid1_resync_remove);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -8,11 +8,135 @@
 #include "spdk/env.h"
 #include "spdk_internal/mock.h"
 
+#include "common/lib/ut_multithread.c"
+
 #include "bdev/raid/raid5f.c"
 
 DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
-DEFINE_STUB_V(raid_bdev_io_complete, (struct raid_bdev_io *raid_io,
-				      enum spdk_bdev_io_status status));
+DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+					struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 64);
+
+static enum spdk_bdev_io_status g_io_status;
+static bool g_io_completed;
+
+void
+raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	CU_ASSERT(g_io_completed == false);
+	g_io_completed = true;
+	g_io_status = status;
+}
+
+/* Memory backed base bdev, covering only the first few stripes of the array */
+struct test_base_bdev {
+	void *buf;
+	size_t size;
+	uint32_t blocklen;
+};
+
+struct test_base_io {
+	struct spdk_bdev_io bdev_io;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+	bool success;
+	TAILQ_ENTRY(test_base_io) link;
+};
+
+static TAILQ_HEAD(, test_base_io) g_pending_base_ios = TAILQ_HEAD_INITIALIZER(g_pending_base_ios);
+static bool g_fail_base_io;
+
+/* Ext opts and buffer of the raid IO being submitted */
+static struct spdk_bdev_ext_io_opts g_raid_io_ext_opts;
+static void *g_raid_io_buf;
+static size_t g_raid_io_buf_len;
+
+static void
+check_base_io_ext_opts(struct iovec *iov, int iovcnt, struct spdk_bdev_ext_io_opts *opts)
+{
+	bool raid_io_buf;
+	int i;
+
+	/* The ext opts are passed with the buffers of the raid IO only */
+	for (i = 0; i < iovcnt; i++) {
+		raid_io_buf = iov[i].iov_base >= g_raid_io_buf &&
+			      iov[i].iov_base < g_raid_io_buf + g_raid_io_buf_len;
+		CU_ASSERT(opts == (raid_io_buf ? &g_raid_io_ext_opts : NULL));
+	}
+}
+
+static int
+test_base_rw(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt,
+	     uint64_t offset_blocks, uint64_t num_blocks, bool write,
+	     spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = (struct test_base_bdev *)desc;
+	size_t offset = offset_blocks * base->blocklen;
+	size_t len = num_blocks * base->blocklen;
+	struct test_base_io *io;
+	int i;
+
+	SPDK_CU_ASSERT_FATAL(offset + len <= base->size);
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	io->success = !g_fail_base_io;
+
+	for (i = 0; i < iovcnt; i++) {
+		CU_ASSERT(iov[i].iov_len <= len);
+		if (write) {
+			memcpy(base->buf + offset, iov[i].iov_base, iov[i].iov_len);
+		} else {
+			memcpy(iov[i].iov_base, base->buf + offset, iov[i].iov_len);
+		}
+		offset += iov[i].iov_len;
+		len -= iov[i].iov_len;
+	}
+	CU_ASSERT(len == 0);
+
+	TAILQ_INSERT_TAIL(&g_pending_base_ios, io, link);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			    spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	check_base_io_ext_opts(iov, iovcnt, opts);
+	return test_base_rw(desc, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			   spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	check_base_io_ext_opts(iov, iovcnt, opts);
+	return test_base_rw(desc, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(SPDK_CONTAINEROF(bdev_io, struct test_base_io, bdev_io));
+}
+
+static void
+complete_base_ios(void)
+{
+	struct test_base_io *io;
+
+	while ((io = TAILQ_FIRST(&g_pending_base_ios))) {
+		TAILQ_REMOVE(&g_pending_base_ios, io, link);
+		io->cb(&io->bdev_io, io->success, io->cb_arg);
+	}
+}
 
 struct raid5f_params {
 	uint8_t num_base_bdevs;
@@ -43,6 +167,9 @@ test_setup(void)
 	uint32_t *strip_size_kb;
 	struct raid5f_params *params;
 
+	allocate_threads(1);
+	set_thread(0);
+
 	g_params_count = SPDK_COUNTOF(num_base_bdevs_values) *
 			 SPDK_COUNTOF(base_bdev_blockcnt_values) *
 			 SPDK_COUNTOF(base_bdev_blocklen_values) *
@@ -80,6 +207,7 @@ static int
 test_cleanup(void)
 {
 	free(g_params);
+	free_threads();
 	return 0;
 }
 
@@ -141,6 +269,7 @@ delete_raid5f(struct raid5f_info *r5f_info)
 	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
 
 	raid5f_stop(raid_bdev);
+	poll_threads();
 
 	delete_raid_bdev(raid_bdev);
 }
@@ -160,12 +289,409 @@ test_raid5f_start(void)
 		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.blockcnt,
 				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
 				(params->num_base_bdevs - 1));
-		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, r5f_info->stripe_blocks);
+		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.write_unit_size, r5f_info->stripe_blocks);
+		CU_ASSERT(r5f_info->raid_bdev->bdev.split_on_write_unit == true);
 
 		delete_raid5f(r5f_info);
 	}
 }
 
+/* Number of stripes backed by the test base bdevs */
+#define TEST_STRIPES_MAX 3
+
+struct raid_io_info {
+	struct raid5f_info *r5f_info;
+	struct raid_bdev_io_channel raid_ch;
+	struct test_base_bdev *base_bdevs;
+	uint64_t num_stripes;
+};
+
+static void
+init_io_info(struct raid_io_info *io_info, struct raid5f_params *params)
+{
+	struct raid5f_info *r5f_info = create_raid5f(params);
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	struct test_base_bdev *base;
+	uint8_t i;
+
+	memset(io_info, 0, sizeof(*io_info));
+	io_info->r5f_info = r5f_info;
+	io_info->num_stripes = spdk_min(r5f_info->total_stripes, TEST_STRIPES_MAX);
+
+	raid_bdev->blocklen_shift = spdk_u32log2(params->base_bdev_blocklen);
+
+	io_info->base_bdevs = calloc(raid_bdev->num_base_bdevs, sizeof(*io_info->base_bdevs));
+	SPDK_CU_ASSERT_FATAL(io_info->base_bdevs != NULL);
+
+	io_info->raid_ch.num_channels = raid_bdev->num_base_bdevs;
+	io_info->raid_ch.base_channel = calloc(raid_bdev->num_base_bdevs,
+					       sizeof(struct spdk_io_channel *));
+	SPDK_CU_ASSERT_FATAL(io_info->raid_ch.base_channel != NULL);
+
+	i = 0;
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		base = &io_info->base_bdevs[i];
+		base->blocklen = params->base_bdev_blocklen;
+		base->size = io_info->num_stripes * params->strip_size * params->base_bdev_blocklen;
+		base->buf = calloc(1, base->size);
+		SPDK_CU_ASSERT_FATAL(base->buf != NULL);
+
+		base_info->desc = (struct spdk_bdev_desc *)base;
+		/* Any non-NULL value, the channel is only passed to the stubs */
+		io_info->raid_ch.base_channel[i] = (struct spdk_io_channel *)base;
+		i++;
+	}
+
+	io_info->raid_ch.module_channel = raid5f_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(io_info->raid_ch.module_channel != NULL);
+}
+
+static void
+deinit_io_info(struct raid_io_info *io_info)
+{
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+	uint8_t i;
+
+	spdk_put_io_channel(io_info->raid_ch.module_channel);
+	poll_threads();
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(io_info->base_bdevs[i].buf);
+	}
+	free(io_info->base_bdevs);
+	free(io_info->raid_ch.base_channel);
+
+	delete_raid5f(io_info->r5f_info);
+}
+
+static enum spdk_bdev_io_status
+submit_io(struct raid_io_info *io_info, enum spdk_bdev_io_type type, struct iovec *iovs,
+	  int iovcnt, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+	struct spdk_bdev_io *bdev_io;
+	struct raid_bdev_io *raid_io;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(*raid_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+
+	bdev_io->bdev = &raid_bdev->bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.iovs = iovs;
+	bdev_io->u.bdev.iovcnt = iovcnt;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->u.bdev.ext_opts = &g_raid_io_ext_opts;
+
+	/* The iovecs of the test IOs are always contiguous */
+	g_raid_io_buf = iovs[0].iov_base;
+	g_raid_io_buf_len = num_blocks * raid_bdev->bdev.blocklen;
+
+	raid_io = (struct raid_bdev_io *)bdev_io->driver_ctx;
+	raid_io->raid_bdev = raid_bdev;
+	raid_io->raid_ch = &io_info->raid_ch;
+	raid_io->base_bdev_io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	g_io_completed = false;
+	raid5f_submit_rw_request(raid_io);
+	complete_base_ios();
+	CU_ASSERT(g_io_completed == true);
+
+	free(bdev_io);
+
+	return g_io_status;
+}
+
+/* Split a buffer into iovecs of varying length to exercise the iovec mapping */
+static int
+buf_to_iovs(void *buf, size_t len, uint32_t blocklen, struct iovec *iovs, int iovcnt_max)
+{
+	size_t iov_len = blocklen / 2;
+	int iovcnt = 0;
+
+	while (len > 0) {
+		SPDK_CU_ASSERT_FATAL(iovcnt < iovcnt_max);
+		iov_len = spdk_min(len, iovcnt == iovcnt_max - 1 ? len : iov_len);
+		iovs[iovcnt].iov_base = buf;
+		iovs[iovcnt].iov_len = iov_len;
+		buf += iov_len;
+		len -= iov_len;
+		iov_len = iov_len * 2 + blocklen / 4;
+		iovcnt++;
+	}
+
+	return iovcnt;
+}
+
+static void
+fill_buf(void *buf, size_t len, uint64_t seed)
+{
+	uint8_t *b = buf;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		b[i] = (uint8_t)(seed * 31 + i * 7 + (i >> 8));
+	}
+}
+
+static void
+write_stripe(struct raid_io_info *io_info, uint64_t stripe_index, void *stripe_buf)
+{
+	struct raid5f_info *r5f_info = io_info->r5f_info;
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	struct iovec iovs[32];
+	int iovcnt;
+
+	iovcnt = buf_to_iovs(stripe_buf, r5f_info->stripe_blocks * raid_bdev->bdev.blocklen,
+			     raid_bdev->bdev.blocklen, iovs, SPDK_COUNTOF(iovs));
+
+	CU_ASSERT(submit_io(io_info, SPDK_BDEV_IO_TYPE_WRITE, iovs, iovcnt,
+			    stripe_index * r5f_info->stripe_blocks,
+			    r5f_info->stripe_blocks) == SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+verify_stripe(struct raid_io_info *io_info, uint64_t stripe_index, void *stripe_buf,
+	      uint8_t skip_idx)
+{
+	struct raid5f_info *r5f_info = io_info->r5f_info;
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t base_offset = stripe_index * strip_len;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+	uint8_t *parity;
+	void *data;
+	uint8_t i, d;
+	size_t j;
+
+	parity = calloc(1, strip_len);
+	SPDK_CU_ASSERT_FATAL(parity != NULL);
+
+	for (i = 0, d = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (i == p_idx) {
+			continue;
+		}
+
+		data = stripe_buf + d * strip_len;
+		if (i != skip_idx) {
+			CU_ASSERT(memcmp(io_info->base_bdevs[i].buf + base_offset, data, strip_len) == 0);
+		}
+		for (j = 0; j < strip_len; j++) {
+			parity[j] ^= ((uint8_t *)data)[j];
+		}
+		d++;
+	}
+
+	if (p_idx != skip_idx) {
+		CU_ASSERT(memcmp(io_info->base_bdevs[p_idx].buf + base_offset, parity, strip_len) == 0);
+	}
+
+	free(parity);
+}
+
+static void
+test_raid5f_submit_full_stripe_write_request(void)
+{
+	struct raid5f_params *params;
+
+	RAID5F_PARAMS_FOR_EACH(params) {
+		struct raid_io_info io_info;
+		size_t stripe_len;
+		uint64_t stripe_index;
+		void *stripe_buf;
+
+		init_io_info(&io_info, params);
+		stripe_len = io_info.r5f_info->stripe_blocks * params->base_bdev_blocklen;
+		stripe_buf = malloc(stripe_len);
+		SPDK_CU_ASSERT_FATAL(stripe_buf != NULL);
+
+		for (stripe_index = 0; stripe_index < io_info.num_stripes; stripe_index++) {
+			fill_buf(stripe_buf, stripe_len, stripe_index);
+			write_stripe(&io_info, stripe_index, stripe_buf);
+			verify_stripe(&io_info, stripe_index, stripe_buf, UINT8_MAX);
+		}
+
+		free(stripe_buf);
+		deinit_io_info(&io_info);
+	}
+}
+
+static void
+test_raid5f_submit_partial_stripe_write_request(void)
+{
+	struct raid5f_params *params = g_params;
+	struct raid_io_info io_info;
+	struct iovec iov;
+
+	init_io_info(&io_info, params);
+
+	iov.iov_len = params->base_bdev_blocklen;
+	iov.iov_base = calloc(1, iov.iov_len);
+	SPDK_CU_ASSERT_FATAL(iov.iov_base != NULL);
+
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_WRITE, &iov, 1, 0, 1) ==
+		  SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(TAILQ_EMPTY(&g_pending_base_ios));
+
+	free(iov.iov_base);
+	deinit_io_info(&io_info);
+}
+
+static void
+read_and_verify(struct raid_io_info *io_info, uint64_t stripe_index, void *stripe_buf)
+{
+	struct raid5f_info *r5f_info = io_info->r5f_info;
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint64_t strip_size = raid_bdev->strip_size;
+	uint64_t stripe_offset;
+	struct iovec iovs[32];
+	int iovcnt;
+	void *buf;
+
+	buf = malloc(strip_size * blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	/* Read each strip in full, then an unaligned range in the middle of it */
+	for (stripe_offset = 0; stripe_offset < r5f_info->stripe_blocks; stripe_offset += strip_size) {
+		uint64_t offset = stripe_offset;
+		uint64_t num_blocks = strip_size;
+
+		memset(buf, 0, strip_size * blocklen);
+		iovcnt = buf_to_iovs(buf, num_blocks * blocklen, blocklen, iovs, SPDK_COUNTOF(iovs));
+		CU_ASSERT(submit_io(io_info, SPDK_BDEV_IO_TYPE_READ, iovs, iovcnt,
+				    stripe_index * r5f_info->stripe_blocks + offset,
+				    num_blocks) == SPDK_BDEV_IO_STATUS_SUCCESS);
+		CU_ASSERT(memcmp(buf, stripe_buf + offset * blocklen, num_blocks * blocklen) == 0);
+
+		if (strip_size < 3) {
+			continue;
+		}
+
+		offset = stripe_offset + 1;
+		num_blocks = strip_size - 2;
+
+		memset(buf, 0, strip_size * blocklen);
+		iovcnt = buf_to_iovs(buf, num_blocks * blocklen, blocklen, iovs, SPDK_COUNTOF(iovs));
+		CU_ASSERT(submit_io(io_info, SPDK_BDEV_IO_TYPE_READ, iovs, iovcnt,
+				    stripe_index * r5f_info->stripe_blocks + offset,
+				    num_blocks) == SPDK_BDEV_IO_STATUS_SUCCESS);
+		CU_ASSERT(memcmp(buf, stripe_buf + offset * blocklen, num_blocks * blocklen) == 0);
+	}
+
+	free(buf);
+}
+
+static void
+test_raid5f_submit_read_request(void)
+{
+	struct raid5f_params *params;
+
+	RAID5F_PARAMS_FOR_EACH(params) {
+		struct raid_io_info io_info;
+		size_t stripe_len;
+		uint64_t stripe_index;
+		void *stripe_buf;
+
+		init_io_info(&io_info, params);
+		stripe_len = io_info.r5f_info->stripe_blocks * params->base_bdev_blocklen;
+		stripe_buf = malloc(stripe_len);
+		SPDK_CU_ASSERT_FATAL(stripe_buf != NULL);
+
+		for (stripe_index = 0; stripe_index < io_info.num_stripes; stripe_index++) {
+			fill_buf(stripe_buf, stripe_len, stripe_index + 100);
+			write_stripe(&io_info, stripe_index, stripe_buf);
+			read_and_verify(&io_info, stripe_index, stripe_buf);
+		}
+
+		free(stripe_buf);
+		deinit_io_info(&io_info);
+	}
+}
+
+static void
+test_raid5f_degraded(void)
+{
+	struct raid5f_params *params;
+
+	RAID5F_PARAMS_FOR_EACH(params) {
+		struct raid_io_info io_info;
+		struct spdk_io_channel *removed_ch;
+		size_t stripe_len;
+		uint64_t stripe_index;
+		void *stripe_buf;
+		uint8_t i;
+
+		init_io_info(&io_info, params);
+		stripe_len = io_info.r5f_info->stripe_blocks * params->base_bdev_blocklen;
+		stripe_buf = malloc(stripe_len);
+		SPDK_CU_ASSERT_FATAL(stripe_buf != NULL);
+
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			/* Remove one base bdev at a time, reads must reconstruct its data */
+			removed_ch = io_info.raid_ch.base_channel[i];
+			io_info.raid_ch.base_channel[i] = NULL;
+
+			for (stripe_index = 0; stripe_index < io_info.num_stripes; stripe_index++) {
+				/* Write while healthy, read while degraded */
+				io_info.raid_ch.base_channel[i] = removed_ch;
+				fill_buf(stripe_buf, stripe_len, stripe_index + i * 10);
+				write_stripe(&io_info, stripe_index, stripe_buf);
+				io_info.raid_ch.base_channel[i] = NULL;
+				read_and_verify(&io_info, stripe_index, stripe_buf);
+
+				/* Write and read while degraded */
+				memset(io_info.base_bdevs[i].buf, 0, io_info.base_bdevs[i].size);
+				fill_buf(stripe_buf, stripe_len, stripe_index + i * 10 + 5);
+				write_stripe(&io_info, stripe_index, stripe_buf);
+				verify_stripe(&io_info, stripe_index, stripe_buf, i);
+				read_and_verify(&io_info, stripe_index, stripe_buf);
+			}
+
+			io_info.raid_ch.base_channel[i] = removed_ch;
+		}
+
+		free(stripe_buf);
+		deinit_io_info(&io_info);
+	}
+}
+
+static void
+test_raid5f_degraded_read_failure(void)
+{
+	struct raid5f_params *params = g_params;
+	struct raid_io_info io_info;
+	struct iovec iov;
+
+	init_io_info(&io_info, params);
+
+	iov.iov_len = params->base_bdev_blocklen;
+	iov.iov_base = calloc(1, iov.iov_len);
+	SPDK_CU_ASSERT_FATAL(iov.iov_base != NULL);
+
+	/* Data chunk 0 of stripe 0 is on base bdev 0 */
+	io_info.raid_ch.base_channel[0] = NULL;
+
+	/* A failed read of any of the other chunks fails the reconstruction */
+	g_fail_base_io = true;
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_READ, &iov, 1, 0, 1) ==
+		  SPDK_BDEV_IO_STATUS_FAILED);
+	g_fail_base_io = false;
+
+	/* Two missing base bdevs can't be recovered from */
+	io_info.raid_ch.base_channel[1] = NULL;
+	CU_ASSERT(submit_io(&io_info, SPDK_BDEV_IO_TYPE_READ, &iov, 1, 0, 1) ==
+		  SPDK_BDEV_IO_STATUS_FAILED);
+
+	io_info.raid_ch.base_channel[0] = (struct spdk_io_channel *)&io_info.base_bdevs[0];
+	io_info.raid_ch.base_channel[1] = (struct spdk_io_channel *)&io_info.base_bdevs[1];
+
+	free(iov.iov_base);
+	deinit_io_info(&io_info);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -177,6 +703,11 @@ main(int argc, char **argv)
 
 	suite = CU_add_suite("raid5f", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_raid5f_start);
+	CU_ADD_TEST(suite, test_raid5f_submit_full_stripe_write_request);
+	CU_ADD_TEST(suite, test_raid5f_submit_partial_stripe_write_request);
+	CU_ADD_TEST(suite, test_raid5f_submit_read_request);
+	CU_ADD_TEST(suite, test_raid5f_degraded);
+	CU_ADD_TEST(suite, test_raid5f_degraded_read_failure);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -2850,7 +2850,7 @@ bs_test_recover_cluster_count(void)
 	memset(super_block.bstype.bstype, 0, sizeof(super_block.bstype.bstype));
 	super_block.size = dev->blockcnt * dev->blocklen;
 	super_block.io_unit_size = 0x1000;
-	memset(super_block.reserved, 0, 4000);
+	memset(super_block.reserved, 0, sizeof(super_block.reserved));
 	super_block.crc = blob_md_page_calc_crc(&super_block);
 	memcpy(g_dev_buffer, &super_block, sizeof(struct spdk_bs_super_block));
 
@@ -2869,6 +2869,226 @@ bs_test_recover_cluster_count(void)
 	g_bs = NULL;
 }
 
+static void
+bs_test_recover_md_replay(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts opts;
+	struct spdk_blob_opts blob_opts;
+	struct spdk_blob *blob;
+	spdk_blob_id blobids[40];
+	char xattr[3000];
+	const void *value;
+	size_t value_len;
+	uint64_t free_clusters;
+	uint64_t used_md_pages;
+	uint32_t i;
+	int rc;
+
+	/* Use more md pages than fit in a single window of replay reads */
+	dev = init_dev();
+	spdk_bs_opts_init(&opts, sizeof(opts));
+	opts.num_md_pages = 4 * SPDK_BLOB_LOAD_REPLAY_QUEUE_DEPTH * SPDK_BLOB_LOAD_REPLAY_SCAN_PAGES;
+
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	/* Every fourth blob has md spanning multiple pages */
+	memset(xattr, 0x5A, sizeof(xattr));
+	for (i = 0; i < SPDK_COUNTOF(blobids); i++) {
+		ut_spdk_blob_opts_init(&blob_opts);
+		blob_opts.num_clusters = 1;
+		blob = ut_blob_create_and_open(bs, &blob_opts);
+		blobids[i] = spdk_blob_get_id(blob);
+
+		if (i % 4 == 0) {
+			rc = spdk_blob_set_xattr(blob, "first", xattr, sizeof(xattr));
+			CU_ASSERT(rc == 0);
+			rc = spdk_blob_set_xattr(blob, "second", xattr, sizeof(xattr));
+			CU_ASSERT(rc == 0);
+			spdk_blob_sync_md(blob, blob_op_complete, NULL);
+			poll_threads();
+			CU_ASSERT(g_bserrno == 0);
+		}
+
+		spdk_blob_close(blob, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	used_md_pages = spdk_bit_array_count_set(bs->used_md_pages);
+	g_blob = NULL;
+
+	ut_bs_dirty_load(&bs, NULL);
+
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+	CU_ASSERT(spdk_bit_array_count_set(bs->used_md_pages) == used_md_pages);
+	CU_ASSERT(spdk_bit_array_count_set(bs->used_blobids) == SPDK_COUNTOF(blobids));
+
+	for (i = 0; i < SPDK_COUNTOF(blobids); i++) {
+		spdk_bs_open_blob(bs, blobids[i], blob_op_with_handle_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+		blob = g_blob;
+
+		CU_ASSERT(spdk_blob_get_num_clusters(blob) == 1);
+		rc = spdk_blob_get_xattr_value(blob, "second", &value, &value_len);
+		if (i % 4 == 0) {
+			CU_ASSERT(rc == 0);
+			CU_ASSERT(value_len == sizeof(xattr));
+		} else {
+			CU_ASSERT(rc != 0);
+		}
+
+		spdk_blob_close(blob, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	g_blob = NULL;
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_md_journal(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts opts;
+	struct spdk_blob_opts blob_opts;
+	struct spdk_bs_super_block *super_block;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	spdk_blob_id blobid;
+	uint8_t payload_read[4096];
+	uint8_t payload_write[4096];
+	uint64_t io_units_per_cluster;
+	uint64_t free_clusters;
+	uint64_t next_seq;
+	uint32_t i;
+
+	/* Journal smaller than two batches is rejected */
+	dev = init_dev();
+	spdk_bs_opts_init(&opts, sizeof(opts));
+	opts.md_journal_pages = 2 * SPDK_BLOB_MD_JOURNAL_BATCH_PAGES - 1;
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EINVAL);
+	CU_ASSERT(g_bs == NULL);
+
+	dev = init_dev();
+	opts.md_journal_pages = 2 * SPDK_BLOB_MD_JOURNAL_BATCH_PAGES;
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	SPDK_CU_ASSERT_FATAL(bs->md_journal != NULL);
+
+	super_block = (struct spdk_bs_super_block *)g_dev_buffer;
+	CU_ASSERT(super_block->version == SPDK_BS_MD_JOURNAL_VERSION);
+	CU_ASSERT(super_block->md_journal_len == opts.md_journal_pages);
+	CU_ASSERT(super_block->md_journal_start + super_block->md_journal_len == super_block->md_start);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_io_unit_size(bs);
+
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.thin_provision = true;
+	blob_opts.num_clusters = 12;
+	blob = ut_blob_create_and_open(bs, &blob_opts);
+	blobid = spdk_blob_get_id(blob);
+	free_clusters = spdk_bs_free_cluster_count(bs);
+
+	/* Each allocation is written to the journal separately. Once half of
+	 * the journal is used, the blob metadata is checkpointed. */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	for (i = 0; i < 11; i++) {
+		spdk_blob_io_write(blob, channel, payload_write, i * io_units_per_cluster, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 11);
+	CU_ASSERT(bs->md_journal->next_seq >= 11);
+	CU_ASSERT(blob->md_journal_seq != 0);
+	CU_ASSERT(bs->md_journal->used < bs->md_journal->len / 2);
+	CU_ASSERT(blob->md_journal_dirty == true);
+	next_seq = bs->md_journal->next_seq;
+
+	/* Dirty shutdown with allocations only in the journal */
+	ut_bs_dirty_load(&bs, NULL);
+	SPDK_CU_ASSERT_FATAL(bs->md_journal != NULL);
+	CU_ASSERT(bs->md_journal->next_seq > next_seq);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 11);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	for (i = 0; i < 11; i++) {
+		CU_ASSERT(blob->active.clusters[i] != 0);
+		memset(payload_read, 0, sizeof(payload_read));
+		spdk_blob_io_read(blob, channel, payload_read, i * io_units_per_cluster, 1,
+				  blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(memcmp(payload_write, payload_read, spdk_bs_get_io_unit_size(bs)) == 0);
+	}
+	CU_ASSERT(blob->active.clusters[11] == 0);
+
+	/* Allocate the last cluster and write it back on close */
+	spdk_blob_io_write(blob, channel, payload_write, 11 * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->md_journal_dirty == true);
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(TAILQ_EMPTY(&bs->md_journal->dirty_blobs));
+	next_seq = bs->md_journal->next_seq;
+	g_blob = NULL;
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	/* Clean shutdown records the last journal record */
+	ut_bs_reload(&bs, NULL);
+	CU_ASSERT(super_block->md_journal_seq == next_seq - 1);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 12);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	for (i = 0; i < 12; i++) {
+		CU_ASSERT(blob->active.clusters[i] != 0);
+	}
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
 static void
 bs_test_grow(void)
 {
@@ -4031,7 +4251,7 @@ blob_insert_cluster_msg_test(void)
 	bs_allocate_cluster(blob, cluster_num, &new_cluster, &extent_page, false);
 	CU_ASSERT(blob->active.clusters[cluster_num] == 0);
 
-	blob_insert_cluster_on_md_thread(blob, cluster_num, new_cluster, extent_page, &page,
+	blob_insert_cluster_on_md_thread(blob, cluster_num, new_cluster, extent_page, &page, false,
 					 blob_op_complete, NULL);
 	poll_threads();
 
@@ -4666,6 +4886,269 @@ blob_snapshot_rw(void)
 	g_blobid = 0;
 }
 
+static void
+blob_snapshot_sub_cluster_cow(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	struct spdk_blob_cow_map *map;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t free_clusters;
+	uint64_t cluster_size;
+	uint64_t io_unit_size;
+	uint64_t io_units_per_cluster;
+	uint64_t read_bytes;
+	uint8_t *payload_read;
+	uint8_t *payload_write;
+	uint8_t *expected;
+
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.sub_cluster_cow = true;
+	ut_bs_reload(&bs, &bs_opts);
+
+	cluster_size = spdk_bs_get_cluster_size(bs);
+	io_unit_size = spdk_bs_get_io_unit_size(bs);
+	io_units_per_cluster = cluster_size / io_unit_size;
+
+	payload_read = calloc(1, cluster_size);
+	payload_write = calloc(1, cluster_size);
+	expected = calloc(1, cluster_size);
+	SPDK_CU_ASSERT_FATAL(payload_read != NULL && payload_write != NULL && expected != NULL);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+
+	/* Maps of partially populated clusters are only kept in extent pages */
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.use_extent_table = true;
+	opts.num_clusters = 2;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	/* Fill the first cluster and snapshot the blob */
+	memset(payload_write, 0xE5, cluster_size);
+	spdk_blob_io_write(blob, channel, payload_write, 0, io_units_per_cluster, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshotid = g_blobid;
+
+	/* Small write allocates a cluster in the clone, without copying it from the snapshot */
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	read_bytes = g_dev_read_bytes;
+
+	memset(payload_write, 0xAA, 10 * io_unit_size);
+	spdk_blob_io_write(blob, channel, payload_write, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+	CU_ASSERT(g_dev_read_bytes == read_bytes);
+	CU_ASSERT((blob->invalid_flags & SPDK_BLOB_COW_MAP) != 0);
+
+	map = blob_get_cow_map(blob, 0);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	CU_ASSERT(spdk_bit_array_count_set(map->io_units) == 10);
+	CU_ASSERT(spdk_bit_array_find_first_set(map->io_units, 0) == 4);
+
+	/* Reads merge data written to the clone with the one from snapshot */
+	memset(expected, 0xE5, 20 * io_unit_size);
+	memset(expected + 4 * io_unit_size, 0xAA, 10 * io_unit_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, 20, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_read, expected, 20 * io_unit_size) == 0);
+
+	/* The map is persisted in the extent page */
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_bs_reload(&bs, &bs_opts);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	map = blob_get_cow_map(blob, 0);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	CU_ASSERT(spdk_bit_array_count_set(map->io_units) == 10);
+
+	memset(payload_read, 0, cluster_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, 20, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_read, expected, 20 * io_unit_size) == 0);
+
+	/* Recovery after dirty shutdown accepts the maps */
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_bs_dirty_load(&bs, &bs_opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	map = blob_get_cow_map(blob, 0);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	CU_ASSERT(spdk_bit_array_count_set(map->io_units) == 10);
+
+	/* Map of a cluster written as a whole is retired right away */
+	read_bytes = g_dev_read_bytes;
+
+	memset(payload_write, 0x55, cluster_size);
+	spdk_blob_io_write(blob, channel, payload_write, io_units_per_cluster, io_units_per_cluster,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_dev_read_bytes == read_bytes);
+	CU_ASSERT(blob->active.clusters[1] != 0);
+	CU_ASSERT(blob_get_cow_map(blob, 1) == NULL);
+
+	/* Removing the snapshot copies io_units not written yet over to the clone */
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->parent_id == SPDK_BLOBID_INVALID);
+	CU_ASSERT(blob_get_cow_map(blob, 0) == NULL);
+
+	memset(payload_read, 0, cluster_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, 20, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_read, expected, 20 * io_unit_size) == 0);
+
+	ut_blob_close_and_delete(bs, blob);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	free(payload_read);
+	free(payload_write);
+	free(expected);
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
+static void
+blob_sub_cluster_cow_parallel(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob *blob, *snapshot;
+	struct spdk_io_channel *channel;
+	struct spdk_bs_channel *bs_channel;
+	struct spdk_blob_opts opts;
+	struct spdk_blob_cow_map *map;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint64_t io_units_per_cluster;
+	uint64_t io_unit_size;
+	uint8_t *payload_read;
+	uint8_t *payload_write;
+
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.sub_cluster_cow = true;
+	ut_bs_reload(&bs, &bs_opts);
+
+	io_unit_size = spdk_bs_get_io_unit_size(bs);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / io_unit_size;
+
+	payload_read = calloc(3, io_unit_size);
+	payload_write = calloc(1, io_unit_size);
+	SPDK_CU_ASSERT_FATAL(payload_read != NULL && payload_write != NULL);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+	bs_channel = spdk_io_channel_get_ctx(channel);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.use_extent_table = true;
+	opts.num_clusters = 2;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+
+	spdk_bs_open_blob(bs, g_blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snapshot = g_blob;
+
+	/* First writes to different clusters don't wait for each other's metadata update,
+	 * a second write to the same cluster does */
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	memset(payload_write, 0xAA, io_unit_size);
+	spdk_blob_io_write(blob, channel, payload_write, 0, 1, blob_op_complete, NULL);
+	spdk_blob_io_write(blob, channel, payload_write, io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	spdk_blob_io_write(blob, channel, payload_write, 2, 1, blob_op_complete, NULL);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+	CU_ASSERT(bs_channel->new_cluster_page_used == true);
+
+	g_bserrno = -1;
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(TAILQ_EMPTY(&bs_channel->need_cluster_alloc));
+	CU_ASSERT(bs_channel->new_cluster_page_used == false);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+
+	map = blob_get_cow_map(blob, 0);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	CU_ASSERT(spdk_bit_array_count_set(map->io_units) == 2);
+	map = blob_get_cow_map(blob, 1);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+	CU_ASSERT(spdk_bit_array_count_set(map->io_units) == 1);
+
+	spdk_blob_io_read(blob, channel, payload_read, 0, 3, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_read, payload_write, io_unit_size) == 0);
+	CU_ASSERT(spdk_mem_all_zero(payload_read + io_unit_size, io_unit_size));
+	CU_ASSERT(memcmp(payload_read + 2 * io_unit_size, payload_write, io_unit_size) == 0);
+
+	ut_blob_close_and_delete(bs, blob);
+	ut_blob_close_and_delete(bs, snapshot);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	free(payload_read);
+	free(payload_write);
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
 static void
 blob_snapshot_rw_iov(void)
 {
@@ -7459,6 +7942,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bs_type);
 	CU_ADD_TEST(suite, bs_super_block);
 	CU_ADD_TEST(suite, bs_test_recover_cluster_count);
+	CU_ADD_TEST(suite, bs_test_recover_md_replay);
+	CU_ADD_TEST(suite, blob_md_journal);
 	CU_ADD_TEST(suite, bs_test_grow);
 	CU_ADD_TEST(suite, blob_serialize_test);
 	CU_ADD_TEST(suite_bs, blob_crc);
@@ -7475,6 +7960,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
 	CU_ADD_TEST(suite, bs_load_iter_test);
 	CU_ADD_TEST(suite_bs, blob_snapshot_rw);
+	CU_ADD_TEST(suite_bs, blob_snapshot_sub_cluster_cow);
+	CU_ADD_TEST(suite_bs, blob_sub_cluster_cow_parallel);
 	CU_ADD_TEST(suite_bs, blob_snapshot_rw_iov);
 	CU_ADD_TEST(suite, blob_relations);
 	CU_ADD_TEST(suite, blob_relations2);
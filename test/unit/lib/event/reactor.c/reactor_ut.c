@@ -722,6 +722,209 @@ test_scheduler(void)
 	free_cores();
 }
 
+static void
+test_scheduler_bin_packing(void)
+{
+	struct spdk_cpuset cpuset = {};
+	struct spdk_thread *thread[3];
+	struct spdk_scheduler_core_info cores_info[3] = {};
+	struct spdk_scheduler_thread_info thread_infos[3] = {};
+	uint64_t period_tsc;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(3);
+
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+
+	spdk_scheduler_set("dynamic");
+	g_scheduler_bin_packing = true;
+	period_tsc = _get_period_tsc();
+
+	for (i = 0; i < 3; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+		spdk_cpuset_set_cpu(&cpuset, i, true);
+	}
+
+	for (i = 0; i < 3; i++) {
+		thread[i] = spdk_thread_create(NULL, &cpuset);
+		CU_ASSERT(thread[i] != NULL);
+		thread_infos[i].thread_id = spdk_thread_get_id(thread[i]);
+	}
+
+	for (i = 0; i < 3; i++) {
+		MOCK_SET(spdk_env_get_current_core, i);
+		event_queue_run_batch(spdk_reactor_get(i));
+	}
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	/* Threads 0 (60% busy) and 1 (30% busy) run on core 1, thread 2 (30% busy) on core 2 */
+	thread_infos[0].lcore = 1;
+	thread_infos[0].current_stats.busy_tsc = 60;
+	thread_infos[0].current_stats.idle_tsc = 40;
+	thread_infos[1].lcore = 1;
+	thread_infos[1].current_stats.busy_tsc = 30;
+	thread_infos[1].current_stats.idle_tsc = 70;
+	thread_infos[2].lcore = 2;
+	thread_infos[2].current_stats.busy_tsc = 30;
+	thread_infos[2].current_stats.idle_tsc = 70;
+
+	for (i = 0; i < 3; i++) {
+		cores_info[i].lcore = i;
+	}
+	cores_info[1].threads_count = 2;
+	cores_info[1].thread_infos = &thread_infos[0];
+	cores_info[2].threads_count = 1;
+	cores_info[2].thread_infos = &thread_infos[2];
+
+	balance(cores_info, 3);
+
+	/* The busiest thread stays, the other two are packed together on the main core
+	 * and core 2 is left empty. */
+	CU_ASSERT(thread_infos[0].lcore == 1);
+	CU_ASSERT(thread_infos[1].lcore == 0);
+	CU_ASSERT(thread_infos[2].lcore == 0);
+	CU_ASSERT(g_cores[0].thread_count == 2);
+	CU_ASSERT(g_cores[1].thread_count == 1);
+	CU_ASSERT(g_cores[2].thread_count == 0);
+	CU_ASSERT(thread_infos[0].current_stats.busy_tsc == period_tsc * 60 / 100);
+
+	/* Load of thread 0 drops, its prediction is averaged with the previous period */
+	for (i = 0; i < 3; i++) {
+		thread_infos[i].lcore = i == 0 ? 1 : 0;
+		thread_infos[i].current_stats.busy_tsc = i == 0 ? 20 : 30;
+		thread_infos[i].current_stats.idle_tsc = i == 0 ? 80 : 70;
+	}
+	cores_info[0].threads_count = 2;
+	cores_info[0].thread_infos = &thread_infos[1];
+	cores_info[1].threads_count = 1;
+	cores_info[1].thread_infos = &thread_infos[0];
+	cores_info[2].threads_count = 0;
+	cores_info[2].thread_infos = NULL;
+
+	balance(cores_info, 3);
+
+	/* Thread 1 now fits next to thread 0, which leaves the main core less busy */
+	CU_ASSERT(thread_infos[0].current_stats.busy_tsc == period_tsc * 40 / 100);
+	CU_ASSERT(thread_infos[0].lcore == 1);
+	CU_ASSERT(thread_infos[1].lcore == 1);
+	CU_ASSERT(thread_infos[2].lcore == 0);
+
+	g_scheduler_bin_packing = false;
+
+	/* Destroy threads */
+	for (i = 0; i < 3; i++) {
+		reactor_run(spdk_reactor_get(i));
+	}
+
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+
+	free_cores();
+}
+
+static void
+test_scheduler_steal(void)
+{
+	struct spdk_cpuset cpuset = {};
+	struct spdk_thread *thread[3];
+	struct spdk_lw_thread *lw_thread;
+	struct spdk_reactor *reactor;
+	struct spdk_poller *busy;
+	uint64_t busy_time[3] = { 100, 300, 50 };
+	uint32_t src_lcore, dst_lcore;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(2);
+
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+
+	spdk_scheduler_set("dynamic");
+
+	for (i = 0; i < 2; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+		spdk_cpuset_set_cpu(&cpuset, i, true);
+	}
+
+	/* Create all threads on core 0 */
+	for (i = 0; i < 3; i++) {
+		g_next_core = 0;
+		thread[i] = spdk_thread_create(NULL, &cpuset);
+		CU_ASSERT(thread[i] != NULL);
+	}
+
+	reactor = spdk_reactor_get(0);
+	CU_ASSERT(event_queue_run_batch(reactor) == 3);
+	CU_ASSERT(reactor->thread_count == 3);
+
+	g_reactor_state = SPDK_REACTOR_STATE_RUNNING;
+
+	/* Stealing is disabled by default */
+	CU_ASSERT(steal(&src_lcore, &dst_lcore) == false);
+	g_scheduler_work_stealing = true;
+
+	/* Core 1 is idle, so nothing can be stolen from it */
+	CU_ASSERT(steal(&src_lcore, &dst_lcore) == false);
+
+	/* Make core 0 fully busy */
+	MOCK_SET(spdk_get_ticks, 100);
+	reactor->tsc_last = 100;
+	for (i = 0; i < 3; i++) {
+		spdk_set_thread(thread[i]);
+		busy = spdk_poller_register(poller_run_busy, (void *)busy_time[i], 0);
+		_reactor_run(reactor);
+		spdk_poller_unregister(&busy);
+	}
+	CU_ASSERT(reactor->busy_tsc == 450);
+
+	_reactors_scheduler_steal();
+
+	/* Core 0 picks the thread that splits its load most evenly */
+	CU_ASSERT(event_queue_run_batch(reactor) == 1);
+	lw_thread = spdk_thread_get_ctx(thread[1]);
+	CU_ASSERT(lw_thread->resched == true);
+	CU_ASSERT(lw_thread->lcore == 1);
+	lw_thread = spdk_thread_get_ctx(thread[0]);
+	CU_ASSERT(lw_thread->resched == false);
+	lw_thread = spdk_thread_get_ctx(thread[2]);
+	CU_ASSERT(lw_thread->resched == false);
+
+	/* Load is measured from the steal on, so the same cores are not picked again */
+	CU_ASSERT(steal(&src_lcore, &dst_lcore) == false);
+
+	_reactor_run(reactor);
+	CU_ASSERT(reactor->thread_count == 2);
+	reactor = spdk_reactor_get(1);
+	MOCK_SET(spdk_env_get_current_core, 1);
+	CU_ASSERT(event_queue_run_batch(reactor) == 1);
+	CU_ASSERT(TAILQ_FIRST(&reactor->threads) == spdk_thread_get_ctx(thread[1]));
+
+	g_scheduler_work_stealing = false;
+	g_reactor_state = SPDK_REACTOR_STATE_INITIALIZED;
+
+	/* Destroy threads */
+	for (i = 0; i < 2; i++) {
+		reactor = spdk_reactor_get(i);
+		MOCK_SET(spdk_env_get_current_core, i);
+		reactor_run(reactor);
+	}
+
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_get_ticks);
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+
+	free_cores();
+}
+
 uint8_t g_curr_freq;
 
 static int
@@ -954,6 +1157,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_for_each_reactor);
 	CU_ADD_TEST(suite, test_reactor_stats);
 	CU_ADD_TEST(suite, test_scheduler);
+	CU_ADD_TEST(suite, test_scheduler_bin_packing);
+	CU_ADD_TEST(suite, test_scheduler_steal);
 	CU_ADD_TEST(suite, test_governor);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
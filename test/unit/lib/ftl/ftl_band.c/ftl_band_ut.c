@@ -110,6 +110,9 @@ DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_i
 DEFINE_STUB(ftl_l2p_get, ftl_addr, (struct spdk_ftl_dev *dev, uint64_t lba), 0);
 DEFINE_STUB_V(ftl_writer_run, (struct ftl_writer *writer));
 DEFINE_STUB(ftl_writer_is_halted, bool, (struct ftl_writer *writer), true);
+DEFINE_STUB_V(ftl_reloc, (struct ftl_reloc *reloc));
+DEFINE_STUB_V(ftl_reloc_halt, (struct ftl_reloc *reloc));
+DEFINE_STUB(ftl_reloc_is_halted, bool, (const struct ftl_reloc *reloc), true);
 
 static void
 setup_band(void)
@@ -0,0 +1,415 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_l2p_cache.c"
+
+#define TEST_LBAS_IN_PAGE	(FTL_BLOCK_SIZE / sizeof(uint64_t))
+#define TEST_NUM_PAGES		512
+#define TEST_NUM_LBAS		(TEST_NUM_PAGES * TEST_LBAS_IN_PAGE)
+#define TEST_MAX_IOS		1024
+
+struct test_io {
+	struct ftl_md_io_entry_ctx *ctx;
+	bool write;
+};
+
+static struct spdk_ftl_dev *g_dev;
+static struct ftl_layout_region g_region;
+static struct ftl_md g_md;
+static uint64_t *g_nvc;
+static struct test_io g_ios[TEST_MAX_IOS];
+static uint64_t g_num_ios;
+static uint64_t g_num_reads;
+static uint64_t g_num_writes;
+static uint64_t g_num_pins_completed;
+static int g_l2p_cb_status;
+static uint64_t g_num_l2p_cb;
+
+static void
+queue_io(struct ftl_md *md, uint64_t start_entry, void *buffer, ftl_md_io_entry_cb cb,
+	 void *cb_arg, struct ftl_md_io_entry_ctx *ctx, bool write)
+{
+	SPDK_CU_ASSERT_FATAL(md == &g_md);
+	SPDK_CU_ASSERT_FATAL(start_entry < TEST_NUM_PAGES);
+	SPDK_CU_ASSERT_FATAL(g_num_ios < TEST_MAX_IOS);
+
+	ctx->cb = cb;
+	ctx->cb_arg = cb_arg;
+	ctx->md = md;
+	ctx->start_entry = start_entry;
+	ctx->buffer = buffer;
+
+	g_ios[g_num_ios].ctx = ctx;
+	g_ios[g_num_ios].write = write;
+	g_num_ios++;
+}
+
+void
+ftl_md_read_entry(struct ftl_md *md, uint64_t start_entry, void *buffer, void *vss_buffer,
+		  ftl_md_io_entry_cb cb, void *cb_arg, struct ftl_md_io_entry_ctx *ctx)
+{
+	queue_io(md, start_entry, buffer, cb, cb_arg, ctx, false);
+	g_num_reads++;
+}
+
+void
+ftl_md_persist_entry(struct ftl_md *md, uint64_t start_entry, void *buffer, void *vss_buffer,
+		     ftl_md_io_entry_cb cb, void *cb_arg, struct ftl_md_io_entry_ctx *ctx)
+{
+	queue_io(md, start_entry, buffer, cb, cb_arg, ctx, true);
+	g_num_writes++;
+}
+
+void
+ftl_md_clear(struct ftl_md *md, int pattern, union ftl_md_vss *vss_pattern)
+{
+	memset(g_nvc, pattern, TEST_NUM_PAGES * FTL_BLOCK_SIZE);
+	md->cb(g_dev, md, 0);
+}
+
+void
+ftl_l2p_pin_complete(struct spdk_ftl_dev *dev, int status, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	CU_ASSERT_EQUAL(status, 0);
+	g_num_pins_completed++;
+}
+
+static void
+complete_ios(void)
+{
+	struct ftl_md_io_entry_ctx *ctx;
+	uint64_t i, num_ios;
+	void *page;
+
+	/* Completions may queue more IOs */
+	while (g_num_ios) {
+		num_ios = g_num_ios;
+		g_num_ios = 0;
+
+		for (i = 0; i < num_ios; i++) {
+			ctx = g_ios[i].ctx;
+			page = (char *)g_nvc + ctx->start_entry * FTL_BLOCK_SIZE;
+
+			if (g_ios[i].write) {
+				memcpy(page, ctx->buffer, FTL_BLOCK_SIZE);
+			} else {
+				memcpy(ctx->buffer, page, FTL_BLOCK_SIZE);
+			}
+			ctx->cb(0, ctx->cb_arg);
+		}
+	}
+}
+
+static void
+l2p_cb(struct spdk_ftl_dev *dev, int status, void *ctx)
+{
+	g_l2p_cb_status = status;
+	g_num_l2p_cb++;
+}
+
+static void
+pin(uint64_t lba, uint64_t count, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	pin_ctx->lba = lba;
+	pin_ctx->count = count;
+	ftl_l2p_cache_pin(g_dev, pin_ctx);
+}
+
+static void
+setup_cache(size_t dram_limit)
+{
+	uint64_t i;
+
+	g_dev = calloc(1, sizeof(*g_dev));
+	SPDK_CU_ASSERT_FATAL(g_dev != NULL);
+
+	g_dev->num_lbas = TEST_NUM_LBAS;
+	g_dev->conf.l2p_dram_limit = dram_limit;
+	g_dev->layout.l2p.addr_size = sizeof(uint64_t);
+	g_dev->layout.l2p.lbas_in_page = TEST_LBAS_IN_PAGE;
+
+	memset(&g_region, 0, sizeof(g_region));
+	g_region.entry_size = 1;
+	g_region.num_entries = TEST_NUM_PAGES;
+	memset(&g_md, 0, sizeof(g_md));
+	g_md.region = &g_region;
+	g_dev->layout.md[FTL_LAYOUT_REGION_TYPE_L2P] = &g_md;
+
+	g_nvc = calloc(TEST_NUM_LBAS, sizeof(uint64_t));
+	SPDK_CU_ASSERT_FATAL(g_nvc != NULL);
+	for (i = 0; i < TEST_NUM_LBAS; i++) {
+		g_nvc[i] = i * 2;
+	}
+
+	g_num_ios = 0;
+	g_num_reads = 0;
+	g_num_writes = 0;
+	g_num_pins_completed = 0;
+	g_num_l2p_cb = 0;
+	g_l2p_cb_status = -1;
+}
+
+static void
+cleanup_cache(void)
+{
+	ftl_l2p_cache_deinit(g_dev);
+	free(g_nvc);
+	free(g_dev);
+}
+
+static void
+test_init(void)
+{
+	struct ftl_l2p_cache *cache;
+
+	/* 1MiB can't hold the minimum number of pages */
+	setup_cache(1);
+	CU_ASSERT_NOT_EQUAL(ftl_l2p_cache_init(g_dev), 0);
+	CU_ASSERT_PTR_NULL(g_dev->l2p);
+	cleanup_cache();
+
+	setup_cache(2);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_init(g_dev), 0);
+	cache = g_dev->l2p;
+	SPDK_CU_ASSERT_FATAL(cache != NULL);
+	CU_ASSERT_EQUAL(cache->num_pages, TEST_NUM_PAGES);
+	CU_ASSERT(cache->max_pages >= FTL_L2P_CACHE_MIN_PAGES);
+	CU_ASSERT(cache->max_pages < TEST_NUM_PAGES);
+	CU_ASSERT_EQUAL(cache->num_free, cache->max_pages);
+	CU_ASSERT(cache->evict_threshold > 0);
+
+	/* Clear invalidates all the entries on the device */
+	ftl_l2p_cache_clear(g_dev, l2p_cb, NULL);
+	CU_ASSERT_EQUAL(g_num_l2p_cb, 1);
+	CU_ASSERT_EQUAL(g_l2p_cb_status, 0);
+	CU_ASSERT_EQUAL(g_nvc[0], FTL_ADDR_INVALID);
+	CU_ASSERT_EQUAL(g_nvc[TEST_NUM_LBAS - 1], FTL_ADDR_INVALID);
+	cleanup_cache();
+
+	/* The cache never holds more pages than the L2P has */
+	setup_cache(1024);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_init(g_dev), 0);
+	cache = g_dev->l2p;
+	SPDK_CU_ASSERT_FATAL(cache != NULL);
+	CU_ASSERT_EQUAL(cache->max_pages, TEST_NUM_PAGES);
+	cleanup_cache();
+}
+
+static void
+test_pin_page_in(void)
+{
+	struct ftl_l2p_pin_ctx pin_ctx, pin_ctx2;
+	struct ftl_l2p_cache *cache;
+	uint64_t lba = TEST_LBAS_IN_PAGE - 2;
+	ftl_addr addr;
+
+	setup_cache(2);
+	SPDK_CU_ASSERT_FATAL(ftl_l2p_cache_init(g_dev) == 0);
+	cache = g_dev->l2p;
+
+	CU_ASSERT_FALSE(ftl_l2p_cache_peek(g_dev, lba, &addr));
+
+	/* The range spans two pages, both need to be read first */
+	pin(lba, 4, &pin_ctx);
+	CU_ASSERT_EQUAL(g_num_pins_completed, 0);
+	CU_ASSERT_EQUAL(g_num_reads, 2);
+	CU_ASSERT_EQUAL(cache->num_free, cache->max_pages - 2);
+	CU_ASSERT_FALSE(ftl_l2p_cache_peek(g_dev, lba, &addr));
+
+	complete_ios();
+	CU_ASSERT_EQUAL(g_num_pins_completed, 1);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_get(g_dev, lba), lba * 2);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_get(g_dev, lba + 3), (lba + 3) * 2);
+
+	ftl_l2p_cache_set(g_dev, lba + 3, 7);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_get(g_dev, lba + 3), 7);
+	CU_ASSERT_EQUAL(cache->page_map[0]->updates, 0);
+	CU_ASSERT_EQUAL(cache->page_map[1]->updates, 1);
+
+	/* Resident pages are pinned right away */
+	pin(lba + 2, 1, &pin_ctx2);
+	CU_ASSERT_EQUAL(g_num_pins_completed, 2);
+	CU_ASSERT_EQUAL(g_num_reads, 2);
+	CU_ASSERT_EQUAL(cache->page_map[1]->pin_ref_cnt, 2);
+
+	ftl_l2p_cache_unpin(g_dev, lba, 4);
+	CU_ASSERT_TRUE(cache->page_map[0]->on_lru);
+	CU_ASSERT_FALSE(cache->page_map[1]->on_lru);
+	ftl_l2p_cache_unpin(g_dev, lba + 2, 1);
+	CU_ASSERT_TRUE(cache->page_map[1]->on_lru);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&cache->lru), cache->page_map[1]);
+
+	/* Unpinned lookups are allowed on resident pages */
+	CU_ASSERT_TRUE(ftl_l2p_cache_peek(g_dev, lba + 3, &addr));
+	CU_ASSERT_EQUAL(addr, 7);
+
+	/* Nothing was written back yet */
+	CU_ASSERT_EQUAL(g_num_writes, 0);
+	CU_ASSERT_EQUAL(g_nvc[lba + 3], (lba + 3) * 2);
+
+	CU_ASSERT_TRUE(ftl_l2p_cache_is_halted(g_dev));
+	cleanup_cache();
+}
+
+static void
+test_evict(void)
+{
+	struct ftl_l2p_pin_ctx pin_ctx;
+	struct ftl_l2p_cache *cache;
+	uint64_t i, max_pages;
+
+	setup_cache(2);
+	SPDK_CU_ASSERT_FATAL(ftl_l2p_cache_init(g_dev) == 0);
+	cache = g_dev->l2p;
+	max_pages = cache->max_pages;
+
+	/* Fill the whole cache, the first page is the least recently used and dirty */
+	for (i = 0; i < max_pages; i++) {
+		pin(i * TEST_LBAS_IN_PAGE, 1, &pin_ctx);
+		complete_ios();
+		if (i == 0) {
+			ftl_l2p_cache_set(g_dev, 0, 3);
+		}
+		ftl_l2p_cache_unpin(g_dev, i * TEST_LBAS_IN_PAGE, 1);
+	}
+	CU_ASSERT_EQUAL(g_num_pins_completed, max_pages);
+	CU_ASSERT_EQUAL(cache->num_free, 0);
+
+	/* No free pages left, the pin has to wait for the eviction */
+	pin(max_pages * TEST_LBAS_IN_PAGE, 1, &pin_ctx);
+	CU_ASSERT_EQUAL(g_num_pins_completed, max_pages);
+	CU_ASSERT_FALSE(TAILQ_EMPTY(&cache->deferred_pins));
+	CU_ASSERT_FALSE(ftl_l2p_cache_is_halted(g_dev));
+
+	/* The dirty page is written back, clean ones are dropped right away */
+	ftl_l2p_cache_process(g_dev);
+	CU_ASSERT_EQUAL(g_num_writes, 1);
+	CU_ASSERT_TRUE(cache->page_map[0]->flushing);
+	CU_ASSERT_PTR_NULL(cache->page_map[1]);
+	CU_ASSERT_EQUAL(cache->num_free + cache->flush_qd, cache->evict_threshold);
+	CU_ASSERT(TAILQ_EMPTY(&cache->deferred_pins));
+	CU_ASSERT_PTR_NOT_NULL(cache->page_map[max_pages]);
+
+	complete_ios();
+	CU_ASSERT_EQUAL(g_num_pins_completed, max_pages + 1);
+	CU_ASSERT_EQUAL(g_nvc[0], 3);
+	CU_ASSERT_PTR_NULL(cache->page_map[0]);
+	CU_ASSERT_EQUAL(cache->num_free, cache->evict_threshold);
+
+	/* Evicted page is read back with the updated entry */
+	ftl_l2p_cache_unpin(g_dev, max_pages * TEST_LBAS_IN_PAGE, 1);
+	pin(0, 1, &pin_ctx);
+	complete_ios();
+	CU_ASSERT_EQUAL(ftl_l2p_cache_get(g_dev, 0), 3);
+	ftl_l2p_cache_unpin(g_dev, 0, 1);
+
+	CU_ASSERT_TRUE(ftl_l2p_cache_is_halted(g_dev));
+	cleanup_cache();
+}
+
+static void
+test_flush_while_pinned(void)
+{
+	struct ftl_l2p_pin_ctx pin_ctx;
+	struct ftl_l2p_cache *cache;
+	struct ftl_l2p_page *page;
+
+	setup_cache(2);
+	SPDK_CU_ASSERT_FATAL(ftl_l2p_cache_init(g_dev) == 0);
+	cache = g_dev->l2p;
+
+	pin(0, 1, &pin_ctx);
+	complete_ios();
+	ftl_l2p_cache_set(g_dev, 0, 3);
+	ftl_l2p_cache_unpin(g_dev, 0, 1);
+
+	page = cache->page_map[0];
+	l2p_cache_lru_remove(cache, page);
+	l2p_cache_page_flush(cache, page);
+	CU_ASSERT_EQUAL(g_num_writes, 1);
+
+	/* The page is pinned and updated while being written back */
+	pin(0, 1, &pin_ctx);
+	CU_ASSERT_EQUAL(g_num_pins_completed, 2);
+	ftl_l2p_cache_set(g_dev, 1, 5);
+	ftl_l2p_cache_unpin(g_dev, 0, 1);
+	CU_ASSERT_FALSE(page->on_lru);
+
+	complete_ios();
+	CU_ASSERT_EQUAL(g_nvc[0], 3);
+	CU_ASSERT_EQUAL(cache->page_map[0], page);
+	CU_ASSERT_EQUAL(page->updates, 1);
+	CU_ASSERT_TRUE(page->on_lru);
+
+	cleanup_cache();
+}
+
+static void
+test_persist(void)
+{
+	struct ftl_l2p_pin_ctx pin_ctx;
+	struct ftl_l2p_cache *cache;
+
+	setup_cache(2);
+	SPDK_CU_ASSERT_FATAL(ftl_l2p_cache_init(g_dev) == 0);
+	cache = g_dev->l2p;
+
+	pin(3 * TEST_LBAS_IN_PAGE, TEST_LBAS_IN_PAGE + 1, &pin_ctx);
+	complete_ios();
+	ftl_l2p_cache_set(g_dev, 3 * TEST_LBAS_IN_PAGE, 11);
+	ftl_l2p_cache_set(g_dev, 4 * TEST_LBAS_IN_PAGE, 12);
+	ftl_l2p_cache_unpin(g_dev, 3 * TEST_LBAS_IN_PAGE, TEST_LBAS_IN_PAGE + 1);
+
+	/* Clean page doesn't need to be written */
+	pin(5 * TEST_LBAS_IN_PAGE, 1, &pin_ctx);
+	complete_ios();
+	ftl_l2p_cache_unpin(g_dev, 5 * TEST_LBAS_IN_PAGE, 1);
+
+	ftl_l2p_cache_halt(g_dev);
+	CU_ASSERT_TRUE(ftl_l2p_cache_is_halted(g_dev));
+
+	ftl_l2p_cache_persist(g_dev, l2p_cb, NULL);
+	CU_ASSERT_EQUAL(g_num_writes, 2);
+	CU_ASSERT_EQUAL(g_num_l2p_cb, 0);
+
+	complete_ios();
+	CU_ASSERT_EQUAL(g_num_l2p_cb, 1);
+	CU_ASSERT_EQUAL(g_l2p_cb_status, 0);
+	CU_ASSERT_EQUAL(g_nvc[3 * TEST_LBAS_IN_PAGE], 11);
+	CU_ASSERT_EQUAL(g_nvc[4 * TEST_LBAS_IN_PAGE], 12);
+	CU_ASSERT_EQUAL(cache->flush_qd, 0);
+
+	cleanup_cache();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_l2p_cache_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_init);
+	CU_ADD_TEST(suite, test_pin_page_in);
+	CU_ADD_TEST(suite, test_evict);
+	CU_ADD_TEST(suite, test_flush_while_pinned);
+	CU_ADD_TEST(suite, test_persist);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,561 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_reloc.c"
+
+#define TEST_XFER_SIZE		16
+#define TEST_BLOCKS_IN_BAND	80
+#define TEST_USER_BLOCKS	64
+#define TEST_NUM_LBAS		4096
+#define TEST_MAX_QDEPTH		4
+#define TEST_NUM_BANDS		3
+#define TEST_MAX_READS		32
+#define TEST_WRITE_ADDR		5000
+
+static struct spdk_ftl_dev *g_dev;
+static struct ftl_band g_bands[TEST_NUM_BANDS];
+static struct ftl_band_md g_band_md[TEST_NUM_BANDS];
+static uint64_t *g_p2l;
+static ftl_addr g_l2p[TEST_NUM_LBAS];
+static struct ftl_rq *g_reads[TEST_MAX_READS];
+static uint64_t g_num_reads;
+static uint64_t g_num_read_blocks;
+static int64_t g_num_pinned;
+static uint64_t g_num_moved;
+static struct ftl_band *g_freed_band;
+static enum ftl_md_status g_tail_md_status;
+static uint64_t g_fail_read_idx;
+
+DEFINE_STUB_V(ftl_rq_unpin, (struct ftl_rq *rq));
+
+size_t
+ftl_band_user_blocks(const struct ftl_band *band)
+{
+	return TEST_USER_BLOCKS;
+}
+
+ftl_addr
+ftl_band_addr_from_block_offset(struct ftl_band *band, uint64_t block_off)
+{
+	return band->start_addr + block_off;
+}
+
+uint64_t
+ftl_band_block_offset_from_addr(struct ftl_band *band, ftl_addr addr)
+{
+	return addr - band->start_addr;
+}
+
+ftl_addr
+ftl_band_next_addr(struct ftl_band *band, ftl_addr addr, size_t offset)
+{
+	return addr + offset;
+}
+
+int
+ftl_band_alloc_p2l_map(struct ftl_band *band)
+{
+	CU_ASSERT_EQUAL(band->p2l_map.ref_cnt, 0);
+	band->p2l_map.band_map = g_p2l;
+	band->p2l_map.ref_cnt = 1;
+	return 0;
+}
+
+void
+ftl_band_release_p2l_map(struct ftl_band *band)
+{
+	CU_ASSERT_EQUAL(band->p2l_map.ref_cnt, 1);
+	band->p2l_map.band_map = NULL;
+	band->p2l_map.ref_cnt = 0;
+}
+
+void
+ftl_band_free(struct ftl_band *band)
+{
+	g_freed_band = band;
+}
+
+void
+ftl_band_read_tail_brq_md(struct ftl_band *band, ftl_band_md_cb cb, void *cntx)
+{
+	cb(band, cntx, g_tail_md_status);
+}
+
+void
+ftl_band_rq_read(struct ftl_band *band, struct ftl_rq *rq)
+{
+	uint64_t i;
+
+	/* Reads are always issued for contiguous runs of blocks */
+	for (i = 1; i < rq->iter.count; i++) {
+		CU_ASSERT_EQUAL(rq->entries[rq->iter.idx + i].addr,
+				rq->entries[rq->iter.idx].addr + i);
+	}
+	CU_ASSERT_EQUAL(band->md->iter.addr, rq->entries[rq->iter.idx].addr);
+
+	SPDK_CU_ASSERT_FATAL(g_num_reads < TEST_MAX_READS);
+	g_reads[g_num_reads++] = rq;
+	g_num_read_blocks += rq->iter.count;
+}
+
+ftl_addr
+ftl_l2p_get(struct spdk_ftl_dev *dev, uint64_t lba)
+{
+	SPDK_CU_ASSERT_FATAL(lba < TEST_NUM_LBAS);
+	return g_l2p[lba];
+}
+
+bool
+ftl_l2p_peek(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr *addr)
+{
+	*addr = ftl_l2p_get(dev, lba);
+	return true;
+}
+
+void
+ftl_l2p_pin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_cb cb, void *cb_ctx,
+	    struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	pin_ctx->lba = lba;
+	pin_ctx->count = count;
+	pin_ctx->cb = cb;
+	pin_ctx->cb_ctx = cb_ctx;
+	g_num_pinned += count;
+	cb(dev, 0, pin_ctx);
+}
+
+void
+ftl_l2p_pin_skip(struct spdk_ftl_dev *dev, ftl_l2p_pin_cb cb, void *cb_ctx,
+		 struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	pin_ctx->lba = FTL_LBA_INVALID;
+	pin_ctx->count = 0;
+	pin_ctx->cb = cb;
+	pin_ctx->cb_ctx = cb_ctx;
+	cb(dev, 0, pin_ctx);
+}
+
+void
+ftl_l2p_unpin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count)
+{
+	g_num_pinned -= count;
+	CU_ASSERT(g_num_pinned >= 0);
+}
+
+void
+ftl_l2p_update_base(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr new_addr, ftl_addr old_addr)
+{
+	CU_ASSERT_EQUAL(g_l2p[lba], old_addr);
+	g_l2p[lba] = new_addr;
+	g_bands[0].p2l_map.num_valid--;
+	g_num_moved++;
+}
+
+struct ftl_rq *
+ftl_rq_new(struct spdk_ftl_dev *dev, uint32_t io_md_size)
+{
+	struct ftl_rq *rq;
+
+	rq = calloc(1, sizeof(*rq) + sizeof(rq->entries[0]) * dev->xfer_size);
+	SPDK_CU_ASSERT_FATAL(rq != NULL);
+	rq->dev = dev;
+	rq->num_blocks = dev->xfer_size;
+
+	return rq;
+}
+
+void
+ftl_rq_del(struct ftl_rq *rq)
+{
+	free(rq);
+}
+
+static void
+setup_reloc(void)
+{
+	struct ftl_band *band;
+	uint64_t i;
+
+	g_dev = calloc(1, sizeof(*g_dev));
+	SPDK_CU_ASSERT_FATAL(g_dev != NULL);
+	g_dev->sb = calloc(1, sizeof(*g_dev->sb));
+	SPDK_CU_ASSERT_FATAL(g_dev->sb != NULL);
+
+	g_dev->sb->max_reloc_qdepth = TEST_MAX_QDEPTH;
+	g_dev->xfer_size = TEST_XFER_SIZE;
+	g_dev->num_blocks_in_band = TEST_BLOCKS_IN_BAND;
+	g_dev->num_lbas = TEST_NUM_LBAS;
+	g_dev->limit = SPDK_FTL_LIMIT_MAX;
+	g_dev->band_close_seq_id = TEST_NUM_BANDS;
+	TAILQ_INIT(&g_dev->shut_bands);
+	TAILQ_INIT(&g_dev->writer_gc.rq_queue);
+
+	memset(g_bands, 0, sizeof(g_bands));
+	memset(g_band_md, 0, sizeof(g_band_md));
+	for (i = 0; i < TEST_NUM_BANDS; i++) {
+		band = &g_bands[i];
+		band->dev = g_dev;
+		band->id = i;
+		band->md = &g_band_md[i];
+		band->md->state = FTL_BAND_STATE_CLOSED;
+		band->md->close_seq_id = i + 1;
+		band->start_addr = i * TEST_BLOCKS_IN_BAND;
+		band->p2l_map.num_valid = TEST_USER_BLOCKS;
+		TAILQ_INSERT_TAIL(&g_dev->shut_bands, band, queue_entry);
+	}
+
+	g_p2l = calloc(ftl_tail_md_num_blocks(g_dev), FTL_BLOCK_SIZE);
+	SPDK_CU_ASSERT_FATAL(g_p2l != NULL);
+
+	for (i = 0; i < TEST_NUM_LBAS; i++) {
+		g_l2p[i] = FTL_ADDR_INVALID;
+	}
+
+	g_dev->reloc = ftl_reloc_init(g_dev);
+	SPDK_CU_ASSERT_FATAL(g_dev->reloc != NULL);
+	ftl_reloc_resume(g_dev->reloc);
+
+	g_num_reads = 0;
+	g_num_read_blocks = 0;
+	g_num_pinned = 0;
+	g_num_moved = 0;
+	g_freed_band = NULL;
+	g_tail_md_status = FTL_MD_SUCCESS;
+	g_fail_read_idx = UINT64_MAX;
+}
+
+static void
+cleanup_reloc(void)
+{
+	ftl_reloc_free(g_dev->reloc);
+	free(g_p2l);
+	free(g_dev->sb);
+	free(g_dev);
+}
+
+/* Fills the P2L map of band 0 - each block holds LBA equal to its offset and
+ * blocks 0-9, 20-29 and 40 are still pointed to by the L2P
+ */
+static void
+setup_victim(void)
+{
+	struct ftl_band *band = &g_bands[0];
+	uint64_t i;
+
+	band->p2l_map.num_valid = 0;
+	for (i = 0; i < TEST_USER_BLOCKS; i++) {
+		g_p2l[i] = i;
+		if (i < 10 || (i >= 20 && i < 30) || i == 40) {
+			g_l2p[i] = band->start_addr + i;
+			band->p2l_map.num_valid++;
+		} else {
+			g_l2p[i] = TEST_NUM_LBAS + i;
+		}
+	}
+
+	band->md->p2l_map_checksum = spdk_crc32c_update(g_p2l, ftl_tail_md_num_blocks(g_dev) *
+				     FTL_BLOCK_SIZE, 0);
+
+	/* Make band 0 the oldest and the only one which isn't fully valid */
+	band->md->close_seq_id = 1;
+}
+
+static void
+complete_reads(void)
+{
+	uint64_t i, num_reads = g_num_reads;
+
+	g_num_reads = 0;
+	for (i = 0; i < num_reads; i++) {
+		g_reads[i]->success = i != g_fail_read_idx;
+		g_reads[i]->owner.cb(g_reads[i]);
+	}
+}
+
+static uint64_t
+complete_writes(void)
+{
+	struct ftl_rq *rq;
+	uint64_t num_writes = 0;
+
+	while ((rq = TAILQ_FIRST(&g_dev->writer_gc.rq_queue))) {
+		TAILQ_REMOVE(&g_dev->writer_gc.rq_queue, rq, qentry);
+		rq->io.band = &g_bands[TEST_NUM_BANDS - 1];
+		rq->io.addr = TEST_WRITE_ADDR + num_writes * TEST_XFER_SIZE;
+		rq->success = true;
+		rq->owner.cb(rq);
+		num_writes++;
+	}
+
+	return num_writes;
+}
+
+static void
+test_band_score(void)
+{
+	struct ftl_band *band = &g_bands[0];
+	uint64_t score_young, score_old;
+
+	setup_reloc();
+
+	/* Empty band is always the best candidate, full band is never relocated */
+	band->p2l_map.num_valid = 0;
+	CU_ASSERT_EQUAL(ftl_reloc_band_score(band, 1), UINT64_MAX);
+	band->p2l_map.num_valid = TEST_USER_BLOCKS;
+	CU_ASSERT_EQUAL(ftl_reloc_band_score(band, 1), 0);
+
+	/* Older data scores higher at the same utilization */
+	band->p2l_map.num_valid = TEST_USER_BLOCKS / 2;
+	band->md->close_seq_id = 10;
+	score_young = ftl_reloc_band_score(band, 10);
+	score_old = ftl_reloc_band_score(band, 20);
+	CU_ASSERT(score_old > score_young);
+
+	/* Less utilized band scores higher at the same age */
+	band->p2l_map.num_valid = TEST_USER_BLOCKS / 4;
+	CU_ASSERT(ftl_reloc_band_score(band, 10) > score_young);
+
+	cleanup_reloc();
+}
+
+static void
+test_select_band(void)
+{
+	struct ftl_reloc *reloc;
+
+	setup_reloc();
+	reloc = g_dev->reloc;
+
+	g_bands[0].p2l_map.num_valid = TEST_USER_BLOCKS / 2;
+	g_bands[1].p2l_map.num_valid = TEST_USER_BLOCKS / 4;
+	g_bands[2].p2l_map.num_valid = TEST_USER_BLOCKS / 4;
+
+	/* Band 1 is less utilized than band 0 and older than band 2 */
+	CU_ASSERT_EQUAL(reloc_select_band(reloc), &g_bands[1]);
+
+	/* Much older band wins even with higher utilization */
+	g_dev->band_close_seq_id = 100;
+	g_bands[1].md->close_seq_id = 90;
+	g_bands[2].md->close_seq_id = 95;
+	CU_ASSERT_EQUAL(reloc_select_band(reloc), &g_bands[0]);
+
+	/* Closing bands are skipped */
+	g_bands[0].md->state = FTL_BAND_STATE_CLOSING;
+	CU_ASSERT_EQUAL(reloc_select_band(reloc), &g_bands[1]);
+
+	/* Empty band is picked right away */
+	g_bands[2].p2l_map.num_valid = 0;
+	CU_ASSERT_EQUAL(reloc_select_band(reloc), &g_bands[2]);
+
+	/* No relocation while there's enough free bands */
+	g_dev->limit = SPDK_FTL_LIMIT_MAX;
+	ftl_reloc(reloc);
+	CU_ASSERT_PTR_NULL(reloc->band);
+
+	cleanup_reloc();
+}
+
+static void
+test_relocate_band(void)
+{
+	struct ftl_reloc *reloc;
+	struct ftl_band *band = &g_bands[0];
+
+	setup_reloc();
+	reloc = g_dev->reloc;
+	setup_victim();
+
+	g_dev->limit = SPDK_FTL_LIMIT_HIGH;
+	ftl_reloc(reloc);
+
+	/* Band is taken off the shut list and all valid blocks are read in contiguous runs */
+	CU_ASSERT_EQUAL(reloc->band, band);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_dev->shut_bands), &g_bands[1]);
+	CU_ASSERT_EQUAL(reloc->offset, TEST_USER_BLOCKS);
+	CU_ASSERT_EQUAL(reloc->num_active, 2);
+	CU_ASSERT_EQUAL(g_num_reads, 4);
+	CU_ASSERT_EQUAL(g_num_read_blocks, 21);
+
+	/* User overwrites LBA 27 while it's being read */
+	g_l2p[27] = TEST_NUM_LBAS;
+	band->p2l_map.num_valid--;
+
+	complete_reads();
+	CU_ASSERT_EQUAL(g_num_pinned, 20);
+	CU_ASSERT_EQUAL(complete_writes(), 2);
+	CU_ASSERT_EQUAL(g_num_pinned, 0);
+	CU_ASSERT_EQUAL(g_num_moved, 20);
+	CU_ASSERT_EQUAL(reloc->num_active, 0);
+
+	/* Moved blocks are written sequentially through the GC writer */
+	CU_ASSERT_EQUAL(g_l2p[0], TEST_WRITE_ADDR);
+	CU_ASSERT_EQUAL(g_l2p[25], TEST_WRITE_ADDR + 15);
+	CU_ASSERT_EQUAL(g_l2p[26], TEST_WRITE_ADDR + TEST_XFER_SIZE);
+	CU_ASSERT_EQUAL(g_l2p[27], TEST_NUM_LBAS);
+	CU_ASSERT_EQUAL(g_l2p[40], TEST_WRITE_ADDR + TEST_XFER_SIZE + 4);
+
+	/* Nothing valid is left, band is freed */
+	CU_ASSERT_EQUAL(band->p2l_map.num_valid, 0);
+	ftl_reloc(reloc);
+	CU_ASSERT_EQUAL(g_freed_band, band);
+	CU_ASSERT_PTR_NULL(reloc->band);
+
+	cleanup_reloc();
+}
+
+static void
+test_halt(void)
+{
+	struct ftl_reloc *reloc;
+	struct ftl_band *band = &g_bands[0];
+
+	setup_reloc();
+	reloc = g_dev->reloc;
+	setup_victim();
+
+	/* Single move in flight */
+	g_dev->limit = SPDK_FTL_LIMIT_START;
+	ftl_reloc(reloc);
+	CU_ASSERT_EQUAL(reloc->band, band);
+	CU_ASSERT_EQUAL(reloc->num_active, 1);
+	CU_ASSERT(reloc->offset < TEST_USER_BLOCKS);
+
+	ftl_reloc_halt(reloc);
+	ftl_reloc(reloc);
+	CU_ASSERT(!ftl_reloc_is_halted(reloc));
+
+	complete_reads();
+	CU_ASSERT_EQUAL(complete_writes(), 1);
+	CU_ASSERT(!ftl_reloc_is_halted(reloc));
+
+	/* Partially relocated band goes back to the shut list */
+	ftl_reloc(reloc);
+	CU_ASSERT(ftl_reloc_is_halted(reloc));
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_dev->shut_bands), band);
+	CU_ASSERT_EQUAL(band->p2l_map.ref_cnt, 0);
+	CU_ASSERT_PTR_NULL(g_freed_band);
+	CU_ASSERT_EQUAL(band->p2l_map.num_valid, 21 - 16);
+
+	cleanup_reloc();
+}
+
+static void
+test_read_errors(void)
+{
+	struct ftl_reloc *reloc;
+	struct ftl_band *band = &g_bands[0];
+
+	setup_reloc();
+	reloc = g_dev->reloc;
+	setup_victim();
+
+	/* Band whose P2L map can't be read is put back on the shut list */
+	g_dev->limit = SPDK_FTL_LIMIT_HIGH;
+	g_tail_md_status = FTL_MD_IO_FAILURE;
+	ftl_reloc(reloc);
+	CU_ASSERT_PTR_NULL(reloc->band);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_dev->shut_bands), band);
+	CU_ASSERT_EQUAL(band->p2l_map.ref_cnt, 0);
+	CU_ASSERT_EQUAL(g_num_reads, 0);
+
+	/* And picked again on the next poll */
+	g_tail_md_status = FTL_MD_SUCCESS;
+	ftl_reloc(reloc);
+	CU_ASSERT_EQUAL(reloc->band, band);
+	CU_ASSERT_EQUAL(reloc->num_active, 2);
+	CU_ASSERT_EQUAL(g_num_reads, 4);
+	CU_ASSERT_EQUAL(g_num_read_blocks, 21);
+
+	/* The second read of the first move (LBAs 10-15) fails, the whole move is read again */
+	g_fail_read_idx = 1;
+	complete_reads();
+	g_fail_read_idx = UINT64_MAX;
+	CU_ASSERT_EQUAL(g_num_pinned, 5);
+	CU_ASSERT_EQUAL(g_num_reads, 2);
+	CU_ASSERT_EQUAL(g_num_read_blocks, 21 + 16);
+
+	complete_reads();
+	CU_ASSERT_EQUAL(g_num_pinned, 21);
+	CU_ASSERT_EQUAL(complete_writes(), 2);
+	CU_ASSERT_EQUAL(g_num_pinned, 0);
+	CU_ASSERT_EQUAL(g_num_moved, 21);
+	CU_ASSERT_EQUAL(reloc->num_active, 0);
+
+	ftl_reloc(reloc);
+	CU_ASSERT_EQUAL(g_freed_band, band);
+
+	cleanup_reloc();
+}
+
+static void
+test_user_write_throttle(void)
+{
+	struct ftl_reloc *reloc;
+
+	setup_reloc();
+	reloc = g_dev->reloc;
+
+	/* Not relocating anything */
+	g_dev->limit = SPDK_FTL_LIMIT_CRIT;
+	CU_ASSERT(ftl_reloc_user_write_allowed(reloc, TEST_XFER_SIZE));
+
+	/* Relocating 3/4 valid band, each moved block earns 1/3 block of user writes */
+	reloc->band = &g_bands[0];
+	reloc->band_valid = TEST_USER_BLOCKS * 3 / 4;
+	CU_ASSERT(!ftl_reloc_user_write_allowed(reloc, 1));
+
+	reloc_add_credit(reloc, 2);
+	CU_ASSERT(!ftl_reloc_user_write_allowed(reloc, 1));
+	reloc_add_credit(reloc, 1);
+	CU_ASSERT(ftl_reloc_user_write_allowed(reloc, 1));
+	CU_ASSERT(!ftl_reloc_user_write_allowed(reloc, 1));
+
+	reloc_add_credit(reloc, 3 * TEST_XFER_SIZE);
+	CU_ASSERT(!ftl_reloc_user_write_allowed(reloc, TEST_XFER_SIZE + 1));
+	CU_ASSERT(ftl_reloc_user_write_allowed(reloc, TEST_XFER_SIZE));
+
+	/* Credit is capped at the size of the band */
+	reloc_add_credit(reloc, 10 * TEST_USER_BLOCKS);
+	CU_ASSERT_EQUAL(reloc->user_credit, TEST_USER_BLOCKS);
+
+	/* Throttling is only applied when running low on free bands */
+	reloc->user_credit = 0;
+	g_dev->limit = SPDK_FTL_LIMIT_START;
+	CU_ASSERT(ftl_reloc_user_write_allowed(reloc, TEST_XFER_SIZE));
+
+	reloc->band = NULL;
+	cleanup_reloc();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_reloc_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_band_score);
+	CU_ADD_TEST(suite, test_select_band);
+	CU_ADD_TEST(suite, test_relocate_band);
+	CU_ADD_TEST(suite, test_halt);
+	CU_ADD_TEST(suite, test_read_errors);
+	CU_ADD_TEST(suite, test_user_write_throttle);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -697,15 +697,26 @@ ut_nvme_tcp_qpair_xfer_complete_cb(void *cb_arg)
 	return;
 }
 
+static void
+ut_submit_accel_crc32c(void *ctx, uint32_t *dst, struct iovec *iov, uint32_t iov_cnt,
+		       uint32_t seed, spdk_nvme_accel_completion_cb cb_fn, void *cb_arg)
+{
+	*dst = spdk_crc32c_iov_update(iov, iov_cnt, ~seed);
+	cb_fn(cb_arg, 0);
+}
+
 static void
 test_nvme_tcp_qpair_write_pdu(void)
 {
 	struct nvme_tcp_qpair tqpair = {};
 	struct spdk_nvme_tcp_stat stats = {};
 	struct nvme_tcp_pdu pdu = {};
+	struct nvme_tcp_poll_group tgroup = {};
+	struct spdk_nvme_poll_group group = {};
 	void *cb_arg = (void *)0xDEADBEEF;
 	char iov_base0[4096];
 	char iov_base1[4096];
+	uint32_t crc32c;
 
 	memset(iov_base0, 0xFF, 4096);
 	memset(iov_base1, 0xFF, 4096);
@@ -781,6 +792,28 @@ test_nvme_tcp_qpair_write_pdu(void)
 	CU_ASSERT(pdu.cb_arg == cb_arg);
 	CU_ASSERT(pdu.qpair == &tqpair);
 	CU_ASSERT(pdu.sock_req.cb_arg == (void *)&pdu);
+
+	/* Test case3: data digest of unaligned data calculated by accel. Expect: PASS */
+	pdu.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	pdu.data_len = 4096 + 1023;
+	pdu.data_iov[1].iov_len = 1023;
+	pdu.hdr.common.plen = pdu.hdr.common.hlen + pdu.data_len + SPDK_NVME_TCP_DIGEST_LEN;
+	tqpair.flags.host_ddgst_enable = 1;
+	tqpair.qpair.poll_group = &tgroup.group;
+	tgroup.group.group = &group;
+	group.accel_fn_table.submit_accel_crc32c = ut_submit_accel_crc32c;
+	nvme_qpair_set_state(&tqpair.qpair, NVME_QPAIR_CONNECTED);
+	memset(pdu.data_digest, 0, SPDK_NVME_TCP_DIGEST_LEN);
+
+	nvme_tcp_qpair_write_pdu(&tqpair,
+				 &pdu,
+				 ut_nvme_tcp_qpair_xfer_complete_cb,
+				 cb_arg);
+	TAILQ_REMOVE(&tqpair.send_queue, &pdu, tailq);
+	crc32c = nvme_tcp_pdu_calc_data_digest(&pdu) ^ SPDK_CRC32C_XOR;
+	CU_ASSERT(MATCH_DIGEST_WORD(pdu.data_digest, crc32c));
+	CU_ASSERT(pdu.sock_req.iovcnt == 4);
+	CU_ASSERT(pdu.iov[3].iov_base == &pdu.data_digest);
 }
 
 static void
@@ -839,6 +839,270 @@ _sock_close(const char *ip, int port, char *impl_name)
 	free(req2);
 }
 
+static void *g_recv_next_buf;
+static void *g_recv_next_ctx;
+static int g_recv_next_rc;
+static int g_recv_next_errno;
+
+static void
+read_data_next(void *cb_arg, struct spdk_sock_group *group, struct spdk_sock *sock)
+{
+	CU_ASSERT(cb_arg == sock);
+
+	g_recv_next_buf = NULL;
+	g_recv_next_ctx = NULL;
+	g_recv_next_rc = spdk_sock_recv_next(sock, &g_recv_next_buf, &g_recv_next_ctx);
+	g_recv_next_errno = errno;
+}
+
+static void
+posix_sock_group_recv_next(void)
+{
+	struct spdk_sock_group *group;
+	struct spdk_sock *listen_sock;
+	struct spdk_sock *server_sock;
+	struct spdk_sock *client_sock;
+	char *test_string = "abcdef";
+	char buf[2][4096];
+	struct iovec iov;
+	void *pbuf, *ctx;
+	int rc;
+
+	listen_sock = spdk_sock_listen("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(listen_sock != NULL);
+
+	client_sock = spdk_sock_connect("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(client_sock != NULL);
+
+	usleep(1000);
+
+	server_sock = spdk_sock_accept(listen_sock);
+	SPDK_CU_ASSERT_FATAL(server_sock != NULL);
+
+	group = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	/* The socket has to be part of a group */
+	rc = spdk_sock_recv_next(server_sock, &pbuf, &ctx);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(errno == EPERM);
+
+	rc = spdk_sock_group_add_sock(group, server_sock, read_data_next, server_sock);
+	CU_ASSERT(rc == 0);
+
+	/* Buffers too small to hold the pool header are rejected */
+	rc = spdk_sock_group_provide_buf(group, buf[0], SPDK_SOCK_GROUP_BUF_MIN_LEN - 1, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	iov.iov_base = test_string;
+	iov.iov_len = 7;
+	rc = spdk_sock_writev(client_sock, &iov, 1);
+	CU_ASSERT(rc == 7);
+
+	usleep(1000);
+
+	/* Nothing in the pool */
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_recv_next_rc == -1);
+	CU_ASSERT(g_recv_next_errno == ENOBUFS);
+
+	rc = spdk_sock_group_provide_buf(group, buf[0], sizeof(buf[0]), &buf[0]);
+	CU_ASSERT(rc == 0);
+	rc = spdk_sock_group_provide_buf(group, buf[1], sizeof(buf[1]), &buf[1]);
+	CU_ASSERT(rc == 0);
+
+	/* The data is received straight into a buffer of the pool */
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_recv_next_rc == 7);
+	SPDK_CU_ASSERT_FATAL(g_recv_next_buf != NULL);
+	CU_ASSERT(g_recv_next_ctx == g_recv_next_buf);
+	CU_ASSERT(memcmp(g_recv_next_buf, test_string, 7) == 0);
+	pbuf = g_recv_next_buf;
+
+	/* The buffer is given back to the pool if the connection is closed */
+	rc = spdk_sock_close(&client_sock);
+	CU_ASSERT(rc == 0);
+
+	usleep(1000);
+
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_recv_next_rc == 0);
+
+	rc = spdk_sock_group_remove_sock(group, server_sock);
+	CU_ASSERT(rc == 0);
+
+	/* The group can't be closed before its pool is drained */
+	rc = spdk_sock_group_close(&group);
+	CU_ASSERT(rc == -1);
+	CU_ASSERT(errno == EBUSY);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	CU_ASSERT(spdk_sock_group_reclaim_buf(group, &g_recv_next_buf, &ctx) == sizeof(buf[0]));
+	CU_ASSERT(g_recv_next_buf != pbuf);
+	CU_ASSERT(ctx == g_recv_next_buf);
+	CU_ASSERT(spdk_sock_group_reclaim_buf(group, &g_recv_next_buf, &ctx) == 0);
+	CU_ASSERT(g_recv_next_buf == NULL);
+
+	rc = spdk_sock_group_close(&group);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_sock_close(&server_sock);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_sock_close(&listen_sock);
+	CU_ASSERT(rc == 0);
+}
+
+static void
+posix_sock_adaptive_recv_pipe(void)
+{
+	struct spdk_sock_group *group;
+	struct spdk_sock *listen_sock;
+	struct spdk_sock *server_sock;
+	struct spdk_sock *client_sock;
+	struct spdk_posix_sock *psock;
+	struct spdk_posix_sock_group_impl *pgroup;
+	struct spdk_sock_impl_opts opts, default_opts;
+	struct spdk_sock_impl_stats stats, init_stats;
+	char *test_string = "abcdef";
+	char *data;
+	struct iovec iov;
+	size_t len;
+	int rc;
+
+	len = sizeof(default_opts);
+	rc = spdk_sock_impl_get_opts("posix", &default_opts, &len);
+	CU_ASSERT(rc == 0);
+	opts = default_opts;
+	opts.recv_pipe_idle_timeout = 10;
+	rc = spdk_sock_impl_set_opts("posix", &opts, sizeof(opts));
+	CU_ASSERT(rc == 0);
+
+	len = sizeof(init_stats);
+	rc = spdk_sock_impl_get_stats("posix", &init_stats, &len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(len == sizeof(init_stats));
+
+	listen_sock = spdk_sock_listen("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(listen_sock != NULL);
+
+	client_sock = spdk_sock_connect("127.0.0.1", UT_PORT, "posix");
+	SPDK_CU_ASSERT_FATAL(client_sock != NULL);
+
+	usleep(1000);
+
+	server_sock = spdk_sock_accept(listen_sock);
+	SPDK_CU_ASSERT_FATAL(server_sock != NULL);
+	psock = __posix_sock(server_sock);
+
+	group = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	rc = spdk_sock_group_add_sock(group, server_sock, read_data, server_sock);
+	CU_ASSERT(rc == 0);
+	pgroup = __posix_group_impl(server_sock->group_impl);
+
+	/* The pipe isn't allocated up front */
+	rc = spdk_sock_set_recvbuf(server_sock, 1024 * 1024);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(psock->recv_pipe == NULL);
+	CU_ASSERT(psock->recv_pipe_max_sz == 1024 * 1024);
+
+	/* Small reads allocate the pipe */
+	iov.iov_base = test_string;
+	iov.iov_len = 7;
+	rc = spdk_sock_writev(client_sock, &iov, 1);
+	CU_ASSERT(rc == 7);
+
+	usleep(1000);
+
+	g_bytes_read = 0;
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_bytes_read == 7);
+	SPDK_CU_ASSERT_FATAL(psock->recv_pipe != NULL);
+	CU_ASSERT(psock->recv_buf_sz == RECV_PIPE_INIT_SIZE);
+	CU_ASSERT(pgroup->recv_pipe_bytes == RECV_PIPE_INIT_SIZE);
+
+	len = sizeof(stats);
+	rc = spdk_sock_impl_get_stats("posix", &stats, &len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.recv_pipes == init_stats.recv_pipes + 1);
+	CU_ASSERT(stats.recv_pipe_bytes == init_stats.recv_pipe_bytes + RECV_PIPE_INIT_SIZE);
+	CU_ASSERT(stats.recv_pipe_grows == init_stats.recv_pipe_grows + 1);
+
+	/* The pipe of an idle socket is released */
+	ut_spdk_get_ticks += 2 * RECV_PIPE_CHECK_PERIOD_US;
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(psock->recv_pipe == NULL);
+	CU_ASSERT(pgroup->recv_pipe_bytes == 0);
+
+	len = sizeof(stats);
+	rc = spdk_sock_impl_get_stats("posix", &stats, &len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.recv_pipes == init_stats.recv_pipes);
+	CU_ASSERT(stats.recv_pipe_bytes == init_stats.recv_pipe_bytes);
+	CU_ASSERT(stats.recv_pipe_shrinks == init_stats.recv_pipe_shrinks + 1);
+
+	/* A pipe filled up by sustained traffic grows */
+	data = calloc(1, 2 * RECV_PIPE_INIT_SIZE);
+	SPDK_CU_ASSERT_FATAL(data != NULL);
+	iov.iov_base = data;
+	iov.iov_len = 2 * RECV_PIPE_INIT_SIZE;
+	rc = spdk_sock_writev(client_sock, &iov, 1);
+	CU_ASSERT(rc == 2 * RECV_PIPE_INIT_SIZE);
+
+	usleep(1000);
+
+	g_bytes_read = 0;
+	rc = spdk_sock_group_poll(group);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_bytes_read == sizeof(g_buf));
+	SPDK_CU_ASSERT_FATAL(psock->recv_pipe != NULL);
+	CU_ASSERT(psock->recv_buf_sz == 2 * RECV_PIPE_INIT_SIZE);
+	CU_ASSERT(pgroup->recv_pipe_bytes == 2 * RECV_PIPE_INIT_SIZE);
+
+	/* But not over the limit of the group */
+	psock->base.impl_opts.group_recv_pipe_limit = 3 * RECV_PIPE_INIT_SIZE;
+	posix_sock_grow_pipe(psock);
+	CU_ASSERT(psock->recv_buf_sz == 2 * RECV_PIPE_INIT_SIZE);
+
+	len = sizeof(stats);
+	rc = spdk_sock_impl_get_stats("posix", &stats, &len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.recv_pipe_limit_hits == init_stats.recv_pipe_limit_hits + 1);
+
+	rc = spdk_sock_close(&client_sock);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_sock_group_remove_sock(group, server_sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(pgroup->recv_pipe_bytes == 0);
+
+	rc = spdk_sock_group_close(&group);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_sock_close(&server_sock);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_sock_close(&listen_sock);
+	CU_ASSERT(rc == 0);
+
+	len = sizeof(stats);
+	rc = spdk_sock_impl_get_stats("posix", &stats, &len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stats.recv_pipes == init_stats.recv_pipes);
+	CU_ASSERT(stats.recv_pipe_bytes == init_stats.recv_pipe_bytes);
+
+	free(data);
+	rc = spdk_sock_impl_set_opts("posix", &default_opts, sizeof(default_opts));
+	CU_ASSERT(rc == 0);
+}
+
 static void
 _posix_sock_close(void)
 {
@@ -1232,6 +1496,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, posix_sock_group);
 	CU_ADD_TEST(suite, ut_sock_group);
 	CU_ADD_TEST(suite, posix_sock_group_fairness);
+	CU_ADD_TEST(suite, posix_sock_group_recv_next);
+	CU_ADD_TEST(suite, posix_sock_adaptive_recv_pipe);
 	CU_ADD_TEST(suite, _posix_sock_close);
 	CU_ADD_TEST(suite, sock_get_default_opts);
 	CU_ADD_TEST(suite, ut_sock_impl_get_set_opts);
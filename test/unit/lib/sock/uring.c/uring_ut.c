@@ -23,6 +23,8 @@ DEFINE_STUB_V(spdk_sock_map_cleanup, (struct spdk_sock_map *map));
 
 DEFINE_STUB_V(spdk_net_impl_register, (struct spdk_net_impl *impl, int priority));
 DEFINE_STUB(spdk_sock_close, int, (struct spdk_sock **s), 0);
+DEFINE_STUB(spdk_sock_group_provide_buf, int, (struct spdk_sock_group *group, void *buf,
+		size_t len, void *ctx), 0);
 DEFINE_STUB(__io_uring_get_cqe, int, (struct io_uring *ring, struct io_uring_cqe **cqe_ptr,
 				      unsigned submit,
 				      unsigned wait_nr, sigset_t *sigmask), 0);
@@ -30,6 +32,14 @@ DEFINE_STUB(io_uring_submit, int, (struct io_uring *ring), 0);
 DEFINE_STUB(io_uring_get_sqe, struct io_uring_sqe *, (struct io_uring *ring), 0);
 DEFINE_STUB(io_uring_queue_init, int, (unsigned entries, struct io_uring *ring, unsigned flags), 0);
 DEFINE_STUB_V(io_uring_queue_exit, (struct io_uring *ring));
+#ifdef SPDK_URING_RECV_MULTISHOT
+DEFINE_STUB(io_uring_register_buf_ring, int, (struct io_uring *ring, struct io_uring_buf_reg *reg,
+		unsigned int flags), -ENOTSUP);
+DEFINE_STUB(io_uring_register_files_sparse, int, (struct io_uring *ring, unsigned nr), -ENOTSUP);
+DEFINE_STUB(io_uring_register_files_update, int, (struct io_uring *ring, unsigned off,
+		const int *files, unsigned nr_files), 0);
+DEFINE_STUB(io_uring_unregister_files, int, (struct io_uring *ring), 0);
+#endif
 
 static void
 _req_cb(void *cb_arg, int len)
@@ -227,6 +237,283 @@ flush_server(void)
 	free(req2);
 }
 
+#ifdef SPDK_URING_RECV_MULTISHOT
+#define UT_CQ_ENTRIES 8
+
+static struct io_uring_cqe g_cqes[UT_CQ_ENTRIES];
+static unsigned g_cq_head;
+static unsigned g_cq_tail;
+static unsigned g_cq_mask = UT_CQ_ENTRIES - 1;
+static struct io_uring_sqe g_sqe;
+
+static void
+_sock_cb(void *arg, struct spdk_sock_group *group, struct spdk_sock *sock)
+{
+}
+
+static void
+ut_group_init(struct spdk_uring_sock_group_impl *group)
+{
+	memset(group, 0, sizeof(*group));
+	group->io_avail = SPDK_SOCK_GROUP_QUEUE_DEPTH;
+	TAILQ_INIT(&group->pending_recv);
+
+	/* Completions are posted directly to the CQ ring */
+	g_cq_head = 0;
+	g_cq_tail = 0;
+	group->uring.cq.khead = &g_cq_head;
+	group->uring.cq.ktail = &g_cq_tail;
+	group->uring.cq.kring_mask = &g_cq_mask;
+	group->uring.cq.ring_mask = g_cq_mask;
+	group->uring.cq.cqes = g_cqes;
+}
+
+static void
+ut_group_fini(struct spdk_uring_sock_group_impl *group)
+{
+	free(group->buf_pool);
+	free(group->buf_ring);
+	free(group->bufs);
+}
+
+static void
+ut_sock_init(struct spdk_uring_sock *sock, bool enable_recv_pipe)
+{
+	memset(sock, 0, sizeof(*sock));
+	sock->fd = -1;
+	sock->fixed_fd = -1;
+	sock->placement_id = -1;
+	STAILQ_INIT(&sock->recv_bufs);
+	TAILQ_INIT(&sock->base.queued_reqs);
+	TAILQ_INIT(&sock->base.pending_reqs);
+	sock->base.impl_opts.enable_recv_pipe = enable_recv_pipe;
+	sock->base.cb_fn = _sock_cb;
+}
+
+/* Arm the multishot receive of the sock and submit it */
+static void
+ut_sock_arm_recv(struct spdk_uring_sock *sock)
+{
+	struct spdk_uring_sock_group_impl *group = sock->group;
+
+	memset(&g_sqe, 0, sizeof(g_sqe));
+	_sock_prep_pollin(&sock->base);
+	CU_ASSERT(sock->recv_task.status == SPDK_URING_SOCK_TASK_IN_PROCESS);
+	CU_ASSERT(g_sqe.opcode == IORING_OP_RECV);
+	CU_ASSERT(g_sqe.flags & IOSQE_BUFFER_SELECT);
+	CU_ASSERT(group->io_queued == 1);
+
+	group->io_inflight += group->io_queued;
+	group->io_avail -= group->io_queued;
+	group->io_queued = 0;
+}
+
+static void
+ut_post_cqe(struct spdk_uring_task *task, int res, uint32_t flags)
+{
+	struct io_uring_cqe *cqe = &g_cqes[g_cq_tail++ & g_cq_mask];
+
+	cqe->user_data = (uint64_t)(uintptr_t)task;
+	cqe->res = res;
+	cqe->flags = flags;
+}
+
+static void
+recv_multishot_rearm(void)
+{
+	struct spdk_uring_sock_group_impl group;
+	struct spdk_uring_sock usock1, usock2;
+	struct spdk_sock *socks[32];
+	uint32_t flags;
+	int rc, i;
+
+	ut_group_init(&group);
+	MOCK_SET(io_uring_register_buf_ring, 0);
+	MOCK_SET(io_uring_get_sqe, &g_sqe);
+
+	/* The buffer ring is only set up once a sock using the receive pipe is added */
+	ut_sock_init(&usock1, false);
+	rc = uring_sock_group_impl_add_sock(&group.base, &usock1.base);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(group.buf_ring == NULL);
+	CU_ASSERT(group.bufs == NULL);
+	CU_ASSERT(!group.recv_multishot);
+
+	ut_sock_init(&usock2, true);
+	rc = uring_sock_group_impl_add_sock(&group.base, &usock2.base);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(group.buf_ring != NULL);
+	CU_ASSERT(group.bufs != NULL);
+	CU_ASSERT(group.recv_multishot);
+	CU_ASSERT(!uring_sock_recv_multishot(&usock1));
+	CU_ASSERT(uring_sock_recv_multishot(&usock2));
+
+	ut_sock_arm_recv(&usock2);
+
+	/* Completions flagged with IORING_CQE_F_MORE leave the receive armed. Each of them
+	 * counts towards the number of completions reaped in a poll. */
+	for (i = 0; i < 3; i++) {
+		ut_post_cqe(&usock2.recv_task, 100,
+			    IORING_CQE_F_MORE | IORING_CQE_F_BUFFER | (i << IORING_CQE_BUFFER_SHIFT));
+	}
+
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(socks[0] == &usock2.base);
+	CU_ASSERT(g_cq_head == 1);
+	CU_ASSERT(usock2.recv_task.status == SPDK_URING_SOCK_TASK_IN_PROCESS);
+	CU_ASSERT(group.io_inflight == 1);
+	CU_ASSERT(STAILQ_FIRST(&usock2.recv_bufs) == &group.bufs[0]);
+
+	/* The receive isn't armed a second time */
+	_sock_prep_pollin(&usock2.base);
+	CU_ASSERT(group.io_queued == 0);
+
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_cq_head == 2);
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(g_cq_head == 3);
+	CU_ASSERT(group.bufs[0].len == 100);
+	CU_ASSERT(STAILQ_NEXT(&group.bufs[0], link) == &group.bufs[1]);
+	CU_ASSERT(STAILQ_NEXT(&group.bufs[1], link) == &group.bufs[2]);
+	CU_ASSERT(STAILQ_NEXT(&group.bufs[2], link) == NULL);
+
+	/* The last completion of the receive doesn't have IORING_CQE_F_MORE set. It's
+	 * armed again on the next poll. */
+	flags = IORING_CQE_F_BUFFER | (3 << IORING_CQE_BUFFER_SHIFT);
+	ut_post_cqe(&usock2.recv_task, 100, flags);
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(usock2.recv_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
+	CU_ASSERT(group.io_inflight == 0);
+	CU_ASSERT(group.io_avail == SPDK_SOCK_GROUP_QUEUE_DEPTH);
+	CU_ASSERT(STAILQ_NEXT(&group.bufs[2], link) == &group.bufs[3]);
+
+	ut_sock_arm_recv(&usock2);
+
+	ut_group_fini(&group);
+	MOCK_CLEAR_P(io_uring_get_sqe);
+	MOCK_SET(io_uring_register_buf_ring, -ENOTSUP);
+}
+
+static void
+recv_multishot_buf_recycle(void)
+{
+	struct spdk_uring_sock_group_impl group;
+	struct spdk_uring_sock usock;
+	struct spdk_sock *socks[32];
+	struct io_uring_buf *ring_buf;
+	struct iovec iov;
+	uint8_t data[10];
+	uint16_t tail;
+	ssize_t bytes;
+	int rc;
+
+	ut_group_init(&group);
+	MOCK_SET(io_uring_register_buf_ring, 0);
+	MOCK_SET(io_uring_get_sqe, &g_sqe);
+
+	ut_sock_init(&usock, true);
+	rc = uring_sock_group_impl_add_sock(&group.base, &usock.base);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(group.recv_multishot);
+	/* All buffers are handed to the kernel */
+	tail = group.buf_ring->tail;
+	CU_ASSERT(tail == SPDK_URING_RECV_BUF_COUNT);
+
+	ut_sock_arm_recv(&usock);
+
+	memset(uring_group_buf_addr(&group, &group.bufs[5]), 0x5a, sizeof(data));
+	ut_post_cqe(&usock.recv_task, sizeof(data),
+		    IORING_CQE_F_MORE | IORING_CQE_F_BUFFER | (5 << IORING_CQE_BUFFER_SHIFT));
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(usock.pending_recv);
+
+	/* A partially read buffer isn't given back */
+	iov.iov_base = data;
+	iov.iov_len = 4;
+	bytes = uring_sock_readv(&usock.base, &iov, 1);
+	CU_ASSERT(bytes == 4);
+	CU_ASSERT(group.bufs[5].offset == 4);
+	CU_ASSERT(group.buf_ring->tail == tail);
+	CU_ASSERT(usock.pending_recv);
+
+	/* Once drained, it's returned to the ring under its buffer ID */
+	iov.iov_len = sizeof(data);
+	bytes = uring_sock_readv(&usock.base, &iov, 1);
+	CU_ASSERT(bytes == sizeof(data) - 4);
+	CU_ASSERT(STAILQ_EMPTY(&usock.recv_bufs));
+	CU_ASSERT(group.buf_ring->tail == (uint16_t)(tail + 1));
+	ring_buf = &group.buf_ring->bufs[tail & (SPDK_URING_RECV_BUF_COUNT - 1)];
+	CU_ASSERT(ring_buf->bid == 5);
+	CU_ASSERT(ring_buf->addr == (uint64_t)(uintptr_t)uring_group_buf_addr(&group, &group.bufs[5]));
+	CU_ASSERT(ring_buf->len == SPDK_URING_RECV_BUF_SIZE);
+	CU_ASSERT(!usock.pending_recv);
+
+	/* Nothing left to read */
+	bytes = uring_sock_readv(&usock.base, &iov, 1);
+	CU_ASSERT(bytes == -1);
+	CU_ASSERT(errno == EAGAIN);
+
+	ut_group_fini(&group);
+	MOCK_CLEAR_P(io_uring_get_sqe);
+	MOCK_SET(io_uring_register_buf_ring, -ENOTSUP);
+}
+
+static void
+recv_multishot_enobufs(void)
+{
+	struct spdk_uring_sock_group_impl group;
+	struct spdk_uring_sock usock;
+	struct spdk_sock *socks[32];
+	int rc;
+
+	ut_group_init(&group);
+	MOCK_SET(io_uring_register_buf_ring, 0);
+	MOCK_SET(io_uring_get_sqe, &g_sqe);
+
+	ut_sock_init(&usock, true);
+	rc = uring_sock_group_impl_add_sock(&group.base, &usock.base);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(group.recv_multishot);
+
+	/* Running out of provided buffers terminates the receive without failing the sock */
+	ut_sock_arm_recv(&usock);
+	ut_post_cqe(&usock.recv_task, -ENOBUFS, 0);
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(usock.recv_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
+	CU_ASSERT(group.io_inflight == 0);
+	CU_ASSERT(usock.recv_errno == 0);
+	CU_ASSERT(!usock.pending_recv);
+	CU_ASSERT(group.recv_multishot);
+
+	/* It's armed again on the next poll */
+	ut_sock_arm_recv(&usock);
+
+	/* A kernel without multishot receive makes the group fall back to polling */
+	ut_post_cqe(&usock.recv_task, -EINVAL, 0);
+	rc = sock_uring_group_reap(&group, 1, SPDK_COUNTOF(socks), socks);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(usock.recv_errno == 0);
+	CU_ASSERT(!group.recv_multishot);
+	CU_ASSERT(!uring_sock_recv_multishot(&usock));
+
+	memset(&g_sqe, 0, sizeof(g_sqe));
+	_sock_prep_pollin(&usock.base);
+	CU_ASSERT(usock.recv_task.status == SPDK_URING_SOCK_TASK_NOT_IN_USE);
+	CU_ASSERT(usock.pollin_task.status == SPDK_URING_SOCK_TASK_IN_PROCESS);
+	CU_ASSERT(g_sqe.opcode == IORING_OP_POLL_ADD);
+
+	ut_group_fini(&group);
+	MOCK_CLEAR_P(io_uring_get_sqe);
+	MOCK_SET(io_uring_register_buf_ring, -ENOTSUP);
+}
+#endif
+
 int
 main(int argc, char **argv)
 {
@@ -241,6 +528,11 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, flush_client);
 	CU_ADD_TEST(suite, flush_server);
+#ifdef SPDK_URING_RECV_MULTISHOT
+	CU_ADD_TEST(suite, recv_multishot_rearm);
+	CU_ADD_TEST(suite, recv_multishot_buf_recycle);
+	CU_ADD_TEST(suite, recv_multishot_enobufs);
+#endif
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
@@ -1101,6 +1101,102 @@ thread_update_stats_test(void)
 	free_threads();
 }
 
+static void
+poller_run_time_stats_test(void)
+{
+	struct spdk_poller	*poller;
+	struct spdk_poller_stats stats;
+
+	allocate_threads(1);
+	set_thread(0);
+
+	poller = spdk_poller_register(poller_run_busy, (void *)100, 0);
+	CU_ASSERT(poller != NULL);
+
+	poll_thread_times(0, 1);
+
+	spdk_poller_get_stats(poller, &stats);
+	CU_ASSERT(stats.run_count == 1);
+	CU_ASSERT(stats.busy_count == 1);
+	CU_ASSERT(stats.total_run_ticks == 100);
+	CU_ASSERT(stats.max_run_ticks == 100);
+	/* 100 ticks fall into the [64, 128) bucket */
+	CU_ASSERT(stats.run_time_histogram[6] == 1);
+
+	spdk_poller_unregister(&poller);
+
+	poller = spdk_poller_register(poller_run_idle, (void *)1000, 0);
+	CU_ASSERT(poller != NULL);
+
+	poll_thread_times(0, 2);
+
+	spdk_poller_get_stats(poller, &stats);
+	CU_ASSERT(stats.run_count == 2);
+	CU_ASSERT(stats.busy_count == 0);
+	CU_ASSERT(stats.total_run_ticks == 2000);
+	CU_ASSERT(stats.max_run_ticks == 1000);
+	/* 1000 ticks fall into the [512, 1024) bucket */
+	CU_ASSERT(stats.run_time_histogram[9] == 2);
+	CU_ASSERT(stats.run_time_histogram[6] == 0);
+
+	spdk_poller_unregister(&poller);
+
+	free_threads();
+}
+
+static void
+count_msg_cb(void *ctx)
+{
+	int *count = ctx;
+
+	(*count)++;
+}
+
+static void
+thread_msg_stats_test(void)
+{
+	struct spdk_thread	*thread;
+	int			count = 0;
+
+	allocate_threads(1);
+	set_thread(0);
+	thread = spdk_get_thread();
+
+	CU_ASSERT(thread->stats.msg_count == 0);
+	CU_ASSERT(thread->stats.msg_samples == 0);
+
+	spdk_thread_send_msg(thread, count_msg_cb, &count);
+	spdk_delay_us(10);
+	spdk_thread_send_msg(thread, count_msg_cb, &count);
+	spdk_delay_us(20);
+
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(count == 2);
+
+	/* Both messages were processed in one batch and the oldest waited 30 ticks */
+	CU_ASSERT(thread->stats.msg_count == 2);
+	CU_ASSERT(thread->stats.msg_samples == 1);
+	CU_ASSERT(thread->stats.msg_queue_depth_total == 2);
+	CU_ASSERT(thread->stats.msg_queue_depth_max == 2);
+	CU_ASSERT(thread->stats.msg_latency_total_tsc == 30);
+	CU_ASSERT(thread->stats.msg_latency_max_tsc == 30);
+
+	spdk_thread_send_msg(thread, count_msg_cb, &count);
+	spdk_delay_us(5);
+
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(count == 3);
+
+	CU_ASSERT(thread->stats.msg_count == 3);
+	CU_ASSERT(thread->stats.msg_samples == 2);
+	CU_ASSERT(thread->stats.msg_queue_depth_total == 3);
+	CU_ASSERT(thread->stats.msg_queue_depth_max == 2);
+	CU_ASSERT(thread->stats.msg_latency_total_tsc == 35);
+	CU_ASSERT(thread->stats.msg_latency_max_tsc == 30);
+
+	free_threads();
+}
+
 struct ut_nested_ch {
 	struct spdk_io_channel *child;
 	struct spdk_poller *poller;
@@ -1800,6 +1896,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, channel_destroy_races);
 	CU_ADD_TEST(suite, thread_exit_test);
 	CU_ADD_TEST(suite, thread_update_stats_test);
+	CU_ADD_TEST(suite, poller_run_time_stats_test);
+	CU_ADD_TEST(suite, thread_msg_stats_test);
 	CU_ADD_TEST(suite, nested_channel);
 	CU_ADD_TEST(suite, device_unregister_and_thread_exit_race);
 	CU_ADD_TEST(suite, cache_closest_timed_poller);
@@ -0,0 +1,210 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+
+#include "util/xor.c"
+
+#define BUF_COUNT 8
+#define SRC_BUF_COUNT (BUF_COUNT - 1)
+#define BUF_SIZE 4096
+
+static uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	uint8_t r = 0;
+
+	while (b) {
+		if (b & 1) {
+			r ^= a;
+		}
+		a = gf_mul2_u8(a);
+		b >>= 1;
+	}
+
+	return r;
+}
+
+static void
+test_xor_gen(void)
+{
+	void *bufs[BUF_COUNT];
+	void *bufs2[SRC_BUF_COUNT];
+	uint8_t *ref, *dest;
+	int ret;
+	size_t i, j;
+	uint32_t *tmp;
+
+	/* alloc and fill the buffers with a pattern */
+	for (i = 0; i < BUF_COUNT; i++) {
+		ret = posix_memalign(&bufs[i], spdk_xor_get_optimal_alignment(), BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+
+		tmp = bufs[i];
+		for (j = 0; j < BUF_SIZE / sizeof(*tmp); j++) {
+			tmp[j] = rand();
+		}
+	}
+
+	dest = bufs[SRC_BUF_COUNT];
+
+	/* prepare the reference buffer */
+	ref = malloc(BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref != NULL);
+
+	memset(ref, 0, BUF_SIZE);
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		for (j = 0; j < BUF_SIZE; j++) {
+			ref[j] ^= ((uint8_t *)bufs[i])[j];
+		}
+	}
+
+	/* generate xor, compare the dest and reference buffers */
+	ret = spdk_xor_gen(dest, bufs, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	ret = memcmp(ref, dest, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+
+	/* len not multiple of alignment */
+	memset(dest, 0xba, BUF_SIZE);
+	ret = spdk_xor_gen(dest, bufs, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	ret = memcmp(ref, dest, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(dest[BUF_SIZE - 1] == 0xba);
+
+	/* unaligned buffers */
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		bufs2[i] = (uint8_t *)bufs[i] + 1;
+	}
+	memset(dest, 0xba, BUF_SIZE);
+	ret = spdk_xor_gen(dest + 1, bufs2, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	ret = memcmp(ref + 1, dest + 1, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(dest[0] == 0xba);
+
+	/* xoring a buffer with itself should result in all zeros */
+	memset(ref, 0, BUF_SIZE);
+	bufs2[0] = bufs[0];
+	bufs2[1] = bufs[0];
+	ret = spdk_xor_gen(dest, bufs2, 2, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	ret = memcmp(ref, dest, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+
+	/* at least two sources are required */
+	ret = spdk_xor_gen(dest, bufs, 1, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < BUF_COUNT; i++) {
+		free(bufs[i]);
+	}
+	free(ref);
+}
+
+static void
+test_xor_gen_pq(void)
+{
+	void *bufs[SRC_BUF_COUNT];
+	void *bufs2[SRC_BUF_COUNT];
+	uint8_t *p, *q, *ref_p, *ref_q, *rebuilt;
+	uint8_t coef;
+	int ret;
+	size_t i, j;
+	uint32_t *tmp;
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		ret = posix_memalign(&bufs[i], spdk_xor_get_optimal_alignment(), BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+
+		tmp = bufs[i];
+		for (j = 0; j < BUF_SIZE / sizeof(*tmp); j++) {
+			tmp[j] = rand();
+		}
+	}
+
+	ret = posix_memalign((void **)&p, spdk_xor_get_optimal_alignment(), BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+	ret = posix_memalign((void **)&q, spdk_xor_get_optimal_alignment(), BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+	ref_p = calloc(1, BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref_p != NULL);
+	ref_q = calloc(1, BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref_q != NULL);
+	rebuilt = calloc(1, BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(rebuilt != NULL);
+
+	/* P is the plain xor, Q multiplies source i by 2^i */
+	coef = 1;
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		for (j = 0; j < BUF_SIZE; j++) {
+			ref_p[j] ^= ((uint8_t *)bufs[i])[j];
+			ref_q[j] ^= gf_mul(coef, ((uint8_t *)bufs[i])[j]);
+		}
+		coef = gf_mul2_u8(coef);
+	}
+
+	ret = spdk_xor_gen_pq(p, q, bufs, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(ref_p, p, BUF_SIZE) == 0);
+	CU_ASSERT(memcmp(ref_q, q, BUF_SIZE) == 0);
+
+	/* unaligned buffers take the byte path and must give the same result */
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		bufs2[i] = (uint8_t *)bufs[i] + 1;
+	}
+	memset(p, 0, BUF_SIZE);
+	memset(q, 0, BUF_SIZE);
+	ret = spdk_xor_gen_pq(p + 1, q + 1, bufs2, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(ref_p + 1, p + 1, BUF_SIZE - 1) == 0);
+	CU_ASSERT(memcmp(ref_q + 1, q + 1, BUF_SIZE - 1) == 0);
+
+	/* a single lost source can be rebuilt from P and the remaining sources */
+	memcpy(bufs2, bufs, sizeof(bufs2));
+	bufs2[3] = ref_p;
+	ret = spdk_xor_gen(rebuilt, bufs2, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(rebuilt, bufs[3], BUF_SIZE) == 0);
+
+	ret = spdk_xor_gen_pq(p, q, bufs, 1, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < SRC_BUF_COUNT; i++) {
+		free(bufs[i]);
+	}
+	free(p);
+	free(q);
+	free(ref_p);
+	free(ref_q);
+	free(rebuilt);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("xor", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_xor_gen);
+	CU_ADD_TEST(suite, test_xor_gen_pq);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+
+	CU_basic_run_tests();
+
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -17,6 +17,7 @@ function unittest_bdev() {
 	$valgrind $testdir/lib/bdev/nvme/bdev_nvme.c/bdev_nvme_ut
 	$valgrind $testdir/lib/bdev/raid/bdev_raid.c/bdev_raid_ut
 	$valgrind $testdir/lib/bdev/raid/concat.c/concat_ut
+	$valgrind $testdir/lib/bdev/raid/raid1.c/raid1_ut
 	$valgrind $testdir/lib/bdev/bdev_zone.c/bdev_zone_ut
 	$valgrind $testdir/lib/bdev/gpt/gpt.c/gpt_ut
 	$valgrind $testdir/lib/bdev/part.c/part_ut
@@ -50,6 +51,8 @@ function unittest_ftl() {
 	$valgrind $testdir/lib/ftl/ftl_mngt/ftl_mngt_ut
 	$valgrind $testdir/lib/ftl/ftl_mempool.c/ftl_mempool_ut
 	$valgrind $testdir/lib/ftl/ftl_l2p/ftl_l2p_ut
+	$valgrind $testdir/lib/ftl/ftl_reloc.c/ftl_reloc_ut
+	$valgrind $testdir/lib/ftl/ftl_l2p_cache.c/ftl_l2p_cache_ut
 }
 
 function unittest_iscsi() {
@@ -130,6 +133,7 @@ function unittest_util() {
 	$valgrind $testdir/lib/util/iov.c/iov_ut
 	$valgrind $testdir/lib/util/math.c/math_ut
 	$valgrind $testdir/lib/util/pipe.c/pipe_ut
+	$valgrind $testdir/lib/util/xor.c/xor_ut
 }
 
 function unittest_init() {